@@ -11,6 +11,7 @@
 // Includes
 //-------------------------------------------------------------------------------------------
 #include <TinyMath.h>
+#include <TextureAtlas.h>
 #include <vector>
 #include <map>
 #include <string>
@@ -38,8 +39,10 @@ struct Subset
     std::string  materialName;
     unsigned int offset;
     unsigned int count;
+    unsigned int texture;       //!< 描画時にバインドするテクスチャIDです(0ならテクスチャなし).
 
     Subset()
+    : texture( 0 )
     { /* DO_NOTHING */ }
 };
 
@@ -116,6 +119,17 @@ public:
     void Release     ();
     void Draw        ();
 
+    //---------------------------------------------------------------------------------------
+    //! @brief      テクスチャアトラスに合わせてテクスチャ座標を書き換えます.
+    //!
+    //! @note       diffuseMap がアトラスに含まれるサブセットのテクスチャ座標をページ上の位置に
+    //!             変換し，同じページ・同じ色のマテリアルのサブセットを1つにまとめます.
+    //!             [0, 1] を超えるテクスチャ座標(タイリング)を持つサブセットは変換しません.
+    //! @param [in]     atlas       構築済みのテクスチャアトラスです.
+    //! @return     アトラスを参照するようになったサブセット数を返却します.
+    //---------------------------------------------------------------------------------------
+    unsigned int ApplyAtlas( const TextureAtlas& atlas );
+
     VertexList&                 GetVertices    ();
     SubsetList&                 GetSubsets     ();
     MaterialDictionary&         GetMaterials   ();
@@ -55,6 +55,24 @@ void SetMaterial( const Material& material )
     glMaterialfv( GL_FRONT_AND_BACK, GL_SHININESS, &material.shininess );
 }
 
+//-------------------------------------------------------------------------------------------
+//      ベクトルが等しいかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsEqual( const Vec3& a, const Vec3& b )
+{ return ( a.x == b.x ) && ( a.y == b.y ) && ( a.z == b.z ); }
+
+//-------------------------------------------------------------------------------------------
+//      SetMaterial() で設定する値が同じかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsSameColor( const Material& a, const Material& b )
+{
+    return IsEqual( a.ambient,  b.ambient  )
+        && IsEqual( a.diffuse,  b.diffuse  )
+        && IsEqual( a.specular, b.specular )
+        && ( a.shininess == b.shininess )
+        && ( a.alpha     == b.alpha );
+}
+
 } // namespace /* anonymous */
 
 
@@ -420,30 +438,30 @@ bool MeshOBJ::LoadMTLFile( const char* filename )
         // Ambient Map
         else if ( 0 == strcmp( buf, "map_Ka" ) )
         {
-            std::string name;
-            file >> name;
-            m_Materials[ name ].ambientMap = m_DirectoryPath + name;
+            std::string path;
+            file >> path;
+            m_Materials[ name ].ambientMap = m_DirectoryPath + path;
         }
         // Diffuse Map
         else if ( 0 == strcmp( buf, "map_Kd" ) )
         {
-            std::string name;
-            file >> name;
-            m_Materials[ name ].diffuseMap = m_DirectoryPath + name;
+            std::string path;
+            file >> path;
+            m_Materials[ name ].diffuseMap = m_DirectoryPath + path;
         }
         // Specular Map
         else if ( 0 == strcmp( buf, "map_Ks" ) )
         {
-            std::string name;
-            file >> name;
-            m_Materials[ name ].specularMap = m_DirectoryPath + name;
+            std::string path;
+            file >> path;
+            m_Materials[ name ].specularMap = m_DirectoryPath + path;
         }
         // Bump Map
         else if ( 0 == strcmp( buf, "map_Bump" ) )
         {
-            std::string name;
-            file >> name;
-            m_Materials[ name ].bumpMap = m_DirectoryPath + name;
+            std::string path;
+            file >> path;
+            m_Materials[ name ].bumpMap = m_DirectoryPath + path;
         }
 
         file.ignore( BUFFER_LENGTH, '\n' );
@@ -478,6 +496,15 @@ bool MeshOBJ::LoadFromFile( const char* filename )
 //-------------------------------------------------------------------------------------------
 void MeshOBJ::Draw()
 {
+    if ( m_Subsets.empty() )
+    { return; }
+
+    //　全サブセットで同じ頂点配列を使うので一度だけ設定する.
+    glInterleavedArrays( GL_T2F_N3F_V3F, 0, &m_Vertices[0] );
+
+    const Material* pCurMaterial = nullptr;
+    unsigned int    curTexture   = 0;
+
     for ( size_t i = 0; i<m_Subsets.size(); i++ )
     {
         // サブセットを取得
@@ -485,12 +512,173 @@ void MeshOBJ::Draw()
 
         // マテリアル
         Material& material = m_Materials[ subset.materialName ];
-        SetMaterial( material );
+        if ( pCurMaterial != &material )
+        {
+            SetMaterial( material );
+            pCurMaterial = &material;
+        }
+
+        // テクスチャ
+        if ( curTexture != subset.texture )
+        {
+            if ( subset.texture != 0 )
+            {
+                glEnable( GL_TEXTURE_2D );
+                glBindTexture( GL_TEXTURE_2D, subset.texture );
+            }
+            else
+            {
+                glBindTexture( GL_TEXTURE_2D, 0 );
+                glDisable( GL_TEXTURE_2D );
+            }
+            curTexture = subset.texture;
+        }
 
         //　三角形描画
-        glInterleavedArrays( GL_T2F_N3F_V3F, 0, &m_Vertices[0] );
         glDrawElements( GL_TRIANGLES, subset.count, GL_UNSIGNED_INT, &m_Indices[ subset.offset ] );
     }
+
+    if ( curTexture != 0 )
+    {
+        glBindTexture( GL_TEXTURE_2D, 0 );
+        glDisable( GL_TEXTURE_2D );
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      テクスチャアトラスに合わせてテクスチャ座標を書き換えます.
+//-------------------------------------------------------------------------------------------
+unsigned int MeshOBJ::ApplyAtlas( const TextureAtlas& atlas )
+{
+    unsigned int result = 0;
+
+    // 元のテクスチャ座標を覚えておく.
+    std::vector<Vec2> texcoords( m_Vertices.size() );
+    for( size_t i=0; i<m_Vertices.size(); ++i )
+    { texcoords[i] = m_Vertices[i].texcoord; }
+
+    // サブセットごとの配置情報を調べる.
+    std::vector<const AtlasRegion*> regions( m_Subsets.size(), nullptr );
+    for( size_t i=0; i<m_Subsets.size(); ++i )
+    {
+        const Subset& subset = m_Subsets[i];
+
+        MaterialDictionaryCItr itr = m_Materials.find( subset.materialName );
+        if ( itr == m_Materials.end() || itr->second.diffuseMap.empty() )
+        { continue; }
+
+        const AtlasRegion* pRegion = atlas.FindRegion( itr->second.diffuseMap );
+        if ( pRegion == nullptr || atlas.GetID( pRegion->page ) == 0 )
+        { continue; }
+
+        // タイリングしているサブセットはアトラス上では再現できないので個別のまま残す.
+        bool inRange = true;
+        for( unsigned int j=0; j<subset.count && inRange; ++j )
+        {
+            const Vec2& uv = texcoords[ m_Indices[ subset.offset + j ] ];
+            inRange = ( uv.x >= 0.0f && uv.x <= 1.0f && uv.y >= 0.0f && uv.y <= 1.0f );
+        }
+
+        if ( inRange )
+        { regions[i] = pRegion; }
+    }
+
+    // 書き換え済みの頂点がどの配置情報で変換されたかを覚えておく.
+    // アトラスを使わないサブセットが参照する頂点は元の値のまま残す.
+    const AtlasRegion original;
+    std::vector<const AtlasRegion*> remapped( m_Vertices.size(), nullptr );
+    for( size_t i=0; i<m_Subsets.size(); ++i )
+    {
+        if ( regions[i] != nullptr )
+        { continue; }
+
+        const Subset& subset = m_Subsets[i];
+        for( unsigned int j=0; j<subset.count; ++j )
+        { remapped[ m_Indices[ subset.offset + j ] ] = &original; }
+    }
+
+    for( size_t i=0; i<m_Subsets.size(); ++i )
+    {
+        const AtlasRegion* pRegion = regions[i];
+        if ( pRegion == nullptr )
+        { continue; }
+
+        Subset& subset = m_Subsets[i];
+        for( unsigned int j=0; j<subset.count; ++j )
+        {
+            unsigned int& index = m_Indices[ subset.offset + j ];
+            if ( remapped[index] == pRegion )
+            { continue; }
+
+            // 別の画像で書き換え済み，または元の値が必要な頂点は複製してから書き換える.
+            if ( remapped[index] != nullptr )
+            {
+                const Vertex vertex = m_Vertices[index];
+                const Vec2   uv     = texcoords[index];
+                m_Vertices.push_back( vertex );
+                remapped  .push_back( nullptr );
+                texcoords .push_back( uv );
+                index = static_cast<unsigned int>( m_Vertices.size() - 1 );
+            }
+
+            m_Vertices[index].texcoord = pRegion->Remap( texcoords[index] );
+            remapped[index] = pRegion;
+        }
+
+        subset.texture = atlas.GetID( pRegion->page );
+        result++;
+    }
+
+    // 色が同じマテリアルは1つにまとめる.
+    for( size_t i=0; i<m_Subsets.size(); ++i )
+    {
+        MaterialDictionaryCItr itr = m_Materials.find( m_Subsets[i].materialName );
+        if ( itr == m_Materials.end() )
+        { continue; }
+
+        for( size_t j=0; j<i; ++j )
+        {
+            MaterialDictionaryCItr other = m_Materials.find( m_Subsets[j].materialName );
+            if ( other != m_Materials.end() && IsSameColor( itr->second, other->second ) )
+            {
+                m_Subsets[i].materialName = m_Subsets[j].materialName;
+                break;
+            }
+        }
+    }
+
+    // テクスチャとマテリアルが同じサブセットを最初に現れた位置で連結する.
+    SubsetList subsets;
+    IndexList  indices;
+    indices.reserve( m_Indices.size() );
+    std::vector<bool> merged( m_Subsets.size(), false );
+    for( size_t i=0; i<m_Subsets.size(); ++i )
+    {
+        if ( merged[i] )
+        { continue; }
+
+        Subset subset = m_Subsets[i];
+        subset.offset = static_cast<unsigned int>( indices.size() );
+        subset.count  = 0;
+
+        for( size_t j=i; j<m_Subsets.size(); ++j )
+        {
+            const Subset& src = m_Subsets[j];
+            if ( merged[j] || src.texture != subset.texture || src.materialName != subset.materialName )
+            { continue; }
+
+            indices.insert( indices.end(), m_Indices.begin() + src.offset, m_Indices.begin() + src.offset + src.count );
+            subset.count += src.count;
+            merged[j] = true;
+        }
+
+        subsets.push_back( subset );
+    }
+
+    m_Subsets.swap( subsets );
+    m_Indices.swap( indices );
+
+    return result;
 }
 
 //-------------------------------------------------------------------------------------------
@@ -12,6 +12,7 @@
 // Includes
 //------------------------------------------------------------------------------------------
 #include <TinyMath.h>
+#include <TextureAtlas.h>
 #include <string>
 #include <vector>
 
@@ -67,6 +68,7 @@ struct Material
     Vec3        emissive;   //!< 自己発光色です.
     float       power;      //!< 鏡面反射強度です.
     std::string texture;    //!< テクスチャ名です.
+    unsigned int textureID; //!< 描画時にバインドするテクスチャIDです(0ならテクスチャなし).
 
     //--------------------------------------------------------------------------------------
     //! @brief      コンストラクタです.
@@ -78,6 +80,7 @@ struct Material
     , emissive  ()
     , power     ( 0.0f )
     , texture   ()
+    , textureID ( 0 )
     { /* DO_NOTHING */ }
 
     //--------------------------------------------------------------------------------------
@@ -90,6 +93,7 @@ struct Material
     , emissive  ( value.emissive )
     , power     ( value.power )
     , texture   ( value.texture )
+    , textureID ( value.textureID )
     { /* DO_NOTHING */ }
 
     //--------------------------------------------------------------------------------------
@@ -190,6 +194,17 @@ public:
     void Release     ();
     void Draw        ();
 
+    //--------------------------------------------------------------------------------------
+    //! @brief      テクスチャアトラスに合わせてテクスチャ座標を書き換えます.
+    //!
+    //! @note       テクスチャがアトラスに含まれるマテリアルの面のテクスチャ座標をページ上の
+    //!             位置に変換し，同じページ・同じ色のマテリアルを1つにまとめて面を並べ替えます.
+    //!             [0, 1] を超えるテクスチャ座標(タイリング)を持つマテリアルは変換しません.
+    //! @param [in]     atlas       構築済みのテクスチャアトラスです.
+    //! @return     アトラスを参照するようになったマテリアル数を返却します.
+    //--------------------------------------------------------------------------------------
+    unsigned int ApplyAtlas( const TextureAtlas& atlas );
+
     std::vector<MeshX>&     GetMeshes   ();
     std::vector<Material>&  GetMaterials();
     BoundingBox             GetBox      () const;
@@ -0,0 +1,221 @@
+﻿//------------------------------------------------------------------------------------------
+// File : TextureAtlas.h
+// Desc : Texture Atlas Builder.
+// Copyright(c) Project Asura. All right reserved.
+//------------------------------------------------------------------------------------------
+
+#ifndef _TEXTURE_ATLAS_H_
+#define _TEXTURE_ATLAS_H_
+
+//------------------------------------------------------------------------------------------
+// Includes
+//------------------------------------------------------------------------------------------
+#include <TinyMath.h>
+#include <string>
+#include <vector>
+#include <map>
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// AtlasRegion structure
+////////////////////////////////////////////////////////////////////////////////////////////
+struct AtlasRegion
+{
+    unsigned int    page;       //!< 配置されたページ番号です.
+    unsigned int    x;          //!< 画像左端の位置です(ガターは含みません).
+    unsigned int    y;          //!< 画像下端の位置です(ガターは含みません).
+    unsigned int    width;      //!< 画像の横幅です.
+    unsigned int    height;     //!< 画像の縦幅です.
+    Vec2            scale;      //!< テクスチャ座標のスケールです.
+    Vec2            offset;     //!< テクスチャ座標のオフセットです.
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //--------------------------------------------------------------------------------------
+    AtlasRegion()
+    : page  ( 0 )
+    , x     ( 0 )
+    , y     ( 0 )
+    , width ( 0 )
+    , height( 0 )
+    , scale ()
+    , offset()
+    { /* DO_NOTHING */ }
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      元画像のテクスチャ座標をアトラス上の座標に変換します.
+    //!
+    //! @note       [0, 1] の範囲のテクスチャ座標のみ正しく変換できます.
+    //--------------------------------------------------------------------------------------
+    Vec2 Remap( const Vec2& texcoord ) const
+    { return Vec2( texcoord.x * scale.x + offset.x, texcoord.y * scale.y + offset.y ); }
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// TextureAtlas class
+////////////////////////////////////////////////////////////////////////////////////////////
+class TextureAtlas
+{
+    //======================================================================================
+    // list of friend classes and methods.
+    //======================================================================================
+    /* NOTHING */
+
+public:
+    //======================================================================================
+    // public variables.
+    //======================================================================================
+    /* NOTHING */
+
+    //======================================================================================
+    // public methods.
+    //======================================================================================
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //--------------------------------------------------------------------------------------
+    TextureAtlas();
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //--------------------------------------------------------------------------------------
+    virtual ~TextureAtlas();
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      アトラスに詰める画像を追加します.
+    //!
+    //! @note       ピクセルデータはコピーされます. 行の並びはGLへ転送する順(先頭行が v = 0)です.
+    //! @param [in]     name        検索用の名前です. マテリアルのテクスチャ名を指定します.
+    //! @param [in]     width       横幅です.
+    //! @param [in]     height      縦幅です.
+    //! @param [in]     pPixels     width * height * 4 バイトのRGBA8です.
+    //! @retval true    追加に成功.
+    //! @retval false   追加に失敗.
+    //--------------------------------------------------------------------------------------
+    bool AddImage( const std::string& name, unsigned int width, unsigned int height, const unsigned char* pPixels );
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      追加した画像をページに詰めてアトラスを構築します.
+    //!
+    //! @note       スカイライン法で高さの大きい順に配置し，収まらない場合はページを追加します.
+    //!             各画像は 2^(mipLevels-1) テクセル境界に揃えて配置し，ガター幅も同じ単位に
+    //!             切り上げるため，最も小さいミップレベルでも隣の画像が滲みません.
+    //! @param [in]     pageSize    ページの一辺のサイズです. 2の累乗を指定します.
+    //! @param [in]     padding     画像の周囲に確保するガターのテクセル数です.
+    //! @param [in]     mipLevels   生成するミップレベル数です(1以上).
+    //! @retval true    構築に成功.
+    //! @retval false   構築に失敗.
+    //--------------------------------------------------------------------------------------
+    bool Build( unsigned int pageSize = 1024, unsigned int padding = 4, unsigned int mipLevels = 4 );
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      ページごとのGLテクスチャを生成します.
+    //--------------------------------------------------------------------------------------
+    bool CreateGLTextures();
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      GLテクスチャを破棄します.
+    //--------------------------------------------------------------------------------------
+    void DeleteGLTextures();
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      解放処理を行います.
+    //--------------------------------------------------------------------------------------
+    void Release();
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      画像の配置情報を検索します.
+    //!
+    //! @param [in]     name        AddImage() で指定した名前です.
+    //! @return     配置情報を返却します. 見つからない場合は nullptr を返却します.
+    //--------------------------------------------------------------------------------------
+    const AtlasRegion* FindRegion( const std::string& name ) const;
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      ページ数を取得します.
+    //--------------------------------------------------------------------------------------
+    unsigned int GetPageCount() const;
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      ページの一辺のサイズを取得します.
+    //--------------------------------------------------------------------------------------
+    unsigned int GetPageSize() const;
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      ミップレベル数を取得します.
+    //--------------------------------------------------------------------------------------
+    unsigned int GetMipLevels() const;
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      ページのピクセルデータ(RGBA8)を取得します.
+    //--------------------------------------------------------------------------------------
+    const unsigned char* GetPagePixels( unsigned int page, unsigned int mipLevel = 0 ) const;
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      ページのテクスチャIDを取得します. 未生成の場合は0を返却します.
+    //--------------------------------------------------------------------------------------
+    unsigned int GetID( unsigned int page ) const;
+
+protected:
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // Image structure
+    ////////////////////////////////////////////////////////////////////////////////////////
+    struct Image
+    {
+        std::string                 name;       //!< 名前です.
+        unsigned int                width;      //!< 横幅です.
+        unsigned int                height;     //!< 縦幅です.
+        std::vector<unsigned char>  pixels;     //!< RGBA8のピクセルデータです.
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // SkylineNode structure
+    ////////////////////////////////////////////////////////////////////////////////////////
+    struct SkylineNode
+    {
+        unsigned int    x;          //!< 区間の左端です.
+        unsigned int    y;          //!< 区間の高さです.
+        unsigned int    width;      //!< 区間の幅です.
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // Page structure
+    ////////////////////////////////////////////////////////////////////////////////////////
+    struct Page
+    {
+        std::vector<SkylineNode>                    skyline;    //!< 配置済み領域の上端です.
+        std::vector< std::vector<unsigned char> >   mips;       //!< ミップレベルごとのピクセルデータです.
+        unsigned int                                id;         //!< テクスチャIDです.
+    };
+
+    //======================================================================================
+    // protected variables.
+    //======================================================================================
+    std::vector<Image>                      m_Images;       //!< 追加された画像です.
+    std::vector<Page>                       m_Pages;        //!< ページです.
+    std::map<std::string, AtlasRegion>     m_Regions;      //!< 名前ごとの配置情報です.
+    unsigned int                            m_PageSize;     //!< ページの一辺のサイズです.
+    unsigned int                            m_MipLevels;    //!< ミップレベル数です.
+
+    //======================================================================================
+    // protected methods.
+    //======================================================================================
+    bool FindPosition( const Page& page, unsigned int width, unsigned int height, unsigned int& bestIndex, unsigned int& bestY ) const;
+    void AddSkyline  ( Page& page, unsigned int index, unsigned int width, unsigned int height, unsigned int y );
+
+private:
+    //======================================================================================
+    // private variables.
+    //======================================================================================
+    /* NOTHING */
+
+    //======================================================================================
+    // private methods.
+    //======================================================================================
+    TextureAtlas    ( const TextureAtlas& value );  // アクセス禁止.
+    void operator = ( const TextureAtlas& value );  // アクセス禁止.
+};
+
+
+#endif//_TEXTURE_ATLAS_H_
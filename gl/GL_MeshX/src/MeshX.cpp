@@ -9,6 +9,8 @@
 //------------------------------------------------------------------------------------------
 #include <MeshX.h>
 #include <cstdio>
+#include <map>
+#include <algorithm>
 #include <GL/freeglut.h>
 
 
@@ -248,6 +250,30 @@ private:
     void operator = ( const Token& value );     // アクセス禁止.
 };
 
+////////////////////////////////////////////////////////////////////////////////////////////
+// SortByMaterial structure
+////////////////////////////////////////////////////////////////////////////////////////////
+struct SortByMaterial
+{
+    bool operator () ( const Face& lhs, const Face& rhs ) const
+    { return lhs.indexM < rhs.indexM; }
+};
+
+//------------------------------------------------------------------------------------------
+//      SetMaterial() で設定する値とテクスチャが同じかどうかチェックします.
+//------------------------------------------------------------------------------------------
+bool IsSameMaterial( const Material& a, const Material& b )
+{
+    return ( a.diffuse.x  == b.diffuse.x  ) && ( a.diffuse.y  == b.diffuse.y  )
+        && ( a.diffuse.z  == b.diffuse.z  ) && ( a.diffuse.w  == b.diffuse.w  )
+        && ( a.specular.x == b.specular.x ) && ( a.specular.y == b.specular.y )
+        && ( a.specular.z == b.specular.z )
+        && ( a.emissive.x == b.emissive.x ) && ( a.emissive.y == b.emissive.y )
+        && ( a.emissive.z == b.emissive.z )
+        && ( a.power      == b.power      )
+        && ( a.textureID  == b.textureID  );
+}
+
 
 } // namespace /* anonymous */ 
 
@@ -601,6 +627,7 @@ void ModelX::DrawMesh( unsigned int index )
 
     int prevMat = -1;
     int currMat = 0;
+    unsigned int currTexture = 0;
 
     for( size_t i=0; i<mesh.faces.size(); ++i )
     {
@@ -614,6 +641,22 @@ void ModelX::DrawMesh( unsigned int index )
             {
                 SetMaterial( m_Materials[currMat] );
                 prevMat = currMat;
+
+                const unsigned int texture = ( hasU ) ? m_Materials[currMat].textureID : 0;
+                if ( texture != currTexture )
+                {
+                    if ( texture != 0 )
+                    {
+                        glEnable( GL_TEXTURE_2D );
+                        glBindTexture( GL_TEXTURE_2D, texture );
+                    }
+                    else
+                    {
+                        glBindTexture( GL_TEXTURE_2D, 0 );
+                        glDisable( GL_TEXTURE_2D );
+                    }
+                    currTexture = texture;
+                }
             }
         }
 
@@ -633,6 +676,12 @@ void ModelX::DrawMesh( unsigned int index )
 
         glEnd();
     }
+
+    if ( currTexture != 0 )
+    {
+        glBindTexture( GL_TEXTURE_2D, 0 );
+        glDisable( GL_TEXTURE_2D );
+    }
 }
 
 //-----------------------------------------------------------------------------------------
@@ -644,6 +693,150 @@ void ModelX::Draw()
     { DrawMesh( i ); }
 }
 
+//-----------------------------------------------------------------------------------------
+//      テクスチャアトラスに合わせてテクスチャ座標を書き換えます.
+//-----------------------------------------------------------------------------------------
+unsigned int ModelX::ApplyAtlas( const TextureAtlas& atlas )
+{
+    const int materialCount = static_cast<int>( m_Materials.size() );
+    if ( materialCount == 0 )
+    { return 0; }
+
+    // マテリアルごとの配置情報を調べる.
+    std::vector<const AtlasRegion*> regions( materialCount, nullptr );
+    for( int i=0; i<materialCount; ++i )
+    {
+        const Material& material = m_Materials[i];
+        if ( material.texture.empty() )
+        { continue; }
+
+        const AtlasRegion* pRegion = atlas.FindRegion( material.texture );
+        if ( pRegion != nullptr && atlas.GetID( pRegion->page ) != 0 )
+        { regions[i] = pRegion; }
+    }
+
+    // タイリングしているマテリアルはアトラス上では再現できないので個別のまま残す.
+    for( size_t i=0; i<m_Meshes.size(); ++i )
+    {
+        const MeshX& mesh = m_Meshes[i];
+        for( size_t j=0; j<mesh.faces.size(); ++j )
+        {
+            const Face& face = mesh.faces[j];
+            if ( face.indexM < 0 || face.indexM >= materialCount || regions[face.indexM] == nullptr )
+            { continue; }
+
+            for( int k=0; k<face.element; ++k )
+            {
+                const int index = face.indexU[k];
+                if ( index < 0 || index >= static_cast<int>( mesh.texcoords.size() ) )
+                {
+                    regions[face.indexM] = nullptr;
+                    break;
+                }
+
+                const Vec2& uv = mesh.texcoords[index];
+                if ( uv.x < 0.0f || uv.x > 1.0f || uv.y < 0.0f || uv.y > 1.0f )
+                {
+                    regions[face.indexM] = nullptr;
+                    break;
+                }
+            }
+        }
+    }
+
+    unsigned int result = 0;
+    for( int i=0; i<materialCount; ++i )
+    {
+        if ( regions[i] != nullptr )
+        {
+            m_Materials[i].textureID = atlas.GetID( regions[i]->page );
+            result++;
+        }
+    }
+
+    // 同じ値のマテリアルは最初に現れたものにまとめる.
+    std::vector<int> canonical( materialCount );
+    for( int i=0; i<materialCount; ++i )
+    {
+        canonical[i] = i;
+        for( int j=0; j<i; ++j )
+        {
+            if ( canonical[j] == j && IsSameMaterial( m_Materials[i], m_Materials[j] ) )
+            {
+                canonical[i] = j;
+                break;
+            }
+        }
+    }
+
+    for( size_t i=0; i<m_Meshes.size(); ++i )
+    {
+        MeshX& mesh = m_Meshes[i];
+
+        // 書き換えたテクスチャ座標は (元の番号, 配置情報) ごとに1つだけ作る.
+        const std::vector<Vec2> texcoords( mesh.texcoords );
+        std::vector<const AtlasRegion*> owners( texcoords.size(), nullptr );
+        std::map<std::pair<int, const AtlasRegion*>, int> duplicates;
+
+        // アトラスを使わない面が参照するテクスチャ座標は元の値のまま残す.
+        const AtlasRegion original;
+        for( size_t j=0; j<mesh.faces.size(); ++j )
+        {
+            const Face& face = mesh.faces[j];
+            if ( face.indexM >= 0 && face.indexM < materialCount && regions[face.indexM] != nullptr )
+            { continue; }
+
+            for( int k=0; k<face.element; ++k )
+            {
+                const int index = face.indexU[k];
+                if ( index >= 0 && index < static_cast<int>( owners.size() ) )
+                { owners[index] = &original; }
+            }
+        }
+
+        for( size_t j=0; j<mesh.faces.size(); ++j )
+        {
+            Face& face = mesh.faces[j];
+            if ( face.indexM < 0 || face.indexM >= materialCount )
+            { continue; }
+
+            const AtlasRegion* pRegion = regions[face.indexM];
+            face.indexM = canonical[face.indexM];
+            if ( pRegion == nullptr )
+            { continue; }
+
+            for( int k=0; k<face.element; ++k )
+            {
+                int& index = face.indexU[k];
+                if ( owners[index] == pRegion )
+                { continue; }
+
+                if ( owners[index] == nullptr )
+                {
+                    mesh.texcoords[index] = pRegion->Remap( texcoords[index] );
+                    owners[index] = pRegion;
+                    continue;
+                }
+
+                // 別の画像で書き換え済み，または元の値が必要なテクスチャ座標は複製する.
+                const std::pair<int, const AtlasRegion*> key( index, pRegion );
+                std::map<std::pair<int, const AtlasRegion*>, int>::iterator itr = duplicates.find( key );
+                if ( itr == duplicates.end() )
+                {
+                    mesh.texcoords.push_back( pRegion->Remap( texcoords[index] ) );
+                    itr = duplicates.insert( std::make_pair( key, static_cast<int>( mesh.texcoords.size() - 1 ) ) ).first;
+                }
+                index = itr->second;
+            }
+        }
+
+        // マテリアル順に並べて切り替え回数を減らす.
+        std::stable_sort( mesh.faces.begin(), mesh.faces.end(), SortByMaterial() );
+    }
+
+    return result;
+}
+
 //-----------------------------------------------------------------------------------------
 //      メッシュを取得します.
 //-----------------------------------------------------------------------------------------
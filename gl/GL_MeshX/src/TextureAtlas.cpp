@@ -0,0 +1,557 @@
+﻿//------------------------------------------------------------------------------------------
+// File : TextureAtlas.cpp
+// Desc : Texture Atlas Builder.
+// Copyright(c) Project Asura. All right reserved.
+//------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------
+// Includes
+//------------------------------------------------------------------------------------------
+#include <TextureAtlas.h>
+#include <GL/freeglut.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+
+//------------------------------------------------------------------------------------------
+// Constant Values
+//------------------------------------------------------------------------------------------
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE        0x812F
+#endif//GL_CLAMP_TO_EDGE
+
+#ifndef GL_TEXTURE_MAX_LEVEL
+#define GL_TEXTURE_MAX_LEVEL    0x813D
+#endif//GL_TEXTURE_MAX_LEVEL
+
+
+namespace /* anonymous */ {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Placement structure
+////////////////////////////////////////////////////////////////////////////////////////////
+struct Placement
+{
+    unsigned int    image;      //!< 画像番号です.
+    unsigned int    page;       //!< ページ番号です.
+    unsigned int    x;          //!< ガターを含む矩形の左端です.
+    unsigned int    y;          //!< ガターを含む矩形の下端です.
+    unsigned int    width;      //!< ガターを含む矩形の横幅です.
+    unsigned int    height;     //!< ガターを含む矩形の縦幅です.
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// SortBySize structure
+////////////////////////////////////////////////////////////////////////////////////////////
+struct SortBySize
+{
+    const std::vector<Placement>& placements;
+
+    SortBySize( const std::vector<Placement>& value )
+    : placements( value )
+    { /* DO_NOTHING */ }
+
+    bool operator () ( unsigned int lhs, unsigned int rhs ) const
+    {
+        const Placement& a = placements[lhs];
+        const Placement& b = placements[rhs];
+        if ( a.height != b.height )
+        { return a.height > b.height; }
+        return a.width > b.width;
+    }
+
+private:
+    void operator = ( const SortBySize& );  // アクセス禁止.
+};
+
+//------------------------------------------------------------------------------------------
+//      alignの倍数に切り上げます.
+//------------------------------------------------------------------------------------------
+inline unsigned int AlignUp( unsigned int value, unsigned int align )
+{ return ( value + align - 1 ) / align * align; }
+
+//------------------------------------------------------------------------------------------
+//      2x2のボックスフィルタで縮小します.
+//------------------------------------------------------------------------------------------
+void Downsample( const unsigned char* pSrc, unsigned int srcSize, unsigned char* pDst )
+{
+    const unsigned int dstSize = srcSize / 2;
+    const size_t srcPitch = size_t( srcSize ) * 4;
+
+    for( unsigned int y=0; y<dstSize; ++y )
+    {
+        const unsigned char* pRow0 = pSrc + srcPitch * ( y * 2 );
+        const unsigned char* pRow1 = pRow0 + srcPitch;
+        unsigned char* pOut = pDst + size_t( dstSize ) * 4 * y;
+
+        for( unsigned int x=0; x<dstSize; ++x )
+        {
+            for( unsigned int c=0; c<4; ++c )
+            {
+                const unsigned int sum = pRow0[c] + pRow0[c + 4] + pRow1[c] + pRow1[c + 4];
+                pOut[c] = static_cast<unsigned char>( ( sum + 2 ) >> 2 );
+            }
+            pRow0 += 8;
+            pRow1 += 8;
+            pOut  += 4;
+        }
+    }
+}
+
+} // namespace /* anonymous */
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// TextureAtlas class
+////////////////////////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//------------------------------------------------------------------------------------------
+TextureAtlas::TextureAtlas()
+: m_Images   ()
+, m_Pages    ()
+, m_Regions  ()
+, m_PageSize ( 0 )
+, m_MipLevels( 0 )
+{ /* DO_NOTHING */ }
+
+//------------------------------------------------------------------------------------------
+//      デストラクタです.
+//------------------------------------------------------------------------------------------
+TextureAtlas::~TextureAtlas()
+{ Release(); }
+
+//------------------------------------------------------------------------------------------
+//      アトラスに詰める画像を追加します.
+//------------------------------------------------------------------------------------------
+bool TextureAtlas::AddImage
+(
+    const std::string&      name,
+    unsigned int            width,
+    unsigned int            height,
+    const unsigned char*    pPixels
+)
+{
+    if ( pPixels == nullptr || width == 0 || height == 0 )
+    { return false; }
+
+    // 同じテクスチャを複数のマテリアルが参照している場合は1つだけ詰める.
+    for( size_t i=0; i<m_Images.size(); ++i )
+    {
+        if ( m_Images[i].name == name )
+        { return true; }
+    }
+
+    // ページは最大でも 2^15 四方なので，それを超える画像はどのみち詰められない.
+    if ( width > 32768 || height > 32768 )
+    {
+        std::cerr << "Error : Image Too Large For Atlas. name = " << name << std::endl;
+        return false;
+    }
+
+    Image image;
+    image.name   = name;
+    image.width  = width;
+    image.height = height;
+    image.pixels.assign( pPixels, pPixels + size_t( width ) * height * 4 );
+    m_Images.push_back( image );
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+//      追加した画像をページに詰めてアトラスを構築します.
+//------------------------------------------------------------------------------------------
+bool TextureAtlas::Build( unsigned int pageSize, unsigned int padding, unsigned int mipLevels )
+{
+    DeleteGLTextures();
+    m_Pages  .clear();
+    m_Regions.clear();
+    m_PageSize  = 0;
+    m_MipLevels = 0;
+
+    if ( pageSize == 0 || pageSize > 32768 || ( pageSize & ( pageSize - 1 ) ) != 0 )
+    {
+        std::cerr << "Error : Invalid Atlas Page Size. pageSize = " << pageSize << std::endl;
+        return false;
+    }
+
+    // ミップレベル数はページの一辺が1になるまでに制限する.
+    unsigned int maxLevels = 1;
+    while( ( pageSize >> ( maxLevels - 1 ) ) > 1 )
+    { maxLevels++; }
+    if ( mipLevels == 0 )
+    { mipLevels = 1; }
+    if ( mipLevels > maxLevels )
+    { mipLevels = maxLevels; }
+
+    // 最も小さいミップで 1 テクセルとなる単位に配置とガターを揃える.
+    const unsigned int align = 1u << ( mipLevels - 1 );
+    const unsigned int gutter = AlignUp( std::max( padding, align ), align );
+
+    std::vector<Placement> placements( m_Images.size() );
+    std::vector<unsigned int> order( m_Images.size() );
+    for( size_t i=0; i<m_Images.size(); ++i )
+    {
+        const Image& image = m_Images[i];
+        Placement& placement = placements[i];
+        placement.image  = static_cast<unsigned int>( i );
+        placement.page   = 0;
+        placement.x      = 0;
+        placement.y      = 0;
+        placement.width  = AlignUp( image.width  + gutter * 2, align );
+        placement.height = AlignUp( image.height + gutter * 2, align );
+        order[i] = static_cast<unsigned int>( i );
+
+        if ( placement.width > pageSize || placement.height > pageSize )
+        {
+            std::cerr << "Error : Image Too Large For Atlas. name = " << image.name << std::endl;
+            return false;
+        }
+    }
+
+    // 高さの大きい順に詰めるとスカイラインの段差が少なくなる.
+    std::stable_sort( order.begin(), order.end(), SortBySize( placements ) );
+
+    for( size_t i=0; i<order.size(); ++i )
+    {
+        Placement& placement = placements[order[i]];
+
+        // 既存のページのうち，最も低い位置に置けるものを選ぶ.
+        bool         found     = false;
+        unsigned int bestPage  = 0;
+        unsigned int bestIndex = 0;
+        unsigned int bestY     = 0;
+        for( size_t j=0; j<m_Pages.size(); ++j )
+        {
+            unsigned int index = 0;
+            unsigned int y     = 0;
+            if ( !FindPosition( m_Pages[j], placement.width, placement.height, index, y ) )
+            { continue; }
+
+            if ( !found || y < bestY )
+            {
+                found     = true;
+                bestPage  = static_cast<unsigned int>( j );
+                bestIndex = index;
+                bestY     = y;
+            }
+        }
+
+        if ( !found )
+        {
+            Page page;
+            SkylineNode node;
+            node.x     = 0;
+            node.y     = 0;
+            node.width = pageSize;
+            page.skyline.push_back( node );
+            page.id = 0;
+            m_Pages.push_back( page );
+
+            bestPage  = static_cast<unsigned int>( m_Pages.size() - 1 );
+            bestIndex = 0;
+            bestY     = 0;
+        }
+
+        Page& page = m_Pages[bestPage];
+        placement.page = bestPage;
+        placement.x    = page.skyline[bestIndex].x;
+        placement.y    = bestY;
+        AddSkyline( page, bestIndex, placement.width, placement.height, bestY );
+    }
+
+    // ページのピクセルを生成.
+    const size_t pagePitch = size_t( pageSize ) * 4;
+    for( size_t i=0; i<m_Pages.size(); ++i )
+    {
+        m_Pages[i].mips.resize( mipLevels );
+        m_Pages[i].mips[0].assign( pagePitch * pageSize, 0 );
+    }
+
+    for( size_t i=0; i<placements.size(); ++i )
+    {
+        const Placement& placement = placements[i];
+        const Image&     image     = m_Images[placement.image];
+        unsigned char*   pPage     = &m_Pages[placement.page].mips[0][0];
+
+        // ガターは画像の端を引き延ばして埋め，バイリニアやミップで背景が混ざらないようにする.
+        const int left   = static_cast<int>( placement.x + gutter );
+        const int bottom = static_cast<int>( placement.y + gutter );
+        const int maxX   = static_cast<int>( image.width  ) - 1;
+        const int maxY   = static_cast<int>( image.height ) - 1;
+        for( unsigned int y=0; y<placement.height; ++y )
+        {
+            const int sy = std::min( std::max( static_cast<int>( placement.y + y ) - bottom, 0 ), maxY );
+            const unsigned char* pSrcRow = &image.pixels[ size_t( sy ) * image.width * 4 ];
+            unsigned char* pDst = pPage + pagePitch * ( placement.y + y ) + size_t( placement.x ) * 4;
+
+            for( unsigned int x=0; x<placement.width; ++x )
+            {
+                const int sx = std::min( std::max( static_cast<int>( placement.x + x ) - left, 0 ), maxX );
+                memcpy( pDst, pSrcRow + sx * 4, 4 );
+                pDst += 4;
+            }
+        }
+
+        AtlasRegion region;
+        region.page     = placement.page;
+        region.x        = placement.x + gutter;
+        region.y        = placement.y + gutter;
+        region.width    = image.width;
+        region.height   = image.height;
+        region.scale    = Vec2( float( image.width ) / pageSize, float( image.height ) / pageSize );
+        region.offset   = Vec2( float( region.x ) / pageSize, float( region.y ) / pageSize );
+        m_Regions[image.name] = region;
+    }
+
+    // 矩形はalign単位に揃っているので，ボックスフィルタでも隣の矩形は混ざらない.
+    for( size_t i=0; i<m_Pages.size(); ++i )
+    {
+        Page& page = m_Pages[i];
+        for( unsigned int level=1; level<mipLevels; ++level )
+        {
+            const unsigned int size = pageSize >> level;
+            page.mips[level].resize( size_t( size ) * size * 4 );
+            Downsample( &page.mips[level - 1][0], size * 2, &page.mips[level][0] );
+        }
+    }
+
+    m_PageSize  = pageSize;
+    m_MipLevels = mipLevels;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+//      配置可能な位置を探します.
+//------------------------------------------------------------------------------------------
+bool TextureAtlas::FindPosition
+(
+    const Page&     page,
+    unsigned int    width,
+    unsigned int    height,
+    unsigned int&   bestIndex,
+    unsigned int&   bestY
+) const
+{
+    const unsigned int pageSize = ( page.skyline.empty() ) ? 0 : page.skyline.back().x + page.skyline.back().width;
+    bool found = false;
+    unsigned int bestWidth = 0;
+
+    for( size_t i=0; i<page.skyline.size(); ++i )
+    {
+        const unsigned int x = page.skyline[i].x;
+        if ( x + width > pageSize )
+        { break; }
+
+        // 矩形がまたがる区間のうち最も高い位置に置く.
+        unsigned int y    = 0;
+        unsigned int rest = width;
+        for( size_t j=i; rest > 0; ++j )
+        {
+            y = std::max( y, page.skyline[j].y );
+            rest -= std::min( rest, page.skyline[j].width );
+        }
+
+        if ( y + height > pageSize )
+        { continue; }
+
+        // 下端が低い位置を優先し，同じ高さなら狭い区間を埋める.
+        if ( !found || y < bestY || ( y == bestY && page.skyline[i].width < bestWidth ) )
+        {
+            found     = true;
+            bestIndex = static_cast<unsigned int>( i );
+            bestY     = y;
+            bestWidth = page.skyline[i].width;
+        }
+    }
+
+    return found;
+}
+
+//------------------------------------------------------------------------------------------
+//      配置した矩形でスカイラインを更新します.
+//------------------------------------------------------------------------------------------
+void TextureAtlas::AddSkyline
+(
+    Page&           page,
+    unsigned int    index,
+    unsigned int    width,
+    unsigned int    height,
+    unsigned int    y
+)
+{
+    SkylineNode node;
+    node.x     = page.skyline[index].x;
+    node.y     = y + height;
+    node.width = width;
+    page.skyline.insert( page.skyline.begin() + index, node );
+
+    // 新しい区間に隠れた区間を削る.
+    const unsigned int right = node.x + node.width;
+    size_t i = index + 1;
+    while( i < page.skyline.size() )
+    {
+        SkylineNode& next = page.skyline[i];
+        if ( next.x >= right )
+        { break; }
+
+        const unsigned int shrink = right - next.x;
+        if ( next.width <= shrink )
+        {
+            page.skyline.erase( page.skyline.begin() + i );
+            continue;
+        }
+
+        next.x     += shrink;
+        next.width -= shrink;
+        break;
+    }
+
+    // 同じ高さの隣接区間を結合する.
+    for( size_t j=0; j + 1 < page.skyline.size(); )
+    {
+        if ( page.skyline[j].y == page.skyline[j + 1].y )
+        {
+            page.skyline[j].width += page.skyline[j + 1].width;
+            page.skyline.erase( page.skyline.begin() + j + 1 );
+        }
+        else
+        { ++j; }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+//      ページごとのGLテクスチャを生成します.
+//------------------------------------------------------------------------------------------
+bool TextureAtlas::CreateGLTextures()
+{
+    if ( m_Pages.empty() )
+    { return false; }
+
+    DeleteGLTextures();
+
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+
+    for( size_t i=0; i<m_Pages.size(); ++i )
+    {
+        Page& page = m_Pages[i];
+
+        //　テクスチャを生成
+        glGenTextures( 1, &page.id );
+        glBindTexture( GL_TEXTURE_2D, page.id );
+
+        //　テクスチャの割り当て
+        for( unsigned int level=0; level<m_MipLevels; ++level )
+        {
+            const unsigned int size = m_PageSize >> level;
+            glTexImage2D(
+                GL_TEXTURE_2D,
+                int( level ),
+                GL_RGBA,
+                size,
+                size,
+                0,
+                GL_RGBA,
+                GL_UNSIGNED_BYTE,
+                &page.mips[level][0] );
+        }
+
+        // ガターを用意したレベルより小さいミップは参照させない.
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, int( m_MipLevels - 1 ) );
+
+        //　テクスチャを拡大・縮小する方法の指定
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, ( m_MipLevels > 1 ) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+    }
+
+    // アンバインドしておく.
+    glBindTexture( GL_TEXTURE_2D, 0 );
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+//      GLテクスチャを破棄します.
+//------------------------------------------------------------------------------------------
+void TextureAtlas::DeleteGLTextures()
+{
+    for( size_t i=0; i<m_Pages.size(); ++i )
+    {
+        if ( m_Pages[i].id )
+        {
+            glDeleteTextures( 1, &m_Pages[i].id );
+            m_Pages[i].id = 0;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+//      解放処理を行います.
+//------------------------------------------------------------------------------------------
+void TextureAtlas::Release()
+{
+    DeleteGLTextures();
+    m_Images .clear();
+    m_Pages  .clear();
+    m_Regions.clear();
+    m_PageSize  = 0;
+    m_MipLevels = 0;
+}
+
+//------------------------------------------------------------------------------------------
+//      画像の配置情報を検索します.
+//------------------------------------------------------------------------------------------
+const AtlasRegion* TextureAtlas::FindRegion( const std::string& name ) const
+{
+    std::map<std::string, AtlasRegion>::const_iterator itr = m_Regions.find( name );
+    if ( itr == m_Regions.end() )
+    { return nullptr; }
+
+    return &itr->second;
+}
+
+//------------------------------------------------------------------------------------------
+//      ページ数を取得します.
+//------------------------------------------------------------------------------------------
+unsigned int TextureAtlas::GetPageCount() const
+{ return static_cast<unsigned int>( m_Pages.size() ); }
+
+//------------------------------------------------------------------------------------------
+//      ページの一辺のサイズを取得します.
+//------------------------------------------------------------------------------------------
+unsigned int TextureAtlas::GetPageSize() const
+{ return m_PageSize; }
+
+//------------------------------------------------------------------------------------------
+//      ミップレベル数を取得します.
+//------------------------------------------------------------------------------------------
+unsigned int TextureAtlas::GetMipLevels() const
+{ return m_MipLevels; }
+
+//------------------------------------------------------------------------------------------
+//      ページのピクセルデータを取得します.
+//------------------------------------------------------------------------------------------
+const unsigned char* TextureAtlas::GetPagePixels( unsigned int page, unsigned int mipLevel ) const
+{
+    if ( page >= m_Pages.size() || mipLevel >= m_MipLevels )
+    { return nullptr; }
+
+    return &m_Pages[page].mips[mipLevel][0];
+}
+
+//------------------------------------------------------------------------------------------
+//      ページのテクスチャIDを取得します.
+//------------------------------------------------------------------------------------------
+unsigned int TextureAtlas::GetID( unsigned int page ) const
+{
+    if ( page >= m_Pages.size() )
+    { return 0; }
+
+    return m_Pages[page].id;
+}
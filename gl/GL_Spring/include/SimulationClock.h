@@ -0,0 +1,88 @@
+﻿//------------------------------------------------------------------------------------------
+// File : SimulationClock.h
+// Desc : Fixed Time Step Simulation Clock Module.
+// Copyright(c) Project Asura. All right reserved.
+//------------------------------------------------------------------------------------------
+
+#ifndef __SIMULATION_CLOCK_H__
+#define __SIMULATION_CLOCK_H__
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// SimulationClock class
+////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief      経過時間を蓄積して，固定の微小時間で何ステップ進めるかを求めるクラスです.
+//!
+//! @note       1回の Advance() で進めるステップ数は上限で打ち切り，処理が追いつかない分の時間は
+//!             捨てます. 捨てずに持ち越すと次のフレームもさらに遅れて発散するためです.
+//!             ステップに満たない残りの時間は GetAlpha() で補間係数として取得できます.
+////////////////////////////////////////////////////////////////////////////////////////////
+class SimulationClock
+{
+    //======================================================================================
+    // list of friend classes and methods.
+    //======================================================================================
+    /* NOTHING */
+
+public:
+    //======================================================================================
+    // public variables.
+    //======================================================================================
+    /* NOTHING */
+
+    //======================================================================================
+    // public methods.
+    //======================================================================================
+    SimulationClock();
+    virtual ~SimulationClock();
+
+    void Reset();
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      経過時間を蓄積し，進めるステップ数を返却します.
+    //!
+    //! @param [in]     elapsedTime     前回の呼び出しからの経過時間(秒)です.
+    //! @return     進めるステップ数を返却します. SetMaxSubstep() で設定した値を超えません.
+    //--------------------------------------------------------------------------------------
+    unsigned int Advance( const double elapsedTime );
+
+    void SetTimeStep  ( const double value );
+    void SetMaxSubstep( const unsigned int value );
+
+    double       GetTimeStep   () const;
+    unsigned int GetMaxSubstep () const;
+    double       GetAccumulator() const;
+    double       GetAlpha      () const;
+    double       GetTime       () const;
+    double       GetDroppedTime() const;
+
+protected:
+    //======================================================================================
+    // protected variables.
+    //======================================================================================
+    double          m_TimeStep;         //!< 1ステップの時間です.
+    unsigned int    m_MaxSubstep;       //!< 1回の Advance() で進める最大ステップ数です.
+    double          m_Accumulator;      //!< まだステップに変換していない時間です.
+    double          m_Time;             //!< 進めたステップの合計時間です.
+    double          m_DroppedTime;      //!< 上限を超えて捨てた時間の合計です.
+
+    //======================================================================================
+    // protected methods.
+    //======================================================================================
+    /* NOTHING */
+
+private:
+    //======================================================================================
+    // private variables.
+    //======================================================================================
+    /* NOTHING */
+
+    //======================================================================================
+    // private methods.
+    //======================================================================================
+    SimulationClock ( const SimulationClock& value );   // アクセス禁止.
+    void operator = ( const SimulationClock& value );   // アクセス禁止.
+};
+
+
+#endif//__SIMULATION_CLOCK_H__
@@ -0,0 +1,133 @@
+﻿//------------------------------------------------------------------------------------------
+// File : SpatialHash.h
+// Desc : Uniform Grid Spatial Hash Module.
+// Copyright(c) Project Asura. All right reserved.
+//------------------------------------------------------------------------------------------
+
+#ifndef __SPATIAL_HASH_H__
+#define __SPATIAL_HASH_H__
+
+//------------------------------------------------------------------------------------------
+// Includes
+//------------------------------------------------------------------------------------------
+#include <TinyMath.h>
+#include <ThreadPool.h>
+#include <vector>
+#include <cstddef>
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// SpatialHash class
+////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief      空間を一様な格子に分け，格子のハッシュ値で質点を検索するクラスです.
+//!
+//! @note       Build() は質点をハッシュ値で基数ソート(計数ソートの繰り返し)します. 各パスは
+//!             チャンクごとの度数分布を並列に数え，チャンク順の累積和で書き込み先を決めるので，
+//!             安定でスレッド数に関係なく同じ並びになります.
+//!             ハッシュ値は x 方向に隣接する格子で連続するようにしてあるので，隣接する3つの格子は
+//!             ソート後の配列の1つの範囲になり，近傍は最大9つの範囲を走査するだけで済みます.
+//!             別の格子が同じハッシュ値になることがあるので，距離の判定は呼び出し側で行ってください.
+////////////////////////////////////////////////////////////////////////////////////////////
+class SpatialHash
+{
+    //======================================================================================
+    // list of friend classes and methods.
+    //======================================================================================
+    /* NOTHING */
+
+public:
+    //======================================================================================
+    // public variables.
+    //======================================================================================
+    static const unsigned int INVALID_INDEX = 0xffffffff;  //!< 空のバケットを表す値です.
+    static const unsigned int MAX_RANGE     = 18;          //!< 近傍の範囲の最大数です(折り返しで9つが分かれる場合を含む).
+
+    //======================================================================================
+    // public methods.
+    //======================================================================================
+    SpatialHash();
+    virtual ~SpatialHash();
+
+    void Clear();
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      質点を格子に登録し直します.
+    //!
+    //! @param [in]     pPositions  質点の位置の配列です.
+    //! @param [in]     count       質点の数です.
+    //! @param [in]     cellSize    格子の1辺の長さです. 検索する距離以上にしてください.
+    //! @param [in]     pPool       スレッドプールです. nullptr の場合は呼び出し元で処理します.
+    //--------------------------------------------------------------------------------------
+    void Build( const Vec3* pPositions, const size_t count, const float cellSize, ThreadPool* pPool );
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      位置を含む格子と隣接する26個の格子に入っている要素の範囲を重複なく列挙します.
+    //!
+    //! @param [in]     position    位置です.
+    //! @param [out]    pBegin      範囲の先頭のソート後の番号を格納する配列です. MAX_RANGE 個必要です.
+    //! @param [out]    pEnd        範囲の終端のソート後の番号を格納する配列です. MAX_RANGE 個必要です.
+    //! @return     列挙した範囲の数を返却します.
+    //--------------------------------------------------------------------------------------
+    unsigned int FindNeighborRanges( const Vec3& position, unsigned int* pBegin, unsigned int* pEnd ) const;
+
+    size_t              GetCount          () const;
+    float               GetCellSize       () const;
+    unsigned int        GetBucketCount    () const;
+    const unsigned int* GetKeys           () const;
+    const unsigned int* GetIndices        () const;
+    const Vec3*         GetSortedPositions() const;
+
+protected:
+    //======================================================================================
+    // protected variables.
+    //======================================================================================
+    const Vec3*                 m_pPositions;       //!< 登録した質点の位置です.
+    size_t                      m_Count;            //!< 登録した質点の数です.
+    float                       m_CellSize;         //!< 格子の1辺の長さです.
+    float                       m_InvCellSize;      //!< 格子の1辺の長さの逆数です.
+    unsigned int                m_BucketBits;       //!< バケット数の2の指数です.
+    unsigned int                m_ChunkCount;       //!< ソートに使うチャンクの数です.
+    unsigned int                m_Shift;            //!< ソート中のパスで使うキーのシフト量です.
+    std::vector<unsigned int>   m_Keys;             //!< ソート済みのハッシュ値です.
+    std::vector<unsigned int>   m_Indices;          //!< ソート済みの質点の番号です.
+    std::vector<unsigned int>   m_TempKeys;         //!< ソート用の作業領域です.
+    std::vector<unsigned int>   m_TempIndices;      //!< ソート用の作業領域です.
+    std::vector<unsigned int>   m_Histogram;        //!< チャンクごとの度数分布と書き込み先です.
+    std::vector<unsigned int>   m_BucketBegin;      //!< バケットごとの最初の要素の番号です.
+    std::vector<Vec3>           m_SortedPositions;  //!< ソート後の順に並べた位置です.
+
+    //======================================================================================
+    // protected methods.
+    //======================================================================================
+    unsigned int CalcBucket( const int x, const int y, const int z ) const;
+    void         CalcCell  ( const Vec3& position, int& x, int& y, int& z ) const;
+
+    void ComputeKeys     ( const size_t begin, const size_t end );
+    void CountDigits     ( const size_t begin, const size_t end );
+    void ScatterDigits   ( const size_t begin, const size_t end );
+    void ClearBuckets    ( const size_t begin, const size_t end );
+    void FindBuckets     ( const size_t begin, const size_t end );
+    void GatherPositions ( const size_t begin, const size_t end );
+
+    static void ComputeKeysJob     ( size_t begin, size_t end, void* pUser );
+    static void CountDigitsJob     ( size_t begin, size_t end, void* pUser );
+    static void ScatterDigitsJob   ( size_t begin, size_t end, void* pUser );
+    static void ClearBucketsJob    ( size_t begin, size_t end, void* pUser );
+    static void FindBucketsJob     ( size_t begin, size_t end, void* pUser );
+    static void GatherPositionsJob ( size_t begin, size_t end, void* pUser );
+
+private:
+    //======================================================================================
+    // private variables.
+    //======================================================================================
+    /* NOTHING */
+
+    //======================================================================================
+    // private methods.
+    //======================================================================================
+    SpatialHash     ( const SpatialHash& value );   // アクセス禁止.
+    void operator = ( const SpatialHash& value );   // アクセス禁止.
+};
+
+
+#endif//__SPATIAL_HASH_H__
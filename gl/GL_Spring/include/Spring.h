@@ -20,12 +20,23 @@ enum SIMULATION_TYPE
 {
     SIMULATION_TYPE_EXPLICIT_EULAR = 0,     //!< 陽的オイラー法.
     SIMULATION_TYPE_VERLET,                 //!< ベルレ法.
+    SIMULATION_TYPE_SEMI_IMPLICIT_EULAR,    //!< 半陰的(シンプレクティック)オイラー法.
+    SIMULATION_TYPE_RUNGE_KUTTA4,           //!< 4次のルンゲ・クッタ法.
+    SIMULATION_TYPE_IMPLICIT_EULAR,         //!< 陰的(後退)オイラー法.
+    SIMULATION_TYPE_XPBD,                   //!< 拡張位置ベース法(XPBD). ばねを適合度付きの距離拘束として解きます.
 };
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 // Spring1D class
 ////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief      1次元のばねをシミュレーションするクラスです.
+//!
+//! @note       Update() は SetTimeStep() で設定した固定の微小時間で1ステップ進めます.
+//!             Advance() は埋め込み型ルンゲ・クッタ法の誤差推定から刻み幅を調整しながら進めます.
+//!             SIMULATION_TYPE_XPBD は固定点との距離拘束を適合度 1 / k で1回だけ射影します.
+//!             拘束が線形なので1回で収束し，結果は陰的オイラー法と(丸め誤差を除いて)一致します.
+////////////////////////////////////////////////////////////////////////////////////////////
 class Spring1D
 {
     //======================================================================================
@@ -45,13 +56,15 @@ public:
     Spring1D();
     virtual ~Spring1D();
 
-    void SetMass        ( const double value );
-    void SetGravity     ( const double value );
-    void SetTimeStep    ( const double value );
-    void SetLength      ( const double value );
-    void SetConstantK   ( const double value );
-    void SetInitVelocity( const double value );
-    void SetInitPosition( const double value );
+    void SetMass         ( const double value );
+    void SetGravity      ( const double value );
+    void SetTimeStep     ( const double value );
+    void SetLength       ( const double value );
+    void SetConstantK    ( const double value );
+    void SetInitVelocity ( const double value );
+    void SetInitPosition ( const double value );
+    void SetTolerance    ( const double value );
+    void SetTimeStepRange( const double minValue, const double maxValue );
 
     double GetMass      () const;
     double GetGravity   () const;
@@ -59,9 +72,29 @@ public:
     double GetLength    () const;
     double GetConstantK () const;
     double GetPosition  () const;
+    double GetVelocity  () const;
+    double GetTolerance () const;
+
+    double             GetMinTimeStep     () const;
+    double             GetMaxTimeStep     () const;
+    double             GetAdaptiveTimeStep() const;
+    unsigned long long GetAcceptCount     () const;
+    unsigned long long GetRejectCount     () const;
 
     void Update( SIMULATION_TYPE type );
 
+    //--------------------------------------------------------------------------------------
+    //! @brief      刻み幅を調整しながら指定時間だけ進めます.
+    //!
+    //! @param [in]     duration    進める時間です.
+    //! @return     受理したステップ数を返却します.
+    //! @note       Dormand-Prince 5(4) 法の誤差推定を使い，PI制御で次の刻み幅を決めます.
+    //!             刻み幅は SetTimeStepRange() の範囲に収めます. ただし最後のステップは
+    //!             duration の終わりに合わせるため最小値を下回ることがあります.
+    //!             最小値でも誤差が許容値を超える場合はそのまま受理します.
+    //--------------------------------------------------------------------------------------
+    unsigned int Advance( const double duration );
+
 protected:
     //======================================================================================
     // protected variables.
@@ -78,14 +111,28 @@ protected:
     double  m_Velocity;         //!< 速度です.
     double  m_Position;         //!< 位置です.
     double  m_Force;            //!< 力です.
-    double  m_PrevPosition;
+    double  m_PrevPosition;     //!< 前の位置です.
+    double  m_Tolerance;        //!< Advance() の1ステップあたりの許容誤差です.
+    double  m_MinTimeStep;      //!< Advance() の刻み幅の最小値です.
+    double  m_MaxTimeStep;      //!< Advance() の刻み幅の最大値です.
+    double  m_AdaptiveTimeStep; //!< Advance() で次に試す刻み幅です. 0の場合は m_TimeStep から始めます.
+    double  m_PrevError;        //!< 前回受理したステップの誤差です(PI制御用).
+
+    unsigned long long  m_AcceptCount;  //!< Advance() で受理したステップの合計です.
+    unsigned long long  m_RejectCount;  //!< Advance() で棄却したステップの合計です.
 
     //======================================================================================
     // protected methods.
     //======================================================================================
     void IntegrateExplicitEular();
+    void IntegrateSemiImplicitEular();
     void IntegrateVerlet();
+    void IntegrateRungeKutta4();
+    void IntegrateImplicitEular();
+    void IntegrateXPBD();
     void UpdateAccel();
+    double CalcAccel( const double position ) const;
+    double TryDormandPrince( const double dt, double& position, double& velocity ) const;
 
 private:
     //======================================================================================
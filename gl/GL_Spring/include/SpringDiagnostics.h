@@ -0,0 +1,334 @@
+﻿//------------------------------------------------------------------------------------------
+// File : SpringDiagnostics.h
+// Desc : Spring Simulation Diagnostics Module.
+// Copyright(c) Project Asura. All right reserved.
+//------------------------------------------------------------------------------------------
+
+#ifndef __SPRING_DIAGNOSTICS_H__
+#define __SPRING_DIAGNOSTICS_H__
+
+//------------------------------------------------------------------------------------------
+// Includes
+//------------------------------------------------------------------------------------------
+#include <Spring.h>
+#include <SpringSystem.h>
+#include <SpringNetwork.h>
+#include <cstddef>
+
+// 0 を定義すると DiagnosticsDefault は何も計測しません.
+#ifndef SPRING_ENABLE_DIAGNOSTICS
+    #define SPRING_ENABLE_DIAGNOSTICS   1
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// SpringSample structure
+////////////////////////////////////////////////////////////////////////////////////////////
+struct SpringSample
+{
+    unsigned long long  step;               //!< 計測したステップ番号です(0始まり).
+    double              time;               //!< 計測した時刻です.
+    double              kinetic;            //!< 運動エネルギーです.
+    double              potential;          //!< ばねと重力による位置エネルギーです.
+    double              maxDisplacement;    //!< 自然長からの伸縮量の絶対値の最大値です.
+    double              maxVelocity;        //!< 速さの最大値です.
+    unsigned int        invalidCount;       //!< 位置・速度・エネルギーが NaN または Inf になった質点の数です.
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// SpringSummary structure
+////////////////////////////////////////////////////////////////////////////////////////////
+struct SpringSummary
+{
+    unsigned long long  sampleCount;        //!< 計測したステップ数です.
+    double              initialEnergy;      //!< 最初に計測した全エネルギーです.
+    double              lastEnergy;         //!< 最後に計測した全エネルギーです.
+    double              maxDrift;           //!< 全エネルギーの相対誤差の最大値です.
+    double              maxDisplacement;    //!< 伸縮量の絶対値の最大値です.
+    double              maxVelocity;        //!< 速さの最大値です.
+    unsigned long long  invalidStep;        //!< 最初に NaN または Inf を検出したステップです.
+    bool                diverged;           //!< NaN または Inf を検出した場合は true.
+};
+
+
+//------------------------------------------------------------------------------------------
+// Type Definitions
+//------------------------------------------------------------------------------------------
+typedef void (*SpringSampleCallback)( const SpringSample& sample, void* pUser );
+
+
+//------------------------------------------------------------------------------------------
+//! @brief      ばねの状態を計測します.
+//!
+//! @note       位置エネルギーは重力の向きを負とした高さを基準にします. 固定点は数えません.
+//------------------------------------------------------------------------------------------
+void MeasureSpring( const Spring1D&      spring,  SpringSample& sample );
+void MeasureSpring( const SpringSystem&  system,  SpringSample& sample );
+void MeasureSpring( const SpringNetwork& network, SpringSample& sample );
+
+//------------------------------------------------------------------------------------------
+//! @brief      有限の値かどうかチェックします. NaN と Inf の場合は false を返却します.
+//------------------------------------------------------------------------------------------
+inline bool IsFinite( const double value )
+{ return ( value - value ) == 0.0; }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// DiagnosticsEnabled structure
+////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief      ステップごとに計測するポリシーです.
+////////////////////////////////////////////////////////////////////////////////////////////
+struct DiagnosticsEnabled
+{ enum { ENABLED = 1 }; };
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// DiagnosticsDisabled structure
+////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief      何も計測しないポリシーです. 全てのメソッドが空になり，メモリも使いません.
+////////////////////////////////////////////////////////////////////////////////////////////
+struct DiagnosticsDisabled
+{ enum { ENABLED = 0 }; };
+
+
+#if SPRING_ENABLE_DIAGNOSTICS
+typedef DiagnosticsEnabled      DiagnosticsDefault;
+#else
+typedef DiagnosticsDisabled     DiagnosticsDefault;
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// SpringDiagnostics class
+////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief      ステップごとにエネルギーと安定性を計測し，直近の結果を保持するクラスです.
+//!
+//! @note       Record() はシミュレーションを進めたスレッドから呼び出してください.
+//!             直近 CAPACITY ステップ分の計測結果をリングバッファに保持し，全体の最大値などは
+//!             GetSummary() で取得できます. コールバックは Record() の中から呼び出されます.
+////////////////////////////////////////////////////////////////////////////////////////////
+template<typename POLICY = DiagnosticsDefault, size_t CAPACITY = 256>
+class SpringDiagnostics
+{
+    //======================================================================================
+    // list of friend classes and methods.
+    //======================================================================================
+    /* NOTHING */
+
+public:
+    //======================================================================================
+    // public variables.
+    //======================================================================================
+    /* NOTHING */
+
+    //======================================================================================
+    // public methods.
+    //======================================================================================
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //--------------------------------------------------------------------------------------
+    SpringDiagnostics()
+    : m_pCallback   ( nullptr )
+    , m_pUser       ( nullptr )
+    { Reset(); }
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //--------------------------------------------------------------------------------------
+    virtual ~SpringDiagnostics()
+    { /* DO_NOTHING */ }
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      計測結果を破棄します. コールバックはそのまま残ります.
+    //--------------------------------------------------------------------------------------
+    void Reset()
+    {
+        m_Head  = 0;
+        m_Count = 0;
+        m_Time  = 0.0;
+
+        m_Summary.sampleCount     = 0;
+        m_Summary.initialEnergy   = 0.0;
+        m_Summary.lastEnergy      = 0.0;
+        m_Summary.maxDrift        = 0.0;
+        m_Summary.maxDisplacement = 0.0;
+        m_Summary.maxVelocity     = 0.0;
+        m_Summary.invalidStep     = 0;
+        m_Summary.diverged        = false;
+    }
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      計測するたびに呼び出すコールバックを設定します.
+    //--------------------------------------------------------------------------------------
+    void SetCallback( SpringSampleCallback pCallback, void* pUser )
+    {
+        m_pCallback = pCallback;
+        m_pUser     = pUser;
+    }
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      1ステップ進めた後の状態を計測します.
+    //!
+    //! @param [in]     model       Spring1D, SpringSystem, SpringNetwork のいずれかです.
+    //--------------------------------------------------------------------------------------
+    template<typename MODEL>
+    void Record( const MODEL& model )
+    {
+        SpringSample& sample = m_Samples[m_Head];
+        MeasureSpring( model, sample );
+
+        m_Time     += model.GetTimeStep();
+        sample.step = m_Summary.sampleCount;
+        sample.time = m_Time;
+
+        m_Head = ( m_Head + 1 ) % CAPACITY;
+        if ( m_Count < CAPACITY )
+        { m_Count++; }
+
+        Accumulate( sample );
+
+        if ( m_pCallback != nullptr )
+        { m_pCallback( sample, m_pUser ); }
+    }
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      リングバッファに残っている計測結果の数を取得します.
+    //--------------------------------------------------------------------------------------
+    size_t GetSampleCount() const
+    { return m_Count; }
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      リングバッファから計測結果を取得します. 0 が最も古い結果です.
+    //--------------------------------------------------------------------------------------
+    bool GetSample( const size_t index, SpringSample& sample ) const
+    {
+        if ( index >= m_Count )
+        { return false; }
+
+        sample = m_Samples[( m_Head + CAPACITY - m_Count + index ) % CAPACITY];
+        return true;
+    }
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      最新の計測結果を取得します.
+    //--------------------------------------------------------------------------------------
+    bool GetLatestSample( SpringSample& sample ) const
+    { return ( m_Count > 0 ) ? GetSample( m_Count - 1, sample ) : false; }
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      Reset() からの集計結果を取得します.
+    //--------------------------------------------------------------------------------------
+    SpringSummary GetSummary() const
+    { return m_Summary; }
+
+protected:
+    //======================================================================================
+    // protected variables.
+    //======================================================================================
+    SpringSample            m_Samples[CAPACITY];    //!< 計測結果のリングバッファです.
+    size_t                  m_Head;                 //!< 次に書き込む位置です.
+    size_t                  m_Count;                //!< リングバッファに残っている数です.
+    double                  m_Time;                 //!< 計測した時刻です.
+    SpringSummary           m_Summary;              //!< 集計結果です.
+    SpringSampleCallback    m_pCallback;            //!< コールバックです.
+    void*                   m_pUser;                //!< コールバックに渡すユーザーデータです.
+
+    //======================================================================================
+    // protected methods.
+    //======================================================================================
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      計測結果を集計します.
+    //--------------------------------------------------------------------------------------
+    void Accumulate( const SpringSample& sample )
+    {
+        const double energy = sample.kinetic + sample.potential;
+        if ( m_Summary.sampleCount == 0 )
+        { m_Summary.initialEnergy = energy; }
+
+        m_Summary.lastEnergy = energy;
+        m_Summary.sampleCount++;
+
+        // 初期エネルギーが0に近い場合は絶対誤差になる.
+        const double scale = ( m_Summary.initialEnergy < 0.0 ) ? -m_Summary.initialEnergy : m_Summary.initialEnergy;
+        const double diff  = ( energy < m_Summary.initialEnergy ) ? m_Summary.initialEnergy - energy : energy - m_Summary.initialEnergy;
+        const double drift = diff / ( ( scale > 1e-12 ) ? scale : 1.0 );
+
+        if ( drift > m_Summary.maxDrift )
+        { m_Summary.maxDrift = drift; }
+        if ( sample.maxDisplacement > m_Summary.maxDisplacement )
+        { m_Summary.maxDisplacement = sample.maxDisplacement; }
+        if ( sample.maxVelocity > m_Summary.maxVelocity )
+        { m_Summary.maxVelocity = sample.maxVelocity; }
+
+        // 発散したステップは最初の1回だけ覚えておく.
+        if ( ( sample.invalidCount > 0 || !IsFinite( energy ) ) && !m_Summary.diverged )
+        {
+            m_Summary.diverged    = true;
+            m_Summary.invalidStep = sample.step;
+        }
+    }
+
+private:
+    //======================================================================================
+    // private variables.
+    //======================================================================================
+    /* NOTHING */
+
+    //======================================================================================
+    // private methods.
+    //======================================================================================
+    SpringDiagnostics( const SpringDiagnostics& value );    // アクセス禁止.
+    void operator =  ( const SpringDiagnostics& value );    // アクセス禁止.
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// SpringDiagnostics class (DiagnosticsDisabled)
+////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief      何も計測しない SpringDiagnostics です. 呼び出しはインライン展開されて消えます.
+////////////////////////////////////////////////////////////////////////////////////////////
+template<size_t CAPACITY>
+class SpringDiagnostics<DiagnosticsDisabled, CAPACITY>
+{
+public:
+    SpringDiagnostics()
+    { /* DO_NOTHING */ }
+
+    virtual ~SpringDiagnostics()
+    { /* DO_NOTHING */ }
+
+    void Reset()
+    { /* DO_NOTHING */ }
+
+    void SetCallback( SpringSampleCallback, void* )
+    { /* DO_NOTHING */ }
+
+    template<typename MODEL>
+    void Record( const MODEL& )
+    { /* DO_NOTHING */ }
+
+    size_t GetSampleCount() const
+    { return 0; }
+
+    bool GetSample( const size_t, SpringSample& ) const
+    { return false; }
+
+    bool GetLatestSample( SpringSample& ) const
+    { return false; }
+
+    SpringSummary GetSummary() const
+    {
+        SpringSummary summary = {};
+        return summary;
+    }
+
+private:
+    SpringDiagnostics( const SpringDiagnostics& value );    // アクセス禁止.
+    void operator =  ( const SpringDiagnostics& value );    // アクセス禁止.
+};
+
+
+#endif//__SPRING_DIAGNOSTICS_H__
@@ -0,0 +1,329 @@
+﻿//------------------------------------------------------------------------------------------
+// File : SpringNetwork.h
+// Desc : Mass-Spring Network Simulator Module.
+// Copyright(c) Project Asura. All right reserved.
+//------------------------------------------------------------------------------------------
+
+#ifndef __SPRING_NETWORK_H__
+#define __SPRING_NETWORK_H__
+
+//------------------------------------------------------------------------------------------
+// Includes
+//------------------------------------------------------------------------------------------
+#include <Spring.h>
+#include <ThreadPool.h>
+#include <SpatialHash.h>
+#include <vector>
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// CONTACT_RESPONSE enum
+////////////////////////////////////////////////////////////////////////////////////////////
+enum CONTACT_RESPONSE
+{
+    CONTACT_RESPONSE_NONE = 0,          //!< 衝突を処理しません.
+    CONTACT_RESPONSE_PENALTY,           //!< めり込み量に比例した反発力を力に加えます.
+    CONTACT_RESPONSE_PROJECTION,        //!< 積分後にめり込みを位置の補正で解消します.
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// XPBD_SOLVER enum
+////////////////////////////////////////////////////////////////////////////////////////////
+enum XPBD_SOLVER
+{
+    XPBD_SOLVER_GAUSS_SEIDEL = 0,       //!< 色ごとに射影して結果をすぐに反映します.
+    XPBD_SOLVER_JACOBI,                 //!< 全ての拘束を同時に射影し，補正量を質点ごとに集めて反映します.
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// SpringNetwork class
+////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief      3次元の質点をばねで繋いだネットワーク(布・弾性体)をシミュレーションするクラスです.
+//!
+//! @note       ばねは端点の番号順に並べ替えてから，端点を共有しないグループに彩色します.
+//!             同じ色のばねは互いに別の質点にしか書き込まないので，色ごとに並列で力を
+//!             累積でき，アトミック操作は不要です. 累積順序はスレッド数に依存しません.
+//!             質点同士と平面との衝突は SpatialHash で近傍を探し，質点ごとに相手から受ける
+//!             力や補正量を集めて求めます. 書き込みは自分の質点だけなので彩色は不要です.
+////////////////////////////////////////////////////////////////////////////////////////////
+class SpringNetwork
+{
+    //======================================================================================
+    // list of friend classes and methods.
+    //======================================================================================
+    /* NOTHING */
+
+public:
+    /////////////////////////////////////////////////////////////////////////////////////////
+    // Edge structure
+    /////////////////////////////////////////////////////////////////////////////////////////
+    struct Edge
+    {
+        unsigned int    a;              //!< 端点の質点番号です(a < b).
+        unsigned int    b;              //!< 端点の質点番号です.
+        float           length;         //!< 自然長です.
+        float           constantK;      //!< ばね定数です.
+    };
+
+    /////////////////////////////////////////////////////////////////////////////////////////
+    // Plane structure
+    /////////////////////////////////////////////////////////////////////////////////////////
+    struct Plane
+    {
+        Vec3            normal;         //!< 質点が存在できる側を向いた単位法線です.
+        float           distance;       //!< 原点からの距離です(Dot( normal, p ) = distance).
+    };
+
+    //======================================================================================
+    // public variables.
+    //======================================================================================
+    /* NOTHING */
+
+    //======================================================================================
+    // public methods.
+    //======================================================================================
+    SpringNetwork();
+    virtual ~SpringNetwork();
+
+    void Clear();
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      質点を追加します. 質量が0以下の場合は固定点になります.
+    //--------------------------------------------------------------------------------------
+    unsigned int AddParticle( const Vec3& position, const float mass );
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      ばねを追加します. 自然長は現在の質点間の距離です.
+    //--------------------------------------------------------------------------------------
+    void AddSpring( const unsigned int a, const unsigned int b, const float constantK );
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      ばねの並べ替えと彩色を行います.
+    //!
+    //! @note       AddSpring() の後，最初の Update() で自動的に呼び出されます.
+    //--------------------------------------------------------------------------------------
+    void Build();
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      布を生成します.
+    //!
+    //! @note       XZ平面に countX * countZ 個の質点を並べ，構造・せん断・曲げのばねで繋ぎます.
+    //!             手前(z = 0)の両端を固定します. 質点の番号は x + z * countX です.
+    //--------------------------------------------------------------------------------------
+    void CreateCloth(
+        const unsigned int  countX,
+        const unsigned int  countZ,
+        const Vec3&         origin,
+        const float         width,
+        const float         depth,
+        const float         mass,
+        const float         constantK );
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      格子状の弾性体を生成します.
+    //!
+    //! @note       各質点を26近傍とばねで繋ぎます. 質点の番号は x + ( y + z * countY ) * countX です.
+    //--------------------------------------------------------------------------------------
+    void CreateSoftBody(
+        const unsigned int  countX,
+        const unsigned int  countY,
+        const unsigned int  countZ,
+        const Vec3&         origin,
+        const float         spacing,
+        const float         mass,
+        const float         constantK );
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      ばねで繋がっていない質点を格子状に生成します.
+    //!
+    //! @note       衝突の確認用です. 質点の番号は x + ( y + z * countY ) * countX です.
+    //--------------------------------------------------------------------------------------
+    void CreateParticles(
+        const unsigned int  countX,
+        const unsigned int  countY,
+        const unsigned int  countZ,
+        const Vec3&         origin,
+        const float         spacing,
+        const float         mass );
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      衝突する平面を追加します. 法線は正規化されます.
+    //--------------------------------------------------------------------------------------
+    void AddPlane( const Vec3& normal, const float distance );
+    void ClearPlanes();
+
+    void             SetGravity             ( const Vec3& value );
+    void             SetTimeStep            ( const float value );
+    void             SetDamping             ( const float value );
+    void             SetFixed               ( const unsigned int index, const bool fixed );
+    void             SetSolverIteration     ( const unsigned int value );
+    void             SetSolverTolerance     ( const float value );
+    void             SetParticleRadius      ( const float value );
+    void             SetContactResponse     ( const CONTACT_RESPONSE value );
+    void             SetContactStiffness    ( const float value );
+    void             SetContactDamping      ( const float value );
+    void             SetContactIteration    ( const unsigned int value );
+    void             SetConstraintSolver    ( const XPBD_SOLVER value );
+    void             SetConstraintIteration ( const unsigned int value );
+    void             SetConstraintRelaxation( const float value );
+
+    Vec3             GetGravity             () const;
+    float            GetTimeStep            () const;
+    float            GetDamping             () const;
+    unsigned int     GetSolverIteration     () const;
+    float            GetSolverTolerance     () const;
+    float            GetParticleRadius      () const;
+    CONTACT_RESPONSE GetContactResponse     () const;
+    float            GetContactStiffness    () const;
+    float            GetContactDamping      () const;
+    unsigned int     GetContactIteration    () const;
+    XPBD_SOLVER      GetConstraintSolver    () const;
+    unsigned int     GetConstraintIteration () const;
+    float            GetConstraintRelaxation() const;
+    unsigned int     GetPlaneCount          () const;
+    unsigned int     GetContactCount        () const;
+    unsigned int     GetLastIteration       () const;
+    unsigned int     GetParticleCount       () const;
+    unsigned int     GetSpringCount         () const;
+    unsigned int     GetColorCount          () const;
+    bool             IsFixed                ( const unsigned int index ) const;
+    float            GetMass                ( const unsigned int index ) const;
+    const Vec3&      GetPosition            ( const unsigned int index ) const;
+    const Vec3&      GetVelocity            ( const unsigned int index ) const;
+    const Edge&      GetSpring              ( const unsigned int index ) const;
+    const Vec3*      GetPositions           () const;
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      1ステップ更新します.
+    //!
+    //! @note       SIMULATION_TYPE_IMPLICIT_EULAR は (M - h * dF/dv - h^2 * dF/dx) * dv = h * ( F + h * dF/dx * v )
+    //!             を前処理付き共役勾配法で解きます. 行列は組み立てず，ばねごとの3x3ブロックを
+    //!             色ごとに掛け合わせます. 圧縮されたばねの横方向の剛性は0に切り詰めて正定値を保ちます.
+    //!             CONTACT_RESPONSE_PENALTY の反発力は力を求めるたびに格子を作り直して加えますが，
+    //!             陰的オイラー法の係数行列には含めません(反発力だけ陽的に扱います).
+    //!             CONTACT_RESPONSE_PROJECTION は積分後に格子を作り直し，めり込みをヤコビ法で
+    //!             SetContactIteration() 回だけ解消して，補正量を速度にも反映します.
+    //!             SIMULATION_TYPE_XPBD はばねを適合度 1 / k の距離拘束として扱い，重力と反発力だけで
+    //!             予測した位置を SetConstraintIteration() 回射影します. 減衰係数は拘束の減衰に使います.
+    //!             ガウス・ザイデル法は彩色したばねの色ごとに並列に射影します. ヤコビ法は補正量を
+    //!             接続数で平均し，SetConstraintRelaxation() 倍して反映します.
+    //--------------------------------------------------------------------------------------
+    void Update( SIMULATION_TYPE type );
+    void Update( SIMULATION_TYPE type, ThreadPool& pool );
+
+protected:
+    /////////////////////////////////////////////////////////////////////////////////////////
+    // Jacobian structure
+    /////////////////////////////////////////////////////////////////////////////////////////
+    struct Jacobian
+    {
+        Vec3            dir;            //!< ばねの方向です.
+        float           alpha;          //!< 伸縮方向の係数(h * c + h^2 * k)です.
+        float           beta;           //!< 横方向の係数(h^2 * k * (1 - L / l))です.
+    };
+
+    //======================================================================================
+    // protected variables.
+    //======================================================================================
+    Vec3                        m_Gravity;          //!< 重力加速度です.
+    float                       m_TimeStep;         //!< 微小時間です.
+    float                       m_Damping;          //!< ばねの伸縮方向の減衰係数です.
+    std::vector<Vec3>           m_Position;         //!< 位置です.
+    std::vector<Vec3>           m_PrevPosition;     //!< 前の位置です.
+    std::vector<Vec3>           m_Velocity;         //!< 速度です.
+    std::vector<Vec3>           m_Force;            //!< 力です.
+    std::vector<float>          m_Mass;             //!< 質量です.
+    std::vector<float>          m_InvMass;          //!< 質量の逆数です(固定点は0).
+    std::vector<Edge>           m_Springs;          //!< 色ごとにまとめたばねです.
+    std::vector<unsigned int>   m_ColorOffsets;     //!< 色 c のばねは [m_ColorOffsets[c], m_ColorOffsets[c+1]) です.
+    bool                        m_Dirty;            //!< Build() が必要かどうか.
+    unsigned int                m_SolverIteration;  //!< 共役勾配法の最大反復回数です.
+    float                       m_SolverTolerance;  //!< 共役勾配法の収束判定に使う相対残差です.
+    unsigned int                m_LastIteration;    //!< 直前の共役勾配法の反復回数です.
+    std::vector<Vec3>           m_StartPosition;    //!< ルンゲ・クッタ法の開始位置です.
+    std::vector<Vec3>           m_StartVelocity;    //!< ルンゲ・クッタ法の開始速度です.
+    std::vector<Vec3>           m_DeltaPosition;    //!< ルンゲ・クッタ法の位置の増分です.
+    std::vector<Vec3>           m_DeltaVelocity;    //!< 速度の増分です.
+    std::vector<Vec3>           m_Residual;         //!< 共役勾配法の残差です.
+    std::vector<Vec3>           m_Direction;        //!< 共役勾配法の探索方向です.
+    std::vector<Vec3>           m_Product;          //!< 係数行列と探索方向の積です.
+    std::vector<Vec3>           m_Diagonal;         //!< 係数行列の対角成分(前処理)です.
+    std::vector<Jacobian>       m_Jacobians;        //!< ばねごとの係数行列のブロックです.
+    SpatialHash                 m_Hash;             //!< 衝突判定に使う格子です.
+    std::vector<Plane>          m_Planes;           //!< 衝突する平面です.
+    std::vector<Vec3>           m_Correction;       //!< 衝突による位置の補正量です.
+    std::vector<unsigned int>   m_ContactCounts;    //!< 質点ごとの接触数です.
+    CONTACT_RESPONSE            m_ContactResponse;  //!< 衝突の処理方法です.
+    float                       m_ParticleRadius;   //!< 質点の半径です.
+    float                       m_ContactStiffness; //!< 反発力のばね定数です.
+    float                       m_ContactDamping;   //!< 反発力の法線方向の減衰係数です.
+    unsigned int                m_ContactIteration; //!< 位置の補正の反復回数です.
+    std::vector<float>          m_Lambda;           //!< 距離拘束ごとのラグランジュ乗数です.
+    std::vector<unsigned int>   m_SpringOffsets;    //!< 質点 i に繋がっているばねは m_SpringIndices の [m_SpringOffsets[i], m_SpringOffsets[i+1]) です.
+    std::vector<unsigned int>   m_SpringIndices;    //!< 質点ごとに繋がっているばねの番号です.
+    std::vector<Vec3>           m_SpringDelta;      //!< ヤコビ法でばねごとに求めた補正量です.
+    XPBD_SOLVER                 m_ConstraintSolver;     //!< 距離拘束の解き方です.
+    unsigned int                m_ConstraintIteration;  //!< 距離拘束の反復回数です.
+    float                       m_ConstraintRelaxation; //!< ヤコビ法の緩和係数です.
+
+    //======================================================================================
+    // protected methods.
+    //======================================================================================
+    void Step                  ( SIMULATION_TYPE type, ThreadPool* pPool );
+    void ComputeForce          ( ThreadPool* pPool );
+    void IntegrateRungeKutta4  ( ThreadPool* pPool );
+    void IntegrateImplicitEular( ThreadPool* pPool );
+    void IntegrateXPBD         ( ThreadPool* pPool );
+    void Multiply              ( ThreadPool* pPool );
+    void BuildContact          ( ThreadPool* pPool );
+    void ProjectContact        ( ThreadPool* pPool );
+
+    void ClearForce       ( const size_t begin, const size_t end );
+    void AccumulateForce  ( const size_t begin, const size_t end );
+    void Integrate        ( SIMULATION_TYPE type, const size_t begin, const size_t end );
+    void RungeKutta4Stage ( const unsigned int stage, const size_t begin, const size_t end );
+    void InitImplicit     ( const size_t begin, const size_t end );
+    void SetupImplicit    ( const size_t begin, const size_t end );
+    void MultiplyDiagonal ( const size_t begin, const size_t end );
+    void MultiplySpring   ( const size_t begin, const size_t end );
+    void AccumulateContact( const size_t begin, const size_t end );
+    void SolveContact     ( const size_t begin, const size_t end );
+    void ApplyContact     ( const size_t begin, const size_t end );
+    void PredictXPBD      ( const size_t begin, const size_t end );
+    void SolveDistance    ( const size_t begin, const size_t end );
+    void GatherJacobi     ( const size_t begin, const size_t end );
+    void FinishXPBD       ( const size_t begin, const size_t end );
+
+    static void ClearForceJob       ( size_t begin, size_t end, void* pUser );
+    static void AccumulateForceJob  ( size_t begin, size_t end, void* pUser );
+    static void IntegrateJob        ( size_t begin, size_t end, void* pUser );
+    static void RungeKutta4StageJob ( size_t begin, size_t end, void* pUser );
+    static void InitImplicitJob     ( size_t begin, size_t end, void* pUser );
+    static void SetupImplicitJob    ( size_t begin, size_t end, void* pUser );
+    static void MultiplyDiagonalJob ( size_t begin, size_t end, void* pUser );
+    static void MultiplySpringJob   ( size_t begin, size_t end, void* pUser );
+    static void AccumulateContactJob( size_t begin, size_t end, void* pUser );
+    static void SolveContactJob     ( size_t begin, size_t end, void* pUser );
+    static void ApplyContactJob     ( size_t begin, size_t end, void* pUser );
+    static void PredictXPBDJob      ( size_t begin, size_t end, void* pUser );
+    static void SolveDistanceJob    ( size_t begin, size_t end, void* pUser );
+    static void GatherJacobiJob     ( size_t begin, size_t end, void* pUser );
+    static void FinishXPBDJob       ( size_t begin, size_t end, void* pUser );
+
+private:
+    //======================================================================================
+    // private variables.
+    //======================================================================================
+    /* NOTHING */
+
+    //======================================================================================
+    // private methods.
+    //======================================================================================
+    SpringNetwork   ( const SpringNetwork& value );     // アクセス禁止.
+    void operator = ( const SpringNetwork& value );     // アクセス禁止.
+};
+
+
+#endif//__SPRING_NETWORK_H__
@@ -0,0 +1,134 @@
+﻿//------------------------------------------------------------------------------------------
+// File : SpringSystem.h
+// Desc : Batched Spring Simulator Module.
+// Copyright(c) Project Asura. All right reserved.
+//------------------------------------------------------------------------------------------
+
+#ifndef __SPRING_SYSTEM_H__
+#define __SPRING_SYSTEM_H__
+
+//------------------------------------------------------------------------------------------
+// Includes
+//------------------------------------------------------------------------------------------
+#include <Spring.h>
+#include <ThreadPool.h>
+#include <vector>
+#include <cstddef>
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// SpringSystem class
+////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief      Spring1D を多数まとめてシミュレーションするクラスです.
+//!
+//! @note       各パラメータは SoA 配列で保持し，SIMD でまとめて積分します.
+//!             演算順序は Spring1D と同じなので，同じパラメータなら同じ結果になります.
+//!             重力加速度と微小時間は全ばね共通です.
+////////////////////////////////////////////////////////////////////////////////////////////
+class SpringSystem
+{
+    //======================================================================================
+    // list of friend classes and methods.
+    //======================================================================================
+    /* NOTHING */
+
+public:
+    //======================================================================================
+    // public variables.
+    //======================================================================================
+    /* NOTHING */
+
+    //======================================================================================
+    // public methods.
+    //======================================================================================
+    SpringSystem();
+    virtual ~SpringSystem();
+
+    void Resize     ( const size_t count );
+    void Clear      ();
+
+    void SetSpring  (
+        const size_t index,
+        const double mass,
+        const double constantK,
+        const double length,
+        const double initPosition,
+        const double initVelocity );
+
+    void SetGravity  ( const double value );
+    void SetTimeStep ( const double value );
+    void SetChunkSize( const size_t value );
+
+    size_t GetCount     () const;
+    double GetGravity   () const;
+    double GetTimeStep  () const;
+    size_t GetChunkSize () const;
+    double GetMass      ( const size_t index ) const;
+    double GetConstantK ( const size_t index ) const;
+    double GetLength    ( const size_t index ) const;
+    double GetPosition  ( const size_t index ) const;
+    double GetVelocity  ( const size_t index ) const;
+
+    const double* GetPositions () const;
+    const double* GetVelocities() const;
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      全てのばねを1ステップ更新します.
+    //--------------------------------------------------------------------------------------
+    void Update( SIMULATION_TYPE type );
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      [begin, end) の範囲のばねを1ステップ更新します.
+    //!
+    //! @note       ばね同士は独立しているので，範囲が重ならなければ別スレッドから呼び出せます.
+    //--------------------------------------------------------------------------------------
+    void Update( SIMULATION_TYPE type, const size_t begin, const size_t end );
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      スレッドプールで全てのばねを substepCount ステップ更新します.
+    //!
+    //! @note       チャンク単位でキャッシュに載せたまま全サブステップを進めてから次のチャンクに
+    //!             移るので，スレッド間の同期は呼び出し1回につき1度だけです.
+    //!             結果は Update( type ) を substepCount 回呼び出した場合と一致します.
+    //--------------------------------------------------------------------------------------
+    void Update( SIMULATION_TYPE type, ThreadPool& pool, const unsigned int substepCount = 1 );
+
+protected:
+    //======================================================================================
+    // protected variables.
+    //======================================================================================
+    double              m_Gravity;          //!< 重力加速度です.
+    double              m_TimeStep;         //!< 微小時間です.
+    size_t              m_ChunkSize;        //!< 並列更新時の1チャンクあたりのばねの数です.
+    std::vector<double> m_Mass;             //!< 質量です.
+    std::vector<double> m_ConstantK;        //!< ばね定数です.
+    std::vector<double> m_Length;           //!< 自然長です.
+    std::vector<double> m_Position;         //!< 位置です.
+    std::vector<double> m_PrevPosition;     //!< 前の位置です.
+    std::vector<double> m_Velocity;         //!< 速度です.
+
+    //======================================================================================
+    // protected methods.
+    //======================================================================================
+    void IntegrateExplicitEular    ( const size_t begin, const size_t end );
+    void IntegrateSemiImplicitEular( const size_t begin, const size_t end );
+    void IntegrateVerlet           ( const size_t begin, const size_t end );
+    void IntegrateRungeKutta4      ( const size_t begin, const size_t end );
+    void IntegrateImplicitEular    ( const size_t begin, const size_t end );
+    void IntegrateXPBD             ( const size_t begin, const size_t end );
+
+private:
+    //======================================================================================
+    // private variables.
+    //======================================================================================
+    /* NOTHING */
+
+    //======================================================================================
+    // private methods.
+    //======================================================================================
+    SpringSystem    ( const SpringSystem& value );  // アクセス禁止.
+    void operator = ( const SpringSystem& value );  // アクセス禁止.
+};
+
+
+#endif//__SPRING_SYSTEM_H__
@@ -0,0 +1,110 @@
+﻿//------------------------------------------------------------------------------------------
+// File : ThreadPool.h
+// Desc : Thread Pool Module.
+// Copyright(c) Project Asura. All right reserved.
+//------------------------------------------------------------------------------------------
+
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+//------------------------------------------------------------------------------------------
+// Includes
+//------------------------------------------------------------------------------------------
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// ThreadPool class
+////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief      常駐スレッドで範囲処理を分割実行するクラスです.
+//!
+//! @note       範囲はチャンク単位で共有カウンタから取り出すので，処理の重さに偏りがあっても
+//!             空いたスレッドが残りを引き受けます. 呼び出し元のスレッドも処理に参加します.
+//!             ParallelFor() の中から ParallelFor() を呼び出すことはできません.
+////////////////////////////////////////////////////////////////////////////////////////////
+class ThreadPool
+{
+    //======================================================================================
+    // list of friend classes and methods.
+    //======================================================================================
+    /* NOTHING */
+
+public:
+    //======================================================================================
+    // public variables.
+    //======================================================================================
+    typedef void (*Func)( size_t begin, size_t end, void* pUser );
+
+    //======================================================================================
+    // public methods.
+    //======================================================================================
+    ThreadPool();
+    virtual ~ThreadPool();
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      ワーカースレッドを起動します.
+    //!
+    //! @param [in]     threadCount     呼び出し元を含むスレッド数です. 0の場合はコア数です.
+    //--------------------------------------------------------------------------------------
+    void Init( unsigned int threadCount = 0 );
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      ワーカースレッドを終了します.
+    //--------------------------------------------------------------------------------------
+    void Term();
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      呼び出し元を含むスレッド数を取得します.
+    //--------------------------------------------------------------------------------------
+    unsigned int GetThreadCount() const;
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      [0, count) を chunkSize ごとに分割して並列に処理します.
+    //!
+    //! @note       全てのチャンクが終わるまで戻りません.
+    //--------------------------------------------------------------------------------------
+    void ParallelFor( size_t count, size_t chunkSize, Func func, void* pUser );
+
+protected:
+    //======================================================================================
+    // protected variables.
+    //======================================================================================
+    std::vector<std::thread>    m_Threads;          //!< ワーカースレッドです.
+    std::mutex                  m_Mutex;            //!< 排他制御用です.
+    std::condition_variable     m_StartCondition;   //!< 処理開始の通知用です.
+    std::condition_variable     m_DoneCondition;    //!< 処理完了の通知用です.
+    unsigned long long          m_Generation;       //!< ParallelFor() の呼び出し回数です.
+    unsigned int                m_Running;          //!< 処理中のワーカー数です.
+    bool                        m_Exit;             //!< 終了要求フラグです.
+    Func                        m_Func;             //!< 処理関数です.
+    void*                       m_pUser;            //!< 処理関数に渡すユーザーデータです.
+    size_t                      m_Count;            //!< 処理する要素数です.
+    size_t                      m_ChunkSize;        //!< 1チャンクあたりの要素数です.
+    std::atomic<size_t>         m_NextChunk;        //!< 次に処理するチャンクの先頭です.
+
+    //======================================================================================
+    // protected methods.
+    //======================================================================================
+    void Worker();
+    void RunChunks();
+
+private:
+    //======================================================================================
+    // private variables.
+    //======================================================================================
+    /* NOTHING */
+
+    //======================================================================================
+    // private methods.
+    //======================================================================================
+    ThreadPool      ( const ThreadPool& value );    // アクセス禁止.
+    void operator = ( const ThreadPool& value );    // アクセス禁止.
+};
+
+
+#endif//__THREAD_POOL_H__
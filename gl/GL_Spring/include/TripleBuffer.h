@@ -0,0 +1,126 @@
+﻿//------------------------------------------------------------------------------------------
+// File : TripleBuffer.h
+// Desc : Lock-free Triple Buffer Module.
+// Copyright(c) Project Asura. All right reserved.
+//------------------------------------------------------------------------------------------
+
+#ifndef __TRIPLE_BUFFER_H__
+#define __TRIPLE_BUFFER_H__
+
+//------------------------------------------------------------------------------------------
+// Includes
+//------------------------------------------------------------------------------------------
+#include <atomic>
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// TripleBuffer class
+////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief      書き込み側1スレッドと読み込み側1スレッドの間でデータを受け渡すトリプルバッファです.
+//!
+//! @note       書き込み用・受け渡し用・読み込み用の3つのバッファを持ち，受け渡し用の番号だけを
+//!             アトミックに交換します. どちらのスレッドも相手を待たずに済みます.
+//!             読み込み側は常に最後に公開されたデータを受け取り，途中のデータは読み飛ばされます.
+////////////////////////////////////////////////////////////////////////////////////////////
+template<typename T>
+class TripleBuffer
+{
+    //======================================================================================
+    // list of friend classes and methods.
+    //======================================================================================
+    /* NOTHING */
+
+public:
+    //======================================================================================
+    // public variables.
+    //======================================================================================
+    /* NOTHING */
+
+    //======================================================================================
+    // public methods.
+    //======================================================================================
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //--------------------------------------------------------------------------------------
+    TripleBuffer()
+    : m_Write   ( 0 )
+    , m_Shared  ( 1 )
+    , m_Read    ( 2 )
+    { /* DO_NOTHING */ }
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //--------------------------------------------------------------------------------------
+    virtual ~TripleBuffer()
+    { /* DO_NOTHING */ }
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      書き込み用のバッファを取得します. 書き込み側のスレッドからのみ呼び出せます.
+    //--------------------------------------------------------------------------------------
+    T& GetWriteBuffer()
+    { return m_Buffer[m_Write]; }
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      書き込み用のバッファを公開し，新しい書き込み用のバッファに切り替えます.
+    //--------------------------------------------------------------------------------------
+    void Publish()
+    {
+        const unsigned int prev = m_Shared.exchange( m_Write | DIRTY_BIT, std::memory_order_acq_rel );
+        m_Write = prev & INDEX_MASK;
+    }
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      公開されたバッファがあれば読み込み用のバッファと交換します.
+    //!
+    //! @retval true    新しいデータを受け取りました.
+    //! @retval false   前回から公開されたデータがありません.
+    //--------------------------------------------------------------------------------------
+    bool Acquire()
+    {
+        if ( ( m_Shared.load( std::memory_order_relaxed ) & DIRTY_BIT ) == 0 )
+        { return false; }
+
+        const unsigned int prev = m_Shared.exchange( m_Read, std::memory_order_acq_rel );
+        m_Read = prev & INDEX_MASK;
+        return true;
+    }
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      読み込み用のバッファを取得します. 読み込み側のスレッドからのみ呼び出せます.
+    //--------------------------------------------------------------------------------------
+    const T& GetReadBuffer() const
+    { return m_Buffer[m_Read]; }
+
+protected:
+    //======================================================================================
+    // protected variables.
+    //======================================================================================
+    static const unsigned int   INDEX_MASK = 0x3;   //!< バッファ番号のマスクです.
+    static const unsigned int   DIRTY_BIT  = 0x4;   //!< 未読のデータが公開されていることを示すビットです.
+
+    T                           m_Buffer[3];        //!< バッファです.
+    unsigned int                m_Write;            //!< 書き込み用のバッファ番号です.
+    std::atomic<unsigned int>   m_Shared;           //!< 受け渡し用のバッファ番号と未読フラグです.
+    unsigned int                m_Read;             //!< 読み込み用のバッファ番号です.
+
+    //======================================================================================
+    // protected methods.
+    //======================================================================================
+    /* NOTHING */
+
+private:
+    //======================================================================================
+    // private variables.
+    //======================================================================================
+    /* NOTHING */
+
+    //======================================================================================
+    // private methods.
+    //======================================================================================
+    TripleBuffer    ( const TripleBuffer& value );  // アクセス禁止.
+    void operator = ( const TripleBuffer& value );  // アクセス禁止.
+};
+
+
+#endif//__TRIPLE_BUFFER_H__
@@ -0,0 +1,118 @@
+﻿//----------------------------------------------------------------------------------------
+// File : SimulationClock.cpp
+// Desc : Fixed Time Step Simulation Clock Module.
+// Copyright(c) Project Asura. All right reserved.
+//----------------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------------
+#include <SimulationClock.h>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// SimulationClock class
+//////////////////////////////////////////////////////////////////////////////////////////
+
+//----------------------------------------------------------------------------------------
+//      コンストラクタです.
+//----------------------------------------------------------------------------------------
+SimulationClock::SimulationClock()
+: m_TimeStep    ( 1.0 / 60.0 )
+, m_MaxSubstep  ( 8 )
+, m_Accumulator ( 0.0 )
+, m_Time        ( 0.0 )
+, m_DroppedTime ( 0.0 )
+{ /* DO_NOTHING */ }
+
+//----------------------------------------------------------------------------------------
+//      デストラクタです.
+//----------------------------------------------------------------------------------------
+SimulationClock::~SimulationClock()
+{ /* DO_NOTHING */ }
+
+//----------------------------------------------------------------------------------------
+//      蓄積した時間を破棄します.
+//----------------------------------------------------------------------------------------
+void SimulationClock::Reset()
+{
+    m_Accumulator = 0.0;
+    m_Time        = 0.0;
+    m_DroppedTime = 0.0;
+}
+
+//----------------------------------------------------------------------------------------
+//      経過時間を蓄積し，進めるステップ数を返却します.
+//----------------------------------------------------------------------------------------
+unsigned int SimulationClock::Advance( const double elapsedTime )
+{
+    // 時計が巻き戻った場合は進めない.
+    if ( elapsedTime > 0.0 )
+    { m_Accumulator += elapsedTime; }
+
+    unsigned int count = 0;
+    while( m_Accumulator >= m_TimeStep && count < m_MaxSubstep )
+    {
+        m_Accumulator -= m_TimeStep;
+        m_Time        += m_TimeStep;
+        count++;
+    }
+
+    // 上限に達した場合は，補間に使う1ステップ未満の端数だけ残して捨てる.
+    if ( m_Accumulator >= m_TimeStep )
+    {
+        const double remain = m_Accumulator - m_TimeStep * static_cast<unsigned long long>( m_Accumulator / m_TimeStep );
+        m_DroppedTime += m_Accumulator - remain;
+        m_Accumulator  = remain;
+    }
+
+    return count;
+}
+
+//----------------------------------------------------------------------------------------
+//      1ステップの時間を設定します.
+//----------------------------------------------------------------------------------------
+void SimulationClock::SetTimeStep( const double value )
+{ m_TimeStep = ( value > 0.0 ) ? value : m_TimeStep; }
+
+//----------------------------------------------------------------------------------------
+//      1回の Advance() で進める最大ステップ数を設定します.
+//----------------------------------------------------------------------------------------
+void SimulationClock::SetMaxSubstep( const unsigned int value )
+{ m_MaxSubstep = ( value > 0 ) ? value : 1; }
+
+//----------------------------------------------------------------------------------------
+//      1ステップの時間を取得します.
+//----------------------------------------------------------------------------------------
+double SimulationClock::GetTimeStep() const
+{ return m_TimeStep; }
+
+//----------------------------------------------------------------------------------------
+//      1回の Advance() で進める最大ステップ数を取得します.
+//----------------------------------------------------------------------------------------
+unsigned int SimulationClock::GetMaxSubstep() const
+{ return m_MaxSubstep; }
+
+//----------------------------------------------------------------------------------------
+//      まだステップに変換していない時間を取得します.
+//----------------------------------------------------------------------------------------
+double SimulationClock::GetAccumulator() const
+{ return m_Accumulator; }
+
+//----------------------------------------------------------------------------------------
+//      前のステップと現在のステップの間の補間係数を取得します.
+//----------------------------------------------------------------------------------------
+double SimulationClock::GetAlpha() const
+{ return m_Accumulator / m_TimeStep; }
+
+//----------------------------------------------------------------------------------------
+//      進めたステップの合計時間を取得します.
+//----------------------------------------------------------------------------------------
+double SimulationClock::GetTime() const
+{ return m_Time; }
+
+//----------------------------------------------------------------------------------------
+//      上限を超えて捨てた時間の合計を取得します.
+//----------------------------------------------------------------------------------------
+double SimulationClock::GetDroppedTime() const
+{ return m_DroppedTime; }
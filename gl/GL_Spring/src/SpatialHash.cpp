@@ -0,0 +1,406 @@
+﻿//----------------------------------------------------------------------------------------
+// File : SpatialHash.cpp
+// Desc : Uniform Grid Spatial Hash Module.
+// Copyright(c) Project Asura. All right reserved.
+//----------------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------------
+#include <SpatialHash.h>
+#include <cmath>
+
+
+namespace /* anonymous */ {
+
+//----------------------------------------------------------------------------------------
+// Constant Values
+//----------------------------------------------------------------------------------------
+static const size_t         SORT_CHUNK_SIZE     = 16384;    // ソートの1チャンクあたりの要素数.
+static const size_t         BUCKET_CHUNK_SIZE   = 65536;    // バケットの初期化の1チャンクあたりの数.
+static const unsigned int   RADIX_BITS          = 11;       // 1パスでソートするビット数.
+static const unsigned int   RADIX               = 1 << RADIX_BITS;
+static const unsigned int   MIN_BUCKET_BITS     = 10;       // バケット数の2の指数の最小値.
+static const unsigned int   MAX_BUCKET_BITS     = 22;       // バケット数の2の指数の最大値.
+static const unsigned int   HASH_PRIME_Y        = 19349663; // y 方向のハッシュ値の係数.
+static const unsigned int   HASH_PRIME_Z        = 83492791; // z 方向のハッシュ値の係数.
+
+//----------------------------------------------------------------------------------------
+//      スレッドプールがあれば並列に，無ければその場で処理します.
+//----------------------------------------------------------------------------------------
+void Dispatch( ThreadPool* pPool, size_t count, size_t chunkSize, ThreadPool::Func func, void* pUser )
+{
+    if ( pPool != nullptr )
+    { pPool->ParallelFor( count, chunkSize, func, pUser ); }
+    else if ( count > 0 )
+    { func( 0, count, pUser ); }
+}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// SpatialHash class
+//////////////////////////////////////////////////////////////////////////////////////////
+
+//----------------------------------------------------------------------------------------
+//      コンストラクタです.
+//----------------------------------------------------------------------------------------
+SpatialHash::SpatialHash()
+: m_pPositions  ( nullptr )
+, m_Count       ( 0 )
+, m_CellSize    ( 1.0f )
+, m_InvCellSize ( 1.0f )
+, m_BucketBits  ( MIN_BUCKET_BITS )
+, m_ChunkCount  ( 0 )
+, m_Shift       ( 0 )
+{ /* DO_NOTHING */ }
+
+//----------------------------------------------------------------------------------------
+//      デストラクタです.
+//----------------------------------------------------------------------------------------
+SpatialHash::~SpatialHash()
+{ Clear(); }
+
+//----------------------------------------------------------------------------------------
+//      登録した質点を破棄します.
+//----------------------------------------------------------------------------------------
+void SpatialHash::Clear()
+{
+    m_Keys       .clear();
+    m_Indices    .clear();
+    m_TempKeys   .clear();
+    m_TempIndices.clear();
+    m_Histogram  .clear();
+    m_BucketBegin.clear();
+    m_SortedPositions.clear();
+    m_pPositions = nullptr;
+    m_Count      = 0;
+}
+
+//----------------------------------------------------------------------------------------
+//      質点を格子に登録し直します.
+//----------------------------------------------------------------------------------------
+void SpatialHash::Build( const Vec3* pPositions, const size_t count, const float cellSize, ThreadPool* pPool )
+{
+    m_pPositions  = pPositions;
+    m_Count       = count;
+    m_CellSize    = ( cellSize > 0.0f ) ? cellSize : 1.0f;
+    m_InvCellSize = 1.0f / m_CellSize;
+
+    // 別の格子との衝突が少なくなるように，質点数の2倍以上のバケットを用意する.
+    m_BucketBits = MIN_BUCKET_BITS;
+    while( m_BucketBits < MAX_BUCKET_BITS && ( size_t( 1 ) << m_BucketBits ) < count * 2 )
+    { m_BucketBits++; }
+
+    m_ChunkCount = static_cast<unsigned int>( ( count + SORT_CHUNK_SIZE - 1 ) / SORT_CHUNK_SIZE );
+    m_Keys       .resize( count );
+    m_Indices    .resize( count );
+    m_TempKeys   .resize( count );
+    m_TempIndices.resize( count );
+    m_Histogram  .resize( m_ChunkCount * RADIX );
+    m_BucketBegin.resize( size_t( 1 ) << m_BucketBits );
+    m_SortedPositions.resize( count );
+
+    // ハッシュ値を求める.
+    Dispatch( pPool, count, SORT_CHUNK_SIZE, ComputeKeysJob, this );
+
+    // 下位の桁から計数ソートを繰り返す.
+    for( m_Shift=0; m_Shift<m_BucketBits; m_Shift+=RADIX_BITS )
+    {
+        Dispatch( pPool, count, SORT_CHUNK_SIZE, CountDigitsJob, this );
+
+        // 桁の値ごとに，チャンク順に書き込み先を割り当てる.
+        unsigned int offset = 0;
+        for( unsigned int digit=0; digit<RADIX; ++digit )
+        {
+            for( unsigned int chunk=0; chunk<m_ChunkCount; ++chunk )
+            {
+                unsigned int& value = m_Histogram[chunk * RADIX + digit];
+                const unsigned int histogram = value;
+                value   = offset;
+                offset += histogram;
+            }
+        }
+
+        Dispatch( pPool, count, SORT_CHUNK_SIZE, ScatterDigitsJob, this );
+        m_Keys   .swap( m_TempKeys );
+        m_Indices.swap( m_TempIndices );
+    }
+
+    // バケットの先頭を求める.
+    Dispatch( pPool, m_BucketBegin.size(), BUCKET_CHUNK_SIZE, ClearBucketsJob, this );
+    Dispatch( pPool, count, SORT_CHUNK_SIZE, FindBucketsJob, this );
+
+    // 近傍の走査で位置を連続して読めるようにソート後の順に並べる.
+    Dispatch( pPool, count, SORT_CHUNK_SIZE, GatherPositionsJob, this );
+}
+
+//----------------------------------------------------------------------------------------
+//      位置を含む格子と隣接する格子に入っている要素の範囲を重複なく列挙します.
+//----------------------------------------------------------------------------------------
+unsigned int SpatialHash::FindNeighborRanges( const Vec3& position, unsigned int* pBegin, unsigned int* pEnd ) const
+{
+    const unsigned int mask = ( 1u << m_BucketBits ) - 1;
+
+    int cx, cy, cz;
+    CalcCell( position, cx, cy, cz );
+
+    // x 方向に並んだ3つの格子は連続したバケットになる. 末尾で折り返す場合は2つに分ける.
+    unsigned int lower[MAX_RANGE];
+    unsigned int upper[MAX_RANGE];
+    unsigned int count = 0;
+    for( int dz=-1; dz<=1; ++dz )
+    for( int dy=-1; dy<=1; ++dy )
+    {
+        const unsigned int first = CalcBucket( cx - 1, cy + dy, cz + dz );
+        const unsigned int last  = ( first + 2 ) & mask;
+
+        if ( last < first )
+        {
+            lower[count] = first;
+            upper[count] = mask;
+            count++;
+
+            lower[count] = 0;
+            upper[count] = last;
+            count++;
+        }
+        else
+        {
+            lower[count] = first;
+            upper[count] = last;
+            count++;
+        }
+    }
+
+    // 別の列が同じバケットになった場合に同じ要素を2度数えないように，並べて重なりをまとめる.
+    for( unsigned int i=1; i<count; ++i )
+    {
+        const unsigned int l = lower[i];
+        const unsigned int u = upper[i];
+
+        unsigned int j = i;
+        for( ; j > 0 && lower[j - 1] > l; --j )
+        {
+            lower[j] = lower[j - 1];
+            upper[j] = upper[j - 1];
+        }
+        lower[j] = l;
+        upper[j] = u;
+    }
+
+    unsigned int merged = 0;
+    for( unsigned int i=0; i<count; ++i )
+    {
+        if ( merged > 0 && lower[i] <= upper[merged - 1] + 1 )
+        {
+            if ( upper[i] > upper[merged - 1] )
+            { upper[merged - 1] = upper[i]; }
+            continue;
+        }
+
+        lower[merged] = lower[i];
+        upper[merged] = upper[i];
+        merged++;
+    }
+
+    // バケットの範囲をソート後の配列の範囲に直す. キーはソート済みなので終端は走査で求まる.
+    unsigned int result = 0;
+    for( unsigned int i=0; i<merged; ++i )
+    {
+        unsigned int begin = INVALID_INDEX;
+        for( unsigned int bucket=lower[i]; bucket<=upper[i] && begin == INVALID_INDEX; ++bucket )
+        { begin = m_BucketBegin[bucket]; }
+
+        if ( begin == INVALID_INDEX )
+        { continue; }
+
+        unsigned int end = begin;
+        while( end < m_Count && m_Keys[end] <= upper[i] )
+        { end++; }
+
+        pBegin[result] = begin;
+        pEnd  [result] = end;
+        result++;
+    }
+
+    return result;
+}
+
+//----------------------------------------------------------------------------------------
+//      格子のハッシュ値からバケットの番号を求めます.
+//----------------------------------------------------------------------------------------
+unsigned int SpatialHash::CalcBucket( const int x, const int y, const int z ) const
+{
+    // x の係数を1にして，x 方向に隣接する格子を連続したバケットにする.
+    const unsigned int hash = static_cast<unsigned int>( x )
+                            + static_cast<unsigned int>( y ) * HASH_PRIME_Y
+                            + static_cast<unsigned int>( z ) * HASH_PRIME_Z;
+    return hash & ( ( 1u << m_BucketBits ) - 1 );
+}
+
+//----------------------------------------------------------------------------------------
+//      位置を含む格子を求めます.
+//----------------------------------------------------------------------------------------
+void SpatialHash::CalcCell( const Vec3& position, int& x, int& y, int& z ) const
+{
+    x = static_cast<int>( floorf( position.x * m_InvCellSize ) );
+    y = static_cast<int>( floorf( position.y * m_InvCellSize ) );
+    z = static_cast<int>( floorf( position.z * m_InvCellSize ) );
+}
+
+//----------------------------------------------------------------------------------------
+//      ハッシュ値を求めます.
+//----------------------------------------------------------------------------------------
+void SpatialHash::ComputeKeys( const size_t begin, const size_t end )
+{
+    for( size_t i=begin; i<end; ++i )
+    {
+        int x, y, z;
+        CalcCell( m_pPositions[i], x, y, z );
+
+        m_Keys   [i] = CalcBucket( x, y, z );
+        m_Indices[i] = static_cast<unsigned int>( i );
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      チャンクごとに桁の度数分布を数えます.
+//----------------------------------------------------------------------------------------
+void SpatialHash::CountDigits( const size_t begin, const size_t end )
+{
+    // スレッドが無い場合は全体がまとめて渡されるので，チャンクに分けて数える.
+    for( size_t chunk=begin; chunk<end; chunk+=SORT_CHUNK_SIZE )
+    {
+        const size_t  chunkEnd   = ( end - chunk < SORT_CHUNK_SIZE ) ? end : chunk + SORT_CHUNK_SIZE;
+        unsigned int* pHistogram = &m_Histogram[( chunk / SORT_CHUNK_SIZE ) * RADIX];
+        for( unsigned int i=0; i<RADIX; ++i )
+        { pHistogram[i] = 0; }
+
+        for( size_t i=chunk; i<chunkEnd; ++i )
+        { pHistogram[( m_Keys[i] >> m_Shift ) & ( RADIX - 1 )]++; }
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      チャンクごとに桁の値で振り分けます. チャンク内の順序は保たれます.
+//----------------------------------------------------------------------------------------
+void SpatialHash::ScatterDigits( const size_t begin, const size_t end )
+{
+    for( size_t chunk=begin; chunk<end; chunk+=SORT_CHUNK_SIZE )
+    {
+        const size_t  chunkEnd = ( end - chunk < SORT_CHUNK_SIZE ) ? end : chunk + SORT_CHUNK_SIZE;
+        unsigned int* pOffset  = &m_Histogram[( chunk / SORT_CHUNK_SIZE ) * RADIX];
+        for( size_t i=chunk; i<chunkEnd; ++i )
+        {
+            const unsigned int key = m_Keys[i];
+            const unsigned int dst = pOffset[( key >> m_Shift ) & ( RADIX - 1 )]++;
+
+            m_TempKeys   [dst] = key;
+            m_TempIndices[dst] = m_Indices[i];
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      バケットを空にします.
+//----------------------------------------------------------------------------------------
+void SpatialHash::ClearBuckets( const size_t begin, const size_t end )
+{
+    for( size_t i=begin; i<end; ++i )
+    { m_BucketBegin[i] = INVALID_INDEX; }
+}
+
+//----------------------------------------------------------------------------------------
+//      キーが変わる位置をバケットの先頭として記録します.
+//----------------------------------------------------------------------------------------
+void SpatialHash::FindBuckets( const size_t begin, const size_t end )
+{
+    for( size_t i=begin; i<end; ++i )
+    {
+        if ( i == 0 || m_Keys[i] != m_Keys[i - 1] )
+        { m_BucketBegin[ m_Keys[i] ] = static_cast<unsigned int>( i ); }
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      位置をソート後の順に並べます.
+//----------------------------------------------------------------------------------------
+void SpatialHash::GatherPositions( const size_t begin, const size_t end )
+{
+    for( size_t i=begin; i<end; ++i )
+    { m_SortedPositions[i] = m_pPositions[ m_Indices[i] ]; }
+}
+
+//----------------------------------------------------------------------------------------
+//      ハッシュ値の計算を並列に行います.
+//----------------------------------------------------------------------------------------
+void SpatialHash::ComputeKeysJob( size_t begin, size_t end, void* pUser )
+{ static_cast<SpatialHash*>( pUser )->ComputeKeys( begin, end ); }
+
+//----------------------------------------------------------------------------------------
+//      度数分布の計算を並列に行います.
+//----------------------------------------------------------------------------------------
+void SpatialHash::CountDigitsJob( size_t begin, size_t end, void* pUser )
+{ static_cast<SpatialHash*>( pUser )->CountDigits( begin, end ); }
+
+//----------------------------------------------------------------------------------------
+//      振り分けを並列に行います.
+//----------------------------------------------------------------------------------------
+void SpatialHash::ScatterDigitsJob( size_t begin, size_t end, void* pUser )
+{ static_cast<SpatialHash*>( pUser )->ScatterDigits( begin, end ); }
+
+//----------------------------------------------------------------------------------------
+//      バケットの初期化を並列に行います.
+//----------------------------------------------------------------------------------------
+void SpatialHash::ClearBucketsJob( size_t begin, size_t end, void* pUser )
+{ static_cast<SpatialHash*>( pUser )->ClearBuckets( begin, end ); }
+
+//----------------------------------------------------------------------------------------
+//      バケットの先頭の検索を並列に行います.
+//----------------------------------------------------------------------------------------
+void SpatialHash::FindBucketsJob( size_t begin, size_t end, void* pUser )
+{ static_cast<SpatialHash*>( pUser )->FindBuckets( begin, end ); }
+
+//----------------------------------------------------------------------------------------
+//      位置の並べ替えを並列に行います.
+//----------------------------------------------------------------------------------------
+void SpatialHash::GatherPositionsJob( size_t begin, size_t end, void* pUser )
+{ static_cast<SpatialHash*>( pUser )->GatherPositions( begin, end ); }
+
+//----------------------------------------------------------------------------------------
+//      登録した質点の数を取得します.
+//----------------------------------------------------------------------------------------
+size_t SpatialHash::GetCount() const
+{ return m_Count; }
+
+//----------------------------------------------------------------------------------------
+//      格子の1辺の長さを取得します.
+//----------------------------------------------------------------------------------------
+float SpatialHash::GetCellSize() const
+{ return m_CellSize; }
+
+//----------------------------------------------------------------------------------------
+//      バケットの数を取得します.
+//----------------------------------------------------------------------------------------
+unsigned int SpatialHash::GetBucketCount() const
+{ return 1u << m_BucketBits; }
+
+//----------------------------------------------------------------------------------------
+//      ソート済みのハッシュ値の配列を取得します.
+//----------------------------------------------------------------------------------------
+const unsigned int* SpatialHash::GetKeys() const
+{ return m_Keys.empty() ? nullptr : &m_Keys[0]; }
+
+//----------------------------------------------------------------------------------------
+//      ソート済みの質点の番号の配列を取得します.
+//----------------------------------------------------------------------------------------
+const unsigned int* SpatialHash::GetIndices() const
+{ return m_Indices.empty() ? nullptr : &m_Indices[0]; }
+
+//----------------------------------------------------------------------------------------
+//      ソート後の順に並べた位置の配列を取得します.
+//----------------------------------------------------------------------------------------
+const Vec3* SpatialHash::GetSortedPositions() const
+{ return m_SortedPositions.empty() ? nullptr : &m_SortedPositions[0]; }
@@ -8,6 +8,45 @@
 // Includes
 //----------------------------------------------------------------------------------------
 #include <Spring.h>
+#include <cmath>
+
+
+namespace /* anonymous */ {
+
+//----------------------------------------------------------------------------------------
+// Constant Values
+//----------------------------------------------------------------------------------------
+// Dormand-Prince 5(4) 法の係数.
+static const double DP_A[6][5] = {
+    { 0.0,                 0.0,                0.0,                0.0,             0.0 },
+    { 1.0 / 5.0,           0.0,                0.0,                0.0,             0.0 },
+    { 3.0 / 40.0,          9.0 / 40.0,         0.0,                0.0,             0.0 },
+    { 44.0 / 45.0,        -56.0 / 15.0,        32.0 / 9.0,         0.0,             0.0 },
+    { 19372.0 / 6561.0,   -25360.0 / 2187.0,   64448.0 / 6561.0,  -212.0 / 729.0,   0.0 },
+    { 9017.0 / 3168.0,    -355.0 / 33.0,       46732.0 / 5247.0,   49.0 / 176.0,   -5103.0 / 18656.0 },
+};
+static const double DP_B[6] = { 35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0, -2187.0 / 6784.0, 11.0 / 84.0 };
+static const double DP_E[7] = { 71.0 / 57600.0, 0.0, -71.0 / 16695.0, 71.0 / 1920.0, -17253.0 / 339200.0, 22.0 / 525.0, -1.0 / 40.0 };
+
+// 刻み幅のPI制御の係数. 指数は5次の公式に合わせる.
+static const double CONTROL_SAFETY      = 0.9;          // 安全係数.
+static const double CONTROL_ALPHA       = 0.7 / 5.0;    // 今回の誤差の指数.
+static const double CONTROL_BETA        = 0.4 / 5.0;    // 前回の誤差の指数.
+static const double CONTROL_MIN_FACTOR  = 0.2;          // 1回で縮める倍率の下限.
+static const double CONTROL_MAX_FACTOR  = 5.0;          // 1回で広げる倍率の上限.
+static const double CONTROL_MIN_ERROR   = 1e-4;         // 前回の誤差の下限.
+
+//----------------------------------------------------------------------------------------
+//      絶対値の大きい方を返却します.
+//----------------------------------------------------------------------------------------
+inline double MaxAbs( const double a, const double b )
+{
+    const double absA = fabs( a );
+    const double absB = fabs( b );
+    return ( absA > absB ) ? absA : absB;
+}
+
+} // namespace /* anonymous */
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -29,6 +68,14 @@ Spring1D::Spring1D()
 , m_Accel       ( 0.0 )
 , m_Velocity    ( 0.0 )
 , m_Force       ( 0.0 )
+, m_PrevPosition( 0.0 )
+, m_Tolerance   ( 1e-6 )
+, m_MinTimeStep ( 1e-6 )
+, m_MaxTimeStep ( 0.1 )
+, m_AdaptiveTimeStep( 0.0 )
+, m_PrevError   ( CONTROL_MIN_ERROR )
+, m_AcceptCount ( 0 )
+, m_RejectCount ( 0 )
 { /* DO_NOTHING */ }
 
 //----------------------------------------------------------------------------------------
@@ -56,9 +103,162 @@ void Spring1D::Update( SIMULATION_TYPE type )
     case SIMULATION_TYPE_VERLET:
         { IntegrateVerlet(); }
         break;
+
+    // 半陰的オイラー法で更新.
+    case SIMULATION_TYPE_SEMI_IMPLICIT_EULAR:
+        { IntegrateSemiImplicitEular(); }
+        break;
+
+    // 4次のルンゲ・クッタ法で更新.
+    case SIMULATION_TYPE_RUNGE_KUTTA4:
+        { IntegrateRungeKutta4(); }
+        break;
+
+    // 陰的オイラー法で更新.
+    case SIMULATION_TYPE_IMPLICIT_EULAR:
+        { IntegrateImplicitEular(); }
+        break;
+
+    // 拡張位置ベース法で更新.
+    case SIMULATION_TYPE_XPBD:
+        { IntegrateXPBD(); }
+        break;
     }
 }
 
+//----------------------------------------------------------------------------------------
+//      刻み幅を調整しながら指定時間だけ進めます.
+//----------------------------------------------------------------------------------------
+unsigned int Spring1D::Advance( const double duration )
+{
+    if ( !( duration > 0.0 ) )
+    { return 0; }
+
+    double dt = ( m_AdaptiveTimeStep > 0.0 ) ? m_AdaptiveTimeStep : m_TimeStep;
+    if ( dt < m_MinTimeStep ) { dt = m_MinTimeStep; }
+    if ( dt > m_MaxTimeStep ) { dt = m_MaxTimeStep; }
+
+    double       elapsed = 0.0;
+    unsigned int count   = 0;
+
+    for( ;; )
+    {
+        // 最後のステップは終わりの時刻に合わせる.
+        const double remain = duration - elapsed;
+        const bool   last   = ( dt >= remain );
+        const double h      = ( last ) ? remain : dt;
+
+        double position = 0.0;
+        double velocity = 0.0;
+        const double error = TryDormandPrince( h, position, velocity );
+
+        // 誤差が許容値を超えた場合は刻み幅を縮めてやり直す. NaN も棄却する.
+        if ( !( error <= 1.0 ) && h > m_MinTimeStep )
+        {
+            double factor = ( error == error ) ? CONTROL_SAFETY * pow( error, -1.0 / 5.0 ) : CONTROL_MIN_FACTOR;
+            if ( factor < CONTROL_MIN_FACTOR ) { factor = CONTROL_MIN_FACTOR; }
+            if ( factor > 1.0 )                { factor = 1.0; }
+
+            dt = h * factor;
+            if ( dt < m_MinTimeStep ) { dt = m_MinTimeStep; }
+
+            m_RejectCount++;
+            continue;
+        }
+
+        // 受理する.
+        m_PrevPosition = m_Position;
+        m_Position     = position;
+        m_Velocity     = velocity;
+        elapsed       += h;
+        count++;
+        m_AcceptCount++;
+
+        // PI制御で次の刻み幅を決める. 前回の誤差も使うので刻み幅が振動しにくい.
+        const double currError = ( error > CONTROL_MIN_ERROR ) ? error : CONTROL_MIN_ERROR;
+        double factor = CONTROL_SAFETY * pow( currError, -CONTROL_ALPHA ) * pow( m_PrevError, CONTROL_BETA );
+        if ( factor < CONTROL_MIN_FACTOR ) { factor = CONTROL_MIN_FACTOR; }
+        if ( factor > CONTROL_MAX_FACTOR ) { factor = CONTROL_MAX_FACTOR; }
+        m_PrevError = currError;
+
+        // 終わりに合わせて縮めた刻み幅は次に持ち越さない.
+        const double next = h * factor;
+        if ( !last || next > dt )
+        { dt = next; }
+        if ( dt < m_MinTimeStep ) { dt = m_MinTimeStep; }
+        if ( dt > m_MaxTimeStep ) { dt = m_MaxTimeStep; }
+
+        if ( last )
+        { break; }
+    }
+
+    m_AdaptiveTimeStep = dt;
+    UpdateAccel();
+
+    return count;
+}
+
+//----------------------------------------------------------------------------------------
+//      Dormand-Prince 5(4) 法で1ステップ進めた結果を求めます.
+//      許容誤差で正規化した誤差を返却します. 1以下なら受理できます.
+//----------------------------------------------------------------------------------------
+double Spring1D::TryDormandPrince( const double dt, double& position, double& velocity ) const
+{
+    double kx[7];
+    double kv[7];
+
+    kx[0] = m_Velocity;
+    kv[0] = CalcAccel( m_Position );
+
+    for( int i=1; i<6; ++i )
+    {
+        double sumX = 0.0;
+        double sumV = 0.0;
+        for( int j=0; j<i; ++j )
+        {
+            sumX += DP_A[i][j] * kx[j];
+            sumV += DP_A[i][j] * kv[j];
+        }
+
+        const double x = m_Position + dt * sumX;
+        kx[i] = m_Velocity + dt * sumV;
+        kv[i] = CalcAccel( x );
+    }
+
+    // 5次の解.
+    double sumX = 0.0;
+    double sumV = 0.0;
+    for( int i=0; i<6; ++i )
+    {
+        sumX += DP_B[i] * kx[i];
+        sumV += DP_B[i] * kv[i];
+    }
+    position = m_Position + dt * sumX;
+    velocity = m_Velocity + dt * sumV;
+
+    // 7段目は5次の解での傾き. 4次の解との差を誤差とする.
+    kx[6] = velocity;
+    kv[6] = CalcAccel( position );
+
+    double errorX = 0.0;
+    double errorV = 0.0;
+    for( int i=0; i<7; ++i )
+    {
+        errorX += DP_E[i] * kx[i];
+        errorV += DP_E[i] * kv[i];
+    }
+    errorX *= dt;
+    errorV *= dt;
+
+    // 絶対誤差と相対誤差を合わせた尺度で正規化する.
+    const double scaleX = m_Tolerance * ( 1.0 + MaxAbs( m_Position, position ) );
+    const double scaleV = m_Tolerance * ( 1.0 + MaxAbs( m_Velocity, velocity ) );
+    const double ratioX = fabs( errorX ) / scaleX;
+    const double ratioV = fabs( errorV ) / scaleV;
+
+    return ( ratioX > ratioV || ratioX != ratioX ) ? ratioX : ratioV;
+}
+
 //----------------------------------------------------------------------------------------
 //      加速度を更新します.
 //----------------------------------------------------------------------------------------
@@ -71,6 +271,12 @@ void Spring1D::UpdateAccel()
     m_Accel = m_Force / m_Mass;
 }
 
+//----------------------------------------------------------------------------------------
+//      指定位置での加速度を求めます. UpdateAccel() と同じ演算順序で計算します.
+//----------------------------------------------------------------------------------------
+double Spring1D::CalcAccel( const double position ) const
+{ return ( - m_ConstantK * ( position - m_Length ) + m_Mass * m_Gravity ) / m_Mass; }
+
 //----------------------------------------------------------------------------------------
 //      陽的オイラー法による積分計算を行います.
 //----------------------------------------------------------------------------------------
@@ -79,7 +285,20 @@ void Spring1D::IntegrateExplicitEular()
     // 前の位置を更新.
     m_PrevPosition = m_Position;
 
-    // 陽的オイラー法を適用.
+    // 陽的オイラー法を適用. 位置は更新前の速度で進める.
+    m_Position += m_Velocity * m_TimeStep;
+    m_Velocity += m_Accel    * m_TimeStep;
+}
+
+//----------------------------------------------------------------------------------------
+//      半陰的オイラー法による積分計算を行います.
+//----------------------------------------------------------------------------------------
+void Spring1D::IntegrateSemiImplicitEular()
+{
+    // 前の位置を更新.
+    m_PrevPosition = m_Position;
+
+    // 半陰的オイラー法を適用. 位置は更新後の速度で進めるので，エネルギーが発散しにくい.
     m_Velocity += m_Accel    * m_TimeStep;
     m_Position += m_Velocity * m_TimeStep;
 }
@@ -100,6 +319,72 @@ void Spring1D::IntegrateVerlet()
     m_Position     = newPos;
 }
 
+//----------------------------------------------------------------------------------------
+//      4次のルンゲ・クッタ法による積分計算を行います.
+//----------------------------------------------------------------------------------------
+void Spring1D::IntegrateRungeKutta4()
+{
+    const double dt     = m_TimeStep;
+    const double halfDt = m_TimeStep * 0.5;
+
+    // 各段の速度と加速度を求める. 1段目の加速度は UpdateAccel() で求めた値.
+    const double v1 = m_Velocity;
+    const double a1 = m_Accel;
+    const double v2 = m_Velocity + a1 * halfDt;
+    const double a2 = CalcAccel( m_Position + v1 * halfDt );
+    const double v3 = m_Velocity + a2 * halfDt;
+    const double a3 = CalcAccel( m_Position + v2 * halfDt );
+    const double v4 = m_Velocity + a3 * dt;
+    const double a4 = CalcAccel( m_Position + v3 * dt );
+
+    // 前の位置を更新.
+    m_PrevPosition = m_Position;
+
+    // 重み付き平均で進める.
+    m_Position += ( v1 + 2.0 * v2 + 2.0 * v3 + v4 ) * ( dt / 6.0 );
+    m_Velocity += ( a1 + 2.0 * a2 + 2.0 * a3 + a4 ) * ( dt / 6.0 );
+}
+
+//----------------------------------------------------------------------------------------
+//      陰的オイラー法による積分計算を行います.
+//----------------------------------------------------------------------------------------
+void Spring1D::IntegrateImplicitEular()
+{
+    // 前の位置を更新.
+    m_PrevPosition = m_Position;
+
+    // v' = v + dt * a( x + dt * v' ) を v' について解く.
+    // ばねの力は位置に対して線形なので，a( x + dt * v' ) = a( x ) - ( k / m ) * dt * v' となる.
+    const double stiffness = m_ConstantK / m_Mass;
+    m_Velocity  = ( m_Velocity + m_Accel * m_TimeStep ) / ( 1.0 + stiffness * m_TimeStep * m_TimeStep );
+    m_Position += m_Velocity * m_TimeStep;
+}
+
+//----------------------------------------------------------------------------------------
+//      拡張位置ベース法による積分計算を行います.
+//----------------------------------------------------------------------------------------
+void Spring1D::IntegrateXPBD()
+{
+    const double dt = m_TimeStep;
+
+    // 前の位置を更新.
+    m_PrevPosition = m_Position;
+
+    // 外力(重力)だけで位置を予測する.
+    double position = m_Position + ( m_Velocity + m_Gravity * dt ) * dt;
+
+    // 拘束 C = x - L を適合度 1 / k で射影する. 固定点側の質量の逆数は0.
+    // k = 0 の場合は適合度が無限大になり，補正量は0になる.
+    const double invMass    = 1.0 / m_Mass;
+    const double compliance = 1.0 / ( m_ConstantK * dt * dt );
+    const double lambda     = -( position - m_Length ) / ( invMass + compliance );
+    position += invMass * lambda;
+
+    // 位置の変化から速度を求める.
+    m_Velocity = ( position - m_PrevPosition ) / dt;
+    m_Position = position;
+}
+
 //----------------------------------------------------------------------------------------
 //      質量を設定します.
 //----------------------------------------------------------------------------------------
@@ -147,6 +432,30 @@ void Spring1D::SetInitPosition( const double value )
     m_InitPosition = value;
     m_Position = m_InitPosition;
     m_PrevPosition = m_Position;
+
+    // 刻み幅の制御と統計もやり直す.
+    m_AdaptiveTimeStep = 0.0;
+    m_PrevError        = CONTROL_MIN_ERROR;
+    m_AcceptCount      = 0;
+    m_RejectCount      = 0;
+}
+
+//----------------------------------------------------------------------------------------
+//      Advance() の1ステップあたりの許容誤差を設定します.
+//----------------------------------------------------------------------------------------
+void Spring1D::SetTolerance( const double value )
+{ m_Tolerance = ( value > 0.0 ) ? value : m_Tolerance; }
+
+//----------------------------------------------------------------------------------------
+//      Advance() の刻み幅の範囲を設定します.
+//----------------------------------------------------------------------------------------
+void Spring1D::SetTimeStepRange( const double minValue, const double maxValue )
+{
+    if ( !( minValue > 0.0 ) || !( maxValue >= minValue ) )
+    { return; }
+
+    m_MinTimeStep = minValue;
+    m_MaxTimeStep = maxValue;
 }
 
 //----------------------------------------------------------------------------------------
@@ -185,3 +494,45 @@ double Spring1D::GetConstantK() const
 double Spring1D::GetPosition() const
 { return m_Position; }
 
+//----------------------------------------------------------------------------------------
+//      速度を取得します.
+//----------------------------------------------------------------------------------------
+double Spring1D::GetVelocity() const
+{ return m_Velocity; }
+
+//----------------------------------------------------------------------------------------
+//      Advance() の許容誤差を取得します.
+//----------------------------------------------------------------------------------------
+double Spring1D::GetTolerance() const
+{ return m_Tolerance; }
+
+//----------------------------------------------------------------------------------------
+//      Advance() の刻み幅の最小値を取得します.
+//----------------------------------------------------------------------------------------
+double Spring1D::GetMinTimeStep() const
+{ return m_MinTimeStep; }
+
+//----------------------------------------------------------------------------------------
+//      Advance() の刻み幅の最大値を取得します.
+//----------------------------------------------------------------------------------------
+double Spring1D::GetMaxTimeStep() const
+{ return m_MaxTimeStep; }
+
+//----------------------------------------------------------------------------------------
+//      Advance() で次に試す刻み幅を取得します.
+//----------------------------------------------------------------------------------------
+double Spring1D::GetAdaptiveTimeStep() const
+{ return ( m_AdaptiveTimeStep > 0.0 ) ? m_AdaptiveTimeStep : m_TimeStep; }
+
+//----------------------------------------------------------------------------------------
+//      Advance() で受理したステップの合計を取得します.
+//----------------------------------------------------------------------------------------
+unsigned long long Spring1D::GetAcceptCount() const
+{ return m_AcceptCount; }
+
+//----------------------------------------------------------------------------------------
+//      Advance() で棄却したステップの合計を取得します.
+//----------------------------------------------------------------------------------------
+unsigned long long Spring1D::GetRejectCount() const
+{ return m_RejectCount; }
+
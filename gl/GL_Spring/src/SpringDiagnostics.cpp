@@ -0,0 +1,158 @@
+﻿//----------------------------------------------------------------------------------------
+// File : SpringDiagnostics.cpp
+// Desc : Spring Simulation Diagnostics Module.
+// Copyright(c) Project Asura. All right reserved.
+//----------------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------------
+#include <SpringDiagnostics.h>
+#include <cmath>
+
+
+namespace /* anonymous */ {
+
+//----------------------------------------------------------------------------------------
+//      絶対値を求めます.
+//----------------------------------------------------------------------------------------
+inline double Abs( const double value )
+{ return ( value < 0.0 ) ? -value : value; }
+
+//----------------------------------------------------------------------------------------
+//      計測結果を初期化します.
+//----------------------------------------------------------------------------------------
+void ClearSample( SpringSample& sample )
+{
+    sample.step            = 0;
+    sample.time            = 0.0;
+    sample.kinetic         = 0.0;
+    sample.potential       = 0.0;
+    sample.maxDisplacement = 0.0;
+    sample.maxVelocity     = 0.0;
+    sample.invalidCount    = 0;
+}
+
+//----------------------------------------------------------------------------------------
+//      1次元のばね1本分を計測結果に加えます.
+//----------------------------------------------------------------------------------------
+void AddSpring1D
+(
+    const double    mass,
+    const double    constantK,
+    const double    length,
+    const double    gravity,
+    const double    position,
+    const double    velocity,
+    SpringSample&   sample
+)
+{
+    const double stretch   = position - length;
+    const double kinetic   = 0.5 * mass * velocity * velocity;
+    const double potential = 0.5 * constantK * stretch * stretch - mass * gravity * position;
+
+    sample.kinetic   += kinetic;
+    sample.potential += potential;
+
+    if ( Abs( stretch )  > sample.maxDisplacement ) { sample.maxDisplacement = Abs( stretch ); }
+    if ( Abs( velocity ) > sample.maxVelocity )     { sample.maxVelocity     = Abs( velocity ); }
+
+    // 位置と速度が有限でもエネルギーが溢れた場合は発散とみなす.
+    if ( !IsFinite( position ) || !IsFinite( velocity ) || !IsFinite( kinetic + potential ) )
+    { sample.invalidCount++; }
+}
+
+} // namespace /* anonymous */
+
+
+//----------------------------------------------------------------------------------------
+//      1次元のばねを計測します.
+//----------------------------------------------------------------------------------------
+void MeasureSpring( const Spring1D& spring, SpringSample& sample )
+{
+    ClearSample( sample );
+    AddSpring1D(
+        spring.GetMass(),
+        spring.GetConstantK(),
+        spring.GetLength(),
+        spring.GetGravity(),
+        spring.GetPosition(),
+        spring.GetVelocity(),
+        sample );
+}
+
+//----------------------------------------------------------------------------------------
+//      まとめて更新するばねを計測します.
+//----------------------------------------------------------------------------------------
+void MeasureSpring( const SpringSystem& system, SpringSample& sample )
+{
+    ClearSample( sample );
+
+    const size_t  count       = system.GetCount();
+    const double  gravity     = system.GetGravity();
+    const double* pPositions  = system.GetPositions();
+    const double* pVelocities = system.GetVelocities();
+
+    for( size_t i=0; i<count; ++i )
+    {
+        AddSpring1D(
+            system.GetMass( i ),
+            system.GetConstantK( i ),
+            system.GetLength( i ),
+            gravity,
+            pPositions [i],
+            pVelocities[i],
+            sample );
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      ばねのネットワークを計測します.
+//----------------------------------------------------------------------------------------
+void MeasureSpring( const SpringNetwork& network, SpringSample& sample )
+{
+    ClearSample( sample );
+
+    const Vec3 gravity = network.GetGravity();
+
+    // 質点の運動エネルギーと重力による位置エネルギー.
+    const unsigned int particleCount = network.GetParticleCount();
+    for( unsigned int i=0; i<particleCount; ++i )
+    {
+        const Vec3& position = network.GetPosition( i );
+        const Vec3& velocity = network.GetVelocity( i );
+
+        if ( !IsFinite( position.x ) || !IsFinite( position.y ) || !IsFinite( position.z )
+          || !IsFinite( velocity.x ) || !IsFinite( velocity.y ) || !IsFinite( velocity.z ) )
+        { sample.invalidCount++; }
+
+        if ( network.IsFixed( i ) )
+        { continue; }
+
+        const double mass   = network.GetMass( i );
+        const double speed2 = double( velocity.x ) * velocity.x + double( velocity.y ) * velocity.y + double( velocity.z ) * velocity.z;
+        const double height = double( gravity.x ) * position.x + double( gravity.y ) * position.y + double( gravity.z ) * position.z;
+
+        sample.kinetic   += 0.5 * mass * speed2;
+        sample.potential -= mass * height;
+
+        if ( speed2 > sample.maxVelocity )
+        { sample.maxVelocity = speed2; }
+    }
+    sample.maxVelocity = sqrt( sample.maxVelocity );
+
+    // ばねの弾性エネルギー.
+    const unsigned int springCount = network.GetSpringCount();
+    for( unsigned int i=0; i<springCount; ++i )
+    {
+        const SpringNetwork::Edge& edge = network.GetSpring( i );
+        const Vec3 diff = network.GetPosition( edge.b ) - network.GetPosition( edge.a );
+        const double distance = sqrt( double( diff.x ) * diff.x + double( diff.y ) * diff.y + double( diff.z ) * diff.z );
+        const double stretch  = distance - edge.length;
+
+        sample.potential += 0.5 * edge.constantK * stretch * stretch;
+
+        if ( Abs( stretch ) > sample.maxDisplacement )
+        { sample.maxDisplacement = Abs( stretch ); }
+    }
+}
@@ -0,0 +1,1650 @@
+﻿//----------------------------------------------------------------------------------------
+// File : SpringNetwork.cpp
+// Desc : Mass-Spring Network Simulator Module.
+// Copyright(c) Project Asura. All right reserved.
+//----------------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------------
+#include <SpringNetwork.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+
+namespace /* anonymous */ {
+
+//----------------------------------------------------------------------------------------
+// Constant Values
+//----------------------------------------------------------------------------------------
+static const size_t         PARTICLE_CHUNK_SIZE = 1024;         // 並列処理時の1チャンクあたりの質点数.
+static const size_t         SPRING_CHUNK_SIZE   = 1024;         // 並列処理時の1チャンクあたりのばねの数.
+static const unsigned int   INVALID_COLOR       = 0xffffffff;   // 未彩色.
+static const float          MIN_LENGTH          = 1e-6f;        // 方向を求められる最小の長さ.
+static const unsigned int   DEFAULT_SOLVER_ITERATION = 50;      // 共役勾配法の最大反復回数の既定値.
+static const float          DEFAULT_SOLVER_TOLERANCE = 1e-4f;   // 共役勾配法の相対残差の既定値.
+static const float          DEFAULT_CONTACT_STIFFNESS = 1000.0f; // 反発力のばね定数の既定値.
+static const unsigned int   DEFAULT_CONSTRAINT_ITERATION = 10;  // 距離拘束の反復回数の既定値.
+static const float          RK4_STAGE_STEP  [3] = { 0.5f, 0.5f, 1.0f };         // ルンゲ・クッタ法の次の段までの時間の比率.
+static const float          RK4_STAGE_WEIGHT[4] = { 1.0f, 2.0f, 2.0f, 1.0f };   // ルンゲ・クッタ法の各段の重み.
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// NetworkJob structure
+//////////////////////////////////////////////////////////////////////////////////////////
+struct NetworkJob
+{
+    SpringNetwork*      pNetwork;           // 処理するネットワークです.
+    SIMULATION_TYPE     type;               // 積分方法です.
+    size_t              offset;             // 範囲の先頭に加えるオフセットです.
+    unsigned int        stage;              // ルンゲ・クッタ法の段です.
+};
+
+//----------------------------------------------------------------------------------------
+//      内積を求めます.
+//----------------------------------------------------------------------------------------
+inline float Dot( const Vec3& a, const Vec3& b )
+{ return ( a.x * b.x ) + ( a.y * b.y ) + ( a.z * b.z ); }
+
+//----------------------------------------------------------------------------------------
+//      スレッドプールがあれば並列に，無ければその場で処理します.
+//----------------------------------------------------------------------------------------
+void Dispatch( ThreadPool* pPool, size_t count, size_t chunkSize, ThreadPool::Func func, NetworkJob* pJob )
+{
+    if ( pPool != nullptr )
+    { pPool->ParallelFor( count, chunkSize, func, pJob ); }
+    else if ( count > 0 )
+    { func( 0, count, pJob ); }
+}
+
+//----------------------------------------------------------------------------------------
+//      ばねを色ごとに処理します. 同じ色のばねは質点を共有しないので並列に処理できます.
+//----------------------------------------------------------------------------------------
+void DispatchColors( ThreadPool* pPool, const std::vector<unsigned int>& offsets, ThreadPool::Func func, NetworkJob* pJob )
+{
+    for( size_t i=0; i + 1 < offsets.size(); ++i )
+    {
+        pJob->offset = offsets[i];
+        Dispatch( pPool, offsets[i + 1] - offsets[i], SPRING_CHUNK_SIZE, func, pJob );
+    }
+    pJob->offset = 0;
+}
+
+//----------------------------------------------------------------------------------------
+//      3次元ベクトルの配列の内積を求めます. 桁落ちを避けるため倍精度で累積します.
+//----------------------------------------------------------------------------------------
+double Dot( const std::vector<Vec3>& a, const std::vector<Vec3>& b )
+{
+    double result = 0.0;
+    for( size_t i=0; i<a.size(); ++i )
+    { result += double( a[i].x ) * b[i].x + double( a[i].y ) * b[i].y + double( a[i].z ) * b[i].z; }
+
+    return result;
+}
+
+//----------------------------------------------------------------------------------------
+//      ばねの係数行列のブロックをベクトルに掛けます.
+//----------------------------------------------------------------------------------------
+inline Vec3 Transform( const Vec3& dir, const float alpha, const float beta, const Vec3& value )
+{
+    // alpha * d * d^T + beta * ( I - d * d^T ).
+    const float along = Dot( dir, value );
+    return dir * ( ( alpha - beta ) * along ) + value * beta;
+}
+
+//----------------------------------------------------------------------------------------
+//      ばねを端点の番号順に比較します.
+//----------------------------------------------------------------------------------------
+bool LessEdge( const SpringNetwork::Edge& lhs, const SpringNetwork::Edge& rhs )
+{
+    if ( lhs.a != rhs.a )
+    { return lhs.a < rhs.a; }
+
+    return lhs.b < rhs.b;
+}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// SpringNetwork class
+//////////////////////////////////////////////////////////////////////////////////////////
+
+//----------------------------------------------------------------------------------------
+//      コンストラクタです.
+//----------------------------------------------------------------------------------------
+SpringNetwork::SpringNetwork()
+: m_Gravity         ( 0.0f, -9.8f, 0.0f )
+, m_TimeStep        ( 0.001f )
+, m_Damping         ( 0.0f )
+, m_Dirty           ( false )
+, m_SolverIteration ( DEFAULT_SOLVER_ITERATION )
+, m_SolverTolerance ( DEFAULT_SOLVER_TOLERANCE )
+, m_LastIteration   ( 0 )
+, m_ContactResponse ( CONTACT_RESPONSE_NONE )
+, m_ParticleRadius  ( 0.0f )
+, m_ContactStiffness( DEFAULT_CONTACT_STIFFNESS )
+, m_ContactDamping  ( 0.0f )
+, m_ContactIteration( 1 )
+, m_ConstraintSolver    ( XPBD_SOLVER_GAUSS_SEIDEL )
+, m_ConstraintIteration ( DEFAULT_CONSTRAINT_ITERATION )
+, m_ConstraintRelaxation( 1.0f )
+{ /* DO_NOTHING */ }
+
+//----------------------------------------------------------------------------------------
+//      デストラクタです.
+//----------------------------------------------------------------------------------------
+SpringNetwork::~SpringNetwork()
+{ Clear(); }
+
+//----------------------------------------------------------------------------------------
+//      全ての質点とばねを破棄します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::Clear()
+{
+    m_Position    .clear();
+    m_PrevPosition.clear();
+    m_Velocity    .clear();
+    m_Force       .clear();
+    m_Mass        .clear();
+    m_InvMass     .clear();
+    m_Springs     .clear();
+    m_ColorOffsets.clear();
+    m_StartPosition.clear();
+    m_StartVelocity.clear();
+    m_DeltaPosition.clear();
+    m_DeltaVelocity.clear();
+    m_Residual     .clear();
+    m_Direction    .clear();
+    m_Product      .clear();
+    m_Diagonal     .clear();
+    m_Jacobians    .clear();
+    m_Correction   .clear();
+    m_ContactCounts.clear();
+    m_Lambda       .clear();
+    m_SpringOffsets.clear();
+    m_SpringIndices.clear();
+    m_SpringDelta  .clear();
+    m_Hash.Clear();
+    m_Dirty         = false;
+    m_LastIteration = 0;
+}
+
+//----------------------------------------------------------------------------------------
+//      質点を追加します.
+//----------------------------------------------------------------------------------------
+unsigned int SpringNetwork::AddParticle( const Vec3& position, const float mass )
+{
+    const unsigned int index = static_cast<unsigned int>( m_Position.size() );
+
+    m_Position    .push_back( position );
+    m_PrevPosition.push_back( position );
+    m_Velocity    .push_back( Vec3() );
+    m_Force       .push_back( Vec3() );
+    m_Mass        .push_back( ( mass > 0.0f ) ? mass : 0.0f );
+    m_InvMass     .push_back( ( mass > 0.0f ) ? 1.0f / mass : 0.0f );
+
+    return index;
+}
+
+//----------------------------------------------------------------------------------------
+//      ばねを追加します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::AddSpring( const unsigned int a, const unsigned int b, const float constantK )
+{
+    assert( a < m_Position.size() && b < m_Position.size() && a != b );
+
+    Vec3 diff = m_Position[b] - m_Position[a];
+
+    Edge edge;
+    edge.a         = ( a < b ) ? a : b;
+    edge.b         = ( a < b ) ? b : a;
+    edge.length    = diff.Length();
+    edge.constantK = constantK;
+
+    m_Springs.push_back( edge );
+    m_Dirty = true;
+}
+
+//----------------------------------------------------------------------------------------
+//      ばねの並べ替えと彩色を行います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::Build()
+{
+    m_Dirty = false;
+    m_ColorOffsets.clear();
+    m_ColorOffsets.push_back( 0 );
+    m_SpringOffsets.assign( m_Position.size() + 1, 0 );
+    m_SpringIndices.clear();
+
+    if ( m_Springs.empty() )
+    { return; }
+
+    // 端点の番号順に並べて，同じ色の中でも質点へのアクセスが前から順になるようにする.
+    std::sort( m_Springs.begin(), m_Springs.end(), LessEdge );
+
+    // 貪欲法で彩色する. 1色ずつ，まだ使われていない質点だけを繋ぐばねを割り当てていく.
+    const size_t springCount = m_Springs.size();
+    std::vector<unsigned int> colors( springCount, INVALID_COLOR );
+    std::vector<unsigned int> stamps( m_Position.size(), INVALID_COLOR );
+    std::vector<unsigned int> pending( springCount );
+    std::vector<unsigned int> rest;
+    std::vector<unsigned int> counts;
+
+    for( size_t i=0; i<springCount; ++i )
+    { pending[i] = static_cast<unsigned int>( i ); }
+
+    for( unsigned int color=0; !pending.empty(); ++color )
+    {
+        rest.clear();
+        counts.push_back( 0 );
+
+        for( size_t i=0; i<pending.size(); ++i )
+        {
+            const Edge& edge = m_Springs[ pending[i] ];
+            if ( stamps[edge.a] == color || stamps[edge.b] == color )
+            {
+                rest.push_back( pending[i] );
+                continue;
+            }
+
+            stamps[edge.a]     = color;
+            stamps[edge.b]     = color;
+            colors[pending[i]] = color;
+            counts[color]++;
+        }
+
+        pending.swap( rest );
+    }
+
+    // 色ごとにまとめる. 同じ色の中では並べ替えた順序を保つ.
+    for( size_t i=0; i<counts.size(); ++i )
+    { m_ColorOffsets.push_back( m_ColorOffsets.back() + counts[i] ); }
+
+    std::vector<unsigned int> cursor( m_ColorOffsets.begin(), m_ColorOffsets.end() - 1 );
+    std::vector<Edge> sorted( springCount );
+    for( size_t i=0; i<springCount; ++i )
+    { sorted[ cursor[ colors[i] ]++ ] = m_Springs[i]; }
+
+    m_Springs.swap( sorted );
+
+    // ヤコビ法で補正量を質点ごとに集めるための接続表. 並べ替えた後のばねの番号で作る.
+    for( size_t i=0; i<springCount; ++i )
+    {
+        m_SpringOffsets[ m_Springs[i].a + 1 ]++;
+        m_SpringOffsets[ m_Springs[i].b + 1 ]++;
+    }
+
+    for( size_t i=0; i<m_Position.size(); ++i )
+    { m_SpringOffsets[i + 1] += m_SpringOffsets[i]; }
+
+    cursor.assign( m_SpringOffsets.begin(), m_SpringOffsets.end() - 1 );
+    m_SpringIndices.resize( springCount * 2 );
+    for( size_t i=0; i<springCount; ++i )
+    {
+        m_SpringIndices[ cursor[ m_Springs[i].a ]++ ] = static_cast<unsigned int>( i );
+        m_SpringIndices[ cursor[ m_Springs[i].b ]++ ] = static_cast<unsigned int>( i );
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      布を生成します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::CreateCloth
+(
+    const unsigned int  countX,
+    const unsigned int  countZ,
+    const Vec3&         origin,
+    const float         width,
+    const float         depth,
+    const float         mass,
+    const float         constantK
+)
+{
+    Clear();
+
+    if ( countX < 2 || countZ < 2 )
+    { return; }
+
+    const float stepX        = width / float( countX - 1 );
+    const float stepZ        = depth / float( countZ - 1 );
+    const float particleMass = mass / float( countX * countZ );
+
+    for( unsigned int z=0; z<countZ; ++z )
+    {
+        for( unsigned int x=0; x<countX; ++x )
+        { AddParticle( origin + Vec3( stepX * x, 0.0f, stepZ * z ), particleMass ); }
+    }
+
+    for( unsigned int z=0; z<countZ; ++z )
+    {
+        for( unsigned int x=0; x<countX; ++x )
+        {
+            const unsigned int index = x + z * countX;
+
+            // 構造ばね.
+            if ( x + 1 < countX ) { AddSpring( index, index + 1,      constantK ); }
+            if ( z + 1 < countZ ) { AddSpring( index, index + countX, constantK ); }
+
+            // せん断ばね.
+            if ( x + 1 < countX && z + 1 < countZ ) { AddSpring( index,     index + countX + 1, constantK ); }
+            if ( x > 0          && z + 1 < countZ ) { AddSpring( index,     index + countX - 1, constantK ); }
+
+            // 曲げばね.
+            if ( x + 2 < countX ) { AddSpring( index, index + 2,          constantK ); }
+            if ( z + 2 < countZ ) { AddSpring( index, index + countX * 2, constantK ); }
+        }
+    }
+
+    SetFixed( 0,          true );
+    SetFixed( countX - 1, true );
+
+    Build();
+}
+
+//----------------------------------------------------------------------------------------
+//      格子状の弾性体を生成します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::CreateSoftBody
+(
+    const unsigned int  countX,
+    const unsigned int  countY,
+    const unsigned int  countZ,
+    const Vec3&         origin,
+    const float         spacing,
+    const float         mass,
+    const float         constantK
+)
+{
+    Clear();
+
+    if ( countX == 0 || countY == 0 || countZ == 0 )
+    { return; }
+
+    const float particleMass = mass / float( countX * countY * countZ );
+
+    for( unsigned int z=0; z<countZ; ++z )
+    {
+        for( unsigned int y=0; y<countY; ++y )
+        {
+            for( unsigned int x=0; x<countX; ++x )
+            { AddParticle( origin + Vec3( spacing * x, spacing * y, spacing * z ), particleMass ); }
+        }
+    }
+
+    for( unsigned int z=0; z<countZ; ++z )
+    {
+        for( unsigned int y=0; y<countY; ++y )
+        {
+            for( unsigned int x=0; x<countX; ++x )
+            {
+                const unsigned int index = x + ( y + z * countY ) * countX;
+
+                // 26近傍のうち番号が大きい方とだけ繋いで，重複を避ける.
+                for( int dz=-1; dz<=1; ++dz )
+                for( int dy=-1; dy<=1; ++dy )
+                for( int dx=-1; dx<=1; ++dx )
+                {
+                    const int nx = int( x ) + dx;
+                    const int ny = int( y ) + dy;
+                    const int nz = int( z ) + dz;
+                    if ( nx < 0 || ny < 0 || nz < 0 || nx >= int( countX ) || ny >= int( countY ) || nz >= int( countZ ) )
+                    { continue; }
+
+                    const unsigned int neighbor = nx + ( ny + nz * countY ) * countX;
+                    if ( neighbor > index )
+                    { AddSpring( index, neighbor, constantK ); }
+                }
+            }
+        }
+    }
+
+    Build();
+}
+
+//----------------------------------------------------------------------------------------
+//      ばねで繋がっていない質点を格子状に生成します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::CreateParticles
+(
+    const unsigned int  countX,
+    const unsigned int  countY,
+    const unsigned int  countZ,
+    const Vec3&         origin,
+    const float         spacing,
+    const float         mass
+)
+{
+    Clear();
+
+    for( unsigned int z=0; z<countZ; ++z )
+    {
+        for( unsigned int y=0; y<countY; ++y )
+        {
+            for( unsigned int x=0; x<countX; ++x )
+            { AddParticle( origin + Vec3( spacing * x, spacing * y, spacing * z ), mass ); }
+        }
+    }
+
+    Build();
+}
+
+//----------------------------------------------------------------------------------------
+//      衝突する平面を追加します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::AddPlane( const Vec3& normal, const float distance )
+{
+    Vec3 value = normal;
+    const float length = value.Length();
+    assert( length >= MIN_LENGTH );
+
+    Plane plane;
+    plane.normal   = value / length;
+    plane.distance = distance;
+
+    m_Planes.push_back( plane );
+}
+
+//----------------------------------------------------------------------------------------
+//      全ての平面を破棄します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::ClearPlanes()
+{ m_Planes.clear(); }
+
+//----------------------------------------------------------------------------------------
+//      更新処理を行います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::Update( SIMULATION_TYPE type )
+{ Step( type, nullptr ); }
+
+//----------------------------------------------------------------------------------------
+//      スレッドプールで更新処理を行います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::Update( SIMULATION_TYPE type, ThreadPool& pool )
+{ Step( type, &pool ); }
+
+//----------------------------------------------------------------------------------------
+//      1ステップ進めます. pPool が nullptr の場合は呼び出し元のスレッドで処理します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::Step( SIMULATION_TYPE type, ThreadPool* pPool )
+{
+    if ( m_Dirty )
+    { Build(); }
+
+    switch( type )
+    {
+    // 4次のルンゲ・クッタ法で更新.
+    case SIMULATION_TYPE_RUNGE_KUTTA4:
+        { IntegrateRungeKutta4( pPool ); }
+        break;
+
+    // 陰的オイラー法で更新.
+    case SIMULATION_TYPE_IMPLICIT_EULAR:
+        { IntegrateImplicitEular( pPool ); }
+        break;
+
+    // 拡張位置ベース法で更新.
+    case SIMULATION_TYPE_XPBD:
+        { IntegrateXPBD( pPool ); }
+        break;
+
+    // 力を1回だけ求めて質点ごとに積分する.
+    default:
+        {
+            NetworkJob job;
+            job.pNetwork = this;
+            job.type     = type;
+            job.offset   = 0;
+            job.stage    = 0;
+
+            ComputeForce( pPool );
+            Dispatch( pPool, m_Position.size(), PARTICLE_CHUNK_SIZE, IntegrateJob, &job );
+        }
+        break;
+    }
+
+    // 積分方法によらず，進めた後の位置でめり込みを解消する.
+    if ( m_ContactResponse == CONTACT_RESPONSE_PROJECTION )
+    { ProjectContact( pPool ); }
+}
+
+//----------------------------------------------------------------------------------------
+//      現在の位置と速度から力を求めます.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::ComputeForce( ThreadPool* pPool )
+{
+    NetworkJob job;
+    job.pNetwork = this;
+    job.type     = SIMULATION_TYPE_EXPLICIT_EULAR;
+    job.offset   = 0;
+    job.stage    = 0;
+
+    Dispatch( pPool, m_Position.size(), PARTICLE_CHUNK_SIZE, ClearForceJob, &job );
+    DispatchColors( pPool, m_ColorOffsets, AccumulateForceJob, &job );
+
+    // 反発力は評価する位置ごとに求め直す.
+    if ( m_ContactResponse == CONTACT_RESPONSE_PENALTY )
+    {
+        BuildContact( pPool );
+        Dispatch( pPool, m_Hash.GetCount(), PARTICLE_CHUNK_SIZE, AccumulateContactJob, &job );
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      4次のルンゲ・クッタ法による積分計算を行います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::IntegrateRungeKutta4( ThreadPool* pPool )
+{
+    const size_t count = m_Position.size();
+    m_StartPosition.assign( m_Position.begin(), m_Position.end() );
+    m_StartVelocity.assign( m_Velocity.begin(), m_Velocity.end() );
+    m_DeltaPosition.assign( count, Vec3() );
+    m_DeltaVelocity.assign( count, Vec3() );
+
+    NetworkJob job;
+    job.pNetwork = this;
+    job.type     = SIMULATION_TYPE_RUNGE_KUTTA4;
+    job.offset   = 0;
+
+    // 各段で力を求め直し，増分を重み付きで足し込んでから次の段の状態に移る.
+    for( unsigned int stage=0; stage<4; ++stage )
+    {
+        job.stage = stage;
+        ComputeForce( pPool );
+        Dispatch( pPool, count, PARTICLE_CHUNK_SIZE, RungeKutta4StageJob, &job );
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      陰的オイラー法による積分計算を行います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::IntegrateImplicitEular( ThreadPool* pPool )
+{
+    const size_t count = m_Position.size();
+    m_DeltaVelocity.resize( count );
+    m_Residual     .resize( count );
+    m_Direction    .resize( count );
+    m_Product      .resize( count );
+    m_Diagonal     .resize( count );
+    m_Jacobians    .resize( m_Springs.size() );
+
+    NetworkJob job;
+    job.pNetwork = this;
+    job.type     = SIMULATION_TYPE_IMPLICIT_EULAR;
+    job.offset   = 0;
+    job.stage    = 0;
+
+    // 右辺と係数行列のブロックを求める.
+    ComputeForce( pPool );
+    Dispatch( pPool, count, PARTICLE_CHUNK_SIZE, InitImplicitJob, &job );
+    DispatchColors( pPool, m_ColorOffsets, SetupImplicitJob, &job );
+
+    // 固定点の行は解かない. 残差を0にしておけば探索方向も0のままになる.
+    for( size_t i=0; i<count; ++i )
+    {
+        if ( m_InvMass[i] == 0.0f )
+        {
+            m_Residual[i] = Vec3();
+            m_Diagonal[i] = Vec3( 1.0f, 1.0f, 1.0f );
+        }
+    }
+
+    // 対角成分で前処理した共役勾配法. 初期値は dv = 0 なので残差は右辺そのもの.
+    for( size_t i=0; i<count; ++i )
+    {
+        m_Direction[i] = Vec3(
+            m_Residual[i].x / m_Diagonal[i].x,
+            m_Residual[i].y / m_Diagonal[i].y,
+            m_Residual[i].z / m_Diagonal[i].z );
+    }
+
+    const double threshold = double( m_SolverTolerance ) * double( m_SolverTolerance ) * Dot( m_Residual, m_Residual );
+    double rz = Dot( m_Residual, m_Direction );
+
+    m_LastIteration = 0;
+    while( m_LastIteration < m_SolverIteration && Dot( m_Residual, m_Residual ) > threshold )
+    {
+        Multiply( pPool );
+
+        const double pAp = Dot( m_Direction, m_Product );
+        if ( pAp <= 0.0 )
+        { break; }
+
+        const float alpha = float( rz / pAp );
+        for( size_t i=0; i<count; ++i )
+        {
+            m_DeltaVelocity[i] = m_DeltaVelocity[i] + m_Direction[i] * alpha;
+            m_Residual     [i] = m_Residual     [i] - m_Product  [i] * alpha;
+        }
+
+        // 前処理後の残差は m_Product に一時的に格納する.
+        for( size_t i=0; i<count; ++i )
+        {
+            m_Product[i] = Vec3(
+                m_Residual[i].x / m_Diagonal[i].x,
+                m_Residual[i].y / m_Diagonal[i].y,
+                m_Residual[i].z / m_Diagonal[i].z );
+        }
+
+        const double rzNext = Dot( m_Residual, m_Product );
+        const float  beta   = float( rzNext / rz );
+        rz = rzNext;
+
+        for( size_t i=0; i<count; ++i )
+        { m_Direction[i] = m_Product[i] + m_Direction[i] * beta; }
+
+        m_LastIteration++;
+    }
+
+    // 求めた速度の増分で進める.
+    const float dt = m_TimeStep;
+    for( size_t i=0; i<count; ++i )
+    {
+        if ( m_InvMass[i] == 0.0f )
+        { continue; }
+
+        m_PrevPosition[i] = m_Position[i];
+        m_Velocity[i]     = m_Velocity[i] + m_DeltaVelocity[i];
+        m_Position[i]     = m_Position[i] + m_Velocity[i] * dt;
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      拡張位置ベース法による積分計算を行います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::IntegrateXPBD( ThreadPool* pPool )
+{
+    const size_t count = m_Position.size();
+    m_Lambda       .assign( m_Springs.size(), 0.0f );
+    m_SpringDelta  .assign( m_Springs.size(), Vec3() );
+    m_SpringOffsets.resize( count + 1, static_cast<unsigned int>( m_SpringIndices.size() ) );
+
+    NetworkJob job;
+    job.pNetwork = this;
+    job.type     = SIMULATION_TYPE_XPBD;
+    job.offset   = 0;
+    job.stage    = 0;
+
+    // ばねの力は拘束で扱うので，重力と反発力だけで位置を予測する.
+    Dispatch( pPool, count, PARTICLE_CHUNK_SIZE, ClearForceJob, &job );
+    if ( m_ContactResponse == CONTACT_RESPONSE_PENALTY )
+    {
+        BuildContact( pPool );
+        Dispatch( pPool, m_Hash.GetCount(), PARTICLE_CHUNK_SIZE, AccumulateContactJob, &job );
+    }
+    Dispatch( pPool, count, PARTICLE_CHUNK_SIZE, PredictXPBDJob, &job );
+
+    for( unsigned int i=0; i<m_ConstraintIteration; ++i )
+    {
+        if ( m_ConstraintSolver == XPBD_SOLVER_JACOBI )
+        {
+            // ばねごとの補正量を全てのばねで同時に求めてから，質点ごとに集める.
+            Dispatch( pPool, m_Springs.size(), SPRING_CHUNK_SIZE, SolveDistanceJob, &job );
+            Dispatch( pPool, count, PARTICLE_CHUNK_SIZE, GatherJacobiJob, &job );
+        }
+        else
+        {
+            // 同じ色のばねは質点を共有しないので，位置を直接書き換えても競合しない.
+            DispatchColors( pPool, m_ColorOffsets, SolveDistanceJob, &job );
+        }
+    }
+
+    // 位置の変化から速度を求める.
+    Dispatch( pPool, count, PARTICLE_CHUNK_SIZE, FinishXPBDJob, &job );
+}
+
+//----------------------------------------------------------------------------------------
+//      係数行列と探索方向の積を求めます.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::Multiply( ThreadPool* pPool )
+{
+    NetworkJob job;
+    job.pNetwork = this;
+    job.type     = SIMULATION_TYPE_IMPLICIT_EULAR;
+    job.offset   = 0;
+    job.stage    = 0;
+
+    Dispatch( pPool, m_Position.size(), PARTICLE_CHUNK_SIZE, MultiplyDiagonalJob, &job );
+    DispatchColors( pPool, m_ColorOffsets, MultiplySpringJob, &job );
+
+    // 固定点の行は0にする.
+    for( size_t i=0; i<m_Position.size(); ++i )
+    {
+        if ( m_InvMass[i] == 0.0f )
+        { m_Product[i] = Vec3(); }
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      現在の位置で衝突判定用の格子を作り直します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::BuildContact( ThreadPool* pPool )
+{
+    const size_t count = m_Position.size();
+    m_Correction   .resize( count );
+    m_ContactCounts.resize( count );
+
+    // 直径を格子の幅にすれば，接触する相手は必ず隣接する格子に入る.
+    if ( count == 0 || m_ParticleRadius <= 0.0f )
+    { m_Hash.Clear(); }
+    else
+    { m_Hash.Build( &m_Position[0], count, m_ParticleRadius * 2.0f, pPool ); }
+}
+
+//----------------------------------------------------------------------------------------
+//      めり込みを位置の補正で解消し，補正量を速度に反映します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::ProjectContact( ThreadPool* pPool )
+{
+    NetworkJob job;
+    job.pNetwork = this;
+    job.type     = SIMULATION_TYPE_EXPLICIT_EULAR;
+    job.offset   = 0;
+    job.stage    = 0;
+
+    // 補正量を全て求めてから適用するヤコビ法なので，結果はスレッド数に依存しない.
+    for( unsigned int i=0; i<m_ContactIteration; ++i )
+    {
+        BuildContact( pPool );
+        Dispatch( pPool, m_Hash.GetCount(), PARTICLE_CHUNK_SIZE, SolveContactJob, &job );
+        Dispatch( pPool, m_Hash.GetCount(), PARTICLE_CHUNK_SIZE, ApplyContactJob, &job );
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      力を重力で初期化します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::ClearForce( const size_t begin, const size_t end )
+{
+    for( size_t i=begin; i<end; ++i )
+    { m_Force[i] = m_Gravity * m_Mass[i]; }
+}
+
+//----------------------------------------------------------------------------------------
+//      ばねの力を累積します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::AccumulateForce( const size_t begin, const size_t end )
+{
+    for( size_t i=begin; i<end; ++i )
+    {
+        const Edge& edge = m_Springs[i];
+
+        Vec3 diff = m_Position[edge.b] - m_Position[edge.a];
+        const float length = diff.Length();
+        if ( length < MIN_LENGTH )
+        { continue; }
+
+        const Vec3 dir = diff / length;
+
+        // フックの法則による力と，伸縮方向の速度差による減衰.
+        const float stretch  = edge.constantK * ( length - edge.length );
+        const float damping  = m_Damping * Dot( m_Velocity[edge.b] - m_Velocity[edge.a], dir );
+        const Vec3  force    = dir * ( stretch + damping );
+
+        m_Force[edge.a] = m_Force[edge.a] + force;
+        m_Force[edge.b] = m_Force[edge.b] - force;
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      積分計算を行います. 式は Spring1D の各積分方法と同じです.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::Integrate( SIMULATION_TYPE type, const size_t begin, const size_t end )
+{
+    const float dt = m_TimeStep;
+
+    switch( type )
+    {
+    // 陽的オイラー法で更新.
+    case SIMULATION_TYPE_EXPLICIT_EULAR:
+        {
+            for( size_t i=begin; i<end; ++i )
+            {
+                if ( m_InvMass[i] == 0.0f )
+                { continue; }
+
+                const Vec3 accel = m_Force[i] * m_InvMass[i];
+
+                m_PrevPosition[i] = m_Position[i];
+                m_Position[i]     = m_Position[i] + m_Velocity[i] * dt;
+                m_Velocity[i]     = m_Velocity[i] + accel * dt;
+            }
+        }
+        break;
+
+    // 半陰的オイラー法で更新.
+    case SIMULATION_TYPE_SEMI_IMPLICIT_EULAR:
+        {
+            for( size_t i=begin; i<end; ++i )
+            {
+                if ( m_InvMass[i] == 0.0f )
+                { continue; }
+
+                const Vec3 accel = m_Force[i] * m_InvMass[i];
+
+                m_PrevPosition[i] = m_Position[i];
+                m_Velocity[i]     = m_Velocity[i] + accel * dt;
+                m_Position[i]     = m_Position[i] + m_Velocity[i] * dt;
+            }
+        }
+        break;
+
+    // ベルレ法で更新.
+    case SIMULATION_TYPE_VERLET:
+        {
+            for( size_t i=begin; i<end; ++i )
+            {
+                if ( m_InvMass[i] == 0.0f )
+                { continue; }
+
+                const Vec3 accel  = m_Force[i] * m_InvMass[i];
+                const Vec3 newPos = m_Position[i] * 2.0f - m_PrevPosition[i] + accel * ( dt * dt );
+
+                m_Velocity[i]     = ( newPos - m_PrevPosition[i] ) / ( 2.0f * dt );
+                m_PrevPosition[i] = m_Position[i];
+                m_Position[i]     = newPos;
+            }
+        }
+        break;
+
+    // 力を複数回求める積分方法は Step() で処理する.
+    default:
+        break;
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      ルンゲ・クッタ法の1段分の増分を足し込み，次の段の状態を求めます.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::RungeKutta4Stage( const unsigned int stage, const size_t begin, const size_t end )
+{
+    const float dt     = m_TimeStep;
+    const float weight = RK4_STAGE_WEIGHT[stage];
+
+    for( size_t i=begin; i<end; ++i )
+    {
+        if ( m_InvMass[i] == 0.0f )
+        { continue; }
+
+        const Vec3 accel = m_Force[i] * m_InvMass[i];
+
+        m_DeltaPosition[i] = m_DeltaPosition[i] + m_Velocity[i] * weight;
+        m_DeltaVelocity[i] = m_DeltaVelocity[i] + accel * weight;
+
+        if ( stage < 3 )
+        {
+            // 開始状態から今の段の傾きで進めた状態が次の段の評価点になる.
+            const float step = dt * RK4_STAGE_STEP[stage];
+            m_Position[i] = m_StartPosition[i] + m_Velocity[i] * step;
+            m_Velocity[i] = m_StartVelocity[i] + accel * step;
+        }
+        else
+        {
+            m_PrevPosition[i] = m_StartPosition[i];
+            m_Position[i]     = m_StartPosition[i] + m_DeltaPosition[i] * ( dt / 6.0f );
+            m_Velocity[i]     = m_StartVelocity[i] + m_DeltaVelocity[i] * ( dt / 6.0f );
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      陰的オイラー法の右辺と係数行列の対角成分を質量の項で初期化します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::InitImplicit( const size_t begin, const size_t end )
+{
+    const float dt = m_TimeStep;
+
+    for( size_t i=begin; i<end; ++i )
+    {
+        const float mass = m_Mass[i];
+
+        m_DeltaVelocity[i] = Vec3();
+        m_Residual     [i] = m_Force[i] * dt;
+        m_Diagonal     [i] = Vec3( mass, mass, mass );
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      ばねごとの係数行列のブロックを求め，右辺と対角成分に足し込みます.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SetupImplicit( const size_t begin, const size_t end )
+{
+    const float dt  = m_TimeStep;
+    const float dt2 = m_TimeStep * m_TimeStep;
+
+    for( size_t i=begin; i<end; ++i )
+    {
+        const Edge& edge     = m_Springs[i];
+        Jacobian&   jacobian = m_Jacobians[i];
+
+        Vec3 diff = m_Position[edge.b] - m_Position[edge.a];
+        const float length = diff.Length();
+        if ( length < MIN_LENGTH )
+        {
+            jacobian.dir   = Vec3();
+            jacobian.alpha = 0.0f;
+            jacobian.beta  = 0.0f;
+            continue;
+        }
+
+        // dF/dx = k * d * d^T + k * ( 1 - L / l ) * ( I - d * d^T ), dF/dv = c * d * d^T.
+        const float ratio     = 1.0f - edge.length / length;
+        const float lateralK  = ( ratio > 0.0f ) ? edge.constantK * ratio : 0.0f;
+
+        jacobian.dir   = diff / length;
+        jacobian.alpha = dt * m_Damping + dt2 * edge.constantK;
+        jacobian.beta  = dt2 * lateralK;
+
+        // 右辺に h^2 * dF/dx * v を足す.
+        const Vec3 rhs = Transform( jacobian.dir, dt2 * edge.constantK, dt2 * lateralK, m_Velocity[edge.b] - m_Velocity[edge.a] );
+        m_Residual[edge.a] = m_Residual[edge.a] + rhs;
+        m_Residual[edge.b] = m_Residual[edge.b] - rhs;
+
+        // 対角成分は両端点に同じだけ足される.
+        const Vec3& d = jacobian.dir;
+        const float s = jacobian.alpha - jacobian.beta;
+        const Vec3  diagonal( s * d.x * d.x + jacobian.beta, s * d.y * d.y + jacobian.beta, s * d.z * d.z + jacobian.beta );
+        m_Diagonal[edge.a] = m_Diagonal[edge.a] + diagonal;
+        m_Diagonal[edge.b] = m_Diagonal[edge.b] + diagonal;
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      係数行列の質量の項と探索方向の積を求めます.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::MultiplyDiagonal( const size_t begin, const size_t end )
+{
+    for( size_t i=begin; i<end; ++i )
+    { m_Product[i] = m_Direction[i] * m_Mass[i]; }
+}
+
+//----------------------------------------------------------------------------------------
+//      係数行列のばねの項と探索方向の積を足し込みます.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::MultiplySpring( const size_t begin, const size_t end )
+{
+    for( size_t i=begin; i<end; ++i )
+    {
+        const Edge&     edge     = m_Springs[i];
+        const Jacobian& jacobian = m_Jacobians[i];
+
+        const Vec3 value = Transform( jacobian.dir, jacobian.alpha, jacobian.beta, m_Direction[edge.a] - m_Direction[edge.b] );
+        m_Product[edge.a] = m_Product[edge.a] + value;
+        m_Product[edge.b] = m_Product[edge.b] - value;
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      接触している質点と平面から受ける反発力を加えます.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::AccumulateContact( const size_t begin, const size_t end )
+{
+    const unsigned int* pIndices   = m_Hash.GetIndices();
+    const Vec3*         pPositions = m_Hash.GetSortedPositions();
+    const float         radius     = m_ParticleRadius;
+    const float         diameter   = m_ParticleRadius * 2.0f;
+    const float         diameter2  = diameter * diameter;
+
+    unsigned int rangeBegin[SpatialHash::MAX_RANGE];
+    unsigned int rangeEnd  [SpatialHash::MAX_RANGE];
+
+    // ソート後の順に処理して，近い質点を続けて参照する. 書き込むのは自分の質点だけ.
+    for( size_t k=begin; k<end; ++k )
+    {
+        const unsigned int i          = pIndices[k];
+        const Vec3         position   = pPositions[k];
+        const Vec3         velocity   = m_Velocity[i];
+        const unsigned int rangeCount = m_Hash.FindNeighborRanges( position, rangeBegin, rangeEnd );
+
+        Vec3         force;
+        unsigned int contacts = 0;
+
+        for( unsigned int r=0; r<rangeCount; ++r )
+        {
+            for( unsigned int m=rangeBegin[r]; m<rangeEnd[r]; ++m )
+            {
+                if ( m == k )
+                { continue; }
+
+                // 接触しない相手は平方根を求めずに除く.
+                const Vec3  diff      = position - pPositions[m];
+                const float distance2 = Dot( diff, diff );
+                if ( distance2 >= diameter2 || distance2 < MIN_LENGTH * MIN_LENGTH )
+                { continue; }
+
+                const unsigned int j        = pIndices[m];
+                const float        distance = sqrtf( distance2 );
+
+                // 引き寄せる向きの力にはしない.
+                const Vec3  normal    = diff / distance;
+                const float magnitude = m_ContactStiffness * ( diameter - distance ) - m_ContactDamping * Dot( velocity - m_Velocity[j], normal );
+                if ( magnitude > 0.0f )
+                { force = force + normal * magnitude; }
+
+                // 組は番号の小さい方だけで数える.
+                if ( i < j )
+                { contacts++; }
+            }
+        }
+
+        for( size_t p=0; p<m_Planes.size(); ++p )
+        {
+            const Plane& plane = m_Planes[p];
+            const float  depth = radius - ( Dot( plane.normal, position ) - plane.distance );
+            if ( depth <= 0.0f )
+            { continue; }
+
+            const float magnitude = m_ContactStiffness * depth - m_ContactDamping * Dot( velocity, plane.normal );
+            if ( magnitude > 0.0f )
+            { force = force + plane.normal * magnitude; }
+
+            contacts++;
+        }
+
+        m_ContactCounts[i] = contacts;
+
+        if ( m_InvMass[i] != 0.0f )
+        { m_Force[i] = m_Force[i] + force; }
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      質点同士のめり込みを解消する補正量を求めます.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SolveContact( const size_t begin, const size_t end )
+{
+    const unsigned int* pIndices   = m_Hash.GetIndices();
+    const Vec3*         pPositions = m_Hash.GetSortedPositions();
+    const float         diameter   = m_ParticleRadius * 2.0f;
+    const float         diameter2  = diameter * diameter;
+
+    unsigned int rangeBegin[SpatialHash::MAX_RANGE];
+    unsigned int rangeEnd  [SpatialHash::MAX_RANGE];
+
+    for( size_t k=begin; k<end; ++k )
+    {
+        const unsigned int i          = pIndices[k];
+        const Vec3         position   = pPositions[k];
+        const float        invMass    = m_InvMass[i];
+        const unsigned int rangeCount = m_Hash.FindNeighborRanges( position, rangeBegin, rangeEnd );
+
+        Vec3         correction;
+        unsigned int contacts    = 0;
+        unsigned int constraints = 0;
+
+        for( unsigned int r=0; r<rangeCount; ++r )
+        {
+            for( unsigned int m=rangeBegin[r]; m<rangeEnd[r]; ++m )
+            {
+                if ( m == k )
+                { continue; }
+
+                // 接触しない相手は平方根を求めずに除く.
+                const Vec3  diff      = position - pPositions[m];
+                const float distance2 = Dot( diff, diff );
+                if ( distance2 >= diameter2 || distance2 < MIN_LENGTH * MIN_LENGTH )
+                { continue; }
+
+                const unsigned int j        = pIndices[m];
+                const float        distance = sqrtf( distance2 );
+
+                // 質量の逆数の比で分け合う. 相手が固定点なら自分が全て動く.
+                const float weight = ( invMass > 0.0f ) ? invMass / ( invMass + m_InvMass[j] ) : 0.0f;
+                correction = correction + diff * ( ( diameter - distance ) * weight / distance );
+                constraints++;
+
+                if ( i < j )
+                { contacts++; }
+            }
+        }
+
+        // 同じ質点に複数の補正が重なっても行き過ぎないように平均する.
+        m_Correction   [i] = ( constraints > 0 ) ? correction / float( constraints ) : Vec3();
+        m_ContactCounts[i] = contacts;
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      補正量を位置と速度に反映し，平面から押し出します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::ApplyContact( const size_t begin, const size_t end )
+{
+    const unsigned int* pIndices = m_Hash.GetIndices();
+    const float         radius   = m_ParticleRadius;
+    const float         invDt    = 1.0f / m_TimeStep;
+
+    for( size_t k=begin; k<end; ++k )
+    {
+        const unsigned int i = pIndices[k];
+        if ( m_InvMass[i] == 0.0f )
+        { continue; }
+
+        Vec3 position = m_Position[i] + m_Correction[i];
+
+        // 平面は質点ごとに独立なので平均せずにそのまま押し出す.
+        for( size_t p=0; p<m_Planes.size(); ++p )
+        {
+            const Plane& plane = m_Planes[p];
+            const float  depth = radius - ( Dot( plane.normal, position ) - plane.distance );
+            if ( depth <= 0.0f )
+            { continue; }
+
+            position = position + plane.normal * depth;
+            m_ContactCounts[i]++;
+        }
+
+        // 押し出した分は近づく速度を打ち消す向きに働く.
+        m_Velocity[i] = m_Velocity[i] + ( position - m_Position[i] ) * invDt;
+        m_Position[i] = position;
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      外力で速度と位置を予測します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::PredictXPBD( const size_t begin, const size_t end )
+{
+    const float dt = m_TimeStep;
+
+    for( size_t i=begin; i<end; ++i )
+    {
+        m_PrevPosition[i] = m_Position[i];
+
+        if ( m_InvMass[i] == 0.0f )
+        { continue; }
+
+        m_Velocity[i] = m_Velocity[i] + m_Force[i] * ( m_InvMass[i] * dt );
+        m_Position[i] = m_Position[i] + m_Velocity[i] * dt;
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      距離拘束を射影します. ガウス・ザイデル法では1色分を，ヤコビ法では全てのばねを扱います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SolveDistance( const size_t begin, const size_t end )
+{
+    const float dt     = m_TimeStep;
+    const bool  jacobi = ( m_ConstraintSolver == XPBD_SOLVER_JACOBI );
+
+    for( size_t i=begin; i<end; ++i )
+    {
+        const Edge& edge = m_Springs[i];
+        if ( jacobi )
+        { m_SpringDelta[i] = Vec3(); }
+
+        const float weightA = m_InvMass[edge.a];
+        const float weightB = m_InvMass[edge.b];
+        if ( weightA + weightB == 0.0f || edge.constantK <= 0.0f )
+        { continue; }
+
+        Vec3 diff = m_Position[edge.b] - m_Position[edge.a];
+        const float length = diff.Length();
+        if ( length < MIN_LENGTH )
+        { continue; }
+
+        const Vec3 dir = diff / length;
+
+        // 適合度 alpha = 1 / k と，減衰係数 c から求めた gamma = alpha * c / dt を使う.
+        const float compliance = 1.0f / ( edge.constantK * dt * dt );
+        const float gamma      = compliance * m_Damping * dt;
+        const float relative   = Dot( dir, ( m_Position[edge.b] - m_PrevPosition[edge.b] ) - ( m_Position[edge.a] - m_PrevPosition[edge.a] ) );
+        const float constraint = length - edge.length;
+
+        float deltaLambda = ( -constraint - compliance * m_Lambda[i] - gamma * relative )
+                          / ( ( 1.0f + gamma ) * ( weightA + weightB ) + compliance );
+
+        if ( jacobi )
+        {
+            // 端点の接続数の多い方で割って緩和する. 乗数にも実際に動かした分だけを積まないと，
+            // 乗数だけが先に進んで平衡位置がずれる.
+            const unsigned int countA = m_SpringOffsets[edge.a + 1] - m_SpringOffsets[edge.a];
+            const unsigned int countB = m_SpringOffsets[edge.b + 1] - m_SpringOffsets[edge.b];
+            deltaLambda *= m_ConstraintRelaxation / float( ( countA > countB ) ? countA : countB );
+        }
+
+        m_Lambda[i] += deltaLambda;
+
+        const Vec3 correction = dir * deltaLambda;
+        if ( jacobi )
+        { m_SpringDelta[i] = correction; }
+        else
+        {
+            m_Position[edge.a] = m_Position[edge.a] - correction * weightA;
+            m_Position[edge.b] = m_Position[edge.b] + correction * weightB;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      ヤコビ法のばねごとの補正量を質点ごとに集めて反映します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::GatherJacobi( const size_t begin, const size_t end )
+{
+    for( size_t i=begin; i<end; ++i )
+    {
+        const float weight = m_InvMass[i];
+        if ( weight == 0.0f )
+        { continue; }
+
+        // 接続表はばねの番号順なので，スレッド数によらず同じ順序で足し合わせる.
+        Vec3 delta;
+        for( unsigned int j=m_SpringOffsets[i]; j<m_SpringOffsets[i + 1]; ++j )
+        {
+            const unsigned int spring = m_SpringIndices[j];
+            if ( m_Springs[spring].a == i )
+            { delta = delta - m_SpringDelta[spring]; }
+            else
+            { delta = delta + m_SpringDelta[spring]; }
+        }
+
+        m_Position[i] = m_Position[i] + delta * weight;
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      位置の変化から速度を求めます.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::FinishXPBD( const size_t begin, const size_t end )
+{
+    const float invDt = 1.0f / m_TimeStep;
+
+    for( size_t i=begin; i<end; ++i )
+    {
+        if ( m_InvMass[i] == 0.0f )
+        { continue; }
+
+        m_Velocity[i] = ( m_Position[i] - m_PrevPosition[i] ) * invDt;
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      力の初期化を並列に行います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::ClearForceJob( size_t begin, size_t end, void* pUser )
+{
+    const NetworkJob* pJob = static_cast<const NetworkJob*>( pUser );
+    pJob->pNetwork->ClearForce( begin, end );
+}
+
+//----------------------------------------------------------------------------------------
+//      1色分のばねの力の累積を並列に行います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::AccumulateForceJob( size_t begin, size_t end, void* pUser )
+{
+    const NetworkJob* pJob = static_cast<const NetworkJob*>( pUser );
+    pJob->pNetwork->AccumulateForce( pJob->offset + begin, pJob->offset + end );
+}
+
+//----------------------------------------------------------------------------------------
+//      積分計算を並列に行います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::IntegrateJob( size_t begin, size_t end, void* pUser )
+{
+    const NetworkJob* pJob = static_cast<const NetworkJob*>( pUser );
+    pJob->pNetwork->Integrate( pJob->type, begin, end );
+}
+
+//----------------------------------------------------------------------------------------
+//      ルンゲ・クッタ法の1段分を並列に行います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::RungeKutta4StageJob( size_t begin, size_t end, void* pUser )
+{
+    const NetworkJob* pJob = static_cast<const NetworkJob*>( pUser );
+    pJob->pNetwork->RungeKutta4Stage( pJob->stage, begin, end );
+}
+
+//----------------------------------------------------------------------------------------
+//      陰的オイラー法の初期化を並列に行います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::InitImplicitJob( size_t begin, size_t end, void* pUser )
+{
+    const NetworkJob* pJob = static_cast<const NetworkJob*>( pUser );
+    pJob->pNetwork->InitImplicit( begin, end );
+}
+
+//----------------------------------------------------------------------------------------
+//      1色分のばねの係数行列のブロックの計算を並列に行います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SetupImplicitJob( size_t begin, size_t end, void* pUser )
+{
+    const NetworkJob* pJob = static_cast<const NetworkJob*>( pUser );
+    pJob->pNetwork->SetupImplicit( pJob->offset + begin, pJob->offset + end );
+}
+
+//----------------------------------------------------------------------------------------
+//      係数行列の質量の項の積を並列に求めます.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::MultiplyDiagonalJob( size_t begin, size_t end, void* pUser )
+{
+    const NetworkJob* pJob = static_cast<const NetworkJob*>( pUser );
+    pJob->pNetwork->MultiplyDiagonal( begin, end );
+}
+
+//----------------------------------------------------------------------------------------
+//      1色分のばねの係数行列の積を並列に足し込みます.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::MultiplySpringJob( size_t begin, size_t end, void* pUser )
+{
+    const NetworkJob* pJob = static_cast<const NetworkJob*>( pUser );
+    pJob->pNetwork->MultiplySpring( pJob->offset + begin, pJob->offset + end );
+}
+
+//----------------------------------------------------------------------------------------
+//      反発力の計算を並列に行います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::AccumulateContactJob( size_t begin, size_t end, void* pUser )
+{
+    const NetworkJob* pJob = static_cast<const NetworkJob*>( pUser );
+    pJob->pNetwork->AccumulateContact( begin, end );
+}
+
+//----------------------------------------------------------------------------------------
+//      めり込みの補正量の計算を並列に行います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SolveContactJob( size_t begin, size_t end, void* pUser )
+{
+    const NetworkJob* pJob = static_cast<const NetworkJob*>( pUser );
+    pJob->pNetwork->SolveContact( begin, end );
+}
+
+//----------------------------------------------------------------------------------------
+//      めり込みの補正量の反映を並列に行います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::ApplyContactJob( size_t begin, size_t end, void* pUser )
+{
+    const NetworkJob* pJob = static_cast<const NetworkJob*>( pUser );
+    pJob->pNetwork->ApplyContact( begin, end );
+}
+
+//----------------------------------------------------------------------------------------
+//      外力による予測を並列に行います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::PredictXPBDJob( size_t begin, size_t end, void* pUser )
+{
+    const NetworkJob* pJob = static_cast<const NetworkJob*>( pUser );
+    pJob->pNetwork->PredictXPBD( begin, end );
+}
+
+//----------------------------------------------------------------------------------------
+//      距離拘束の射影を並列に行います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SolveDistanceJob( size_t begin, size_t end, void* pUser )
+{
+    const NetworkJob* pJob = static_cast<const NetworkJob*>( pUser );
+    pJob->pNetwork->SolveDistance( pJob->offset + begin, pJob->offset + end );
+}
+
+//----------------------------------------------------------------------------------------
+//      ヤコビ法の補正量の集計を並列に行います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::GatherJacobiJob( size_t begin, size_t end, void* pUser )
+{
+    const NetworkJob* pJob = static_cast<const NetworkJob*>( pUser );
+    pJob->pNetwork->GatherJacobi( begin, end );
+}
+
+//----------------------------------------------------------------------------------------
+//      速度の計算を並列に行います.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::FinishXPBDJob( size_t begin, size_t end, void* pUser )
+{
+    const NetworkJob* pJob = static_cast<const NetworkJob*>( pUser );
+    pJob->pNetwork->FinishXPBD( begin, end );
+}
+
+//----------------------------------------------------------------------------------------
+//      重力加速度を設定します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SetGravity( const Vec3& value )
+{ m_Gravity = value; }
+
+//----------------------------------------------------------------------------------------
+//      タイムステップ(微小時間）を設定します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SetTimeStep( const float value )
+{ m_TimeStep = value; }
+
+//----------------------------------------------------------------------------------------
+//      減衰係数を設定します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SetDamping( const float value )
+{ m_Damping = value; }
+
+//----------------------------------------------------------------------------------------
+//      質点を固定するかどうかを設定します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SetFixed( const unsigned int index, const bool fixed )
+{
+    assert( index < m_Position.size() );
+
+    // 固定を解除した場合は元の質量に戻す.
+    m_InvMass[index] = ( fixed || m_Mass[index] <= 0.0f ) ? 0.0f : 1.0f / m_Mass[index];
+
+    if ( fixed )
+    {
+        m_Velocity    [index] = Vec3();
+        m_PrevPosition[index] = m_Position[index];
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      共役勾配法の最大反復回数を設定します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SetSolverIteration( const unsigned int value )
+{ m_SolverIteration = value; }
+
+//----------------------------------------------------------------------------------------
+//      共役勾配法の収束判定に使う相対残差を設定します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SetSolverTolerance( const float value )
+{ m_SolverTolerance = value; }
+
+//----------------------------------------------------------------------------------------
+//      質点の半径を設定します. 0以下の場合は衝突を判定しません.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SetParticleRadius( const float value )
+{ m_ParticleRadius = value; }
+
+//----------------------------------------------------------------------------------------
+//      衝突の処理方法を設定します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SetContactResponse( const CONTACT_RESPONSE value )
+{
+    m_ContactResponse = value;
+
+    // 処理しない間に前の接触数が残らないようにする.
+    m_ContactCounts.assign( m_ContactCounts.size(), 0 );
+}
+
+//----------------------------------------------------------------------------------------
+//      反発力のばね定数を設定します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SetContactStiffness( const float value )
+{ m_ContactStiffness = value; }
+
+//----------------------------------------------------------------------------------------
+//      反発力の法線方向の減衰係数を設定します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SetContactDamping( const float value )
+{ m_ContactDamping = value; }
+
+//----------------------------------------------------------------------------------------
+//      位置の補正の反復回数を設定します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SetContactIteration( const unsigned int value )
+{ m_ContactIteration = value; }
+
+//----------------------------------------------------------------------------------------
+//      距離拘束の解き方を設定します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SetConstraintSolver( const XPBD_SOLVER value )
+{ m_ConstraintSolver = value; }
+
+//----------------------------------------------------------------------------------------
+//      距離拘束の反復回数を設定します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SetConstraintIteration( const unsigned int value )
+{ m_ConstraintIteration = value; }
+
+//----------------------------------------------------------------------------------------
+//      ヤコビ法の緩和係数を設定します.
+//----------------------------------------------------------------------------------------
+void SpringNetwork::SetConstraintRelaxation( const float value )
+{ m_ConstraintRelaxation = value; }
+
+//----------------------------------------------------------------------------------------
+//      重力加速度を取得します.
+//----------------------------------------------------------------------------------------
+Vec3 SpringNetwork::GetGravity() const
+{ return m_Gravity; }
+
+//----------------------------------------------------------------------------------------
+//      タイムステップを取得します.
+//----------------------------------------------------------------------------------------
+float SpringNetwork::GetTimeStep() const
+{ return m_TimeStep; }
+
+//----------------------------------------------------------------------------------------
+//      減衰係数を取得します.
+//----------------------------------------------------------------------------------------
+float SpringNetwork::GetDamping() const
+{ return m_Damping; }
+
+//----------------------------------------------------------------------------------------
+//      共役勾配法の最大反復回数を取得します.
+//----------------------------------------------------------------------------------------
+unsigned int SpringNetwork::GetSolverIteration() const
+{ return m_SolverIteration; }
+
+//----------------------------------------------------------------------------------------
+//      共役勾配法の収束判定に使う相対残差を取得します.
+//----------------------------------------------------------------------------------------
+float SpringNetwork::GetSolverTolerance() const
+{ return m_SolverTolerance; }
+
+//----------------------------------------------------------------------------------------
+//      質点の半径を取得します.
+//----------------------------------------------------------------------------------------
+float SpringNetwork::GetParticleRadius() const
+{ return m_ParticleRadius; }
+
+//----------------------------------------------------------------------------------------
+//      衝突の処理方法を取得します.
+//----------------------------------------------------------------------------------------
+CONTACT_RESPONSE SpringNetwork::GetContactResponse() const
+{ return m_ContactResponse; }
+
+//----------------------------------------------------------------------------------------
+//      反発力のばね定数を取得します.
+//----------------------------------------------------------------------------------------
+float SpringNetwork::GetContactStiffness() const
+{ return m_ContactStiffness; }
+
+//----------------------------------------------------------------------------------------
+//      反発力の法線方向の減衰係数を取得します.
+//----------------------------------------------------------------------------------------
+float SpringNetwork::GetContactDamping() const
+{ return m_ContactDamping; }
+
+//----------------------------------------------------------------------------------------
+//      位置の補正の反復回数を取得します.
+//----------------------------------------------------------------------------------------
+unsigned int SpringNetwork::GetContactIteration() const
+{ return m_ContactIteration; }
+
+//----------------------------------------------------------------------------------------
+//      距離拘束の解き方を取得します.
+//----------------------------------------------------------------------------------------
+XPBD_SOLVER SpringNetwork::GetConstraintSolver() const
+{ return m_ConstraintSolver; }
+
+//----------------------------------------------------------------------------------------
+//      距離拘束の反復回数を取得します.
+//----------------------------------------------------------------------------------------
+unsigned int SpringNetwork::GetConstraintIteration() const
+{ return m_ConstraintIteration; }
+
+//----------------------------------------------------------------------------------------
+//      ヤコビ法の緩和係数を取得します.
+//----------------------------------------------------------------------------------------
+float SpringNetwork::GetConstraintRelaxation() const
+{ return m_ConstraintRelaxation; }
+
+//----------------------------------------------------------------------------------------
+//      平面の数を取得します.
+//----------------------------------------------------------------------------------------
+unsigned int SpringNetwork::GetPlaneCount() const
+{ return static_cast<unsigned int>( m_Planes.size() ); }
+
+//----------------------------------------------------------------------------------------
+//      直前のステップで接触していた組の数を取得します. 質点と平面の組も含みます.
+//----------------------------------------------------------------------------------------
+unsigned int SpringNetwork::GetContactCount() const
+{
+    unsigned int result = 0;
+    for( size_t i=0; i<m_ContactCounts.size(); ++i )
+    { result += m_ContactCounts[i]; }
+
+    return result;
+}
+
+//----------------------------------------------------------------------------------------
+//      直前の共役勾配法の反復回数を取得します.
+//----------------------------------------------------------------------------------------
+unsigned int SpringNetwork::GetLastIteration() const
+{ return m_LastIteration; }
+
+//----------------------------------------------------------------------------------------
+//      質点の数を取得します.
+//----------------------------------------------------------------------------------------
+unsigned int SpringNetwork::GetParticleCount() const
+{ return static_cast<unsigned int>( m_Position.size() ); }
+
+//----------------------------------------------------------------------------------------
+//      ばねの数を取得します.
+//----------------------------------------------------------------------------------------
+unsigned int SpringNetwork::GetSpringCount() const
+{ return static_cast<unsigned int>( m_Springs.size() ); }
+
+//----------------------------------------------------------------------------------------
+//      彩色した色の数を取得します.
+//----------------------------------------------------------------------------------------
+unsigned int SpringNetwork::GetColorCount() const
+{ return m_ColorOffsets.empty() ? 0 : static_cast<unsigned int>( m_ColorOffsets.size() - 1 ); }
+
+//----------------------------------------------------------------------------------------
+//      質点が固定されているかどうかチェックします.
+//----------------------------------------------------------------------------------------
+bool SpringNetwork::IsFixed( const unsigned int index ) const
+{ return ( m_InvMass[index] == 0.0f ); }
+
+//----------------------------------------------------------------------------------------
+//      質量を取得します.
+//----------------------------------------------------------------------------------------
+float SpringNetwork::GetMass( const unsigned int index ) const
+{ return m_Mass[index]; }
+
+//----------------------------------------------------------------------------------------
+//      位置座標を取得します.
+//----------------------------------------------------------------------------------------
+const Vec3& SpringNetwork::GetPosition( const unsigned int index ) const
+{ return m_Position[index]; }
+
+//----------------------------------------------------------------------------------------
+//      速度を取得します.
+//----------------------------------------------------------------------------------------
+const Vec3& SpringNetwork::GetVelocity( const unsigned int index ) const
+{ return m_Velocity[index]; }
+
+//----------------------------------------------------------------------------------------
+//      ばねを取得します.
+//----------------------------------------------------------------------------------------
+const SpringNetwork::Edge& SpringNetwork::GetSpring( const unsigned int index ) const
+{ return m_Springs[index]; }
+
+//----------------------------------------------------------------------------------------
+//      位置座標の配列を取得します.
+//----------------------------------------------------------------------------------------
+const Vec3* SpringNetwork::GetPositions() const
+{ return m_Position.empty() ? nullptr : &m_Position[0]; }
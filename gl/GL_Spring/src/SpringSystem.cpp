@@ -0,0 +1,738 @@
+﻿//----------------------------------------------------------------------------------------
+// File : SpringSystem.cpp
+// Desc : Batched Spring Simulator Module.
+// Copyright(c) Project Asura. All right reserved.
+//----------------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------------
+#include <SpringSystem.h>
+#include <cassert>
+
+#if defined(__AVX512F__)
+    #define SPRING_SIMD_WIDTH   8
+    #include <immintrin.h>
+#elif defined(__AVX__)
+    #define SPRING_SIMD_WIDTH   4
+    #include <immintrin.h>
+#elif defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 ) || defined(__SSE2__)
+    #define SPRING_SIMD_WIDTH   2
+    #include <emmintrin.h>
+#else
+    #define SPRING_SIMD_WIDTH   1
+#endif
+
+
+namespace /* anonymous */ {
+
+//----------------------------------------------------------------------------------------
+// Constant Values
+//----------------------------------------------------------------------------------------
+// 1チャンクの6配列分(4096 * 8byte * 6 = 192KB)がL2キャッシュに収まる程度にする.
+static const size_t DEFAULT_CHUNK_SIZE = 4096;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// StepJob structure
+//////////////////////////////////////////////////////////////////////////////////////////
+struct StepJob
+{
+    SpringSystem*       pSystem;            // 更新するばねです.
+    SIMULATION_TYPE     type;               // 積分方法です.
+    unsigned int        substepCount;       // サブステップ数です.
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// ScalarOps structure
+//////////////////////////////////////////////////////////////////////////////////////////
+struct ScalarOps
+{
+    typedef double Type;
+    enum { WIDTH = 1 };
+
+    static Type Load ( const double* p )        { return *p; }
+    static void Store( double* p, Type v )      { *p = v; }
+    static Type Set  ( double v )               { return v; }
+    static Type Add  ( Type a, Type b )         { return a + b; }
+    static Type Sub  ( Type a, Type b )         { return a - b; }
+    static Type Mul  ( Type a, Type b )         { return a * b; }
+    static Type Div  ( Type a, Type b )         { return a / b; }
+    static Type Neg  ( Type a )                 { return -a; }
+};
+
+#if SPRING_SIMD_WIDTH == 8
+//////////////////////////////////////////////////////////////////////////////////////////
+// SimdOps structure (AVX-512)
+//////////////////////////////////////////////////////////////////////////////////////////
+struct SimdOps
+{
+    typedef __m512d Type;
+    enum { WIDTH = 8 };
+
+    static Type Load ( const double* p )        { return _mm512_loadu_pd( p ); }
+    static void Store( double* p, Type v )      { _mm512_storeu_pd( p, v ); }
+    static Type Set  ( double v )               { return _mm512_set1_pd( v ); }
+    static Type Add  ( Type a, Type b )         { return _mm512_add_pd( a, b ); }
+    static Type Sub  ( Type a, Type b )         { return _mm512_sub_pd( a, b ); }
+    static Type Mul  ( Type a, Type b )         { return _mm512_mul_pd( a, b ); }
+    static Type Div  ( Type a, Type b )         { return _mm512_div_pd( a, b ); }
+    static Type Neg  ( Type a )
+    { return _mm512_castsi512_pd( _mm512_xor_si512( _mm512_castpd_si512( a ), _mm512_set1_epi64( 0x8000000000000000LL ) ) ); }
+};
+#elif SPRING_SIMD_WIDTH == 4
+//////////////////////////////////////////////////////////////////////////////////////////
+// SimdOps structure (AVX)
+//////////////////////////////////////////////////////////////////////////////////////////
+struct SimdOps
+{
+    typedef __m256d Type;
+    enum { WIDTH = 4 };
+
+    static Type Load ( const double* p )        { return _mm256_loadu_pd( p ); }
+    static void Store( double* p, Type v )      { _mm256_storeu_pd( p, v ); }
+    static Type Set  ( double v )               { return _mm256_set1_pd( v ); }
+    static Type Add  ( Type a, Type b )         { return _mm256_add_pd( a, b ); }
+    static Type Sub  ( Type a, Type b )         { return _mm256_sub_pd( a, b ); }
+    static Type Mul  ( Type a, Type b )         { return _mm256_mul_pd( a, b ); }
+    static Type Div  ( Type a, Type b )         { return _mm256_div_pd( a, b ); }
+    static Type Neg  ( Type a )                 { return _mm256_xor_pd( a, _mm256_set1_pd( -0.0 ) ); }
+};
+#elif SPRING_SIMD_WIDTH == 2
+//////////////////////////////////////////////////////////////////////////////////////////
+// SimdOps structure (SSE2)
+//////////////////////////////////////////////////////////////////////////////////////////
+struct SimdOps
+{
+    typedef __m128d Type;
+    enum { WIDTH = 2 };
+
+    static Type Load ( const double* p )        { return _mm_loadu_pd( p ); }
+    static void Store( double* p, Type v )      { _mm_storeu_pd( p, v ); }
+    static Type Set  ( double v )               { return _mm_set1_pd( v ); }
+    static Type Add  ( Type a, Type b )         { return _mm_add_pd( a, b ); }
+    static Type Sub  ( Type a, Type b )         { return _mm_sub_pd( a, b ); }
+    static Type Mul  ( Type a, Type b )         { return _mm_mul_pd( a, b ); }
+    static Type Div  ( Type a, Type b )         { return _mm_div_pd( a, b ); }
+    static Type Neg  ( Type a )                 { return _mm_xor_pd( a, _mm_set1_pd( -0.0 ) ); }
+};
+#else
+typedef ScalarOps SimdOps;
+#endif
+
+//----------------------------------------------------------------------------------------
+//      加速度を求めます. Spring1D::UpdateAccel() と同じ演算順序で計算します.
+//----------------------------------------------------------------------------------------
+template<typename OPS>
+typename OPS::Type CalcAccel
+(
+    typename OPS::Type  mass,
+    typename OPS::Type  constantK,
+    typename OPS::Type  length,
+    typename OPS::Type  position,
+    typename OPS::Type  gravity
+)
+{
+    // フックの法則により力を求める.
+    const typename OPS::Type force = OPS::Add(
+        OPS::Mul( OPS::Neg( constantK ), OPS::Sub( position, length ) ),
+        OPS::Mul( mass, gravity ) );
+
+    // 加速度を求める.
+    return OPS::Div( force, mass );
+}
+
+//----------------------------------------------------------------------------------------
+//      陽的オイラー法で [begin, end) を WIDTH 単位で積分し，処理した終端を返却します.
+//----------------------------------------------------------------------------------------
+template<typename OPS>
+size_t IntegrateExplicitEularKernel
+(
+    const double*   pMass,
+    const double*   pConstantK,
+    const double*   pLength,
+    double*         pPosition,
+    double*         pPrevPosition,
+    double*         pVelocity,
+    size_t          begin,
+    size_t          end,
+    double          gravity,
+    double          timeStep
+)
+{
+    typedef typename OPS::Type T;
+    const T g  = OPS::Set( gravity );
+    const T dt = OPS::Set( timeStep );
+
+    size_t i = begin;
+    for( ; i + OPS::WIDTH <= end; i += OPS::WIDTH )
+    {
+        const T x = OPS::Load( pPosition + i );
+        const T v = OPS::Load( pVelocity + i );
+        const T a = CalcAccel<OPS>( OPS::Load( pMass + i ), OPS::Load( pConstantK + i ), OPS::Load( pLength + i ), x, g );
+
+        OPS::Store( pPrevPosition + i, x );
+        OPS::Store( pPosition     + i, OPS::Add( x, OPS::Mul( v, dt ) ) );
+        OPS::Store( pVelocity     + i, OPS::Add( v, OPS::Mul( a, dt ) ) );
+    }
+
+    return i;
+}
+
+//----------------------------------------------------------------------------------------
+//      半陰的オイラー法で [begin, end) を WIDTH 単位で積分し，処理した終端を返却します.
+//----------------------------------------------------------------------------------------
+template<typename OPS>
+size_t IntegrateSemiImplicitEularKernel
+(
+    const double*   pMass,
+    const double*   pConstantK,
+    const double*   pLength,
+    double*         pPosition,
+    double*         pPrevPosition,
+    double*         pVelocity,
+    size_t          begin,
+    size_t          end,
+    double          gravity,
+    double          timeStep
+)
+{
+    typedef typename OPS::Type T;
+    const T g  = OPS::Set( gravity );
+    const T dt = OPS::Set( timeStep );
+
+    size_t i = begin;
+    for( ; i + OPS::WIDTH <= end; i += OPS::WIDTH )
+    {
+        const T x = OPS::Load( pPosition + i );
+        const T a = CalcAccel<OPS>( OPS::Load( pMass + i ), OPS::Load( pConstantK + i ), OPS::Load( pLength + i ), x, g );
+
+        const T v = OPS::Add( OPS::Load( pVelocity + i ), OPS::Mul( a, dt ) );
+
+        OPS::Store( pPrevPosition + i, x );
+        OPS::Store( pVelocity     + i, v );
+        OPS::Store( pPosition     + i, OPS::Add( x, OPS::Mul( v, dt ) ) );
+    }
+
+    return i;
+}
+
+//----------------------------------------------------------------------------------------
+//      ベルレ法で [begin, end) を WIDTH 単位で積分し，処理した終端を返却します.
+//----------------------------------------------------------------------------------------
+template<typename OPS>
+size_t IntegrateVerletKernel
+(
+    const double*   pMass,
+    const double*   pConstantK,
+    const double*   pLength,
+    double*         pPosition,
+    double*         pPrevPosition,
+    double*         pVelocity,
+    size_t          begin,
+    size_t          end,
+    double          gravity,
+    double          timeStep
+)
+{
+    typedef typename OPS::Type T;
+    const T g     = OPS::Set( gravity );
+    const T two   = OPS::Set( 2.0 );
+    const T dt2   = OPS::Set( timeStep * timeStep );
+    const T twoDt = OPS::Set( 2.0 * timeStep );
+
+    size_t i = begin;
+    for( ; i + OPS::WIDTH <= end; i += OPS::WIDTH )
+    {
+        const T x    = OPS::Load( pPosition     + i );
+        const T prev = OPS::Load( pPrevPosition + i );
+        const T a    = CalcAccel<OPS>( OPS::Load( pMass + i ), OPS::Load( pConstantK + i ), OPS::Load( pLength + i ), x, g );
+
+        const T newPos = OPS::Add( OPS::Sub( OPS::Mul( two, x ), prev ), OPS::Mul( a, dt2 ) );
+
+        OPS::Store( pVelocity     + i, OPS::Div( OPS::Sub( newPos, prev ), twoDt ) );
+        OPS::Store( pPrevPosition + i, x );
+        OPS::Store( pPosition     + i, newPos );
+    }
+
+    return i;
+}
+
+//----------------------------------------------------------------------------------------
+//      4次のルンゲ・クッタ法で [begin, end) を WIDTH 単位で積分し，処理した終端を返却します.
+//----------------------------------------------------------------------------------------
+template<typename OPS>
+size_t IntegrateRungeKutta4Kernel
+(
+    const double*   pMass,
+    const double*   pConstantK,
+    const double*   pLength,
+    double*         pPosition,
+    double*         pPrevPosition,
+    double*         pVelocity,
+    size_t          begin,
+    size_t          end,
+    double          gravity,
+    double          timeStep
+)
+{
+    typedef typename OPS::Type T;
+    const T g      = OPS::Set( gravity );
+    const T two    = OPS::Set( 2.0 );
+    const T dt     = OPS::Set( timeStep );
+    const T halfDt = OPS::Set( timeStep * 0.5 );
+    const T sixth  = OPS::Set( timeStep / 6.0 );
+
+    size_t i = begin;
+    for( ; i + OPS::WIDTH <= end; i += OPS::WIDTH )
+    {
+        const T m = OPS::Load( pMass      + i );
+        const T k = OPS::Load( pConstantK + i );
+        const T l = OPS::Load( pLength    + i );
+        const T x = OPS::Load( pPosition  + i );
+        const T v = OPS::Load( pVelocity  + i );
+
+        const T v1 = v;
+        const T a1 = CalcAccel<OPS>( m, k, l, x, g );
+        const T v2 = OPS::Add( v, OPS::Mul( a1, halfDt ) );
+        const T a2 = CalcAccel<OPS>( m, k, l, OPS::Add( x, OPS::Mul( v1, halfDt ) ), g );
+        const T v3 = OPS::Add( v, OPS::Mul( a2, halfDt ) );
+        const T a3 = CalcAccel<OPS>( m, k, l, OPS::Add( x, OPS::Mul( v2, halfDt ) ), g );
+        const T v4 = OPS::Add( v, OPS::Mul( a3, dt ) );
+        const T a4 = CalcAccel<OPS>( m, k, l, OPS::Add( x, OPS::Mul( v3, dt ) ), g );
+
+        const T sumV = OPS::Add( OPS::Add( OPS::Add( v1, OPS::Mul( two, v2 ) ), OPS::Mul( two, v3 ) ), v4 );
+        const T sumA = OPS::Add( OPS::Add( OPS::Add( a1, OPS::Mul( two, a2 ) ), OPS::Mul( two, a3 ) ), a4 );
+
+        OPS::Store( pPrevPosition + i, x );
+        OPS::Store( pPosition     + i, OPS::Add( x, OPS::Mul( sumV, sixth ) ) );
+        OPS::Store( pVelocity     + i, OPS::Add( v, OPS::Mul( sumA, sixth ) ) );
+    }
+
+    return i;
+}
+
+//----------------------------------------------------------------------------------------
+//      陰的オイラー法で [begin, end) を WIDTH 単位で積分し，処理した終端を返却します.
+//----------------------------------------------------------------------------------------
+template<typename OPS>
+size_t IntegrateImplicitEularKernel
+(
+    const double*   pMass,
+    const double*   pConstantK,
+    const double*   pLength,
+    double*         pPosition,
+    double*         pPrevPosition,
+    double*         pVelocity,
+    size_t          begin,
+    size_t          end,
+    double          gravity,
+    double          timeStep
+)
+{
+    typedef typename OPS::Type T;
+    const T g   = OPS::Set( gravity );
+    const T one = OPS::Set( 1.0 );
+    const T dt  = OPS::Set( timeStep );
+
+    size_t i = begin;
+    for( ; i + OPS::WIDTH <= end; i += OPS::WIDTH )
+    {
+        const T m = OPS::Load( pMass      + i );
+        const T k = OPS::Load( pConstantK + i );
+        const T x = OPS::Load( pPosition  + i );
+        const T a = CalcAccel<OPS>( m, k, OPS::Load( pLength + i ), x, g );
+
+        const T stiffness = OPS::Div( k, m );
+        const T denom     = OPS::Add( one, OPS::Mul( OPS::Mul( stiffness, dt ), dt ) );
+        const T v         = OPS::Div( OPS::Add( OPS::Load( pVelocity + i ), OPS::Mul( a, dt ) ), denom );
+
+        OPS::Store( pPrevPosition + i, x );
+        OPS::Store( pVelocity     + i, v );
+        OPS::Store( pPosition     + i, OPS::Add( x, OPS::Mul( v, dt ) ) );
+    }
+
+    return i;
+}
+
+//----------------------------------------------------------------------------------------
+//      拡張位置ベース法で [begin, end) を WIDTH 単位で積分し，処理した終端を返却します.
+//----------------------------------------------------------------------------------------
+template<typename OPS>
+size_t IntegrateXPBDKernel
+(
+    const double*   pMass,
+    const double*   pConstantK,
+    const double*   pLength,
+    double*         pPosition,
+    double*         pPrevPosition,
+    double*         pVelocity,
+    size_t          begin,
+    size_t          end,
+    double          gravity,
+    double          timeStep
+)
+{
+    typedef typename OPS::Type T;
+    const T g   = OPS::Set( gravity );
+    const T one = OPS::Set( 1.0 );
+    const T dt  = OPS::Set( timeStep );
+
+    size_t i = begin;
+    for( ; i + OPS::WIDTH <= end; i += OPS::WIDTH )
+    {
+        const T x = OPS::Load( pPosition + i );
+        const T v = OPS::Load( pVelocity + i );
+
+        // 重力だけで予測してから，距離拘束を適合度 1 / k で射影する.
+        const T predicted  = OPS::Add( x, OPS::Mul( OPS::Add( v, OPS::Mul( g, dt ) ), dt ) );
+        const T invMass    = OPS::Div( one, OPS::Load( pMass + i ) );
+        const T compliance = OPS::Div( one, OPS::Mul( OPS::Mul( OPS::Load( pConstantK + i ), dt ), dt ) );
+        const T lambda     = OPS::Div( OPS::Neg( OPS::Sub( predicted, OPS::Load( pLength + i ) ) ), OPS::Add( invMass, compliance ) );
+        const T position   = OPS::Add( predicted, OPS::Mul( invMass, lambda ) );
+
+        OPS::Store( pPrevPosition + i, x );
+        OPS::Store( pVelocity     + i, OPS::Div( OPS::Sub( position, x ), dt ) );
+        OPS::Store( pPosition     + i, position );
+    }
+
+    return i;
+}
+
+//----------------------------------------------------------------------------------------
+//      1チャンク分のばねを全サブステップ更新します.
+//----------------------------------------------------------------------------------------
+void StepChunk( size_t begin, size_t end, void* pUser )
+{
+    const StepJob* pJob = static_cast<const StepJob*>( pUser );
+
+    for( unsigned int i=0; i<pJob->substepCount; ++i )
+    { pJob->pSystem->Update( pJob->type, begin, end ); }
+}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// SpringSystem class
+//////////////////////////////////////////////////////////////////////////////////////////
+
+//----------------------------------------------------------------------------------------
+//      コンストラクタです.
+//----------------------------------------------------------------------------------------
+SpringSystem::SpringSystem()
+: m_Gravity  ( 9.8 )
+, m_TimeStep ( 0.00001 )
+, m_ChunkSize( DEFAULT_CHUNK_SIZE )
+{ /* DO_NOTHING */ }
+
+//----------------------------------------------------------------------------------------
+//      デストラクタです.
+//----------------------------------------------------------------------------------------
+SpringSystem::~SpringSystem()
+{ Clear(); }
+
+//----------------------------------------------------------------------------------------
+//      ばねの数を変更します. 追加されたばねは Spring1D の既定値で初期化されます.
+//----------------------------------------------------------------------------------------
+void SpringSystem::Resize( const size_t count )
+{
+    m_Mass        .resize( count, 1.0 );
+    m_ConstantK   .resize( count, 0.0 );
+    m_Length      .resize( count, 0.0 );
+    m_Position    .resize( count, 0.0 );
+    m_PrevPosition.resize( count, 0.0 );
+    m_Velocity    .resize( count, 0.0 );
+}
+
+//----------------------------------------------------------------------------------------
+//      全てのばねを破棄します.
+//----------------------------------------------------------------------------------------
+void SpringSystem::Clear()
+{
+    std::vector<double>().swap( m_Mass );
+    std::vector<double>().swap( m_ConstantK );
+    std::vector<double>().swap( m_Length );
+    std::vector<double>().swap( m_Position );
+    std::vector<double>().swap( m_PrevPosition );
+    std::vector<double>().swap( m_Velocity );
+}
+
+//----------------------------------------------------------------------------------------
+//      ばねのパラメータを設定します.
+//----------------------------------------------------------------------------------------
+void SpringSystem::SetSpring
+(
+    const size_t index,
+    const double mass,
+    const double constantK,
+    const double length,
+    const double initPosition,
+    const double initVelocity
+)
+{
+    assert( index < m_Mass.size() );
+
+    m_Mass        [index] = mass;
+    m_ConstantK   [index] = constantK;
+    m_Length      [index] = length;
+    m_Position    [index] = initPosition;
+    m_PrevPosition[index] = initPosition;
+    m_Velocity    [index] = initVelocity;
+}
+
+//----------------------------------------------------------------------------------------
+//      更新処理を行います.
+//----------------------------------------------------------------------------------------
+void SpringSystem::Update( SIMULATION_TYPE type )
+{ Update( type, 0, m_Position.size() ); }
+
+//----------------------------------------------------------------------------------------
+//      指定範囲の更新処理を行います.
+//----------------------------------------------------------------------------------------
+void SpringSystem::Update( SIMULATION_TYPE type, const size_t begin, const size_t end )
+{
+    assert( begin <= end && end <= m_Position.size() );
+
+    switch( type )
+    {
+    // 陽的オイラー法で更新.
+    case SIMULATION_TYPE_EXPLICIT_EULAR:
+        { IntegrateExplicitEular( begin, end ); }
+        break;
+
+    // ベルレ法で更新.
+    case SIMULATION_TYPE_VERLET:
+        { IntegrateVerlet( begin, end ); }
+        break;
+
+    // 半陰的オイラー法で更新.
+    case SIMULATION_TYPE_SEMI_IMPLICIT_EULAR:
+        { IntegrateSemiImplicitEular( begin, end ); }
+        break;
+
+    // 4次のルンゲ・クッタ法で更新.
+    case SIMULATION_TYPE_RUNGE_KUTTA4:
+        { IntegrateRungeKutta4( begin, end ); }
+        break;
+
+    // 陰的オイラー法で更新.
+    case SIMULATION_TYPE_IMPLICIT_EULAR:
+        { IntegrateImplicitEular( begin, end ); }
+        break;
+
+    // 拡張位置ベース法で更新.
+    case SIMULATION_TYPE_XPBD:
+        { IntegrateXPBD( begin, end ); }
+        break;
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      スレッドプールで更新処理を行います.
+//----------------------------------------------------------------------------------------
+void SpringSystem::Update( SIMULATION_TYPE type, ThreadPool& pool, const unsigned int substepCount )
+{
+    StepJob job;
+    job.pSystem      = this;
+    job.type         = type;
+    job.substepCount = substepCount;
+
+    pool.ParallelFor( m_Position.size(), m_ChunkSize, StepChunk, &job );
+}
+
+//----------------------------------------------------------------------------------------
+//      陽的オイラー法による積分計算を行います.
+//----------------------------------------------------------------------------------------
+void SpringSystem::IntegrateExplicitEular( const size_t begin, const size_t end )
+{
+    if ( begin >= end )
+    { return; }
+
+    // SIMD幅で割り切れない残りはスカラーで処理する.
+    size_t i = IntegrateExplicitEularKernel<SimdOps>(
+        &m_Mass[0], &m_ConstantK[0], &m_Length[0], &m_Position[0], &m_PrevPosition[0], &m_Velocity[0],
+        begin, end, m_Gravity, m_TimeStep );
+
+    IntegrateExplicitEularKernel<ScalarOps>(
+        &m_Mass[0], &m_ConstantK[0], &m_Length[0], &m_Position[0], &m_PrevPosition[0], &m_Velocity[0],
+        i, end, m_Gravity, m_TimeStep );
+}
+
+//----------------------------------------------------------------------------------------
+//      ベルレ法による積分計算を行います.
+//----------------------------------------------------------------------------------------
+void SpringSystem::IntegrateVerlet( const size_t begin, const size_t end )
+{
+    if ( begin >= end )
+    { return; }
+
+    // SIMD幅で割り切れない残りはスカラーで処理する.
+    size_t i = IntegrateVerletKernel<SimdOps>(
+        &m_Mass[0], &m_ConstantK[0], &m_Length[0], &m_Position[0], &m_PrevPosition[0], &m_Velocity[0],
+        begin, end, m_Gravity, m_TimeStep );
+
+    IntegrateVerletKernel<ScalarOps>(
+        &m_Mass[0], &m_ConstantK[0], &m_Length[0], &m_Position[0], &m_PrevPosition[0], &m_Velocity[0],
+        i, end, m_Gravity, m_TimeStep );
+}
+
+//----------------------------------------------------------------------------------------
+//      半陰的オイラー法による積分計算を行います.
+//----------------------------------------------------------------------------------------
+void SpringSystem::IntegrateSemiImplicitEular( const size_t begin, const size_t end )
+{
+    if ( begin >= end )
+    { return; }
+
+    // SIMD幅で割り切れない残りはスカラーで処理する.
+    size_t i = IntegrateSemiImplicitEularKernel<SimdOps>(
+        &m_Mass[0], &m_ConstantK[0], &m_Length[0], &m_Position[0], &m_PrevPosition[0], &m_Velocity[0],
+        begin, end, m_Gravity, m_TimeStep );
+
+    IntegrateSemiImplicitEularKernel<ScalarOps>(
+        &m_Mass[0], &m_ConstantK[0], &m_Length[0], &m_Position[0], &m_PrevPosition[0], &m_Velocity[0],
+        i, end, m_Gravity, m_TimeStep );
+}
+
+//----------------------------------------------------------------------------------------
+//      4次のルンゲ・クッタ法による積分計算を行います.
+//----------------------------------------------------------------------------------------
+void SpringSystem::IntegrateRungeKutta4( const size_t begin, const size_t end )
+{
+    if ( begin >= end )
+    { return; }
+
+    // SIMD幅で割り切れない残りはスカラーで処理する.
+    size_t i = IntegrateRungeKutta4Kernel<SimdOps>(
+        &m_Mass[0], &m_ConstantK[0], &m_Length[0], &m_Position[0], &m_PrevPosition[0], &m_Velocity[0],
+        begin, end, m_Gravity, m_TimeStep );
+
+    IntegrateRungeKutta4Kernel<ScalarOps>(
+        &m_Mass[0], &m_ConstantK[0], &m_Length[0], &m_Position[0], &m_PrevPosition[0], &m_Velocity[0],
+        i, end, m_Gravity, m_TimeStep );
+}
+
+//----------------------------------------------------------------------------------------
+//      陰的オイラー法による積分計算を行います.
+//----------------------------------------------------------------------------------------
+void SpringSystem::IntegrateImplicitEular( const size_t begin, const size_t end )
+{
+    if ( begin >= end )
+    { return; }
+
+    // SIMD幅で割り切れない残りはスカラーで処理する.
+    size_t i = IntegrateImplicitEularKernel<SimdOps>(
+        &m_Mass[0], &m_ConstantK[0], &m_Length[0], &m_Position[0], &m_PrevPosition[0], &m_Velocity[0],
+        begin, end, m_Gravity, m_TimeStep );
+
+    IntegrateImplicitEularKernel<ScalarOps>(
+        &m_Mass[0], &m_ConstantK[0], &m_Length[0], &m_Position[0], &m_PrevPosition[0], &m_Velocity[0],
+        i, end, m_Gravity, m_TimeStep );
+}
+
+//----------------------------------------------------------------------------------------
+//      拡張位置ベース法による積分計算を行います.
+//----------------------------------------------------------------------------------------
+void SpringSystem::IntegrateXPBD( const size_t begin, const size_t end )
+{
+    if ( begin >= end )
+    { return; }
+
+    // SIMD幅で割り切れない残りはスカラーで処理する.
+    size_t i = IntegrateXPBDKernel<SimdOps>(
+        &m_Mass[0], &m_ConstantK[0], &m_Length[0], &m_Position[0], &m_PrevPosition[0], &m_Velocity[0],
+        begin, end, m_Gravity, m_TimeStep );
+
+    IntegrateXPBDKernel<ScalarOps>(
+        &m_Mass[0], &m_ConstantK[0], &m_Length[0], &m_Position[0], &m_PrevPosition[0], &m_Velocity[0],
+        i, end, m_Gravity, m_TimeStep );
+}
+
+//----------------------------------------------------------------------------------------
+//      重力加速度を設定します.
+//----------------------------------------------------------------------------------------
+void SpringSystem::SetGravity( const double value )
+{ m_Gravity = value; }
+
+//----------------------------------------------------------------------------------------
+//      タイムステップ(微小時間）を設定します.
+//----------------------------------------------------------------------------------------
+void SpringSystem::SetTimeStep( const double value )
+{ m_TimeStep = value; }
+
+//----------------------------------------------------------------------------------------
+//      並列更新時の1チャンクあたりのばねの数を設定します.
+//----------------------------------------------------------------------------------------
+void SpringSystem::SetChunkSize( const size_t value )
+{
+    // SIMD幅の倍数に切り上げて，チャンク境界でスカラー処理が挟まらないようにする.
+    const size_t width = SPRING_SIMD_WIDTH;
+    m_ChunkSize = ( value < width ) ? width : ( value + width - 1 ) / width * width;
+}
+
+//----------------------------------------------------------------------------------------
+//      ばねの数を取得します.
+//----------------------------------------------------------------------------------------
+size_t SpringSystem::GetCount() const
+{ return m_Position.size(); }
+
+//----------------------------------------------------------------------------------------
+//      重力加速度を取得します.
+//----------------------------------------------------------------------------------------
+double SpringSystem::GetGravity() const
+{ return m_Gravity; }
+
+//----------------------------------------------------------------------------------------
+//      タイムステップを取得します.
+//----------------------------------------------------------------------------------------
+double SpringSystem::GetTimeStep() const
+{ return m_TimeStep; }
+
+//----------------------------------------------------------------------------------------
+//      並列更新時の1チャンクあたりのばねの数を取得します.
+//----------------------------------------------------------------------------------------
+size_t SpringSystem::GetChunkSize() const
+{ return m_ChunkSize; }
+
+//----------------------------------------------------------------------------------------
+//      質量を取得します.
+//----------------------------------------------------------------------------------------
+double SpringSystem::GetMass( const size_t index ) const
+{ return m_Mass[index]; }
+
+//----------------------------------------------------------------------------------------
+//      ばね定数を取得します.
+//----------------------------------------------------------------------------------------
+double SpringSystem::GetConstantK( const size_t index ) const
+{ return m_ConstantK[index]; }
+
+//----------------------------------------------------------------------------------------
+//      自然長を取得します.
+//----------------------------------------------------------------------------------------
+double SpringSystem::GetLength( const size_t index ) const
+{ return m_Length[index]; }
+
+//----------------------------------------------------------------------------------------
+//      位置座標を取得します.
+//----------------------------------------------------------------------------------------
+double SpringSystem::GetPosition( const size_t index ) const
+{ return m_Position[index]; }
+
+//----------------------------------------------------------------------------------------
+//      速度を取得します.
+//----------------------------------------------------------------------------------------
+double SpringSystem::GetVelocity( const size_t index ) const
+{ return m_Velocity[index]; }
+
+//----------------------------------------------------------------------------------------
+//      位置座標の配列を取得します.
+//----------------------------------------------------------------------------------------
+const double* SpringSystem::GetPositions() const
+{ return m_Position.empty() ? nullptr : &m_Position[0]; }
+
+//----------------------------------------------------------------------------------------
+//      速度の配列を取得します.
+//----------------------------------------------------------------------------------------
+const double* SpringSystem::GetVelocities() const
+{ return m_Velocity.empty() ? nullptr : &m_Velocity[0]; }
@@ -0,0 +1,170 @@
+﻿//----------------------------------------------------------------------------------------
+// File : ThreadPool.cpp
+// Desc : Thread Pool Module.
+// Copyright(c) Project Asura. All right reserved.
+//----------------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------------
+#include <ThreadPool.h>
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// ThreadPool class
+//////////////////////////////////////////////////////////////////////////////////////////
+
+//----------------------------------------------------------------------------------------
+//      コンストラクタです.
+//----------------------------------------------------------------------------------------
+ThreadPool::ThreadPool()
+: m_Generation  ( 0 )
+, m_Running     ( 0 )
+, m_Exit        ( false )
+, m_Func        ( nullptr )
+, m_pUser       ( nullptr )
+, m_Count       ( 0 )
+, m_ChunkSize   ( 1 )
+, m_NextChunk   ( 0 )
+{ /* DO_NOTHING */ }
+
+//----------------------------------------------------------------------------------------
+//      デストラクタです.
+//----------------------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{ Term(); }
+
+//----------------------------------------------------------------------------------------
+//      ワーカースレッドを起動します.
+//----------------------------------------------------------------------------------------
+void ThreadPool::Init( unsigned int threadCount )
+{
+    Term();
+
+    if ( threadCount == 0 )
+    { threadCount = std::thread::hardware_concurrency(); }
+    if ( threadCount < 1 )
+    { threadCount = 1; }
+
+    // 呼び出し元のスレッドも処理に参加するので1つ少なく起動する.
+    m_Exit = false;
+    m_Threads.reserve( threadCount - 1 );
+    for( unsigned int i=0; i<threadCount - 1; ++i )
+    { m_Threads.push_back( std::thread( &ThreadPool::Worker, this ) ); }
+}
+
+//----------------------------------------------------------------------------------------
+//      ワーカースレッドを終了します.
+//----------------------------------------------------------------------------------------
+void ThreadPool::Term()
+{
+    if ( m_Threads.empty() )
+    { return; }
+
+    {
+        std::lock_guard<std::mutex> locker( m_Mutex );
+        m_Exit = true;
+    }
+    m_StartCondition.notify_all();
+
+    for( size_t i=0; i<m_Threads.size(); ++i )
+    { m_Threads[i].join(); }
+
+    m_Threads.clear();
+}
+
+//----------------------------------------------------------------------------------------
+//      呼び出し元を含むスレッド数を取得します.
+//----------------------------------------------------------------------------------------
+unsigned int ThreadPool::GetThreadCount() const
+{ return static_cast<unsigned int>( m_Threads.size() ) + 1; }
+
+//----------------------------------------------------------------------------------------
+//      範囲を分割して並列に処理します.
+//----------------------------------------------------------------------------------------
+void ThreadPool::ParallelFor( size_t count, size_t chunkSize, Func func, void* pUser )
+{
+    if ( count == 0 )
+    { return; }
+
+    if ( chunkSize == 0 )
+    { chunkSize = 1; }
+
+    // 1チャンクに収まる場合は起こす分だけ無駄になる.
+    if ( count <= chunkSize )
+    {
+        func( 0, count, pUser );
+        return;
+    }
+
+    // ワーカーがいなくてもチャンク単位で呼び出す. 範囲全体を1回で渡すと，
+    // チャンク内でサブステップを回してキャッシュに載せたまま進める処理が効かなくなる.
+    if ( m_Threads.empty() )
+    {
+        for( size_t begin=0; begin<count; begin+=chunkSize )
+        { func( begin, ( count - begin < chunkSize ) ? count : begin + chunkSize, pUser ); }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> locker( m_Mutex );
+        m_Func      = func;
+        m_pUser     = pUser;
+        m_Count     = count;
+        m_ChunkSize = chunkSize;
+        m_NextChunk = 0;
+        m_Running   = static_cast<unsigned int>( m_Threads.size() );
+        m_Generation++;
+    }
+    m_StartCondition.notify_all();
+
+    RunChunks();
+
+    std::unique_lock<std::mutex> locker( m_Mutex );
+    while( m_Running > 0 )
+    { m_DoneCondition.wait( locker ); }
+}
+
+//----------------------------------------------------------------------------------------
+//      ワーカースレッドの処理です.
+//----------------------------------------------------------------------------------------
+void ThreadPool::Worker()
+{
+    unsigned long long generation = 0;
+
+    for( ;; )
+    {
+        {
+            std::unique_lock<std::mutex> locker( m_Mutex );
+            while( !m_Exit && m_Generation == generation )
+            { m_StartCondition.wait( locker ); }
+
+            if ( m_Exit )
+            { return; }
+
+            generation = m_Generation;
+        }
+
+        RunChunks();
+
+        std::lock_guard<std::mutex> locker( m_Mutex );
+        if ( --m_Running == 0 )
+        { m_DoneCondition.notify_one(); }
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      チャンクが無くなるまで取り出して処理します.
+//----------------------------------------------------------------------------------------
+void ThreadPool::RunChunks()
+{
+    for( ;; )
+    {
+        const size_t begin = m_NextChunk.fetch_add( m_ChunkSize );
+        if ( begin >= m_Count )
+        { break; }
+
+        const size_t end = ( m_Count - begin > m_ChunkSize ) ? begin + m_ChunkSize : m_Count;
+        m_Func( begin, end, m_pUser );
+    }
+}
@@ -20,13 +20,78 @@
 // Includes
 //-------------------------------------------------------------------------------------------
 #include <iostream>
+#include <cstdio>
+#include <cstring>
 #include <GL/freeglut.h>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
 #include <Mouse.h>
 #include <Spring.h>
+#include <SpringNetwork.h>
+#include <SimulationClock.h>
+#include <TripleBuffer.h>
+#include <SpringDiagnostics.h>
 
 
 namespace /* anonymous */ {
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+// DEMO_MODE enum
+/////////////////////////////////////////////////////////////////////////////////////////////
+enum DEMO_MODE
+{
+    DEMO_MODE_SPRING = 0,       //!< 1次元のばね.
+    DEMO_MODE_CLOTH,            //!< 布.
+    DEMO_MODE_PARTICLES,        //!< 衝突する質点.
+};
+
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+const unsigned int  CLOTH_COUNT         = 24;       // 布の1辺あたりの質点数.
+const double        CLOTH_TIME_STEP     = 0.002;    // 布の微小時間.
+const double        SPRING_TIME_STEP    = 0.01;     // 1次元のばねの微小時間.
+const unsigned int  MAX_SUBSTEP         = 16;       // 1回の待ち合わせで進める最大ステップ数.
+const unsigned int  PARTICLE_COUNT      = 16;       // 質点の1辺あたりの数.
+const double        PARTICLE_TIME_STEP  = 0.005;    // 質点の微小時間. 位置の補正は刻み幅に依らず安定.
+const float         PARTICLE_RADIUS     = 0.4f;     // 質点の半径.
+const float         PARTICLE_BOX_SIZE   = 10.0f;    // 質点を閉じ込める箱の半分の幅.
+
+//-------------------------------------------------------------------------------------------
+// Type Definitions
+//-------------------------------------------------------------------------------------------
+typedef std::chrono::high_resolution_clock  HighResolutionClock;
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// RenderState structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct RenderState
+{
+    DEMO_MODE                       mode;               //!< 表示するモードです.
+    double                          springPosition[2];  //!< 1つ前と最新のステップのばねの位置です.
+    std::vector<Vec3>               networkPosition[2]; //!< 1つ前と最新のステップの布・質点の位置です.
+    double                          timeStep;           //!< 1ステップの時間です.
+    double                          accumulator;        //!< 公開時点でステップに満たなかった時間です.
+    HighResolutionClock::time_point publishTime;        //!< 公開した時刻です.
+    SpringSummary                   summary;            //!< 積分の安定性の集計結果です.
+    double                          stepTime;           //!< 1ステップあたりの計算時間(ミリ秒)です.
+
+    RenderState()
+    : mode          ( DEMO_MODE_SPRING )
+    , timeStep      ( SPRING_TIME_STEP )
+    , accumulator   ( 0.0 )
+    , publishTime   ( HighResolutionClock::now() )
+    , summary       ()
+    , stepTime      ( 0.0 )
+    {
+        springPosition[0] = 0.0;
+        springPosition[1] = 0.0;
+    }
+};
+
 //-------------------------------------------------------------------------------------------
 // Global Variables
 //-------------------------------------------------------------------------------------------
@@ -37,10 +102,36 @@ int         g_WindowHeight      = 512;
 double      g_AspectRatio       = g_WindowWidth / g_WindowHeight;
 char        g_WindowTitle[]     = "Spring Simulator";
 Camera      g_Camera;
-Spring1D    g_Spring;
+
+// シミュレーションスレッドだけが触る変数.
+Spring1D            g_Spring;
+SpringNetwork       g_Cloth;
+SpringNetwork       g_Particles;
+ThreadPool          g_ThreadPool;
+SimulationClock     g_Clock;
+DEMO_MODE           g_Mode = DEMO_MODE_SPRING;
+SIMULATION_TYPE     g_SimulationType = SIMULATION_TYPE_VERLET;
+SpringDiagnostics<> g_Diagnostics;
+bool                g_DivergeReported = false;
+
+// スレッド間で受け渡す変数.
+std::thread                 g_SimulationThread;
+std::atomic<bool>           g_Exit         ( false );
+std::atomic<int>            g_RequestMode  ( DEMO_MODE_SPRING );
+std::atomic<int>            g_RequestType  ( SIMULATION_TYPE_VERLET );
+std::atomic<int>            g_RequestSolver( XPBD_SOLVER_GAUSS_SEIDEL );
+std::atomic<bool>           g_RequestReset ( false );
+TripleBuffer<RenderState>   g_RenderStates;
+
+// 描画スレッドだけが触る変数.
+std::vector<Vec3>   g_NetworkPositions;
+std::vector<Vec3>   g_ClothNormals;
+char                g_CurrentTitle[256] = "";
 
 GLfloat     g_ColorObj [4] = { 0.0, 1.0, 0.0, 1.0 };   // 重りの色
 GLfloat     g_ColorLine[4] = { 1.0, 1.0, 1.0, 1.0 };   // 線の色
+GLfloat     g_ColorCloth[4] = { 1.0, 0.5, 0.2, 1.0 };  // 布の色
+GLfloat     g_ColorParticle[4] = { 1.0, 1.0, 0.2, 1.0 };  // 質点の色
 
 //-------------------------------------------------------------------------------------------
 //      ライティングの設定を行います.
@@ -60,6 +151,382 @@ void SetLighting()
     glLightfv( GL_LIGHT0, GL_SPECULAR, lightSpecularColor );
 }
 
+//-------------------------------------------------------------------------------------------
+//      ばねを初期状態に戻します.
+//-------------------------------------------------------------------------------------------
+void ResetSpring()
+{
+    g_Spring.SetMass        ( 1.0 );
+    g_Spring.SetGravity     ( 9.8 );
+    g_Spring.SetTimeStep    ( SPRING_TIME_STEP );
+    g_Spring.SetConstantK   ( 100.0 );
+    g_Spring.SetLength      ( 0.0 );
+    g_Spring.SetInitVelocity( 10.0 );
+    g_Spring.SetInitPosition( 10.0 );
+}
+
+//-------------------------------------------------------------------------------------------
+//      布を初期状態に戻します.
+//-------------------------------------------------------------------------------------------
+void ResetCloth()
+{
+    g_Cloth.CreateCloth( CLOTH_COUNT, CLOTH_COUNT, Vec3( -10.0f, 10.0f, -10.0f ), 20.0f, 20.0f, 1.0f, 50.0f );
+    g_Cloth.SetTimeStep( float( CLOTH_TIME_STEP ) );
+    g_Cloth.SetDamping ( 0.05f );
+}
+
+//-------------------------------------------------------------------------------------------
+//      質点を初期状態に戻します. 床と壁で囲んだ箱の中に落とします.
+//-------------------------------------------------------------------------------------------
+void ResetParticles()
+{
+    const float spacing = PARTICLE_RADIUS * 2.5f;
+    const float offset  = -0.5f * spacing * float( PARTICLE_COUNT - 1 );
+
+    g_Particles.CreateParticles( PARTICLE_COUNT, PARTICLE_COUNT, PARTICLE_COUNT, Vec3( offset, 0.0f, offset ), spacing, 0.01f );
+    g_Particles.SetTimeStep       ( float( PARTICLE_TIME_STEP ) );
+    g_Particles.SetParticleRadius ( PARTICLE_RADIUS );
+    g_Particles.SetContactResponse( CONTACT_RESPONSE_PROJECTION );
+
+    g_Particles.ClearPlanes();
+    g_Particles.AddPlane( Vec3(  0.0f, 1.0f,  0.0f ), -PARTICLE_BOX_SIZE );
+    g_Particles.AddPlane( Vec3(  1.0f, 0.0f,  0.0f ), -PARTICLE_BOX_SIZE );
+    g_Particles.AddPlane( Vec3( -1.0f, 0.0f,  0.0f ), -PARTICLE_BOX_SIZE );
+    g_Particles.AddPlane( Vec3(  0.0f, 0.0f,  1.0f ), -PARTICLE_BOX_SIZE );
+    g_Particles.AddPlane( Vec3(  0.0f, 0.0f, -1.0f ), -PARTICLE_BOX_SIZE );
+}
+
+//-------------------------------------------------------------------------------------------
+//      積分方法の切り替えを要求します. 発散しても戻せるようにばねと布と質点は初期状態に戻します.
+//-------------------------------------------------------------------------------------------
+void ChangeSimulationType( SIMULATION_TYPE type )
+{
+    g_RequestType .store( type );
+    g_RequestReset.store( true );
+}
+
+//-------------------------------------------------------------------------------------------
+//      描画スレッドからの要求を反映します. 状態が変わった場合は true を返却します.
+//-------------------------------------------------------------------------------------------
+bool ApplyRequest()
+{
+    const DEMO_MODE       mode   = static_cast<DEMO_MODE>      ( g_RequestMode.load() );
+    const SIMULATION_TYPE type   = static_cast<SIMULATION_TYPE>( g_RequestType.load() );
+    const XPBD_SOLVER     solver = static_cast<XPBD_SOLVER>    ( g_RequestSolver.load() );
+    const bool            reset  = g_RequestReset.exchange( false );
+
+    if ( mode == g_Mode && type == g_SimulationType && !reset )
+    { return false; }
+
+    g_Cloth    .SetConstraintSolver( solver );
+    g_Particles.SetConstraintSolver( solver );
+
+    if ( reset )
+    {
+        ResetSpring();
+        ResetCloth();
+        ResetParticles();
+    }
+
+    g_Mode           = mode;
+    g_SimulationType = type;
+
+    // モードごとに微小時間が違うので，蓄積した時間は捨てる.
+    switch( mode )
+    {
+    case DEMO_MODE_CLOTH:
+        { g_Clock.SetTimeStep( CLOTH_TIME_STEP ); }
+        break;
+
+    case DEMO_MODE_PARTICLES:
+        { g_Clock.SetTimeStep( PARTICLE_TIME_STEP ); }
+        break;
+
+    default:
+        { g_Clock.SetTimeStep( SPRING_TIME_STEP ); }
+        break;
+    }
+    g_Clock.Reset();
+
+    // 計測もやり直す.
+    g_Diagnostics.Reset();
+    g_DivergeReported = false;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      計測結果を受け取ります. 発散した場合は1度だけコンソールに表示します.
+//-------------------------------------------------------------------------------------------
+void OnSample( const SpringSample& sample, void* pUser )
+{
+    bool* pReported = static_cast<bool*>( pUser );
+    if ( sample.invalidCount == 0 || *pReported )
+    { return; }
+
+    std::cout << "Warning : simulation diverged at step " << sample.step << " (t = " << sample.time << ")" << std::endl;
+    *pReported = true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      シミュレーションを1ステップ進めます.
+//-------------------------------------------------------------------------------------------
+void StepSimulation()
+{
+    if ( g_Mode == DEMO_MODE_CLOTH )
+    {
+        g_Cloth.Update( g_SimulationType, g_ThreadPool );
+        g_Diagnostics.Record( g_Cloth );
+    }
+    else if ( g_Mode == DEMO_MODE_PARTICLES )
+    {
+        g_Particles.Update( g_SimulationType, g_ThreadPool );
+        g_Diagnostics.Record( g_Particles );
+    }
+    else
+    {
+        g_Spring.Update( g_SimulationType );
+        g_Diagnostics.Record( g_Spring );
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      現在の状態を描画用に書き出します.
+//-------------------------------------------------------------------------------------------
+void CaptureState( RenderState& state, const int slot )
+{
+    if ( g_Mode == DEMO_MODE_CLOTH || g_Mode == DEMO_MODE_PARTICLES )
+    {
+        const SpringNetwork& network    = ( g_Mode == DEMO_MODE_CLOTH ) ? g_Cloth : g_Particles;
+        const Vec3*          pPositions = network.GetPositions();
+        state.networkPosition[slot].assign( pPositions, pPositions + network.GetParticleCount() );
+    }
+    else
+    { state.springPosition[slot] = g_Spring.GetPosition(); }
+}
+
+//-------------------------------------------------------------------------------------------
+//      シミュレーションスレッドの処理です.
+//-------------------------------------------------------------------------------------------
+void SimulationMain()
+{
+    HighResolutionClock::time_point prevTime = HighResolutionClock::now();
+    bool dirty = true;
+
+    while( !g_Exit.load() )
+    {
+        if ( ApplyRequest() )
+        { dirty = true; }
+
+        // 経過時間を固定の微小時間に換算する. 描画の頻度には依存しない.
+        const HighResolutionClock::time_point currTime = HighResolutionClock::now();
+        const double elapsedTime = std::chrono::duration_cast<std::chrono::microseconds>( currTime - prevTime ).count() * 1e-6;
+        prevTime = currTime;
+
+        const unsigned int count = g_Clock.Advance( elapsedTime );
+        if ( count == 0 && !dirty )
+        {
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+            continue;
+        }
+
+        // 描画側で補間できるように，最後のステップの前後の状態を書き出す.
+        RenderState& state = g_RenderStates.GetWriteBuffer();
+        if ( count == 0 )
+        { CaptureState( state, 0 ); }
+
+        // 積分方法ごとの負荷を比べられるように，1ステップあたりの時間を計る.
+        const HighResolutionClock::time_point beginTime = HighResolutionClock::now();
+        for( unsigned int i=0; i<count; ++i )
+        {
+            if ( i + 1 == count )
+            { CaptureState( state, 0 ); }
+
+            StepSimulation();
+        }
+        if ( count > 0 )
+        {
+            const HighResolutionClock::time_point endTime = HighResolutionClock::now();
+            state.stepTime = std::chrono::duration_cast<std::chrono::microseconds>( endTime - beginTime ).count() * 1e-3 / count;
+        }
+
+        CaptureState( state, 1 );
+        state.mode        = g_Mode;
+        state.timeStep    = g_Clock.GetTimeStep();
+        state.accumulator = g_Clock.GetAccumulator();
+        state.publishTime = currTime;
+        state.summary     = g_Diagnostics.GetSummary();
+
+        g_RenderStates.Publish();
+        dirty = false;
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      補間係数を求めます.
+//-------------------------------------------------------------------------------------------
+double CalcAlpha( const RenderState& state )
+{
+    // 公開後に経過した時間もステップに満たない時間として加える.
+    const HighResolutionClock::time_point currTime = HighResolutionClock::now();
+    const double elapsedTime = std::chrono::duration_cast<std::chrono::microseconds>( currTime - state.publishTime ).count() * 1e-6;
+    const double alpha = ( state.accumulator + elapsedTime ) / state.timeStep;
+
+    // シミュレーションが遅れている場合は最新の状態で止める.
+    if ( alpha < 0.0 ) { return 0.0; }
+    if ( alpha > 1.0 ) { return 1.0; }
+    return alpha;
+}
+
+//-------------------------------------------------------------------------------------------
+//      計測結果をウィンドウタイトルに表示します.
+//-------------------------------------------------------------------------------------------
+void UpdateTitle( const SpringSummary& summary, const double stepTime )
+{
+    char title[256];
+    if ( summary.diverged )
+    { sprintf_s( title, sizeof(title), "%s - diverged at step %llu - %.3f ms/step", g_WindowTitle, summary.invalidStep, stepTime ); }
+    else if ( summary.sampleCount > 0 )
+    { sprintf_s( title, sizeof(title), "%s - energy drift %.2f%% - %.3f ms/step", g_WindowTitle, summary.maxDrift * 100.0, stepTime ); }
+    else
+    { sprintf_s( title, sizeof(title), "%s", g_WindowTitle ); }
+
+    // 変わった場合だけ設定する.
+    if ( strcmp( title, g_CurrentTitle ) != 0 )
+    {
+        glutSetWindowTitle( title );
+        strcpy_s( g_CurrentTitle, sizeof(g_CurrentTitle), title );
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      外積を求めます.
+//-------------------------------------------------------------------------------------------
+Vec3 Cross( const Vec3& a, const Vec3& b )
+{
+    return Vec3(
+        ( a.y * b.z ) - ( a.z * b.y ),
+        ( a.z * b.x ) - ( a.x * b.z ),
+        ( a.x * b.y ) - ( a.y * b.x ) );
+}
+
+//-------------------------------------------------------------------------------------------
+//      1次元のばねを描画します.
+//-------------------------------------------------------------------------------------------
+void DrawSpring( const double position )
+{
+    //　固定点の描画
+    glPushMatrix();
+    glColor4fv(g_ColorLine);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT,  g_ColorLine);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE,  g_ColorLine);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, g_ColorLine);
+    glTranslated(0.0, 10.0, 0.0);
+    glutSolidSphere(1.0, 5, 5);
+    glPopMatrix();
+
+    //　線の描画
+    glLineWidth(5.0);
+    glBegin(GL_LINES);
+    glColor4fv(g_ColorLine);
+    glVertex3d(0.0, 10.0, 0.0);
+    glVertex3d(0.0, position, 0.0);
+    glEnd();
+
+    //　物体の描画
+    glPushMatrix();
+    glColor4fv(g_ColorObj);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT,  g_ColorObj);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE,  g_ColorObj);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, g_ColorObj);
+    glTranslated(0.0, position, 0.0);
+    glutSolidSphere(2.0, 5, 5);
+    glPopMatrix();
+}
+
+//-------------------------------------------------------------------------------------------
+//      布を描画します.
+//-------------------------------------------------------------------------------------------
+void DrawCloth( const std::vector<Vec3>& positions )
+{
+    if ( positions.size() != CLOTH_COUNT * CLOTH_COUNT )
+    { return; }
+
+    const Vec3* pPositions = &positions[0];
+
+    // 面法線を頂点に足し込んで頂点法線を求める.
+    g_ClothNormals.assign( positions.size(), Vec3() );
+    for( unsigned int z=0; z + 1<CLOTH_COUNT; ++z )
+    {
+        for( unsigned int x=0; x + 1<CLOTH_COUNT; ++x )
+        {
+            const unsigned int i0 = x + z * CLOTH_COUNT;
+            const unsigned int i1 = i0 + 1;
+            const unsigned int i2 = i0 + CLOTH_COUNT;
+            const unsigned int i3 = i2 + 1;
+
+            const Vec3 normal = Cross( pPositions[i2] - pPositions[i0], pPositions[i1] - pPositions[i0] );
+            g_ClothNormals[i0] = g_ClothNormals[i0] + normal;
+            g_ClothNormals[i1] = g_ClothNormals[i1] + normal;
+            g_ClothNormals[i2] = g_ClothNormals[i2] + normal;
+            g_ClothNormals[i3] = g_ClothNormals[i3] + normal;
+        }
+    }
+
+    glPushMatrix();
+    glColor4fv(g_ColorCloth);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT,  g_ColorCloth);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE,  g_ColorCloth);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, g_ColorCloth);
+    glEnable(GL_NORMALIZE);
+    glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE);
+
+    glBegin(GL_TRIANGLES);
+    for( unsigned int z=0; z + 1<CLOTH_COUNT; ++z )
+    {
+        for( unsigned int x=0; x + 1<CLOTH_COUNT; ++x )
+        {
+            const unsigned int i0 = x + z * CLOTH_COUNT;
+            const unsigned int indices[6] = { i0, i0 + CLOTH_COUNT, i0 + 1, i0 + 1, i0 + CLOTH_COUNT, i0 + CLOTH_COUNT + 1 };
+
+            for( int j=0; j<6; ++j )
+            {
+                glNormal3fv( g_ClothNormals[ indices[j] ] );
+                glVertex3fv( pPositions[ indices[j] ] );
+            }
+        }
+    }
+    glEnd();
+
+    glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_FALSE);
+    glDisable(GL_NORMALIZE);
+    glPopMatrix();
+}
+
+//-------------------------------------------------------------------------------------------
+//      質点を描画します.
+//-------------------------------------------------------------------------------------------
+void DrawParticles( const std::vector<Vec3>& positions )
+{
+    if ( positions.empty() )
+    { return; }
+
+    // 数が多いのでライティングせずに点で描く.
+    glPushMatrix();
+    glDisable(GL_LIGHTING);
+    glPointSize(4.0f);
+    glColor4fv(g_ColorParticle);
+
+    glBegin(GL_POINTS);
+    for( size_t i=0; i<positions.size(); ++i )
+    { glVertex3fv( positions[i] ); }
+    glEnd();
+
+    glPointSize(1.0f);
+    glEnable(GL_LIGHTING);
+    glPopMatrix();
+}
+
 
 } // namespace /* anonymous */
 
@@ -130,13 +597,22 @@ bool OnInit()
     SetLighting();
 
     // シミュレーションの設定.
-    g_Spring.SetMass        ( 1.0 );
-    g_Spring.SetGravity     ( 9.8 );
-    g_Spring.SetTimeStep    ( 0.01 );
-    g_Spring.SetConstantK   ( 100.0 );
-    g_Spring.SetLength      ( 0.0 );
-    g_Spring.SetInitVelocity( 10.0 );
-    g_Spring.SetInitPosition( 10.0 );
+    ResetSpring();
+
+    // 布の設定.
+    g_ThreadPool.Init();
+    ResetCloth();
+    ResetParticles();
+
+    // シミュレーションスレッドを起動.
+    g_Clock.SetTimeStep  ( SPRING_TIME_STEP );
+    g_Clock.SetMaxSubstep( MAX_SUBSTEP );
+    g_Diagnostics.SetCallback( OnSample, &g_DivergeReported );
+    g_Exit.store( false );
+    g_SimulationThread = std::thread( SimulationMain );
+
+    // カメラの設定.
+    g_Camera.Reset( 50.0f );
 
     // 正常終了.
     return true;
@@ -147,6 +623,14 @@ bool OnInit()
 //-------------------------------------------------------------------------------------------
 void OnTerm()
 {
+    // シミュレーションスレッドを止めてから破棄する.
+    g_Exit.store( true );
+    if ( g_SimulationThread.joinable() )
+    { g_SimulationThread.join(); }
+
+    g_ThreadPool.Term();
+    g_Cloth.Clear();
+    g_Particles.Clear();
 }
 
 
@@ -196,41 +680,36 @@ void OnDisplay()
     glPushMatrix();
 
     //　視点の描画
-    gluLookAt(
-        0.0, 0.0, -50.0,
-        0.0, 0.0, 0.0,
-        0.0, 1.0, 0.0);
+    g_Camera.Update();
 
-    // ベルレ法で更新.
-    g_Spring.Update( SIMULATION_TYPE_VERLET );
+    // 最新の状態を受け取り，前のステップとの間を補間して描画する.
+    g_RenderStates.Acquire();
+    const RenderState& state = g_RenderStates.GetReadBuffer();
+    const double       alpha = CalcAlpha( state );
 
-    //　固定点の描画
-    glPushMatrix();
-    glColor4fv(g_ColorLine);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT,  g_ColorLine);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE,  g_ColorLine);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, g_ColorLine);
-    glTranslated(0.0, 10.0, 0.0);
-    glutSolidSphere(1.0, 5, 5);
-    glPopMatrix();
+    UpdateTitle( state.summary, state.stepTime );
 
-    //　線の描画
-    glLineWidth(5.0);
-    glBegin(GL_LINES);
-    glColor4fv(g_ColorLine);
-    glVertex3d(0.0, 10.0, 0.0);
-    glVertex3d(0.0, g_Spring.GetPosition(), 0.0);
-    glEnd();
+    if ( state.mode == DEMO_MODE_CLOTH || state.mode == DEMO_MODE_PARTICLES )
+    {
+        const std::vector<Vec3>& prev = state.networkPosition[0];
+        const std::vector<Vec3>& curr = state.networkPosition[1];
 
-    //　物体の描画
-    glPushMatrix();
-    glColor4fv(g_ColorObj);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT,  g_ColorObj);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE,  g_ColorObj);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, g_ColorObj);
-    glTranslated(0.0, g_Spring.GetPosition(), 0.0);
-    glutSolidSphere(2.0, 5, 5);
-    glPopMatrix();
+        g_NetworkPositions.resize( curr.size() );
+        for( size_t i=0; i<curr.size() && i<prev.size(); ++i )
+        { g_NetworkPositions[i] = prev[i] + ( curr[i] - prev[i] ) * float( alpha ); }
+
+        if ( state.mode == DEMO_MODE_CLOTH )
+        { DrawCloth( g_NetworkPositions ); }
+        else
+        { DrawParticles( g_NetworkPositions ); }
+    }
+    else
+    {
+        const double prev = state.springPosition[0];
+        const double curr = state.springPosition[1];
+
+        DrawSpring( prev + ( curr - prev ) * alpha );
+    }
 
     glPopMatrix();
 
@@ -293,6 +772,7 @@ void OnMouse( int button, int state, int x, int y )
 //-------------------------------------------------------------------------------------------
 void OnMotion( int x, int y )
 {
+    g_Camera.MouseMotion( x, y );
 }
 
 
@@ -328,34 +808,66 @@ void OnSpecial( int key, int x, int y )
 {
     switch ( key )
     {
+    // F1キーで1次元のばねに切り替え.
     case GLUT_KEY_F1:
+        { g_RequestMode.store( DEMO_MODE_SPRING ); }
         break;
 
+    // F2キーで布に切り替え. 布は初期状態に戻す.
     case GLUT_KEY_F2:
+        {
+            g_RequestMode .store( DEMO_MODE_CLOTH );
+            g_RequestReset.store( true );
+        }
         break;
 
+    // F3キーで陽的オイラー法に切り替え.
     case GLUT_KEY_F3:
+        { ChangeSimulationType( SIMULATION_TYPE_EXPLICIT_EULAR ); }
         break;
 
+    // F4キーで半陰的オイラー法に切り替え.
     case GLUT_KEY_F4:
+        { ChangeSimulationType( SIMULATION_TYPE_SEMI_IMPLICIT_EULAR ); }
         break;
 
+    // F5キーでベルレ法に切り替え.
     case GLUT_KEY_F5:
+        { ChangeSimulationType( SIMULATION_TYPE_VERLET ); }
         break;
 
+    // F6キーで4次のルンゲ・クッタ法に切り替え.
     case GLUT_KEY_F6:
+        { ChangeSimulationType( SIMULATION_TYPE_RUNGE_KUTTA4 ); }
         break;
 
+    // F7キーで陰的オイラー法に切り替え.
     case GLUT_KEY_F7:
+        { ChangeSimulationType( SIMULATION_TYPE_IMPLICIT_EULAR ); }
         break;
 
+    // F8キーで衝突する質点に切り替え. 質点は初期状態に戻す.
     case GLUT_KEY_F8:
+        {
+            g_RequestMode .store( DEMO_MODE_PARTICLES );
+            g_RequestReset.store( true );
+        }
         break;
 
+    // F9キーでガウス・ザイデル法の XPBD に切り替え.
     case GLUT_KEY_F9:
+        {
+            g_RequestSolver.store( XPBD_SOLVER_GAUSS_SEIDEL );
+            ChangeSimulationType( SIMULATION_TYPE_XPBD );
+        }
         break;
 
+    // F10キーでヤコビ法の XPBD に切り替え.
     case GLUT_KEY_F10:
+        {
+            g_RequestSolver.store( XPBD_SOLVER_JACOBI );
+            ChangeSimulationType( SIMULATION_TYPE_XPBD );
+        }
         break;
 
     case GLUT_KEY_F11:
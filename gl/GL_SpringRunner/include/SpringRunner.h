@@ -0,0 +1,371 @@
+﻿//------------------------------------------------------------------------------------------
+// File : SpringRunner.h
+// Desc : Headless Spring Simulation Runner.
+// Copyright(c) Project Asura. All right reserved.
+//------------------------------------------------------------------------------------------
+
+#ifndef __SPRING_RUNNER_H__
+#define __SPRING_RUNNER_H__
+
+//------------------------------------------------------------------------------------------
+// Includes
+//------------------------------------------------------------------------------------------
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <Spring.h>
+#include <SpringSystem.h>
+#include <SpringNetwork.h>
+#include <ThreadPool.h>
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// RUNNER_MODEL enum
+////////////////////////////////////////////////////////////////////////////////////////////
+enum RUNNER_MODEL
+{
+    RUNNER_MODEL_SPRING = 0,        //!< Spring1D を1つだけ更新します.
+    RUNNER_MODEL_SYSTEM,            //!< SpringSystem でまとめて更新します.
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// RUNNER_OUTPUT enum
+////////////////////////////////////////////////////////////////////////////////////////////
+enum RUNNER_OUTPUT
+{
+    RUNNER_OUTPUT_NONE = 0,         //!< 軌跡を出力しません.
+    RUNNER_OUTPUT_CSV,              //!< CSV形式で出力します.
+    RUNNER_OUTPUT_BINARY,           //!< バイナリ形式で出力します. 再生による検証に使えます.
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// RunnerRange structure
+////////////////////////////////////////////////////////////////////////////////////////////
+struct RunnerRange
+{
+    double  min;        //!< 最小値です.
+    double  max;        //!< 最大値です. min と同じ場合は乱数を使いません.
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      固定値で初期化するコンストラクタです.
+    //--------------------------------------------------------------------------------------
+    RunnerRange( const double value = 0.0 )
+    : min( value )
+    , max( value )
+    { /* DO_NOTHING */ }
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      範囲で初期化するコンストラクタです.
+    //--------------------------------------------------------------------------------------
+    RunnerRange( const double minValue, const double maxValue )
+    : min( minValue )
+    , max( maxValue )
+    { /* DO_NOTHING */ }
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// RunnerConfig structure
+////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief      シミュレーションの設定です.
+//!
+//! @note       各ばねのパラメータは seed から決まる乱数で範囲内から選びます. 乱数は実装に依存しない
+//!             SplitMix64 を使うので，同じ設定ならどの環境でも同じ初期状態になります.
+//!             threadCount は結果に影響しません.
+//!             tolerance を設定すると記録する時刻は同じまま，その間を可変の刻み幅で進めます.
+////////////////////////////////////////////////////////////////////////////////////////////
+struct RunnerConfig
+{
+    RUNNER_MODEL        model;          //!< 更新するモデルです.
+    SIMULATION_TYPE     type;           //!< 積分方法です.
+    unsigned long long  count;          //!< ばねの数です. RUNNER_MODEL_SPRING の場合は1です.
+    unsigned long long  steps;          //!< 進めるステップ数です.
+    unsigned long long  stride;         //!< 軌跡を記録する間隔(ステップ数)です.
+    double              timeStep;       //!< 微小時間です.
+    double              gravity;        //!< 重力加速度です.
+    unsigned long long  seed;           //!< 乱数のシードです.
+    RunnerRange         mass;           //!< 質量の範囲です.
+    RunnerRange         constantK;      //!< ばね定数の範囲です.
+    RunnerRange         length;         //!< 自然長の範囲です.
+    RunnerRange         position;       //!< 初期位置の範囲です.
+    RunnerRange         velocity;       //!< 初期速度の範囲です.
+    unsigned int        threadCount;    //!< RUNNER_MODEL_SYSTEM で使うスレッド数です. 0の場合はコア数です.
+    double              tolerance;      //!< 0より大きい場合は Spring1D::Advance() で刻み幅を調整します.
+    double              minTimeStep;    //!< 刻み幅を調整する場合の最小値です.
+    double              maxTimeStep;    //!< 刻み幅を調整する場合の最大値です.
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです. main.cpp のデモと同じばねになります.
+    //--------------------------------------------------------------------------------------
+    RunnerConfig()
+    : model         ( RUNNER_MODEL_SPRING )
+    , type          ( SIMULATION_TYPE_VERLET )
+    , count         ( 1 )
+    , steps         ( 1000 )
+    , stride        ( 1 )
+    , timeStep      ( 0.01 )
+    , gravity       ( 9.8 )
+    , seed          ( 0 )
+    , mass          ( 1.0 )
+    , constantK     ( 100.0 )
+    , length        ( 0.0 )
+    , position      ( 10.0 )
+    , velocity      ( 10.0 )
+    , threadCount   ( 0 )
+    , tolerance     ( 0.0 )
+    , minTimeStep   ( 1e-6 )
+    , maxTimeStep   ( 0.1 )
+    { /* DO_NOTHING */ }
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// RunnerResult structure
+////////////////////////////////////////////////////////////////////////////////////////////
+struct RunnerResult
+{
+    std::string         message;        //!< 失敗した場合のエラーメッセージです.
+    bool                succeeded;      //!< 最後まで実行できた場合は true.
+    bool                matched;        //!< 再生した結果が記録と一致した場合は true.
+    unsigned long long  steps;          //!< 進めたステップ数です. 刻み幅を調整する場合は timeStep 単位の数です.
+    unsigned long long  acceptedSteps;  //!< 刻み幅を調整した場合に受理したステップ数です.
+    unsigned long long  rejectedSteps;  //!< 刻み幅を調整した場合に棄却したステップ数です.
+    unsigned long long  records;        //!< 記録したレコード数です.
+    unsigned long long  mismatchStep;   //!< 最初に一致しなかったステップです.
+    double              initialEnergy;  //!< 初期状態の全エネルギーです.
+    double              finalEnergy;    //!< 最終状態の全エネルギーです.
+    double              maxDrift;       //!< 記録したレコードでのエネルギーの相対誤差の最大値です.
+    unsigned long long  digest;         //!< 最終状態のハッシュ値です. 結果の一致確認に使います.
+    double              seconds;        //!< 実行にかかった時間(秒)です.
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //--------------------------------------------------------------------------------------
+    RunnerResult()
+    : message       ()
+    , succeeded     ( false )
+    , matched       ( false )
+    , steps         ( 0 )
+    , acceptedSteps ( 0 )
+    , rejectedSteps ( 0 )
+    , records       ( 0 )
+    , mismatchStep  ( 0 )
+    , initialEnergy ( 0.0 )
+    , finalEnergy   ( 0.0 )
+    , maxDrift      ( 0.0 )
+    , digest        ( 0 )
+    , seconds       ( 0.0 )
+    { /* DO_NOTHING */ }
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// RunnerBenchmark structure
+////////////////////////////////////////////////////////////////////////////////////////////
+struct RunnerBenchmark
+{
+    unsigned int        threadCount;    //!< 使用したスレッド数です.
+    double              seconds;        //!< ステップを進めるのにかかった時間(秒)です. 初期化は含みません.
+    double              stepsPerSecond; //!< 1秒あたりのステップ数です.
+    double              speedup;        //!< 1スレッドの場合に対する速度比です.
+    unsigned long long  digest;         //!< 最終状態のハッシュ値です. スレッド数によらず一致します.
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //--------------------------------------------------------------------------------------
+    RunnerBenchmark()
+    : threadCount   ( 0 )
+    , seconds       ( 0.0 )
+    , stepsPerSecond( 0.0 )
+    , speedup       ( 0.0 )
+    , digest        ( 0 )
+    { /* DO_NOTHING */ }
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// RunnerStability structure
+////////////////////////////////////////////////////////////////////////////////////////////
+struct RunnerStability
+{
+    SIMULATION_TYPE     type;           //!< 積分方法です.
+    double              timeStep;       //!< 安定だった最大の微小時間です. belowMin の場合は試した最小の微小時間です.
+    bool                belowMin;       //!< 最小の微小時間でも不安定だった場合は true.
+    bool                atMax;          //!< 最大の微小時間でも安定だった場合は true.
+    unsigned int        trials;         //!< 試行した微小時間の数です.
+    unsigned long long  steps;          //!< timeStep で同じ時間を進めるのに必要なステップ数です.
+    double              growth;         //!< timeStep で進めた場合のエネルギーの増加率の最大値です.
+    double              seconds;        //!< timeStep で同じ時間を進めるのにかかった時間(秒)です.
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //--------------------------------------------------------------------------------------
+    RunnerStability()
+    : type          ( SIMULATION_TYPE_EXPLICIT_EULAR )
+    , timeStep      ( 0.0 )
+    , belowMin      ( false )
+    , atMax         ( false )
+    , trials        ( 0 )
+    , steps         ( 0 )
+    , growth        ( 0.0 )
+    , seconds       ( 0.0 )
+    { /* DO_NOTHING */ }
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// RunnerChain structure
+////////////////////////////////////////////////////////////////////////////////////////////
+struct RunnerChain
+{
+    XPBD_SOLVER         solver;         //!< 距離拘束の解き方です.
+    double              stretch;        //!< 静止した後の一番上のばねの伸びです.
+    double              expected;       //!< 吊り下げた質点の重さから求めた伸びです.
+    double              error;          //!< 伸びの相対誤差です.
+    bool                passed;         //!< 相対誤差が許容範囲内の場合は true.
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //--------------------------------------------------------------------------------------
+    RunnerChain()
+    : solver        ( XPBD_SOLVER_GAUSS_SEIDEL )
+    , stretch       ( 0.0 )
+    , expected      ( 0.0 )
+    , error         ( 0.0 )
+    , passed        ( false )
+    { /* DO_NOTHING */ }
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// SpringRunner class
+////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief      ウィンドウを使わずにばねを更新し，軌跡をファイルに書き出すクラスです.
+//!
+//! @note       バイナリ形式はヘッダに設定を全て含むので，Replay() でファイルだけから同じ
+//!             シミュレーションをやり直し，全レコードをビット単位で比較できます.
+//!             エネルギーは 0.5 * m * v^2 + 0.5 * k * ( x - L )^2 - m * g * x です.
+////////////////////////////////////////////////////////////////////////////////////////////
+class SpringRunner
+{
+    //======================================================================================
+    // list of friend classes and methods.
+    //======================================================================================
+    /* NOTHING */
+
+public:
+    //======================================================================================
+    // public variables.
+    //======================================================================================
+    /* NOTHING */
+
+    //======================================================================================
+    // public methods.
+    //======================================================================================
+    SpringRunner();
+    virtual ~SpringRunner();
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      シミュレーションを実行し，軌跡を出力します.
+    //!
+    //! @param [in]     config      設定です.
+    //! @param [in]     output      出力形式です.
+    //! @param [in]     path        出力ファイル名です. RUNNER_OUTPUT_NONE の場合は無視されます.
+    //! @param [out]    result      実行結果です.
+    //! @retval true    実行に成功しました.
+    //! @retval false   実行に失敗しました.
+    //--------------------------------------------------------------------------------------
+    bool Run( const RunnerConfig& config, RUNNER_OUTPUT output, const char* path, RunnerResult& result );
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      バイナリ形式の軌跡を読み込み，同じ設定で実行し直して比較します.
+    //!
+    //! @param [in]     path        Run() で出力したバイナリファイル名です.
+    //! @param [in]     threadCount 実行に使うスレッド数です. 記録時と違っていても結果は一致します.
+    //! @param [out]    result      実行結果です. result.matched に比較結果が格納されます.
+    //! @retval true    ファイルを最後まで比較できました.
+    //! @retval false   ファイルが読み込めませんでした.
+    //--------------------------------------------------------------------------------------
+    bool Replay( const char* path, unsigned int threadCount, RunnerResult& result );
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      スレッド数を 1 から maxThreadCount まで変えて SpringSystem の更新速度を計測します.
+    //!
+    //! @note       config.model と config.threadCount は無視し，RUNNER_MODEL_SYSTEM で実行します.
+    //!             スレッド数ごとに同じ初期状態から config.steps ステップ進め，初期化を除いた時間を計ります.
+    //! @param [in]     config          設定です.
+    //! @param [in]     maxThreadCount  計測する最大のスレッド数です. 0の場合はコア数です.
+    //! @param [out]    results         スレッド数ごとの計測結果です.
+    //! @param [out]    result          失敗した場合は result.message にエラーメッセージが格納されます.
+    //! @retval true    計測に成功し，全てのスレッド数で最終状態が一致しました.
+    //! @retval false   実行に失敗したか，スレッド数によって最終状態が異なりました.
+    //--------------------------------------------------------------------------------------
+    bool Benchmark( const RunnerConfig& config, unsigned int maxThreadCount, std::vector<RunnerBenchmark>& results, RunnerResult& result );
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      同じ時間を安定して進められる最大の微小時間を探します.
+    //!
+    //! @note       config.steps * config.timeStep の時間を微小時間を変えて進め，エネルギーが有限で
+    //!             初期値から maxGrowth * |初期値| より増えなければ安定とみなします.
+    //!             陰的オイラー法のように減衰する方法は精度に関係なく安定になります.
+    //!             微小時間は config.maxTimeStep から config.minTimeStep まで半分ずつ下げて試し，
+    //!             最初に安定した値との間を対数で二分探索します. 見つかった微小時間で同じ時間を
+    //!             進めるのにかかる時間も計ります.
+    //! @param [in]     config      設定です. config.type の積分方法を調べます.
+    //! @param [in]     maxGrowth   許容するエネルギーの増加率です.
+    //! @param [out]    stability   探索結果です.
+    //! @param [out]    result      失敗した場合は result.message にエラーメッセージが格納されます.
+    //! @retval true    探索に成功しました.
+    //! @retval false   設定が不正です.
+    //--------------------------------------------------------------------------------------
+    bool FindStableTimeStep( const RunnerConfig& config, double maxGrowth, RunnerStability& stability, RunnerResult& result );
+
+    //--------------------------------------------------------------------------------------
+    //! @brief      SpringNetwork の拡張位置ベース法が正しい平衡位置に落ち着くかチェックします.
+    //!
+    //! @note       上端を固定した6質点の鎖(ばね定数 200，質量 1)を拘束の反復回数 100 で
+    //!             静止するまで進め，一番上のばねの伸びを 5 * m * g / k と比べます.
+    //!             ガウス・ザイデル法とヤコビ法の両方を調べます.
+    //! @param [out]    results     解き方ごとの結果です.
+    //! @param [out]    result      失敗した場合は result.message にエラーメッセージが格納されます.
+    //! @retval true    全ての解き方で伸びが許容範囲内でした.
+    //! @retval false   伸びが許容範囲を超えた解き方がありました.
+    //--------------------------------------------------------------------------------------
+    bool CheckChainEquilibrium( std::vector<RunnerChain>& results, RunnerResult& result );
+
+protected:
+    //======================================================================================
+    // protected variables.
+    //======================================================================================
+    RunnerConfig            m_Config;       //!< 実行中の設定です.
+    Spring1D                m_Spring;       //!< RUNNER_MODEL_SPRING で更新するばねです.
+    SpringSystem            m_System;       //!< RUNNER_MODEL_SYSTEM で更新するばねです.
+    ThreadPool              m_ThreadPool;   //!< RUNNER_MODEL_SYSTEM で使うスレッドプールです.
+    std::vector<double>     m_Record;       //!< 1レコード分の位置と速度です.
+
+    //======================================================================================
+    // protected methods.
+    //======================================================================================
+    bool   Setup        ( const RunnerConfig& config, unsigned int threadCount, RunnerResult& result );
+    bool   TryTimeStep  ( const RunnerConfig& config, double timeStep, double maxGrowth, double& growth );
+    void   Step         ( unsigned long long count );
+    void   Capture      ();
+    double CalcEnergy   () const;
+
+private:
+    //======================================================================================
+    // private variables.
+    //======================================================================================
+    /* NOTHING */
+
+    //======================================================================================
+    // private methods.
+    //======================================================================================
+    SpringRunner    ( const SpringRunner& value );  // アクセス禁止.
+    void operator = ( const SpringRunner& value );  // アクセス禁止.
+};
+
+
+#endif//__SPRING_RUNNER_H__
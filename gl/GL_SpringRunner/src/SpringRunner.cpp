@@ -0,0 +1,814 @@
+﻿//----------------------------------------------------------------------------------------
+// File : SpringRunner.cpp
+// Desc : Headless Spring Simulation Runner.
+// Copyright(c) Project Asura. All right reserved.
+//----------------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------------
+#include <SpringRunner.h>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+
+namespace /* anonymous */ {
+
+//----------------------------------------------------------------------------------------
+// Constant Values
+//----------------------------------------------------------------------------------------
+static const char           TRAJECTORY_MAGIC[4] = { 'S', 'P', 'R', 'T' };  // バイナリ形式の識別子.
+static const unsigned int   TRAJECTORY_VERSION  = 2;                        // バイナリ形式のバージョン.
+static const unsigned int   MAX_SUBSTEP_COUNT   = 0x10000;                  // SpringSystem に1回で渡すステップ数の上限.
+static const unsigned int   STABILITY_SEARCH    = 8;                        // 安定な微小時間を二分探索する回数.
+static const unsigned int   STABILITY_RECORDS   = 1000;                     // 安定性の判定でエネルギーを調べる回数.
+static const unsigned int   CHAIN_PARTICLES     = 6;                        // 平衡位置の確認に使う鎖の質点数.
+static const float          CHAIN_CONSTANT_K    = 200.0f;                   // 鎖のばね定数.
+static const float          CHAIN_MASS          = 1.0f;                     // 鎖の質点1つあたりの質量.
+static const float          CHAIN_TIME_STEP     = 0.01f;                    // 鎖を進める微小時間.
+static const float          CHAIN_DAMPING       = 2.0f;                     // 鎖を静止させるための減衰係数.
+static const unsigned int   CHAIN_ITERATION     = 100;                      // 鎖の距離拘束の反復回数.
+static const unsigned int   CHAIN_STEPS         = 3000;                     // 鎖が静止するまでのステップ数.
+static const double         CHAIN_TOLERANCE     = 0.01;                     // 鎖の伸びの許容相対誤差.
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// SplitMix64 class
+//////////////////////////////////////////////////////////////////////////////////////////
+class SplitMix64
+{
+public:
+    //------------------------------------------------------------------------------------
+    //      コンストラクタです.
+    //------------------------------------------------------------------------------------
+    explicit SplitMix64( unsigned long long seed )
+    : m_State( seed )
+    { /* DO_NOTHING */ }
+
+    //------------------------------------------------------------------------------------
+    //      64bitの乱数を生成します.
+    //------------------------------------------------------------------------------------
+    unsigned long long Next()
+    {
+        m_State += 0x9E3779B97F4A7C15ULL;
+        unsigned long long z = m_State;
+        z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+        z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+        return z ^ ( z >> 31 );
+    }
+
+    //------------------------------------------------------------------------------------
+    //      範囲内の乱数を生成します. 範囲の幅が0でも乱数は1つ消費します.
+    //------------------------------------------------------------------------------------
+    double Next( const RunnerRange& range )
+    {
+        const double t = double( Next() >> 11 ) * ( 1.0 / 9007199254740992.0 );
+        return ( range.min == range.max ) ? range.min : range.min + ( range.max - range.min ) * t;
+    }
+
+private:
+    unsigned long long  m_State;    // 内部状態です.
+};
+
+//----------------------------------------------------------------------------------------
+//      経過時間を秒単位で取得します.
+//----------------------------------------------------------------------------------------
+double GetElapsedSeconds( const std::chrono::high_resolution_clock::time_point& start )
+{
+    const std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>( now - start ).count() * 1e-6;
+}
+
+//----------------------------------------------------------------------------------------
+//      FNV-1a でハッシュ値を求めます.
+//----------------------------------------------------------------------------------------
+unsigned long long CalcDigest( const void* pData, size_t size )
+{
+    const unsigned char* pBytes = static_cast<const unsigned char*>( pData );
+    unsigned long long hash = 0xcbf29ce484222325ULL;
+    for( size_t i=0; i<size; ++i )
+    {
+        hash ^= pBytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+//----------------------------------------------------------------------------------------
+//      エネルギーの相対誤差を求めます.
+//----------------------------------------------------------------------------------------
+double CalcDrift( const double energy, const double initialEnergy )
+{
+    const double diff = energy - initialEnergy;
+    return ( initialEnergy != 0.0 ) ? std::fabs( diff / initialEnergy ) : std::fabs( diff );
+}
+
+//----------------------------------------------------------------------------------------
+//      指定した時間を微小時間で進めるのに必要なステップ数を求めます.
+//----------------------------------------------------------------------------------------
+unsigned long long CalcSpanSteps( const double span, const double timeStep )
+{
+    const double steps = std::ceil( span / timeStep - 1e-9 );
+    return ( steps < 1.0 ) ? 1 : static_cast<unsigned long long>( steps );
+}
+
+//----------------------------------------------------------------------------------------
+//      値を書き込みます.
+//----------------------------------------------------------------------------------------
+template<typename T>
+bool WriteValue( FILE* pFile, const T& value )
+{ return fwrite( &value, sizeof(T), 1, pFile ) == 1; }
+
+//----------------------------------------------------------------------------------------
+//      値を読み込みます.
+//----------------------------------------------------------------------------------------
+template<typename T>
+bool ReadValue( FILE* pFile, T& value )
+{ return fread( &value, sizeof(T), 1, pFile ) == 1; }
+
+//----------------------------------------------------------------------------------------
+//      範囲を書き込みます.
+//----------------------------------------------------------------------------------------
+bool WriteRange( FILE* pFile, const RunnerRange& range )
+{ return WriteValue( pFile, range.min ) && WriteValue( pFile, range.max ); }
+
+//----------------------------------------------------------------------------------------
+//      範囲を読み込みます.
+//----------------------------------------------------------------------------------------
+bool ReadRange( FILE* pFile, RunnerRange& range )
+{ return ReadValue( pFile, range.min ) && ReadValue( pFile, range.max ); }
+
+//----------------------------------------------------------------------------------------
+//      バイナリ形式のヘッダを書き込みます. 再生に必要な設定を全て含めます.
+//----------------------------------------------------------------------------------------
+bool WriteHeader( FILE* pFile, const RunnerConfig& config )
+{
+    const unsigned int model = static_cast<unsigned int>( config.model );
+    const unsigned int type  = static_cast<unsigned int>( config.type );
+
+    return fwrite( TRAJECTORY_MAGIC, sizeof(TRAJECTORY_MAGIC), 1, pFile ) == 1
+        && WriteValue( pFile, TRAJECTORY_VERSION )
+        && WriteValue( pFile, model )
+        && WriteValue( pFile, type )
+        && WriteValue( pFile, config.count )
+        && WriteValue( pFile, config.steps )
+        && WriteValue( pFile, config.stride )
+        && WriteValue( pFile, config.seed )
+        && WriteValue( pFile, config.timeStep )
+        && WriteValue( pFile, config.gravity )
+        && WriteRange( pFile, config.mass )
+        && WriteRange( pFile, config.constantK )
+        && WriteRange( pFile, config.length )
+        && WriteRange( pFile, config.position )
+        && WriteRange( pFile, config.velocity )
+        && WriteValue( pFile, config.tolerance )
+        && WriteValue( pFile, config.minTimeStep )
+        && WriteValue( pFile, config.maxTimeStep );
+}
+
+//----------------------------------------------------------------------------------------
+//      バイナリ形式のヘッダを読み込みます.
+//----------------------------------------------------------------------------------------
+bool ReadHeader( FILE* pFile, RunnerConfig& config, std::string& message )
+{
+    char         magic[4];
+    unsigned int version = 0;
+    unsigned int model   = 0;
+    unsigned int type    = 0;
+
+    if ( fread( magic, sizeof(magic), 1, pFile ) != 1 || memcmp( magic, TRAJECTORY_MAGIC, sizeof(magic) ) != 0 )
+    {
+        message = "not a trajectory file";
+        return false;
+    }
+
+    // バージョン1は固定の刻み幅のみ.
+    if ( !ReadValue( pFile, version ) || version < 1 || version > TRAJECTORY_VERSION )
+    {
+        message = "unsupported trajectory version";
+        return false;
+    }
+
+    const bool ok = ReadValue( pFile, model )
+                 && ReadValue( pFile, type )
+                 && ReadValue( pFile, config.count )
+                 && ReadValue( pFile, config.steps )
+                 && ReadValue( pFile, config.stride )
+                 && ReadValue( pFile, config.seed )
+                 && ReadValue( pFile, config.timeStep )
+                 && ReadValue( pFile, config.gravity )
+                 && ReadRange( pFile, config.mass )
+                 && ReadRange( pFile, config.constantK )
+                 && ReadRange( pFile, config.length )
+                 && ReadRange( pFile, config.position )
+                 && ReadRange( pFile, config.velocity )
+                 && ( version < 2
+                   || ( ReadValue( pFile, config.tolerance )
+                     && ReadValue( pFile, config.minTimeStep )
+                     && ReadValue( pFile, config.maxTimeStep ) ) );
+    if ( !ok )
+    {
+        message = "truncated trajectory header";
+        return false;
+    }
+
+    config.model = static_cast<RUNNER_MODEL>( model );
+    config.type  = static_cast<SIMULATION_TYPE>( type );
+    return true;
+}
+
+} // namespace /* anonymous */
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// SpringRunner class
+//////////////////////////////////////////////////////////////////////////////////////////
+
+//----------------------------------------------------------------------------------------
+//      コンストラクタです.
+//----------------------------------------------------------------------------------------
+SpringRunner::SpringRunner()
+{ /* DO_NOTHING */ }
+
+//----------------------------------------------------------------------------------------
+//      デストラクタです.
+//----------------------------------------------------------------------------------------
+SpringRunner::~SpringRunner()
+{ m_ThreadPool.Term(); }
+
+//----------------------------------------------------------------------------------------
+//      シミュレーションを実行し，軌跡を出力します.
+//----------------------------------------------------------------------------------------
+bool SpringRunner::Run( const RunnerConfig& config, RUNNER_OUTPUT output, const char* path, RunnerResult& result )
+{
+    const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    result = RunnerResult();
+
+    if ( !Setup( config, config.threadCount, result ) )
+    { return false; }
+
+    FILE* pFile = nullptr;
+    if ( output != RUNNER_OUTPUT_NONE )
+    {
+        if ( path == nullptr || fopen_s( &pFile, path, ( output == RUNNER_OUTPUT_CSV ) ? "w" : "wb" ) != 0 || pFile == nullptr )
+        {
+            result.message = "cannot open output file";
+            return false;
+        }
+    }
+
+    bool ok = true;
+    if ( output == RUNNER_OUTPUT_CSV )
+    {
+        fprintf( pFile, "step,time,energy,drift" );
+        for( unsigned long long i=0; i<m_Config.count; ++i )
+        { fprintf( pFile, ",x%llu,v%llu", i, i ); }
+        fprintf( pFile, "\n" );
+    }
+    else if ( output == RUNNER_OUTPUT_BINARY )
+    { ok = WriteHeader( pFile, m_Config ); }
+
+    // 初期状態と stride ステップごとの状態, 最後の状態を記録する.
+    unsigned long long step = 0;
+    for( ;; )
+    {
+        Capture();
+        const double energy = CalcEnergy();
+        if ( step == 0 )
+        { result.initialEnergy = energy; }
+
+        const double drift = CalcDrift( energy, result.initialEnergy );
+        if ( drift > result.maxDrift || drift != drift )
+        { result.maxDrift = drift; }
+        result.finalEnergy = energy;
+        result.records++;
+
+        if ( output == RUNNER_OUTPUT_CSV )
+        {
+            fprintf( pFile, "%llu,%.17g,%.17g,%.17g", step, double( step ) * m_Config.timeStep, energy, drift );
+            for( unsigned long long i=0; i<m_Config.count; ++i )
+            { fprintf( pFile, ",%.17g,%.17g", m_Record[i], m_Record[m_Config.count + i] ); }
+            fprintf( pFile, "\n" );
+        }
+        else if ( output == RUNNER_OUTPUT_BINARY )
+        {
+            ok = ok
+              && WriteValue( pFile, step )
+              && WriteValue( pFile, energy )
+              && fwrite( &m_Record[0], sizeof(double), m_Record.size(), pFile ) == m_Record.size();
+        }
+
+        if ( step >= m_Config.steps || !ok )
+        { break; }
+
+        const unsigned long long count = ( m_Config.steps - step < m_Config.stride ) ? m_Config.steps - step : m_Config.stride;
+        Step( count );
+        step += count;
+    }
+
+    if ( pFile != nullptr )
+    {
+        if ( ferror( pFile ) )
+        { ok = false; }
+        fclose( pFile );
+    }
+
+    if ( !ok )
+    {
+        result.message = "failed to write output file";
+        return false;
+    }
+
+    result.steps         = step;
+    result.acceptedSteps = ( m_Config.tolerance > 0.0 ) ? m_Spring.GetAcceptCount() : 0;
+    result.rejectedSteps = ( m_Config.tolerance > 0.0 ) ? m_Spring.GetRejectCount() : 0;
+    result.digest    = CalcDigest( &m_Record[0], m_Record.size() * sizeof(double) );
+    result.seconds   = GetElapsedSeconds( start );
+    result.succeeded = true;
+    return true;
+}
+
+//----------------------------------------------------------------------------------------
+//      バイナリ形式の軌跡を読み込み，同じ設定で実行し直して比較します.
+//----------------------------------------------------------------------------------------
+bool SpringRunner::Replay( const char* path, unsigned int threadCount, RunnerResult& result )
+{
+    const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    result = RunnerResult();
+
+    FILE* pFile = nullptr;
+    if ( path == nullptr || fopen_s( &pFile, path, "rb" ) != 0 || pFile == nullptr )
+    {
+        result.message = "cannot open trajectory file";
+        return false;
+    }
+
+    RunnerConfig config;
+    if ( !ReadHeader( pFile, config, result.message ) || !Setup( config, threadCount, result ) )
+    {
+        fclose( pFile );
+        return false;
+    }
+
+    std::vector<double> expected( m_Record.size() );
+    unsigned long long  step = 0;
+    bool                ok   = true;
+
+    result.matched = true;
+    for( ;; )
+    {
+        unsigned long long expectedStep   = 0;
+        double             expectedEnergy = 0.0;
+        if ( !ReadValue( pFile, expectedStep )
+          || !ReadValue( pFile, expectedEnergy )
+          || fread( &expected[0], sizeof(double), expected.size(), pFile ) != expected.size() )
+        {
+            result.message = "truncated trajectory file";
+            ok = false;
+            break;
+        }
+
+        Capture();
+        const double energy = CalcEnergy();
+        if ( step == 0 )
+        { result.initialEnergy = energy; }
+
+        const double drift = CalcDrift( energy, result.initialEnergy );
+        if ( drift > result.maxDrift || drift != drift )
+        { result.maxDrift = drift; }
+        result.finalEnergy = energy;
+        result.records++;
+
+        // ビット単位で比較する. NaN 同士も同じビット列なら一致とみなす.
+        if ( expectedStep != step
+          || memcmp( &expectedEnergy, &energy, sizeof(double) ) != 0
+          || memcmp( &expected[0], &m_Record[0], expected.size() * sizeof(double) ) != 0 )
+        {
+            result.matched      = false;
+            result.mismatchStep = step;
+            break;
+        }
+
+        if ( step >= m_Config.steps )
+        { break; }
+
+        const unsigned long long count = ( m_Config.steps - step < m_Config.stride ) ? m_Config.steps - step : m_Config.stride;
+        Step( count );
+        step += count;
+    }
+
+    fclose( pFile );
+
+    if ( !ok )
+    { return false; }
+
+    result.steps         = step;
+    result.acceptedSteps = ( m_Config.tolerance > 0.0 ) ? m_Spring.GetAcceptCount() : 0;
+    result.rejectedSteps = ( m_Config.tolerance > 0.0 ) ? m_Spring.GetRejectCount() : 0;
+    result.digest    = CalcDigest( &m_Record[0], m_Record.size() * sizeof(double) );
+    result.seconds   = GetElapsedSeconds( start );
+    result.succeeded = true;
+    return true;
+}
+
+//----------------------------------------------------------------------------------------
+//      スレッド数を変えて SpringSystem の更新速度を計測します.
+//----------------------------------------------------------------------------------------
+bool SpringRunner::Benchmark( const RunnerConfig& config, unsigned int maxThreadCount, std::vector<RunnerBenchmark>& results, RunnerResult& result )
+{
+    result = RunnerResult();
+    results.clear();
+
+    if ( maxThreadCount == 0 )
+    { maxThreadCount = std::thread::hardware_concurrency(); }
+    if ( maxThreadCount < 1 )
+    { maxThreadCount = 1; }
+
+    RunnerConfig benchConfig = config;
+    benchConfig.model       = RUNNER_MODEL_SYSTEM;
+    benchConfig.threadCount = 0;
+
+    result.matched = true;
+    for( unsigned int threadCount=1; threadCount<=maxThreadCount; ++threadCount )
+    {
+        // 初期化は計測しない. 毎回同じ初期状態から進めるので最終状態も一致するはず.
+        if ( !Setup( benchConfig, threadCount, result ) )
+        { return false; }
+
+        const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        Step( m_Config.steps );
+
+        RunnerBenchmark bench;
+        bench.threadCount    = threadCount;
+        bench.seconds        = GetElapsedSeconds( start );
+        bench.stepsPerSecond = ( bench.seconds > 0.0 ) ? double( m_Config.steps ) / bench.seconds : 0.0;
+        bench.speedup        = ( !results.empty() && bench.seconds > 0.0 ) ? results[0].seconds / bench.seconds : 1.0;
+
+        Capture();
+        bench.digest = CalcDigest( &m_Record[0], m_Record.size() * sizeof(double) );
+
+        if ( !results.empty() && bench.digest != results[0].digest && result.matched )
+        {
+            result.matched = false;
+            result.message = "final state depends on the thread count";
+        }
+
+        results.push_back( bench );
+    }
+
+    result.steps     = m_Config.steps;
+    result.digest    = results[0].digest;
+    result.succeeded = result.matched;
+    return result.succeeded;
+}
+
+//----------------------------------------------------------------------------------------
+//      同じ時間を安定して進められる最大の微小時間を探します.
+//----------------------------------------------------------------------------------------
+bool SpringRunner::FindStableTimeStep( const RunnerConfig& config, double maxGrowth, RunnerStability& stability, RunnerResult& result )
+{
+    result    = RunnerResult();
+    stability = RunnerStability();
+    stability.type = config.type;
+
+    RunnerConfig baseConfig = config;
+    baseConfig.tolerance = 0.0;
+
+    if ( !Setup( baseConfig, baseConfig.threadCount, result ) )
+    { return false; }
+
+    if ( !( maxGrowth >= 0.0 ) || !( config.minTimeStep > 0.0 ) || !( config.maxTimeStep >= config.minTimeStep ) )
+    {
+        result.message = "invalid time step range";
+        return false;
+    }
+
+    double growth   = 0.0;
+    double stable   = 0.0;
+    double unstable = 0.0;
+
+    // 小さい刻み幅ほど試行が重いので，最大値から半分ずつ下げて最初に安定した所で止める.
+    for( double timeStep = config.maxTimeStep; ; timeStep = std::max( timeStep * 0.5, config.minTimeStep ) )
+    {
+        stability.trials++;
+        if ( TryTimeStep( baseConfig, timeStep, maxGrowth, growth ) )
+        {
+            stable           = timeStep;
+            stability.growth = growth;
+            break;
+        }
+
+        unstable = timeStep;
+        if ( timeStep <= config.minTimeStep )
+        { break; }
+    }
+
+    if ( stable == 0.0 )
+    {
+        stability.belowMin = true;
+        stability.timeStep = config.minTimeStep;
+        stability.growth   = growth;
+        result.succeeded   = true;
+        return true;
+    }
+
+    stability.atMax = ( unstable == 0.0 );
+
+    // 安定と不安定の間を対数の中点で分けて絞り込む.
+    for( unsigned int i=0; i<STABILITY_SEARCH && unstable > 0.0; ++i )
+    {
+        const double middle = std::sqrt( stable * unstable );
+
+        stability.trials++;
+        if ( TryTimeStep( baseConfig, middle, maxGrowth, growth ) )
+        {
+            stable           = middle;
+            stability.growth = growth;
+        }
+        else
+        { unstable = middle; }
+    }
+
+    // 見つかった微小時間で同じ時間を進める時間を計る. 初期化とエネルギーの計算は含まない.
+    RunnerConfig timedConfig = baseConfig;
+    timedConfig.timeStep = stable;
+    timedConfig.steps    = CalcSpanSteps( double( config.steps ) * config.timeStep, stable );
+    if ( !Setup( timedConfig, timedConfig.threadCount, result ) )
+    { return false; }
+
+    const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    Step( m_Config.steps );
+
+    stability.timeStep = stable;
+    stability.steps    = m_Config.steps;
+    stability.seconds  = GetElapsedSeconds( start );
+    result.succeeded   = true;
+    return true;
+}
+
+//----------------------------------------------------------------------------------------
+//      拡張位置ベース法が正しい平衡位置に落ち着くかチェックします.
+//----------------------------------------------------------------------------------------
+bool SpringRunner::CheckChainEquilibrium( std::vector<RunnerChain>& results, RunnerResult& result )
+{
+    static const XPBD_SOLVER solvers[] = { XPBD_SOLVER_GAUSS_SEIDEL, XPBD_SOLVER_JACOBI };
+
+    result = RunnerResult();
+    results.clear();
+    result.matched = true;
+
+    for( size_t i=0; i<sizeof( solvers ) / sizeof( solvers[0] ); ++i )
+    {
+        // 自然長 1 で真下に吊るす. 上端だけを固定する.
+        SpringNetwork network;
+        for( unsigned int j=0; j<CHAIN_PARTICLES; ++j )
+        { network.AddParticle( Vec3( 0.0f, -float( j ), 0.0f ), CHAIN_MASS ); }
+        for( unsigned int j=0; j + 1<CHAIN_PARTICLES; ++j )
+        { network.AddSpring( j, j + 1, CHAIN_CONSTANT_K ); }
+
+        network.SetFixed( 0, true );
+        network.SetTimeStep( CHAIN_TIME_STEP );
+        network.SetDamping( CHAIN_DAMPING );
+        network.SetConstraintSolver( solvers[i] );
+        network.SetConstraintIteration( CHAIN_ITERATION );
+
+        for( unsigned int j=0; j<CHAIN_STEPS; ++j )
+        { network.Update( SIMULATION_TYPE_XPBD ); }
+
+        // 一番上のばねは下に吊るした全ての質点の重さを支える.
+        Vec3 diff = network.GetPosition( 1 ) - network.GetPosition( 0 );
+        const double weight = double( CHAIN_PARTICLES - 1 ) * CHAIN_MASS * fabs( network.GetGravity().y );
+
+        RunnerChain chain;
+        chain.solver   = solvers[i];
+        chain.stretch  = double( diff.Length() ) - 1.0;
+        chain.expected = weight / CHAIN_CONSTANT_K;
+        chain.error    = fabs( chain.stretch - chain.expected ) / chain.expected;
+        chain.passed   = ( chain.error <= CHAIN_TOLERANCE );
+
+        if ( !chain.passed && result.matched )
+        {
+            result.matched = false;
+            result.message = "chain did not settle at the static stretch";
+        }
+
+        results.push_back( chain );
+    }
+
+    result.steps     = CHAIN_STEPS;
+    result.succeeded = result.matched;
+    return result.succeeded;
+}
+
+//----------------------------------------------------------------------------------------
+//      指定した微小時間で同じ時間を進め，エネルギーが増えすぎないかチェックします.
+//----------------------------------------------------------------------------------------
+bool SpringRunner::TryTimeStep( const RunnerConfig& config, double timeStep, double maxGrowth, double& growth )
+{
+    RunnerConfig trialConfig = config;
+    trialConfig.timeStep = timeStep;
+    trialConfig.steps    = CalcSpanSteps( double( config.steps ) * config.timeStep, timeStep );
+
+    RunnerResult result;
+    if ( !Setup( trialConfig, trialConfig.threadCount, result ) )
+    { return false; }
+
+    Capture();
+    const double initialEnergy = CalcEnergy();
+    const double scale         = ( initialEnergy != 0.0 ) ? std::fabs( initialEnergy ) : 1.0;
+    const unsigned long long stride = ( m_Config.steps > STABILITY_RECORDS ) ? m_Config.steps / STABILITY_RECORDS : 1;
+
+    growth = 0.0;
+    for( unsigned long long step = 0; step < m_Config.steps; )
+    {
+        const unsigned long long count = ( m_Config.steps - step < stride ) ? m_Config.steps - step : stride;
+        Step( count );
+        step += count;
+
+        Capture();
+        const double value = ( CalcEnergy() - initialEnergy ) / scale;
+        if ( value > growth || value != value )
+        { growth = value; }
+
+        // NaN も不安定とみなす.
+        if ( !( growth <= maxGrowth ) )
+        { return false; }
+    }
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------
+//      設定を検証し，ばねを初期化します.
+//----------------------------------------------------------------------------------------
+bool SpringRunner::Setup( const RunnerConfig& config, unsigned int threadCount, RunnerResult& result )
+{
+    m_Config = config;
+    if ( m_Config.model == RUNNER_MODEL_SPRING )
+    { m_Config.count = 1; }
+
+    if ( m_Config.model != RUNNER_MODEL_SPRING && m_Config.model != RUNNER_MODEL_SYSTEM )
+    {
+        result.message = "invalid model";
+        return false;
+    }
+
+    if ( m_Config.type < SIMULATION_TYPE_EXPLICIT_EULAR || m_Config.type > SIMULATION_TYPE_XPBD )
+    {
+        result.message = "invalid simulation type";
+        return false;
+    }
+
+    if ( m_Config.count == 0 || m_Config.stride == 0 || !( m_Config.timeStep > 0.0 ) )
+    {
+        result.message = "count, stride and time step must be positive";
+        return false;
+    }
+
+    if ( m_Config.tolerance > 0.0 && m_Config.model != RUNNER_MODEL_SPRING )
+    {
+        result.message = "adaptive time step requires the spring model";
+        return false;
+    }
+
+    if ( m_Config.tolerance > 0.0 && ( !( m_Config.minTimeStep > 0.0 ) || !( m_Config.maxTimeStep >= m_Config.minTimeStep ) ) )
+    {
+        result.message = "invalid time step range";
+        return false;
+    }
+
+    if ( !( m_Config.mass.min > 0.0 ) || !( m_Config.mass.max > 0.0 ) )
+    {
+        result.message = "mass must be positive";
+        return false;
+    }
+
+    // 位置と速度を1レコードにまとめるので，その大きさが size_t に収まるか確認する.
+    if ( m_Config.count > size_t( -1 ) / ( 2 * sizeof(double) ) )
+    {
+        result.message = "too many springs";
+        return false;
+    }
+
+    const size_t count = static_cast<size_t>( m_Config.count );
+    m_Record.resize( count * 2 );
+
+    // 乱数は毎回シードから作り直すので，呼び出し順序に関係なく同じ初期状態になる.
+    SplitMix64 random( m_Config.seed );
+
+    if ( m_Config.model == RUNNER_MODEL_SPRING )
+    {
+        const double mass      = random.Next( m_Config.mass );
+        const double constantK = random.Next( m_Config.constantK );
+        const double length    = random.Next( m_Config.length );
+        const double position  = random.Next( m_Config.position );
+        const double velocity  = random.Next( m_Config.velocity );
+
+        m_Spring.SetMass        ( mass );
+        m_Spring.SetGravity     ( m_Config.gravity );
+        m_Spring.SetTimeStep    ( m_Config.timeStep );
+        m_Spring.SetConstantK   ( constantK );
+        m_Spring.SetLength      ( length );
+        m_Spring.SetInitVelocity( velocity );
+        m_Spring.SetInitPosition( position );
+
+        if ( m_Config.tolerance > 0.0 )
+        {
+            m_Spring.SetTolerance    ( m_Config.tolerance );
+            m_Spring.SetTimeStepRange( m_Config.minTimeStep, m_Config.maxTimeStep );
+        }
+    }
+    else
+    {
+        m_System.Clear();
+        m_System.Resize     ( count );
+        m_System.SetGravity ( m_Config.gravity );
+        m_System.SetTimeStep( m_Config.timeStep );
+
+        for( size_t i=0; i<count; ++i )
+        {
+            const double mass      = random.Next( m_Config.mass );
+            const double constantK = random.Next( m_Config.constantK );
+            const double length    = random.Next( m_Config.length );
+            const double position  = random.Next( m_Config.position );
+            const double velocity  = random.Next( m_Config.velocity );
+
+            m_System.SetSpring( i, mass, constantK, length, position, velocity );
+        }
+
+        m_ThreadPool.Init( threadCount );
+    }
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------
+//      指定ステップ数だけ進めます.
+//----------------------------------------------------------------------------------------
+void SpringRunner::Step( unsigned long long count )
+{
+    if ( m_Config.model == RUNNER_MODEL_SPRING )
+    {
+        // 刻み幅を調整する場合は次の記録時刻まで一度に進める.
+        if ( m_Config.tolerance > 0.0 )
+        {
+            m_Spring.Advance( double( count ) * m_Config.timeStep );
+            return;
+        }
+
+        for( unsigned long long i=0; i<count; ++i )
+        { m_Spring.Update( m_Config.type ); }
+        return;
+    }
+
+    // サブステップでまとめて進めると，スレッド間の同期がチャンクごとに1回で済む.
+    while( count > 0 )
+    {
+        const unsigned int substep = ( count > MAX_SUBSTEP_COUNT ) ? MAX_SUBSTEP_COUNT : static_cast<unsigned int>( count );
+        m_System.Update( m_Config.type, m_ThreadPool, substep );
+        count -= substep;
+    }
+}
+
+//----------------------------------------------------------------------------------------
+//      現在の位置と速度をレコードに書き出します.
+//----------------------------------------------------------------------------------------
+void SpringRunner::Capture()
+{
+    const size_t count = static_cast<size_t>( m_Config.count );
+
+    if ( m_Config.model == RUNNER_MODEL_SPRING )
+    {
+        m_Record[0] = m_Spring.GetPosition();
+        m_Record[1] = m_Spring.GetVelocity();
+        return;
+    }
+
+    memcpy( &m_Record[0],     m_System.GetPositions(),  count * sizeof(double) );
+    memcpy( &m_Record[count], m_System.GetVelocities(), count * sizeof(double) );
+}
+
+//----------------------------------------------------------------------------------------
+//      全エネルギーを求めます. 番号順に足すので結果は実行環境に依存しません.
+//----------------------------------------------------------------------------------------
+double SpringRunner::CalcEnergy() const
+{
+    const size_t count  = static_cast<size_t>( m_Config.count );
+    double       energy = 0.0;
+
+    for( size_t i=0; i<count; ++i )
+    {
+        const double mass      = ( m_Config.model == RUNNER_MODEL_SPRING ) ? m_Spring.GetMass()      : m_System.GetMass( i );
+        const double constantK = ( m_Config.model == RUNNER_MODEL_SPRING ) ? m_Spring.GetConstantK() : m_System.GetConstantK( i );
+        const double length    = ( m_Config.model == RUNNER_MODEL_SPRING ) ? m_Spring.GetLength()    : m_System.GetLength( i );
+        const double x         = m_Record[i];
+        const double v         = m_Record[count + i];
+
+        energy += 0.5 * mass * v * v + 0.5 * constantK * ( x - length ) * ( x - length ) - mass * m_Config.gravity * x;
+    }
+
+    return energy;
+}
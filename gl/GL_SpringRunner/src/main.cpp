@@ -0,0 +1,443 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Headless Spring Simulation Runner
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+
+#if defined(DEBUG) || defined(_DEBUG)
+    #define _CRTDBG_MAP_ALLOC
+    #include <crtdbg.h>
+#endif//defined(DEBUG) || defined(_DEBUG)
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <SpringRunner.h>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+//      使い方を表示します.
+//-------------------------------------------------------------------------------------------
+void PrintUsage()
+{
+    std::cout << "Usage : GL_SpringRunner [options]\n"
+              << "  -model spring|system  model to simulate (default: spring)\n"
+              << "  -type euler|semi|verlet|rk4|implicit|xpbd\n"
+              << "                        integrator (default: verlet)\n"
+              << "  -n <N>                number of springs for -model system (default: 1)\n"
+              << "  -steps <N>            number of steps (default: 1000)\n"
+              << "  -stride <N>           record every N steps (default: 1)\n"
+              << "  -dt <sec>             time step (default: 0.01)\n"
+              << "  -g <value>            gravity (default: 9.8)\n"
+              << "  -seed <N>             random seed for parameter ranges (default: 0)\n"
+              << "  -mass <min>[:<max>]   mass (default: 1)\n"
+              << "  -k <min>[:<max>]      spring constant (default: 100)\n"
+              << "  -length <min>[:<max>] natural length (default: 0)\n"
+              << "  -x <min>[:<max>]      initial position (default: 10)\n"
+              << "  -v <min>[:<max>]      initial velocity (default: 10)\n"
+              << "  -tol <value>          adapt the time step to this error tolerance (spring model only,\n"
+              << "                        Dormand-Prince 5(4); -type is ignored, records stay every -dt)\n"
+              << "  -dtmin <sec>          minimum adaptive time step (default: 1e-6)\n"
+              << "  -dtmax <sec>          maximum adaptive time step (default: 0.1)\n"
+              << "  -j <N>                number of threads for -model system (default: all cores)\n"
+              << "  -o <file>             output trajectory file\n"
+              << "  -f csv|bin            output format (default: bin, or csv for *.csv)\n"
+              << "  -replay <file>        re-run a binary trajectory and compare bit-exactly\n"
+              << "  -bench <N>            time -model system with 1..N threads and print steps/s\n"
+              << "                        (0: all cores; defaults to -n 10000000 -steps 100)\n"
+              << "  -stability <growth>   for every -type, find the largest dt in [-dtmin, -dtmax] that\n"
+              << "                        simulates -steps * -dt without the energy growing by more\n"
+              << "                        than growth * |E0|, and time that span\n"
+              << "  -chain                check that xpbd settles a hanging 6-particle chain (k=200)\n"
+              << "                        at the static stretch with both constraint solvers\n"
+              << std::endl;
+}
+
+//-------------------------------------------------------------------------------------------
+//      "min[:max]" 形式の範囲を解析します.
+//-------------------------------------------------------------------------------------------
+bool ParseRange( const char* text, RunnerRange& range )
+{
+    char* pEnd = nullptr;
+    range.min = strtod( text, &pEnd );
+    if ( pEnd == text )
+    { return false; }
+
+    range.max = range.min;
+    if ( *pEnd == ':' )
+    {
+        const char* pMax = pEnd + 1;
+        range.max = strtod( pMax, &pEnd );
+        if ( pEnd == pMax )
+        { return false; }
+    }
+
+    return ( *pEnd == '\0' );
+}
+
+//-------------------------------------------------------------------------------------------
+//      正の整数を解析します.
+//-------------------------------------------------------------------------------------------
+bool ParseCount( const char* text, unsigned long long& value )
+{
+    // strtoull() は VS2012 に無いので自前で解析する.
+    value = 0;
+    if ( *text == '\0' )
+    { return false; }
+
+    for( const char* p = text; *p != '\0'; ++p )
+    {
+        if ( *p < '0' || *p > '9' )
+        { return false; }
+
+        value = value * 10 + static_cast<unsigned long long>( *p - '0' );
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      実数を解析します.
+//-------------------------------------------------------------------------------------------
+bool ParseDouble( const char* text, double& value )
+{
+    char* pEnd = nullptr;
+    value = strtod( text, &pEnd );
+    return ( pEnd != text && *pEnd == '\0' );
+}
+
+//-------------------------------------------------------------------------------------------
+//      ファイル名が指定した拡張子で終わるかチェックします.
+//-------------------------------------------------------------------------------------------
+bool HasExtension( const char* path, const char* ext )
+{
+    const size_t pathLength = strlen( path );
+    const size_t extLength  = strlen( ext );
+    return ( pathLength >= extLength && strcmp( path + pathLength - extLength, ext ) == 0 );
+}
+
+//-------------------------------------------------------------------------------------------
+//      スレッド数ごとの計測結果を表示します.
+//-------------------------------------------------------------------------------------------
+void PrintBenchmark( const RunnerConfig& config, const std::vector<RunnerBenchmark>& results )
+{
+    std::cout << "springs  : " << config.count << ", " << config.steps << " steps\n"
+              << "threads      time[s]      steps/s   Mspring-steps/s  speedup  digest\n";
+
+    for( size_t i=0; i<results.size(); ++i )
+    {
+        const RunnerBenchmark& bench = results[i];
+        std::cout << std::setw( 7 ) << bench.threadCount
+                  << std::fixed
+                  << std::setw( 13 ) << std::setprecision( 3 ) << bench.seconds
+                  << std::setw( 13 ) << std::setprecision( 2 ) << bench.stepsPerSecond
+                  << std::setw( 18 ) << std::setprecision( 1 ) << bench.stepsPerSecond * double( config.count ) * 1e-6
+                  << std::setw( 9 )  << std::setprecision( 2 ) << bench.speedup
+                  << "  " << std::hex << std::setw( 16 ) << std::setfill( '0' ) << bench.digest << std::dec << std::setfill( ' ' )
+                  << "\n";
+    }
+
+    std::cout << std::flush;
+}
+
+//-------------------------------------------------------------------------------------------
+//      積分方法の名前を取得します.
+//-------------------------------------------------------------------------------------------
+const char* GetTypeName( SIMULATION_TYPE type )
+{
+    switch( type )
+    {
+    case SIMULATION_TYPE_EXPLICIT_EULAR:      return "euler";
+    case SIMULATION_TYPE_VERLET:              return "verlet";
+    case SIMULATION_TYPE_SEMI_IMPLICIT_EULAR: return "semi";
+    case SIMULATION_TYPE_RUNGE_KUTTA4:        return "rk4";
+    case SIMULATION_TYPE_IMPLICIT_EULAR:      return "implicit";
+    case SIMULATION_TYPE_XPBD:                return "xpbd";
+    default:                                  break;
+    }
+
+    return "unknown";
+}
+
+//-------------------------------------------------------------------------------------------
+//      積分方法ごとの安定な最大の微小時間を表示します.
+//-------------------------------------------------------------------------------------------
+void PrintStability( const RunnerStability& stability )
+{
+    std::cout << std::setw( 8 ) << std::left << GetTypeName( stability.type ) << std::right;
+
+    if ( stability.belowMin )
+    {
+        std::cout << "  unstable at dt " << std::scientific << std::setprecision( 3 ) << stability.timeStep
+                  << " (growth " << stability.growth << ")" << std::endl;
+        return;
+    }
+
+    std::cout << ( stability.atMax ? "  >=" : "    " )
+              << std::scientific << std::setprecision( 3 ) << stability.timeStep
+              << std::setw( 12 ) << stability.steps
+              << std::fixed << std::setprecision( 4 ) << std::setw( 11 ) << stability.seconds
+              << std::scientific << std::setprecision( 2 ) << std::setw( 12 ) << stability.growth
+              << std::setw( 7 ) << stability.trials
+              << std::endl;
+}
+
+//-------------------------------------------------------------------------------------------
+//      鎖の平衡位置のチェック結果を表示します.
+//-------------------------------------------------------------------------------------------
+void PrintChain( const std::vector<RunnerChain>& results )
+{
+    std::cout << "solver        stretch   expected      error\n";
+
+    for( size_t i=0; i<results.size(); ++i )
+    {
+        const RunnerChain& chain = results[i];
+        std::cout << std::setw( 12 ) << std::left << ( ( chain.solver == XPBD_SOLVER_JACOBI ) ? "jacobi" : "gauss-seidel" ) << std::right
+                  << std::fixed << std::setprecision( 4 )
+                  << std::setw( 11 ) << chain.stretch
+                  << std::setw( 11 ) << chain.expected
+                  << std::scientific << std::setprecision( 2 )
+                  << std::setw( 11 ) << chain.error
+                  << ( chain.passed ? "  ok" : "  NG" )
+                  << "\n";
+    }
+
+    std::cout << std::flush;
+}
+
+//-------------------------------------------------------------------------------------------
+//      実行結果を表示します.
+//-------------------------------------------------------------------------------------------
+void PrintResult( const RunnerResult& result )
+{
+    std::cout << "steps    : " << result.steps << " (" << result.records << " records)\n";
+    if ( result.acceptedSteps > 0 )
+    { std::cout << "adaptive : " << result.acceptedSteps << " accepted, " << result.rejectedSteps << " rejected\n"; }
+
+    std::cout << "energy   : " << std::setprecision( 17 ) << result.initialEnergy << " -> " << result.finalEnergy << "\n"
+              << "drift    : " << std::setprecision( 6 ) << result.maxDrift << " (max relative)\n"
+              << "digest   : " << std::hex << std::setw( 16 ) << std::setfill( '0' ) << result.digest << std::dec << std::setfill( ' ' ) << "\n"
+              << "time     : " << std::fixed << std::setprecision( 3 ) << result.seconds << " sec"
+              << std::endl;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+#if defined(DEBUG) || defined(_DEBUG)
+    _CrtSetDbgFlag( _CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF );
+#endif//defined(DEBUG) || defined(_DEBUG)
+
+    RunnerConfig    config;
+    RUNNER_OUTPUT   output       = RUNNER_OUTPUT_NONE;
+    bool            formatGiven  = false;
+    const char*     outputPath   = nullptr;
+    const char*     replayPath   = nullptr;
+    bool            benchmark    = false;
+    unsigned int    benchThreads = 0;
+    bool            countGiven   = false;
+    bool            stepsGiven   = false;
+    double          maxGrowth    = -1.0;
+    bool            chain        = false;
+
+    for( int i=1; i<argc; ++i )
+    {
+        const char* arg  = argv[i];
+        const char* next = ( i + 1 < argc ) ? argv[i + 1] : nullptr;
+        bool        ok   = true;
+        unsigned long long value = 0;
+
+        if ( strcmp( arg, "-model" ) == 0 && next != nullptr )
+        {
+            if      ( strcmp( next, "spring" ) == 0 ) { config.model = RUNNER_MODEL_SPRING; }
+            else if ( strcmp( next, "system" ) == 0 ) { config.model = RUNNER_MODEL_SYSTEM; }
+            else    { ok = false; }
+            ++i;
+        }
+        else if ( strcmp( arg, "-type" ) == 0 && next != nullptr )
+        {
+            if      ( strcmp( next, "euler" )    == 0 ) { config.type = SIMULATION_TYPE_EXPLICIT_EULAR; }
+            else if ( strcmp( next, "semi" )     == 0 ) { config.type = SIMULATION_TYPE_SEMI_IMPLICIT_EULAR; }
+            else if ( strcmp( next, "verlet" )   == 0 ) { config.type = SIMULATION_TYPE_VERLET; }
+            else if ( strcmp( next, "rk4" )      == 0 ) { config.type = SIMULATION_TYPE_RUNGE_KUTTA4; }
+            else if ( strcmp( next, "implicit" ) == 0 ) { config.type = SIMULATION_TYPE_IMPLICIT_EULAR; }
+            else if ( strcmp( next, "xpbd" )     == 0 ) { config.type = SIMULATION_TYPE_XPBD; }
+            else    { ok = false; }
+            ++i;
+        }
+        else if ( strcmp( arg, "-n" ) == 0 && next != nullptr )
+        { ok = ParseCount( next, config.count ); countGiven = true; ++i; }
+        else if ( strcmp( arg, "-steps" ) == 0 && next != nullptr )
+        { ok = ParseCount( next, config.steps ); stepsGiven = true; ++i; }
+        else if ( strcmp( arg, "-stride" ) == 0 && next != nullptr )
+        { ok = ParseCount( next, config.stride ); ++i; }
+        else if ( strcmp( arg, "-dt" ) == 0 && next != nullptr )
+        { ok = ParseDouble( next, config.timeStep ); ++i; }
+        else if ( strcmp( arg, "-g" ) == 0 && next != nullptr )
+        { ok = ParseDouble( next, config.gravity ); ++i; }
+        else if ( strcmp( arg, "-seed" ) == 0 && next != nullptr )
+        { ok = ParseCount( next, config.seed ); ++i; }
+        else if ( strcmp( arg, "-mass" ) == 0 && next != nullptr )
+        { ok = ParseRange( next, config.mass ); ++i; }
+        else if ( strcmp( arg, "-k" ) == 0 && next != nullptr )
+        { ok = ParseRange( next, config.constantK ); ++i; }
+        else if ( strcmp( arg, "-length" ) == 0 && next != nullptr )
+        { ok = ParseRange( next, config.length ); ++i; }
+        else if ( strcmp( arg, "-x" ) == 0 && next != nullptr )
+        { ok = ParseRange( next, config.position ); ++i; }
+        else if ( strcmp( arg, "-v" ) == 0 && next != nullptr )
+        { ok = ParseRange( next, config.velocity ); ++i; }
+        else if ( strcmp( arg, "-tol" ) == 0 && next != nullptr )
+        { ok = ParseDouble( next, config.tolerance ) && config.tolerance > 0.0; ++i; }
+        else if ( strcmp( arg, "-dtmin" ) == 0 && next != nullptr )
+        { ok = ParseDouble( next, config.minTimeStep ); ++i; }
+        else if ( strcmp( arg, "-dtmax" ) == 0 && next != nullptr )
+        { ok = ParseDouble( next, config.maxTimeStep ); ++i; }
+        else if ( strcmp( arg, "-j" ) == 0 && next != nullptr )
+        {
+            ok = ParseCount( next, value );
+            config.threadCount = static_cast<unsigned int>( value );
+            ++i;
+        }
+        else if ( strcmp( arg, "-o" ) == 0 && next != nullptr )
+        { outputPath = next; ++i; }
+        else if ( strcmp( arg, "-f" ) == 0 && next != nullptr )
+        {
+            formatGiven = true;
+            if      ( strcmp( next, "csv" ) == 0 ) { output = RUNNER_OUTPUT_CSV; }
+            else if ( strcmp( next, "bin" ) == 0 ) { output = RUNNER_OUTPUT_BINARY; }
+            else    { ok = false; }
+            ++i;
+        }
+        else if ( strcmp( arg, "-replay" ) == 0 && next != nullptr )
+        { replayPath = next; ++i; }
+        else if ( strcmp( arg, "-bench" ) == 0 && next != nullptr )
+        {
+            ok = ParseCount( next, value );
+            benchmark    = true;
+            benchThreads = static_cast<unsigned int>( value );
+            ++i;
+        }
+        else if ( strcmp( arg, "-stability" ) == 0 && next != nullptr )
+        { ok = ParseDouble( next, maxGrowth ) && maxGrowth >= 0.0; ++i; }
+        else if ( strcmp( arg, "-chain" ) == 0 )
+        { chain = true; }
+        else
+        { ok = false; }
+
+        if ( !ok )
+        {
+            std::cerr << "Error : invalid option " << arg << std::endl;
+            PrintUsage();
+            return -1;
+        }
+    }
+
+    SpringRunner runner;
+    RunnerResult result;
+
+    // 記録済みの軌跡を再生して比較する.
+    if ( replayPath != nullptr )
+    {
+        if ( !runner.Replay( replayPath, config.threadCount, result ) )
+        {
+            std::cerr << "Error : " << replayPath << " : " << result.message << std::endl;
+            return -1;
+        }
+
+        PrintResult( result );
+        if ( !result.matched )
+        {
+            std::cout << "replay   : MISMATCH at step " << result.mismatchStep << std::endl;
+            return 1;
+        }
+
+        std::cout << "replay   : bit-exact" << std::endl;
+        return 0;
+    }
+
+    // 吊り下げた鎖の伸びを静的なつり合いと比べる.
+    if ( chain )
+    {
+        std::vector<RunnerChain> results;
+        const bool succeeded = runner.CheckChainEquilibrium( results, result );
+        PrintChain( results );
+
+        if ( !succeeded )
+        {
+            std::cerr << "Error : " << result.message << std::endl;
+            return 1;
+        }
+
+        return 0;
+    }
+
+    // スレッド数を変えて更新速度を計測する. 軌跡は出力しない.
+    if ( benchmark )
+    {
+        if ( !countGiven ) { config.count = 10000000; }
+        if ( !stepsGiven ) { config.steps = 100; }
+
+        std::vector<RunnerBenchmark> results;
+        const bool succeeded = runner.Benchmark( config, benchThreads, results, result );
+        PrintBenchmark( config, results );
+
+        if ( !succeeded )
+        {
+            std::cerr << "Error : " << result.message << std::endl;
+            return results.empty() ? -1 : 1;
+        }
+
+        return 0;
+    }
+
+    // 積分方法ごとに同じ時間を安定して進められる最大の微小時間を探す.
+    if ( maxGrowth >= 0.0 )
+    {
+        std::cout << "span     : " << double( config.steps ) * config.timeStep << " sec, "
+                  << config.count << " spring(s), growth limit " << maxGrowth << "\n"
+                  << "type      largest dt        steps    time[s]      growth trials" << std::endl;
+
+        for( int type=SIMULATION_TYPE_EXPLICIT_EULAR; type<=SIMULATION_TYPE_XPBD; ++type )
+        {
+            config.type = static_cast<SIMULATION_TYPE>( type );
+
+            RunnerStability stability;
+            if ( !runner.FindStableTimeStep( config, maxGrowth, stability, result ) )
+            {
+                std::cerr << "Error : " << result.message << std::endl;
+                return -1;
+            }
+
+            PrintStability( stability );
+        }
+
+        return 0;
+    }
+
+    if ( outputPath != nullptr && !formatGiven )
+    { output = HasExtension( outputPath, ".csv" ) ? RUNNER_OUTPUT_CSV : RUNNER_OUTPUT_BINARY; }
+    else if ( outputPath == nullptr )
+    { output = RUNNER_OUTPUT_NONE; }
+
+    if ( !runner.Run( config, output, outputPath, result ) )
+    {
+        std::cerr << "Error : " << result.message << std::endl;
+        return -1;
+    }
+
+    PrintResult( result );
+    return 0;
+}
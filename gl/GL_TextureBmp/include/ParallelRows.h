@@ -0,0 +1,66 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : ParallelRows.h
+// Desc : Parallel Row Range Dispatcher.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+#ifndef _PARALLEL_ROWS_H_
+#define _PARALLEL_ROWS_H_
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+
+//-------------------------------------------------------------------------------------------
+//! @brief      行の範囲を分割して並列実行します.
+//!
+//! @note       func( begin, end ) を重ならない [begin, end) ごとに呼び出します. 全ての区間は
+//!             [0, rowCount) に収まり，最後の区間は呼び出しスレッドが担当します.
+//!             1スレッドあたりの行数が minRowsPerThread を下回らないようにスレッド数を減らします.
+//! @param [in]     rowCount            行数です.
+//! @param [in]     minRowsPerThread    スレッド1つあたりの最小行数です.
+//! @param [in]     threadCount         使用するスレッド数です. 0の場合はハードウェアスレッド数を使用します.
+//! @param [in]     func                行の範囲を処理する関数です.
+//-------------------------------------------------------------------------------------------
+template<typename Func>
+inline void ParallelRows( unsigned int rowCount, unsigned int minRowsPerThread, unsigned int threadCount, Func func )
+{
+    if ( threadCount == 0 )
+    { threadCount = std::thread::hardware_concurrency(); }
+
+    // 行数が少ない場合はスレッド生成のコストの方が大きいので分割しない.
+    unsigned int maxThreads = rowCount / minRowsPerThread;
+    if ( threadCount > maxThreads ) { threadCount = maxThreads; }
+    if ( threadCount < 1 )          { threadCount = 1; }
+
+    if ( threadCount == 1 )
+    {
+        func( 0, rowCount );
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve( threadCount - 1 );
+
+    // 切り上げた行数で分割するので，途中で全ての行を割り当て終わる場合がある.
+    const unsigned int rowsPerThread = ( rowCount + threadCount - 1 ) / threadCount;
+    unsigned int begin = 0;
+    for( unsigned int i=0; i<threadCount - 1 && begin < rowCount; ++i )
+    {
+        const unsigned int end = std::min( begin + rowsPerThread, rowCount );
+        threads.push_back( std::thread( func, begin, end ) );
+        begin = end;
+    }
+
+    func( begin, rowCount );
+
+    for( size_t i=0; i<threads.size(); ++i )
+    { threads[i].join(); }
+}
+
+
+#endif//_PARALLEL_ROWS_H_
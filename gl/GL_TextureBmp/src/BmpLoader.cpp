@@ -8,29 +8,50 @@
 // Includes
 //-------------------------------------------------------------------------------------------
 #include <iostream>
-#include <fstream>
+#include <cstdlib>
+#include <cstring>
 #include <BmpLoader.h>
+#include <MappedFile.h>
+#include <MipMapGenerator.h>
+#include <TextureCache.h>
+#include <ColorSpace.h>
 #include <GL/glut.h>
 
+#ifndef GL_SRGB8
+#define GL_SRGB8            0x8C41
+#endif//GL_SRGB8
+
+#ifndef GL_SRGB8_ALPHA8
+#define GL_SRGB8_ALPHA8     0x8C43
+#endif//GL_SRGB8_ALPHA8
+
 
 namespace /* anonymous */ {
 
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+const unsigned short    BMP_SIGNATURE   = 0x4d42;   // "BM".
+const unsigned int      BI_RGB          = 0;        // 非圧縮.
+
+
 #pragma pack(push, 1 )
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 // BmpInfoHeader structure
 /////////////////////////////////////////////////////////////////////////////////////////////
+// LONG は32bitなので，long が64bitになる環境でもサイズが変わらないよう int で定義する.
 struct BmpInfoHeader
 {
     unsigned int    biSize;
-    long            biWidth;
-    long            biHeight;
+    int             biWidth;
+    int             biHeight;
     unsigned short  biPlanes;
     unsigned short  biBitCount;
     unsigned int    biCompression;
     unsigned int    biSizeImage;
-    long            biXPelsPerMeter;
-    long            biYPelsPerMeter;
+    int             biXPelsPerMeter;
+    int             biYPelsPerMeter;
     unsigned int    biClrUsed;
     unsigned int    biClrImportant;
 };
@@ -49,6 +70,43 @@ struct BmpFileHeader
 
 #pragma pack(pop)
 
+//-------------------------------------------------------------------------------------------
+//      色空間に応じた内部フォーマットを取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int GetInternalFormat( unsigned int format, COLOR_SPACE colorSpace )
+{
+    if ( colorSpace != COLOR_SPACE_SRGB )
+    { return format; }
+
+    return ( format == GL_RGBA ) ? GL_SRGB8_ALPHA8 : GL_SRGB8;
+}
+
+//-------------------------------------------------------------------------------------------
+//      sRGBの内部フォーマットかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsSRGBInternalFormat( unsigned int internalFormat )
+{ return ( internalFormat == GL_SRGB8 ) || ( internalFormat == GL_SRGB8_ALPHA8 ); }
+
+//-------------------------------------------------------------------------------------------
+//      sRGBテクスチャに対応しているかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsSupportSRGBTexture()
+{
+    // GL 2.1 以降はコア機能.
+    const char* pVersion = reinterpret_cast<const char*>( glGetString( GL_VERSION ) );
+    if ( pVersion != nullptr )
+    {
+        const char* pDot  = strchr( pVersion, '.' );
+        const int   major = atoi( pVersion );
+        const int   minor = ( pDot != nullptr ) ? atoi( pDot + 1 ) : 0;
+        if ( major > 2 || ( major == 2 && minor >= 1 ) )
+        { return true; }
+    }
+
+    const char* pExtensions = reinterpret_cast<const char*>( glGetString( GL_EXTENSIONS ) );
+    return ( pExtensions != nullptr ) && ( strstr( pExtensions, "GL_EXT_texture_sRGB" ) != nullptr );
+}
+
 } // namespace /* anonymous */
 
 
@@ -68,6 +126,8 @@ BmpImage::BmpImage()
 , m_BytePerPixel    ( 0 )
 , m_ID              ( 0 )
 , m_pImageData      ( nullptr )
+, m_ColorSpace      ( COLOR_SPACE_SRGB )
+, m_ColorSpaceHint  ( COLOR_SPACE_SRGB )
 { /* DO_NOTHING */ }
 
 
@@ -88,12 +148,15 @@ void BmpImage::Release()
         m_pImageData = nullptr;
     }
 
+    m_Cache.Close();
+
     m_ImageSize      = 0;
     m_Format         = 0;
     m_InternalFormat = 0;
     m_Width          = 0;
     m_Height         = 0;
     m_BytePerPixel   = 0;
+    m_ColorSpace     = m_ColorSpaceHint;
 }
 
 //-------------------------------------------------------------------------------------------
@@ -101,71 +164,124 @@ void BmpImage::Release()
 //-------------------------------------------------------------------------------------------
 bool BmpImage::Load(const char *filename)
 {
-    FILE *fp;
+    // 線形として扱う場合はミップマップの内容が変わるので，キャッシュを区別する.
+    const unsigned long long salt = ( m_ColorSpaceHint == COLOR_SPACE_LINEAR ) ? TextureCache::SALT_LINEAR : 0;
 
-    BmpInfoHeader infoHeader;
-    BmpFileHeader header;
+    // 変換済みのキャッシュがあれば復号とミップ生成をすべて省略する.
+    if ( m_Cache.Open( filename, salt ) )
+    {
+        m_Width          = m_Cache.GetWidth();
+        m_Height         = m_Cache.GetHeight();
+        m_BytePerPixel   = m_Cache.GetBytePerPixel();
+        m_Format         = m_Cache.GetFormat();
+        m_InternalFormat = m_Cache.GetInternalFormat();
+        m_ColorSpace     = IsSRGBInternalFormat( m_InternalFormat ) ? COLOR_SPACE_SRGB : COLOR_SPACE_LINEAR;
+        m_ImageSize      = m_Cache.GetLevel( 0 ).size;
+        return true;
+    }
 
-    // ファイルを開く
-    errno_t err = fopen_s( &fp, filename, "rb" );
-    if ( err != 0 )
+    MappedFile file;
+    if ( !file.Open( filename ) )
     {
         std::cerr << "Error : File Open Failed.";
         std::cerr << "File Name : " << filename << std::endl;
         return false;
     }
 
-    // ヘッダー情報の読み取り
-    fread( &header, sizeof(header), 1, fp );
+    const unsigned char* pData = file.GetData();
+    const size_t         size  = file.GetSize();
+
+    // ヘッダー情報の読み取り. ファイルが途中で切れていないか先にチェックする.
+    BmpFileHeader header;
+    BmpInfoHeader infoHeader;
+    if ( size < sizeof(header) + sizeof(infoHeader) )
+    {
+        std::cerr << "Error : Invalid File.";
+        std::cerr << "File Name : " << filename << std::endl;
+        return false;
+    }
+
+    memcpy( &header,     pData,                  sizeof(header) );
+    memcpy( &infoHeader, pData + sizeof(header), sizeof(infoHeader) );
 
     // ファイルチェック
-    if ( header.bfType != 0x4d42 )
+    if ( header.bfType != BMP_SIGNATURE || infoHeader.biSize < sizeof(infoHeader) )
     {
-        std::cerr << "Error : Invalid File";
-        fclose(fp);
+        std::cerr << "Error : Invalid File.";
+        std::cerr << "File Name : " << filename << std::endl;
         return false;
     }
 
-    // ヘッダー情報の読み取り
-    fread( &infoHeader, sizeof(infoHeader), 1, fp );
+    // 非圧縮の24bitのみ対応.
+    if ( infoHeader.biBitCount != 24 || infoHeader.biCompression != BI_RGB )
+    {
+        std::cerr << "Error : Unsupported Format. BitCount = " << infoHeader.biBitCount
+                  << ", Compression = " << infoHeader.biCompression << std::endl;
+        return false;
+    }
+
+    // 高さが負の場合は上から下の行順で格納されている.
+    if ( infoHeader.biWidth <= 0 || infoHeader.biHeight == 0 || infoHeader.biHeight < -0x7fffffff )
+    {
+        std::cerr << "Error : Invalid Size." << std::endl;
+        return false;
+    }
 
-    if ( infoHeader.biSizeImage == 0 )
-    { infoHeader.biSizeImage = infoHeader.biWidth * infoHeader.biHeight * 3; }
+    const bool         topDown = ( infoHeader.biHeight < 0 );
+    const unsigned int width   = static_cast<unsigned int>( infoHeader.biWidth );
+    const unsigned int height  = static_cast<unsigned int>( topDown ? -infoHeader.biHeight : infoHeader.biHeight );
 
-    // 進める.
-    fseek( fp, header.bfOffBits, SEEK_SET );
+    // biSizeImage は信用せず，64bitで計算してからオーバーフローと切れたファイルをチェックする.
+    // 各行は4バイト境界にパディングされるが，最終行のパディングは省略されていても許容する.
+    const unsigned long long rowSize   = static_cast<unsigned long long>( width ) * 3;
+    const unsigned long long pitch     = ( rowSize + 3 ) & ~3ull;
+    const unsigned long long imageSize = rowSize * height;
+    if ( imageSize > 0xffffffff || imageSize > static_cast<unsigned long long>( size_t( -1 ) ) )
+    {
+        std::cerr << "Error : Image Too Large." << std::endl;
+        return false;
+    }
+
+    if ( header.bfOffBits > size || pitch * ( height - 1 ) + rowSize > size - header.bfOffBits )
+    {
+        std::cerr << "Error : Unexpected End Of File." << std::endl;
+        return false;
+    }
 
     //　データサイズを決定し，メモリを確保
-    m_ImageSize  = infoHeader.biSizeImage;
+    m_ImageSize  = static_cast<unsigned int>( imageSize );
     m_pImageData = new(std::nothrow) unsigned char [m_ImageSize];
     if ( m_pImageData == nullptr )
     {
         std::cerr << "Error : Memory Allocate Failed." << std::endl;
-        fclose( fp );
         return false;
     }
 
     // データを設定.
-    m_Width          = infoHeader.biWidth;
-    m_Height         = infoHeader.biHeight;
+    m_Width          = width;
+    m_Height         = height;
     m_BytePerPixel   = 3;
     m_Format         = GL_RGB;
-    m_InternalFormat = GL_RGB;
-
-    //　ピクセルデータの読み込み
-    fread( m_pImageData, 1, infoHeader.biSizeImage, fp );
+    m_ColorSpace     = m_ColorSpaceHint;
+    m_InternalFormat = GetInternalFormat( GL_RGB, m_ColorSpace );
 
-    //　BGR → RGBに変換
-    for ( unsigned int i=0; i<m_ImageSize; i+=m_BytePerPixel )
+    //　ピクセルデータをパディングを除いて読み込み，BGR → RGBに変換.
+    //　出力は下から上の行順に揃える.
+    const unsigned char* pPixels = pData + header.bfOffBits;
+    for ( unsigned int y=0; y<height; ++y )
     {
-        unsigned char    temp = m_pImageData[ i + 0 ];
-        m_pImageData[ i + 0 ] = m_pImageData[ i + 2 ];
-        m_pImageData[ i + 2 ] = temp;
+        const unsigned int   srcY = ( topDown ) ? ( height - 1 - y ) : y;
+        const unsigned char* pSrc = pPixels + pitch * srcY;
+        unsigned char*       pDst = m_pImageData + rowSize * y;
+
+        for ( unsigned int x=0; x<width; ++x )
+        {
+            pDst[ x * 3 + 0 ] = pSrc[ x * 3 + 2 ];
+            pDst[ x * 3 + 1 ] = pSrc[ x * 3 + 1 ];
+            pDst[ x * 3 + 2 ] = pSrc[ x * 3 + 0 ];
+        }
     }
 
-    //　ファイルを閉じる
-    fclose(fp);
-
     // 正常終了.
     return true;
 }
@@ -175,7 +291,7 @@ bool BmpImage::Load(const char *filename)
 //-------------------------------------------------------------------------------------------
 bool BmpImage::CreateGLTexture()
 {
-    if ( m_pImageData == nullptr )
+    if ( m_pImageData == nullptr && !m_Cache.IsValid() )
     { return false; }
 
     //　テクスチャを生成
@@ -184,20 +300,68 @@ bool BmpImage::CreateGLTexture()
     //　テクスチャをバインドする
     glBindTexture(GL_TEXTURE_2D, m_ID);
 
+    // sRGBテクスチャに非対応の環境では変換せずにそのまま転送する.
+    const unsigned int internalFormat = ( IsSRGBInternalFormat( m_InternalFormat ) && !IsSupportSRGBTexture() )
+        ? m_Format
+        : m_InternalFormat;
+
     if ( m_BytePerPixel == 4 )
     { glPixelStorei(GL_UNPACK_ALIGNMENT, 4); }
     else 
     { glPixelStorei(GL_UNPACK_ALIGNMENT, 1); }
 
-    //　テクスチャの割り当て
-    gluBuild2DMipmaps(
-        GL_TEXTURE_2D,
-        m_InternalFormat,
-        m_Width,
-        m_Height,
-        m_Format,
-        GL_UNSIGNED_BYTE,
-        m_pImageData );
+    if ( m_Cache.IsValid() )
+    {
+        //　キャッシュからマップしたまま転送する.
+        for( unsigned int i=0; i<m_Cache.GetMipCount(); ++i )
+        {
+            const TextureCache::Level& level = m_Cache.GetLevel( i );
+            glTexImage2D(
+                GL_TEXTURE_2D,
+                int(i),
+                internalFormat,
+                level.width,
+                level.height,
+                0,
+                m_Format,
+                GL_UNSIGNED_BYTE,
+                m_Cache.GetLevelData( i ) );
+        }
+    }
+    else
+    {
+        //　ミップマップチェインをCPUで生成する(非2の累乗サイズもリスケールしない).
+        //　sRGBの画像は線形空間に変換してから縮小する.
+        MipMapOption option;
+        option.isSRGB = ( m_ColorSpace == COLOR_SPACE_SRGB );
+
+        std::vector<MipLevel> levels;
+        if ( !GenerateMipMaps( m_pImageData, m_Width, m_Height, m_BytePerPixel, option, levels ) )
+        {
+            std::cerr << "Error : Generate MipMaps Failed." << std::endl;
+            glBindTexture( GL_TEXTURE_2D, 0 );
+            DeleteGLTexture();
+            return false;
+        }
+
+        //　テクスチャの割り当て
+        for( size_t i=0; i<levels.size(); ++i )
+        {
+            glTexImage2D(
+                GL_TEXTURE_2D,
+                int(i),
+                internalFormat,
+                levels[i].width,
+                levels[i].height,
+                0,
+                m_Format,
+                GL_UNSIGNED_BYTE,
+                &levels[i].pixels[0] );
+        }
+
+        // 次回の起動で復号とミップ生成を省略できるよう保存しておく.
+        m_Cache.Save( m_Format, m_InternalFormat, m_BytePerPixel, levels );
+    }
 
     //　テクスチャを拡大・縮小する方法の指定
     glTexParameteri(GL_TEXTURE_2D, 	GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -229,3 +393,39 @@ void BmpImage::DeleteGLTexture()
 //-------------------------------------------------------------------------------------------
 unsigned int BmpImage::GetID() const
 { return m_ID; }
+
+//-------------------------------------------------------------------------------------------
+//      画像の横幅を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int BmpImage::GetWidth() const
+{ return m_Width; }
+
+//-------------------------------------------------------------------------------------------
+//      画像の縦幅を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int BmpImage::GetHeight() const
+{ return m_Height; }
+
+//-------------------------------------------------------------------------------------------
+//      1ピクセルあたりのバイト数を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int BmpImage::GetBytePerPixel() const
+{ return m_BytePerPixel; }
+
+//-------------------------------------------------------------------------------------------
+//      ピクセルデータを取得します.
+//-------------------------------------------------------------------------------------------
+const unsigned char* BmpImage::GetPixels() const
+{ return ( m_pImageData != nullptr ) ? m_pImageData : m_Cache.GetLevelData( 0 ); }
+
+//-------------------------------------------------------------------------------------------
+//      色空間の情報を持たない画像に適用する色空間を設定します.
+//-------------------------------------------------------------------------------------------
+void BmpImage::SetColorSpaceHint( COLOR_SPACE colorSpace )
+{ m_ColorSpaceHint = colorSpace; }
+
+//-------------------------------------------------------------------------------------------
+//      読み込んだ画像の色空間を取得します.
+//-------------------------------------------------------------------------------------------
+COLOR_SPACE BmpImage::GetColorSpace() const
+{ return m_ColorSpace; }
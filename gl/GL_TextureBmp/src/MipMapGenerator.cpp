@@ -0,0 +1,427 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : MipMapGenerator.cpp
+// Desc : CPU MipMap Chain Generator.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <MipMapGenerator.h>
+#include <ColorSpace.h>
+#include <ParallelRows.h>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#if defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 1 ) || defined(__SSE__)
+    #define MIP_ENABLE_SSE      1
+    #include <xmmintrin.h>
+#else
+    #define MIP_ENABLE_SSE      0
+#endif
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+static const float          PI                  = 3.14159265358979323846f;
+static const float          KAISER_WIDTH        = 3.0f;     // カイザーフィルタの半径.
+static const float          KAISER_ALPHA        = 4.0f;     // カイザー窓の形状パラメータ.
+static const float          LANCZOS_WIDTH       = 3.0f;     // Lanczosフィルタの半径.
+static const unsigned int   MIN_ROWS_PER_THREAD = 32;       // スレッド1つあたりの最小行数.
+static const unsigned int   COVERAGE_ITERATION  = 10;       // 被覆率のスケール探索回数.
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// FilterTable structure
+////////////////////////////////////////////////////////////////////////////////////////////
+struct FilterTable
+{
+    unsigned int        taps;           // 1出力あたりのタップ数.
+    std::vector<int>    index;          // 参照する入力位置 (出力数 * taps).
+    std::vector<float>  weight;         // 正規化済みの重み (出力数 * taps).
+};
+
+
+//-------------------------------------------------------------------------------------------
+//      sinc関数です.
+//-------------------------------------------------------------------------------------------
+inline float Sinc( float x )
+{
+    if ( fabsf( x ) < 1e-5f )
+    { return 1.0f; }
+
+    x *= PI;
+    return sinf( x ) / x;
+}
+
+//-------------------------------------------------------------------------------------------
+//      第1種変形ベッセル関数 I0 を級数展開で求めます.
+//-------------------------------------------------------------------------------------------
+float BesselI0( float x )
+{
+    float sum  = 1.0f;
+    float term = 1.0f;
+    const float q = x * x * 0.25f;
+
+    for( int k=1; k<32; ++k )
+    {
+        term *= q / float( k * k );
+        sum  += term;
+        if ( term < sum * 1e-7f )
+        { break; }
+    }
+
+    return sum;
+}
+
+//-------------------------------------------------------------------------------------------
+//      フィルタの半径を取得します.
+//-------------------------------------------------------------------------------------------
+float GetFilterWidth( MIPMAP_FILTER filter )
+{
+    switch( filter )
+    {
+    case MIPMAP_FILTER_KAISER:  return KAISER_WIDTH;
+    case MIPMAP_FILTER_LANCZOS: return LANCZOS_WIDTH;
+    default:                    break;
+    }
+
+    return 0.5f;
+}
+
+//-------------------------------------------------------------------------------------------
+//      フィルタカーネルを評価します.
+//-------------------------------------------------------------------------------------------
+float EvaluateFilter( MIPMAP_FILTER filter, float x )
+{
+    x = fabsf( x );
+
+    switch( filter )
+    {
+    case MIPMAP_FILTER_KAISER:
+        {
+            if ( x >= KAISER_WIDTH )
+            { return 0.0f; }
+
+            const float t = x / KAISER_WIDTH;
+            return Sinc( x ) * BesselI0( KAISER_ALPHA * sqrtf( 1.0f - t * t ) ) / BesselI0( KAISER_ALPHA );
+        }
+
+    case MIPMAP_FILTER_LANCZOS:
+        {
+            if ( x >= LANCZOS_WIDTH )
+            { return 0.0f; }
+
+            return Sinc( x ) * Sinc( x / LANCZOS_WIDTH );
+        }
+
+    default:
+        break;
+    }
+
+    return ( x <= 0.5f ) ? 1.0f : 0.0f;
+}
+
+//-------------------------------------------------------------------------------------------
+//      1次元の縮小フィルタテーブルを構築します.
+//-------------------------------------------------------------------------------------------
+void BuildFilterTable( unsigned int srcSize, unsigned int dstSize, MIPMAP_FILTER filter, FilterTable& table )
+{
+    // 縮小率に合わせてカーネルを引き伸ばす.
+    const float scale   = float( srcSize ) / float( dstSize );
+    const float support = GetFilterWidth( filter ) * scale;
+
+    table.taps = static_cast<unsigned int>( ceilf( support * 2.0f ) ) + 1;
+    table.index .assign( size_t( dstSize ) * table.taps, 0 );
+    table.weight.assign( size_t( dstSize ) * table.taps, 0.0f );
+
+    for( unsigned int d=0; d<dstSize; ++d )
+    {
+        const float center = ( d + 0.5f ) * scale;
+        const int   left   = static_cast<int>( floorf( center - support ) );
+
+        int*   pIndex  = &table.index [ size_t( d ) * table.taps ];
+        float* pWeight = &table.weight[ size_t( d ) * table.taps ];
+        float  total   = 0.0f;
+
+        for( unsigned int t=0; t<table.taps; ++t )
+        {
+            const int s = left + int( t );
+            float w;
+
+            if ( filter == MIPMAP_FILTER_BOX )
+            {
+                // ボックスは出力ピクセルと入力ピクセルの重なり面積を重みとする.
+                const float lo = std::max( center - scale * 0.5f, float( s ) );
+                const float hi = std::min( center + scale * 0.5f, float( s + 1 ) );
+                w = std::max( hi - lo, 0.0f );
+            }
+            else
+            { w = EvaluateFilter( filter, ( s + 0.5f - center ) / scale ); }
+
+            // 画像端はクランプする.
+            pIndex [ t ] = std::min( std::max( s, 0 ), int( srcSize ) - 1 );
+            pWeight[ t ] = w;
+            total += w;
+        }
+
+        if ( total != 0.0f )
+        {
+            const float invTotal = 1.0f / total;
+            for( unsigned int t=0; t<table.taps; ++t )
+            { pWeight[ t ] *= invTotal; }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      横方向に縮小します. 1ピクセルは float4 です.
+//-------------------------------------------------------------------------------------------
+void FilterRowsHorizontal
+(
+    const float*        pSrc,
+    unsigned int        srcWidth,
+    float*              pDst,
+    unsigned int        dstWidth,
+    const FilterTable&  table,
+    unsigned int        begin,
+    unsigned int        end
+)
+{
+    for( unsigned int y=begin; y<end; ++y )
+    {
+        const float* pSrcRow = pSrc + size_t( y ) * srcWidth * 4;
+        float*       pDstRow = pDst + size_t( y ) * dstWidth * 4;
+
+        for( unsigned int x=0; x<dstWidth; ++x )
+        {
+            const int*   pIndex  = &table.index [ size_t( x ) * table.taps ];
+            const float* pWeight = &table.weight[ size_t( x ) * table.taps ];
+
+        #if MIP_ENABLE_SSE
+            __m128 sum = _mm_setzero_ps();
+            for( unsigned int t=0; t<table.taps; ++t )
+            {
+                const __m128 texel = _mm_loadu_ps( pSrcRow + pIndex[ t ] * 4 );
+                sum = _mm_add_ps( sum, _mm_mul_ps( texel, _mm_set1_ps( pWeight[ t ] ) ) );
+            }
+            _mm_storeu_ps( pDstRow + x * 4, sum );
+        #else
+            float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            for( unsigned int t=0; t<table.taps; ++t )
+            {
+                const float* pTexel = pSrcRow + pIndex[ t ] * 4;
+                for( int c=0; c<4; ++c )
+                { sum[ c ] += pTexel[ c ] * pWeight[ t ]; }
+            }
+            memcpy( pDstRow + x * 4, sum, sizeof(sum) );
+        #endif
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      縦方向に縮小します. 行全体をまとめて積和します.
+//-------------------------------------------------------------------------------------------
+void FilterRowsVertical
+(
+    const float*        pSrc,
+    float*              pDst,
+    unsigned int        width,
+    const FilterTable&  table,
+    unsigned int        begin,
+    unsigned int        end
+)
+{
+    const size_t rowFloats = size_t( width ) * 4;
+
+    for( unsigned int y=begin; y<end; ++y )
+    {
+        const int*   pIndex  = &table.index [ size_t( y ) * table.taps ];
+        const float* pWeight = &table.weight[ size_t( y ) * table.taps ];
+        float*       pDstRow = pDst + y * rowFloats;
+
+        memset( pDstRow, 0, rowFloats * sizeof(float) );
+
+        for( unsigned int t=0; t<table.taps; ++t )
+        {
+            if ( pWeight[ t ] == 0.0f )
+            { continue; }
+
+            const float* pSrcRow = pSrc + pIndex[ t ] * rowFloats;
+
+        #if MIP_ENABLE_SSE
+            // 1ピクセルが float4 なので行は常に4の倍数.
+            const __m128 w = _mm_set1_ps( pWeight[ t ] );
+            for( size_t i=0; i<rowFloats; i+=4 )
+            {
+                const __m128 acc = _mm_loadu_ps( pDstRow + i );
+                _mm_storeu_ps( pDstRow + i, _mm_add_ps( acc, _mm_mul_ps( _mm_loadu_ps( pSrcRow + i ), w ) ) );
+            }
+        #else
+            const float w = pWeight[ t ];
+            for( size_t i=0; i<rowFloats; ++i )
+            { pDstRow[ i ] += pSrcRow[ i ] * w; }
+        #endif
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      アルファ成分のインデックスを取得します. アルファがない場合は -1 を返します.
+//-------------------------------------------------------------------------------------------
+inline int GetAlphaChannel( unsigned int bytePerPixel )
+{
+    if ( bytePerPixel == 4 ) { return 3; }
+    if ( bytePerPixel == 2 ) { return 1; }
+    return -1;
+}
+
+//-------------------------------------------------------------------------------------------
+//      アルファテストの被覆率を計算します.
+//-------------------------------------------------------------------------------------------
+float ComputeCoverage( const float* pSrc, size_t pixelCount, int alphaChannel, float reference, float scale )
+{
+    size_t count = 0;
+    for( size_t i=0; i<pixelCount; ++i )
+    {
+        if ( pSrc[ i * 4 + alphaChannel ] * scale > reference )
+        { count++; }
+    }
+
+    return float( count ) / float( pixelCount );
+}
+
+//-------------------------------------------------------------------------------------------
+//      目標の被覆率となるアルファのスケールを二分探索で求めます.
+//-------------------------------------------------------------------------------------------
+float FindCoverageScale( const float* pSrc, size_t pixelCount, int alphaChannel, float reference, float targetCoverage )
+{
+    float lo = 0.0f;
+    float hi = 4.0f;
+
+    for( unsigned int i=0; i<COVERAGE_ITERATION; ++i )
+    {
+        const float mid = ( lo + hi ) * 0.5f;
+        if ( ComputeCoverage( pSrc, pixelCount, alphaChannel, reference, mid ) < targetCoverage )
+        { lo = mid; }
+        else
+        { hi = mid; }
+    }
+
+    // 被覆率は段階的にしか変化しないので，目標に近い方の端を採用する.
+    const float coverageLo = ComputeCoverage( pSrc, pixelCount, alphaChannel, reference, lo );
+    const float coverageHi = ComputeCoverage( pSrc, pixelCount, alphaChannel, reference, hi );
+
+    return ( fabsf( coverageLo - targetCoverage ) <= fabsf( coverageHi - targetCoverage ) ) ? lo : hi;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------
+//      1x1 までのミップレベル数を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int GetMipLevelCount( unsigned int width, unsigned int height )
+{
+    unsigned int size  = std::max( width, height );
+    unsigned int count = 1;
+
+    while( size > 1 )
+    {
+        size >>= 1;
+        count++;
+    }
+
+    return count;
+}
+
+//-------------------------------------------------------------------------------------------
+//      1x1 までのミップマップチェインを生成します.
+//-------------------------------------------------------------------------------------------
+bool GenerateMipMaps
+(
+    const unsigned char*    pSrc,
+    unsigned int            width,
+    unsigned int            height,
+    unsigned int            bytePerPixel,
+    const MipMapOption&     option,
+    std::vector<MipLevel>&  levels
+)
+{
+    levels.clear();
+
+    if ( pSrc == nullptr || width == 0 || height == 0 || bytePerPixel == 0 || bytePerPixel > 4 )
+    { return false; }
+
+    const unsigned int levelCount = GetMipLevelCount( width, height );
+    levels.resize( levelCount );
+
+    // レベル0は元画像のコピー.
+    levels[0].width  = width;
+    levels[0].height = height;
+    levels[0].pixels.assign( pSrc, pSrc + size_t( width ) * height * bytePerPixel );
+
+    // 再量子化による誤差の蓄積を避けるため，チェインは線形空間の float4 のまま縮小していく.
+    std::vector<float> current( size_t( width ) * height * 4 );
+    std::vector<float> temp;
+    std::vector<float> next;
+    const COLOR_SPACE colorSpace = ( option.isSRGB ) ? COLOR_SPACE_SRGB : COLOR_SPACE_LINEAR;
+    ConvertToLinearFloat4( pSrc, size_t( width ) * height, bytePerPixel, colorSpace, &current[0] );
+
+    const int  alphaChannel   = GetAlphaChannel( bytePerPixel );
+    const bool keepCoverage   = option.preserveAlphaCoverage && ( alphaChannel >= 0 );
+    const float targetCoverage = ( keepCoverage )
+        ? ComputeCoverage( &current[0], size_t( width ) * height, alphaChannel, option.alphaReference, 1.0f )
+        : 0.0f;
+
+    FilterTable tableX;
+    FilterTable tableY;
+
+    unsigned int srcW = width;
+    unsigned int srcH = height;
+
+    for( unsigned int level=1; level<levelCount; ++level )
+    {
+        const unsigned int dstW = ( srcW > 1 ) ? ( srcW >> 1 ) : 1;
+        const unsigned int dstH = ( srcH > 1 ) ? ( srcH >> 1 ) : 1;
+
+        BuildFilterTable( srcW, dstW, option.filter, tableX );
+        BuildFilterTable( srcH, dstH, option.filter, tableY );
+
+        temp.resize( size_t( dstW ) * srcH * 4 );
+        next.resize( size_t( dstW ) * dstH * 4 );
+
+        // 分離可能フィルタなので横 -> 縦の順に縮小する. それぞれ行単位で並列化する.
+        const float* pCurrent = &current[0];
+        float*       pTemp    = &temp[0];
+        float*       pNext    = &next[0];
+
+        ParallelRows( srcH, MIN_ROWS_PER_THREAD, option.threadCount, [&]( unsigned int begin, unsigned int end )
+        { FilterRowsHorizontal( pCurrent, srcW, pTemp, dstW, tableX, begin, end ); } );
+
+        ParallelRows( dstH, MIN_ROWS_PER_THREAD, option.threadCount, [&]( unsigned int begin, unsigned int end )
+        { FilterRowsVertical( pTemp, pNext, dstW, tableY, begin, end ); } );
+
+        const size_t pixelCount = size_t( dstW ) * dstH;
+
+        float alphaScale = 1.0f;
+        if ( keepCoverage )
+        { alphaScale = FindCoverageScale( pNext, pixelCount, alphaChannel, option.alphaReference, targetCoverage ); }
+
+        levels[ level ].width  = dstW;
+        levels[ level ].height = dstH;
+        levels[ level ].pixels.resize( pixelCount * bytePerPixel );
+        ConvertFromLinearFloat4( pNext, pixelCount, bytePerPixel, colorSpace, alphaScale, &levels[ level ].pixels[0] );
+
+        current.swap( next );
+        srcW = dstW;
+        srcH = dstH;
+    }
+
+    return true;
+}
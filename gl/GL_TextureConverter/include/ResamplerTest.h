@@ -0,0 +1,33 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : ResamplerTest.h
+// Desc : Resampler Self Test.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+#ifndef _RESAMPLER_TEST_H_
+#define _RESAMPLER_TEST_H_
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+/* NOTHING */
+
+
+//-------------------------------------------------------------------------------------------
+//! @brief      リサンプラーとミップマップ生成の自己診断を実行します.
+//!
+//! @note       ResampleImage() の結果を倍精度で計算した参照実装(クランプ付きの分離フィルタ)と
+//!             比較します. 全フィルタについてランダムなサイズの拡大・縮小を検証し，
+//!             同サイズの8bit sRGB変換が元の値に戻ること，単色画像が全ミップレベルで
+//!             単色のまま保たれること，ミップマップ生成とリサンプル，ブロック圧縮の展開の結果が
+//!             スレッド数によらないことも
+//!             確認します. 結果は標準出力に表示します.
+//! @param [in]     caseCount       フィルタごとに検証するランダムなケースの数です.
+//! @param [in]     seed            乱数のシード値です.
+//! @retval true    全ての検証に合格.
+//! @retval false   許容誤差を超えた検証がある.
+//-------------------------------------------------------------------------------------------
+bool RunResamplerTest( unsigned int caseCount, unsigned int seed );
+
+
+#endif//_RESAMPLER_TEST_H_
@@ -0,0 +1,406 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : TextureConverter.h
+// Desc : Batch Texture Conversion Pipeline.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+#ifndef _TEXTURE_CONVERTER_H_
+#define _TEXTURE_CONVERTER_H_
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <BcEncoder.h>
+#include <MipMapGenerator.h>
+#include <Resampler.h>
+#include <ColorSpace.h>
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// CONVERT_OUTPUT enum
+/////////////////////////////////////////////////////////////////////////////////////////////
+enum CONVERT_OUTPUT
+{
+    CONVERT_OUTPUT_DDS = 0,         //!< ブロック圧縮したDDSファイルを出力します.
+    CONVERT_OUTPUT_CACHE,           //!< 各ローダーが読み込む変換済みキャッシュを出力します.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// ConvertOption structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct ConvertOption
+{
+    CONVERT_OUTPUT  output;             //!< 出力形式です.
+    std::string     outputDirectory;    //!< 出力先ディレクトリです.
+    bool            autoFormat;         //!< アルファの有無で BC1 / BC3 を自動選択する場合は true.
+    BC_FORMAT       format;             //!< autoFormat が false の場合のブロック圧縮フォーマットです.
+    BC_QUALITY      quality;            //!< ブロック圧縮の品質です.
+    unsigned int    resizeWidth;        //!< リサイズ後の横幅です. 0の場合は指定しません.
+    unsigned int    resizeHeight;       //!< リサイズ後の縦幅です. 0の場合は指定しません.
+    unsigned int    maxSize;            //!< 長辺の上限です. 0の場合は制限しません.
+    bool            powerOfTwo;         //!< 縦横を最も近い2の累乗に丸める場合は true.
+    RESAMPLE_FILTER resizeFilter;       //!< リサイズに使用するフィルタです.
+    bool            generateMips;       //!< ミップマップを生成する場合は true. キャッシュ出力では常に生成します.
+    MipMapOption    mipOption;          //!< ミップマップ生成オプションです. threadCount は無視されます.
+    unsigned int    rawWidth;           //!< RAWファイルの横幅です.
+    unsigned int    rawHeight;          //!< RAWファイルの縦幅です.
+    bool            rawAlpha;           //!< RAWファイルがアルファを持つ場合は true.
+    unsigned int    threadCount;        //!< 同時に処理するファイル数です. 0の場合はハードウェアスレッド数を使用します.
+    size_t          memoryBudget;       //!< 同時に処理する画像の作業メモリの上限(バイト)です.
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------
+    ConvertOption()
+    : output            ( CONVERT_OUTPUT_DDS )
+    , outputDirectory   ( "." )
+    , autoFormat        ( true )
+    , format            ( BC_FORMAT_BC1 )
+    , quality           ( BC_QUALITY_FAST )
+    , resizeWidth       ( 0 )
+    , resizeHeight      ( 0 )
+    , maxSize           ( 0 )
+    , powerOfTwo        ( false )
+    , resizeFilter      ( RESAMPLE_FILTER_LANCZOS3 )
+    , generateMips      ( true )
+    , mipOption         ()
+    , rawWidth          ( 0 )
+    , rawHeight         ( 0 )
+    , rawAlpha          ( false )
+    , threadCount       ( 0 )
+    , memoryBudget      ( size_t( 512 ) * 1024 * 1024 )
+    { /* DO_NOTHING */ }
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// ConvertResult structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct ConvertResult
+{
+    std::string         source;         //!< 入力ファイル名です.
+    std::string         output;         //!< 出力ファイル名です.
+    std::string         message;        //!< 失敗した場合のエラーメッセージです.
+    bool                succeeded;      //!< 変換に成功した場合は true.
+    bool                skipped;        //!< 変換済みキャッシュが存在したため省略した場合は true.
+    unsigned int        width;          //!< 出力画像の横幅です.
+    unsigned int        height;         //!< 出力画像の縦幅です.
+    unsigned int        mipCount;       //!< 出力したミップレベル数です.
+    unsigned long long  inputBytes;     //!< 入力ファイルのバイト数です.
+    unsigned long long  outputBytes;    //!< 出力したピクセルデータのバイト数です.
+    double              seconds;        //!< 変換にかかった時間(秒)です.
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------
+    ConvertResult()
+    : source        ()
+    , output        ()
+    , message       ()
+    , succeeded     ( false )
+    , skipped       ( false )
+    , width         ( 0 )
+    , height        ( 0 )
+    , mipCount      ( 0 )
+    , inputBytes    ( 0 )
+    , outputBytes   ( 0 )
+    , seconds       ( 0.0 )
+    { /* DO_NOTHING */ }
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// ConvertStats structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct ConvertStats
+{
+    unsigned int        succeeded;      //!< 変換に成功したファイル数です.
+    unsigned int        skipped;        //!< 省略したファイル数です.
+    unsigned int        failed;         //!< 変換に失敗したファイル数です.
+    unsigned long long  inputBytes;     //!< 処理した入力ファイルの合計バイト数です.
+    unsigned long long  outputBytes;    //!< 出力したピクセルデータの合計バイト数です.
+    size_t              peakMemory;     //!< 同時に確保した作業メモリ見積もりの最大値です.
+    double              seconds;        //!< バッチ全体の経過時間(秒)です.
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------
+    ConvertStats()
+    : succeeded     ( 0 )
+    , skipped       ( 0 )
+    , failed        ( 0 )
+    , inputBytes    ( 0 )
+    , outputBytes   ( 0 )
+    , peakMemory    ( 0 )
+    , seconds       ( 0.0 )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      入力のスループット(MB/s)を取得します.
+    //---------------------------------------------------------------------------------------
+    double GetMegaBytesPerSecond() const
+    { return ( seconds > 0.0 ) ? ( inputBytes / ( 1024.0 * 1024.0 ) ) / seconds : 0.0; }
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      1秒あたりに処理した画像数を取得します.
+    //---------------------------------------------------------------------------------------
+    double GetImagesPerSecond() const
+    { return ( seconds > 0.0 ) ? ( succeeded + skipped ) / seconds : 0.0; }
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// BenchmarkResult structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct BenchmarkResult
+{
+    std::string         source;         //!< 入力ファイル名です.
+    std::string         message;        //!< 失敗した場合のエラーメッセージです.
+    bool                succeeded;      //!< 復号に成功した場合は true.
+    bool                compared;       //!< 基準画像と比較した場合は true.
+    unsigned int        width;          //!< 画像の横幅です.
+    unsigned int        height;         //!< 画像の縦幅です.
+    unsigned int        bytePerPixel;   //!< 1ピクセルあたりのバイト数です.
+    unsigned int        count;          //!< 復号した回数です.
+    unsigned long long  inputBytes;     //!< 入力ファイルのバイト数です.
+    double              minSeconds;     //!< 1回の復号にかかった時間の最小値(秒)です.
+    double              totalSeconds;   //!< 全ての復号にかかった時間(秒)です.
+    double              maxError;       //!< 基準画像とのRGB成分の差の最大値です.
+    double              meanError;      //!< 基準画像とのRGB成分の差の平均値です.
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------
+    BenchmarkResult()
+    : source        ()
+    , message       ()
+    , succeeded     ( false )
+    , compared      ( false )
+    , width         ( 0 )
+    , height        ( 0 )
+    , bytePerPixel  ( 0 )
+    , count         ( 0 )
+    , inputBytes    ( 0 )
+    , minSeconds    ( 0.0 )
+    , totalSeconds  ( 0.0 )
+    , maxError      ( 0.0 )
+    , meanError     ( 0.0 )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      1回の復号にかかった時間の平均値(秒)を取得します.
+    //---------------------------------------------------------------------------------------
+    double GetAverageSeconds() const
+    { return ( count > 0 ) ? totalSeconds / count : 0.0; }
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      最速の復号での1秒あたりの出力画素数(百万画素/秒)を取得します.
+    //---------------------------------------------------------------------------------------
+    double GetMegaPixelsPerSecond() const
+    { return ( minSeconds > 0.0 ) ? ( double( width ) * height * 1e-6 ) / minSeconds : 0.0; }
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// TextureConverter class
+/////////////////////////////////////////////////////////////////////////////////////////////
+class TextureConverter
+{
+    //=======================================================================================
+    // list of friend classes and methods.
+    //=======================================================================================
+    /* NOTHING */
+
+public:
+    //=======================================================================================
+    // public variables.
+    //=======================================================================================
+    typedef void (*ProgressCallback)( const ConvertResult& result, void* pUser );
+
+    //=======================================================================================
+    // public methods.
+    //=======================================================================================
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------
+    TextureConverter();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------
+    virtual ~TextureConverter();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      変換オプションを設定します.
+    //!
+    //! @note       TextureCache の保存先ディレクトリも出力先ディレクトリに変更します.
+    //!             DDS出力時も既定のキャッシュを読み込まず，常に元画像から変換するためです.
+    //---------------------------------------------------------------------------------------
+    void SetOption( const ConvertOption& option );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      変換オプションを取得します.
+    //---------------------------------------------------------------------------------------
+    const ConvertOption& GetOption() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      進捗通知用のコールバックを設定します.
+    //!
+    //! @note       1ファイルの変換が終わるたびにワーカースレッドから呼び出されます.
+    //!             呼び出しは排他されます.
+    //---------------------------------------------------------------------------------------
+    void SetProgressCallback( ProgressCallback callback, void* pUser );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      変換するファイルを追加します.
+    //!
+    //! @param [in]     filename    ファイル名です.
+    //! @retval true    追加に成功.
+    //! @retval false   対応していない拡張子.
+    //---------------------------------------------------------------------------------------
+    bool AddFile( const char* filename );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      ディレクトリ内の対応する画像ファイルをすべて追加します.
+    //!
+    //! @note       対応する拡張子は bmp, tga, raw, dds, png, jpg, jpeg です(大文字小文字は区別しません).
+    //! @param [in]     path        ディレクトリパスです.
+    //! @param [in]     recursive   サブディレクトリも検索する場合は true.
+    //! @return     追加したファイル数を返却します.
+    //---------------------------------------------------------------------------------------
+    unsigned int AddDirectory( const char* path, bool recursive = false );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      追加したファイルを並列に変換します.
+    //!
+    //! @note       ワーカーは共有キューからファイルを1つずつ取り出し，復号後に作業メモリの
+    //!             見積もりを予約します. 予約の合計が memoryBudget を超える場合は，他の
+    //!             ワーカーが解放するまで待機します(何も処理中でなければ必ず通します).
+    //! @param [out]    stats       集計結果の格納先です.
+    //! @retval true    すべてのファイルの変換に成功.
+    //! @retval false   1つ以上のファイルの変換に失敗.
+    //---------------------------------------------------------------------------------------
+    bool Run( ConvertStats& stats );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      1ファイルを変換します.
+    //!
+    //! @note       呼び出しスレッドで処理し，各段の処理は option.threadCount で並列化します.
+    //! @param [in]     source      入力ファイル名です.
+    //! @param [in]     output      出力ファイル名です. キャッシュ出力の場合は無視されます.
+    //! @param [out]    result      変換結果の格納先です.
+    //! @retval true    変換に成功.
+    //! @retval false   変換に失敗.
+    //---------------------------------------------------------------------------------------
+    bool ConvertFile( const char* source, const char* output, ConvertResult& result );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      追加したファイルの復号時間を計測します.
+    //!
+    //! @note       各ファイルを呼び出しスレッドで count 回復号し，リサイズやミップ生成は行いません.
+    //!             最初に復号できた画像を基準とし，同じサイズの画像は上下の向きを揃えて
+    //!             RGB成分の差を求めます. 同じ内容を別の形式で保存したファイルを並べると，
+    //!             形式ごとの復号速度と非可逆圧縮の誤差を比較できます.
+    //!             出力先ディレクトリに変換済みキャッシュがあるファイルは復号できません.
+    //! @param [in]     count       1ファイルあたりの復号回数です.
+    //! @param [out]    results     計測結果の格納先です. 順序は追加順です.
+    //! @retval true    すべてのファイルの復号に成功.
+    //! @retval false   1つ以上のファイルの復号に失敗.
+    //---------------------------------------------------------------------------------------
+    bool Benchmark( unsigned int count, std::vector<BenchmarkResult>& results ) const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      追加したファイルと変換結果をクリアします.
+    //---------------------------------------------------------------------------------------
+    void Clear();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      追加したファイル数を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetFileCount() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      直前の Run() の変換結果を取得します. 順序は追加順です.
+    //---------------------------------------------------------------------------------------
+    const std::vector<ConvertResult>& GetResults() const;
+
+protected:
+    /////////////////////////////////////////////////////////////////////////////////////////
+    // Image structure
+    /////////////////////////////////////////////////////////////////////////////////////////
+    struct Image
+    {
+        unsigned int                width;          //!< 横幅です.
+        unsigned int                height;         //!< 縦幅です.
+        unsigned int                bytePerPixel;   //!< 1ピクセルあたりのバイト数(3 または 4)です.
+        bool                        bottomUp;       //!< 行が下から上に並んでいる場合は true.
+        COLOR_SPACE                 colorSpace;     //!< カラー成分の色空間です.
+        std::vector<unsigned char>  pixels;         //!< 行パディングなしのピクセルデータです.
+    };
+
+    /////////////////////////////////////////////////////////////////////////////////////////
+    // MemoryBudget class
+    /////////////////////////////////////////////////////////////////////////////////////////
+    class MemoryBudget
+    {
+    public:
+        MemoryBudget();
+        void    Reset  ( size_t limit );
+        void    Acquire( size_t size );
+        void    Release( size_t size );
+        size_t  GetPeak() const;
+
+    private:
+        std::mutex              m_Mutex;        //!< 排他制御用です.
+        std::condition_variable m_Condition;    //!< 解放待ち用です.
+        size_t                  m_Limit;        //!< 上限です.
+        size_t                  m_Used;         //!< 予約済みのサイズです.
+        size_t                  m_Peak;         //!< 予約済みサイズの最大値です.
+    };
+
+    //=======================================================================================
+    // protected variables.
+    //=======================================================================================
+    ConvertOption               m_Option;       //!< 変換オプションです.
+    std::vector<std::string>    m_Files;        //!< 変換するファイルです.
+    std::vector<ConvertResult>  m_Results;      //!< 変換結果です.
+    ProgressCallback            m_Callback;     //!< 進捗通知用のコールバックです.
+    void*                       m_pUser;        //!< コールバックに渡すユーザーデータです.
+    MemoryBudget                m_Budget;       //!< 作業メモリの予約です.
+    std::mutex                  m_Mutex;        //!< キューと結果の排他制御用です.
+    size_t                      m_Next;         //!< 次に処理するファイルの番号です.
+
+    //=======================================================================================
+    // protected methods.
+    //=======================================================================================
+    void Worker   ();
+    bool Convert  ( const std::string& source, const std::string& output, unsigned int threadCount, bool useBudget, ConvertResult& result );
+    bool Decode   ( const std::string& source, Image& image, std::string& message ) const;
+    bool Resize   ( Image& image, unsigned int threadCount ) const;
+    bool WriteDDS ( const std::string& output, const Image& image, const std::vector<MipLevel>& levels, unsigned int threadCount, ConvertResult& result ) const;
+    bool WriteCache( const std::string& source, const Image& image, const std::vector<MipLevel>& levels, ConvertResult& result ) const;
+    void GetTargetSize( unsigned int width, unsigned int height, unsigned int& targetWidth, unsigned int& targetHeight ) const;
+    unsigned long long GetCacheSalt( const std::string& source ) const;
+    void MakeOutputNames();
+
+private:
+    //=======================================================================================
+    // private variables.
+    //=======================================================================================
+    /* NOTHING */
+
+    //=======================================================================================
+    // private methods.
+    //=======================================================================================
+    TextureConverter( const TextureConverter& value );  // アクセス禁止.
+    void operator = ( const TextureConverter& value );  // アクセス禁止.
+};
+
+
+#endif//_TEXTURE_CONVERTER_H_
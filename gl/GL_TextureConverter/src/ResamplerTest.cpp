@@ -0,0 +1,380 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : ResamplerTest.cpp
+// Desc : Resampler Self Test.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <ResamplerTest.h>
+#include <Resampler.h>
+#include <MipMapGenerator.h>
+#include <BcDecoder.h>
+#include <cmath>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+static const double         PI              = 3.14159265358979323846;
+static const double         FLOAT_TOLERANCE = 1e-4;     // float出力と参照値の許容誤差.
+static const unsigned int   MAX_TEST_SIZE   = 60;       // ランダムなケースの最大サイズ.
+static const unsigned int   MAX_TEST_THREAD = 64;       // スレッド数による差を調べる場合のスレッド数.
+static const char*          FILTER_NAME[]   = { "box", "bilinear", "bicubic", "lanczos" };
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// ReferenceTap structure
+////////////////////////////////////////////////////////////////////////////////////////////
+struct ReferenceTap
+{
+    unsigned int    index;      // 入力の位置.
+    double          weight;     // 正規化済みの重み.
+};
+
+typedef std::vector< std::vector<ReferenceTap> > ReferenceTable;
+
+
+//-------------------------------------------------------------------------------------------
+//      参照用のフィルタカーネルを評価します.
+//-------------------------------------------------------------------------------------------
+double EvaluateReference( RESAMPLE_FILTER filter, double x )
+{
+    x = fabs( x );
+
+    switch( filter )
+    {
+    case RESAMPLE_FILTER_BILINEAR:
+        return ( x < 1.0 ) ? 1.0 - x : 0.0;
+
+    case RESAMPLE_FILTER_BICUBIC:
+        if ( x < 1.0 ) { return (  1.5 * x - 2.5 ) * x * x + 1.0; }
+        if ( x < 2.0 ) { return ( ( -0.5 * x + 2.5 ) * x - 4.0 ) * x + 2.0; }
+        return 0.0;
+
+    case RESAMPLE_FILTER_LANCZOS3:
+        if ( x < 1e-9 ) { return 1.0; }
+        if ( x < 3.0 )  { return 3.0 * sin( PI * x ) * sin( PI * x / 3.0 ) / ( PI * PI * x * x ); }
+        return 0.0;
+
+    default:
+        break;
+    }
+
+    return 0.0;
+}
+
+//-------------------------------------------------------------------------------------------
+//      参照用の1次元フィルタテーブルを構築します.
+//-------------------------------------------------------------------------------------------
+void BuildReferenceTable( unsigned int srcSize, unsigned int dstSize, RESAMPLE_FILTER filter, ReferenceTable& table )
+{
+    // 縮小時はカーネルを縮小率に合わせて引き伸ばし，画像外は端のピクセルを参照する.
+    const double scale       = double( srcSize ) / double( dstSize );
+    const double filterScale = std::max( scale, 1.0 );
+    const double radius      = ( filter == RESAMPLE_FILTER_BILINEAR ) ? 1.0
+                             : ( filter == RESAMPLE_FILTER_BICUBIC )  ? 2.0
+                             : ( filter == RESAMPLE_FILTER_LANCZOS3 ) ? 3.0 : 0.5;
+
+    table.assign( dstSize, std::vector<ReferenceTap>() );
+
+    std::vector<double> weight( srcSize );
+    for( unsigned int d=0; d<dstSize; ++d )
+    {
+        const double center = ( d + 0.5 ) * scale;
+        const int    left   = static_cast<int>( floor( center - radius * filterScale ) ) - 1;
+        const int    right  = static_cast<int>( ceil ( center + radius * filterScale ) ) + 1;
+
+        std::fill( weight.begin(), weight.end(), 0.0 );
+        double total = 0.0;
+
+        for( int s=left; s<=right; ++s )
+        {
+            double w;
+            if ( filter == RESAMPLE_FILTER_BOX )
+            {
+                // ボックスは幅 filterScale の窓と入力ピクセルの重なり面積.
+                const double lo = std::max( center - filterScale * 0.5, double( s ) );
+                const double hi = std::min( center + filterScale * 0.5, double( s + 1 ) );
+                w = std::max( hi - lo, 0.0 );
+            }
+            else
+            { w = EvaluateReference( filter, ( s + 0.5 - center ) / filterScale ); }
+
+            const int i = std::min( std::max( s, 0 ), int( srcSize ) - 1 );
+            weight[ i ] += w;
+            total += w;
+        }
+
+        for( unsigned int s=0; s<srcSize; ++s )
+        {
+            if ( weight[ s ] == 0.0 )
+            { continue; }
+
+            ReferenceTap tap;
+            tap.index  = s;
+            tap.weight = weight[ s ] / total;
+            table[ d ].push_back( tap );
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      RGBA32F の画像を参照実装でリサンプルした場合との最大誤差を求めます.
+//-------------------------------------------------------------------------------------------
+double MeasureFloatError(
+    const std::vector<float>&   src,
+    unsigned int                srcWidth,
+    unsigned int                srcHeight,
+    const std::vector<float>&   dst,
+    unsigned int                dstWidth,
+    unsigned int                dstHeight,
+    RESAMPLE_FILTER             filter )
+{
+    ReferenceTable tableX;
+    ReferenceTable tableY;
+    BuildReferenceTable( srcWidth,  dstWidth,  filter, tableX );
+    BuildReferenceTable( srcHeight, dstHeight, filter, tableY );
+
+    double maxError = 0.0;
+    for( unsigned int y=0; y<dstHeight; ++y )
+    {
+        for( unsigned int x=0; x<dstWidth; ++x )
+        {
+            for( unsigned int c=0; c<4; ++c )
+            {
+                double value = 0.0;
+                for( size_t j=0; j<tableY[ y ].size(); ++j )
+                {
+                    const ReferenceTap& ty = tableY[ y ][ j ];
+                    for( size_t i=0; i<tableX[ x ].size(); ++i )
+                    {
+                        const ReferenceTap& tx = tableX[ x ][ i ];
+                        value += ty.weight * tx.weight * src[ ( size_t( ty.index ) * srcWidth + tx.index ) * 4 + c ];
+                    }
+                }
+
+                const double error = fabs( value - dst[ ( size_t( y ) * dstWidth + x ) * 4 + c ] );
+                maxError = std::max( maxError, error );
+            }
+        }
+    }
+
+    return maxError;
+}
+
+//-------------------------------------------------------------------------------------------
+//      検証結果を表示します.
+//-------------------------------------------------------------------------------------------
+bool Report( const char* name, bool passed )
+{
+    std::cout << ( passed ? "[pass] " : "[FAIL] " ) << name << std::endl;
+    return passed;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------
+//      リサンプラーとミップマップ生成の自己診断を実行します.
+//-------------------------------------------------------------------------------------------
+bool RunResamplerTest( unsigned int caseCount, unsigned int seed )
+{
+    std::mt19937 random( seed );
+    bool passed = true;
+
+    // 全フィルタについてランダムなサイズの拡大・縮小を参照実装と比較する.
+    for( unsigned int f=0; f<4; ++f )
+    {
+        const RESAMPLE_FILTER filter = static_cast<RESAMPLE_FILTER>( f );
+        double maxError = 0.0;
+        unsigned int failed = 0;
+
+        for( unsigned int t=0; t<caseCount; ++t )
+        {
+            const unsigned int srcWidth  = 1 + random() % MAX_TEST_SIZE;
+            const unsigned int srcHeight = 1 + random() % MAX_TEST_SIZE;
+            const unsigned int dstWidth  = 1 + random() % MAX_TEST_SIZE;
+            const unsigned int dstHeight = 1 + random() % MAX_TEST_SIZE;
+
+            std::vector<float> src( size_t( srcWidth ) * srcHeight * 4 );
+            std::vector<float> dst( size_t( dstWidth ) * dstHeight * 4 );
+            for( size_t i=0; i<src.size(); ++i )
+            { src[ i ] = float( random() % 1000 ) / 1000.0f; }
+
+            ResampleOption option;
+            option.filter      = filter;
+            option.isSRGB      = false;
+            option.threadCount = 1 + random() % 4;
+
+            if ( !ResampleImage( &src[0], srcWidth, srcHeight, RESAMPLE_FORMAT_RGBA32F, &dst[0], dstWidth, dstHeight, option ) )
+            {
+                failed++;
+                continue;
+            }
+
+            maxError = std::max( maxError, MeasureFloatError( src, srcWidth, srcHeight, dst, dstWidth, dstHeight, filter ) );
+        }
+
+        const bool ok = ( failed == 0 && maxError <= FLOAT_TOLERANCE );
+        std::cout << ( ok ? "[pass] " : "[FAIL] " )
+                  << "resample " << std::setw( 8 ) << std::left << FILTER_NAME[ f ] << std::right
+                  << " : max error " << std::scientific << std::setprecision( 2 ) << maxError
+                  << std::fixed << " (" << caseCount << " cases)" << std::endl;
+
+        passed &= ok;
+    }
+
+    // 同じサイズへの8bit sRGBの変換は線形空間を経由しても元の値に戻る.
+    {
+        const unsigned int width  = 33;
+        const unsigned int height = 17;
+        std::vector<unsigned char> src( width * height * 3 );
+        std::vector<unsigned char> dst( width * height * 3 );
+        for( size_t i=0; i<src.size(); ++i )
+        { src[ i ] = static_cast<unsigned char>( random() ); }
+
+        unsigned int mismatch = 0;
+        for( unsigned int f=0; f<4; ++f )
+        {
+            ResampleOption option;
+            option.filter = static_cast<RESAMPLE_FILTER>( f );
+            if ( !ResampleImage( &src[0], width, height, RESAMPLE_FORMAT_RGB8, &dst[0], width, height, option ) )
+            {
+                mismatch++;
+                continue;
+            }
+
+            for( size_t i=0; i<src.size(); ++i )
+            { mismatch += ( src[ i ] != dst[ i ] ) ? 1 : 0; }
+        }
+
+        passed &= Report( "resample identity sRGB8", mismatch == 0 );
+    }
+
+    // ミップチェーンのサイズと，単色画像が全レベルで単色のまま保たれることを確認する.
+    {
+        const unsigned int width  = 64;
+        const unsigned int height = 48;
+        std::vector<unsigned char> src( width * height * 4, 77 );
+
+        bool chainValid = true;
+        unsigned int mismatch = 0;
+        for( unsigned int f=0; f<3; ++f )
+        {
+            MipMapOption option;
+            option.filter = static_cast<MIPMAP_FILTER>( f );
+
+            std::vector<MipLevel> levels;
+            if ( !GenerateMipMaps( &src[0], width, height, 4, option, levels ) || levels.size() != 7 )
+            {
+                chainValid = false;
+                continue;
+            }
+
+            for( size_t i=0; i<levels.size(); ++i )
+            {
+                const unsigned int w = std::max( width  >> i, 1u );
+                const unsigned int h = std::max( height >> i, 1u );
+                chainValid &= ( levels[ i ].width == w && levels[ i ].height == h );
+                chainValid &= ( levels[ i ].pixels.size() == size_t( w ) * h * 4 );
+
+                for( size_t j=0; j<levels[ i ].pixels.size(); ++j )
+                { mismatch += ( levels[ i ].pixels[ j ] != 77 ) ? 1 : 0; }
+            }
+        }
+
+        passed &= Report( "mipmap chain size", chainValid );
+        passed &= Report( "mipmap constant color", mismatch == 0 );
+    }
+
+    // 行数がスレッド数で割り切れない高さでも，分割の仕方によらず同じ結果になることを確認する.
+    {
+        const unsigned int width     = 8;
+        const unsigned int heights[] = { 1, 63, 1601, 2179, 4101 };
+
+        unsigned int mismatch = 0;
+        for( size_t i=0; i<sizeof( heights ) / sizeof( heights[0] ); ++i )
+        {
+            const unsigned int height = heights[ i ];
+            std::vector<unsigned char> src( size_t( width ) * height * 4 );
+            for( size_t j=0; j<src.size(); ++j )
+            { src[ j ] = static_cast<unsigned char>( random() ); }
+
+            for( unsigned int f=0; f<3; ++f )
+            {
+                MipMapOption option;
+                option.filter = static_cast<MIPMAP_FILTER>( f );
+
+                std::vector<MipLevel> single;
+                std::vector<MipLevel> multi;
+                option.threadCount = 1;
+                const bool singleOk = GenerateMipMaps( &src[0], width, height, 4, option, single );
+                option.threadCount = MAX_TEST_THREAD;
+                const bool multiOk  = GenerateMipMaps( &src[0], width, height, 4, option, multi );
+
+                bool same = ( singleOk && multiOk && single.size() == multi.size() );
+                for( size_t j=0; same && j<single.size(); ++j )
+                { same = ( single[ j ].pixels == multi[ j ].pixels ); }
+
+                mismatch += same ? 0 : 1;
+            }
+
+            for( unsigned int f=0; f<4; ++f )
+            {
+                const unsigned int dstHeight = height / 2 + 1;
+                std::vector<unsigned char> single( size_t( width ) * dstHeight * 4 );
+                std::vector<unsigned char> multi ( size_t( width ) * dstHeight * 4 );
+
+                ResampleOption option;
+                option.filter      = static_cast<RESAMPLE_FILTER>( f );
+                option.threadCount = 1;
+                const bool singleOk = ResampleImage( &src[0], width, height, RESAMPLE_FORMAT_RGBA8, &single[0], width, dstHeight, option );
+                option.threadCount = MAX_TEST_THREAD;
+                const bool multiOk  = ResampleImage( &src[0], width, height, RESAMPLE_FORMAT_RGBA8, &multi[0], width, dstHeight, option );
+
+                mismatch += ( singleOk && multiOk && single == multi ) ? 0 : 1;
+            }
+        }
+
+        passed &= Report( "mipmap/resample 1 vs 64 threads", mismatch == 0 );
+    }
+
+    // ブロック行がスレッド数で割り切れない高さでも，分割の仕方によらず同じ結果になることを確認する.
+    {
+        const unsigned int width     = 20;
+        const unsigned int heights[] = { 1, 63, 1219, 2179, 4101 };
+
+        unsigned int mismatch = 0;
+        for( unsigned int f=BC_FORMAT_BC1; f<=BC_FORMAT_BC5S; ++f )
+        {
+            const BC_FORMAT format = static_cast<BC_FORMAT>( f );
+
+            for( size_t i=0; i<sizeof( heights ) / sizeof( heights[0] ); ++i )
+            {
+                const unsigned int height = heights[ i ];
+                std::vector<unsigned char> src( size_t( ( width + 3 ) / 4 ) * ( ( height + 3 ) / 4 ) * GetBCBlockSize( format ) );
+                std::vector<unsigned char> single( size_t( width ) * height * 4 );
+                std::vector<unsigned char> multi ( size_t( width ) * height * 4 );
+                for( size_t j=0; j<src.size(); ++j )
+                { src[ j ] = static_cast<unsigned char>( random() ); }
+
+                DecodeBC( format, &src[0], width, height, &single[0], 1 );
+                DecodeBC( format, &src[0], width, height, &multi[0], MAX_TEST_THREAD );
+                mismatch += ( single != multi ) ? 1 : 0;
+            }
+        }
+
+        passed &= Report( "bc decode 1 vs 64 threads", mismatch == 0 );
+    }
+
+    return passed;
+}
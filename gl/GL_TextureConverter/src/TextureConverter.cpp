@@ -0,0 +1,1098 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : TextureConverter.cpp
+// Desc : Batch Texture Conversion Pipeline.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <TextureConverter.h>
+#include <BmpLoader.h>
+#include <TgaLoader.h>
+#include <RawLoader.h>
+#include <PngLoader.h>
+#include <JpegLoader.h>
+#include <DdsLoader.h>
+#include <DdsWriter.h>
+#include <TextureCache.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <set>
+#include <thread>
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif//WIN32_LEAN_AND_MEAN
+    #ifndef NOMINMAX
+    #define NOMINMAX
+    #endif//NOMINMAX
+    #include <Windows.h>
+    #include <direct.h>
+    #include <sys/stat.h>
+#else
+    #include <dirent.h>
+    #include <sys/stat.h>
+#endif
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+static const unsigned int   FORMAT_RGB          = 0x1907;   // GL_RGB.
+static const unsigned int   FORMAT_RGBA         = 0x1908;   // GL_RGBA.
+static const unsigned int   FORMAT_SRGB8        = 0x8C41;   // GL_SRGB8.
+static const unsigned int   FORMAT_SRGB8_ALPHA8 = 0x8C43;   // GL_SRGB8_ALPHA8.
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// SOURCE_TYPE enum
+/////////////////////////////////////////////////////////////////////////////////////////////
+enum SOURCE_TYPE
+{
+    SOURCE_TYPE_UNKNOWN = 0,
+    SOURCE_TYPE_BMP,
+    SOURCE_TYPE_TGA,
+    SOURCE_TYPE_RAW,
+    SOURCE_TYPE_PNG,
+    SOURCE_TYPE_JPEG,
+    SOURCE_TYPE_DDS,
+};
+
+//-------------------------------------------------------------------------------------------
+//      拡張子を小文字で取得します.
+//-------------------------------------------------------------------------------------------
+std::string GetExtension( const std::string& filename )
+{
+    const size_t dot   = filename.find_last_of( '.' );
+    const size_t slash = filename.find_last_of( "/\\" );
+    if ( dot == std::string::npos || ( slash != std::string::npos && dot < slash ) )
+    { return std::string(); }
+
+    std::string ext = filename.substr( dot + 1 );
+    for( size_t i=0; i<ext.size(); ++i )
+    {
+        if ( 'A' <= ext[i] && ext[i] <= 'Z' )
+        { ext[i] = static_cast<char>( ext[i] - 'A' + 'a' ); }
+    }
+    return ext;
+}
+
+//-------------------------------------------------------------------------------------------
+//      ディレクトリと拡張子を除いたファイル名を取得します.
+//-------------------------------------------------------------------------------------------
+std::string GetStem( const std::string& filename )
+{
+    const size_t slash = filename.find_last_of( "/\\" );
+    const std::string name = ( slash == std::string::npos ) ? filename : filename.substr( slash + 1 );
+
+    const size_t dot = name.find_last_of( '.' );
+    return ( dot == std::string::npos ) ? name : name.substr( 0, dot );
+}
+
+//-------------------------------------------------------------------------------------------
+//      拡張子から入力の種類を判定します.
+//-------------------------------------------------------------------------------------------
+SOURCE_TYPE GetSourceType( const std::string& filename )
+{
+    const std::string ext = GetExtension( filename );
+    if ( ext == "bmp" )                  { return SOURCE_TYPE_BMP; }
+    if ( ext == "tga" )                  { return SOURCE_TYPE_TGA; }
+    if ( ext == "raw" )                  { return SOURCE_TYPE_RAW; }
+    if ( ext == "png" )                  { return SOURCE_TYPE_PNG; }
+    if ( ext == "jpg" || ext == "jpeg" ) { return SOURCE_TYPE_JPEG; }
+    if ( ext == "dds" )                  { return SOURCE_TYPE_DDS; }
+    return SOURCE_TYPE_UNKNOWN;
+}
+
+//-------------------------------------------------------------------------------------------
+//      ファイルサイズを取得します.
+//-------------------------------------------------------------------------------------------
+unsigned long long GetFileBytes( const std::string& filename )
+{
+#if defined(_WIN32)
+    struct _stat64 info;
+    if ( _stat64( filename.c_str(), &info ) != 0 )
+    { return 0; }
+#else
+    struct stat info;
+    if ( stat( filename.c_str(), &info ) != 0 )
+    { return 0; }
+#endif
+    return static_cast<unsigned long long>( info.st_size );
+}
+
+//-------------------------------------------------------------------------------------------
+//      ディレクトリを作成します. 既に存在する場合は何もしません.
+//-------------------------------------------------------------------------------------------
+void MakeDirectory( const std::string& path )
+{
+#if defined(_WIN32)
+    _mkdir( path.c_str() );
+#else
+    mkdir( path.c_str(), 0755 );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------
+//      ディレクトリ内のファイルとサブディレクトリを列挙します.
+//-------------------------------------------------------------------------------------------
+void ListDirectory( const std::string& path, std::vector<std::string>& files, std::vector<std::string>& directories )
+{
+#if defined(_WIN32)
+    WIN32_FIND_DATAA data;
+    HANDLE hFind = FindFirstFileA( ( path + "\\*" ).c_str(), &data );
+    if ( hFind == INVALID_HANDLE_VALUE )
+    { return; }
+
+    do
+    {
+        const std::string name = data.cFileName;
+        if ( name == "." || name == ".." )
+        { continue; }
+
+        if ( data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY )
+        { directories.push_back( path + "/" + name ); }
+        else
+        { files.push_back( path + "/" + name ); }
+    }
+    while( FindNextFileA( hFind, &data ) );
+
+    FindClose( hFind );
+#else
+    DIR* pDir = opendir( path.c_str() );
+    if ( pDir == nullptr )
+    { return; }
+
+    struct dirent* pEntry = nullptr;
+    while( ( pEntry = readdir( pDir ) ) != nullptr )
+    {
+        const std::string name = pEntry->d_name;
+        if ( name == "." || name == ".." )
+        { continue; }
+
+        const std::string fullPath = path + "/" + name;
+        struct stat info;
+        if ( stat( fullPath.c_str(), &info ) != 0 )
+        { continue; }
+
+        if ( S_ISDIR( info.st_mode ) )
+        { directories.push_back( fullPath ); }
+        else
+        { files.push_back( fullPath ); }
+    }
+
+    closedir( pDir );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------
+//      最も近い2の累乗に丸めます.
+//-------------------------------------------------------------------------------------------
+unsigned int RoundToPowerOfTwo( unsigned int value )
+{
+    unsigned int lower = 1;
+    while( lower <= value / 2 )
+    { lower *= 2; }
+
+    // 上側の2の累乗の方が近ければそちらを選ぶ.
+    return ( value - lower > lower * 2 - value ) ? lower * 2 : lower;
+}
+
+//-------------------------------------------------------------------------------------------
+//      行の並びを上下反転します.
+//-------------------------------------------------------------------------------------------
+void FlipRows( unsigned char* pPixels, unsigned int width, unsigned int height, unsigned int bytePerPixel )
+{
+    const size_t pitch = size_t( width ) * bytePerPixel;
+    std::vector<unsigned char> temp( pitch );
+    for( unsigned int y=0; y<height / 2; ++y )
+    {
+        unsigned char* pTop    = pPixels + pitch * y;
+        unsigned char* pBottom = pPixels + pitch * ( height - 1 - y );
+        memcpy( &temp[0], pTop,    pitch );
+        memcpy( pTop,     pBottom, pitch );
+        memcpy( pBottom,  &temp[0], pitch );
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      アルファがすべて255かどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsOpaque( const std::vector<unsigned char>& pixels, unsigned int bytePerPixel )
+{
+    if ( bytePerPixel != 4 )
+    { return true; }
+
+    for( size_t i=3; i<pixels.size(); i+=4 )
+    {
+        if ( pixels[i] != 255 )
+        { return false; }
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      ローダーのピクセルデータをコピーします.
+//-------------------------------------------------------------------------------------------
+template<typename T>
+bool CopyPixels( const T& loader, std::vector<unsigned char>& pixels, unsigned int& width, unsigned int& height, unsigned int& bytePerPixel )
+{
+    width        = loader.GetWidth();
+    height       = loader.GetHeight();
+    bytePerPixel = loader.GetBytePerPixel();
+    if ( loader.GetPixels() == nullptr || width == 0 || height == 0 || ( bytePerPixel != 3 && bytePerPixel != 4 ) )
+    { return false; }
+
+    const unsigned char* pPixels = loader.GetPixels();
+    pixels.assign( pPixels, pPixels + size_t( width ) * height * bytePerPixel );
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      経過時間(秒)を取得します.
+//-------------------------------------------------------------------------------------------
+double GetElapsedSeconds( const std::chrono::high_resolution_clock::time_point& start )
+{
+    const std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>( now - start ).count() * 1e-6;
+}
+
+} // namespace /* anonymous */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// TextureConverter::MemoryBudget class
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------
+TextureConverter::MemoryBudget::MemoryBudget()
+: m_Limit   ( 0 )
+, m_Used    ( 0 )
+, m_Peak    ( 0 )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------
+//      上限を設定し，予約をリセットします.
+//-------------------------------------------------------------------------------------------
+void TextureConverter::MemoryBudget::Reset( size_t limit )
+{
+    std::lock_guard<std::mutex> locker( m_Mutex );
+    m_Limit = limit;
+    m_Used  = 0;
+    m_Peak  = 0;
+}
+
+//-------------------------------------------------------------------------------------------
+//      作業メモリを予約します. 上限を超える場合は解放されるまで待機します.
+//-------------------------------------------------------------------------------------------
+void TextureConverter::MemoryBudget::Acquire( size_t size )
+{
+    std::unique_lock<std::mutex> locker( m_Mutex );
+
+    // 上限より大きな画像でも処理できるよう，何も予約されていなければ必ず通す.
+    while( m_Used != 0 && m_Used + size > m_Limit )
+    { m_Condition.wait( locker ); }
+
+    m_Used += size;
+    m_Peak  = std::max( m_Peak, m_Used );
+}
+
+//-------------------------------------------------------------------------------------------
+//      予約した作業メモリを解放します.
+//-------------------------------------------------------------------------------------------
+void TextureConverter::MemoryBudget::Release( size_t size )
+{
+    {
+        std::lock_guard<std::mutex> locker( m_Mutex );
+        m_Used -= size;
+    }
+    m_Condition.notify_all();
+}
+
+//-------------------------------------------------------------------------------------------
+//      予約サイズの最大値を取得します.
+//-------------------------------------------------------------------------------------------
+size_t TextureConverter::MemoryBudget::GetPeak() const
+{ return m_Peak; }
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// TextureConverter class
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------
+TextureConverter::TextureConverter()
+: m_Option  ()
+, m_Files   ()
+, m_Results ()
+, m_Callback( nullptr )
+, m_pUser   ( nullptr )
+, m_Budget  ()
+, m_Mutex   ()
+, m_Next    ( 0 )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------
+TextureConverter::~TextureConverter()
+{ Clear(); }
+
+//-------------------------------------------------------------------------------------------
+//      変換オプションを設定します.
+//-------------------------------------------------------------------------------------------
+void TextureConverter::SetOption( const ConvertOption& option )
+{
+    m_Option = option;
+    if ( m_Option.outputDirectory.empty() )
+    { m_Option.outputDirectory = "."; }
+
+    TextureCache::SetDirectory( m_Option.outputDirectory.c_str() );
+}
+
+//-------------------------------------------------------------------------------------------
+//      変換オプションを取得します.
+//-------------------------------------------------------------------------------------------
+const ConvertOption& TextureConverter::GetOption() const
+{ return m_Option; }
+
+//-------------------------------------------------------------------------------------------
+//      進捗通知用のコールバックを設定します.
+//-------------------------------------------------------------------------------------------
+void TextureConverter::SetProgressCallback( ProgressCallback callback, void* pUser )
+{
+    m_Callback = callback;
+    m_pUser    = pUser;
+}
+
+//-------------------------------------------------------------------------------------------
+//      変換するファイルを追加します.
+//-------------------------------------------------------------------------------------------
+bool TextureConverter::AddFile( const char* filename )
+{
+    if ( filename == nullptr || GetSourceType( filename ) == SOURCE_TYPE_UNKNOWN )
+    { return false; }
+
+    m_Files.push_back( filename );
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      ディレクトリ内の対応する画像ファイルをすべて追加します.
+//-------------------------------------------------------------------------------------------
+unsigned int TextureConverter::AddDirectory( const char* path, bool recursive )
+{
+    if ( path == nullptr )
+    { return 0; }
+
+    std::vector<std::string> files;
+    std::vector<std::string> directories;
+    ListDirectory( path, files, directories );
+
+    // 列挙順はファイルシステム依存なので，結果を安定させるためにソートする.
+    std::sort( files.begin(), files.end() );
+    std::sort( directories.begin(), directories.end() );
+
+    unsigned int count = 0;
+    for( size_t i=0; i<files.size(); ++i )
+    {
+        if ( AddFile( files[i].c_str() ) )
+        { count++; }
+    }
+
+    if ( recursive )
+    {
+        for( size_t i=0; i<directories.size(); ++i )
+        { count += AddDirectory( directories[i].c_str(), true ); }
+    }
+
+    return count;
+}
+
+//-------------------------------------------------------------------------------------------
+//      追加したファイルを並列に変換します.
+//-------------------------------------------------------------------------------------------
+bool TextureConverter::Run( ConvertStats& stats )
+{
+    stats = ConvertStats();
+
+    MakeDirectory( m_Option.outputDirectory );
+
+    m_Results.clear();
+    m_Results.resize( m_Files.size() );
+    MakeOutputNames();
+
+    m_Next = 0;
+    m_Budget.Reset( m_Option.memoryBudget );
+
+    unsigned int threadCount = m_Option.threadCount;
+    if ( threadCount == 0 )
+    { threadCount = std::thread::hardware_concurrency(); }
+    if ( threadCount > m_Files.size() )
+    { threadCount = static_cast<unsigned int>( m_Files.size() ); }
+    if ( threadCount < 1 )
+    { threadCount = 1; }
+
+    const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    // 最後のワーカーは呼び出しスレッドが担当する.
+    std::vector<std::thread> threads;
+    threads.reserve( threadCount - 1 );
+    for( unsigned int i=0; i<threadCount - 1; ++i )
+    { threads.push_back( std::thread( &TextureConverter::Worker, this ) ); }
+
+    Worker();
+
+    for( size_t i=0; i<threads.size(); ++i )
+    { threads[i].join(); }
+
+    stats.seconds    = GetElapsedSeconds( start );
+    stats.peakMemory = m_Budget.GetPeak();
+
+    for( size_t i=0; i<m_Results.size(); ++i )
+    {
+        const ConvertResult& result = m_Results[i];
+        if ( !result.succeeded )
+        {
+            stats.failed++;
+            continue;
+        }
+
+        if ( result.skipped )
+        { stats.skipped++; }
+        else
+        { stats.succeeded++; }
+
+        stats.inputBytes  += result.inputBytes;
+        stats.outputBytes += result.outputBytes;
+    }
+
+    return ( stats.failed == 0 );
+}
+
+//-------------------------------------------------------------------------------------------
+//      1ファイルを変換します.
+//-------------------------------------------------------------------------------------------
+bool TextureConverter::ConvertFile( const char* source, const char* output, ConvertResult& result )
+{
+    result = ConvertResult();
+    if ( source == nullptr )
+    { return false; }
+
+    result.source = source;
+    result.output = ( output != nullptr ) ? output : "";
+
+    if ( m_Option.output == CONVERT_OUTPUT_CACHE )
+    { MakeDirectory( m_Option.outputDirectory ); }
+
+    return Convert( result.source, result.output, m_Option.threadCount, false, result );
+}
+
+//-------------------------------------------------------------------------------------------
+//      追加したファイルの復号時間を計測します.
+//-------------------------------------------------------------------------------------------
+bool TextureConverter::Benchmark( unsigned int count, std::vector<BenchmarkResult>& results ) const
+{
+    results.clear();
+    results.resize( m_Files.size() );
+
+    if ( count == 0 )
+    { count = 1; }
+
+    Image reference;
+    reference.width = 0;
+    reference.height = 0;
+
+    bool succeeded = true;
+    for( size_t i=0; i<m_Files.size(); ++i )
+    {
+        BenchmarkResult& result = results[i];
+        result.source     = m_Files[i];
+        result.inputBytes = GetFileBytes( m_Files[i] );
+
+        Image image;
+        for( unsigned int j=0; j<count; ++j )
+        {
+            const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+            const bool decoded = Decode( m_Files[i], image, result.message );
+            const double seconds = GetElapsedSeconds( start );
+
+            if ( !decoded )
+            { break; }
+
+            result.minSeconds    = ( j == 0 ) ? seconds : std::min( result.minSeconds, seconds );
+            result.totalSeconds += seconds;
+            result.count++;
+        }
+
+        result.succeeded = ( result.count == count );
+        if ( !result.succeeded )
+        {
+            succeeded = false;
+            continue;
+        }
+
+        result.width        = image.width;
+        result.height       = image.height;
+        result.bytePerPixel = image.bytePerPixel;
+
+        // 行の向きを揃えて基準画像と比較する.
+        if ( image.bottomUp )
+        { FlipRows( &image.pixels[0], image.width, image.height, image.bytePerPixel ); }
+
+        if ( reference.width == 0 )
+        {
+            reference = image;
+            continue;
+        }
+
+        if ( image.width != reference.width || image.height != reference.height )
+        { continue; }
+
+        const size_t pixelCount = size_t( image.width ) * image.height;
+        double sum = 0.0;
+        int    max = 0;
+        for( size_t p=0; p<pixelCount; ++p )
+        {
+            const unsigned char* pA = &image.pixels[ p * image.bytePerPixel ];
+            const unsigned char* pB = &reference.pixels[ p * reference.bytePerPixel ];
+            for( unsigned int c=0; c<3; ++c )
+            {
+                const int diff = abs( int( pA[c] ) - int( pB[c] ) );
+                max  = std::max( max, diff );
+                sum += diff;
+            }
+        }
+
+        result.compared  = true;
+        result.maxError  = max;
+        result.meanError = sum / ( pixelCount * 3.0 );
+    }
+
+    return succeeded;
+}
+
+//-------------------------------------------------------------------------------------------
+//      追加したファイルと変換結果をクリアします.
+//-------------------------------------------------------------------------------------------
+void TextureConverter::Clear()
+{
+    m_Files  .clear();
+    m_Results.clear();
+    m_Next = 0;
+}
+
+//-------------------------------------------------------------------------------------------
+//      追加したファイル数を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int TextureConverter::GetFileCount() const
+{ return static_cast<unsigned int>( m_Files.size() ); }
+
+//-------------------------------------------------------------------------------------------
+//      直前の Run() の変換結果を取得します.
+//-------------------------------------------------------------------------------------------
+const std::vector<ConvertResult>& TextureConverter::GetResults() const
+{ return m_Results; }
+
+//-------------------------------------------------------------------------------------------
+//      キューが空になるまでファイルを取り出して変換します.
+//-------------------------------------------------------------------------------------------
+void TextureConverter::Worker()
+{
+    // ファイル単位で並列化するので，ファイルが1つの場合を除き各段は単一スレッドで処理する.
+    const unsigned int innerThreads = ( m_Files.size() == 1 ) ? m_Option.threadCount : 1;
+
+    for( ;; )
+    {
+        size_t index = 0;
+        {
+            std::lock_guard<std::mutex> locker( m_Mutex );
+            if ( m_Next >= m_Files.size() )
+            { return; }
+            index = m_Next++;
+        }
+
+        // 結果の格納先はファイルごとに別なので，書き込み中の排他は不要.
+        ConvertResult& result = m_Results[index];
+        Convert( result.source, result.output, innerThreads, true, result );
+
+        if ( m_Callback != nullptr )
+        {
+            std::lock_guard<std::mutex> locker( m_Mutex );
+            m_Callback( result, m_pUser );
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      復号 -> リサイズ -> ミップ生成 -> 書き出し を行います.
+//-------------------------------------------------------------------------------------------
+bool TextureConverter::Convert
+(
+    const std::string&  source,
+    const std::string&  output,
+    unsigned int        threadCount,
+    bool                useBudget,
+    ConvertResult&      result
+)
+{
+    const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    result.inputBytes = GetFileBytes( source );
+
+    // キャッシュ出力は各ローダーと同じ識別子で保存するので，既にあれば変換を省略する.
+    if ( m_Option.output == CONVERT_OUTPUT_CACHE )
+    {
+        const unsigned long long salt = GetCacheSalt( source );
+
+        TextureCache cache;
+        if ( cache.Open( source.c_str(), salt ) )
+        {
+            result.output    = m_Option.outputDirectory;
+            result.width     = cache.GetWidth();
+            result.height    = cache.GetHeight();
+            result.mipCount  = cache.GetMipCount();
+            result.succeeded = true;
+            result.skipped   = true;
+            result.seconds   = GetElapsedSeconds( start );
+            return true;
+        }
+    }
+
+    Image image;
+    if ( !Decode( source, image, result.message ) )
+    {
+        result.seconds = GetElapsedSeconds( start );
+        return false;
+    }
+
+    // 作業メモリの見積もり. リサイズの中間バッファ(float4)，ミップチェイン，
+    // ミップ生成の浮動小数バッファ，ブロック圧縮用のRGBA8と圧縮結果を合計する.
+    unsigned int targetWidth  = 0;
+    unsigned int targetHeight = 0;
+    GetTargetSize( image.width, image.height, targetWidth, targetHeight );
+
+    const size_t srcPixels = size_t( image.width ) * image.height;
+    const size_t dstPixels = size_t( targetWidth ) * targetHeight;
+    size_t estimate = srcPixels * image.bytePerPixel + dstPixels * ( image.bytePerPixel * 2 + 32 + 4 + 1 );
+    if ( targetWidth != image.width || targetHeight != image.height )
+    { estimate += size_t( targetWidth ) * image.height * 16; }
+
+    if ( useBudget )
+    { m_Budget.Acquire( estimate ); }
+
+    bool succeeded = false;
+    for( ;; )
+    {
+        // DDSは上から下の行順で格納する. 反転は縦フィルタと可換なので先に済ませる.
+        if ( m_Option.output == CONVERT_OUTPUT_DDS && image.bottomUp )
+        {
+            FlipRows( &image.pixels[0], image.width, image.height, image.bytePerPixel );
+            image.bottomUp = false;
+        }
+
+        if ( !Resize( image, threadCount ) )
+        {
+            result.message = "Resize Failed.";
+            break;
+        }
+
+        std::vector<MipLevel> levels;
+        if ( m_Option.generateMips || m_Option.output == CONVERT_OUTPUT_CACHE )
+        {
+            MipMapOption option = m_Option.mipOption;
+            option.threadCount = threadCount;
+            option.isSRGB      = ( image.colorSpace == COLOR_SPACE_SRGB );
+            if ( !GenerateMipMaps( &image.pixels[0], image.width, image.height, image.bytePerPixel, option, levels ) )
+            {
+                result.message = "Generate MipMaps Failed.";
+                break;
+            }
+        }
+        else
+        {
+            levels.resize( 1 );
+            levels[0].width  = image.width;
+            levels[0].height = image.height;
+            levels[0].pixels.swap( image.pixels );
+        }
+
+        // 元の解像度のピクセルは不要になったので先に解放する.
+        std::vector<unsigned char>().swap( image.pixels );
+
+        result.width    = image.width;
+        result.height   = image.height;
+        result.mipCount = static_cast<unsigned int>( levels.size() );
+
+        succeeded = ( m_Option.output == CONVERT_OUTPUT_DDS )
+            ? WriteDDS( output, image, levels, threadCount, result )
+            : WriteCache( source, image, levels, result );
+        break;
+    }
+
+    if ( useBudget )
+    { m_Budget.Release( estimate ); }
+
+    result.succeeded = succeeded;
+    result.seconds   = GetElapsedSeconds( start );
+    return succeeded;
+}
+
+//-------------------------------------------------------------------------------------------
+//      入力ファイルを復号します.
+//-------------------------------------------------------------------------------------------
+bool TextureConverter::Decode( const std::string& source, Image& image, std::string& message ) const
+{
+    image.width        = 0;
+    image.height       = 0;
+    image.bytePerPixel = 0;
+    image.bottomUp     = false;
+    image.pixels.clear();
+
+    // ローダーには色空間のヒントを渡し，画像が持つ情報(PNGのsRGBチャンク等)を優先する.
+    const COLOR_SPACE hint = ( m_Option.mipOption.isSRGB ) ? COLOR_SPACE_SRGB : COLOR_SPACE_LINEAR;
+    image.colorSpace = hint;
+
+    bool loaded = false;
+    bool copied = false;
+    switch( GetSourceType( source ) )
+    {
+    case SOURCE_TYPE_BMP:
+        {
+            BmpImage loader;
+            loader.SetColorSpaceHint( hint );
+            loaded = loader.Load( source.c_str() );
+            copied = loaded && CopyPixels( loader, image.pixels, image.width, image.height, image.bytePerPixel );
+            image.colorSpace = loader.GetColorSpace();
+            image.bottomUp = true;
+        }
+        break;
+
+    case SOURCE_TYPE_TGA:
+        {
+            TgaImage loader;
+            loader.SetColorSpaceHint( hint );
+            loaded = loader.Load( source.c_str() );
+            copied = loaded && CopyPixels( loader, image.pixels, image.width, image.height, image.bytePerPixel );
+            image.colorSpace = loader.GetColorSpace();
+            image.bottomUp = true;
+        }
+        break;
+
+    case SOURCE_TYPE_RAW:
+        {
+            if ( m_Option.rawWidth == 0 || m_Option.rawHeight == 0 )
+            {
+                message = "RAW Size Is Not Specified.";
+                return false;
+            }
+
+            RawImage loader;
+            loader.SetColorSpaceHint( hint );
+            loaded = loader.Load( source.c_str(), m_Option.rawWidth, m_Option.rawHeight, m_Option.rawAlpha );
+            copied = loaded && CopyPixels( loader, image.pixels, image.width, image.height, image.bytePerPixel );
+            image.colorSpace = loader.GetColorSpace();
+        }
+        break;
+
+    case SOURCE_TYPE_PNG:
+        {
+            PngImage loader;
+            loader.SetColorSpaceHint( hint );
+            loaded = loader.Load( source.c_str() );
+            copied = loaded && CopyPixels( loader, image.pixels, image.width, image.height, image.bytePerPixel );
+            image.colorSpace = loader.GetColorSpace();
+        }
+        break;
+
+    case SOURCE_TYPE_JPEG:
+        {
+            JpegImage loader;
+            loader.SetColorSpaceHint( hint );
+            loaded = loader.Load( source.c_str() );
+            copied = loaded && CopyPixels( loader, image.pixels, image.width, image.height, image.bytePerPixel );
+            image.colorSpace = loader.GetColorSpace();
+        }
+        break;
+
+    case SOURCE_TYPE_DDS:
+        {
+            // ブロック圧縮フォーマットの最上位ミップ(先頭スライス)のみ変換する.
+            DdsImage loader;
+            loader.SetColorSpaceHint( hint );
+            loaded = loader.Load( source.c_str() );
+            if ( loaded && loader.GetWidth() > 0 && loader.GetHeight() > 0 )
+            {
+                image.width        = loader.GetWidth();
+                image.height       = loader.GetHeight();
+                image.bytePerPixel = 4;
+                image.pixels.resize( size_t( image.width ) * image.height * 4 );
+                copied = loader.Decode( 0, &image.pixels[0], 1 );
+                image.colorSpace = loader.GetColorSpace();
+            }
+        }
+        break;
+
+    default:
+        message = "Unsupported File Type.";
+        return false;
+    }
+
+    if ( !loaded )
+    {
+        message = "Load Failed.";
+        return false;
+    }
+
+    if ( !copied )
+    {
+        message = "Unsupported Pixel Format.";
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      オプションに従ってリサイズします.
+//-------------------------------------------------------------------------------------------
+bool TextureConverter::Resize( Image& image, unsigned int threadCount ) const
+{
+    unsigned int width  = 0;
+    unsigned int height = 0;
+    GetTargetSize( image.width, image.height, width, height );
+    if ( width == image.width && height == image.height )
+    { return true; }
+
+    ResampleOption option;
+    option.filter      = m_Option.resizeFilter;
+    option.isSRGB      = ( image.colorSpace == COLOR_SPACE_SRGB );
+    option.threadCount = threadCount;
+
+    const RESAMPLE_FORMAT format = ( image.bytePerPixel == 4 ) ? RESAMPLE_FORMAT_RGBA8 : RESAMPLE_FORMAT_RGB8;
+
+    std::vector<unsigned char> pixels( size_t( width ) * height * image.bytePerPixel );
+    if ( !ResampleImage( &image.pixels[0], image.width, image.height, format, &pixels[0], width, height, option ) )
+    { return false; }
+
+    image.pixels.swap( pixels );
+    image.width  = width;
+    image.height = height;
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      ブロック圧縮してDDSファイルに書き出します.
+//-------------------------------------------------------------------------------------------
+bool TextureConverter::WriteDDS
+(
+    const std::string&              output,
+    const Image&                    image,
+    const std::vector<MipLevel>&    levels,
+    unsigned int                    threadCount,
+    ConvertResult&                  result
+) const
+{
+    BC_FORMAT format = m_Option.format;
+    if ( m_Option.autoFormat )
+    { format = IsOpaque( levels[0].pixels, image.bytePerPixel ) ? BC_FORMAT_BC1 : BC_FORMAT_BC3; }
+
+    size_t totalSize = 0;
+    for( size_t i=0; i<levels.size(); ++i )
+    { totalSize += GetBCSurfaceSize( format, levels[i].width, levels[i].height ); }
+
+    std::vector<unsigned char> data( totalSize );
+    std::vector<unsigned char> rgba;
+
+    size_t offset = 0;
+    for( size_t i=0; i<levels.size(); ++i )
+    {
+        const MipLevel&      level   = levels[i];
+        const unsigned char* pPixels = &level.pixels[0];
+
+        // エンコーダはRGBA8のみ受け付けるので，RGB8は不透明なアルファを補う.
+        if ( image.bytePerPixel == 3 )
+        {
+            const size_t count = size_t( level.width ) * level.height;
+            rgba.resize( count * 4 );
+            for( size_t j=0; j<count; ++j )
+            {
+                rgba[ j * 4 + 0 ] = level.pixels[ j * 3 + 0 ];
+                rgba[ j * 4 + 1 ] = level.pixels[ j * 3 + 1 ];
+                rgba[ j * 4 + 2 ] = level.pixels[ j * 3 + 2 ];
+                rgba[ j * 4 + 3 ] = 255;
+            }
+            pPixels = &rgba[0];
+        }
+
+        if ( !EncodeBC( format, pPixels, level.width, level.height, &data[offset], m_Option.quality, threadCount ) )
+        {
+            result.message = "Block Compression Failed.";
+            return false;
+        }
+
+        offset += GetBCSurfaceSize( format, level.width, level.height );
+    }
+
+    if ( !SaveDDS( output.c_str(), format, image.width, image.height, static_cast<unsigned int>( levels.size() ), &data[0], data.size() ) )
+    {
+        result.message = "Save DDS Failed.";
+        return false;
+    }
+
+    result.outputBytes = GetFileBytes( output );
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      ミップマップチェインを変換済みキャッシュとして書き出します.
+//-------------------------------------------------------------------------------------------
+bool TextureConverter::WriteCache
+(
+    const std::string&              source,
+    const Image&                    image,
+    const std::vector<MipLevel>&    levels,
+    ConvertResult&                  result
+) const
+{
+    const unsigned long long salt = GetCacheSalt( source );
+
+    // Open() で元画像のハッシュを計算しておく必要がある.
+    TextureCache cache;
+    cache.Open( source.c_str(), salt );
+
+    // ローダーと同様に，sRGBの場合は内部フォーマットで色空間を記録する.
+    const bool         isSRGB         = ( image.colorSpace == COLOR_SPACE_SRGB );
+    const unsigned int format         = ( image.bytePerPixel == 4 ) ? FORMAT_RGBA : FORMAT_RGB;
+    const unsigned int internalFormat = ( image.bytePerPixel == 4 )
+        ? ( isSRGB ? FORMAT_SRGB8_ALPHA8 : FORMAT_RGBA )
+        : ( isSRGB ? FORMAT_SRGB8        : FORMAT_RGB );
+    if ( !cache.Save( format, internalFormat, image.bytePerPixel, levels ) )
+    {
+        result.message = "Save Cache Failed.";
+        return false;
+    }
+
+    result.output = m_Option.outputDirectory;
+    for( size_t i=0; i<levels.size(); ++i )
+    { result.outputBytes += levels[i].pixels.size(); }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      リサイズ後のサイズを求めます.
+//-------------------------------------------------------------------------------------------
+void TextureConverter::GetTargetSize
+(
+    unsigned int    width,
+    unsigned int    height,
+    unsigned int&   targetWidth,
+    unsigned int&   targetHeight
+) const
+{
+    targetWidth  = ( m_Option.resizeWidth  != 0 ) ? m_Option.resizeWidth  : width;
+    targetHeight = ( m_Option.resizeHeight != 0 ) ? m_Option.resizeHeight : height;
+
+    // 長辺を上限に収める. 縦横比は保つ.
+    const unsigned int maxSize = m_Option.maxSize;
+    if ( maxSize != 0 && ( targetWidth > maxSize || targetHeight > maxSize ) )
+    {
+        if ( targetWidth >= targetHeight )
+        {
+            targetHeight = static_cast<unsigned int>( ( double( targetHeight ) * maxSize ) / targetWidth + 0.5 );
+            targetWidth  = maxSize;
+        }
+        else
+        {
+            targetWidth  = static_cast<unsigned int>( ( double( targetWidth ) * maxSize ) / targetHeight + 0.5 );
+            targetHeight = maxSize;
+        }
+    }
+
+    if ( m_Option.powerOfTwo )
+    {
+        targetWidth  = RoundToPowerOfTwo( std::max( targetWidth,  1u ) );
+        targetHeight = RoundToPowerOfTwo( std::max( targetHeight, 1u ) );
+
+        // 丸めで上限を超えた場合は1段下げる.
+        if ( maxSize != 0 )
+        {
+            while( targetWidth  > maxSize && targetWidth  > 1 ) { targetWidth  /= 2; }
+            while( targetHeight > maxSize && targetHeight > 1 ) { targetHeight /= 2; }
+        }
+    }
+
+    targetWidth  = std::max( targetWidth,  1u );
+    targetHeight = std::max( targetHeight, 1u );
+}
+
+//-------------------------------------------------------------------------------------------
+//      キャッシュの識別に使うソルトを求めます. 各ローダーと同じ値になるようにします.
+//-------------------------------------------------------------------------------------------
+unsigned long long TextureConverter::GetCacheSalt( const std::string& source ) const
+{
+    unsigned long long salt = 0;
+    if ( GetSourceType( source ) == SOURCE_TYPE_RAW )
+    {
+        salt = ( static_cast<unsigned long long>( m_Option.rawWidth ) << 32 )
+             | ( static_cast<unsigned long long>( m_Option.rawHeight ) << 1 )
+             | ( m_Option.rawAlpha ? 1 : 0 );
+    }
+
+    if ( !m_Option.mipOption.isSRGB )
+    { salt ^= TextureCache::SALT_LINEAR; }
+
+    return salt;
+}
+
+//-------------------------------------------------------------------------------------------
+//      出力ファイル名を生成します.
+//-------------------------------------------------------------------------------------------
+void TextureConverter::MakeOutputNames()
+{
+    // "a.png" と "a.tga" のように名前が衝突する場合は，追加順によらないよう衝突するすべてに拡張子を付ける.
+    std::map<std::string, unsigned int> stemCount;
+    for( size_t i=0; i<m_Files.size(); ++i )
+    { stemCount[ GetStem( m_Files[i] ) ]++; }
+
+    std::set<std::string> used;
+    for( size_t i=0; i<m_Files.size(); ++i )
+    {
+        ConvertResult& result = m_Results[i];
+        result.source = m_Files[i];
+
+        if ( m_Option.output == CONVERT_OUTPUT_CACHE )
+        {
+            result.output = m_Option.outputDirectory;
+            continue;
+        }
+
+        const std::string stem = GetStem( m_Files[i] );
+        const std::string base = ( stemCount[ stem ] > 1 ) ? stem + "_" + GetExtension( m_Files[i] ) : stem;
+
+        // 別ディレクトリの同名ファイルは連番で区別する.
+        std::string name = base;
+        for( unsigned int n=1; used.count( name ) != 0; ++n )
+        {
+            char suffix[16];
+            sprintf_s( suffix, sizeof(suffix), "_%u", n );
+            name = base + suffix;
+        }
+
+        used.insert( name );
+        result.output = m_Option.outputDirectory + "/" + name + ".dds";
+    }
+}
@@ -0,0 +1,301 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Texture Converter
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+
+#if defined(DEBUG) || defined(_DEBUG)
+    #define _CRTDBG_MAP_ALLOC
+    #include <crtdbg.h>
+#endif//defined(DEBUG) || defined(_DEBUG)
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <TextureConverter.h>
+#include <ResamplerTest.h>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+//      使い方を表示します.
+//-------------------------------------------------------------------------------------------
+void PrintUsage()
+{
+    std::cout << "Usage : GL_TextureConverter [options] <file or directory> ...\n"
+              << "  -o <dir>          output directory (default: .)\n"
+              << "  -f dds|cache      output format (default: dds)\n"
+              << "  -bc bc1|bc2|bc3|bc4|bc5\n"
+              << "                    block compression format (default: bc1 or bc3 by alpha)\n"
+              << "  -q fast|high      block compression quality (default: fast)\n"
+              << "  -resize <W>x<H>   resize to W x H\n"
+              << "  -max <N>          clamp the longer side to N (keeps aspect ratio)\n"
+              << "  -pot              round sizes to the nearest power of two\n"
+              << "  -filter box|bilinear|bicubic|lanczos\n"
+              << "                    resize filter (default: lanczos)\n"
+              << "  -mipfilter box|kaiser|lanczos\n"
+              << "                    mipmap filter (default: kaiser)\n"
+              << "  -nomips           do not generate mipmaps (dds only)\n"
+              << "  -linear           treat color as linear instead of sRGB\n"
+              << "  -raw <W>x<H>[a]   size of .raw files, 'a' for RGBA\n"
+              << "  -r                search directories recursively\n"
+              << "  -j <N>            number of files processed in parallel (default: all cores)\n"
+              << "  -mem <MB>         working memory budget (default: 512)\n"
+              << "  -bench <N>        only decode each input N times and print timings\n"
+              << "  -selftest         check the resampler against a reference and exit\n"
+              << std::endl;
+}
+
+//-------------------------------------------------------------------------------------------
+//      "WxH" 形式のサイズを解析します.
+//-------------------------------------------------------------------------------------------
+bool ParseSize( const char* text, unsigned int& width, unsigned int& height, bool* pAlpha = nullptr )
+{
+    char* pEnd = nullptr;
+    width = static_cast<unsigned int>( strtoul( text, &pEnd, 10 ) );
+    if ( *pEnd != 'x' )
+    { return false; }
+
+    height = static_cast<unsigned int>( strtoul( pEnd + 1, &pEnd, 10 ) );
+    if ( width == 0 || height == 0 )
+    { return false; }
+
+    // RAWの場合のみ末尾の 'a' でアルファ付きを指定できる.
+    if ( pAlpha != nullptr && *pEnd == 'a' )
+    {
+        *pAlpha = true;
+        pEnd++;
+    }
+
+    return ( *pEnd == '\0' );
+}
+
+//-------------------------------------------------------------------------------------------
+//      1ファイルの変換が終わったときに呼ばれます.
+//-------------------------------------------------------------------------------------------
+void OnProgress( const ConvertResult& result, void* )
+{
+    if ( !result.succeeded )
+    {
+        std::cerr << "Error : " << result.source << " : " << result.message << std::endl;
+        return;
+    }
+
+    std::cout << ( result.skipped ? "[skip] " : "[done] " )
+              << result.source << " -> " << result.output
+              << " (" << result.width << "x" << result.height
+              << ", " << result.mipCount << " mips, "
+              << std::fixed << std::setprecision( 1 ) << result.seconds * 1000.0 << " ms)"
+              << std::endl;
+}
+
+//-------------------------------------------------------------------------------------------
+//      復号時間の計測結果を表示します.
+//-------------------------------------------------------------------------------------------
+void PrintBenchmark( const std::vector<BenchmarkResult>& results )
+{
+    for( size_t i=0; i<results.size(); ++i )
+    {
+        const BenchmarkResult& result = results[i];
+        if ( !result.succeeded )
+        {
+            std::cerr << "Error : " << result.source << " : " << result.message << std::endl;
+            continue;
+        }
+
+        std::cout << "[bench] " << result.source
+                  << " (" << result.width << "x" << result.height << "x" << result.bytePerPixel
+                  << ", " << result.inputBytes / 1024 << " KB) "
+                  << std::fixed << std::setprecision( 3 )
+                  << "min " << result.minSeconds * 1000.0 << " ms, "
+                  << "avg " << result.GetAverageSeconds() * 1000.0 << " ms, "
+                  << std::setprecision( 1 )
+                  << result.GetMegaPixelsPerSecond() << " MP/s";
+
+        // 最初の画像と同じサイズなら，同じ内容として誤差も表示する.
+        if ( result.compared )
+        {
+            std::cout << std::setprecision( 2 )
+                      << ", error max " << result.maxError << " mean " << result.meanError;
+        }
+        else if ( i > 0 )
+        { std::cout << ", not compared"; }
+
+        std::cout << std::endl;
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      ファイルまたはディレクトリを入力に追加します.
+//-------------------------------------------------------------------------------------------
+bool AddInput( TextureConverter& converter, const char* path, bool recursive )
+{
+    if ( converter.AddFile( path ) )
+    { return true; }
+
+    return converter.AddDirectory( path, recursive ) > 0;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+#if defined(DEBUG) || defined(_DEBUG)
+    _CrtSetDbgFlag( _CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF );
+#endif//defined(DEBUG) || defined(_DEBUG)
+
+    ConvertOption             option;
+    std::vector<const char*>  inputs;
+    bool                      recursive = false;
+    unsigned int              benchmark = 0;
+    bool                      selfTest  = false;
+
+    for( int i=1; i<argc; ++i )
+    {
+        const char* arg  = argv[i];
+        const char* next = ( i + 1 < argc ) ? argv[i + 1] : nullptr;
+        bool        ok   = true;
+
+        if ( arg[0] != '-' )
+        {
+            inputs.push_back( arg );
+            continue;
+        }
+
+        if ( strcmp( arg, "-o" ) == 0 && next != nullptr )
+        { option.outputDirectory = next; ++i; }
+        else if ( strcmp( arg, "-f" ) == 0 && next != nullptr )
+        {
+            if      ( strcmp( next, "dds" )   == 0 ) { option.output = CONVERT_OUTPUT_DDS; }
+            else if ( strcmp( next, "cache" ) == 0 ) { option.output = CONVERT_OUTPUT_CACHE; }
+            else    { ok = false; }
+            ++i;
+        }
+        else if ( strcmp( arg, "-bc" ) == 0 && next != nullptr )
+        {
+            option.autoFormat = false;
+            if      ( strcmp( next, "bc1" ) == 0 ) { option.format = BC_FORMAT_BC1; }
+            else if ( strcmp( next, "bc2" ) == 0 ) { option.format = BC_FORMAT_BC2; }
+            else if ( strcmp( next, "bc3" ) == 0 ) { option.format = BC_FORMAT_BC3; }
+            else if ( strcmp( next, "bc4" ) == 0 ) { option.format = BC_FORMAT_BC4U; }
+            else if ( strcmp( next, "bc5" ) == 0 ) { option.format = BC_FORMAT_BC5U; }
+            else    { ok = false; }
+            ++i;
+        }
+        else if ( strcmp( arg, "-q" ) == 0 && next != nullptr )
+        {
+            if      ( strcmp( next, "fast" ) == 0 ) { option.quality = BC_QUALITY_FAST; }
+            else if ( strcmp( next, "high" ) == 0 ) { option.quality = BC_QUALITY_HIGH; }
+            else    { ok = false; }
+            ++i;
+        }
+        else if ( strcmp( arg, "-resize" ) == 0 && next != nullptr )
+        { ok = ParseSize( next, option.resizeWidth, option.resizeHeight ); ++i; }
+        else if ( strcmp( arg, "-max" ) == 0 && next != nullptr )
+        { option.maxSize = static_cast<unsigned int>( atoi( next ) ); ++i; }
+        else if ( strcmp( arg, "-pot" ) == 0 )
+        { option.powerOfTwo = true; }
+        else if ( strcmp( arg, "-filter" ) == 0 && next != nullptr )
+        {
+            if      ( strcmp( next, "box" )      == 0 ) { option.resizeFilter = RESAMPLE_FILTER_BOX; }
+            else if ( strcmp( next, "bilinear" ) == 0 ) { option.resizeFilter = RESAMPLE_FILTER_BILINEAR; }
+            else if ( strcmp( next, "bicubic" )  == 0 ) { option.resizeFilter = RESAMPLE_FILTER_BICUBIC; }
+            else if ( strcmp( next, "lanczos" )  == 0 ) { option.resizeFilter = RESAMPLE_FILTER_LANCZOS3; }
+            else    { ok = false; }
+            ++i;
+        }
+        else if ( strcmp( arg, "-mipfilter" ) == 0 && next != nullptr )
+        {
+            if      ( strcmp( next, "box" )     == 0 ) { option.mipOption.filter = MIPMAP_FILTER_BOX; }
+            else if ( strcmp( next, "kaiser" )  == 0 ) { option.mipOption.filter = MIPMAP_FILTER_KAISER; }
+            else if ( strcmp( next, "lanczos" ) == 0 ) { option.mipOption.filter = MIPMAP_FILTER_LANCZOS; }
+            else    { ok = false; }
+            ++i;
+        }
+        else if ( strcmp( arg, "-nomips" ) == 0 )
+        { option.generateMips = false; }
+        else if ( strcmp( arg, "-linear" ) == 0 )
+        { option.mipOption.isSRGB = false; }
+        else if ( strcmp( arg, "-raw" ) == 0 && next != nullptr )
+        { ok = ParseSize( next, option.rawWidth, option.rawHeight, &option.rawAlpha ); ++i; }
+        else if ( strcmp( arg, "-r" ) == 0 )
+        { recursive = true; }
+        else if ( strcmp( arg, "-j" ) == 0 && next != nullptr )
+        { option.threadCount = static_cast<unsigned int>( atoi( next ) ); ++i; }
+        else if ( strcmp( arg, "-mem" ) == 0 && next != nullptr )
+        { option.memoryBudget = size_t( atoi( next ) ) * 1024 * 1024; ++i; }
+        else if ( strcmp( arg, "-bench" ) == 0 && next != nullptr )
+        { benchmark = static_cast<unsigned int>( atoi( next ) ); ok = ( benchmark > 0 ); ++i; }
+        else if ( strcmp( arg, "-selftest" ) == 0 )
+        { selfTest = true; }
+        else
+        { ok = false; }
+
+        if ( !ok )
+        {
+            std::cerr << "Error : Invalid Option. " << arg << std::endl;
+            PrintUsage();
+            return -1;
+        }
+    }
+
+    // 入力は不要. リサンプラーの自己診断のみ行う.
+    if ( selfTest )
+    { return RunResamplerTest( 200, 5 ) ? 0 : 1; }
+
+    if ( inputs.empty() )
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    TextureConverter converter;
+    converter.SetOption( option );
+    converter.SetProgressCallback( OnProgress, nullptr );
+
+    for( size_t i=0; i<inputs.size(); ++i )
+    {
+        if ( !AddInput( converter, inputs[i], recursive ) )
+        { std::cerr << "Warning : No Images Found. " << inputs[i] << std::endl; }
+    }
+
+    if ( converter.GetFileCount() == 0 )
+    { return -1; }
+
+    // 復号時間だけを計測する. 変換は行わない.
+    if ( benchmark > 0 )
+    {
+        std::vector<BenchmarkResult> results;
+        const bool succeeded = converter.Benchmark( benchmark, results );
+        PrintBenchmark( results );
+        return succeeded ? 0 : 1;
+    }
+
+    ConvertStats stats;
+    const bool succeeded = converter.Run( stats );
+
+    std::cout << std::fixed << std::setprecision( 2 )
+              << "\n"
+              << "Converted  : " << stats.succeeded << " file(s), "
+              << stats.skipped   << " skipped, "
+              << stats.failed    << " failed\n"
+              << "Input      : " << stats.inputBytes  / ( 1024.0 * 1024.0 ) << " MB\n"
+              << "Output     : " << stats.outputBytes / ( 1024.0 * 1024.0 ) << " MB\n"
+              << "Time       : " << stats.seconds << " sec\n"
+              << "Throughput : " << stats.GetMegaBytesPerSecond() << " MB/s, "
+              << stats.GetImagesPerSecond() << " images/s\n"
+              << "Peak Memory: " << stats.peakMemory / ( 1024.0 * 1024.0 ) << " MB (estimated)"
+              << std::endl;
+
+    return succeeded ? 0 : 1;
+}
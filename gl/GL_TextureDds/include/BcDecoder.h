@@ -0,0 +1,66 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : BcDecoder.h
+// Desc : Block Compression Decoder.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+#ifndef _BC_DECODER_H_
+#define _BC_DECODER_H_
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// BC_FORMAT enum
+/////////////////////////////////////////////////////////////////////////////////////////////
+enum BC_FORMAT
+{
+    BC_FORMAT_BC1 = 0,          //!< BC1 (DXT1).
+    BC_FORMAT_BC2,              //!< BC2 (DXT2, DXT3).
+    BC_FORMAT_BC3,              //!< BC3 (DXT4, DXT5).
+    BC_FORMAT_BC4U,             //!< BC4 符号なし (ATI1).
+    BC_FORMAT_BC4S,             //!< BC4 符号付き.
+    BC_FORMAT_BC5U,             //!< BC5 符号なし (ATI2).
+    BC_FORMAT_BC5S,             //!< BC5 符号付き.
+};
+
+
+//-------------------------------------------------------------------------------------------
+//! @brief      1ブロックあたりのバイト数を取得します.
+//!
+//! @param [in]     format      ブロック圧縮フォーマットです.
+//! @return     1ブロック(4x4ピクセル)あたりのバイト数を返却します.
+//-------------------------------------------------------------------------------------------
+unsigned int GetBCBlockSize( BC_FORMAT format );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      1ブロックをRGBA8に展開します.
+//!
+//! @param [in]     format      ブロック圧縮フォーマットです.
+//! @param [in]     pBlock      圧縮ブロックです.
+//! @param [out]    pDst        4x4ピクセルのRGBA8 (64バイト) の格納先です.
+//-------------------------------------------------------------------------------------------
+void DecodeBCBlock( BC_FORMAT format, const unsigned char* pBlock, unsigned char* pDst );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      ブロック圧縮されたサーフェイスをRGBA8に展開します.
+//!
+//! @note       GLコンテキストを必要としないため，ツールやテストからも利用できます.
+//!             BC4はRを，BC5はRGを出力し，GLでサンプリングした場合と同じく残りの成分は
+//!             ( 0, 0, 255 ) で埋めます. 符号付きフォーマットは [-1, 1] を [0, 255] に写像します.
+//!
+//! @param [in]     format      ブロック圧縮フォーマットです.
+//! @param [in]     pSrc        圧縮データです.
+//! @param [in]     width       サーフェイスの横幅です.
+//! @param [in]     height      サーフェイスの縦幅です.
+//! @param [out]    pDst        width * height * 4 バイトのRGBA8の格納先です.
+//! @param [in]     threadCount 使用するスレッド数です. 0の場合はハードウェアスレッド数を使用します.
+//-------------------------------------------------------------------------------------------
+void DecodeBC(
+    BC_FORMAT               format,
+    const unsigned char*    pSrc,
+    unsigned int            width,
+    unsigned int            height,
+    unsigned char*          pDst,
+    unsigned int            threadCount = 0 );
+
+
+#endif//_BC_DECODER_H_
@@ -0,0 +1,74 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : BcEncoder.h
+// Desc : Block Compression Encoder.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+#ifndef _BC_ENCODER_H_
+#define _BC_ENCODER_H_
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <cstddef>
+#include <BcDecoder.h>
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// BC_QUALITY enum
+/////////////////////////////////////////////////////////////////////////////////////////////
+enum BC_QUALITY
+{
+    BC_QUALITY_FAST = 0,        //!< 主軸上の範囲から端点を決めます(レンジフィット).
+    BC_QUALITY_HIGH,            //!< 全クラスタ分割を最小二乗で評価します(クラスタフィット).
+};
+
+
+//-------------------------------------------------------------------------------------------
+//! @brief      サーフェイスの圧縮後のバイト数を取得します.
+//!
+//! @param [in]     format      ブロック圧縮フォーマットです.
+//! @param [in]     width       横幅です.
+//! @param [in]     height      縦幅です.
+//! @return     圧縮後のバイト数を返却します.
+//-------------------------------------------------------------------------------------------
+size_t GetBCSurfaceSize( BC_FORMAT format, unsigned int width, unsigned int height );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      4x4ピクセルのRGBA8を1ブロックに圧縮します.
+//!
+//! @param [in]     format      ブロック圧縮フォーマットです. 符号付きフォーマットは非対応です.
+//! @param [in]     pSrc        4x4ピクセルのRGBA8 (64バイト) です.
+//! @param [in]     quality     圧縮品質です.
+//! @param [out]    pBlock      圧縮ブロックの格納先です.
+//! @retval true    圧縮に成功.
+//! @retval false   非対応のフォーマット.
+//-------------------------------------------------------------------------------------------
+bool EncodeBCBlock( BC_FORMAT format, const unsigned char* pSrc, BC_QUALITY quality, unsigned char* pBlock );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      RGBA8のサーフェイスをブロック圧縮します.
+//!
+//! @note       BC4はR成分，BC5はRG成分を圧縮します.
+//!
+//! @param [in]     format      ブロック圧縮フォーマットです. 符号付きフォーマットは非対応です.
+//! @param [in]     pSrc        width * height * 4 バイトのRGBA8です.
+//! @param [in]     width       サーフェイスの横幅です.
+//! @param [in]     height      サーフェイスの縦幅です.
+//! @param [out]    pDst        GetBCSurfaceSize() バイトの格納先です.
+//! @param [in]     quality     圧縮品質です.
+//! @param [in]     threadCount 使用するスレッド数です. 0の場合はハードウェアスレッド数を使用します.
+//! @retval true    圧縮に成功.
+//! @retval false   圧縮に失敗.
+//-------------------------------------------------------------------------------------------
+bool EncodeBC(
+    BC_FORMAT               format,
+    const unsigned char*    pSrc,
+    unsigned int            width,
+    unsigned int            height,
+    unsigned char*          pDst,
+    BC_QUALITY              quality     = BC_QUALITY_FAST,
+    unsigned int            threadCount = 0 );
+
+
+#endif//_BC_ENCODER_H_
@@ -7,6 +7,12 @@
 #ifndef _DDS_LOADER_H_
 #define _DDS_LOADER_H_
 
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <vector>
+#include <MappedFile.h>
+#include <ColorSpace.h>
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 // DdsImage class
@@ -19,6 +25,18 @@ class DdsImage
     /* NOTHING */
 
 public:
+    /////////////////////////////////////////////////////////////////////////////////////////
+    // Surface structure
+    /////////////////////////////////////////////////////////////////////////////////////////
+    struct Surface
+    {
+        unsigned int    offset;         //!< ピクセルデータ先頭からのオフセットです.
+        unsigned int    size;           //!< データサイズです.
+        unsigned int    width;          //!< 横幅です.
+        unsigned int    height;         //!< 縦幅です.
+        unsigned int    depth;          //!< ボリュームテクスチャの奥行です(ミップレベル単位).
+    };
+
     //=======================================================================================
     // public variables.
     //=======================================================================================
@@ -38,6 +56,15 @@ public:
     //---------------------------------------------------------------------------------------
     virtual ~DdsImage();
 
+    //---------------------------------------------------------------------------------------
+    //! @brief      色空間のヒントを設定します.
+    //!
+    //! @note       Load() の前に呼び出します. DX10拡張ヘッダを持つファイルはDXGIフォーマットの
+    //!             _SRGB の有無を優先し，旧形式の8bitカラー・BC1～BC3のみヒントに従います.
+    //! @param [in]     colorSpace      色空間です. 既定値は COLOR_SPACE_SRGB です.
+    //---------------------------------------------------------------------------------------
+    void SetColorSpaceHint( COLOR_SPACE colorSpace );
+
     //---------------------------------------------------------------------------------------
     //! @brief      テクスチャを読み込みします.
     //!
@@ -67,6 +94,113 @@ public:
     //---------------------------------------------------------------------------------------
     unsigned int GetID() const;
 
+    //---------------------------------------------------------------------------------------
+    //! @brief      画像の横幅を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetWidth() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      画像の縦幅を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetHeight() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      ボリュームテクスチャの奥行を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetDepth() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      テクスチャ配列の要素数を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetArraySize() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      フォーマットを取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetFormat() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      読み込んだ画像の色空間を取得します.
+    //---------------------------------------------------------------------------------------
+    COLOR_SPACE GetColorSpace() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      GLのテクスチャターゲットを取得します.
+    //!
+    //! @return     GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_3D, GL_TEXTURE_2D_ARRAY,
+    //!             GL_TEXTURE_CUBE_MAP_ARRAY のいずれかを返却します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetTarget() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      キューブマップかどうかチェックします.
+    //---------------------------------------------------------------------------------------
+    bool IsCubemap() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      ボリュームテクスチャかどうかチェックします.
+    //---------------------------------------------------------------------------------------
+    bool IsVolume() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      ミップマップ数を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetMipmapCount() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      指定ミップレベルに含まれる2Dスライス数を取得します.
+    //!
+    //! @note       テクスチャ配列・キューブマップの場合は 配列要素数 * 面数 で全ミップ共通です.
+    //!             ボリュームテクスチャの場合はミップレベルごとの奥行です.
+    //! @param [in]     mipLevel        ミップレベルです.
+    //! @return     2Dスライス数を返却します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetLayerCount( unsigned int mipLevel ) const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      サーフェイス情報を取得します.
+    //!
+    //! @param [in]     mipLevel        ミップレベルです.
+    //! @param [in]     layer           2Dスライス番号です. キューブマップの場合は 配列番号 * 6 + 面番号
+    //!                                 (+X, -X, +Y, -Y, +Z, -Z の順) で，ボリュームの場合は奥行方向の番号です.
+    //! @return     サーフェイス情報を返却します.
+    //---------------------------------------------------------------------------------------
+    const Surface& GetSurface( unsigned int mipLevel, unsigned int layer = 0 ) const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      サーフェイスのピクセルデータを取得します.
+    //!
+    //! @param [in]     mipLevel        ミップレベルです.
+    //! @param [in]     layer           2Dスライス番号です.
+    //! @return     マップされたファイル上のピクセルデータを返却します. コピーはされません.
+    //---------------------------------------------------------------------------------------
+    const unsigned char* GetSurfaceData( unsigned int mipLevel, unsigned int layer = 0 ) const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      サーフェイスをCPUでRGBA8に展開します.
+    //!
+    //! @note       GLコンテキストは不要です. ツールや画像比較テストから利用できます.
+    //!             BC1～BC5のブロック圧縮フォーマットのみ対応します.
+    //! @param [in]     mipLevel        ミップレベルです.
+    //! @param [out]    pDst            width * height * 4 バイトの格納先です.
+    //! @param [in]     threadCount     使用するスレッド数です. 0の場合は自動で決定します.
+    //! @retval true    展開に成功.
+    //! @retval false   展開に失敗.
+    //---------------------------------------------------------------------------------------
+    bool Decode( unsigned int mipLevel, unsigned char* pDst, unsigned int threadCount = 0 ) const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      指定スライスのサーフェイスをCPUでRGBA8に展開します.
+    //!
+    //! @param [in]     mipLevel        ミップレベルです.
+    //! @param [in]     layer           2Dスライス番号です.
+    //! @param [out]    pDst            width * height * 4 バイトの格納先です.
+    //! @param [in]     threadCount     使用するスレッド数です. 0の場合は自動で決定します.
+    //! @retval true    展開に成功.
+    //! @retval false   展開に失敗.
+    //---------------------------------------------------------------------------------------
+    bool Decode( unsigned int mipLevel, unsigned int layer, unsigned char* pDst, unsigned int threadCount = 0 ) const;
+
 protected:
     enum COMPRESS_TYPE
     {
@@ -80,20 +214,35 @@ protected:
     //=======================================================================================
     // protected variables.
     //=======================================================================================
-    unsigned int    m_ImageSize;        //!< ピクセルサイズです.
-    unsigned int    m_Format;           //!< フォーマットです.
-    unsigned int    m_InternalFormat;   //!< 内部フォーマットです.
-    unsigned int    m_Width;            //!< 画像の横幅です.
-    unsigned int    m_Height;           //!< 画像の縦幅です.
-    unsigned int    m_BytePerPixel;     //!< 1ピクセルあたりのバイト数です.
-    unsigned int    m_ID;               //!< テクスチャIDです.
-    unsigned char*  m_pImageData;       //!< ピクセルデータです.
-    unsigned int    m_MipmapCount;      //!< ミップマップ数です.
+    unsigned int            m_ImageSize;        //!< ピクセルサイズです.
+    unsigned int            m_Format;           //!< フォーマットです.
+    unsigned int            m_InternalFormat;   //!< 内部フォーマットです.
+    unsigned int            m_Type;             //!< 転送データ型です(非圧縮のみ).
+    unsigned int            m_BlockSize;        //!< 1ブロックあたりのバイト数です(非圧縮の場合は0).
+    unsigned int            m_ConvertType;      //!< 転送時の変換タイプです.
+    unsigned int            m_Width;            //!< 画像の横幅です.
+    unsigned int            m_Height;           //!< 画像の縦幅です.
+    unsigned int            m_Depth;            //!< ボリュームテクスチャの奥行です.
+    unsigned int            m_ArraySize;        //!< テクスチャ配列の要素数です.
+    unsigned int            m_FaceCount;        //!< 面数です(キューブマップの場合は6).
+    unsigned int            m_Target;           //!< GLのテクスチャターゲットです.
+    unsigned int            m_BytePerPixel;     //!< 1ピクセルあたりのバイト数です.
+    unsigned int            m_ID;               //!< テクスチャIDです.
+    const unsigned char*    m_pImageData;       //!< ピクセルデータです(マップされたファイルを指します).
+    unsigned int            m_MipmapCount;      //!< ミップマップ数です.
+    MappedFile              m_File;             //!< メモリマップドファイルです.
+    std::vector<Surface>    m_Surfaces;         //!< ミップレベルごとのサーフェイス情報です.
+    COLOR_SPACE             m_ColorSpace;       //!< 読み込んだ画像の色空間です.
+    COLOR_SPACE             m_ColorSpaceHint;   //!< 色空間のヒントです.
 
     //=======================================================================================
     // protected methods.
     //=======================================================================================
-    void DecompressBC();
+    bool DecompressBC();
+    bool UploadUncompressed();
+    void AllocateStorage( unsigned int internalFormat, unsigned int format, unsigned int type, bool compressed );
+    void UploadSlice( unsigned int mipLevel, unsigned int layer, unsigned int internalFormat, unsigned int format, unsigned int type, const void* pPixels, bool compressed );
+    unsigned int GetSurfaceIndex( unsigned int mipLevel, unsigned int layer ) const;
 
 private:
     //=======================================================================================
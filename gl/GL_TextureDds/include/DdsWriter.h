@@ -0,0 +1,69 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : DdsWriter.h
+// Desc : Direct Draw Surface Texture Writer.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+#ifndef _DDS_WRITER_H_
+#define _DDS_WRITER_H_
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <cstddef>
+#include <BcEncoder.h>
+
+
+//-------------------------------------------------------------------------------------------
+//! @brief      ブロック圧縮済みのデータをDDSファイルに書き出します.
+//!
+//! @param [in]     filename        ファイル名です.
+//! @param [in]     format          ブロック圧縮フォーマットです.
+//! @param [in]     width           最上位ミップの横幅です.
+//! @param [in]     height          最上位ミップの縦幅です.
+//! @param [in]     mipCount        ミップマップ数です.
+//! @param [in]     pData           全ミップを連結した圧縮データです.
+//! @param [in]     size            圧縮データのバイト数です.
+//! @retval true    書き出しに成功.
+//! @retval false   書き出しに失敗.
+//-------------------------------------------------------------------------------------------
+bool SaveDDS(
+    const char*             filename,
+    BC_FORMAT               format,
+    unsigned int            width,
+    unsigned int            height,
+    unsigned int            mipCount,
+    const unsigned char*    pData,
+    size_t                  size );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      画像をミップマップ付きでブロック圧縮し，DDSファイルに書き出します.
+//!
+//! @note       BmpImage, TgaImage, RawImage の GetPixels() をそのまま渡せます.
+//!             BMP, TGA は下から上の行順なので flipVertical に true を指定してください.
+//!
+//! @param [in]     filename        ファイル名です.
+//! @param [in]     pPixels         RGB8 または RGBA8 のピクセルデータです.
+//! @param [in]     width           横幅です.
+//! @param [in]     height          縦幅です.
+//! @param [in]     bytePerPixel    1ピクセルあたりのバイト数(3 または 4)です.
+//! @param [in]     format          ブロック圧縮フォーマットです.
+//! @param [in]     quality         圧縮品質です.
+//! @param [in]     flipVertical    上下反転して書き出す場合は true を指定します.
+//! @param [in]     threadCount     使用するスレッド数です. 0の場合は自動で決定します.
+//! @retval true    書き出しに成功.
+//! @retval false   書き出しに失敗.
+//-------------------------------------------------------------------------------------------
+bool CompressToDDS(
+    const char*             filename,
+    const unsigned char*    pPixels,
+    unsigned int            width,
+    unsigned int            height,
+    unsigned int            bytePerPixel,
+    BC_FORMAT               format,
+    BC_QUALITY              quality      = BC_QUALITY_FAST,
+    bool                    flipVertical = false,
+    unsigned int            threadCount  = 0 );
+
+
+#endif//_DDS_WRITER_H_
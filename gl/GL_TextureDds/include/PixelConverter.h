@@ -0,0 +1,40 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : PixelConverter.h
+// Desc : Pixel Format Conversion Kernels.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+#ifndef _PIXEL_CONVERTER_H_
+#define _PIXEL_CONVERTER_H_
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <cstddef>
+
+
+//-------------------------------------------------------------------------------------------
+//! @brief      半精度浮動小数を単精度浮動小数に変換します.
+//!
+//! @note       GLが GL_HALF_FLOAT の転送に対応していない場合に使用します.
+//!             非正規化数, 無限大, NaN も保持されます.
+//!
+//! @param [in]     pSrc        半精度浮動小数の配列です.
+//! @param [out]    pDst        単精度浮動小数の格納先です.
+//! @param [in]     count       要素数です.
+//-------------------------------------------------------------------------------------------
+void ConvertHalfToFloat( const unsigned short* pSrc, float* pDst, size_t count );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      CxV8U8 (2成分法線) を符号付きRGB8に変換します.
+//!
+//! @note       Z成分は sqrt( 1 - x^2 - y^2 ) で復元します.
+//!
+//! @param [in]     pSrc        CxV8U8 のピクセルデータです.
+//! @param [out]    pDst        符号付きRGB8 (pixelCount * 3 バイト) の格納先です.
+//! @param [in]     pixelCount  ピクセル数です.
+//-------------------------------------------------------------------------------------------
+void ConvertCxV8U8ToRGB8( const unsigned char* pSrc, unsigned char* pDst, size_t pixelCount );
+
+
+#endif//_PIXEL_CONVERTER_H_
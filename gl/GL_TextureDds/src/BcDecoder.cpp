@@ -0,0 +1,565 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : BcDecoder.cpp
+// Desc : Block Compression Decoder.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <BcDecoder.h>
+#include <cstring>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <algorithm>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+    #define BC_ENABLE_SSSE3     1
+    #include <tmmintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+        #define BC_TARGET_SSSE3
+    #else
+        #include <cpuid.h>
+        #define BC_TARGET_SSSE3     __attribute__((target("ssse3")))
+    #endif
+#else
+    #define BC_ENABLE_SSSE3     0
+#endif
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+static const unsigned int   MIN_BLOCK_ROWS_PER_THREAD = 16;     // スレッド1つあたりの最小ブロック行数.
+
+
+//-------------------------------------------------------------------------------------------
+//      リトルエンディアンで16bit値を読み取ります.
+//-------------------------------------------------------------------------------------------
+inline unsigned int ReadU16( const unsigned char* p )
+{ return static_cast<unsigned int>( p[0] ) | ( static_cast<unsigned int>( p[1] ) << 8 ); }
+
+//-------------------------------------------------------------------------------------------
+//      リトルエンディアンで32bit値を読み取ります.
+//-------------------------------------------------------------------------------------------
+inline unsigned int ReadU32( const unsigned char* p )
+{ return ReadU16( p ) | ( ReadU16( p + 2 ) << 16 ); }
+
+//-------------------------------------------------------------------------------------------
+//      RGB565をRGBA8に展開します.
+//-------------------------------------------------------------------------------------------
+inline void ExpandRGB565( unsigned int c, unsigned char* pDst )
+{
+    const unsigned int r = ( c >> 11 ) & 0x1f;
+    const unsigned int g = ( c >>  5 ) & 0x3f;
+    const unsigned int b = ( c       ) & 0x1f;
+
+    pDst[0] = static_cast<unsigned char>( ( r << 3 ) | ( r >> 2 ) );
+    pDst[1] = static_cast<unsigned char>( ( g << 2 ) | ( g >> 4 ) );
+    pDst[2] = static_cast<unsigned char>( ( b << 3 ) | ( b >> 2 ) );
+    pDst[3] = 255;
+}
+
+//-------------------------------------------------------------------------------------------
+//      カラーブロックのパレット(4色 x RGBA8)を求めます.
+//-------------------------------------------------------------------------------------------
+void BuildColorPalette( const unsigned char* pBlock, bool allowTransparent, unsigned char* pPalette )
+{
+    const unsigned int c0 = ReadU16( pBlock + 0 );
+    const unsigned int c1 = ReadU16( pBlock + 2 );
+
+    ExpandRGB565( c0, pPalette + 0 );
+    ExpandRGB565( c1, pPalette + 4 );
+
+    // BC2, BC3では常に4色モードとして扱う.
+    if ( c0 > c1 || !allowTransparent )
+    {
+        for( int i=0; i<3; ++i )
+        {
+            pPalette[ 8 + i] = static_cast<unsigned char>( ( 2 * pPalette[i] + pPalette[4 + i] + 1 ) / 3 );
+            pPalette[12 + i] = static_cast<unsigned char>( ( pPalette[i] + 2 * pPalette[4 + i] + 1 ) / 3 );
+        }
+        pPalette[11] = 255;
+        pPalette[15] = 255;
+    }
+    else
+    {
+        for( int i=0; i<3; ++i )
+        {
+            pPalette[ 8 + i] = static_cast<unsigned char>( ( pPalette[i] + pPalette[4 + i] + 1 ) / 2 );
+            pPalette[12 + i] = 0;
+        }
+        pPalette[11] = 255;
+        pPalette[15] = 0;       // 透明な黒.
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      補間アルファブロックのパレット(8値)と16個のインデックスを求めます.
+//-------------------------------------------------------------------------------------------
+void BuildAlphaPalette( const unsigned char* pBlock, bool isSigned, unsigned char* pPalette, unsigned char* pIndices )
+{
+    if ( isSigned )
+    {
+        // 符号付きは [-127, 127] で補間してから [0, 255] に写像する.
+        int a0 = static_cast<signed char>( pBlock[0] );
+        int a1 = static_cast<signed char>( pBlock[1] );
+        if ( a0 < -127 ) { a0 = -127; }
+        if ( a1 < -127 ) { a1 = -127; }
+
+        float values[8];
+        values[0] = float( a0 );
+        values[1] = float( a1 );
+        if ( a0 > a1 )
+        {
+            for( int i=1; i<7; ++i )
+            { values[1 + i] = ( float( 7 - i ) * a0 + float( i ) * a1 ) / 7.0f; }
+        }
+        else
+        {
+            for( int i=1; i<5; ++i )
+            { values[1 + i] = ( float( 5 - i ) * a0 + float( i ) * a1 ) / 5.0f; }
+            values[6] = -127.0f;
+            values[7] =  127.0f;
+        }
+
+        for( int i=0; i<8; ++i )
+        { pPalette[i] = static_cast<unsigned char>( ( values[i] / 127.0f + 1.0f ) * 127.5f + 0.5f ); }
+    }
+    else
+    {
+        const unsigned int a0 = pBlock[0];
+        const unsigned int a1 = pBlock[1];
+        pPalette[0] = static_cast<unsigned char>( a0 );
+        pPalette[1] = static_cast<unsigned char>( a1 );
+        if ( a0 > a1 )
+        {
+            for( unsigned int i=1; i<7; ++i )
+            { pPalette[1 + i] = static_cast<unsigned char>( ( ( 7 - i ) * a0 + i * a1 + 3 ) / 7 ); }
+        }
+        else
+        {
+            for( unsigned int i=1; i<5; ++i )
+            { pPalette[1 + i] = static_cast<unsigned char>( ( ( 5 - i ) * a0 + i * a1 + 2 ) / 5 ); }
+            pPalette[6] = 0;
+            pPalette[7] = 255;
+        }
+    }
+
+    // 48bitのインデックスを3bitずつ取り出す.
+    const unsigned long long bits =
+          static_cast<unsigned long long>( ReadU16( pBlock + 2 ) )
+        | ( static_cast<unsigned long long>( ReadU16( pBlock + 4 ) ) << 16 )
+        | ( static_cast<unsigned long long>( ReadU16( pBlock + 6 ) ) << 32 );
+
+    for( int i=0; i<16; ++i )
+    { pIndices[i] = static_cast<unsigned char>( ( bits >> ( 3 * i ) ) & 0x7 ); }
+}
+
+//-------------------------------------------------------------------------------------------
+//      カラーブロックを展開します.
+//-------------------------------------------------------------------------------------------
+void DecodeColorBlock( const unsigned char* pBlock, bool allowTransparent, unsigned char* pDst )
+{
+    unsigned char palette[16];
+    BuildColorPalette( pBlock, allowTransparent, palette );
+
+    const unsigned int indices = ReadU32( pBlock + 4 );
+    for( int i=0; i<16; ++i )
+    {
+        const unsigned int idx = ( indices >> ( 2 * i ) ) & 0x3;
+        memcpy( pDst + i * 4, palette + idx * 4, 4 );
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      BC2の明示アルファを展開します.
+//-------------------------------------------------------------------------------------------
+void DecodeExplicitAlpha( const unsigned char* pBlock, unsigned char* pDst )
+{
+    for( int i=0; i<8; ++i )
+    {
+        pDst[ ( i * 2 + 0 ) * 4 + 3 ] = static_cast<unsigned char>( ( pBlock[i] & 0x0f ) * 17 );
+        pDst[ ( i * 2 + 1 ) * 4 + 3 ] = static_cast<unsigned char>( ( pBlock[i] >> 4 ) * 17 );
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      補間アルファブロックを指定チャンネルに展開します.
+//-------------------------------------------------------------------------------------------
+void DecodeAlphaBlock( const unsigned char* pBlock, bool isSigned, int channel, unsigned char* pDst )
+{
+    unsigned char palette[8];
+    unsigned char indices[16];
+    BuildAlphaPalette( pBlock, isSigned, palette, indices );
+
+    for( int i=0; i<16; ++i )
+    { pDst[ i * 4 + channel ] = palette[ indices[i] ]; }
+}
+
+//-------------------------------------------------------------------------------------------
+//      スカラー版で1ブロックを展開します.
+//-------------------------------------------------------------------------------------------
+void DecodeBlockScalar( BC_FORMAT format, const unsigned char* pBlock, unsigned char* pDst )
+{
+    switch( format )
+    {
+    case BC_FORMAT_BC1:
+        { DecodeColorBlock( pBlock, true, pDst ); }
+        break;
+
+    case BC_FORMAT_BC2:
+        {
+            DecodeColorBlock( pBlock + 8, false, pDst );
+            DecodeExplicitAlpha( pBlock, pDst );
+        }
+        break;
+
+    case BC_FORMAT_BC3:
+        {
+            DecodeColorBlock( pBlock + 8, false, pDst );
+            DecodeAlphaBlock( pBlock, false, 3, pDst );
+        }
+        break;
+
+    case BC_FORMAT_BC4U:
+    case BC_FORMAT_BC4S:
+        {
+            for( int i=0; i<16; ++i )
+            {
+                pDst[ i * 4 + 1 ] = 0;
+                pDst[ i * 4 + 2 ] = 0;
+                pDst[ i * 4 + 3 ] = 255;
+            }
+            DecodeAlphaBlock( pBlock, ( format == BC_FORMAT_BC4S ), 0, pDst );
+        }
+        break;
+
+    case BC_FORMAT_BC5U:
+    case BC_FORMAT_BC5S:
+        {
+            for( int i=0; i<16; ++i )
+            {
+                pDst[ i * 4 + 2 ] = 0;
+                pDst[ i * 4 + 3 ] = 255;
+            }
+            DecodeAlphaBlock( pBlock + 0, ( format == BC_FORMAT_BC5S ), 0, pDst );
+            DecodeAlphaBlock( pBlock + 8, ( format == BC_FORMAT_BC5S ), 1, pDst );
+        }
+        break;
+    }
+}
+
+
+#if BC_ENABLE_SSSE3
+
+//-------------------------------------------------------------------------------------------
+// Shuffle Tables
+//-------------------------------------------------------------------------------------------
+unsigned char   g_ColorShuffle[ 256 ][ 16 ];        // 4ピクセル分の2bitインデックス → パレット参照用マスク.
+unsigned char   g_SpreadShuffle[ 4 ][ 4 ][ 16 ];    // 16個の値 → 指定チャンネル/行への配置用マスク.
+unsigned char   g_ChannelMask[ 4 ][ 16 ];           // 指定チャンネルのバイトのみ0xffとなるマスク.
+std::once_flag  g_TableFlag;
+
+//-------------------------------------------------------------------------------------------
+//      シャッフルテーブルを初期化します.
+//-------------------------------------------------------------------------------------------
+void InitShuffleTables()
+{
+    for( int bits=0; bits<256; ++bits )
+    {
+        for( int j=0; j<4; ++j )
+        {
+            const int idx = ( bits >> ( 2 * j ) ) & 0x3;
+            for( int c=0; c<4; ++c )
+            { g_ColorShuffle[ bits ][ j * 4 + c ] = static_cast<unsigned char>( idx * 4 + c ); }
+        }
+    }
+
+    for( int c=0; c<4; ++c )
+    {
+        for( int j=0; j<16; ++j )
+        { g_ChannelMask[ c ][ j ] = ( ( j % 4 ) == c ) ? 0xff : 0x00; }
+
+        for( int r=0; r<4; ++r )
+        {
+            for( int j=0; j<16; ++j )
+            {
+                g_SpreadShuffle[ c ][ r ][ j ] = ( ( j % 4 ) == c )
+                    ? static_cast<unsigned char>( r * 4 + j / 4 )
+                    : 0x80;
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      SSSE3が使用可能かどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsSupportSSSE3()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid( info, 1 );
+    return ( info[2] & ( 1 << 9 ) ) != 0;
+#else
+    unsigned int a, b, c, d;
+    if ( !__get_cpuid( 1, &a, &b, &c, &d ) )
+    { return false; }
+    return ( c & bit_SSSE3 ) != 0;
+#endif
+}
+
+//-------------------------------------------------------------------------------------------
+//      カラーブロックを4行分のレジスタに展開します.
+//-------------------------------------------------------------------------------------------
+BC_TARGET_SSSE3
+void DecodeColorRowsSSSE3( const unsigned char* pBlock, bool allowTransparent, __m128i* pRows )
+{
+    unsigned char palette[16];
+    BuildColorPalette( pBlock, allowTransparent, palette );
+
+    const __m128i      pal     = _mm_loadu_si128( reinterpret_cast<const __m128i*>( palette ) );
+    const unsigned int indices = ReadU32( pBlock + 4 );
+
+    // 1行(4ピクセル)の8bitインデックスからマスクを引いてパレットをシャッフルする.
+    for( int r=0; r<4; ++r )
+    {
+        const unsigned int bits = ( indices >> ( 8 * r ) ) & 0xff;
+        const __m128i      mask = _mm_loadu_si128( reinterpret_cast<const __m128i*>( g_ColorShuffle[ bits ] ) );
+        pRows[r] = _mm_shuffle_epi8( pal, mask );
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      補間アルファブロックを4行分のレジスタの指定チャンネルに展開します.
+//-------------------------------------------------------------------------------------------
+BC_TARGET_SSSE3
+void DecodeAlphaRowsSSSE3( const unsigned char* pBlock, bool isSigned, int channel, __m128i* pRows )
+{
+    unsigned char palette[16] = { 0 };
+    unsigned char indices[16];
+    BuildAlphaPalette( pBlock, isSigned, palette, indices );
+
+    // 16ピクセル分の値を一度に引く.
+    const __m128i values = _mm_shuffle_epi8(
+        _mm_loadu_si128( reinterpret_cast<const __m128i*>( palette ) ),
+        _mm_loadu_si128( reinterpret_cast<const __m128i*>( indices ) ) );
+
+    const __m128i keep = _mm_loadu_si128( reinterpret_cast<const __m128i*>( g_ChannelMask[ channel ] ) );
+    for( int r=0; r<4; ++r )
+    {
+        const __m128i mask   = _mm_loadu_si128( reinterpret_cast<const __m128i*>( g_SpreadShuffle[ channel ][ r ] ) );
+        const __m128i spread = _mm_shuffle_epi8( values, mask );
+        pRows[r] = _mm_or_si128( _mm_andnot_si128( keep, pRows[r] ), spread );
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      SSSE3版で1ブロックを展開します.
+//-------------------------------------------------------------------------------------------
+BC_TARGET_SSSE3
+void DecodeBlockSSSE3( BC_FORMAT format, const unsigned char* pBlock, unsigned char* pDst )
+{
+    __m128i rows[4];
+
+    switch( format )
+    {
+    case BC_FORMAT_BC1:
+        { DecodeColorRowsSSSE3( pBlock, true, rows ); }
+        break;
+
+    case BC_FORMAT_BC2:
+        { DecodeColorRowsSSSE3( pBlock + 8, false, rows ); }
+        break;
+
+    case BC_FORMAT_BC3:
+        {
+            DecodeColorRowsSSSE3( pBlock + 8, false, rows );
+            DecodeAlphaRowsSSSE3( pBlock, false, 3, rows );
+        }
+        break;
+
+    case BC_FORMAT_BC4U:
+    case BC_FORMAT_BC4S:
+        {
+            rows[0] = rows[1] = rows[2] = rows[3] = _mm_set1_epi32( int( 0xff000000 ) );
+            DecodeAlphaRowsSSSE3( pBlock, ( format == BC_FORMAT_BC4S ), 0, rows );
+        }
+        break;
+
+    case BC_FORMAT_BC5U:
+    case BC_FORMAT_BC5S:
+        {
+            rows[0] = rows[1] = rows[2] = rows[3] = _mm_set1_epi32( int( 0xff000000 ) );
+            DecodeAlphaRowsSSSE3( pBlock + 0, ( format == BC_FORMAT_BC5S ), 0, rows );
+            DecodeAlphaRowsSSSE3( pBlock + 8, ( format == BC_FORMAT_BC5S ), 1, rows );
+        }
+        break;
+    }
+
+    for( int r=0; r<4; ++r )
+    { _mm_storeu_si128( reinterpret_cast<__m128i*>( pDst + r * 16 ), rows[r] ); }
+
+    // BC2の4bitアルファはスカラーで上書きする.
+    if ( format == BC_FORMAT_BC2 )
+    { DecodeExplicitAlpha( pBlock, pDst ); }
+}
+
+#endif//BC_ENABLE_SSSE3
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// DecodeContext structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct DecodeContext
+{
+    BC_FORMAT               format;         //!< フォーマットです.
+    bool                    useSimd;        //!< SIMD版を使用するかどうか.
+    const unsigned char*    pSrc;           //!< 圧縮データです.
+    unsigned char*          pDst;           //!< 出力先です.
+    unsigned int            width;          //!< 横幅です.
+    unsigned int            height;         //!< 縦幅です.
+    unsigned int            blockSize;      //!< 1ブロックあたりのバイト数です.
+    unsigned int            blockCountX;    //!< 横方向のブロック数です.
+};
+
+//-------------------------------------------------------------------------------------------
+//      指定範囲のブロック行を展開します.
+//-------------------------------------------------------------------------------------------
+void DecodeBlockRows( const DecodeContext& ctx, unsigned int beginRow, unsigned int endRow )
+{
+    unsigned char block[64];
+
+    for( unsigned int by=beginRow; by<endRow; ++by )
+    {
+        const unsigned int y     = by * 4;
+        const unsigned int lines = ( ctx.height - y < 4 ) ? ( ctx.height - y ) : 4;
+
+        for( unsigned int bx=0; bx<ctx.blockCountX; ++bx )
+        {
+            const unsigned char* pBlock = ctx.pSrc + ( size_t( by ) * ctx.blockCountX + bx ) * ctx.blockSize;
+
+        #if BC_ENABLE_SSSE3
+            if ( ctx.useSimd )
+            { DecodeBlockSSSE3( ctx.format, pBlock, block ); }
+            else
+        #endif
+            { DecodeBlockScalar( ctx.format, pBlock, block ); }
+
+            // 画像端でクリップしながら書き出す.
+            const unsigned int x      = bx * 4;
+            const unsigned int pixels = ( ctx.width - x < 4 ) ? ( ctx.width - x ) : 4;
+            for( unsigned int r=0; r<lines; ++r )
+            {
+                memcpy(
+                    ctx.pDst + ( size_t( y + r ) * ctx.width + x ) * 4,
+                    block + r * 16,
+                    pixels * 4 );
+            }
+        }
+    }
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------
+//      1ブロックあたりのバイト数を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int GetBCBlockSize( BC_FORMAT format )
+{
+    switch( format )
+    {
+    case BC_FORMAT_BC1:
+    case BC_FORMAT_BC4U:
+    case BC_FORMAT_BC4S:
+        return 8;
+
+    default:
+        break;
+    }
+
+    return 16;
+}
+
+//-------------------------------------------------------------------------------------------
+//      1ブロックをRGBA8に展開します.
+//-------------------------------------------------------------------------------------------
+void DecodeBCBlock( BC_FORMAT format, const unsigned char* pBlock, unsigned char* pDst )
+{ DecodeBlockScalar( format, pBlock, pDst ); }
+
+//-------------------------------------------------------------------------------------------
+//      ブロック圧縮されたサーフェイスをRGBA8に展開します.
+//-------------------------------------------------------------------------------------------
+void DecodeBC
+(
+    BC_FORMAT               format,
+    const unsigned char*    pSrc,
+    unsigned int            width,
+    unsigned int            height,
+    unsigned char*          pDst,
+    unsigned int            threadCount
+)
+{
+    if ( pSrc == nullptr || pDst == nullptr || width == 0 || height == 0 )
+    { return; }
+
+    DecodeContext ctx;
+    ctx.format      = format;
+    ctx.useSimd     = false;
+    ctx.pSrc        = pSrc;
+    ctx.pDst        = pDst;
+    ctx.width       = width;
+    ctx.height      = height;
+    ctx.blockSize   = GetBCBlockSize( format );
+    ctx.blockCountX = ( width + 3 ) / 4;
+
+#if BC_ENABLE_SSSE3
+    static const bool isSupportSSSE3 = IsSupportSSSE3();
+    if ( isSupportSSSE3 )
+    {
+        std::call_once( g_TableFlag, InitShuffleTables );
+        ctx.useSimd = true;
+    }
+#endif
+
+    const unsigned int blockCountY = ( height + 3 ) / 4;
+
+    if ( threadCount == 0 )
+    { threadCount = std::thread::hardware_concurrency(); }
+
+    // 小さなミップレベルではスレッド生成のコストの方が大きいので分割しない.
+    unsigned int maxThreads = blockCountY / MIN_BLOCK_ROWS_PER_THREAD;
+    if ( threadCount > maxThreads ) { threadCount = maxThreads; }
+    if ( threadCount < 1 )          { threadCount = 1; }
+
+    if ( threadCount == 1 )
+    {
+        DecodeBlockRows( ctx, 0, blockCountY );
+        return;
+    }
+
+    // ブロック行を均等に分割して展開する. 最後の区間は呼び出しスレッドが担当する.
+    // 切り上げた行数で分割するので，途中で全ての行を割り当て終わる場合がある.
+    std::vector<std::thread> threads;
+    threads.reserve( threadCount - 1 );
+
+    const unsigned int rowsPerThread = ( blockCountY + threadCount - 1 ) / threadCount;
+    unsigned int begin = 0;
+    for( unsigned int i=0; i<threadCount - 1 && begin < blockCountY; ++i )
+    {
+        const unsigned int end = std::min( begin + rowsPerThread, blockCountY );
+        threads.push_back( std::thread( DecodeBlockRows, std::cref( ctx ), begin, end ) );
+        begin = end;
+    }
+
+    DecodeBlockRows( ctx, begin, blockCountY );
+
+    for( size_t i=0; i<threads.size(); ++i )
+    { threads[i].join(); }
+}
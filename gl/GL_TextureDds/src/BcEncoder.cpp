@@ -0,0 +1,715 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : BcEncoder.cpp
+// Desc : Block Compression Encoder.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <BcEncoder.h>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+static const unsigned int   MIN_BLOCK_ROWS_PER_THREAD = 4;      // スレッド1つあたりの最小ブロック行数.
+static const unsigned int   ALPHA_THRESHOLD           = 128;    // BC1で透明とみなすアルファ値.
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// ColorPoint structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct ColorPoint
+{
+    float   rgb[3];     //!< 色です.
+    float   t;          //!< 主軸上の射影値です.
+
+    bool operator < ( const ColorPoint& value ) const
+    { return t < value.t; }
+};
+
+
+//-------------------------------------------------------------------------------------------
+//      リトルエンディアンで16bit値を書き込みます.
+//-------------------------------------------------------------------------------------------
+inline void WriteU16( unsigned char* p, unsigned int value )
+{
+    p[0] = static_cast<unsigned char>( value & 0xff );
+    p[1] = static_cast<unsigned char>( ( value >> 8 ) & 0xff );
+}
+
+//-------------------------------------------------------------------------------------------
+//      リトルエンディアンで32bit値を書き込みます.
+//-------------------------------------------------------------------------------------------
+inline void WriteU32( unsigned char* p, unsigned int value )
+{
+    WriteU16( p + 0, value & 0xffff );
+    WriteU16( p + 2, value >> 16 );
+}
+
+//-------------------------------------------------------------------------------------------
+//      値を [0, 255] にクランプします.
+//-------------------------------------------------------------------------------------------
+inline float Saturate255( float value )
+{
+    if ( value < 0.0f )   { return 0.0f; }
+    if ( value > 255.0f ) { return 255.0f; }
+    return value;
+}
+
+//-------------------------------------------------------------------------------------------
+//      RGBをRGB565に量子化します.
+//-------------------------------------------------------------------------------------------
+inline unsigned int PackRGB565( const float* rgb )
+{
+    const unsigned int r = static_cast<unsigned int>( Saturate255( rgb[0] ) * 31.0f / 255.0f + 0.5f );
+    const unsigned int g = static_cast<unsigned int>( Saturate255( rgb[1] ) * 63.0f / 255.0f + 0.5f );
+    const unsigned int b = static_cast<unsigned int>( Saturate255( rgb[2] ) * 31.0f / 255.0f + 0.5f );
+    return ( r << 11 ) | ( g << 5 ) | b;
+}
+
+//-------------------------------------------------------------------------------------------
+//      RGB565を展開します.
+//-------------------------------------------------------------------------------------------
+inline void UnpackRGB565( unsigned int c, int* rgb )
+{
+    const int r = ( c >> 11 ) & 0x1f;
+    const int g = ( c >>  5 ) & 0x3f;
+    const int b = ( c       ) & 0x1f;
+    rgb[0] = ( r << 3 ) | ( r >> 2 );
+    rgb[1] = ( g << 2 ) | ( g >> 4 );
+    rgb[2] = ( b << 3 ) | ( b >> 2 );
+}
+
+//-------------------------------------------------------------------------------------------
+//      デコーダと同じ計算でカラーパレットを求めます.
+//-------------------------------------------------------------------------------------------
+void BuildColorPalette( unsigned int c0, unsigned int c1, bool fourColor, int palette[4][3] )
+{
+    UnpackRGB565( c0, palette[0] );
+    UnpackRGB565( c1, palette[1] );
+
+    for( int i=0; i<3; ++i )
+    {
+        if ( fourColor )
+        {
+            palette[2][i] = ( 2 * palette[0][i] + palette[1][i] + 1 ) / 3;
+            palette[3][i] = ( palette[0][i] + 2 * palette[1][i] + 1 ) / 3;
+        }
+        else
+        {
+            palette[2][i] = ( palette[0][i] + palette[1][i] + 1 ) / 2;
+            palette[3][i] = 0;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      各ピクセルに最も近いパレット番号を割り当て，二乗誤差を返却します.
+//-------------------------------------------------------------------------------------------
+unsigned int AssignColorIndices
+(
+    const unsigned char*    pSrc,
+    unsigned int            c0,
+    unsigned int            c1,
+    bool                    fourColor,
+    bool                    hasTransparent,
+    unsigned int&           indices
+)
+{
+    int palette[4][3];
+    BuildColorPalette( c0, c1, fourColor, palette );
+
+    const int    count = fourColor ? 4 : 3;
+    unsigned int error = 0;
+    indices = 0;
+
+    for( int i=0; i<16; ++i )
+    {
+        const unsigned char* p = pSrc + i * 4;
+
+        // 透明ピクセルは3番(透明な黒)に割り当てる.
+        if ( hasTransparent && p[3] < ALPHA_THRESHOLD )
+        {
+            indices |= ( 3u << ( 2 * i ) );
+            continue;
+        }
+
+        unsigned int bestError = ~0u;
+        unsigned int bestIndex = 0;
+        for( int j=0; j<count; ++j )
+        {
+            const int dr = palette[j][0] - p[0];
+            const int dg = palette[j][1] - p[1];
+            const int db = palette[j][2] - p[2];
+            const unsigned int e = static_cast<unsigned int>( dr * dr + dg * dg + db * db );
+            if ( e < bestError )
+            {
+                bestError = e;
+                bestIndex = j;
+            }
+        }
+
+        indices |= ( bestIndex << ( 2 * i ) );
+        error   += bestError;
+    }
+
+    return error;
+}
+
+//-------------------------------------------------------------------------------------------
+//      点群の主軸を求めます.
+//-------------------------------------------------------------------------------------------
+void ComputePrincipalAxis( const ColorPoint* points, int count, float* mean, float* axis )
+{
+    mean[0] = mean[1] = mean[2] = 0.0f;
+    for( int i=0; i<count; ++i )
+    {
+        mean[0] += points[i].rgb[0];
+        mean[1] += points[i].rgb[1];
+        mean[2] += points[i].rgb[2];
+    }
+    mean[0] /= count;
+    mean[1] /= count;
+    mean[2] /= count;
+
+    // 共分散行列(対称なので6要素).
+    float cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    for( int i=0; i<count; ++i )
+    {
+        const float r = points[i].rgb[0] - mean[0];
+        const float g = points[i].rgb[1] - mean[1];
+        const float b = points[i].rgb[2] - mean[2];
+        cov[0] += r * r;
+        cov[1] += r * g;
+        cov[2] += r * b;
+        cov[3] += g * g;
+        cov[4] += g * b;
+        cov[5] += b * b;
+    }
+
+    // べき乗法で最大固有ベクトルを求める.
+    float v[3] = { 1.0f, 1.0f, 1.0f };
+    for( int iter=0; iter<8; ++iter )
+    {
+        const float x = cov[0] * v[0] + cov[1] * v[1] + cov[2] * v[2];
+        const float y = cov[1] * v[0] + cov[3] * v[1] + cov[4] * v[2];
+        const float z = cov[2] * v[0] + cov[4] * v[1] + cov[5] * v[2];
+
+        float m = std::max( fabsf( x ), std::max( fabsf( y ), fabsf( z ) ) );
+        if ( m <= 0.0f )
+        { break; }
+
+        v[0] = x / m;
+        v[1] = y / m;
+        v[2] = z / m;
+    }
+
+    const float len = sqrtf( v[0] * v[0] + v[1] * v[1] + v[2] * v[2] );
+    axis[0] = v[0] / len;
+    axis[1] = v[1] / len;
+    axis[2] = v[2] / len;
+}
+
+//-------------------------------------------------------------------------------------------
+//      レンジフィットで端点を求めます.
+//-------------------------------------------------------------------------------------------
+void RangeFit( ColorPoint* points, int count, float* start, float* end )
+{
+    float mean[3];
+    float axis[3];
+    ComputePrincipalAxis( points, count, mean, axis );
+
+    float minT =  3.402823466e+38F;
+    float maxT = -3.402823466e+38F;
+    for( int i=0; i<count; ++i )
+    {
+        points[i].t = ( points[i].rgb[0] - mean[0] ) * axis[0]
+                    + ( points[i].rgb[1] - mean[1] ) * axis[1]
+                    + ( points[i].rgb[2] - mean[2] ) * axis[2];
+        minT = std::min( minT, points[i].t );
+        maxT = std::max( maxT, points[i].t );
+    }
+
+    for( int i=0; i<3; ++i )
+    {
+        start[i] = Saturate255( mean[i] + axis[i] * maxT );
+        end  [i] = Saturate255( mean[i] + axis[i] * minT );
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      クラスタフィットで端点を求めます.
+//-------------------------------------------------------------------------------------------
+void ClusterFit( ColorPoint* points, int count, float* start, float* end )
+{
+    // 主軸上の射影値で整列. (RangeFit()で射影値を計算済み.)
+    RangeFit( points, count, start, end );
+    std::sort( points, points + count );
+
+    // 累積和.
+    float prefix[17][3];
+    prefix[0][0] = prefix[0][1] = prefix[0][2] = 0.0f;
+    for( int i=0; i<count; ++i )
+    {
+        for( int c=0; c<3; ++c )
+        { prefix[i + 1][c] = prefix[i][c] + points[i].rgb[c]; }
+    }
+
+    float sumSq = 0.0f;
+    for( int i=0; i<count; ++i )
+    {
+        sumSq += points[i].rgb[0] * points[i].rgb[0]
+               + points[i].rgb[1] * points[i].rgb[1]
+               + points[i].rgb[2] * points[i].rgb[2];
+    }
+
+    float bestError = 3.402823466e+38F;
+
+    // 整列済みの点を 重み 1, 2/3, 1/3, 0 の4クラスタに分ける全ての分割を評価する.
+    for( int i=0; i<=count; ++i )
+    {
+        for( int j=i; j<=count; ++j )
+        {
+            for( int k=j; k<=count; ++k )
+            {
+                const float n0 = float( i );
+                const float n1 = float( j - i );
+                const float n2 = float( k - j );
+                const float n3 = float( count - k );
+
+                const float aa = n0 + n1 * ( 4.0f / 9.0f ) + n2 * ( 1.0f / 9.0f );
+                const float ab = ( n1 + n2 ) * ( 2.0f / 9.0f );
+                const float bb = n1 * ( 1.0f / 9.0f ) + n2 * ( 4.0f / 9.0f ) + n3;
+
+                const float det = aa * bb - ab * ab;
+                if ( fabsf( det ) < 1e-6f )
+                { continue; }
+
+                float ax[3];
+                float bx[3];
+                float a [3];
+                float b [3];
+                for( int c=0; c<3; ++c )
+                {
+                    ax[c] = prefix[i][c]
+                          + ( prefix[j][c] - prefix[i][c] ) * ( 2.0f / 3.0f )
+                          + ( prefix[k][c] - prefix[j][c] ) * ( 1.0f / 3.0f );
+                    bx[c] = prefix[count][c] - ax[c];
+
+                    a[c] = Saturate255( ( ax[c] * bb - bx[c] * ab ) / det );
+                    b[c] = Saturate255( ( bx[c] * aa - ax[c] * ab ) / det );
+                }
+
+                // 二乗誤差 = Σ|x|^2 - 2(a・Σαx + b・Σβx) + aa|a|^2 + 2ab(a・b) + bb|b|^2
+                float error = sumSq;
+                for( int c=0; c<3; ++c )
+                {
+                    error += -2.0f * ( a[c] * ax[c] + b[c] * bx[c] )
+                           + aa * a[c] * a[c]
+                           + 2.0f * ab * a[c] * b[c]
+                           + bb * b[c] * b[c];
+                }
+
+                if ( error < bestError )
+                {
+                    bestError = error;
+                    memcpy( start, a, sizeof(float) * 3 );
+                    memcpy( end,   b, sizeof(float) * 3 );
+                }
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      端点から4色モードのブロックを求めます.
+//-------------------------------------------------------------------------------------------
+unsigned int FitFourColor
+(
+    const unsigned char*    pSrc,
+    const float*            start,
+    const float*            end,
+    unsigned int&           c0,
+    unsigned int&           c1,
+    unsigned int&           indices
+)
+{
+    c0 = PackRGB565( start );
+    c1 = PackRGB565( end );
+
+    // 4色モードは c0 > c1 が条件.
+    if ( c0 < c1 )
+    { std::swap( c0, c1 ); }
+
+    // 単色の場合は3色モードになるが，0番に全て割り当てるので問題ない.
+    return AssignColorIndices( pSrc, c0, c1, ( c0 > c1 ), false, indices );
+}
+
+//-------------------------------------------------------------------------------------------
+//      カラーブロックを圧縮します.
+//-------------------------------------------------------------------------------------------
+void EncodeColorBlock( const unsigned char* pSrc, bool allowTransparent, BC_QUALITY quality, unsigned char* pDst )
+{
+    ColorPoint points[16];
+    int  count          = 0;
+    bool hasTransparent = false;
+
+    for( int i=0; i<16; ++i )
+    {
+        const unsigned char* p = pSrc + i * 4;
+        if ( allowTransparent && p[3] < ALPHA_THRESHOLD )
+        {
+            hasTransparent = true;
+            continue;
+        }
+
+        points[count].rgb[0] = p[0];
+        points[count].rgb[1] = p[1];
+        points[count].rgb[2] = p[2];
+        points[count].t      = 0.0f;
+        count++;
+    }
+
+    unsigned int c0      = 0;
+    unsigned int c1      = 0;
+    unsigned int indices = 0xffffffff;
+
+    if ( count > 0 )
+    {
+        float start[3];
+        float end  [3];
+        RangeFit( points, count, start, end );
+
+        if ( hasTransparent )
+        {
+            // 透明ピクセルを含む場合は3色モード (c0 <= c1) を使う.
+            c0 = PackRGB565( start );
+            c1 = PackRGB565( end );
+            if ( c0 > c1 )
+            { std::swap( c0, c1 ); }
+
+            AssignColorIndices( pSrc, c0, c1, false, true, indices );
+        }
+        else
+        {
+            unsigned int error = FitFourColor( pSrc, start, end, c0, c1, indices );
+
+            if ( quality == BC_QUALITY_HIGH && error > 0 )
+            {
+                ClusterFit( points, count, start, end );
+
+                unsigned int cc0, cc1, cIndices;
+                unsigned int cError = FitFourColor( pSrc, start, end, cc0, cc1, cIndices );
+
+                // 量子化後の誤差で良い方を採用する.
+                if ( cError < error )
+                {
+                    c0      = cc0;
+                    c1      = cc1;
+                    indices = cIndices;
+                }
+            }
+        }
+    }
+
+    WriteU16( pDst + 0, c0 );
+    WriteU16( pDst + 2, c1 );
+    WriteU32( pDst + 4, indices );
+}
+
+//-------------------------------------------------------------------------------------------
+//      デコーダと同じ計算でアルファパレットを求めます.
+//-------------------------------------------------------------------------------------------
+void BuildAlphaPalette( unsigned int a0, unsigned int a1, int* palette )
+{
+    palette[0] = a0;
+    palette[1] = a1;
+    if ( a0 > a1 )
+    {
+        for( unsigned int i=1; i<7; ++i )
+        { palette[1 + i] = ( ( 7 - i ) * a0 + i * a1 + 3 ) / 7; }
+    }
+    else
+    {
+        for( unsigned int i=1; i<5; ++i )
+        { palette[1 + i] = ( ( 5 - i ) * a0 + i * a1 + 2 ) / 5; }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      各値に最も近いパレット番号を割り当て，二乗誤差を返却します.
+//-------------------------------------------------------------------------------------------
+unsigned int AssignAlphaIndices( const int* values, unsigned int a0, unsigned int a1, unsigned long long& indices )
+{
+    int palette[8];
+    BuildAlphaPalette( a0, a1, palette );
+
+    unsigned int error = 0;
+    indices = 0;
+
+    for( int i=0; i<16; ++i )
+    {
+        unsigned int bestError = ~0u;
+        unsigned int bestIndex = 0;
+        for( unsigned int j=0; j<8; ++j )
+        {
+            const int d = palette[j] - values[i];
+            const unsigned int e = static_cast<unsigned int>( d * d );
+            if ( e < bestError )
+            {
+                bestError = e;
+                bestIndex = j;
+            }
+        }
+
+        indices |= ( static_cast<unsigned long long>( bestIndex ) << ( 3 * i ) );
+        error   += bestError;
+    }
+
+    return error;
+}
+
+//-------------------------------------------------------------------------------------------
+//      指定チャンネルを補間アルファブロックとして圧縮します.
+//-------------------------------------------------------------------------------------------
+void EncodeAlphaBlock( const unsigned char* pSrc, int channel, BC_QUALITY quality, unsigned char* pDst )
+{
+    int values[16];
+    int minValue = 255;
+    int maxValue = 0;
+
+    for( int i=0; i<16; ++i )
+    {
+        values[i] = pSrc[ i * 4 + channel ];
+        minValue  = std::min( minValue, values[i] );
+        maxValue  = std::max( maxValue, values[i] );
+    }
+
+    // 8値モード (a0 > a1).
+    unsigned int       a0 = maxValue;
+    unsigned int       a1 = minValue;
+    unsigned long long indices;
+    unsigned int       error = AssignAlphaIndices( values, a0, a1, indices );
+
+    if ( quality == BC_QUALITY_HIGH && error > 0 )
+    {
+        // 0と255を除いた範囲で6値モード (a0 <= a1) を試す.
+        int innerMin = 255;
+        int innerMax = 0;
+        for( int i=0; i<16; ++i )
+        {
+            if ( values[i] == 0 || values[i] == 255 )
+            { continue; }
+
+            innerMin = std::min( innerMin, values[i] );
+            innerMax = std::max( innerMax, values[i] );
+        }
+
+        if ( innerMin <= innerMax )
+        {
+            unsigned long long indices6;
+            unsigned int error6 = AssignAlphaIndices( values, innerMin, innerMax, indices6 );
+            if ( error6 < error )
+            {
+                a0      = innerMin;
+                a1      = innerMax;
+                indices = indices6;
+                error   = error6;
+            }
+        }
+    }
+
+    pDst[0] = static_cast<unsigned char>( a0 );
+    pDst[1] = static_cast<unsigned char>( a1 );
+    for( int i=0; i<6; ++i )
+    { pDst[2 + i] = static_cast<unsigned char>( ( indices >> ( 8 * i ) ) & 0xff ); }
+}
+
+//-------------------------------------------------------------------------------------------
+//      BC2の明示アルファを圧縮します.
+//-------------------------------------------------------------------------------------------
+void EncodeExplicitAlpha( const unsigned char* pSrc, unsigned char* pDst )
+{
+    for( int i=0; i<8; ++i )
+    {
+        const unsigned int lo = ( pSrc[ ( i * 2 + 0 ) * 4 + 3 ] * 15 + 127 ) / 255;
+        const unsigned int hi = ( pSrc[ ( i * 2 + 1 ) * 4 + 3 ] * 15 + 127 ) / 255;
+        pDst[i] = static_cast<unsigned char>( lo | ( hi << 4 ) );
+    }
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// EncodeContext structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct EncodeContext
+{
+    BC_FORMAT               format;         //!< フォーマットです.
+    BC_QUALITY              quality;        //!< 圧縮品質です.
+    const unsigned char*    pSrc;           //!< RGBA8の入力です.
+    unsigned char*          pDst;           //!< 出力先です.
+    unsigned int            width;          //!< 横幅です.
+    unsigned int            height;         //!< 縦幅です.
+    unsigned int            blockSize;      //!< 1ブロックあたりのバイト数です.
+    unsigned int            blockCountX;    //!< 横方向のブロック数です.
+};
+
+//-------------------------------------------------------------------------------------------
+//      指定範囲のブロック行を圧縮します.
+//-------------------------------------------------------------------------------------------
+void EncodeBlockRows( const EncodeContext& ctx, unsigned int beginRow, unsigned int endRow )
+{
+    unsigned char block[64];
+
+    for( unsigned int by=beginRow; by<endRow; ++by )
+    {
+        for( unsigned int bx=0; bx<ctx.blockCountX; ++bx )
+        {
+            // 画像端は最後のピクセルを複製して4x4を埋める.
+            for( unsigned int r=0; r<4; ++r )
+            {
+                const unsigned int y = std::min( by * 4 + r, ctx.height - 1 );
+                for( unsigned int c=0; c<4; ++c )
+                {
+                    const unsigned int x = std::min( bx * 4 + c, ctx.width - 1 );
+                    memcpy( block + ( r * 4 + c ) * 4, ctx.pSrc + ( size_t( y ) * ctx.width + x ) * 4, 4 );
+                }
+            }
+
+            EncodeBCBlock(
+                ctx.format,
+                block,
+                ctx.quality,
+                ctx.pDst + ( size_t( by ) * ctx.blockCountX + bx ) * ctx.blockSize );
+        }
+    }
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------
+//      サーフェイスの圧縮後のバイト数を取得します.
+//-------------------------------------------------------------------------------------------
+size_t GetBCSurfaceSize( BC_FORMAT format, unsigned int width, unsigned int height )
+{ return size_t( ( width + 3 ) / 4 ) * size_t( ( height + 3 ) / 4 ) * GetBCBlockSize( format ); }
+
+//-------------------------------------------------------------------------------------------
+//      4x4ピクセルのRGBA8を1ブロックに圧縮します.
+//-------------------------------------------------------------------------------------------
+bool EncodeBCBlock( BC_FORMAT format, const unsigned char* pSrc, BC_QUALITY quality, unsigned char* pBlock )
+{
+    switch( format )
+    {
+    case BC_FORMAT_BC1:
+        { EncodeColorBlock( pSrc, true, quality, pBlock ); }
+        return true;
+
+    case BC_FORMAT_BC2:
+        {
+            EncodeExplicitAlpha( pSrc, pBlock );
+            EncodeColorBlock( pSrc, false, quality, pBlock + 8 );
+        }
+        return true;
+
+    case BC_FORMAT_BC3:
+        {
+            EncodeAlphaBlock( pSrc, 3, quality, pBlock );
+            EncodeColorBlock( pSrc, false, quality, pBlock + 8 );
+        }
+        return true;
+
+    case BC_FORMAT_BC4U:
+        { EncodeAlphaBlock( pSrc, 0, quality, pBlock ); }
+        return true;
+
+    case BC_FORMAT_BC5U:
+        {
+            EncodeAlphaBlock( pSrc, 0, quality, pBlock + 0 );
+            EncodeAlphaBlock( pSrc, 1, quality, pBlock + 8 );
+        }
+        return true;
+
+    default:
+        break;
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------
+//      RGBA8のサーフェイスをブロック圧縮します.
+//-------------------------------------------------------------------------------------------
+bool EncodeBC
+(
+    BC_FORMAT               format,
+    const unsigned char*    pSrc,
+    unsigned int            width,
+    unsigned int            height,
+    unsigned char*          pDst,
+    BC_QUALITY              quality,
+    unsigned int            threadCount
+)
+{
+    if ( pSrc == nullptr || pDst == nullptr || width == 0 || height == 0 )
+    { return false; }
+
+    if ( format == BC_FORMAT_BC4S || format == BC_FORMAT_BC5S )
+    { return false; }
+
+    EncodeContext ctx;
+    ctx.format      = format;
+    ctx.quality     = quality;
+    ctx.pSrc        = pSrc;
+    ctx.pDst        = pDst;
+    ctx.width       = width;
+    ctx.height      = height;
+    ctx.blockSize   = GetBCBlockSize( format );
+    ctx.blockCountX = ( width + 3 ) / 4;
+
+    const unsigned int blockCountY = ( height + 3 ) / 4;
+
+    if ( threadCount == 0 )
+    { threadCount = std::thread::hardware_concurrency(); }
+
+    unsigned int maxThreads = blockCountY / MIN_BLOCK_ROWS_PER_THREAD;
+    if ( threadCount > maxThreads ) { threadCount = maxThreads; }
+    if ( threadCount < 1 )          { threadCount = 1; }
+
+    if ( threadCount == 1 )
+    {
+        EncodeBlockRows( ctx, 0, blockCountY );
+        return true;
+    }
+
+    // ブロック行を均等に分割して圧縮する. 最後の区間は呼び出しスレッドが担当する.
+    std::vector<std::thread> threads;
+    threads.reserve( threadCount - 1 );
+
+    const unsigned int rowsPerThread = ( blockCountY + threadCount - 1 ) / threadCount;
+    unsigned int begin = 0;
+    for( unsigned int i=0; i<threadCount - 1; ++i )
+    {
+        const unsigned int end = std::min( begin + rowsPerThread, blockCountY );
+        threads.push_back( std::thread( EncodeBlockRows, std::cref( ctx ), begin, end ) );
+        begin = end;
+    }
+
+    EncodeBlockRows( ctx, begin, blockCountY );
+
+    for( size_t i=0; i<threads.size(); ++i )
+    { threads[i].join(); }
+
+    return true;
+}
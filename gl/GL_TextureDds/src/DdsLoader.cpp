@@ -9,7 +9,10 @@
 //-------------------------------------------------------------------------------------------
 #include <iostream>
 #include <fstream>
+#include <cstring>
 #include <DdsLoader.h>
+#include <BcDecoder.h>
+#include <PixelConverter.h>
 #include <GL/glew.h>
 #include <GL/glut.h>
 
@@ -64,6 +67,12 @@ static const unsigned int DDSCAPS2_CUBEMAP_NEGATIVE_Y   = 0x00002000;   // CubeM
 static const unsigned int DDSCAPS2_CUBEMAP_POSITIVE_Z   = 0x00004000;   // CubeMap Z+
 static const unsigned int DDSCAPS2_CUBEMAP_NEGATIVE_Z   = 0x00008000;   // CubeMap Z-
 static const unsigned int DDSCAPS2_VOLUME               = 0x00400000;   // VolumeTextureの場合.
+static const unsigned int DDSCAPS2_CUBEMAP_ALLFACES     = DDSCAPS2_CUBEMAP_POSITIVE_X
+                                                        | DDSCAPS2_CUBEMAP_NEGATIVE_X
+                                                        | DDSCAPS2_CUBEMAP_POSITIVE_Y
+                                                        | DDSCAPS2_CUBEMAP_NEGATIVE_Y
+                                                        | DDSCAPS2_CUBEMAP_POSITIVE_Z
+                                                        | DDSCAPS2_CUBEMAP_NEGATIVE_Z;
 
 // dwFourCC Value
 static const unsigned int FOURCC_DXT1           = '1TXD';           // DXT1
@@ -89,6 +98,105 @@ static const unsigned int FOURCC_A32B32G32R32F  = 0x00000074;
 static const unsigned int FOURCC_CxV8U8         = 0x00000075;
 static const unsigned int FOURCC_Q8W8V8U8       = 0x0000003f;
 
+// DX10 resourceDimension Value
+static const unsigned int DDS_DIMENSION_TEXTURE1D   = 2;    // 1Dテクスチャ.
+static const unsigned int DDS_DIMENSION_TEXTURE2D   = 3;    // 2Dテクスチャ.
+static const unsigned int DDS_DIMENSION_TEXTURE3D   = 4;    // 3Dテクスチャ.
+
+// DX10 miscFlag Value
+static const unsigned int DDS_RESOURCE_MISC_TEXTURECUBE = 0x00000004;   // CubeMapの場合.
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// CONVERT_TYPE enum
+/////////////////////////////////////////////////////////////////////////////////////////////
+enum CONVERT_TYPE
+{
+    CONVERT_TYPE_NONE = 0,          // 変換なし.
+    CONVERT_TYPE_HALF_TO_FLOAT,     // GLが半精度の転送に非対応の場合は単精度に変換.
+    CONVERT_TYPE_CXV8U8,            // 2成分法線からZを復元して符号付きRGB8に変換.
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// FormatInfo structure
+////////////////////////////////////////////////////////////////////////////////////////////
+struct FormatInfo
+{
+    unsigned int    internalFormat;     // GLの内部フォーマット (圧縮フォーマットの場合は圧縮形式).
+    unsigned int    format;             // GLの転送フォーマット (圧縮フォーマットの場合は圧縮形式).
+    unsigned int    type;               // GLの転送データ型.
+    unsigned int    bytePerPixel;       // ファイル上の1ピクセルあたりのバイト数.
+    unsigned int    blockSize;          // 1ブロックあたりのバイト数. 非圧縮の場合は0.
+    unsigned int    convertType;        // 転送時の変換タイプ.
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// DXGIFormatEntry structure
+////////////////////////////////////////////////////////////////////////////////////////////
+struct DXGIFormatEntry
+{
+    unsigned int    dxgiFormat;         // DXGI_FORMAT の値.
+    FormatInfo      info;               // 対応するフォーマット情報.
+};
+
+// DXGI_FORMAT とGLフォーマットの対応表.
+static const DXGIFormatEntry DXGI_FORMAT_TABLE[] = {
+    {   2, { GL_RGBA32F,            GL_RGBA,    GL_FLOAT,                           16,  0, CONVERT_TYPE_NONE } },            // R32G32B32A32_FLOAT
+    {   6, { GL_RGB32F,             GL_RGB,     GL_FLOAT,                           12,  0, CONVERT_TYPE_NONE } },            // R32G32B32_FLOAT
+    {  10, { GL_RGBA16F,            GL_RGBA,    GL_HALF_FLOAT,                       8,  0, CONVERT_TYPE_HALF_TO_FLOAT } },   // R16G16B16A16_FLOAT
+    {  11, { GL_RGBA16,             GL_RGBA,    GL_UNSIGNED_SHORT,                   8,  0, CONVERT_TYPE_NONE } },            // R16G16B16A16_UNORM
+    {  13, { GL_RGBA16_SNORM,       GL_RGBA,    GL_SHORT,                            8,  0, CONVERT_TYPE_NONE } },            // R16G16B16A16_SNORM
+    {  16, { GL_RG32F,              GL_RG,      GL_FLOAT,                            8,  0, CONVERT_TYPE_NONE } },            // R32G32_FLOAT
+    {  24, { GL_RGB10_A2,           GL_RGBA,    GL_UNSIGNED_INT_2_10_10_10_REV,      4,  0, CONVERT_TYPE_NONE } },            // R10G10B10A2_UNORM
+    {  26, { GL_R11F_G11F_B10F,     GL_RGB,     GL_UNSIGNED_INT_10F_11F_11F_REV,     4,  0, CONVERT_TYPE_NONE } },            // R11G11B10_FLOAT
+    {  28, { GL_RGBA8,              GL_RGBA,    GL_UNSIGNED_BYTE,                    4,  0, CONVERT_TYPE_NONE } },            // R8G8B8A8_UNORM
+    {  29, { GL_SRGB8_ALPHA8,       GL_RGBA,    GL_UNSIGNED_BYTE,                    4,  0, CONVERT_TYPE_NONE } },            // R8G8B8A8_UNORM_SRGB
+    {  31, { GL_RGBA8_SNORM,        GL_RGBA,    GL_BYTE,                             4,  0, CONVERT_TYPE_NONE } },            // R8G8B8A8_SNORM
+    {  34, { GL_RG16F,              GL_RG,      GL_HALF_FLOAT,                       4,  0, CONVERT_TYPE_HALF_TO_FLOAT } },   // R16G16_FLOAT
+    {  35, { GL_RG16,               GL_RG,      GL_UNSIGNED_SHORT,                   4,  0, CONVERT_TYPE_NONE } },            // R16G16_UNORM
+    {  37, { GL_RG16_SNORM,         GL_RG,      GL_SHORT,                            4,  0, CONVERT_TYPE_NONE } },            // R16G16_SNORM
+    {  41, { GL_R32F,               GL_RED,     GL_FLOAT,                            4,  0, CONVERT_TYPE_NONE } },            // R32_FLOAT
+    {  49, { GL_RG8,                GL_RG,      GL_UNSIGNED_BYTE,                    2,  0, CONVERT_TYPE_NONE } },            // R8G8_UNORM
+    {  51, { GL_RG8_SNORM,          GL_RG,      GL_BYTE,                             2,  0, CONVERT_TYPE_NONE } },            // R8G8_SNORM
+    {  54, { GL_R16F,               GL_RED,     GL_HALF_FLOAT,                       2,  0, CONVERT_TYPE_HALF_TO_FLOAT } },   // R16_FLOAT
+    {  56, { GL_R16,                GL_RED,     GL_UNSIGNED_SHORT,                   2,  0, CONVERT_TYPE_NONE } },            // R16_UNORM
+    {  58, { GL_R16_SNORM,          GL_RED,     GL_SHORT,                            2,  0, CONVERT_TYPE_NONE } },            // R16_SNORM
+    {  61, { GL_R8,                 GL_RED,     GL_UNSIGNED_BYTE,                    1,  0, CONVERT_TYPE_NONE } },            // R8_UNORM
+    {  63, { GL_R8_SNORM,           GL_RED,     GL_BYTE,                             1,  0, CONVERT_TYPE_NONE } },            // R8_SNORM
+    {  65, { GL_ALPHA8,             GL_ALPHA,   GL_UNSIGNED_BYTE,                    1,  0, CONVERT_TYPE_NONE } },            // A8_UNORM
+    {  67, { GL_RGB9_E5,            GL_RGB,     GL_UNSIGNED_INT_5_9_9_9_REV,         4,  0, CONVERT_TYPE_NONE } },            // R9G9B9E5_SHAREDEXP
+    {  70, { GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,          GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,           0, 0,  8, CONVERT_TYPE_NONE } },   // BC1_TYPELESS
+    {  71, { GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,          GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,           0, 0,  8, CONVERT_TYPE_NONE } },   // BC1_UNORM
+    {  72, { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT,    GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT,     0, 0,  8, CONVERT_TYPE_NONE } },   // BC1_UNORM_SRGB
+    {  73, { GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,          GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,           0, 0, 16, CONVERT_TYPE_NONE } },   // BC2_TYPELESS
+    {  74, { GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,          GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,           0, 0, 16, CONVERT_TYPE_NONE } },   // BC2_UNORM
+    {  75, { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT,    GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT,     0, 0, 16, CONVERT_TYPE_NONE } },   // BC2_UNORM_SRGB
+    {  76, { GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,          GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,           0, 0, 16, CONVERT_TYPE_NONE } },   // BC3_TYPELESS
+    {  77, { GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,          GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,           0, 0, 16, CONVERT_TYPE_NONE } },   // BC3_UNORM
+    {  78, { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT,    GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT,     0, 0, 16, CONVERT_TYPE_NONE } },   // BC3_UNORM_SRGB
+    {  79, { GL_COMPRESSED_RED_RGTC1_EXT,               GL_COMPRESSED_RED_RGTC1_EXT,                0, 0,  8, CONVERT_TYPE_NONE } },   // BC4_TYPELESS
+    {  80, { GL_COMPRESSED_RED_RGTC1_EXT,               GL_COMPRESSED_RED_RGTC1_EXT,                0, 0,  8, CONVERT_TYPE_NONE } },   // BC4_UNORM
+    {  81, { GL_COMPRESSED_SIGNED_RED_RGTC1_EXT,        GL_COMPRESSED_SIGNED_RED_RGTC1_EXT,         0, 0,  8, CONVERT_TYPE_NONE } },   // BC4_SNORM
+    {  82, { GL_COMPRESSED_RED_GREEN_RGTC2_EXT,         GL_COMPRESSED_RED_GREEN_RGTC2_EXT,          0, 0, 16, CONVERT_TYPE_NONE } },   // BC5_TYPELESS
+    {  83, { GL_COMPRESSED_RED_GREEN_RGTC2_EXT,         GL_COMPRESSED_RED_GREEN_RGTC2_EXT,          0, 0, 16, CONVERT_TYPE_NONE } },   // BC5_UNORM
+    {  84, { GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT,  GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT,   0, 0, 16, CONVERT_TYPE_NONE } },   // BC5_SNORM
+    {  85, { GL_RGB5,               GL_RGB,     GL_UNSIGNED_SHORT_5_6_5,             2,  0, CONVERT_TYPE_NONE } },            // B5G6R5_UNORM
+    {  86, { GL_RGB5_A1,            GL_BGRA,    GL_UNSIGNED_SHORT_1_5_5_5_REV,       2,  0, CONVERT_TYPE_NONE } },            // B5G5R5A1_UNORM
+    {  87, { GL_RGBA8,              GL_BGRA,    GL_UNSIGNED_BYTE,                    4,  0, CONVERT_TYPE_NONE } },            // B8G8R8A8_UNORM
+    {  88, { GL_RGB8,               GL_BGRA,    GL_UNSIGNED_BYTE,                    4,  0, CONVERT_TYPE_NONE } },            // B8G8R8X8_UNORM
+    {  91, { GL_SRGB8_ALPHA8,       GL_BGRA,    GL_UNSIGNED_BYTE,                    4,  0, CONVERT_TYPE_NONE } },            // B8G8R8A8_UNORM_SRGB
+    {  93, { GL_SRGB8,              GL_BGRA,    GL_UNSIGNED_BYTE,                    4,  0, CONVERT_TYPE_NONE } },            // B8G8R8X8_UNORM_SRGB
+    {  94, { GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB, GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB,  0, 0, 16, CONVERT_TYPE_NONE } },   // BC6H_TYPELESS
+    {  95, { GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB, GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB,  0, 0, 16, CONVERT_TYPE_NONE } },   // BC6H_UF16
+    {  96, { GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT_ARB,   GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT_ARB,    0, 0, 16, CONVERT_TYPE_NONE } },   // BC6H_SF16
+    {  97, { GL_COMPRESSED_RGBA_BPTC_UNORM_ARB,         GL_COMPRESSED_RGBA_BPTC_UNORM_ARB,          0, 0, 16, CONVERT_TYPE_NONE } },   // BC7_TYPELESS
+    {  98, { GL_COMPRESSED_RGBA_BPTC_UNORM_ARB,         GL_COMPRESSED_RGBA_BPTC_UNORM_ARB,          0, 0, 16, CONVERT_TYPE_NONE } },   // BC7_UNORM
+    {  99, { GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB,   GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB,    0, 0, 16, CONVERT_TYPE_NONE } },   // BC7_UNORM_SRGB
+    { 115, { GL_RGBA4,              GL_BGRA,    GL_UNSIGNED_SHORT_4_4_4_4_REV,       2,  0, CONVERT_TYPE_NONE } },            // B4G4R4A4_UNORM
+};
+
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -148,6 +256,19 @@ typedef struct __DDSurfaceDesc
 } DDSurfaceDesc;
 
 
+////////////////////////////////////////////////////////////////////////////////////////////
+// DDSHeaderDX10 structure
+////////////////////////////////////////////////////////////////////////////////////////////
+typedef struct __DDSHeaderDX10
+{
+    unsigned int    dxgiFormat;
+    unsigned int    resourceDimension;
+    unsigned int    miscFlag;
+    unsigned int    arraySize;
+    unsigned int    miscFlags2;
+} DDSHeaderDX10;
+
+
 //-------------------------------------------------------------------------------------------
 //      マスクをチェックします.
 //-------------------------------------------------------------------------------------------
@@ -169,6 +290,415 @@ bool CheckMask
     return false;
 }
 
+//-------------------------------------------------------------------------------------------
+//      GLの圧縮フォーマットをブロック圧縮フォーマットに変換します.
+//-------------------------------------------------------------------------------------------
+bool ToBCFormat( unsigned int glFormat, BC_FORMAT& result )
+{
+    switch( glFormat )
+    {
+    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:    { result = BC_FORMAT_BC1;  } return true;
+    case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:    { result = BC_FORMAT_BC2;  } return true;
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:    { result = BC_FORMAT_BC3;  } return true;
+    case GL_COMPRESSED_RED_RGTC1_EXT:               { result = BC_FORMAT_BC4U; } return true;
+    case GL_COMPRESSED_SIGNED_RED_RGTC1_EXT:        { result = BC_FORMAT_BC4S; } return true;
+    case GL_COMPRESSED_RED_GREEN_RGTC2_EXT:         { result = BC_FORMAT_BC5U; } return true;
+    case GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT:  { result = BC_FORMAT_BC5S; } return true;
+    default:
+        break;
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------
+//      GLが圧縮フォーマットを直接扱えるかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsSupportCompressedFormat( BC_FORMAT format )
+{
+    switch( format )
+    {
+    case BC_FORMAT_BC1:
+    case BC_FORMAT_BC2:
+    case BC_FORMAT_BC3:
+        return ( GLEW_EXT_texture_compression_s3tc != GL_FALSE );
+
+    default:
+        break;
+    }
+
+    return ( GLEW_VERSION_3_0 != GL_FALSE )
+        || ( GLEW_ARB_texture_compression_rgtc != GL_FALSE )
+        || ( GLEW_EXT_texture_compression_rgtc != GL_FALSE );
+}
+
+//-------------------------------------------------------------------------------------------
+//      sRGBのブロック圧縮フォーマットかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsSRGBCompressedFormat( unsigned int glFormat )
+{
+    return ( glFormat == GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT )
+        || ( glFormat == GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT )
+        || ( glFormat == GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT );
+}
+
+//-------------------------------------------------------------------------------------------
+//      sRGBの内部フォーマットかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsSRGBFormat( unsigned int internalFormat )
+{
+    return ( internalFormat == GL_SRGB8 )
+        || ( internalFormat == GL_SRGB8_ALPHA8 )
+        || ( internalFormat == GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB )
+        || IsSRGBCompressedFormat( internalFormat );
+}
+
+//-------------------------------------------------------------------------------------------
+//      内部フォーマットに対応するsRGBフォーマットを取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int ToSRGBFormat( unsigned int internalFormat )
+{
+    switch( internalFormat )
+    {
+    case GL_RGB8:                               { return GL_SRGB8; }
+    case GL_RGBA8:                              { return GL_SRGB8_ALPHA8; }
+    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:      { return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; }
+    case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:      { return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT; }
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:      { return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; }
+    default:
+        break;
+    }
+
+    // sRGBの対応フォーマットが無いもの(BC4/BC5，16bit，浮動小数等)は線形のまま.
+    return internalFormat;
+}
+
+//-------------------------------------------------------------------------------------------
+//      BPTC (BC6H, BC7) フォーマットかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsBPTCFormat( unsigned int glFormat )
+{
+    return ( glFormat == GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB )
+        || ( glFormat == GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT_ARB )
+        || ( glFormat == GL_COMPRESSED_RGBA_BPTC_UNORM_ARB )
+        || ( glFormat == GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB );
+}
+
+//-------------------------------------------------------------------------------------------
+//      浮動小数の内部フォーマットかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsFloatFormat( unsigned int internalFormat )
+{
+    switch( internalFormat )
+    {
+    case GL_R16F:
+    case GL_RG16F:
+    case GL_RGBA16F:
+    case GL_R32F:
+    case GL_RG32F:
+    case GL_RGB32F:
+    case GL_RGBA32F:
+        return true;
+
+    default:
+        break;
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------
+//      フォーマット情報を設定します.
+//-------------------------------------------------------------------------------------------
+void SetFormatInfo
+(
+    FormatInfo&     info,
+    unsigned int    internalFormat,
+    unsigned int    format,
+    unsigned int    type,
+    unsigned int    bytePerPixel,
+    unsigned int    convertType = CONVERT_TYPE_NONE
+)
+{
+    info.internalFormat = internalFormat;
+    info.format         = format;
+    info.type           = type;
+    info.bytePerPixel   = bytePerPixel;
+    info.blockSize      = 0;
+    info.convertType    = convertType;
+}
+
+//-------------------------------------------------------------------------------------------
+//      ブロック圧縮のフォーマット情報を設定します.
+//-------------------------------------------------------------------------------------------
+void SetCompressedFormatInfo( FormatInfo& info, unsigned int glFormat, unsigned int blockSize )
+{
+    info.internalFormat = glFormat;
+    info.format         = glFormat;
+    info.type           = 0;
+    info.bytePerPixel   = 0;
+    info.blockSize      = blockSize;
+    info.convertType    = CONVERT_TYPE_NONE;
+}
+
+//-------------------------------------------------------------------------------------------
+//      FourCCからフォーマット情報を取得します.
+//-------------------------------------------------------------------------------------------
+bool GetFormatInfoFromFourCC( unsigned int fourCC, FormatInfo& info )
+{
+    switch( fourCC )
+    {
+    case FOURCC_DXT1:
+        { SetCompressedFormatInfo( info, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 8 ); }
+        return true;
+
+    case FOURCC_DXT2:
+    case FOURCC_DXT3:
+        { SetCompressedFormatInfo( info, GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, 16 ); }
+        return true;
+
+    case FOURCC_DXT4:
+    case FOURCC_DXT5:
+        { SetCompressedFormatInfo( info, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 16 ); }
+        return true;
+
+    case FOURCC_ATI1:
+    case FOURCC_BC4U:
+        { SetCompressedFormatInfo( info, GL_COMPRESSED_RED_RGTC1_EXT, 8 ); }
+        return true;
+
+    case FOURCC_BC4S:
+        { SetCompressedFormatInfo( info, GL_COMPRESSED_SIGNED_RED_RGTC1_EXT, 8 ); }
+        return true;
+
+    case FOURCC_ATI2:
+    case FOURCC_BC5U:
+        { SetCompressedFormatInfo( info, GL_COMPRESSED_RED_GREEN_RGTC2_EXT, 16 ); }
+        return true;
+
+    case FOURCC_BC5S:
+        { SetCompressedFormatInfo( info, GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT, 16 ); }
+        return true;
+
+    case FOURCC_A16B16G16R16:
+        { SetFormatInfo( info, GL_RGBA16, GL_RGBA, GL_UNSIGNED_SHORT, 8 ); }
+        return true;
+
+    case FOURCC_Q16W16V16U16:
+        { SetFormatInfo( info, GL_RGBA16_SNORM, GL_RGBA, GL_SHORT, 8 ); }
+        return true;
+
+    case FOURCC_R16F:
+        { SetFormatInfo( info, GL_R16F, GL_RED, GL_HALF_FLOAT, 2, CONVERT_TYPE_HALF_TO_FLOAT ); }
+        return true;
+
+    case FOURCC_G16R16F:
+        { SetFormatInfo( info, GL_RG16F, GL_RG, GL_HALF_FLOAT, 4, CONVERT_TYPE_HALF_TO_FLOAT ); }
+        return true;
+
+    case FOURCC_A16B16G16R16F:
+        { SetFormatInfo( info, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, 8, CONVERT_TYPE_HALF_TO_FLOAT ); }
+        return true;
+
+    case FOURCC_R32F:
+        { SetFormatInfo( info, GL_R32F, GL_RED, GL_FLOAT, 4 ); }
+        return true;
+
+    case FOURCC_G32R32F:
+        { SetFormatInfo( info, GL_RG32F, GL_RG, GL_FLOAT, 8 ); }
+        return true;
+
+    case FOURCC_A32B32G32R32F:
+        { SetFormatInfo( info, GL_RGBA32F, GL_RGBA, GL_FLOAT, 16 ); }
+        return true;
+
+    case FOURCC_CxV8U8:
+        { SetFormatInfo( info, GL_RGB8_SNORM, GL_RGB, GL_BYTE, 2, CONVERT_TYPE_CXV8U8 ); }
+        return true;
+
+    case FOURCC_Q8W8V8U8:
+        { SetFormatInfo( info, GL_RGBA8_SNORM, GL_RGBA, GL_BYTE, 4 ); }
+        return true;
+
+    default:
+        break;
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------
+//      ビットマスクからフォーマット情報を取得します.
+//-------------------------------------------------------------------------------------------
+bool GetFormatInfoFromMask( const DDPixelFormat& pixelFormat, FormatInfo& info )
+{
+    if ( pixelFormat.flags & DDPF_RGB )
+    {
+        switch( pixelFormat.bpp )
+        {
+        case 32:
+            {
+                // A8 B8 G8 R8
+                if ( CheckMask( pixelFormat, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000 ) )
+                { SetFormatInfo( info, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4 ); return true; }
+
+                // A8 R8 G8 B8
+                if ( CheckMask( pixelFormat, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000 ) )
+                { SetFormatInfo( info, GL_RGBA8, GL_BGRA, GL_UNSIGNED_BYTE, 4 ); return true; }
+
+                // X8 B8 G8 R8
+                if ( CheckMask( pixelFormat, 0x000000ff, 0x0000ff00, 0x00ff0000, 0x00000000 ) )
+                { SetFormatInfo( info, GL_RGB8, GL_RGBA, GL_UNSIGNED_BYTE, 4 ); return true; }
+
+                // X8 R8 G8 B8
+                if ( CheckMask( pixelFormat, 0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000 ) )
+                { SetFormatInfo( info, GL_RGB8, GL_BGRA, GL_UNSIGNED_BYTE, 4 ); return true; }
+
+                // A2 B10 G10 R10
+                if ( CheckMask( pixelFormat, 0x000003ff, 0x000ffc00, 0x3ff00000, 0xc0000000 ) )
+                { SetFormatInfo( info, GL_RGB10_A2, GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV, 4 ); return true; }
+
+                // A2 R10 G10 B10
+                if ( CheckMask( pixelFormat, 0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000 ) )
+                { SetFormatInfo( info, GL_RGB10_A2, GL_BGRA, GL_UNSIGNED_INT_2_10_10_10_REV, 4 ); return true; }
+
+                // G16 R16
+                if ( CheckMask( pixelFormat, 0x0000ffff, 0xffff0000, 0x00000000, 0x00000000 ) )
+                { SetFormatInfo( info, GL_RG16, GL_RG, GL_UNSIGNED_SHORT, 4 ); return true; }
+            }
+            break;
+
+        case 24:
+            {
+                // R8 G8 B8
+                if ( CheckMask( pixelFormat, 0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000 ) )
+                { SetFormatInfo( info, GL_RGB8, GL_BGR, GL_UNSIGNED_BYTE, 3 ); return true; }
+
+                // B8 G8 R8
+                if ( CheckMask( pixelFormat, 0x000000ff, 0x0000ff00, 0x00ff0000, 0x00000000 ) )
+                { SetFormatInfo( info, GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE, 3 ); return true; }
+            }
+            break;
+
+        case 16:
+            {
+                // A1 R5 G5 B5
+                if ( CheckMask( pixelFormat, 0x7c00, 0x03e0, 0x001f, 0x8000 ) )
+                { SetFormatInfo( info, GL_RGB5_A1, GL_BGRA, GL_UNSIGNED_SHORT_1_5_5_5_REV, 2 ); return true; }
+
+                // X1 R5 G5 B5
+                if ( CheckMask( pixelFormat, 0x7c00, 0x03e0, 0x001f, 0x0000 ) )
+                { SetFormatInfo( info, GL_RGB5, GL_BGRA, GL_UNSIGNED_SHORT_1_5_5_5_REV, 2 ); return true; }
+
+                // R5 G6 B5
+                if ( CheckMask( pixelFormat, 0xf800, 0x07e0, 0x001f, 0x0000 ) )
+                { SetFormatInfo( info, GL_RGB5, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, 2 ); return true; }
+
+                // A4 R4 G4 B4
+                if ( CheckMask( pixelFormat, 0x0f00, 0x00f0, 0x000f, 0xf000 ) )
+                { SetFormatInfo( info, GL_RGBA4, GL_BGRA, GL_UNSIGNED_SHORT_4_4_4_4_REV, 2 ); return true; }
+            }
+            break;
+        }
+    }
+    else if ( pixelFormat.flags & DDPF_LUMINANCE )
+    {
+        switch( pixelFormat.bpp )
+        {
+        case 8:
+            {
+                // L8
+                if ( CheckMask( pixelFormat, 0x000000ff, 0x00000000, 0x00000000, 0x00000000 ) )
+                { SetFormatInfo( info, GL_LUMINANCE8, GL_LUMINANCE, GL_UNSIGNED_BYTE, 1 ); return true; }
+            }
+            break;
+
+        case 16:
+            {
+                // L16
+                if ( CheckMask( pixelFormat, 0x0000ffff, 0x00000000, 0x00000000, 0x00000000 ) )
+                { SetFormatInfo( info, GL_LUMINANCE16, GL_LUMINANCE, GL_UNSIGNED_SHORT, 2 ); return true; }
+
+                // A8 L8
+                if ( CheckMask( pixelFormat, 0x000000ff, 0x00000000, 0x00000000, 0x0000ff00 ) )
+                { SetFormatInfo( info, GL_LUMINANCE8_ALPHA8, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, 2 ); return true; }
+            }
+            break;
+        }
+    }
+    else if ( pixelFormat.flags & DDPF_ALPHA )
+    {
+        // A8
+        if ( 8 == pixelFormat.bpp )
+        { SetFormatInfo( info, GL_ALPHA8, GL_ALPHA, GL_UNSIGNED_BYTE, 1 ); return true; }
+    }
+    else if ( pixelFormat.flags & DDPF_BUMPDUDV )
+    {
+        // V8 U8
+        if ( ( 16 == pixelFormat.bpp ) && CheckMask( pixelFormat, 0x000000ff, 0x0000ff00, 0x00000000, 0x00000000 ) )
+        { SetFormatInfo( info, GL_RG8_SNORM, GL_RG, GL_BYTE, 2 ); return true; }
+
+        // Q8 W8 V8 U8
+        if ( ( 32 == pixelFormat.bpp ) && CheckMask( pixelFormat, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000 ) )
+        { SetFormatInfo( info, GL_RGBA8_SNORM, GL_RGBA, GL_BYTE, 4 ); return true; }
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------
+//      DXGI_FORMATからフォーマット情報を取得します.
+//-------------------------------------------------------------------------------------------
+bool GetFormatInfoFromDXGI( unsigned int dxgiFormat, FormatInfo& info )
+{
+    const size_t count = sizeof(DXGI_FORMAT_TABLE) / sizeof(DXGI_FORMAT_TABLE[0]);
+    for( size_t i=0; i<count; ++i )
+    {
+        if ( DXGI_FORMAT_TABLE[i].dxgiFormat == dxgiFormat )
+        {
+            info = DXGI_FORMAT_TABLE[i].info;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------
+//      GLが半精度浮動小数の転送に対応しているかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsSupportHalfFloatPixel()
+{
+    return ( GLEW_VERSION_3_0 != GL_FALSE )
+        || ( GLEW_ARB_half_float_pixel != GL_FALSE );
+}
+
+//-------------------------------------------------------------------------------------------
+//      GLがテクスチャターゲットに対応しているかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsSupportTarget( unsigned int target )
+{
+    switch( target )
+    {
+    case GL_TEXTURE_2D_ARRAY:
+        return ( GLEW_VERSION_3_0 != GL_FALSE )
+            || ( GLEW_EXT_texture_array != GL_FALSE );
+
+    case GL_TEXTURE_CUBE_MAP_ARRAY:
+        return ( GLEW_VERSION_4_0 != GL_FALSE )
+            || ( GLEW_ARB_texture_cube_map_array != GL_FALSE );
+
+    default:
+        break;
+    }
+
+    // GL_TEXTURE_2D, GL_TEXTURE_3D, GL_TEXTURE_CUBE_MAP は GL 1.3 で必須.
+    return true;
+}
+
 
 } // namespace /* anonymous */
 
@@ -184,12 +714,21 @@ DdsImage::DdsImage()
 : m_ImageSize       ( 0 )
 , m_Format          ( 0 )
 , m_InternalFormat  ( 0 )
+, m_Type            ( 0 )
+, m_BlockSize       ( 0 )
+, m_ConvertType     ( CONVERT_TYPE_NONE )
 , m_Width           ( 0 )
 , m_Height          ( 0 )
+, m_Depth           ( 0 )
+, m_ArraySize       ( 0 )
+, m_FaceCount       ( 0 )
+, m_Target          ( GL_TEXTURE_2D )
 , m_BytePerPixel    ( 0 )
 , m_ID              ( 0 )
 , m_pImageData      ( nullptr )
 , m_MipmapCount     ( 0 )
+, m_ColorSpace      ( COLOR_SPACE_SRGB )
+, m_ColorSpaceHint  ( COLOR_SPACE_SRGB )
 { /* DO_NOTHING */ }
 
 
@@ -204,346 +743,276 @@ DdsImage::~DdsImage()
 //-------------------------------------------------------------------------------------------
 void DdsImage::Release()
 {
-    if ( m_pImageData )
-    {
-        delete[] m_pImageData;
-        m_pImageData = nullptr;
-    }
+    // ピクセルデータはマップされたファイルを指しているので，マップ解除のみ行う.
+    m_File.Close();
+    m_Surfaces.clear();
+    m_pImageData = nullptr;
 
     m_ImageSize      = 0;
     m_Format         = 0;
     m_InternalFormat = 0;
+    m_Type           = 0;
+    m_BlockSize      = 0;
+    m_ConvertType    = CONVERT_TYPE_NONE;
     m_Width          = 0;
     m_Height         = 0;
+    m_Depth          = 0;
+    m_ArraySize      = 0;
+    m_FaceCount      = 0;
+    m_Target         = GL_TEXTURE_2D;
     m_BytePerPixel   = 0;
     m_MipmapCount    = 0;
+    m_ColorSpace     = m_ColorSpaceHint;
 }
 
+//-------------------------------------------------------------------------------------------
+//      色空間のヒントを設定します.
+//-------------------------------------------------------------------------------------------
+void DdsImage::SetColorSpaceHint( COLOR_SPACE colorSpace )
+{ m_ColorSpaceHint = colorSpace; }
+
 //-------------------------------------------------------------------------------------------
 //      読み込み処理を行います.
 //-------------------------------------------------------------------------------------------
 bool DdsImage::Load(const char *filename)
 {
-    FILE *fp;
+    Release();
 
-    //　ファイルを開く
-    errno_t err = fopen_s(&fp,filename, "rb");
-    if ( err != 0 )
+    //　ファイルを読み取り専用でマップする.
+    if ( !m_File.Open( filename ) )
     {
         ELOG( "Error : File Open Failed. FileName = %s", filename );
         return false;
     }
 
+    const unsigned char* pFile    = m_File.GetData();
+    const size_t         fileSize = m_File.GetSize();
+
     // ファイルマジックをチェック.
-    char magic[4];
-    fread( &magic, sizeof(char), 4, fp );
-    if ( ( magic[0] != 'D' )
-      || ( magic[1] != 'D' )
-      || ( magic[2] != 'S' )
-      || ( magic[3] != ' ' ) )
+    if ( ( fileSize < 4 + sizeof(DDSurfaceDesc) )
+      || ( pFile[0] != 'D' )
+      || ( pFile[1] != 'D' )
+      || ( pFile[2] != 'S' )
+      || ( pFile[3] != ' ' ) )
     {
         ELOG( "Error : Invalid File Format." );
-        fclose( fp );
+        Release();
         return false;
     }
 
     DDSurfaceDesc ddsd;
 
     //　ヘッダーを読み取り
-    fread( &ddsd, sizeof(ddsd), 1, fp );
+    memcpy( &ddsd, pFile + 4, sizeof(ddsd) );
 
     //　幅・高さを格納
     m_Height      = ddsd.height;
     m_Width       = ddsd.width;
     m_MipmapCount = 1;
 
-    if ( ddsd.flags & DDSD_MIPMAPCOUNT )
+    if ( ( ddsd.flags & DDSD_MIPMAPCOUNT ) && ( ddsd.mipMapLevels > 0 ) )
     { m_MipmapCount = ddsd.mipMapLevels; }
 
-    // キューブマップとボリュームテクスチャの判定を一応行って該当する場合は弾く.
-    if ( ddsd.caps & DDSCAPS_COMPLEX )
+    m_Depth     = 1;
+    m_ArraySize = 1;
+    m_FaceCount = 1;
+
+    // キューブマップとボリュームテクスチャの判定.
+    if ( ddsd.caps2 & DDSCAPS2_CUBEMAP )
     {
-        if ( ddsd.caps2 & DDSCAPS2_CUBEMAP )
+        // 一部の面だけを持つキューブマップはGLで表現できないので弾く.
+        if ( ( ddsd.caps2 & DDSCAPS2_CUBEMAP_ALLFACES ) != DDSCAPS2_CUBEMAP_ALLFACES )
         {
-            ELOG( "Error : Cubemap Not Support." );
-            fclose( fp );
-            return false;
-        }
-        else if ( ddsd.caps2 & DDSCAPS2_VOLUME )
-        {
-            ELOG( "Error : Volume Texture Not Support." );
-            fclose( fp );
+            ELOG( "Error : Partial Cubemap Not Support." );
+            Release();
             return false;
         }
+
+        m_FaceCount = 6;
     }
+    else if ( ( ddsd.caps2 & DDSCAPS2_VOLUME ) && ( ddsd.flags & DDSD_DEPTH ) && ( ddsd.depth > 0 ) )
+    { m_Depth = ddsd.depth; }
 
-    bool isFind = false;
+    // ピクセルデータは基本的にヘッダの直後から始まる.
+    size_t     dataOffset = 4 + sizeof(DDSurfaceDesc);
+    FormatInfo info;
+    bool       isFind = false;
+    bool       isDX10 = false;
 
-    // BC圧縮のタイプを調べる.
+    // フォーマットを調べる.
     if ( ddsd.flags & DDSD_PIXELFORMAT )
     {
-        if ( ddsd.format.flags & DDPF_FOURCC )
+        if ( ( ddsd.format.flags & DDPF_FOURCC ) && ( ddsd.format.fourCC == FOURCC_DX10 ) )
         {
-            //　フォーマット判別
-            switch ( ddsd.format.fourCC )
+            // DX10拡張ヘッダが続く.
+            if ( fileSize < dataOffset + sizeof(DDSHeaderDX10) )
             {
-                case FOURCC_DXT1:
-                    {
-                        m_Format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
-                        m_InternalFormat = GL_RGBA;
-                        isFind = true;
-                    }
-                    break;
+                ELOG( "Error : Unexpected End Of File." );
+                Release();
+                return false;
+            }
 
-                case FOURCC_DXT2:
-                    {
-                        m_Format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
-                        m_InternalFormat = GL_RGBA;
-                        isFind = true;
-                    }
-                    break;
+            DDSHeaderDX10 ext;
+            memcpy( &ext, pFile + dataOffset, sizeof(ext) );
+            dataOffset += sizeof(ext);
 
-                case FOURCC_DXT3:
-                    {
-                        m_Format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
-                        m_InternalFormat = GL_RGBA;
-                        isFind = true;
-                    }
-                    break;
+            // DX10拡張ヘッダの次元と配列数を優先する.
+            if ( ext.resourceDimension == DDS_DIMENSION_TEXTURE3D )
+            {
+                m_Depth     = ( ddsd.depth > 0 ) ? ddsd.depth : 1;
+                m_FaceCount = 1;
+            }
+            else if ( ( ext.resourceDimension == DDS_DIMENSION_TEXTURE1D )
+                   || ( ext.resourceDimension == DDS_DIMENSION_TEXTURE2D ) )
+            {
+                m_Depth     = 1;
+                m_FaceCount = ( ext.miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE ) ? 6 : 1;
+                m_ArraySize = ( ext.arraySize > 0 ) ? ext.arraySize : 1;
+            }
+            else
+            {
+                ELOG( "Error : Invalid Resource Dimension. Dimension = %u", ext.resourceDimension );
+                Release();
+                return false;
+            }
 
-                case FOURCC_DXT4:
-                    {
-                        m_Format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
-                        m_InternalFormat = GL_RGBA;
-                        isFind = true;
-                    }
-                    break;
+            isFind = GetFormatInfoFromDXGI( ext.dxgiFormat, info );
+            isDX10 = true;
+        }
+        else if ( ddsd.format.flags & DDPF_FOURCC )
+        { isFind = GetFormatInfoFromFourCC( ddsd.format.fourCC, info ); }
+        else
+        { isFind = GetFormatInfoFromMask( ddsd.format, info ); }
+    }
 
-                case FOURCC_DXT5:
-                    {
-                        m_Format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
-                        m_InternalFormat = GL_RGBA;
-                        isFind = true;
-                    }
-                    break;
+    if ( !isFind )
+    {
+        ELOG( "Error : Unsupported format" );
+        Release();
+        return false;
+    }
 
-                case FOURCC_ATI1:
-                case FOURCC_BC4U:
-                    {
-                        m_Format = GL_COMPRESSED_RED_RGTC1_EXT;
-                        m_InternalFormat = GL_R;
-                        isFind = true;
-                    }
-                    break;
+    // 旧形式のヘッダは色空間を持たないので，ヒントに従ってsRGBフォーマットを選ぶ.
+    if ( !isDX10 && m_ColorSpaceHint == COLOR_SPACE_SRGB )
+    {
+        info.internalFormat = ToSRGBFormat( info.internalFormat );
+        if ( info.blockSize != 0 )
+        { info.format = info.internalFormat; }
+    }
 
-                case FOURCC_BC4S:
-                    {
-                        m_Format = GL_COMPRESSED_SIGNED_RED_RGTC1_EXT;
-                        m_InternalFormat = GL_R;
-                        isFind = true;
-                    }
-                    break;
+    m_Format         = info.format;
+    m_InternalFormat = info.internalFormat;
+    m_ColorSpace     = IsSRGBFormat( info.internalFormat ) ? COLOR_SPACE_SRGB : COLOR_SPACE_LINEAR;
+    m_Type           = info.type;
+    m_BytePerPixel   = info.bytePerPixel;
+    m_BlockSize      = info.blockSize;
+    m_ConvertType    = info.convertType;
+
+    // GLのテクスチャターゲットを決定する.
+    if ( m_Depth > 1 )
+    { m_Target = GL_TEXTURE_3D; }
+    else if ( m_FaceCount == 6 )
+    { m_Target = ( m_ArraySize > 1 ) ? GL_TEXTURE_CUBE_MAP_ARRAY : GL_TEXTURE_CUBE_MAP; }
+    else
+    { m_Target = ( m_ArraySize > 1 ) ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D; }
 
-                case FOURCC_ATI2:
-                case FOURCC_BC5U:
-                    {
-                        m_Format = GL_COMPRESSED_RED_GREEN_RGTC2_EXT;
-                        m_InternalFormat = GL_RG;
-                        isFind = true;
-                    }
-                    break;
+    // ヘッダの値は信用せず，テーブルの確保やサイズ計算の前に範囲をチェックする.
+    if ( m_Width == 0 || m_Height == 0 )
+    {
+        ELOG( "Error : Invalid Size. Width = %u, Height = %u", m_Width, m_Height );
+        Release();
+        return false;
+    }
 
-                case FOURCC_BC5S:
-                    {
-                        m_Format = GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT;
-                        m_InternalFormat = GL_RG;
-                        isFind = true;
-                    }
-                    break;
-
-                //case FOURCC_DX10:
-                //    {
-                //    }
-                //    break;
-
-                //case 36 : // D3DFMT_A16B16G16R16
-                //    {
-                //    }
-                //    break;
-
-                //case 110: // D3DFMT_Q16W16V16U16
-                //    {
-                //    }
-                //    break;
-
-                //case 111: // D3DFMT_R16F
-                //    {
-                //    }
-                //    break;
-
-                //case 112: // D3DFMT_G16G16F
-                //    {
-                //    }
-                //    break;
-
-                //case 113: // D3DFMT_A16B16G16R16F
-                //    {
-                //    }
-                //    break;
-
-                //case 114: // D3DFMT_R32F
-                //    {
-                //    }
-                //    break;
-
-                //case 115: // D3DFMT_G32R32F
-                //    {
-                //    }
-                //    break;
-
-                //case 116: // D3DFMT_A32B32G32R32F
-                //    {
-                //    }
-                //    break;
-
-                default:
-                    {
-                        isFind = false;
-                    }
-                    break;
-            }
-        }
-        //else if ( ddsd.format.flags & DDPF_RGB )
-        //{
-        //    switch( ddsd.format.bpp )
-        //    {
-        //    case 32:
-        //        {
-        //            if ( CheckMask( ddsd.format, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000 ) )
-        //            {
-        //                // A8 R8 G8 B8
-        //            }
-
-        //            if ( CheckMask( ddsd.format, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000 ) )
-        //            {
-        //                // A8 B8 G8 R8
-        //            }
-
-        //            if ( CheckMask( ddsd.format, 0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000 ) )
-        //            {
-        //                // X8 R8 G8 B8
-        //            }
-
-        //            if ( CheckMask( ddsd.format, 0x000000ff, 0x0000ff00, 0x00ff0000, 0x00000000 ) )
-        //            {
-        //                // X8 B8 G8 R8
-        //            }
-
-        //            if ( CheckMask( ddsd.format, 0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000 ) )
-        //            {
-        //                // R10 G10 B10 A2
-        //            }
-
-        //            if ( CheckMask( ddsd.format, 0x0000ffff, 0xffff0000, 0x00000000, 0x00000000 ) )
-        //            {
-        //                // R16 G16
-        //            }
-        //            if ( CheckMask( ddsd.format, 0xffffffff, 0x00000000,0x00000000,0x00000000 ) )
-        //            {
-        //                // R32
-        //            }
-        //        }
-        //        break;
-
-        //    case 24:
-        //        {
-        //            /* NOT_SUPPORT */
-        //        }
-        //        break;
-
-        //    case 16:
-        //        {
-        //            if ( CheckMask( ddsd.format, 0x7c00, 0x03e0, 0x001f, 0x8000 ) )
-        //            {
-        //                // B5 G5 R5 A1
-        //            }
-
-        //            if ( CheckMask( ddsd.format, 0xf800, 0x07e0, 0x001f, 0x0000 ) )
-        //            {
-        //                // B5 G6 R5
-        //            }
-        //        }
-        //        break;
-        //    }
-        //}
-        //else if ( ddsd.format.flags & DDPF_LUMINANCE )
-        //{
-        //    switch( ddsd.format.bpp )
-        //    {
-        //    case 8:
-        //        {
-        //            if ( CheckMask( ddsd.format, 0x000000ff, 0x00000000, 0x00000000, 0x00000000 ) )
-        //            {
-        //                // R8
-        //            }
-        //        }
-        //        break;
-
-        //    case 16:
-        //        {
-        //            if ( CheckMask( ddsd.format, 0x0000ffff, 0x00000000, 0x00000000, 0x00000000 ) )
-        //            {
-        //                // R16
-        //            }
-
-        //            if ( CheckMask( ddsd.format, 0x000000ff, 0x00000000, 0x00000000, 0x0000ff00 ) )
-        //            {
-        //                // R8 G8
-        //            }
-        //        }
-        //        break;
-        //    }
-        //}
-        //else if ( ddsd.format.flags & DDPF_ALPHA )
-        //{
-        //    if ( 8 == ddsd.format.bpp )
-        //    {
-        //        // A8
-        //    }
-        //}
-    }
-        
-
-    // BC圧縮以外は非サポートのためエラー扱い.
-    if ( !isFind )
+    // ミップレベル数は 1x1(x1) までの段数を超えられない.
+    unsigned int maxSize = ( m_Width > m_Height ) ? m_Width : m_Height;
+    if ( m_Depth > maxSize ) { maxSize = m_Depth; }
+
+    unsigned int maxMipmapCount = 1;
+    for ( ; maxSize > 1; maxSize >>= 1 )
+    { maxMipmapCount++; }
+
+    if ( m_MipmapCount > maxMipmapCount )
     {
-        ELOG( "Error : Unsupported format" );
-        fclose( fp );
+        ELOG( "Error : Invalid Mipmap Count. Count = %u", m_MipmapCount );
+        Release();
         return false;
     }
 
-    long curr = ftell(fp);
-    fseek( fp, 0, SEEK_END );
-    long end = ftell(fp);
-    fseek( fp, curr, SEEK_SET );
+    const size_t dataSize = fileSize - dataOffset;
 
-    //　テクセルデータのサイズを算出
-    m_ImageSize = unsigned int( end - curr );
+    // 各サーフェイスは1バイト以上なので，サーフェイス数がデータサイズを超えるなら切れたファイル.
+    // 配列数などが巨大な場合にテーブルのインデックス計算がオーバーフローするのもここで防ぐ.
+    unsigned long long surfaceCount = 0;
+    if ( m_Depth > 1 )
+    {
+        for ( unsigned int i=0; i<m_MipmapCount; ++i )
+        { surfaceCount += ( ( m_Depth >> i ) > 1 ) ? ( m_Depth >> i ) : 1; }
+    }
+    else
+    { surfaceCount = static_cast<unsigned long long>( m_ArraySize ) * m_FaceCount * m_MipmapCount; }
 
-    // メモリを確保.
-    m_pImageData = new(std::nothrow) unsigned char [ m_ImageSize ];
-    if ( m_pImageData == nullptr )
+    if ( surfaceCount > dataSize || surfaceCount > 0xffffffff )
     {
-        ELOG( "Error : Memory Allocate Failed." );
-        fclose( fp );
+        ELOG( "Error : Unexpected End Of File." );
+        Release();
         return false;
     }
 
-    //　ピクセルデータの読み込み
-    fread( m_pImageData, sizeof(unsigned char), m_ImageSize, fp );
+    // 2Dスライスごとのサーフェイス情報を読み込み時に一度だけ算出する.
+    // テーブルはミップレベル順に並べ，ファイル上の並び (配列要素 -> 面 -> ミップ -> 奥行) はオフセットで表す.
+    m_Surfaces.resize( GetSurfaceIndex( m_MipmapCount, 0 ) );
+
+    size_t offset = 0;
+
+    for ( unsigned int item=0; item<m_ArraySize; ++item )
+    {
+        for ( unsigned int face=0; face<m_FaceCount; ++face )
+        {
+            unsigned int w = m_Width;
+            unsigned int h = m_Height;
+            unsigned int d = m_Depth;
+
+            for ( unsigned int i=0; i<m_MipmapCount; ++i )
+            {
+                // 32bit環境でもオーバーフローしないよう64bitで計算する.
+                const unsigned long long size = ( m_BlockSize != 0 )
+                    ? ( ( w + 3ull ) / 4 ) * ( ( h + 3ull ) / 4 ) * m_BlockSize
+                    : static_cast<unsigned long long>( w ) * h * m_BytePerPixel;
+
+                for ( unsigned int slice=0; slice<d; ++slice )
+                {
+                    // ファイルが途中で切れていないかチェック.
+                    // オフセットとサイズは32bitで保持するので，4GBを超えるファイルも弾く.
+                    if ( size > dataSize - offset || offset + size > 0xffffffff )
+                    {
+                        ELOG( "Error : Unexpected End Of File." );
+                        Release();
+                        return false;
+                    }
+
+                    const unsigned int layer = ( m_Depth > 1 ) ? slice : item * m_FaceCount + face;
 
-    //　ファイルを閉じる
-    fclose( fp );
+                    Surface& surface = m_Surfaces[ GetSurfaceIndex( i, layer ) ];
+                    surface.offset = static_cast<unsigned int>( offset );
+                    surface.size   = static_cast<unsigned int>( size );
+                    surface.width  = w;
+                    surface.height = h;
+                    surface.depth  = d;
+
+                    offset += static_cast<size_t>( size );
+                }
+
+                w = ( w > 1 ) ? ( w >> 1 ) : 1;
+                h = ( h > 1 ) ? ( h >> 1 ) : 1;
+                d = ( d > 1 ) ? ( d >> 1 ) : 1;
+            }
+        }
+    }
+
+    //　テクセルデータはマップされたファイルを直接参照する.
+    m_ImageSize  = static_cast<unsigned int>( offset );
+    m_pImageData = pFile + dataOffset;
 
     // 正常終了.
     return true;
@@ -557,29 +1026,44 @@ bool DdsImage::CreateGLTexture()
     if ( m_pImageData == nullptr )
     { return false; }
 
+    if ( !IsSupportTarget( m_Target ) )
+    {
+        ELOG( "Error : Texture Target Not Support On This GL. Target = 0x%x", m_Target );
+        return false;
+    }
+
     glEnable( GL_TEXTURE_2D );
 
     //　テクスチャを生成
     glGenTextures(1, &m_ID);
 
     //　テクスチャをバインドする
-    glBindTexture( GL_TEXTURE_2D, m_ID );
+    glBindTexture( m_Target, m_ID );
 
     //　拡大・縮小する方法の指定
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+    glTexParameteri( m_Target, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glTexParameteri( m_Target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+
+    // ファイルに含まれるミップレベルまでで完全なテクスチャとする.
+    glTexParameteri( m_Target, GL_TEXTURE_MAX_LEVEL, int( m_MipmapCount - 1 ) );
 
     //　テクスチャ環境の設定
     glTexEnvi( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE );
 
-    //　解凍作業
-    DecompressBC();
+    //　転送
+    const bool result = ( m_BlockSize != 0 ) ? DecompressBC() : UploadUncompressed();
 
     // アンバインドしておく.
-    glBindTexture( GL_TEXTURE_2D, 0 );
+    glBindTexture( m_Target, 0 );
 
     glDisable( GL_TEXTURE_2D );
 
+    if ( !result )
+    {
+        DeleteGLTexture();
+        return false;
+    }
+
     // 正常終了.
     return true;
 }
@@ -587,37 +1071,260 @@ bool DdsImage::CreateGLTexture()
 //-------------------------------------------------------------------------------------------
 //      ブロック圧縮を解凍します.
 //-------------------------------------------------------------------------------------------
-void DdsImage::DecompressBC()
+bool DdsImage::DecompressBC()
 {
-    int blockSize = 0;
-    int offset    = 0;
-    int size      = 0;
+    BC_FORMAT  bcFormat;
+    const bool isSRGB = IsSRGBCompressedFormat( m_Format );
+    if ( ToBCFormat( m_Format, bcFormat )
+      && ( !IsSupportCompressedFormat( bcFormat ) || ( isSRGB && !GLEW_EXT_texture_sRGB ) ) )
+    {
+        // GLが圧縮フォーマットに対応していない場合はCPUでRGBA8に展開して転送する.
+        const unsigned int internalFormat = ( isSRGB ) ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+        std::vector<unsigned char> pixels( size_t( m_Width ) * m_Height * 4 );
 
-    int w = m_Width;
-    int h = m_Height;
+        glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
 
-    //　BC1, BC4の場合.
-    if ( ( m_Format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT )
-      || ( m_Format == GL_COMPRESSED_SIGNED_RED_RGTC1_EXT )
-      || ( m_Format == GL_COMPRESSED_RED_RGTC1_EXT ) )
-    { blockSize = 8; }
-    //　BC2, BC3, BC5, BC6H, BC7の場合.
-    else
-    { blockSize = 16; }
+        AllocateStorage( internalFormat, GL_RGBA, GL_UNSIGNED_BYTE, false );
 
-    //　解凍
+        for ( unsigned int i=0; i<m_MipmapCount; i++ )
+        {
+            const unsigned int layerCount = GetLayerCount( i );
+            for ( unsigned int layer=0; layer<layerCount; ++layer )
+            {
+                const Surface& surface = GetSurface( i, layer );
+                DecodeBC( bcFormat, m_pImageData + surface.offset, surface.width, surface.height, &pixels[0] );
+                UploadSlice( i, layer, internalFormat, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0], false );
+            }
+        }
+        return true;
+    }
+
+    // BC6H, BC7はCPU展開を持たないので，非対応の場合はエラーとする.
+    if ( IsBPTCFormat( m_Format ) && !GLEW_VERSION_4_2 && !GLEW_ARB_texture_compression_bptc )
+    {
+        ELOG( "Error : BC6H/BC7 Not Support On This GL." );
+        return false;
+    }
+
+    AllocateStorage( m_Format, 0, 0, true );
+
+    //　マップされたファイルから直接転送する.
     for ( unsigned int i=0; i<m_MipmapCount; i++ )
     {
-        size = ( ( w + 3 ) / 4 ) * ( ( h + 3 ) / 4 ) * blockSize;
-        glCompressedTexImage2D( GL_TEXTURE_2D, int(i), m_Format, w, h, 0, size, m_pImageData + offset );
+        const unsigned int layerCount = GetLayerCount( i );
+        for ( unsigned int layer=0; layer<layerCount; ++layer )
+        { UploadSlice( i, layer, m_Format, 0, 0, GetSurfaceData( i, layer ), true ); }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      非圧縮フォーマットを転送します.
+//-------------------------------------------------------------------------------------------
+bool DdsImage::UploadUncompressed()
+{
+    if ( IsFloatFormat( m_InternalFormat ) && !GLEW_VERSION_3_0 && !GLEW_ARB_texture_float )
+    {
+        ELOG( "Error : Floating Point Texture Not Support On This GL." );
+        return false;
+    }
+
+    // 半精度の転送に対応していない場合だけ単精度に変換する.
+    const bool         halfToFloat = ( m_ConvertType == CONVERT_TYPE_HALF_TO_FLOAT ) && !IsSupportHalfFloatPixel();
+    const bool         cxv8u8      = ( m_ConvertType == CONVERT_TYPE_CXV8U8 );
+    const unsigned int type        = ( halfToFloat ) ? GL_FLOAT : m_Type;
+
+    std::vector<unsigned char> temp;
+    if ( halfToFloat )
+    { temp.resize( m_Surfaces[0].size * 2 ); }
+    else if ( cxv8u8 )
+    { temp.resize( size_t( m_Width ) * m_Height * 3 ); }
+
+    // DDSの行はパディングされない.
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+
+    AllocateStorage( m_InternalFormat, m_Format, type, false );
+
+    for ( unsigned int i=0; i<m_MipmapCount; i++ )
+    {
+        const unsigned int layerCount = GetLayerCount( i );
+        for ( unsigned int layer=0; layer<layerCount; ++layer )
+        {
+            const Surface&       surface = GetSurface( i, layer );
+            const unsigned char* pPixels = m_pImageData + surface.offset;
+
+            if ( halfToFloat )
+            {
+                ConvertHalfToFloat(
+                    reinterpret_cast<const unsigned short*>( pPixels ),
+                    reinterpret_cast<float*>( &temp[0] ),
+                    surface.size / 2 );
+                pPixels = &temp[0];
+            }
+            else if ( cxv8u8 )
+            {
+                ConvertCxV8U8ToRGB8( pPixels, &temp[0], size_t( surface.width ) * surface.height );
+                pPixels = &temp[0];
+            }
+
+            UploadSlice( i, layer, m_InternalFormat, m_Format, type, pPixels, false );
+        }
+    }
+
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      3Dテクスチャ・テクスチャ配列の領域を確保します.
+//-------------------------------------------------------------------------------------------
+void DdsImage::AllocateStorage
+(
+    unsigned int    internalFormat,
+    unsigned int    format,
+    unsigned int    type,
+    bool            compressed
+)
+{
+    // 2Dテクスチャとキューブマップはスライスごとに確保と転送を同時に行う.
+    if ( ( m_Target == GL_TEXTURE_2D ) || ( m_Target == GL_TEXTURE_CUBE_MAP ) )
+    { return; }
+
+    for ( unsigned int i=0; i<m_MipmapCount; ++i )
+    {
+        const Surface&     surface    = GetSurface( i, 0 );
+        const unsigned int layerCount = GetLayerCount( i );
 
-        w = ( w >> 1 );
-        h = ( h >> 1 );
-        if ( w < 1 ) { w = 1; }
-        if ( h < 1 ) { h = 1; }
+        if ( compressed )
+        {
+            glCompressedTexImage3D(
+                m_Target,
+                int(i),
+                internalFormat,
+                surface.width,
+                surface.height,
+                layerCount,
+                0,
+                surface.size * layerCount,
+                nullptr );
+        }
+        else
+        {
+            glTexImage3D(
+                m_Target,
+                int(i),
+                internalFormat,
+                surface.width,
+                surface.height,
+                layerCount,
+                0,
+                format,
+                type,
+                nullptr );
+        }
+    }
+}
 
-        offset += size;
+//-------------------------------------------------------------------------------------------
+//      2Dスライスを転送します.
+//-------------------------------------------------------------------------------------------
+void DdsImage::UploadSlice
+(
+    unsigned int    mipLevel,
+    unsigned int    layer,
+    unsigned int    internalFormat,
+    unsigned int    format,
+    unsigned int    type,
+    const void*     pPixels,
+    bool            compressed
+)
+{
+    const Surface& surface = GetSurface( mipLevel, layer );
+
+    if ( ( m_Target == GL_TEXTURE_2D ) || ( m_Target == GL_TEXTURE_CUBE_MAP ) )
+    {
+        // キューブマップの面の並びは DDS と GL で同じ (+X, -X, +Y, -Y, +Z, -Z).
+        const unsigned int target = ( m_Target == GL_TEXTURE_CUBE_MAP )
+                                  ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + layer
+                                  : GL_TEXTURE_2D;
+
+        if ( compressed )
+        {
+            glCompressedTexImage2D(
+                target,
+                int(mipLevel),
+                internalFormat,
+                surface.width,
+                surface.height,
+                0,
+                surface.size,
+                pPixels );
+        }
+        else
+        {
+            glTexImage2D(
+                target,
+                int(mipLevel),
+                internalFormat,
+                surface.width,
+                surface.height,
+                0,
+                format,
+                type,
+                pPixels );
+        }
+        return;
     }
+
+    // 3Dテクスチャ・テクスチャ配列は確保済みの領域にスライス単位で転送する.
+    if ( compressed )
+    {
+        glCompressedTexSubImage3D(
+            m_Target,
+            int(mipLevel),
+            0,
+            0,
+            int(layer),
+            surface.width,
+            surface.height,
+            1,
+            internalFormat,
+            surface.size,
+            pPixels );
+    }
+    else
+    {
+        glTexSubImage3D(
+            m_Target,
+            int(mipLevel),
+            0,
+            0,
+            int(layer),
+            surface.width,
+            surface.height,
+            1,
+            format,
+            type,
+            pPixels );
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      サーフェイステーブルのインデックスを取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int DdsImage::GetSurfaceIndex( unsigned int mipLevel, unsigned int layer ) const
+{
+    if ( m_Depth <= 1 )
+    { return mipLevel * m_ArraySize * m_FaceCount + layer; }
+
+    // ボリュームテクスチャはミップレベルごとに奥行が変わる.
+    unsigned int index = 0;
+    for ( unsigned int i=0; i<mipLevel; ++i )
+    { index += GetLayerCount( i ); }
+
+    return index + layer;
 }
 
 
@@ -638,3 +1345,119 @@ void DdsImage::DeleteGLTexture()
 //-------------------------------------------------------------------------------------------
 unsigned int DdsImage::GetID() const
 { return m_ID; }
+
+//-------------------------------------------------------------------------------------------
+//      サーフェイスをRGBA8に展開します.
+//-------------------------------------------------------------------------------------------
+bool DdsImage::Decode( unsigned int mipLevel, unsigned char* pDst, unsigned int threadCount ) const
+{ return Decode( mipLevel, 0, pDst, threadCount ); }
+
+//-------------------------------------------------------------------------------------------
+//      指定スライスのサーフェイスをRGBA8に展開します.
+//-------------------------------------------------------------------------------------------
+bool DdsImage::Decode( unsigned int mipLevel, unsigned int layer, unsigned char* pDst, unsigned int threadCount ) const
+{
+    if ( m_pImageData == nullptr || pDst == nullptr || mipLevel >= m_MipmapCount || layer >= GetLayerCount( mipLevel ) )
+    { return false; }
+
+    // 非圧縮フォーマットとBC6H, BC7は非対応.
+    BC_FORMAT bcFormat;
+    if ( !ToBCFormat( m_Format, bcFormat ) )
+    { return false; }
+
+    const Surface& surface = GetSurface( mipLevel, layer );
+    DecodeBC( bcFormat, m_pImageData + surface.offset, surface.width, surface.height, pDst, threadCount );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      画像の横幅を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int DdsImage::GetWidth() const
+{ return m_Width; }
+
+//-------------------------------------------------------------------------------------------
+//      画像の縦幅を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int DdsImage::GetHeight() const
+{ return m_Height; }
+
+//-------------------------------------------------------------------------------------------
+//      ボリュームテクスチャの奥行を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int DdsImage::GetDepth() const
+{ return m_Depth; }
+
+//-------------------------------------------------------------------------------------------
+//      テクスチャ配列の要素数を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int DdsImage::GetArraySize() const
+{ return m_ArraySize; }
+
+//-------------------------------------------------------------------------------------------
+//      GLのテクスチャターゲットを取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int DdsImage::GetTarget() const
+{ return m_Target; }
+
+//-------------------------------------------------------------------------------------------
+//      キューブマップかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool DdsImage::IsCubemap() const
+{ return ( m_FaceCount == 6 ); }
+
+//-------------------------------------------------------------------------------------------
+//      ボリュームテクスチャかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool DdsImage::IsVolume() const
+{ return ( m_Target == GL_TEXTURE_3D ); }
+
+//-------------------------------------------------------------------------------------------
+//      フォーマットを取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int DdsImage::GetFormat() const
+{ return m_Format; }
+
+//-------------------------------------------------------------------------------------------
+//      読み込んだ画像の色空間を取得します.
+//-------------------------------------------------------------------------------------------
+COLOR_SPACE DdsImage::GetColorSpace() const
+{ return m_ColorSpace; }
+
+//-------------------------------------------------------------------------------------------
+//      ミップマップ数を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int DdsImage::GetMipmapCount() const
+{ return m_MipmapCount; }
+
+//-------------------------------------------------------------------------------------------
+//      指定ミップレベルに含まれる2Dスライス数を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int DdsImage::GetLayerCount( unsigned int mipLevel ) const
+{
+    if ( m_Depth > 1 )
+    {
+        const unsigned int depth = m_Depth >> mipLevel;
+        return ( depth > 1 ) ? depth : 1;
+    }
+
+    return m_ArraySize * m_FaceCount;
+}
+
+//-------------------------------------------------------------------------------------------
+//      サーフェイス情報を取得します.
+//-------------------------------------------------------------------------------------------
+const DdsImage::Surface& DdsImage::GetSurface( unsigned int mipLevel, unsigned int layer ) const
+{ return m_Surfaces[ GetSurfaceIndex( mipLevel, layer ) ]; }
+
+//-------------------------------------------------------------------------------------------
+//      サーフェイスのピクセルデータを取得します.
+//-------------------------------------------------------------------------------------------
+const unsigned char* DdsImage::GetSurfaceData( unsigned int mipLevel, unsigned int layer ) const
+{
+    if ( m_pImageData == nullptr || mipLevel >= m_MipmapCount || layer >= GetLayerCount( mipLevel ) )
+    { return nullptr; }
+
+    return m_pImageData + m_Surfaces[ GetSurfaceIndex( mipLevel, layer ) ].offset;
+}
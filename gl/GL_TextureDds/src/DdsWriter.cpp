@@ -0,0 +1,284 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : DdsWriter.cpp
+// Desc : Direct Draw Surface Texture Writer.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <DdsWriter.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+
+#ifndef ELOG
+#define ELOG( x, ... )  fprintf_s( stderr, "[File : %s, Line : %d] "x"\n", __FILE__, __LINE__, ##__VA_ARGS__ )
+#endif//ELOG
+
+
+namespace /* anonymous */ {
+
+//------------------------------------------------------------------------------------------
+// Constant Values
+//------------------------------------------------------------------------------------------
+static const unsigned int DDSD_CAPS         = 0x00000001;
+static const unsigned int DDSD_HEIGHT       = 0x00000002;
+static const unsigned int DDSD_WIDTH        = 0x00000004;
+static const unsigned int DDSD_PIXELFORMAT  = 0x00001000;
+static const unsigned int DDSD_MIPMAPCOUNT  = 0x00020000;
+static const unsigned int DDSD_LINEARSIZE   = 0x00080000;
+static const unsigned int DDPF_FOURCC       = 0x00000004;
+static const unsigned int DDSCAPS_COMPLEX   = 0x00000008;
+static const unsigned int DDSCAPS_TEXTURE   = 0x00001000;
+static const unsigned int DDSCAPS_MIPMAP    = 0x00400000;
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// DDSHeader structure
+////////////////////////////////////////////////////////////////////////////////////////////
+struct DDSHeader
+{
+    unsigned int    size;
+    unsigned int    flags;
+    unsigned int    height;
+    unsigned int    width;
+    unsigned int    pitch;
+    unsigned int    depth;
+    unsigned int    mipMapLevels;
+    unsigned int    reserved1[ 11 ];
+    unsigned int    pfSize;
+    unsigned int    pfFlags;
+    unsigned int    pfFourCC;
+    unsigned int    pfBpp;
+    unsigned int    pfMaskR;
+    unsigned int    pfMaskG;
+    unsigned int    pfMaskB;
+    unsigned int    pfMaskA;
+    unsigned int    caps;
+    unsigned int    caps2;
+    unsigned int    caps3;
+    unsigned int    caps4;
+    unsigned int    reserved2;
+};
+
+
+//-------------------------------------------------------------------------------------------
+//      FourCCを生成します.
+//-------------------------------------------------------------------------------------------
+inline unsigned int MakeFourCC( char a, char b, char c, char d )
+{
+    return static_cast<unsigned int>( static_cast<unsigned char>( a ) )
+        | ( static_cast<unsigned int>( static_cast<unsigned char>( b ) ) << 8 )
+        | ( static_cast<unsigned int>( static_cast<unsigned char>( c ) ) << 16 )
+        | ( static_cast<unsigned int>( static_cast<unsigned char>( d ) ) << 24 );
+}
+
+//-------------------------------------------------------------------------------------------
+//      ブロック圧縮フォーマットに対応するFourCCを取得します.
+//-------------------------------------------------------------------------------------------
+bool GetFourCC( BC_FORMAT format, unsigned int& fourCC )
+{
+    switch( format )
+    {
+    case BC_FORMAT_BC1:  { fourCC = MakeFourCC( 'D', 'X', 'T', '1' ); } return true;
+    case BC_FORMAT_BC2:  { fourCC = MakeFourCC( 'D', 'X', 'T', '3' ); } return true;
+    case BC_FORMAT_BC3:  { fourCC = MakeFourCC( 'D', 'X', 'T', '5' ); } return true;
+    case BC_FORMAT_BC4U: { fourCC = MakeFourCC( 'A', 'T', 'I', '1' ); } return true;
+    case BC_FORMAT_BC4S: { fourCC = MakeFourCC( 'B', 'C', '4', 'S' ); } return true;
+    case BC_FORMAT_BC5U: { fourCC = MakeFourCC( 'A', 'T', 'I', '2' ); } return true;
+    case BC_FORMAT_BC5S: { fourCC = MakeFourCC( 'B', 'C', '5', 'S' ); } return true;
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------
+//      2x2のボックスフィルタで縮小します.
+//-------------------------------------------------------------------------------------------
+void Downsample
+(
+    const unsigned char*    pSrc,
+    unsigned int            srcW,
+    unsigned int            srcH,
+    unsigned char*          pDst,
+    unsigned int            dstW,
+    unsigned int            dstH
+)
+{
+    for( unsigned int y=0; y<dstH; ++y )
+    {
+        const unsigned int y0 = ( y * 2     < srcH ) ? y * 2     : srcH - 1;
+        const unsigned int y1 = ( y * 2 + 1 < srcH ) ? y * 2 + 1 : srcH - 1;
+
+        for( unsigned int x=0; x<dstW; ++x )
+        {
+            const unsigned int x0 = ( x * 2     < srcW ) ? x * 2     : srcW - 1;
+            const unsigned int x1 = ( x * 2 + 1 < srcW ) ? x * 2 + 1 : srcW - 1;
+
+            const unsigned char* p00 = pSrc + ( size_t( y0 ) * srcW + x0 ) * 4;
+            const unsigned char* p01 = pSrc + ( size_t( y0 ) * srcW + x1 ) * 4;
+            const unsigned char* p10 = pSrc + ( size_t( y1 ) * srcW + x0 ) * 4;
+            const unsigned char* p11 = pSrc + ( size_t( y1 ) * srcW + x1 ) * 4;
+
+            unsigned char* pOut = pDst + ( size_t( y ) * dstW + x ) * 4;
+            for( int c=0; c<4; ++c )
+            { pOut[c] = static_cast<unsigned char>( ( p00[c] + p01[c] + p10[c] + p11[c] + 2 ) / 4 ); }
+        }
+    }
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------
+//      ブロック圧縮済みのデータをDDSファイルに書き出します.
+//-------------------------------------------------------------------------------------------
+bool SaveDDS
+(
+    const char*             filename,
+    BC_FORMAT               format,
+    unsigned int            width,
+    unsigned int            height,
+    unsigned int            mipCount,
+    const unsigned char*    pData,
+    size_t                  size
+)
+{
+    unsigned int fourCC;
+    if ( !GetFourCC( format, fourCC ) )
+    {
+        ELOG( "Error : Unsupported format." );
+        return false;
+    }
+
+    DDSHeader header;
+    memset( &header, 0, sizeof(header) );
+
+    header.size         = sizeof(DDSHeader);
+    header.flags        = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE;
+    header.height       = height;
+    header.width        = width;
+    header.pitch        = static_cast<unsigned int>( GetBCSurfaceSize( format, width, height ) );
+    header.mipMapLevels = mipCount;
+    header.pfSize       = 32;
+    header.pfFlags      = DDPF_FOURCC;
+    header.pfFourCC     = fourCC;
+    header.caps         = DDSCAPS_TEXTURE;
+
+    if ( mipCount > 1 )
+    {
+        header.flags |= DDSD_MIPMAPCOUNT;
+        header.caps  |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+    }
+
+    FILE* fp;
+    errno_t err = fopen_s( &fp, filename, "wb" );
+    if ( err != 0 )
+    {
+        ELOG( "Error : File Open Failed. FileName = %s", filename );
+        return false;
+    }
+
+    const char magic[4] = { 'D', 'D', 'S', ' ' };
+    bool result = ( fwrite( magic, sizeof(magic), 1, fp ) == 1 )
+               && ( fwrite( &header, sizeof(header), 1, fp ) == 1 )
+               && ( fwrite( pData, 1, size, fp ) == size );
+
+    fclose( fp );
+
+    if ( !result )
+    { ELOG( "Error : File Write Failed. FileName = %s", filename ); }
+
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------
+//      画像をミップマップ付きでブロック圧縮し，DDSファイルに書き出します.
+//-------------------------------------------------------------------------------------------
+bool CompressToDDS
+(
+    const char*             filename,
+    const unsigned char*    pPixels,
+    unsigned int            width,
+    unsigned int            height,
+    unsigned int            bytePerPixel,
+    BC_FORMAT               format,
+    BC_QUALITY              quality,
+    bool                    flipVertical,
+    unsigned int            threadCount
+)
+{
+    if ( pPixels == nullptr || width == 0 || height == 0 )
+    { return false; }
+
+    if ( bytePerPixel != 3 && bytePerPixel != 4 )
+    {
+        ELOG( "Error : Unsupported pixel size. bytePerPixel = %u", bytePerPixel );
+        return false;
+    }
+
+    // RGBA8に展開.
+    std::vector<unsigned char> level( size_t( width ) * height * 4 );
+    for( unsigned int y=0; y<height; ++y )
+    {
+        const unsigned int   srcY = flipVertical ? ( height - 1 - y ) : y;
+        const unsigned char* pSrc = pPixels + size_t( srcY ) * width * bytePerPixel;
+        unsigned char*       pDst = &level[ size_t( y ) * width * 4 ];
+
+        for( unsigned int x=0; x<width; ++x )
+        {
+            pDst[ x * 4 + 0 ] = pSrc[ x * bytePerPixel + 0 ];
+            pDst[ x * 4 + 1 ] = pSrc[ x * bytePerPixel + 1 ];
+            pDst[ x * 4 + 2 ] = pSrc[ x * bytePerPixel + 2 ];
+            pDst[ x * 4 + 3 ] = ( bytePerPixel == 4 ) ? pSrc[ x * bytePerPixel + 3 ] : 255;
+        }
+    }
+
+    // 1x1 までのミップマップ数と合計サイズを求める.
+    unsigned int mipCount  = 1;
+    size_t       totalSize = 0;
+    {
+        unsigned int w = width;
+        unsigned int h = height;
+        totalSize += GetBCSurfaceSize( format, w, h );
+        while( w > 1 || h > 1 )
+        {
+            w = ( w > 1 ) ? ( w >> 1 ) : 1;
+            h = ( h > 1 ) ? ( h >> 1 ) : 1;
+            totalSize += GetBCSurfaceSize( format, w, h );
+            mipCount++;
+        }
+    }
+
+    std::vector<unsigned char> compressed( totalSize );
+    std::vector<unsigned char> next;
+
+    size_t       offset = 0;
+    unsigned int w      = width;
+    unsigned int h      = height;
+
+    for( unsigned int i=0; i<mipCount; ++i )
+    {
+        if ( !EncodeBC( format, &level[0], w, h, &compressed[ offset ], quality, threadCount ) )
+        {
+            ELOG( "Error : Block Compression Failed." );
+            return false;
+        }
+        offset += GetBCSurfaceSize( format, w, h );
+
+        if ( i + 1 < mipCount )
+        {
+            const unsigned int nw = ( w > 1 ) ? ( w >> 1 ) : 1;
+            const unsigned int nh = ( h > 1 ) ? ( h >> 1 ) : 1;
+            next.resize( size_t( nw ) * nh * 4 );
+            Downsample( &level[0], w, h, &next[0], nw, nh );
+            level.swap( next );
+            w = nw;
+            h = nh;
+        }
+    }
+
+    return SaveDDS( filename, format, width, height, mipCount, &compressed[0], compressed.size() );
+}
@@ -0,0 +1,125 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : PixelConverter.cpp
+// Desc : Pixel Format Conversion Kernels.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <PixelConverter.h>
+#include <cstring>
+#include <cmath>
+
+#if defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 ) || defined(__SSE2__)
+    #define PC_ENABLE_SSE2      1
+    #include <emmintrin.h>
+#else
+    #define PC_ENABLE_SSE2      0
+#endif
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+static const unsigned int HALF_MASK_NOSIGN  = 0x7fff;               // 符号を除いたビット.
+static const unsigned int HALF_WAS_INFNAN   = 0x7bff;               // これより大きければ無限大/NaN.
+static const unsigned int FLOAT_MAGIC       = ( 254 - 15 ) << 23;   // 指数を補正する乗数 (2^112).
+static const unsigned int FLOAT_EXP_INFNAN  = 255 << 23;            // 無限大/NaNの指数.
+
+
+//-------------------------------------------------------------------------------------------
+//      半精度浮動小数を1つ変換します.
+//-------------------------------------------------------------------------------------------
+inline float HalfToFloat( unsigned short value )
+{
+    const unsigned int expmant = value & HALF_MASK_NOSIGN;
+    const unsigned int sign    = ( value ^ expmant ) << 16;
+
+    // 指数と仮数を単精度の位置にずらし，乗算で指数のバイアスを補正する.
+    // 非正規化数も乗算によって正しく正規化される.
+    unsigned int shifted = expmant << 13;
+    float        scaled;
+    float        magic;
+    memcpy( &scaled, &shifted, sizeof(float) );
+    memcpy( &magic,  &FLOAT_MAGIC, sizeof(float) );
+    scaled *= magic;
+
+    unsigned int bits;
+    memcpy( &bits, &scaled, sizeof(float) );
+
+    if ( expmant > HALF_WAS_INFNAN )
+    { bits |= FLOAT_EXP_INFNAN; }
+
+    bits |= sign;
+
+    float result;
+    memcpy( &result, &bits, sizeof(float) );
+    return result;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------
+//      半精度浮動小数を単精度浮動小数に変換します.
+//-------------------------------------------------------------------------------------------
+void ConvertHalfToFloat( const unsigned short* pSrc, float* pDst, size_t count )
+{
+    size_t i = 0;
+
+#if PC_ENABLE_SSE2
+    const __m128i maskNoSign = _mm_set1_epi32( HALF_MASK_NOSIGN );
+    const __m128i wasInfNan  = _mm_set1_epi32( HALF_WAS_INFNAN );
+    const __m128i expInfNan  = _mm_set1_epi32( FLOAT_EXP_INFNAN );
+    const __m128  magic      = _mm_castsi128_ps( _mm_set1_epi32( FLOAT_MAGIC ) );
+    const __m128i zero       = _mm_setzero_si128();
+
+    // 8要素ずつ変換する.
+    for( ; i + 8 <= count; i += 8 )
+    {
+        const __m128i halves = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pSrc + i ) );
+
+        for( int j=0; j<2; ++j )
+        {
+            const __m128i h        = ( j == 0 ) ? _mm_unpacklo_epi16( halves, zero ) : _mm_unpackhi_epi16( halves, zero );
+            const __m128i expmant  = _mm_and_si128( maskNoSign, h );
+            const __m128i justSign = _mm_xor_si128( h, expmant );
+            const __m128  scaled   = _mm_mul_ps( _mm_castsi128_ps( _mm_slli_epi32( expmant, 13 ) ), magic );
+            const __m128i isInfNan = _mm_cmpgt_epi32( expmant, wasInfNan );
+            const __m128i sign     = _mm_slli_epi32( justSign, 16 );
+            const __m128i infNan   = _mm_and_si128( isInfNan, expInfNan );
+            const __m128  result   = _mm_or_ps( scaled, _mm_castsi128_ps( _mm_or_si128( sign, infNan ) ) );
+
+            _mm_storeu_ps( pDst + i + j * 4, result );
+        }
+    }
+#endif
+
+    // 端数.
+    for( ; i<count; ++i )
+    { pDst[i] = HalfToFloat( pSrc[i] ); }
+}
+
+//-------------------------------------------------------------------------------------------
+//      CxV8U8 を符号付きRGB8に変換します.
+//-------------------------------------------------------------------------------------------
+void ConvertCxV8U8ToRGB8( const unsigned char* pSrc, unsigned char* pDst, size_t pixelCount )
+{
+    for( size_t i=0; i<pixelCount; ++i )
+    {
+        const signed char u = static_cast<signed char>( pSrc[ i * 2 + 0 ] );
+        const signed char v = static_cast<signed char>( pSrc[ i * 2 + 1 ] );
+
+        const float x  = u / 127.0f;
+        const float y  = v / 127.0f;
+        const float zz = 1.0f - x * x - y * y;
+        const float z  = ( zz > 0.0f ) ? sqrtf( zz ) : 0.0f;
+
+        pDst[ i * 3 + 0 ] = static_cast<unsigned char>( u );
+        pDst[ i * 3 + 1 ] = static_cast<unsigned char>( v );
+        pDst[ i * 3 + 2 ] = static_cast<unsigned char>( static_cast<signed char>( z * 127.0f + 0.5f ) );
+    }
+}
@@ -24,6 +24,11 @@
 #include <DdsLoader.h>
 
 
+#ifndef GL_FRAMEBUFFER_SRGB
+#define GL_FRAMEBUFFER_SRGB      0x8DB9
+#endif//GL_FRAMEBUFFER_SRGB
+
+
 namespace /* anonymous */ {
 
 //-------------------------------------------------------------------------------------------
@@ -70,7 +75,12 @@ int main( int argc, char** argv )
         glutSetOption( GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_GLUTMAINLOOP_RETURNS );
         glutInitWindowPosition( g_WindowPositionX, g_WindowPositionY );
         glutInitWindowSize( g_WindowWidth, g_WindowHeight );
+    #ifdef GLUT_SRGB
+        // sRGBテクスチャを正しく表示するため，sRGB対応のフレームバッファを要求する.
+        glutInitDisplayMode( GLUT_RGBA | GLUT_DEPTH | GLUT_DOUBLE | GLUT_SRGB );
+    #else
         glutInitDisplayMode( GLUT_RGBA | GLUT_DEPTH | GLUT_DOUBLE );
+    #endif//GLUT_SRGB
         glutCreateWindow( g_WindowTitle );
         glutDisplayFunc( OnDisplay );
         glutReshapeFunc( OnReshape );
@@ -110,6 +120,10 @@ bool OnInit()
     if ( !g_Texture.CreateGLTexture() )
     { return false; }
 
+    // sRGBテクスチャは線形にデコードされるため，書き込み時にsRGBへ戻す.
+    if ( g_Texture.GetColorSpace() == COLOR_SPACE_SRGB )
+    { glEnable( GL_FRAMEBUFFER_SRGB ); }
+
     return true;
 }
 
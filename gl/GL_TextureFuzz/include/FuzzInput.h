@@ -0,0 +1,42 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : FuzzInput.h
+// Desc : Fuzzing Input Helper.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+#ifndef _FUZZ_INPUT_H_
+#define _FUZZ_INPUT_H_
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+
+
+//-------------------------------------------------------------------------------------------
+//! @brief      ファジング対象の関数です.
+//!
+//! @note       libFuzzer と同じシグネチャです. ローダーごとに1つのソースファイルで定義し，
+//!             ローダーごとに別の実行ファイルとしてビルドします.
+//! @param [in]     pData           入力データです.
+//! @param [in]     size            入力データのサイズです.
+//! @return     常に 0 を返却します.
+//-------------------------------------------------------------------------------------------
+extern "C" int LLVMFuzzerTestOneInput( const uint8_t* pData, size_t size );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      入力データを一時ファイルに書き出します.
+//!
+//! @note       ローダーはファイル名からしか読み込めないため，入力を一時ファイル経由で渡します.
+//!             ファイル名はプロセスごとに固定で，libFuzzer の -jobs による並列実行でも衝突しません.
+//!             初回呼び出し時にキャッシュの保存先を作成できないパスに設定し，
+//!             キャッシュの読み書きを行わずに毎回デコードさせます.
+//! @param [in]     pData           入力データです.
+//! @param [in]     size            入力データのサイズです.
+//! @return     書き出したファイルのパスを返却します. 失敗した場合は nullptr を返却します.
+//-------------------------------------------------------------------------------------------
+const char* WriteFuzzInput( const uint8_t* pData, size_t size );
+
+
+#endif//_FUZZ_INPUT_H_
@@ -0,0 +1,59 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : FuzzDds.cpp
+// Desc : Fuzzing Target for DdsImage.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <FuzzInput.h>
+#include <DdsLoader.h>
+#include <vector>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+static const size_t MAX_DECODE_PIXELS = 1 << 24;    // 1入力あたりに展開するピクセル数の上限.
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------
+//      DDSの読み込みとブロック圧縮の展開をファジングします.
+//-------------------------------------------------------------------------------------------
+extern "C" int LLVMFuzzerTestOneInput( const uint8_t* pData, size_t size )
+{
+    const char* pPath = WriteFuzzInput( pData, size );
+    if ( pPath == nullptr )
+    { return 0; }
+
+    DdsImage image;
+    if ( !image.Load( pPath ) )
+    { return 0; }
+
+    // ヘッダから求めたサーフェイスの位置が正しいかは展開してはじめて分かるので，
+    // 全ミップレベルの全スライスを上限まで展開する.
+    std::vector<unsigned char> pixels;
+    size_t budget = MAX_DECODE_PIXELS;
+
+    for( unsigned int mip=0; mip<image.GetMipmapCount(); ++mip )
+    {
+        for( unsigned int layer=0; layer<image.GetLayerCount( mip ); ++layer )
+        {
+            const DdsImage::Surface& surface = image.GetSurface( mip, layer );
+            const size_t count = size_t( surface.width ) * surface.height;
+            if ( count > budget )
+            { return 0; }
+
+            budget -= count;
+            pixels.resize( count * 4 );
+            image.Decode( mip, layer, pixels.data(), 1 );
+        }
+    }
+
+    return 0;
+}
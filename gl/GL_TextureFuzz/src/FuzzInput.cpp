@@ -0,0 +1,86 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : FuzzInput.cpp
+// Desc : Fuzzing Input Helper.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <FuzzInput.h>
+#include <TextureCache.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#ifdef _WIN32
+    #include <process.h>
+#else
+    #include <unistd.h>
+#endif
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+// Global Variables
+//-------------------------------------------------------------------------------------------
+std::string     g_InputPath;        // 入力を書き出す一時ファイルのパスです.
+
+
+//-------------------------------------------------------------------------------------------
+//      終了時に一時ファイルを削除します.
+//-------------------------------------------------------------------------------------------
+void RemoveInput()
+{ remove( g_InputPath.c_str() ); }
+
+//-------------------------------------------------------------------------------------------
+//      一時ファイルのパスを生成します.
+//-------------------------------------------------------------------------------------------
+std::string MakeInputPath()
+{
+#ifdef _WIN32
+    const char* pDir = getenv( "TEMP" );
+    const int   pid  = _getpid();
+#else
+    const char* pDir = getenv( "TMPDIR" );
+    const int   pid  = static_cast<int>( getpid() );
+    if ( pDir == nullptr )
+    { pDir = "/tmp"; }
+#endif
+
+    char name[64];
+    sprintf_s( name, sizeof( name ), "asura_fuzz_%d.bin", pid );
+
+    std::string path = ( pDir != nullptr ) ? pDir : ".";
+    path += "/";
+    path += name;
+    return path;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------
+//      入力データを一時ファイルに書き出します.
+//-------------------------------------------------------------------------------------------
+const char* WriteFuzzInput( const uint8_t* pData, size_t size )
+{
+    if ( g_InputPath.empty() )
+    {
+        g_InputPath = MakeInputPath();
+        atexit( RemoveInput );
+
+        // 通常ファイルの下にはディレクトリを作れないので，キャッシュは常に保存に失敗する.
+        TextureCache::SetDirectory( ( g_InputPath + "/cache" ).c_str() );
+    }
+
+    FILE* pFile = nullptr;
+    if ( fopen_s( &pFile, g_InputPath.c_str(), "wb" ) != 0 )
+    { return nullptr; }
+
+    const bool succeeded = ( size == 0 ) || ( fwrite( pData, 1, size, pFile ) == size );
+    fclose( pFile );
+
+    return succeeded ? g_InputPath.c_str() : nullptr;
+}
@@ -0,0 +1,220 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : FuzzMain.cpp
+// Desc : Fuzzing Driver for Non-libFuzzer Builds.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+//  ファジング対象(FuzzBmp.cpp / FuzzTga.cpp / FuzzDds.cpp)はローダーごとに別の実行ファイルです.
+//
+//  libFuzzer でビルドする場合はこのファイルを含めずにリンクします. 例)
+//      clang++ -g -O1 -fsanitize=fuzzer,address -I../include -I../../GL_TextureBmp/include
+//          ../src/FuzzBmp.cpp ../src/FuzzInput.cpp <GL_TextureFuzzBmp.vcxproj と同じローダーのソース>
+//          -o fuzz_bmp
+//      ./fuzz_bmp ../corpus/bmp
+//
+//  libFuzzer が使えない環境(VS2012 など)ではこのファイルをリンクし，コーパスの再生と
+//  簡易的な変異による検査を行います. 例)
+//      GL_TextureFuzzBmp.exe ../corpus/bmp crash-xxxx -runs 10000 -seed 1
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <FuzzInput.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <iostream>
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif//WIN32_LEAN_AND_MEAN
+    #ifndef NOMINMAX
+    #define NOMINMAX
+    #endif//NOMINMAX
+    #include <Windows.h>
+#else
+    #include <dirent.h>
+    #include <sys/stat.h>
+#endif
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+static const size_t HEADER_BYTES = 256;     // 変異を集中させる先頭のバイト数.
+
+
+//-------------------------------------------------------------------------------------------
+//      使い方を表示します.
+//-------------------------------------------------------------------------------------------
+void PrintUsage()
+{
+    std::cout << "Usage : GL_TextureFuzz<Bmp|Tga|Dds> [options] <file or directory> ...\n"
+              << "  -runs <N>         run N mutated inputs after replaying the corpus (default: 0)\n"
+              << "  -seed <N>         random seed for mutations (default: 1)\n"
+              << std::endl;
+}
+
+//-------------------------------------------------------------------------------------------
+//      ディレクトリ内のファイルを列挙します.
+//-------------------------------------------------------------------------------------------
+bool ListFiles( const std::string& path, std::vector<std::string>& files )
+{
+#if defined(_WIN32)
+    WIN32_FIND_DATAA data;
+    HANDLE hFind = FindFirstFileA( ( path + "\\*" ).c_str(), &data );
+    if ( hFind == INVALID_HANDLE_VALUE )
+    { return false; }
+
+    do
+    {
+        if ( ( data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) == 0 )
+        { files.push_back( path + "/" + data.cFileName ); }
+    }
+    while( FindNextFileA( hFind, &data ) );
+
+    FindClose( hFind );
+#else
+    DIR* pDir = opendir( path.c_str() );
+    if ( pDir == nullptr )
+    { return false; }
+
+    struct dirent* pEntry = nullptr;
+    while( ( pEntry = readdir( pDir ) ) != nullptr )
+    {
+        const std::string fullPath = path + "/" + pEntry->d_name;
+        struct stat info;
+        if ( stat( fullPath.c_str(), &info ) == 0 && !S_ISDIR( info.st_mode ) )
+        { files.push_back( fullPath ); }
+    }
+
+    closedir( pDir );
+#endif
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      ファイルを全て読み込みます.
+//-------------------------------------------------------------------------------------------
+bool LoadInput( const std::string& path, std::vector<uint8_t>& data )
+{
+    FILE* pFile = nullptr;
+    if ( fopen_s( &pFile, path.c_str(), "rb" ) != 0 )
+    { return false; }
+
+    data.clear();
+
+    uint8_t buffer[4096];
+    size_t  count = 0;
+    while( ( count = fread( buffer, 1, sizeof( buffer ), pFile ) ) > 0 )
+    { data.insert( data.end(), buffer, buffer + count ); }
+
+    fclose( pFile );
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      入力を1つ実行します.
+//-------------------------------------------------------------------------------------------
+void RunOne( const std::vector<uint8_t>& data )
+{ LLVMFuzzerTestOneInput( data.empty() ? nullptr : &data[0], data.size() ); }
+
+//-------------------------------------------------------------------------------------------
+//      入力に変異を加えます.
+//-------------------------------------------------------------------------------------------
+void Mutate( std::mt19937& random, std::vector<uint8_t>& data )
+{
+    // 1/4 の確率で途中で切り詰める.
+    if ( !data.empty() && random() % 4 == 0 )
+    { data.resize( random() % data.size() ); }
+
+    const unsigned int count = 1 + random() % 8;
+    for( unsigned int i=0; i<count && !data.empty(); ++i )
+    {
+        // 半分はヘッダ付近を狙う. サイズやオフセットを壊した方が到達できる経路が多い.
+        const size_t range = ( random() % 2 ) ? std::min( data.size(), HEADER_BYTES ) : data.size();
+        const size_t pos   = random() % range;
+
+        switch( random() % 3 )
+        {
+        case 0: data[ pos ] ^= static_cast<uint8_t>( 1 << ( random() % 8 ) ); break;
+        case 1: data[ pos ]  = static_cast<uint8_t>( random() ); break;
+        case 2: data[ pos ]  = ( random() % 2 ) ? 0xff : 0x00; break;
+        }
+    }
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+    std::vector<std::string> files;
+    unsigned int runs = 0;
+    unsigned int seed = 1;
+
+    for( int i=1; i<argc; ++i )
+    {
+        const char* arg  = argv[i];
+        const char* next = ( i + 1 < argc ) ? argv[i + 1] : nullptr;
+
+        if ( strcmp( arg, "-runs" ) == 0 && next != nullptr )
+        { runs = static_cast<unsigned int>( atoi( next ) ); ++i; }
+        else if ( strcmp( arg, "-seed" ) == 0 && next != nullptr )
+        { seed = static_cast<unsigned int>( atoi( next ) ); ++i; }
+        else if ( arg[0] == '-' )
+        {
+            std::cerr << "Error : Invalid Option. " << arg << std::endl;
+            PrintUsage();
+            return -1;
+        }
+        else if ( !ListFiles( arg, files ) )
+        { files.push_back( arg ); }
+    }
+
+    if ( files.empty() )
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    // コーパスをそのまま再生する. クラッシュした入力もファイル名を指定すれば再現できる.
+    std::vector< std::vector<uint8_t> > corpus;
+    for( size_t i=0; i<files.size(); ++i )
+    {
+        std::vector<uint8_t> data;
+        if ( !LoadInput( files[i], data ) )
+        {
+            std::cerr << "Error : File Open Failed. " << files[i] << std::endl;
+            return -1;
+        }
+
+        std::cout << "[run] " << files[i] << " (" << data.size() << " bytes)" << std::endl;
+        RunOne( data );
+        corpus.push_back( data );
+    }
+
+    // 簡易的な変異による検査. 異常はサニタイザやデバッグランタイムで検出する.
+    std::mt19937 random( seed );
+    for( unsigned int i=0; i<runs; ++i )
+    {
+        std::vector<uint8_t> data = corpus[ random() % corpus.size() ];
+        Mutate( random, data );
+        RunOne( data );
+    }
+
+    std::cout << "Done : " << corpus.size() << " corpus file(s), " << runs << " mutated run(s)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,28 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : FuzzTga.cpp
+// Desc : Fuzzing Target for TgaImage.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <FuzzInput.h>
+#include <TgaLoader.h>
+
+
+//-------------------------------------------------------------------------------------------
+//      TGAの読み込みをファジングします.
+//-------------------------------------------------------------------------------------------
+extern "C" int LLVMFuzzerTestOneInput( const uint8_t* pData, size_t size )
+{
+    const char* pPath = WriteFuzzInput( pData, size );
+    if ( pPath == nullptr )
+    { return 0; }
+
+    // 読み込みでは展開とミップマップ生成まで行われる. GLコンテキストは不要.
+    TgaImage image;
+    image.Load( pPath );
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : JpegKernel.h
+// Desc : JPEG Decoding Kernels.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+#ifndef _JPEG_KERNEL_H_
+#define _JPEG_KERNEL_H_
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <cstddef>
+
+
+//-------------------------------------------------------------------------------------------
+//! @brief      逆DCT用の逆量子化テーブルを生成します.
+//!
+//! @note       AAN法のスケール係数と最終段の 1/8 を量子化値に畳み込んでおきます.
+//! @param [in]     pQuant      自然順(ジグザグ順ではない)の量子化テーブル(64要素)です.
+//! @param [out]    pTable      64要素の逆量子化テーブルの格納先です.
+//-------------------------------------------------------------------------------------------
+void BuildIdctTable( const unsigned short* pQuant, float* pTable );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      8x8ブロックを逆量子化・逆DCTし，8bitのサンプルとして書き出します.
+//!
+//! @param [in]     pCoef       自然順のDCT係数(64要素)です.
+//! @param [in]     pTable      BuildIdctTable() で生成した逆量子化テーブルです.
+//! @param [out]    pDst        左上サンプルの格納先です.
+//! @param [in]     stride      格納先の1行あたりのバイト数です.
+//-------------------------------------------------------------------------------------------
+void IdctBlock( const short* pCoef, const float* pTable, unsigned char* pDst, size_t stride );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      YCbCr (JFIF) の1行分をRGB8に変換します.
+//!
+//! @param [in]     pY          輝度です.
+//! @param [in]     pCb         色差(青)です.
+//! @param [in]     pCr         色差(赤)です.
+//! @param [out]    pDst        count * 3 バイトの格納先です.
+//! @param [in]     count       ピクセル数です.
+//-------------------------------------------------------------------------------------------
+void ConvertYCbCrToRGB(
+    const unsigned char*    pY,
+    const unsigned char*    pCb,
+    const unsigned char*    pCr,
+    unsigned char*          pDst,
+    size_t                  count );
+
+
+#endif//_JPEG_KERNEL_H_
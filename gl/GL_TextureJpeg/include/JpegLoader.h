@@ -0,0 +1,147 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : JpegLoader.h
+// Desc : JPEG File Interchange Format Texture Loader.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+#ifndef _JPEG_LOADER_H_
+#define _JPEG_LOADER_H_
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <TextureCache.h>
+#include <ColorSpace.h>
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// JpegImage class
+/////////////////////////////////////////////////////////////////////////////////////////////
+class JpegImage
+{
+    //=======================================================================================
+    // list of friend classes and methods.
+    //=======================================================================================
+    /* NOTHING */
+
+public:
+    //=======================================================================================
+    // public variables.
+    //=======================================================================================
+    /* NOTHING */
+
+    //=======================================================================================
+    // public methods.
+    //=======================================================================================
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------
+    JpegImage();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------
+    virtual ~JpegImage();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      テクスチャを読み込みします.
+    //!
+    //! @param [in]     filename        ファイル名です.
+    //! @retval true    読み込みに成功.
+    //! @retval false   読み込みに失敗.
+    //---------------------------------------------------------------------------------------
+    bool Load( const char* filename );
+   
+    //---------------------------------------------------------------------------------------
+    //! @brief      GLテクスチャを生成します.
+    //---------------------------------------------------------------------------------------
+    bool CreateGLTexture();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      GLテクスチャを破棄します.
+    //---------------------------------------------------------------------------------------
+    void DeleteGLTexture();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      解放処理を行います.
+    //---------------------------------------------------------------------------------------
+    void Release();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      テクスチャIDを取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetID() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      画像の横幅を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetWidth() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      画像の縦幅を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetHeight() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      1ピクセルあたりのバイト数を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetBytePerPixel() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      RGBに変換済みのピクセルデータを取得します.
+    //!
+    //! @note       キャッシュから読み込んだ場合はマップされたキャッシュファイル上のデータを返却します.
+    //---------------------------------------------------------------------------------------
+    const unsigned char* GetPixels() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      色空間の情報を持たない画像をどの色空間として扱うかを設定します.
+    //!
+    //! @note       Load() の前に呼び出します. 既定値は COLOR_SPACE_SRGB です.
+    //!             sRGBの場合は線形空間でミップマップを生成し，sRGBの内部フォーマットで転送します.
+    //!             法線マップなどのデータテクスチャには COLOR_SPACE_LINEAR を指定します.
+    //---------------------------------------------------------------------------------------
+    void SetColorSpaceHint( COLOR_SPACE colorSpace );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      読み込んだ画像の色空間を取得します.
+    //---------------------------------------------------------------------------------------
+    COLOR_SPACE GetColorSpace() const;
+
+protected:
+    //=======================================================================================
+    // protected variables.
+    //=======================================================================================
+    unsigned int    m_ImageSize;        //!< ピクセルサイズです.
+    unsigned int    m_Format;           //!< フォーマットです.
+    unsigned int    m_InternalFormat;   //!< 内部フォーマットです.
+    unsigned int    m_Width;            //!< 画像の横幅です.
+    unsigned int    m_Height;           //!< 画像の縦幅です.
+    unsigned int    m_BytePerPixel;     //!< 1ピクセルあたりのバイト数です.
+    unsigned int    m_ID;               //!< テクスチャIDです.
+    unsigned char*  m_pImageData;       //!< ピクセルデータです.
+    TextureCache    m_Cache;            //!< 変換済みテクスチャのキャッシュです.
+    COLOR_SPACE     m_ColorSpace;       //!< 読み込んだ画像の色空間です.
+    COLOR_SPACE     m_ColorSpaceHint;   //!< 色空間の情報を持たない画像に適用する色空間です.
+
+    //=======================================================================================
+    // protected methods.
+    //=======================================================================================
+    /* NOTHING */
+
+private:
+    //=======================================================================================
+    // private variables.
+    //=======================================================================================
+    /* NOTHING */
+
+    //=======================================================================================
+    // private methods.
+    //=======================================================================================
+    JpegImage        ( const JpegImage& value );     // アクセス禁止.
+    void operator = ( const JpegImage& value );     // アクセス禁止.
+};
+
+
+#endif //_JPEG_LOADER_H_
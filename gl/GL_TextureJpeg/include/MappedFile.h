@@ -0,0 +1,104 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : MappedFile.h
+// Desc : Read Only Memory Mapped File.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+#ifndef _MAPPED_FILE_H_
+#define _MAPPED_FILE_H_
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <cstddef>
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// MappedFile class
+/////////////////////////////////////////////////////////////////////////////////////////////
+class MappedFile
+{
+    //=======================================================================================
+    // list of friend classes and methods.
+    //=======================================================================================
+    /* NOTHING */
+
+public:
+    //=======================================================================================
+    // public variables.
+    //=======================================================================================
+    /* NOTHING */
+
+    //=======================================================================================
+    // public methods.
+    //=======================================================================================
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------
+    MappedFile();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------
+    virtual ~MappedFile();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      ファイルを読み取り専用でメモリにマップします.
+    //!
+    //! @param [in]     filename        ファイル名です.
+    //! @retval true    マップに成功.
+    //! @retval false   マップに失敗.
+    //---------------------------------------------------------------------------------------
+    bool Open( const char* filename );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      マップを解除し，ファイルを閉じます.
+    //---------------------------------------------------------------------------------------
+    void Close();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      マップされているかどうかチェックします.
+    //---------------------------------------------------------------------------------------
+    bool IsOpen() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      マップされたデータの先頭ポインタを取得します.
+    //---------------------------------------------------------------------------------------
+    const unsigned char* GetData() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      ファイルサイズを取得します.
+    //---------------------------------------------------------------------------------------
+    size_t GetSize() const;
+
+protected:
+    //=======================================================================================
+    // protected variables.
+    //=======================================================================================
+    void*           m_hFile;            //!< ファイルハンドルです.
+    void*           m_hMapping;         //!< ファイルマッピングハンドルです.
+    int             m_FileDesc;         //!< ファイルディスクリプタです.
+    unsigned char*  m_pData;            //!< マップされたデータです.
+    size_t          m_Size;             //!< ファイルサイズです.
+
+    //=======================================================================================
+    // protected methods.
+    //=======================================================================================
+    /* NOTHING */
+
+private:
+    //=======================================================================================
+    // private variables.
+    //=======================================================================================
+    /* NOTHING */
+
+    //=======================================================================================
+    // private methods.
+    //=======================================================================================
+    MappedFile      ( const MappedFile& value );    // アクセス禁止.
+    void operator = ( const MappedFile& value );    // アクセス禁止.
+};
+
+
+#endif//_MAPPED_FILE_H_
@@ -0,0 +1,353 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : JpegKernel.cpp
+// Desc : JPEG Decoding Kernels.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <cmath>
+#include <JpegKernel.h>
+
+#if defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 ) || defined(__SSE2__)
+    #define JPEG_ENABLE_SSE2    1
+    #include <emmintrin.h>
+#else
+    #define JPEG_ENABLE_SSE2    0
+#endif
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+const float F_1_414213562 = 1.414213562f;
+const float F_1_847759065 = 1.847759065f;
+const float F_1_082392200 = 1.082392200f;
+const float F_2_613125930 = 2.613125930f;
+
+const float F_1_402000 = 1.402000f;
+const float F_0_344136 = 0.344136f;
+const float F_0_714136 = 0.714136f;
+const float F_1_772000 = 1.772000f;
+
+
+//-------------------------------------------------------------------------------------------
+//      0～255の範囲に丸めます.
+//-------------------------------------------------------------------------------------------
+inline unsigned char ClampToByte( float value )
+{
+    const int i = static_cast<int>( floor( value + 0.5f ) );
+    return static_cast<unsigned char>( ( i < 0 ) ? 0 : ( i > 255 ) ? 255 : i );
+}
+
+#if JPEG_ENABLE_SSE2
+
+//-------------------------------------------------------------------------------------------
+//      8点の1次元逆DCTを4列まとめて行います(AAN法).
+//-------------------------------------------------------------------------------------------
+inline void Idct8SSE( __m128* v )
+{
+    const __m128 k1_414 = _mm_set1_ps( F_1_414213562 );
+
+    // 偶数部.
+    __m128 tmp10 = _mm_add_ps( v[0], v[4] );
+    __m128 tmp11 = _mm_sub_ps( v[0], v[4] );
+    __m128 tmp13 = _mm_add_ps( v[2], v[6] );
+    __m128 tmp12 = _mm_sub_ps( _mm_mul_ps( _mm_sub_ps( v[2], v[6] ), k1_414 ), tmp13 );
+
+    const __m128 tmp0 = _mm_add_ps( tmp10, tmp13 );
+    const __m128 tmp3 = _mm_sub_ps( tmp10, tmp13 );
+    const __m128 tmp1 = _mm_add_ps( tmp11, tmp12 );
+    const __m128 tmp2 = _mm_sub_ps( tmp11, tmp12 );
+
+    // 奇数部.
+    const __m128 z13 = _mm_add_ps( v[5], v[3] );
+    const __m128 z10 = _mm_sub_ps( v[5], v[3] );
+    const __m128 z11 = _mm_add_ps( v[1], v[7] );
+    const __m128 z12 = _mm_sub_ps( v[1], v[7] );
+
+    const __m128 tmp7 = _mm_add_ps( z11, z13 );
+    tmp11 = _mm_mul_ps( _mm_sub_ps( z11, z13 ), k1_414 );
+
+    const __m128 z5 = _mm_mul_ps( _mm_add_ps( z10, z12 ), _mm_set1_ps( F_1_847759065 ) );
+    tmp10 = _mm_sub_ps( _mm_mul_ps( z12, _mm_set1_ps( F_1_082392200 ) ), z5 );
+    tmp12 = _mm_sub_ps( z5, _mm_mul_ps( z10, _mm_set1_ps( F_2_613125930 ) ) );
+
+    const __m128 tmp6 = _mm_sub_ps( tmp12, tmp7 );
+    const __m128 tmp5 = _mm_sub_ps( tmp11, tmp6 );
+    const __m128 tmp4 = _mm_add_ps( tmp10, tmp5 );
+
+    v[0] = _mm_add_ps( tmp0, tmp7 );
+    v[7] = _mm_sub_ps( tmp0, tmp7 );
+    v[1] = _mm_add_ps( tmp1, tmp6 );
+    v[6] = _mm_sub_ps( tmp1, tmp6 );
+    v[2] = _mm_add_ps( tmp2, tmp5 );
+    v[5] = _mm_sub_ps( tmp2, tmp5 );
+    v[4] = _mm_add_ps( tmp3, tmp4 );
+    v[3] = _mm_sub_ps( tmp3, tmp4 );
+}
+
+//-------------------------------------------------------------------------------------------
+//      4x4の小行列を転置してコピーします.
+//-------------------------------------------------------------------------------------------
+inline void Transpose4( const __m128* pSrc, __m128* pDst )
+{
+    __m128 r0 = pSrc[0];
+    __m128 r1 = pSrc[1];
+    __m128 r2 = pSrc[2];
+    __m128 r3 = pSrc[3];
+    _MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+    pDst[0] = r0;
+    pDst[1] = r1;
+    pDst[2] = r2;
+    pDst[3] = r3;
+}
+
+//-------------------------------------------------------------------------------------------
+//      逆DCTを行います(SSE2版).
+//-------------------------------------------------------------------------------------------
+void IdctBlockSSE2( const short* pCoef, const float* pTable, unsigned char* pDst, size_t stride )
+{
+    // lo[r] は r行目の 0～3列，hi[r] は 4～7列.
+    __m128 lo[8];
+    __m128 hi[8];
+    for( int r=0; r<8; ++r )
+    {
+        const __m128i c  = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pCoef + r * 8 ) );
+        const __m128i cl = _mm_srai_epi32( _mm_unpacklo_epi16( c, c ), 16 );
+        const __m128i ch = _mm_srai_epi32( _mm_unpackhi_epi16( c, c ), 16 );
+        lo[r] = _mm_mul_ps( _mm_cvtepi32_ps( cl ), _mm_loadu_ps( pTable + r * 8 + 0 ) );
+        hi[r] = _mm_mul_ps( _mm_cvtepi32_ps( ch ), _mm_loadu_ps( pTable + r * 8 + 4 ) );
+    }
+
+    // 列方向.
+    Idct8SSE( lo );
+    Idct8SSE( hi );
+
+    // 転置して行方向. 転置後は tlo[c] が c列目の 0～3行，thi[c] が 4～7行.
+    __m128 tlo[8];
+    __m128 thi[8];
+    Transpose4( lo + 0, tlo + 0 );
+    Transpose4( lo + 4, thi + 0 );
+    Transpose4( hi + 0, tlo + 4 );
+    Transpose4( hi + 4, thi + 4 );
+
+    Idct8SSE( tlo );
+    Idct8SSE( thi );
+
+    // 元の並びに戻す.
+    Transpose4( tlo + 0, lo + 0 );
+    Transpose4( tlo + 4, hi + 0 );
+    Transpose4( thi + 0, lo + 4 );
+    Transpose4( thi + 4, hi + 4 );
+
+    // レベルシフトして飽和付きで8bitに詰める.
+    const __m128 center = _mm_set1_ps( 128.0f );
+    for( int r=0; r<8; ++r )
+    {
+        const __m128i il = _mm_cvtps_epi32( _mm_add_ps( lo[r], center ) );
+        const __m128i ih = _mm_cvtps_epi32( _mm_add_ps( hi[r], center ) );
+        const __m128i s  = _mm_packs_epi32( il, ih );
+        _mm_storel_epi64( reinterpret_cast<__m128i*>( pDst + r * stride ), _mm_packus_epi16( s, s ) );
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      8bit x 8 を float x 4 x 2 に展開します.
+//-------------------------------------------------------------------------------------------
+inline void Load8( const unsigned char* p, __m128& lo, __m128& hi )
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i v16  = _mm_unpacklo_epi8( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( p ) ), zero );
+    lo = _mm_cvtepi32_ps( _mm_unpacklo_epi16( v16, zero ) );
+    hi = _mm_cvtepi32_ps( _mm_unpackhi_epi16( v16, zero ) );
+}
+
+//-------------------------------------------------------------------------------------------
+//      float x 4 x 2 を飽和付きで8bit x 8 に詰めます.
+//-------------------------------------------------------------------------------------------
+inline void Store8( unsigned char* p, __m128 lo, __m128 hi )
+{
+    const __m128i s = _mm_packs_epi32( _mm_cvtps_epi32( lo ), _mm_cvtps_epi32( hi ) );
+    _mm_storel_epi64( reinterpret_cast<__m128i*>( p ), _mm_packus_epi16( s, s ) );
+}
+
+#else
+
+//-------------------------------------------------------------------------------------------
+//      逆DCTを行います(スカラー版).
+//-------------------------------------------------------------------------------------------
+void IdctBlockScalar( const short* pCoef, const float* pTable, unsigned char* pDst, size_t stride )
+{
+    float ws[64];
+
+    for( int pass=0; pass<2; ++pass )
+    {
+        for( int i=0; i<8; ++i )
+        {
+            // 1パス目は列方向(ステップ8)，2パス目は行方向(ステップ1)に処理する.
+            float in[8];
+            if ( pass == 0 )
+            {
+                for( int k=0; k<8; ++k )
+                { in[k] = pCoef[k * 8 + i] * pTable[k * 8 + i]; }
+            }
+            else
+            {
+                for( int k=0; k<8; ++k )
+                { in[k] = ws[i * 8 + k]; }
+            }
+
+            float tmp10 = in[0] + in[4];
+            float tmp11 = in[0] - in[4];
+            float tmp13 = in[2] + in[6];
+            float tmp12 = ( in[2] - in[6] ) * F_1_414213562 - tmp13;
+
+            const float tmp0 = tmp10 + tmp13;
+            const float tmp3 = tmp10 - tmp13;
+            const float tmp1 = tmp11 + tmp12;
+            const float tmp2 = tmp11 - tmp12;
+
+            const float z13 = in[5] + in[3];
+            const float z10 = in[5] - in[3];
+            const float z11 = in[1] + in[7];
+            const float z12 = in[1] - in[7];
+
+            const float tmp7 = z11 + z13;
+            tmp11 = ( z11 - z13 ) * F_1_414213562;
+
+            const float z5 = ( z10 + z12 ) * F_1_847759065;
+            tmp10 = z12 * F_1_082392200 - z5;
+            tmp12 = z5 - z10 * F_2_613125930;
+
+            const float tmp6 = tmp12 - tmp7;
+            const float tmp5 = tmp11 - tmp6;
+            const float tmp4 = tmp10 + tmp5;
+
+            float out[8];
+            out[0] = tmp0 + tmp7;
+            out[7] = tmp0 - tmp7;
+            out[1] = tmp1 + tmp6;
+            out[6] = tmp1 - tmp6;
+            out[2] = tmp2 + tmp5;
+            out[5] = tmp2 - tmp5;
+            out[4] = tmp3 + tmp4;
+            out[3] = tmp3 - tmp4;
+
+            if ( pass == 0 )
+            {
+                // 転置して格納し，2パス目で行を連続して読めるようにする.
+                for( int k=0; k<8; ++k )
+                { ws[k * 8 + i] = out[k]; }
+            }
+            else
+            {
+                for( int k=0; k<8; ++k )
+                { pDst[i * stride + k] = ClampToByte( out[k] + 128.0f ); }
+            }
+        }
+    }
+}
+
+#endif//JPEG_ENABLE_SSE2
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------
+//      逆DCT用の逆量子化テーブルを生成します.
+//-------------------------------------------------------------------------------------------
+void BuildIdctTable( const unsigned short* pQuant, float* pTable )
+{
+    const double PI = 3.14159265358979323846;
+
+    double scale[8];
+    scale[0] = 1.0;
+    for( int k=1; k<8; ++k )
+    { scale[k] = cos( k * PI / 16.0 ) * sqrt( 2.0 ); }
+
+    for( int r=0; r<8; ++r )
+    {
+        for( int c=0; c<8; ++c )
+        { pTable[r * 8 + c] = static_cast<float>( pQuant[r * 8 + c] * scale[r] * scale[c] / 8.0 ); }
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      8x8ブロックを逆量子化・逆DCTします.
+//-------------------------------------------------------------------------------------------
+void IdctBlock( const short* pCoef, const float* pTable, unsigned char* pDst, size_t stride )
+{
+#if JPEG_ENABLE_SSE2
+    IdctBlockSSE2( pCoef, pTable, pDst, stride );
+#else
+    IdctBlockScalar( pCoef, pTable, pDst, stride );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------
+//      YCbCr の1行分をRGB8に変換します.
+//-------------------------------------------------------------------------------------------
+void ConvertYCbCrToRGB
+(
+    const unsigned char*    pY,
+    const unsigned char*    pCb,
+    const unsigned char*    pCr,
+    unsigned char*          pDst,
+    size_t                  count
+)
+{
+    size_t i = 0;
+
+#if JPEG_ENABLE_SSE2
+    {
+        const __m128 center = _mm_set1_ps( 128.0f );
+        const __m128 kCrR   = _mm_set1_ps(  F_1_402000 );
+        const __m128 kCbG   = _mm_set1_ps( -F_0_344136 );
+        const __m128 kCrG   = _mm_set1_ps( -F_0_714136 );
+        const __m128 kCbB   = _mm_set1_ps(  F_1_772000 );
+
+        // 8ピクセルずつ平面のまま変換し，最後にRGBへ並べ替える.
+        unsigned char r[8], g[8], b[8];
+        for( ; i + 8 <= count; i += 8 )
+        {
+            __m128 y0, y1, cb0, cb1, cr0, cr1;
+            Load8( pY  + i, y0,  y1  );
+            Load8( pCb + i, cb0, cb1 );
+            Load8( pCr + i, cr0, cr1 );
+            cb0 = _mm_sub_ps( cb0, center );
+            cb1 = _mm_sub_ps( cb1, center );
+            cr0 = _mm_sub_ps( cr0, center );
+            cr1 = _mm_sub_ps( cr1, center );
+
+            Store8( r, _mm_add_ps( y0, _mm_mul_ps( cr0, kCrR ) ),
+                       _mm_add_ps( y1, _mm_mul_ps( cr1, kCrR ) ) );
+            Store8( g, _mm_add_ps( y0, _mm_add_ps( _mm_mul_ps( cb0, kCbG ), _mm_mul_ps( cr0, kCrG ) ) ),
+                       _mm_add_ps( y1, _mm_add_ps( _mm_mul_ps( cb1, kCbG ), _mm_mul_ps( cr1, kCrG ) ) ) );
+            Store8( b, _mm_add_ps( y0, _mm_mul_ps( cb0, kCbB ) ),
+                       _mm_add_ps( y1, _mm_mul_ps( cb1, kCbB ) ) );
+
+            unsigned char* pOut = pDst + i * 3;
+            for( int k=0; k<8; ++k )
+            {
+                pOut[k * 3 + 0] = r[k];
+                pOut[k * 3 + 1] = g[k];
+                pOut[k * 3 + 2] = b[k];
+            }
+        }
+    }
+#endif
+
+    for( ; i<count; ++i )
+    {
+        const float y  = pY[i];
+        const float cb = pCb[i] - 128.0f;
+        const float cr = pCr[i] - 128.0f;
+        pDst[i * 3 + 0] = ClampToByte( y + F_1_402000 * cr );
+        pDst[i * 3 + 1] = ClampToByte( y - F_0_344136 * cb - F_0_714136 * cr );
+        pDst[i * 3 + 2] = ClampToByte( y + F_1_772000 * cb );
+    }
+}
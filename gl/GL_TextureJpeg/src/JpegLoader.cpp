@@ -0,0 +1,1402 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : JpegLoader.cpp
+// Desc : JPEG File Interchange Format Texture Loader.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <JpegLoader.h>
+#include <JpegKernel.h>
+#include <MappedFile.h>
+#include <MipMapGenerator.h>
+#include <TextureCache.h>
+#include <ColorSpace.h>
+#include <GL/glut.h>
+
+#ifndef GL_SRGB8
+#define GL_SRGB8            0x8C41
+#endif//GL_SRGB8
+
+#ifndef GL_SRGB8_ALPHA8
+#define GL_SRGB8_ALPHA8     0x8C43
+#endif//GL_SRGB8_ALPHA8
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+const unsigned char MARKER_SOF0     = 0xc0;     // ベースライン.
+const unsigned char MARKER_SOF1     = 0xc1;     // 拡張シーケンシャル(ハフマン).
+const unsigned char MARKER_SOF2     = 0xc2;     // プログレッシブ(ハフマン).
+const unsigned char MARKER_DHT      = 0xc4;
+const unsigned char MARKER_RST0     = 0xd0;
+const unsigned char MARKER_RST7     = 0xd7;
+const unsigned char MARKER_SOI      = 0xd8;
+const unsigned char MARKER_EOI      = 0xd9;
+const unsigned char MARKER_SOS      = 0xda;
+const unsigned char MARKER_DQT      = 0xdb;
+const unsigned char MARKER_DRI      = 0xdd;
+const unsigned char MARKER_APP14    = 0xee;
+const unsigned char MARKER_TEM      = 0x01;
+
+const unsigned int  MAX_COMPONENTS  = 3;        // CMYK(4成分)は非対応.
+const unsigned int  MAX_TABLES      = 4;
+const unsigned int  FAST_BITS       = 9;        // ハフマン復号のルックアップテーブルのビット数.
+
+// ジグザグ順から自然順への変換テーブル. 不正なデータで範囲外を読まないよう末尾を埋めておく.
+const unsigned char ZIGZAG[64 + 16] = {
+     0,  1,  8, 16,  9,  2,  3, 10,
+    17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34,
+    27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36,
+    29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46,
+    53, 60, 61, 54, 47, 55, 62, 63,
+    63, 63, 63, 63, 63, 63, 63, 63,
+    63, 63, 63, 63, 63, 63, 63, 63,
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// HuffmanTable structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct HuffmanTable
+{
+    unsigned short  fast[1 << FAST_BITS];   //!< 先頭 FAST_BITS ビットからの ( 符号長 << 8 ) | シンボル です. 0は未登録.
+    int             maxCode[17];            //!< 符号長ごとの最大符号です. 該当なしは -1 です.
+    int             valOffset[17];          //!< 符号からシンボル配列の添え字へのオフセットです.
+    unsigned char   values[256];            //!< シンボルです.
+    bool            valid;                  //!< 定義済みかどうかのフラグです.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Component structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct Component
+{
+    unsigned int                id;             //!< 成分IDです.
+    unsigned int                h;              //!< 水平サンプリング係数です.
+    unsigned int                v;              //!< 垂直サンプリング係数です.
+    unsigned int                tq;             //!< 量子化テーブル番号です.
+    unsigned int                width;          //!< 間引き後の横幅です.
+    unsigned int                height;         //!< 間引き後の縦幅です.
+    unsigned int                blocksW;        //!< MCU境界まで含めた横方向のブロック数です.
+    unsigned int                blocksH;        //!< MCU境界まで含めた縦方向のブロック数です.
+    unsigned int                dcTable;        //!< DC用ハフマンテーブル番号です.
+    unsigned int                acTable;        //!< AC用ハフマンテーブル番号です.
+    int                         dcPred;         //!< DC成分の予測値です.
+    bool                        latched;        //!< 量子化テーブルを確定済みかどうかのフラグです.
+    float                       idct[64];       //!< 逆DCT用の逆量子化テーブルです.
+    std::vector<unsigned char>  plane;          //!< 逆DCT後のサンプルです.
+    std::vector<short>          coef;           //!< プログレッシブ用のDCT係数です.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// ScanParam structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct ScanParam
+{
+    unsigned int    ss;     //!< スペクトル選択の開始位置です.
+    unsigned int    se;     //!< スペクトル選択の終了位置です.
+    unsigned int    ah;     //!< 前回の逐次近似ビット位置です.
+    unsigned int    al;     //!< 今回の逐次近似ビット位置です.
+};
+
+
+//-------------------------------------------------------------------------------------------
+//      ビッグエンディアンで16bit読み込みします.
+//-------------------------------------------------------------------------------------------
+inline unsigned int ReadBE16( const unsigned char* p )
+{ return ( static_cast<unsigned int>( p[0] ) << 8 ) | p[1]; }
+
+//-------------------------------------------------------------------------------------------
+//      ハフマン符号の付加ビットを符号付きの値に変換します.
+//-------------------------------------------------------------------------------------------
+inline int Extend( unsigned int value, unsigned int bits )
+{ return ( value < ( 1u << ( bits - 1 ) ) ) ? static_cast<int>( value ) - ( 1 << bits ) + 1 : static_cast<int>( value ); }
+
+//-------------------------------------------------------------------------------------------
+//      ハフマンテーブルを構築します.
+//-------------------------------------------------------------------------------------------
+bool BuildHuffmanTable( const unsigned char* pCounts, const unsigned char* pSymbols, unsigned int symbolCount, HuffmanTable& table )
+{
+    memset( table.fast, 0, sizeof(table.fast) );
+    memcpy( table.values, pSymbols, symbolCount );
+
+    // 標準的なカノニカル符号の割り当て.
+    int          code  = 0;
+    unsigned int index = 0;
+    for( unsigned int len=1; len<=16; ++len )
+    {
+        table.valOffset[len] = static_cast<int>( index ) - code;
+        for( unsigned int i=0; i<pCounts[len - 1]; ++i )
+        {
+            // 符号長に収まらない割り当ては不正.
+            if ( code >= ( 1 << len ) )
+            { return false; }
+
+            if ( len <= FAST_BITS )
+            {
+                const unsigned int shift = FAST_BITS - len;
+                const unsigned int first = static_cast<unsigned int>( code ) << shift;
+                const unsigned short entry = static_cast<unsigned short>( ( len << 8 ) | pSymbols[index] );
+                for( unsigned int j=0; j<( 1u << shift ); ++j )
+                { table.fast[first + j] = entry; }
+            }
+            ++code;
+            ++index;
+        }
+        table.maxCode[len] = ( pCounts[len - 1] != 0 ) ? code - 1 : -1;
+        code <<= 1;
+    }
+
+    table.valid = true;
+    return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// BitReader class
+/////////////////////////////////////////////////////////////////////////////////////////////
+class BitReader
+{
+public:
+    //---------------------------------------------------------------------------------------
+    //      エントロピー符号化データの読み取りを開始します.
+    //---------------------------------------------------------------------------------------
+    void Reset( const unsigned char* pBegin, const unsigned char* pEnd )
+    {
+        m_pCur   = pBegin;
+        m_pEnd   = pEnd;
+        m_Bits   = 0;
+        m_Count  = 0;
+        m_Marker = false;
+    }
+
+    //---------------------------------------------------------------------------------------
+    //      ビットバッファを補充します.
+    //---------------------------------------------------------------------------------------
+    void Fill()
+    {
+        while( m_Count <= 56 )
+        {
+            // マーカーに到達した以降は0を供給する.
+            unsigned int byte = 0;
+            if ( !m_Marker && m_pCur < m_pEnd )
+            {
+                byte = *m_pCur;
+                if ( byte != 0xff )
+                { ++m_pCur; }
+                else if ( m_pCur + 1 < m_pEnd && m_pCur[1] == 0x00 )
+                { m_pCur += 2; }
+                else
+                {
+                    m_Marker = true;
+                    byte     = 0;
+                }
+            }
+
+            m_Bits  |= static_cast<unsigned long long>( byte ) << ( 56 - m_Count );
+            m_Count += 8;
+        }
+    }
+
+    //---------------------------------------------------------------------------------------
+    //      指定ビット数(16以下)を読み取ります.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetBits( unsigned int count )
+    {
+        if ( count == 0 )
+        { return 0; }
+
+        if ( m_Count < static_cast<int>( count ) )
+        { Fill(); }
+
+        const unsigned int value = static_cast<unsigned int>( m_Bits >> ( 64 - count ) );
+        m_Bits  <<= count;
+        m_Count  -= count;
+        return value;
+    }
+
+    //---------------------------------------------------------------------------------------
+    //      ハフマン符号を1つ復号します. 不正な符号の場合は -1 を返却します.
+    //---------------------------------------------------------------------------------------
+    int Decode( const HuffmanTable& table )
+    {
+        if ( m_Count < 16 )
+        { Fill(); }
+
+        const unsigned int entry = table.fast[ m_Bits >> ( 64 - FAST_BITS ) ];
+        if ( entry != 0 )
+        {
+            const unsigned int len = entry >> 8;
+            m_Bits  <<= len;
+            m_Count  -= len;
+            return entry & 0xff;
+        }
+
+        const int code16 = static_cast<int>( m_Bits >> 48 );
+        for( unsigned int len=FAST_BITS + 1; len<=16; ++len )
+        {
+            const int code = code16 >> ( 16 - len );
+            if ( code <= table.maxCode[len] )
+            {
+                m_Bits  <<= len;
+                m_Count  -= len;
+                return table.values[ table.valOffset[len] + code ];
+            }
+        }
+
+        return -1;
+    }
+
+    //---------------------------------------------------------------------------------------
+    //      次のマーカーの位置を取得します.
+    //---------------------------------------------------------------------------------------
+    const unsigned char* FindMarker()
+    {
+        while( m_pCur + 1 < m_pEnd )
+        {
+            if ( m_pCur[0] == 0xff && m_pCur[1] != 0x00 && m_pCur[1] != 0xff )
+            { return m_pCur; }
+            ++m_pCur;
+        }
+        return m_pEnd;
+    }
+
+    //---------------------------------------------------------------------------------------
+    //      リスタートマーカーを読み飛ばし，ビットバッファを破棄します.
+    //---------------------------------------------------------------------------------------
+    bool Restart()
+    {
+        const unsigned char* p = FindMarker();
+        if ( p + 1 >= m_pEnd || p[1] < MARKER_RST0 || p[1] > MARKER_RST7 )
+        { return false; }
+
+        Reset( p + 2, m_pEnd );
+        return true;
+    }
+
+private:
+    const unsigned char*    m_pCur;     //!< 次に読み取る位置です.
+    const unsigned char*    m_pEnd;     //!< データの終端です.
+    unsigned long long      m_Bits;     //!< MSB詰めのビットバッファです.
+    int                     m_Count;    //!< ビットバッファの有効ビット数です.
+    bool                    m_Marker;   //!< マーカーに到達したかどうかのフラグです.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// JpegDecoder class
+/////////////////////////////////////////////////////////////////////////////////////////////
+class JpegDecoder
+{
+public:
+    //---------------------------------------------------------------------------------------
+    //      コンストラクタです.
+    //---------------------------------------------------------------------------------------
+    JpegDecoder()
+    : m_pError          ( nullptr )
+    , m_Width           ( 0 )
+    , m_Height          ( 0 )
+    , m_ComponentCount  ( 0 )
+    , m_MaxH            ( 1 )
+    , m_MaxV            ( 1 )
+    , m_McusX           ( 0 )
+    , m_McusY           ( 0 )
+    , m_RestartInterval ( 0 )
+    , m_EobRun          ( 0 )
+    , m_Progressive     ( false )
+    , m_HasFrame        ( false )
+    , m_AdobeTransform  ( -1 )
+    {
+        memset( m_QuantValid, 0, sizeof(m_QuantValid) );
+        memset( m_DcTables,   0, sizeof(m_DcTables) );
+        memset( m_AcTables,   0, sizeof(m_AcTables) );
+    }
+
+    //---------------------------------------------------------------------------------------
+    //      ストリーム全体を復号します.
+    //---------------------------------------------------------------------------------------
+    bool Decode( const unsigned char* pData, size_t size )
+    {
+        if ( size < 4 || pData[0] != 0xff || pData[1] != MARKER_SOI )
+        { return Fail( "Invalid File." ); }
+
+        size_t offset = 2;
+        for( ;; )
+        {
+            // マーカー前の埋め込み用 0xff は読み飛ばす.
+            if ( offset >= size || pData[offset] != 0xff )
+            { return Fail( "Marker Not Found." ); }
+
+            while( offset < size && pData[offset] == 0xff )
+            { ++offset; }
+
+            if ( offset >= size )
+            { return Fail( "Unexpected End Of File." ); }
+
+            const unsigned char marker = pData[offset++];
+            if ( marker == MARKER_EOI )
+            { break; }
+
+            // 長さを持たないマーカー.
+            if ( marker == MARKER_SOI || marker == MARKER_TEM || ( MARKER_RST0 <= marker && marker <= MARKER_RST7 ) )
+            { continue; }
+
+            if ( size - offset < 2 )
+            { return Fail( "Unexpected End Of File." ); }
+
+            const unsigned int length = ReadBE16( pData + offset );
+            if ( length < 2 || length > size - offset )
+            { return Fail( "Invalid Segment Length." ); }
+
+            const unsigned char* pBody   = pData + offset + 2;
+            const unsigned int   bodyLen = length - 2;
+
+            bool result = true;
+            switch( marker )
+            {
+            case MARKER_SOF0:
+            case MARKER_SOF1:
+            case MARKER_SOF2:
+                result = ParseFrame( pBody, bodyLen, marker == MARKER_SOF2 );
+                break;
+
+            case MARKER_DHT:
+                result = ParseHuffmanTables( pBody, bodyLen );
+                break;
+
+            case MARKER_DQT:
+                result = ParseQuantTables( pBody, bodyLen );
+                break;
+
+            case MARKER_DRI:
+                if ( bodyLen < 2 )
+                { return Fail( "Invalid DRI." ); }
+                m_RestartInterval = ReadBE16( pBody );
+                break;
+
+            case MARKER_APP14:
+                // Adobe のカラー変換フラグ.
+                if ( bodyLen >= 12 && memcmp( pBody, "Adobe", 5 ) == 0 )
+                { m_AdobeTransform = pBody[11]; }
+                break;
+
+            case MARKER_SOS:
+                {
+                    const unsigned char* pNext = nullptr;
+                    if ( !DecodeScan( pBody, bodyLen, pData + size, pNext ) )
+                    { return false; }
+
+                    // スキャンの長さはエントロピー符号化データの終端で決まる.
+                    offset = static_cast<size_t>( pNext - pData );
+                }
+                continue;
+
+            default:
+                // 算術符号・ロスレス・階層型は非対応.
+                if ( ( 0xc3 <= marker && marker <= 0xcf ) && marker != MARKER_DHT && marker != 0xc8 && marker != 0xcc )
+                { return Fail( "Unsupported JPEG Process." ); }
+                break;
+            }
+
+            if ( !result )
+            { return false; }
+
+            offset += length;
+        }
+
+        if ( !m_HasFrame )
+        { return Fail( "Frame Not Found." ); }
+
+        for( unsigned int i=0; i<m_ComponentCount; ++i )
+        {
+            if ( !m_Components[i].latched )
+            { return Fail( "Incomplete Image Data." ); }
+        }
+
+        // プログレッシブは全スキャンが揃ってから逆DCTする.
+        if ( m_Progressive )
+        {
+            for( unsigned int i=0; i<m_ComponentCount; ++i )
+            {
+                Component&   comp   = m_Components[i];
+                const size_t stride = size_t( comp.blocksW ) * 8;
+                for( unsigned int by=0; by<comp.blocksH; ++by )
+                {
+                    for( unsigned int bx=0; bx<comp.blocksW; ++bx )
+                    {
+                        IdctBlock(
+                            &comp.coef[ ( size_t( by ) * comp.blocksW + bx ) * 64 ],
+                            comp.idct,
+                            &comp.plane[ size_t( by ) * 8 * stride + bx * 8 ],
+                            stride );
+                    }
+                }
+
+                std::vector<short>().swap( comp.coef );
+            }
+        }
+
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------
+    //      アップサンプリングと色変換を行い，RGB8で書き出します.
+    //---------------------------------------------------------------------------------------
+    void Output( unsigned char* pDst ) const
+    {
+        std::vector<unsigned char> rows[MAX_COMPONENTS];
+        for( unsigned int i=0; i<m_ComponentCount; ++i )
+        { rows[i].resize( size_t( m_Width ) + 16 ); }
+
+        const bool isRGB = ( m_AdobeTransform == 0 )
+                        || ( m_ComponentCount == 3 && m_Components[0].id == 'R' && m_Components[1].id == 'G' && m_Components[2].id == 'B' );
+
+        for( unsigned int y=0; y<m_Height; ++y )
+        {
+            const unsigned char* pRow[MAX_COMPONENTS];
+            for( unsigned int i=0; i<m_ComponentCount; ++i )
+            { pRow[i] = Upsample( m_Components[i], y, &rows[i][0] ); }
+
+            unsigned char* pOut = pDst + size_t( y ) * m_Width * 3;
+            if ( m_ComponentCount == 1 )
+            {
+                for( unsigned int x=0; x<m_Width; ++x )
+                {
+                    pOut[x * 3 + 0] = pRow[0][x];
+                    pOut[x * 3 + 1] = pRow[0][x];
+                    pOut[x * 3 + 2] = pRow[0][x];
+                }
+            }
+            else if ( isRGB )
+            {
+                for( unsigned int x=0; x<m_Width; ++x )
+                {
+                    pOut[x * 3 + 0] = pRow[0][x];
+                    pOut[x * 3 + 1] = pRow[1][x];
+                    pOut[x * 3 + 2] = pRow[2][x];
+                }
+            }
+            else
+            {
+                ConvertYCbCrToRGB( pRow[0], pRow[1], pRow[2], pOut, m_Width );
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------
+    //      エラーメッセージを取得します.
+    //---------------------------------------------------------------------------------------
+    const char* GetError() const
+    { return ( m_pError != nullptr ) ? m_pError : "Unknown Error."; }
+
+    unsigned int GetWidth () const { return m_Width; }
+    unsigned int GetHeight() const { return m_Height; }
+
+private:
+    const char*     m_pError;                       //!< エラーメッセージです.
+    unsigned int    m_Width;                        //!< 画像の横幅です.
+    unsigned int    m_Height;                       //!< 画像の縦幅です.
+    unsigned int    m_ComponentCount;               //!< 成分数です.
+    unsigned int    m_MaxH;                         //!< 最大水平サンプリング係数です.
+    unsigned int    m_MaxV;                         //!< 最大垂直サンプリング係数です.
+    unsigned int    m_McusX;                        //!< 横方向のMCU数です.
+    unsigned int    m_McusY;                        //!< 縦方向のMCU数です.
+    unsigned int    m_RestartInterval;              //!< リスタート間隔(MCU数)です.
+    unsigned int    m_EobRun;                       //!< プログレッシブのEOBランです.
+    bool            m_Progressive;                  //!< プログレッシブかどうかのフラグです.
+    bool            m_HasFrame;                     //!< フレームヘッダを読み込み済みかどうかのフラグです.
+    int             m_AdobeTransform;               //!< Adobeマーカーの変換フラグです. なければ -1 です.
+    bool            m_QuantValid[MAX_TABLES];       //!< 量子化テーブルが定義済みかどうかのフラグです.
+    unsigned short  m_Quant[MAX_TABLES][64];        //!< 自然順の量子化テーブルです.
+    HuffmanTable    m_DcTables[MAX_TABLES];         //!< DC用ハフマンテーブルです.
+    HuffmanTable    m_AcTables[MAX_TABLES];         //!< AC用ハフマンテーブルです.
+    Component       m_Components[MAX_COMPONENTS];   //!< 成分です.
+    BitReader       m_Reader;                       //!< ビットリーダーです.
+
+    //---------------------------------------------------------------------------------------
+    //      エラーを設定します.
+    //---------------------------------------------------------------------------------------
+    bool Fail( const char* message )
+    {
+        m_pError = message;
+        return false;
+    }
+
+    //---------------------------------------------------------------------------------------
+    //      DQTを解析します.
+    //---------------------------------------------------------------------------------------
+    bool ParseQuantTables( const unsigned char* p, unsigned int length )
+    {
+        while( length > 0 )
+        {
+            const unsigned int precision = p[0] >> 4;
+            const unsigned int index     = p[0] & 0xf;
+            const unsigned int tableSize = ( precision == 0 ) ? 64 : 128;
+            if ( index >= MAX_TABLES || precision > 1 || length < 1 + tableSize )
+            { return Fail( "Invalid DQT." ); }
+
+            for( unsigned int k=0; k<64; ++k )
+            {
+                m_Quant[index][ ZIGZAG[k] ] = static_cast<unsigned short>(
+                    ( precision == 0 ) ? p[1 + k] : ReadBE16( p + 1 + k * 2 ) );
+            }
+            m_QuantValid[index] = true;
+
+            p      += 1 + tableSize;
+            length -= 1 + tableSize;
+        }
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------
+    //      DHTを解析します.
+    //---------------------------------------------------------------------------------------
+    bool ParseHuffmanTables( const unsigned char* p, unsigned int length )
+    {
+        while( length > 0 )
+        {
+            if ( length < 17 )
+            { return Fail( "Invalid DHT." ); }
+
+            const unsigned int tableClass = p[0] >> 4;
+            const unsigned int index      = p[0] & 0xf;
+            unsigned int symbolCount = 0;
+            for( unsigned int i=0; i<16; ++i )
+            { symbolCount += p[1 + i]; }
+
+            if ( tableClass > 1 || index >= MAX_TABLES || symbolCount > 256 || length < 17 + symbolCount )
+            { return Fail( "Invalid DHT." ); }
+
+            HuffmanTable& table = ( tableClass == 0 ) ? m_DcTables[index] : m_AcTables[index];
+            if ( !BuildHuffmanTable( p + 1, p + 17, symbolCount, table ) )
+            { return Fail( "Invalid Huffman Table." ); }
+
+            p      += 17 + symbolCount;
+            length -= 17 + symbolCount;
+        }
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------
+    //      SOFを解析します.
+    //---------------------------------------------------------------------------------------
+    bool ParseFrame( const unsigned char* p, unsigned int length, bool progressive )
+    {
+        if ( m_HasFrame )
+        { return Fail( "Multiple Frames." ); }
+
+        if ( length < 6 )
+        { return Fail( "Invalid SOF." ); }
+
+        if ( p[0] != 8 )
+        { return Fail( "Unsupported Sample Precision." ); }
+
+        m_Height         = ReadBE16( p + 1 );
+        m_Width          = ReadBE16( p + 3 );
+        m_ComponentCount = p[5];
+        m_Progressive    = progressive;
+
+        // DNLマーカーで高さを後から与える形式は非対応.
+        if ( m_Width == 0 || m_Height == 0 )
+        { return Fail( "Invalid Image Size." ); }
+
+        if ( m_ComponentCount != 1 && m_ComponentCount != 3 )
+        { return Fail( "Unsupported Component Count." ); }
+
+        if ( length < 6 + m_ComponentCount * 3 )
+        { return Fail( "Invalid SOF." ); }
+
+        m_MaxH = 1;
+        m_MaxV = 1;
+        for( unsigned int i=0; i<m_ComponentCount; ++i )
+        {
+            Component& comp = m_Components[i];
+            comp.id      = p[6 + i * 3 + 0];
+            comp.h       = p[6 + i * 3 + 1] >> 4;
+            comp.v       = p[6 + i * 3 + 1] & 0xf;
+            comp.tq      = p[6 + i * 3 + 2];
+            comp.latched = false;
+            if ( comp.h < 1 || comp.h > 4 || comp.v < 1 || comp.v > 4 || comp.tq >= MAX_TABLES )
+            { return Fail( "Invalid SOF." ); }
+
+            // 1成分の場合はサンプリング係数に関わらず1ブロックが1MCUになる.
+            if ( m_ComponentCount == 1 )
+            {
+                comp.h = 1;
+                comp.v = 1;
+            }
+
+            if ( comp.h > m_MaxH ) { m_MaxH = comp.h; }
+            if ( comp.v > m_MaxV ) { m_MaxV = comp.v; }
+        }
+
+        m_McusX = ( m_Width  + m_MaxH * 8 - 1 ) / ( m_MaxH * 8 );
+        m_McusY = ( m_Height + m_MaxV * 8 - 1 ) / ( m_MaxV * 8 );
+
+        for( unsigned int i=0; i<m_ComponentCount; ++i )
+        {
+            Component& comp = m_Components[i];
+
+            // 整数倍でないサンプリング係数の組み合わせは非対応.
+            if ( ( m_MaxH % comp.h ) != 0 || ( m_MaxV % comp.v ) != 0 )
+            { return Fail( "Unsupported Sampling Factor." ); }
+
+            comp.width   = ( m_Width  * comp.h + m_MaxH - 1 ) / m_MaxH;
+            comp.height  = ( m_Height * comp.v + m_MaxV - 1 ) / m_MaxV;
+            comp.blocksW = m_McusX * comp.h;
+            comp.blocksH = m_McusY * comp.v;
+
+            const unsigned long long blocks = static_cast<unsigned long long>( comp.blocksW ) * comp.blocksH;
+            if ( blocks * 64 * sizeof(short) > static_cast<unsigned long long>( size_t( -1 ) ) )
+            { return Fail( "Image Too Large." ); }
+
+            comp.plane.assign( size_t( blocks * 64 ), 0 );
+            if ( m_Progressive )
+            { comp.coef.assign( size_t( blocks * 64 ), 0 ); }
+        }
+
+        m_HasFrame = true;
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------
+    //      スキャンを復号します.
+    //---------------------------------------------------------------------------------------
+    bool DecodeScan( const unsigned char* p, unsigned int length, const unsigned char* pEnd, const unsigned char*& pNext )
+    {
+        if ( !m_HasFrame )
+        { return Fail( "SOF Not Found." ); }
+
+        if ( length < 1 )
+        { return Fail( "Invalid SOS." ); }
+
+        const unsigned int count = p[0];
+        if ( count < 1 || count > m_ComponentCount || length < 4 + count * 2 )
+        { return Fail( "Invalid SOS." ); }
+
+        Component* pComps[MAX_COMPONENTS];
+        for( unsigned int i=0; i<count; ++i )
+        {
+            const unsigned int id = p[1 + i * 2];
+            pComps[i] = nullptr;
+            for( unsigned int j=0; j<m_ComponentCount; ++j )
+            {
+                if ( m_Components[j].id == id )
+                { pComps[i] = &m_Components[j]; }
+            }
+            if ( pComps[i] == nullptr )
+            { return Fail( "Invalid SOS." ); }
+
+            pComps[i]->dcTable = p[2 + i * 2] >> 4;
+            pComps[i]->acTable = p[2 + i * 2] & 0xf;
+            pComps[i]->dcPred  = 0;
+            if ( pComps[i]->dcTable >= MAX_TABLES || pComps[i]->acTable >= MAX_TABLES )
+            { return Fail( "Invalid SOS." ); }
+        }
+
+        const unsigned int ss = p[1 + count * 2];
+        const unsigned int se = p[2 + count * 2];
+        const unsigned int ah = p[3 + count * 2] >> 4;
+        const unsigned int al = p[3 + count * 2] & 0xf;
+
+        if ( m_Progressive )
+        {
+            // DCとACは別スキャン. AC は非インターリーブのみ.
+            if ( ss > se || se > 63 || al > 13 || ( ss == 0 && se != 0 ) || ( ss != 0 && count != 1 ) )
+            { return Fail( "Invalid Progressive Scan." ); }
+        }
+        else if ( ss != 0 || se != 63 || ah != 0 || al != 0 )
+        { return Fail( "Invalid Sequential Scan." ); }
+
+        const bool needDC = !m_Progressive || ( ss == 0 && ah == 0 );
+        const bool needAC = !m_Progressive || ( ss != 0 );
+        for( unsigned int i=0; i<count; ++i )
+        {
+            Component& comp = *pComps[i];
+            if ( ( needDC && !m_DcTables[comp.dcTable].valid ) || ( needAC && !m_AcTables[comp.acTable].valid ) )
+            { return Fail( "Huffman Table Not Found." ); }
+
+            // 量子化テーブルは成分が最初に現れたスキャンの時点のものを使う.
+            if ( !comp.latched )
+            {
+                if ( !m_QuantValid[comp.tq] )
+                { return Fail( "Quantization Table Not Found." ); }
+                BuildIdctTable( m_Quant[comp.tq], comp.idct );
+                comp.latched = true;
+            }
+        }
+
+        m_Reader.Reset( p + length, pEnd );
+        m_EobRun = 0;
+
+        ScanParam param;
+        param.ss = ss;
+        param.se = se;
+        param.ah = ah;
+        param.al = al;
+
+        // 1成分のスキャンはMCU境界ではなく成分の実サイズ分のブロックだけを含む.
+        const unsigned int mcusX = ( count == 1 ) ? ( pComps[0]->width  + 7 ) / 8 : m_McusX;
+        const unsigned int mcusY = ( count == 1 ) ? ( pComps[0]->height + 7 ) / 8 : m_McusY;
+
+        unsigned int mcuIndex = 0;
+        for( unsigned int my=0; my<mcusY; ++my )
+        {
+            for( unsigned int mx=0; mx<mcusX; ++mx, ++mcuIndex )
+            {
+                if ( m_RestartInterval != 0 && mcuIndex != 0 && ( mcuIndex % m_RestartInterval ) == 0 )
+                {
+                    if ( !m_Reader.Restart() )
+                    { return Fail( "Restart Marker Not Found." ); }
+
+                    for( unsigned int i=0; i<count; ++i )
+                    { pComps[i]->dcPred = 0; }
+                    m_EobRun = 0;
+                }
+
+                if ( count == 1 )
+                {
+                    if ( !DecodeBlock( *pComps[0], mx, my, param ) )
+                    { return false; }
+                    continue;
+                }
+
+                for( unsigned int i=0; i<count; ++i )
+                {
+                    Component& comp = *pComps[i];
+                    for( unsigned int v=0; v<comp.v; ++v )
+                    {
+                        for( unsigned int h=0; h<comp.h; ++h )
+                        {
+                            if ( !DecodeBlock( comp, mx * comp.h + h, my * comp.v + v, param ) )
+                            { return false; }
+                        }
+                    }
+                }
+            }
+        }
+
+        pNext = m_Reader.FindMarker();
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------
+    //      1ブロックを復号します.
+    //---------------------------------------------------------------------------------------
+    bool DecodeBlock( Component& comp, unsigned int bx, unsigned int by, const ScanParam& param )
+    {
+        if ( !m_Progressive )
+        {
+            // シーケンシャルは係数が揃うのでそのまま逆DCTする.
+            short coef[64];
+            if ( !DecodeSequential( comp, coef ) )
+            { return false; }
+
+            const size_t stride = size_t( comp.blocksW ) * 8;
+            IdctBlock( coef, comp.idct, &comp.plane[ size_t( by ) * 8 * stride + bx * 8 ], stride );
+            return true;
+        }
+
+        short* pCoef = &comp.coef[ ( size_t( by ) * comp.blocksW + bx ) * 64 ];
+        if ( param.ss == 0 )
+        {
+            if ( param.ah == 0 )
+            { return DecodeDCFirst( comp, pCoef, param ); }
+
+            // DCの逐次近似は1ビットを追加するだけ.
+            if ( m_Reader.GetBits( 1 ) )
+            { pCoef[0] = static_cast<short>( pCoef[0] | ( 1 << param.al ) ); }
+            return true;
+        }
+
+        return ( param.ah == 0 )
+            ? DecodeACFirst( comp, pCoef, param )
+            : DecodeACRefine( comp, pCoef, param );
+    }
+
+    //---------------------------------------------------------------------------------------
+    //      シーケンシャルの1ブロックを復号します.
+    //---------------------------------------------------------------------------------------
+    bool DecodeSequential( Component& comp, short* pCoef )
+    {
+        memset( pCoef, 0, sizeof(short) * 64 );
+
+        const int t = m_Reader.Decode( m_DcTables[comp.dcTable] );
+        if ( t < 0 || t > 11 )
+        { return Fail( "Corrupt Huffman Data." ); }
+
+        const int diff = ( t != 0 ) ? Extend( m_Reader.GetBits( t ), t ) : 0;
+        comp.dcPred += diff;
+        pCoef[0] = static_cast<short>( comp.dcPred );
+
+        const HuffmanTable& ac = m_AcTables[comp.acTable];
+        unsigned int k = 1;
+        while( k < 64 )
+        {
+            const int rs = m_Reader.Decode( ac );
+            if ( rs < 0 )
+            { return Fail( "Corrupt Huffman Data." ); }
+
+            const unsigned int r = rs >> 4;
+            const unsigned int s = rs & 0xf;
+            if ( s == 0 )
+            {
+                if ( r != 15 )
+                { break; }      // EOB.
+                k += 16;        // ZRL.
+                continue;
+            }
+
+            k += r;
+            if ( k > 63 )
+            { return Fail( "Corrupt Huffman Data." ); }
+
+            pCoef[ ZIGZAG[k++] ] = static_cast<short>( Extend( m_Reader.GetBits( s ), s ) );
+        }
+
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------
+    //      プログレッシブのDC初回スキャンを復号します.
+    //---------------------------------------------------------------------------------------
+    bool DecodeDCFirst( Component& comp, short* pCoef, const ScanParam& param )
+    {
+        const int t = m_Reader.Decode( m_DcTables[comp.dcTable] );
+        if ( t < 0 || t > 11 )
+        { return Fail( "Corrupt Huffman Data." ); }
+
+        const int diff = ( t != 0 ) ? Extend( m_Reader.GetBits( t ), t ) : 0;
+        comp.dcPred += diff;
+        pCoef[0] = static_cast<short>( comp.dcPred * ( 1 << param.al ) );
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------
+    //      プログレッシブのAC初回スキャンを復号します.
+    //---------------------------------------------------------------------------------------
+    bool DecodeACFirst( Component& comp, short* pCoef, const ScanParam& param )
+    {
+        if ( m_EobRun > 0 )
+        {
+            --m_EobRun;
+            return true;
+        }
+
+        const HuffmanTable& ac = m_AcTables[comp.acTable];
+        unsigned int k = param.ss;
+        while( k <= param.se )
+        {
+            const int rs = m_Reader.Decode( ac );
+            if ( rs < 0 )
+            { return Fail( "Corrupt Huffman Data." ); }
+
+            const unsigned int r = rs >> 4;
+            const unsigned int s = rs & 0xf;
+            if ( s == 0 )
+            {
+                if ( r < 15 )
+                {
+                    // EOBRUN は現在のブロックを含むので1つ減らしておく.
+                    m_EobRun = ( 1u << r ) + m_Reader.GetBits( r ) - 1;
+                    break;
+                }
+                k += 16;
+                continue;
+            }
+
+            k += r;
+            if ( k > param.se )
+            { return Fail( "Corrupt Huffman Data." ); }
+
+            pCoef[ ZIGZAG[k++] ] = static_cast<short>( Extend( m_Reader.GetBits( s ), s ) * ( 1 << param.al ) );
+        }
+
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------
+    //      既に非0の係数に補正ビットを1つ加えます.
+    //---------------------------------------------------------------------------------------
+    void RefineNonZero( short* p, short bit )
+    {
+        if ( m_Reader.GetBits( 1 ) && ( *p & bit ) == 0 )
+        { *p = static_cast<short>( ( *p > 0 ) ? *p + bit : *p - bit ); }
+    }
+
+    //---------------------------------------------------------------------------------------
+    //      プログレッシブのAC逐次近似スキャンを復号します.
+    //---------------------------------------------------------------------------------------
+    bool DecodeACRefine( Component& comp, short* pCoef, const ScanParam& param )
+    {
+        const short bit = static_cast<short>( 1 << param.al );
+
+        unsigned int k = param.ss;
+        if ( m_EobRun == 0 )
+        {
+            const HuffmanTable& ac = m_AcTables[comp.acTable];
+            while( k <= param.se )
+            {
+                const int rs = m_Reader.Decode( ac );
+                if ( rs < 0 )
+                { return Fail( "Corrupt Huffman Data." ); }
+
+                int          r = rs >> 4;
+                const int    s = rs & 0xf;
+                short        value = 0;
+                if ( s == 0 )
+                {
+                    if ( r < 15 )
+                    {
+                        // 残りはEOBランとして下で処理する.
+                        m_EobRun = ( 1u << r ) + m_Reader.GetBits( r );
+                        break;
+                    }
+                    // ZRL は0係数を16個飛ばす(r=15 の後に値0を書く扱い).
+                }
+                else
+                {
+                    if ( s != 1 )
+                    { return Fail( "Corrupt Huffman Data." ); }
+                    value = m_Reader.GetBits( 1 ) ? bit : static_cast<short>( -bit );
+                }
+
+                // r個の0係数を飛ばし，その間の非0係数は補正する.
+                while( k <= param.se )
+                {
+                    short* p = &pCoef[ ZIGZAG[k++] ];
+                    if ( *p != 0 )
+                    { RefineNonZero( p, bit ); }
+                    else
+                    {
+                        if ( r == 0 )
+                        {
+                            if ( value != 0 )
+                            { *p = value; }
+                            break;
+                        }
+                        --r;
+                    }
+                }
+            }
+        }
+
+        if ( m_EobRun > 0 )
+        {
+            // EOBラン中のブロックは残りの非0係数の補正だけを行う.
+            for( ; k <= param.se; ++k )
+            {
+                short* p = &pCoef[ ZIGZAG[k] ];
+                if ( *p != 0 )
+                { RefineNonZero( p, bit ); }
+            }
+            --m_EobRun;
+        }
+
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------------
+    //      成分の1行をフル解像度に拡大します.
+    //---------------------------------------------------------------------------------------
+    const unsigned char* Upsample( const Component& comp, unsigned int y, unsigned char* pBuffer ) const
+    {
+        const size_t         stride = size_t( comp.blocksW ) * 8;
+        const unsigned int   sx     = m_MaxH / comp.h;
+        const unsigned int   sy     = m_MaxV / comp.v;
+        const unsigned int   w      = comp.width;
+        const unsigned char* pPlane = &comp.plane[0];
+
+        if ( sx == 1 && sy == 1 )
+        { return pPlane + size_t( y ) * stride; }
+
+        // 1サンプル幅は補間する相手がないので複製する.
+        if ( w == 1 && sx == 2 && sy <= 2 )
+        {
+            memset( pBuffer, pPlane[ size_t( y / sy ) * stride ], sx );
+            return pBuffer;
+        }
+
+        if ( sx == 2 && sy == 1 )
+        {
+            // 水平2倍の三角フィルタ(libjpeg の fancy upsampling 相当).
+            const unsigned char* pIn = pPlane + size_t( y ) * stride;
+            pBuffer[0] = pIn[0];
+            pBuffer[1] = static_cast<unsigned char>( ( pIn[0] * 3 + pIn[1] + 2 ) >> 2 );
+            for( unsigned int i=1; i<w - 1; ++i )
+            {
+                const int cur = pIn[i] * 3;
+                pBuffer[i * 2 + 0] = static_cast<unsigned char>( ( cur + pIn[i - 1] + 1 ) >> 2 );
+                pBuffer[i * 2 + 1] = static_cast<unsigned char>( ( cur + pIn[i + 1] + 2 ) >> 2 );
+            }
+            pBuffer[w * 2 - 2] = static_cast<unsigned char>( ( pIn[w - 1] * 3 + pIn[w - 2] + 1 ) >> 2 );
+            pBuffer[w * 2 - 1] = pIn[w - 1];
+            return pBuffer;
+        }
+
+        if ( sx == 1 && sy == 2 )
+        {
+            // 垂直2倍の三角フィルタ.
+            const unsigned int   inY  = y / 2;
+            const unsigned int   farY = ( y & 1 )
+                                      ? ( ( inY + 1 < comp.height ) ? inY + 1 : inY )
+                                      : ( ( inY > 0 ) ? inY - 1 : 0 );
+            const unsigned char* pNear = pPlane + size_t( inY  ) * stride;
+            const unsigned char* pFar  = pPlane + size_t( farY ) * stride;
+            const int            bias  = ( y & 1 ) ? 2 : 1;
+            for( unsigned int i=0; i<w; ++i )
+            { pBuffer[i] = static_cast<unsigned char>( ( pNear[i] * 3 + pFar[i] + bias ) >> 2 ); }
+            return pBuffer;
+        }
+
+        if ( sx == 2 && sy == 2 )
+        {
+            // 縦横2倍の三角フィルタ. 近い行を3，遠い行を1で重み付けした列和を水平に補間する.
+            const unsigned int   inY  = y / 2;
+            const unsigned int   farY = ( y & 1 )
+                                      ? ( ( inY + 1 < comp.height ) ? inY + 1 : inY )
+                                      : ( ( inY > 0 ) ? inY - 1 : 0 );
+            const unsigned char* pNear = pPlane + size_t( inY  ) * stride;
+            const unsigned char* pFar  = pPlane + size_t( farY ) * stride;
+
+            int last = pNear[0] * 3 + pFar[0];
+            int cur  = last;
+            int next = pNear[1] * 3 + pFar[1];
+            pBuffer[0] = static_cast<unsigned char>( ( cur * 4 + 8 ) >> 4 );
+            pBuffer[1] = static_cast<unsigned char>( ( cur * 3 + next + 7 ) >> 4 );
+            for( unsigned int i=1; i<w - 1; ++i )
+            {
+                last = cur;
+                cur  = next;
+                next = pNear[i + 1] * 3 + pFar[i + 1];
+                pBuffer[i * 2 + 0] = static_cast<unsigned char>( ( cur * 3 + last + 8 ) >> 4 );
+                pBuffer[i * 2 + 1] = static_cast<unsigned char>( ( cur * 3 + next + 7 ) >> 4 );
+            }
+            last = cur;
+            cur  = next;
+            pBuffer[w * 2 - 2] = static_cast<unsigned char>( ( cur * 3 + last + 8 ) >> 4 );
+            pBuffer[w * 2 - 1] = static_cast<unsigned char>( ( cur * 4 + 7 ) >> 4 );
+            return pBuffer;
+        }
+
+        // その他の係数は最近傍で拡大する.
+        const unsigned char* pIn = pPlane + size_t( y / sy ) * stride;
+        for( unsigned int x=0; x<m_Width; ++x )
+        { pBuffer[x] = pIn[x / sx]; }
+        return pBuffer;
+    }
+};
+
+//-------------------------------------------------------------------------------------------
+//      色空間に応じた内部フォーマットを取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int GetInternalFormat( unsigned int format, COLOR_SPACE colorSpace )
+{
+    if ( colorSpace != COLOR_SPACE_SRGB )
+    { return format; }
+
+    return ( format == GL_RGBA ) ? GL_SRGB8_ALPHA8 : GL_SRGB8;
+}
+
+//-------------------------------------------------------------------------------------------
+//      sRGBの内部フォーマットかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsSRGBInternalFormat( unsigned int internalFormat )
+{ return ( internalFormat == GL_SRGB8 ) || ( internalFormat == GL_SRGB8_ALPHA8 ); }
+
+//-------------------------------------------------------------------------------------------
+//      sRGBテクスチャに対応しているかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsSupportSRGBTexture()
+{
+    // GL 2.1 以降はコア機能.
+    const char* pVersion = reinterpret_cast<const char*>( glGetString( GL_VERSION ) );
+    if ( pVersion != nullptr )
+    {
+        const char* pDot  = strchr( pVersion, '.' );
+        const int   major = atoi( pVersion );
+        const int   minor = ( pDot != nullptr ) ? atoi( pDot + 1 ) : 0;
+        if ( major > 2 || ( major == 2 && minor >= 1 ) )
+        { return true; }
+    }
+
+    const char* pExtensions = reinterpret_cast<const char*>( glGetString( GL_EXTENSIONS ) );
+    return ( pExtensions != nullptr ) && ( strstr( pExtensions, "GL_EXT_texture_sRGB" ) != nullptr );
+}
+
+} // namespace /* anonymous */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// JpegImage class
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------
+JpegImage::JpegImage()
+: m_ImageSize       ( 0 )
+, m_Format          ( 0 )
+, m_InternalFormat  ( 0 )
+, m_Width           ( 0 )
+, m_Height          ( 0 )
+, m_BytePerPixel    ( 0 )
+, m_ID              ( 0 )
+, m_pImageData      ( nullptr )
+, m_ColorSpace      ( COLOR_SPACE_SRGB )
+, m_ColorSpaceHint  ( COLOR_SPACE_SRGB )
+{ /* DO_NOTHING */ }
+
+
+//-------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------
+JpegImage::~JpegImage()
+{ Release(); }
+
+//-------------------------------------------------------------------------------------------
+//      解放処理を行います.
+//-------------------------------------------------------------------------------------------
+void JpegImage::Release()
+{
+    if ( m_pImageData )
+    {
+        delete[] m_pImageData;
+        m_pImageData = nullptr;
+    }
+
+    m_Cache.Close();
+
+    m_ImageSize      = 0;
+    m_Format         = 0;
+    m_InternalFormat = 0;
+    m_Width          = 0;
+    m_Height         = 0;
+    m_BytePerPixel   = 0;
+    m_ColorSpace     = m_ColorSpaceHint;
+}
+
+//-------------------------------------------------------------------------------------------
+//      読み込み処理を行います.
+//-------------------------------------------------------------------------------------------
+bool JpegImage::Load( const char* filename )
+{
+    // 線形として扱う場合はミップマップの内容が変わるので，キャッシュを区別する.
+    const unsigned long long salt = ( m_ColorSpaceHint == COLOR_SPACE_LINEAR ) ? TextureCache::SALT_LINEAR : 0;
+
+    // 変換済みのキャッシュがあれば復号とミップ生成をすべて省略する.
+    if ( m_Cache.Open( filename, salt ) )
+    {
+        m_Width          = m_Cache.GetWidth();
+        m_Height         = m_Cache.GetHeight();
+        m_BytePerPixel   = m_Cache.GetBytePerPixel();
+        m_Format         = m_Cache.GetFormat();
+        m_InternalFormat = m_Cache.GetInternalFormat();
+        m_ColorSpace     = IsSRGBInternalFormat( m_InternalFormat ) ? COLOR_SPACE_SRGB : COLOR_SPACE_LINEAR;
+        m_ImageSize      = m_Cache.GetLevel( 0 ).size;
+        return true;
+    }
+
+    MappedFile file;
+    if ( !file.Open( filename ) )
+    {
+        std::cerr << "Error : File Open Failed.";
+        std::cerr << "File Name : " << filename << std::endl;
+        return false;
+    }
+
+    JpegDecoder decoder;
+    if ( !decoder.Decode( file.GetData(), file.GetSize() ) )
+    {
+        std::cerr << "Error : " << decoder.GetError();
+        std::cerr << "File Name : " << filename << std::endl;
+        return false;
+    }
+
+    const unsigned int       channels  = 3;
+    const unsigned long long imageSize = static_cast<unsigned long long>( decoder.GetWidth() ) * decoder.GetHeight() * channels;
+    if ( imageSize > 0xffffffff || imageSize > static_cast<unsigned long long>( size_t( -1 ) ) )
+    {
+        std::cerr << "Error : Image Too Large." << std::endl;
+        return false;
+    }
+
+    m_pImageData = new(std::nothrow) unsigned char [size_t( imageSize )];
+    if ( m_pImageData == nullptr )
+    {
+        std::cerr << "Error : Memory Allocate Failed." << std::endl;
+        return false;
+    }
+
+    decoder.Output( m_pImageData );
+
+    // データを設定.
+    m_Width          = decoder.GetWidth();
+    m_Height         = decoder.GetHeight();
+    m_BytePerPixel   = channels;
+    m_ImageSize      = static_cast<unsigned int>( imageSize );
+    m_Format         = GL_RGB;
+    m_ColorSpace     = m_ColorSpaceHint;
+    m_InternalFormat = GetInternalFormat( GL_RGB, m_ColorSpace );
+
+    // 正常終了.
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      テクスチャを生成します.
+//-------------------------------------------------------------------------------------------
+bool JpegImage::CreateGLTexture()
+{
+    if ( m_pImageData == nullptr && !m_Cache.IsValid() )
+    { return false; }
+
+    //　テクスチャを生成
+    glGenTextures(1, &m_ID);
+
+    //　テクスチャをバインドする
+    glBindTexture(GL_TEXTURE_2D, m_ID);
+
+    // sRGBテクスチャに非対応の環境では変換せずにそのまま転送する.
+    const unsigned int internalFormat = ( IsSRGBInternalFormat( m_InternalFormat ) && !IsSupportSRGBTexture() )
+        ? m_Format
+        : m_InternalFormat;
+
+    if ( m_BytePerPixel == 4 )
+    { glPixelStorei(GL_UNPACK_ALIGNMENT, 4); }
+    else 
+    { glPixelStorei(GL_UNPACK_ALIGNMENT, 1); }
+
+    if ( m_Cache.IsValid() )
+    {
+        //　キャッシュからマップしたまま転送する.
+        for( unsigned int i=0; i<m_Cache.GetMipCount(); ++i )
+        {
+            const TextureCache::Level& level = m_Cache.GetLevel( i );
+            glTexImage2D(
+                GL_TEXTURE_2D,
+                int(i),
+                internalFormat,
+                level.width,
+                level.height,
+                0,
+                m_Format,
+                GL_UNSIGNED_BYTE,
+                m_Cache.GetLevelData( i ) );
+        }
+    }
+    else
+    {
+        //　ミップマップチェインをCPUで生成する(非2の累乗サイズもリスケールしない).
+        //　sRGBの画像は線形空間に変換してから縮小する.
+        MipMapOption option;
+        option.isSRGB = ( m_ColorSpace == COLOR_SPACE_SRGB );
+
+        std::vector<MipLevel> levels;
+        if ( !GenerateMipMaps( m_pImageData, m_Width, m_Height, m_BytePerPixel, option, levels ) )
+        {
+            std::cerr << "Error : Generate MipMaps Failed." << std::endl;
+            glBindTexture( GL_TEXTURE_2D, 0 );
+            DeleteGLTexture();
+            return false;
+        }
+
+        //　テクスチャの割り当て
+        for( size_t i=0; i<levels.size(); ++i )
+        {
+            glTexImage2D(
+                GL_TEXTURE_2D,
+                int(i),
+                internalFormat,
+                levels[i].width,
+                levels[i].height,
+                0,
+                m_Format,
+                GL_UNSIGNED_BYTE,
+                &levels[i].pixels[0] );
+        }
+
+        // 次回の起動で復号とミップ生成を省略できるよう保存しておく.
+        m_Cache.Save( m_Format, m_InternalFormat, m_BytePerPixel, levels );
+    }
+
+    //　テクスチャを拡大・縮小する方法の指定
+    glTexParameteri(GL_TEXTURE_2D, 	GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, 	GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+
+    //　テクスチャ環境
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+
+    // アンバインドしておく.
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      テクスチャを破棄します.
+//-------------------------------------------------------------------------------------------
+void JpegImage::DeleteGLTexture()
+{
+    if ( m_ID )
+    {
+        glDeleteTextures( 1, &m_ID );
+        m_ID = 0;
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      テクスチャIDを取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int JpegImage::GetID() const
+{ return m_ID; }
+
+//-------------------------------------------------------------------------------------------
+//      画像の横幅を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int JpegImage::GetWidth() const
+{ return m_Width; }
+
+//-------------------------------------------------------------------------------------------
+//      画像の縦幅を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int JpegImage::GetHeight() const
+{ return m_Height; }
+
+//-------------------------------------------------------------------------------------------
+//      1ピクセルあたりのバイト数を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int JpegImage::GetBytePerPixel() const
+{ return m_BytePerPixel; }
+
+//-------------------------------------------------------------------------------------------
+//      ピクセルデータを取得します.
+//-------------------------------------------------------------------------------------------
+const unsigned char* JpegImage::GetPixels() const
+{ return ( m_pImageData != nullptr ) ? m_pImageData : m_Cache.GetLevelData( 0 ); }
+
+//-------------------------------------------------------------------------------------------
+//      色空間の情報を持たない画像に適用する色空間を設定します.
+//-------------------------------------------------------------------------------------------
+void JpegImage::SetColorSpaceHint( COLOR_SPACE colorSpace )
+{ m_ColorSpaceHint = colorSpace; }
+
+//-------------------------------------------------------------------------------------------
+//      読み込んだ画像の色空間を取得します.
+//-------------------------------------------------------------------------------------------
+COLOR_SPACE JpegImage::GetColorSpace() const
+{ return m_ColorSpace; }
@@ -0,0 +1,114 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : ColorSpace.h
+// Desc : sRGB / Linear Color Space Conversion.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+#ifndef _COLOR_SPACE_H_
+#define _COLOR_SPACE_H_
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <cstddef>
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// COLOR_SPACE enum
+/////////////////////////////////////////////////////////////////////////////////////////////
+enum COLOR_SPACE
+{
+    COLOR_SPACE_SRGB = 0,           //!< sRGB(ガンマ補正済み)です. 8bitのカラー画像の既定値です.
+    COLOR_SPACE_LINEAR,             //!< 線形です. 法線マップやデータテクスチャ，浮動小数画像に使用します.
+};
+
+
+//-------------------------------------------------------------------------------------------
+//! @brief      sRGBの値を線形の値に変換します.
+//!
+//! @note       powf() は使用せず，log2/exp2 の多項式近似で計算します(相対誤差 1e-6 程度).
+//! @param [in]     value       sRGBの値です. 1.0 を超える値も変換します.
+//! @return     線形の値を返却します.
+//-------------------------------------------------------------------------------------------
+float SRGBToLinear( float value );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      線形の値をsRGBの値に変換します.
+//!
+//! @param [in]     value       線形の値です. 1.0 を超える値も変換します.
+//! @return     sRGBの値を返却します.
+//-------------------------------------------------------------------------------------------
+float LinearToSRGB( float value );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      8bitのsRGB値をテーブル参照で線形の値に変換します.
+//-------------------------------------------------------------------------------------------
+float SRGB8ToLinear( unsigned char value );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      線形の値を最も近い8bitのsRGB値に変換します.
+//!
+//! @note       テーブルで近似値を求め，sRGB値の境界と比較して補正します. 範囲外の値はクランプします.
+//-------------------------------------------------------------------------------------------
+unsigned char LinearToSRGB8( float value );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      浮動小数の配列をsRGBから線形に変換します.
+//!
+//! @note       SSE2が使える場合は4要素ずつ処理します. pSrc と pDst は同じでも構いません.
+//! @param [in]     pSrc        変換元です.
+//! @param [out]    pDst        出力先です.
+//! @param [in]     count       要素数です.
+//-------------------------------------------------------------------------------------------
+void ConvertSRGBToLinear( const float* pSrc, float* pDst, size_t count );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      浮動小数の配列を線形からsRGBに変換します.
+//!
+//! @note       SSE2が使える場合は4要素ずつ処理します. pSrc と pDst は同じでも構いません.
+//! @param [in]     pSrc        変換元です.
+//! @param [out]    pDst        出力先です.
+//! @param [in]     count       要素数です.
+//-------------------------------------------------------------------------------------------
+void ConvertLinearToSRGB( const float* pSrc, float* pDst, size_t count );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      8bitのピクセルデータを線形空間の float4 に変換します.
+//!
+//! @note       チャンネル c は出力の c 番目の要素に格納し，存在しないカラー成分は 0，
+//!             アルファは 1 で埋めます. アルファ(2チャンネルの1番目，4チャンネルの3番目)は
+//!             常に線形として扱います.
+//! @param [in]     pSrc            変換元のピクセルデータです.
+//! @param [in]     pixelCount      ピクセル数です.
+//! @param [in]     bytePerPixel    1ピクセルあたりのバイト数(1～4)です.
+//! @param [in]     colorSpace      変換元のカラー成分の色空間です.
+//! @param [out]    pDst            pixelCount * 4 要素の出力先です.
+//-------------------------------------------------------------------------------------------
+void ConvertToLinearFloat4(
+    const unsigned char*    pSrc,
+    size_t                  pixelCount,
+    unsigned int            bytePerPixel,
+    COLOR_SPACE             colorSpace,
+    float*                  pDst );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      線形空間の float4 を8bitのピクセルデータに変換します.
+//!
+//! @note       [0, 1] にクランプしてから量子化します.
+//! @param [in]     pSrc            pixelCount * 4 要素の変換元です.
+//! @param [in]     pixelCount      ピクセル数です.
+//! @param [in]     bytePerPixel    1ピクセルあたりのバイト数(1～4)です.
+//! @param [in]     colorSpace      出力するカラー成分の色空間です.
+//! @param [in]     alphaScale      アルファに乗算する値です.
+//! @param [out]    pDst            出力先です.
+//-------------------------------------------------------------------------------------------
+void ConvertFromLinearFloat4(
+    const float*            pSrc,
+    size_t                  pixelCount,
+    unsigned int            bytePerPixel,
+    COLOR_SPACE             colorSpace,
+    float                   alphaScale,
+    unsigned char*          pDst );
+
+
+#endif//_COLOR_SPACE_H_
@@ -0,0 +1,76 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : Inflate.h
+// Desc : Deflate Stream Decoder.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+#ifndef _INFLATE_H_
+#define _INFLATE_H_
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <cstddef>
+
+
+//-------------------------------------------------------------------------------------------
+//! @brief      Adler-32 チェックサムを計算します.
+//!
+//! @param [in]     pData       データです.
+//! @param [in]     size        データサイズです.
+//! @param [in]     adler       前回までのチェックサムです. 初回は1を指定します.
+//! @return     チェックサムを返却します.
+//-------------------------------------------------------------------------------------------
+unsigned int ComputeAdler32( const void* pData, size_t size, unsigned int adler = 1 );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      CRC-32 を計算します.
+//!
+//! @param [in]     pData       データです.
+//! @param [in]     size        データサイズです.
+//! @param [in]     crc         前回までのCRCです. 初回は0を指定します.
+//! @return     CRCを返却します.
+//-------------------------------------------------------------------------------------------
+unsigned int ComputeCrc32( const void* pData, size_t size, unsigned int crc = 0 );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      Deflate (RFC 1951) のストリームを展開します.
+//!
+//! @note       展開後のサイズが既知であることを前提に，出力先を事前に確保してもらいます.
+//!             出力先を超える場合や不正なストリームの場合は失敗します.
+//! @param [in]     pSrc        圧縮データです.
+//! @param [in]     srcSize     圧縮データのサイズです.
+//! @param [out]    pDst        展開先です.
+//! @param [in]     dstSize     展開先のサイズです.
+//! @param [out]    pDstWritten 展開したバイト数の格納先です. 不要な場合は nullptr を指定します.
+//! @retval true    展開に成功.
+//! @retval false   展開に失敗.
+//-------------------------------------------------------------------------------------------
+bool Inflate(
+    const unsigned char*    pSrc,
+    size_t                  srcSize,
+    unsigned char*          pDst,
+    size_t                  dstSize,
+    size_t*                 pDstWritten = nullptr );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      zlib (RFC 1950) 形式のストリームを展開します.
+//!
+//! @note       ヘッダを検証し，展開後に Adler-32 を照合します.
+//! @param [in]     pSrc        圧縮データです.
+//! @param [in]     srcSize     圧縮データのサイズです.
+//! @param [out]    pDst        展開先です.
+//! @param [in]     dstSize     展開先のサイズです.
+//! @param [out]    pDstWritten 展開したバイト数の格納先です. 不要な場合は nullptr を指定します.
+//! @retval true    展開に成功.
+//! @retval false   展開に失敗.
+//-------------------------------------------------------------------------------------------
+bool InflateZlib(
+    const unsigned char*    pSrc,
+    size_t                  srcSize,
+    unsigned char*          pDst,
+    size_t                  dstSize,
+    size_t*                 pDstWritten = nullptr );
+
+
+#endif//_INFLATE_H_
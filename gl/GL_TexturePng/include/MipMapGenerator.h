@@ -0,0 +1,97 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : MipMapGenerator.h
+// Desc : CPU MipMap Chain Generator.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+#ifndef _MIPMAP_GENERATOR_H_
+#define _MIPMAP_GENERATOR_H_
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <vector>
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// MIPMAP_FILTER enum
+/////////////////////////////////////////////////////////////////////////////////////////////
+enum MIPMAP_FILTER
+{
+    MIPMAP_FILTER_BOX = 0,          //!< ボックスフィルタ(面積平均)です.
+    MIPMAP_FILTER_KAISER,           //!< カイザー窓付きsincフィルタです(幅3, alpha=4).
+    MIPMAP_FILTER_LANCZOS,          //!< Lanczos3フィルタです.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// MipMapOption structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct MipMapOption
+{
+    MIPMAP_FILTER   filter;                 //!< 縮小フィルタです.
+    bool            isSRGB;                 //!< カラー成分をsRGBとして扱い，線形空間で縮小する場合は true.
+    bool            preserveAlphaCoverage;  //!< アルファテストの被覆率を各レベルで保つ場合は true.
+    float           alphaReference;         //!< 被覆率を計算する際のアルファ参照値です.
+    unsigned int    threadCount;            //!< 使用するスレッド数です. 0の場合はハードウェアスレッド数を使用します.
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------
+    MipMapOption()
+    : filter                ( MIPMAP_FILTER_KAISER )
+    , isSRGB                ( true )
+    , preserveAlphaCoverage ( false )
+    , alphaReference        ( 0.5f )
+    , threadCount           ( 0 )
+    { /* DO_NOTHING */ }
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// MipLevel structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct MipLevel
+{
+    unsigned int                width;      //!< 横幅です.
+    unsigned int                height;     //!< 縦幅です.
+    std::vector<unsigned char>  pixels;     //!< 行パディングなしのピクセルデータです.
+};
+
+
+//-------------------------------------------------------------------------------------------
+//! @brief      1x1 までのミップレベル数を取得します.
+//!
+//! @param [in]     width       横幅です.
+//! @param [in]     height      縦幅です.
+//! @return     ミップレベル数を返却します.
+//-------------------------------------------------------------------------------------------
+unsigned int GetMipLevelCount( unsigned int width, unsigned int height );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      1x1 までのミップマップチェインを生成します.
+//!
+//! @note       GLコンテキストを必要としないため，結果をキャッシュしたり
+//!             glTexImage2D でレベルごとに転送したりできます.
+//!             2の累乗でない画像もリスケールせず，各レベルを max( 1, size / 2 ) に縮小します.
+//!             levels[0] は元画像のコピーです.
+//!
+//! @param [in]     pSrc            元画像のピクセルデータです(行パディングなし).
+//! @param [in]     width           元画像の横幅です.
+//! @param [in]     height          元画像の縦幅です.
+//! @param [in]     bytePerPixel    1ピクセルあたりのバイト数(1～4)です. 2はLA，4はRGBAとして扱います.
+//! @param [in]     option          生成オプションです.
+//! @param [out]    levels          生成したミップレベルの格納先です.
+//! @retval true    生成に成功.
+//! @retval false   生成に失敗.
+//-------------------------------------------------------------------------------------------
+bool GenerateMipMaps(
+    const unsigned char*    pSrc,
+    unsigned int            width,
+    unsigned int            height,
+    unsigned int            bytePerPixel,
+    const MipMapOption&     option,
+    std::vector<MipLevel>&  levels );
+
+
+#endif//_MIPMAP_GENERATOR_H_
@@ -0,0 +1,93 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : Resampler.h
+// Desc : Separable Image Resampler.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+#ifndef _RESAMPLER_H_
+#define _RESAMPLER_H_
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// RESAMPLE_FILTER enum
+/////////////////////////////////////////////////////////////////////////////////////////////
+enum RESAMPLE_FILTER
+{
+    RESAMPLE_FILTER_BOX = 0,        //!< ボックスフィルタ(面積平均)です.
+    RESAMPLE_FILTER_BILINEAR,       //!< 三角フィルタ(バイリニア)です.
+    RESAMPLE_FILTER_BICUBIC,        //!< Catmull-Rom スプライン(バイキュービック, a = -0.5)です.
+    RESAMPLE_FILTER_LANCZOS3,       //!< Lanczos3フィルタです.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// RESAMPLE_FORMAT enum
+/////////////////////////////////////////////////////////////////////////////////////////////
+enum RESAMPLE_FORMAT
+{
+    RESAMPLE_FORMAT_RGB8 = 0,       //!< 8bit RGB です.
+    RESAMPLE_FORMAT_RGBA8,          //!< 8bit RGBA です.
+    RESAMPLE_FORMAT_RGB32F,         //!< 32bit浮動小数 RGB です.
+    RESAMPLE_FORMAT_RGBA32F,        //!< 32bit浮動小数 RGBA です.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// ResampleOption structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct ResampleOption
+{
+    RESAMPLE_FILTER filter;         //!< リサンプルフィルタです.
+    bool            isSRGB;         //!< 8bitのカラー成分をsRGBとして扱い，線形空間でフィルタする場合は true.
+    unsigned int    threadCount;    //!< 使用するスレッド数です. 0の場合はハードウェアスレッド数を使用します.
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------
+    ResampleOption()
+    : filter        ( RESAMPLE_FILTER_BICUBIC )
+    , isSRGB        ( true )
+    , threadCount   ( 0 )
+    { /* DO_NOTHING */ }
+};
+
+
+//-------------------------------------------------------------------------------------------
+//! @brief      1ピクセルあたりのバイト数を取得します.
+//!
+//! @param [in]     format      ピクセルフォーマットです.
+//! @return     1ピクセルあたりのバイト数を返却します.
+//-------------------------------------------------------------------------------------------
+unsigned int GetResampleBytePerPixel( RESAMPLE_FORMAT format );
+
+//-------------------------------------------------------------------------------------------
+//! @brief      画像を任意のサイズに拡大・縮小します.
+//!
+//! @note       横 -> 縦の順に分離可能フィルタを適用します. 各出力位置の重みは事前に
+//!             テーブル化し(ポリフェーズ)，縮小時はカーネルを縮小率に合わせて引き伸ばします.
+//!             画像端はクランプします. 8bitフォーマットの出力は [0, 255] にクランプし，
+//!             浮動小数フォーマットの出力はクランプしません.
+//!
+//! @param [in]     pSrc        元画像のピクセルデータです(行パディングなし).
+//! @param [in]     srcWidth    元画像の横幅です.
+//! @param [in]     srcHeight   元画像の縦幅です.
+//! @param [in]     format      元画像と出力先のピクセルフォーマットです.
+//! @param [out]    pDst        出力先です. dstWidth * dstHeight ピクセル分の領域が必要です.
+//! @param [in]     dstWidth    出力先の横幅です.
+//! @param [in]     dstHeight   出力先の縦幅です.
+//! @param [in]     option      リサンプルオプションです.
+//! @retval true    リサンプルに成功.
+//! @retval false   リサンプルに失敗.
+//-------------------------------------------------------------------------------------------
+bool ResampleImage(
+    const void*             pSrc,
+    unsigned int            srcWidth,
+    unsigned int            srcHeight,
+    RESAMPLE_FORMAT         format,
+    void*                   pDst,
+    unsigned int            dstWidth,
+    unsigned int            dstHeight,
+    const ResampleOption&   option );
+
+
+#endif//_RESAMPLER_H_
@@ -0,0 +1,551 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : Inflate.cpp
+// Desc : Deflate Stream Decoder.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <Inflate.h>
+#include <cstring>
+#include <mutex>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+const int           FAST_BITS       = 10;                   //!< 1回の表引きで復号するビット数です.
+const int           FAST_SIZE       = 1 << FAST_BITS;       //!< 表引きテーブルの要素数です.
+const int           MAX_CODE_BITS   = 15;                   //!< 符号の最大ビット長です.
+const int           MAX_LIT_CODES   = 288;                  //!< リテラル/長さ符号の最大数です.
+const int           MAX_DIST_CODES  = 32;                   //!< 距離符号の最大数です.
+const unsigned int  ADLER_BASE      = 65521;                //!< Adler-32 の法です.
+const size_t        ADLER_NMAX      = 5552;                 //!< 剰余を取らずに加算できる最大バイト数です.
+
+// 長さ符号 257～285 の基本値と追加ビット数.
+const unsigned short LENGTH_BASE [29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const unsigned char  LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+
+// 距離符号 0～29 の基本値と追加ビット数.
+const unsigned short DIST_BASE [30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+const unsigned char  DIST_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// 符号長符号の並び順.
+const unsigned char  CODE_LENGTH_ORDER[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Huffman structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct Huffman
+{
+    unsigned short  fast  [FAST_SIZE];          //!< 表引きテーブルです. ( ビット長 << 9 ) | 符号 で，0は低速経路です.
+    unsigned short  count [MAX_CODE_BITS + 1];  //!< ビット長ごとの符号数です.
+    unsigned short  symbol[MAX_LIT_CODES];      //!< 正準符号順に並べた符号です.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// BitReader structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct BitReader
+{
+    const unsigned char*    pCur;       //!< 次に読み込む位置です.
+    const unsigned char*    pEnd;       //!< 終端です.
+    unsigned long long      bits;       //!< ビットバッファ(LSBから順に消費).
+    int                     count;      //!< ビットバッファ内の有効ビット数です.
+    int                     overrun;    //!< 終端を越えて補填したバイト数です.
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      ビットバッファを補充します.
+    //---------------------------------------------------------------------------------------
+    inline void Refill()
+    {
+        while( count <= 56 )
+        {
+            if ( pCur < pEnd )
+            { bits |= static_cast<unsigned long long>( *pCur++ ) << count; }
+            else
+            { overrun++; }
+            count += 8;
+        }
+    }
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      指定ビット数を読み込みます.
+    //---------------------------------------------------------------------------------------
+    inline unsigned int GetBits( int n )
+    {
+        if ( count < n )
+        { Refill(); }
+
+        const unsigned int value = static_cast<unsigned int>( bits & ( ( 1ull << n ) - 1 ) );
+        bits  >>= n;
+        count  -= n;
+        return value;
+    }
+};
+
+
+//-------------------------------------------------------------------------------------------
+//      ビット列を反転します.
+//-------------------------------------------------------------------------------------------
+inline unsigned int ReverseBits( unsigned int code, int length )
+{
+    unsigned int result = 0;
+    for( int i=0; i<length; ++i )
+    {
+        result = ( result << 1 ) | ( code & 1 );
+        code >>= 1;
+    }
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------
+//      符号長からハフマンテーブルを構築します.
+//-------------------------------------------------------------------------------------------
+bool BuildHuffman( Huffman& table, const unsigned char* pLengths, int symbolCount )
+{
+    memset( table.fast,  0, sizeof(table.fast) );
+    memset( table.count, 0, sizeof(table.count) );
+
+    for( int i=0; i<symbolCount; ++i )
+    { table.count[pLengths[i]]++; }
+    table.count[0] = 0;
+
+    // 符号の割り当てが過剰でないか確認する(不足は許容する).
+    int left = 1;
+    for( int len=1; len<=MAX_CODE_BITS; ++len )
+    {
+        left <<= 1;
+        left -= table.count[len];
+        if ( left < 0 )
+        { return false; }
+    }
+
+    unsigned short offset[MAX_CODE_BITS + 2];
+    unsigned int   nextCode[MAX_CODE_BITS + 2];
+    offset[1]   = 0;
+    nextCode[1] = 0;
+    for( int len=1; len<=MAX_CODE_BITS; ++len )
+    {
+        offset  [len + 1] = offset[len] + table.count[len];
+        nextCode[len + 1] = ( nextCode[len] + table.count[len] ) << 1;
+    }
+
+    for( int i=0; i<symbolCount; ++i )
+    {
+        const int len = pLengths[i];
+        if ( len == 0 )
+        { continue; }
+
+        table.symbol[offset[len]++] = static_cast<unsigned short>( i );
+
+        const unsigned int code = nextCode[len]++;
+        if ( len <= FAST_BITS )
+        {
+            // ストリームはLSBから符号のMSBが並ぶので，反転した値で表を埋める.
+            const unsigned short entry = static_cast<unsigned short>( ( len << 9 ) | i );
+            for( unsigned int j=ReverseBits( code, len ); j<FAST_SIZE; j += ( 1u << len ) )
+            { table.fast[j] = entry; }
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      符号を1つ復号します.
+//-------------------------------------------------------------------------------------------
+inline int DecodeSymbol( BitReader& reader, const Huffman& table )
+{
+    if ( reader.count < MAX_CODE_BITS )
+    { reader.Refill(); }
+
+    const unsigned short entry = table.fast[reader.bits & ( FAST_SIZE - 1 )];
+    if ( entry != 0 )
+    {
+        const int len = entry >> 9;
+        reader.bits  >>= len;
+        reader.count  -= len;
+        return entry & 0x1ff;
+    }
+
+    // 長い符号は正準符号の性質を使って1ビットずつ判定する.
+    int code  = 0;
+    int first = 0;
+    int index = 0;
+    for( int len=1; len<=MAX_CODE_BITS; ++len )
+    {
+        code |= static_cast<int>( reader.bits & 1 );
+        reader.bits >>= 1;
+        reader.count--;
+
+        const int count = table.count[len];
+        if ( code - count < first )
+        { return table.symbol[index + ( code - first )]; }
+
+        index += count;
+        first += count;
+        first <<= 1;
+        code  <<= 1;
+    }
+
+    return -1;
+}
+
+//-------------------------------------------------------------------------------------------
+//      固定ハフマン符号のテーブルを構築します.
+//-------------------------------------------------------------------------------------------
+void BuildFixedHuffman( Huffman& lit, Huffman& dist )
+{
+    unsigned char lengths[MAX_LIT_CODES];
+    int i = 0;
+    for( ; i<144; ++i ) { lengths[i] = 8; }
+    for( ; i<256; ++i ) { lengths[i] = 9; }
+    for( ; i<280; ++i ) { lengths[i] = 7; }
+    for( ; i<288; ++i ) { lengths[i] = 8; }
+    BuildHuffman( lit, lengths, MAX_LIT_CODES );
+
+    for( i=0; i<MAX_DIST_CODES; ++i )
+    { lengths[i] = 5; }
+    BuildHuffman( dist, lengths, MAX_DIST_CODES );
+}
+
+//-------------------------------------------------------------------------------------------
+//      動的ハフマン符号のテーブルを読み込みます.
+//-------------------------------------------------------------------------------------------
+bool ReadDynamicHuffman( BitReader& reader, Huffman& lit, Huffman& dist )
+{
+    const int litCount  = int( reader.GetBits( 5 ) ) + 257;
+    const int distCount = int( reader.GetBits( 5 ) ) + 1;
+    const int lenCount  = int( reader.GetBits( 4 ) ) + 4;
+
+    if ( litCount > 286 || distCount > 30 )
+    { return false; }
+
+    unsigned char codeLengths[19];
+    memset( codeLengths, 0, sizeof(codeLengths) );
+    for( int i=0; i<lenCount; ++i )
+    { codeLengths[CODE_LENGTH_ORDER[i]] = static_cast<unsigned char>( reader.GetBits( 3 ) ); }
+
+    Huffman lenTable;
+    if ( !BuildHuffman( lenTable, codeLengths, 19 ) )
+    { return false; }
+
+    unsigned char lengths[MAX_LIT_CODES + MAX_DIST_CODES];
+    const int total = litCount + distCount;
+    int n = 0;
+    while( n < total )
+    {
+        const int symbol = DecodeSymbol( reader, lenTable );
+        if ( symbol < 0 )
+        { return false; }
+
+        if ( symbol < 16 )
+        {
+            lengths[n++] = static_cast<unsigned char>( symbol );
+            continue;
+        }
+
+        unsigned char value  = 0;
+        int           repeat = 0;
+        if ( symbol == 16 )
+        {
+            if ( n == 0 )
+            { return false; }
+            value  = lengths[n - 1];
+            repeat = 3 + int( reader.GetBits( 2 ) );
+        }
+        else if ( symbol == 17 )
+        { repeat = 3 + int( reader.GetBits( 3 ) ); }
+        else
+        { repeat = 11 + int( reader.GetBits( 7 ) ); }
+
+        if ( n + repeat > total )
+        { return false; }
+
+        memset( &lengths[n], value, repeat );
+        n += repeat;
+    }
+
+    // ブロック終端符号が無いストリームは不正.
+    if ( lengths[256] == 0 )
+    { return false; }
+
+    return BuildHuffman( lit,  lengths,            litCount  )
+        && BuildHuffman( dist, lengths + litCount, distCount );
+}
+
+//-------------------------------------------------------------------------------------------
+//      ハフマン符号化されたブロックを展開します.
+//-------------------------------------------------------------------------------------------
+bool InflateBlock
+(
+    BitReader&      reader,
+    const Huffman&  lit,
+    const Huffman&  dist,
+    unsigned char*  pDst,
+    size_t          dstSize,
+    size_t&         pos
+)
+{
+    for( ;; )
+    {
+        int symbol = DecodeSymbol( reader, lit );
+        if ( symbol < 0 )
+        { return false; }
+
+        if ( symbol < 256 )
+        {
+            if ( pos >= dstSize )
+            { return false; }
+            pDst[pos++] = static_cast<unsigned char>( symbol );
+            continue;
+        }
+
+        if ( symbol == 256 )
+        { return true; }
+
+        symbol -= 257;
+        if ( symbol >= 29 )
+        { return false; }
+
+        const size_t length = LENGTH_BASE[symbol] + reader.GetBits( LENGTH_EXTRA[symbol] );
+
+        const int distSymbol = DecodeSymbol( reader, dist );
+        if ( distSymbol < 0 || distSymbol >= 30 )
+        { return false; }
+
+        const size_t distance = DIST_BASE[distSymbol] + reader.GetBits( DIST_EXTRA[distSymbol] );
+        if ( distance > pos || length > dstSize - pos )
+        { return false; }
+
+        unsigned char*       pOut = pDst + pos;
+        const unsigned char* pRef = pOut - distance;
+
+        // 重ならない場合は8バイト単位で，重なる場合は1バイトずつ複写する.
+        if ( distance >= 8 && dstSize - pos >= length + 8 )
+        {
+            size_t i = 0;
+            for( ; i<length; i+=8 )
+            { memcpy( pOut + i, pRef + i, 8 ); }
+        }
+        else if ( distance == 1 )
+        {
+            memset( pOut, *pRef, length );
+        }
+        else
+        {
+            for( size_t i=0; i<length; ++i )
+            { pOut[i] = pRef[i]; }
+        }
+
+        pos += length;
+    }
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------
+//      Adler-32 チェックサムを計算します.
+//-------------------------------------------------------------------------------------------
+unsigned int ComputeAdler32( const void* pData, size_t size, unsigned int adler )
+{
+    const unsigned char* p = static_cast<const unsigned char*>( pData );
+    unsigned int a = adler & 0xffff;
+    unsigned int b = adler >> 16;
+
+    while( size > 0 )
+    {
+        const size_t n = ( size < ADLER_NMAX ) ? size : ADLER_NMAX;
+        size -= n;
+
+        for( size_t i=0; i<n; ++i )
+        {
+            a += p[i];
+            b += a;
+        }
+        p += n;
+
+        a %= ADLER_BASE;
+        b %= ADLER_BASE;
+    }
+
+    return ( b << 16 ) | a;
+}
+
+//-------------------------------------------------------------------------------------------
+//      CRC-32 を計算します.
+//-------------------------------------------------------------------------------------------
+unsigned int ComputeCrc32( const void* pData, size_t size, unsigned int crc )
+{
+    static unsigned int   table[256];
+    static std::once_flag flag;
+
+    std::call_once( flag, []
+    {
+        for( unsigned int i=0; i<256; ++i )
+        {
+            unsigned int c = i;
+            for( int k=0; k<8; ++k )
+            { c = ( c & 1 ) ? ( 0xedb88320 ^ ( c >> 1 ) ) : ( c >> 1 ); }
+            table[i] = c;
+        }
+    });
+
+    const unsigned char* p = static_cast<const unsigned char*>( pData );
+    crc = ~crc;
+    for( size_t i=0; i<size; ++i )
+    { crc = table[( crc ^ p[i] ) & 0xff] ^ ( crc >> 8 ); }
+
+    return ~crc;
+}
+
+//-------------------------------------------------------------------------------------------
+//      Deflate のストリームを展開します.
+//-------------------------------------------------------------------------------------------
+bool Inflate
+(
+    const unsigned char*    pSrc,
+    size_t                  srcSize,
+    unsigned char*          pDst,
+    size_t                  dstSize,
+    size_t*                 pDstWritten
+)
+{
+    if ( pSrc == nullptr || ( pDst == nullptr && dstSize > 0 ) )
+    { return false; }
+
+    BitReader reader;
+    reader.pCur    = pSrc;
+    reader.pEnd    = pSrc + srcSize;
+    reader.bits    = 0;
+    reader.count   = 0;
+    reader.overrun = 0;
+
+    Huffman lit;
+    Huffman dist;
+    size_t  pos     = 0;
+    bool    isFinal = false;
+
+    do
+    {
+        isFinal = ( reader.GetBits( 1 ) != 0 );
+        const unsigned int type = reader.GetBits( 2 );
+
+        if ( type == 0 )
+        {
+            // 非圧縮ブロック. バイト境界に揃え，先読みしたバイトを戻してから直接複写する.
+            reader.GetBits( reader.count & 7 );
+            const int buffered = reader.count / 8 - reader.overrun;
+            if ( buffered < 0 )
+            { return false; }
+
+            reader.pCur   -= buffered;
+            reader.bits    = 0;
+            reader.count   = 0;
+            reader.overrun = 0;
+
+            if ( reader.pEnd - reader.pCur < 4 )
+            { return false; }
+
+            const unsigned int len  = reader.pCur[0] | ( reader.pCur[1] << 8 );
+            const unsigned int nlen = reader.pCur[2] | ( reader.pCur[3] << 8 );
+            reader.pCur += 4;
+
+            if ( ( len ^ 0xffff ) != nlen
+              || len > dstSize - pos
+              || len > size_t( reader.pEnd - reader.pCur ) )
+            { return false; }
+
+            memcpy( pDst + pos, reader.pCur, len );
+            reader.pCur += len;
+            pos         += len;
+        }
+        else if ( type == 1 )
+        {
+            BuildFixedHuffman( lit, dist );
+            if ( !InflateBlock( reader, lit, dist, pDst, dstSize, pos ) )
+            { return false; }
+        }
+        else if ( type == 2 )
+        {
+            if ( !ReadDynamicHuffman( reader, lit, dist ) )
+            { return false; }
+
+            if ( !InflateBlock( reader, lit, dist, pDst, dstSize, pos ) )
+            { return false; }
+        }
+        else
+        {
+            return false;
+        }
+
+        // 実データを越えて補填したビットまで消費していたら不正なストリーム.
+        if ( reader.overrun * 8 > reader.count )
+        { return false; }
+    }
+    while( !isFinal );
+
+    if ( pDstWritten != nullptr )
+    { *pDstWritten = pos; }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      zlib 形式のストリームを展開します.
+//-------------------------------------------------------------------------------------------
+bool InflateZlib
+(
+    const unsigned char*    pSrc,
+    size_t                  srcSize,
+    unsigned char*          pDst,
+    size_t                  dstSize,
+    size_t*                 pDstWritten
+)
+{
+    if ( pSrc == nullptr || srcSize < 6 )
+    { return false; }
+
+    const unsigned int cmf = pSrc[0];
+    const unsigned int flg = pSrc[1];
+
+    // 圧縮方式 8 (deflate)，窓サイズ 32KB 以下，プリセット辞書なしのみ対応.
+    if ( ( cmf & 0x0f ) != 8
+      || ( cmf >> 4 ) > 7
+      || ( ( cmf << 8 ) | flg ) % 31 != 0
+      || ( flg & 0x20 ) != 0 )
+    { return false; }
+
+    size_t written = 0;
+    if ( !Inflate( pSrc + 2, srcSize - 6, pDst, dstSize, &written ) )
+    { return false; }
+
+    const unsigned char* pTail = pSrc + srcSize - 4;
+    const unsigned int expected = ( static_cast<unsigned int>( pTail[0] ) << 24 )
+                                | ( static_cast<unsigned int>( pTail[1] ) << 16 )
+                                | ( static_cast<unsigned int>( pTail[2] ) << 8 )
+                                | ( static_cast<unsigned int>( pTail[3] ) );
+    if ( ComputeAdler32( pDst, written ) != expected )
+    { return false; }
+
+    if ( pDstWritten != nullptr )
+    { *pDstWritten = written; }
+
+    return true;
+}
@@ -0,0 +1,1029 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : PngLoader.cpp
+// Desc : Portable Network Graphics Texture Loader.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <PngLoader.h>
+#include <Inflate.h>
+#include <MappedFile.h>
+#include <MipMapGenerator.h>
+#include <TextureCache.h>
+#include <ColorSpace.h>
+#include <GL/glut.h>
+
+#ifndef GL_SRGB8
+#define GL_SRGB8            0x8C41
+#endif//GL_SRGB8
+
+#ifndef GL_SRGB8_ALPHA8
+#define GL_SRGB8_ALPHA8     0x8C43
+#endif//GL_SRGB8_ALPHA8
+
+#if defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 ) || defined(__SSE2__)
+    #define PNG_ENABLE_SSE2     1
+    #include <emmintrin.h>
+#else
+    #define PNG_ENABLE_SSE2     0
+#endif
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+const unsigned char PNG_SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+const unsigned int  CHUNK_IHDR  = 0x49484452;   // "IHDR"
+const unsigned int  CHUNK_PLTE  = 0x504c5445;   // "PLTE"
+const unsigned int  CHUNK_TRNS  = 0x74524e53;   // "tRNS"
+const unsigned int  CHUNK_IDAT  = 0x49444154;   // "IDAT"
+const unsigned int  CHUNK_IEND  = 0x49454e44;   // "IEND"
+const unsigned int  CHUNK_SRGB  = 0x73524742;   // "sRGB"
+const unsigned int  CHUNK_GAMA  = 0x67414d41;   // "gAMA"
+
+const unsigned int  GAMMA_LINEAR    = 100000;   // gAMAチャンクの値(100000倍)で 1.0.
+const unsigned int  GAMMA_SRGB      = 45455;    // gAMAチャンクの値(100000倍)で 1/2.2.
+
+const unsigned char COLOR_TYPE_GRAY         = 0;
+const unsigned char COLOR_TYPE_RGB          = 2;
+const unsigned char COLOR_TYPE_PALETTE      = 3;
+const unsigned char COLOR_TYPE_GRAY_ALPHA   = 4;
+const unsigned char COLOR_TYPE_RGB_ALPHA    = 6;
+
+const unsigned char FILTER_NONE     = 0;
+const unsigned char FILTER_SUB      = 1;
+const unsigned char FILTER_UP       = 2;
+const unsigned char FILTER_AVERAGE  = 3;
+const unsigned char FILTER_PAETH    = 4;
+
+// Adam7 の各パスの開始位置と間隔.
+const unsigned int  ADAM7_X0[7] = { 0, 4, 0, 2, 0, 1, 0 };
+const unsigned int  ADAM7_Y0[7] = { 0, 0, 4, 0, 2, 0, 1 };
+const unsigned int  ADAM7_DX[7] = { 8, 8, 4, 4, 2, 2, 1 };
+const unsigned int  ADAM7_DY[7] = { 8, 8, 8, 4, 4, 2, 2 };
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// PngInfo structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct PngInfo
+{
+    unsigned int    width;              //!< 横幅です.
+    unsigned int    height;             //!< 縦幅です.
+    unsigned char   bitDepth;           //!< サンプルあたりのビット数です.
+    unsigned char   colorType;          //!< カラータイプです.
+    unsigned char   interlace;          //!< インターレース方式です.
+    unsigned int    channels;           //!< ピクセルあたりのサンプル数です.
+    unsigned int    bitsPerPixel;       //!< ピクセルあたりのビット数です.
+    unsigned int    filterStride;       //!< フィルタで参照する左隣ピクセルまでのバイト数です.
+    unsigned int    paletteCount;       //!< パレットの要素数です.
+    unsigned char   palette[256][4];    //!< パレット(RGBA)です.
+    bool            hasTransparent;     //!< 透過色を持つかどうかのフラグです.
+    unsigned short  transparent[3];     //!< 透過色(グレースケールまたはRGB)です.
+};
+
+
+//-------------------------------------------------------------------------------------------
+//      ビッグエンディアンの32bit値を読み込みます.
+//-------------------------------------------------------------------------------------------
+inline unsigned int ReadBE32( const unsigned char* p )
+{
+    return ( static_cast<unsigned int>( p[0] ) << 24 )
+         | ( static_cast<unsigned int>( p[1] ) << 16 )
+         | ( static_cast<unsigned int>( p[2] ) << 8 )
+         | ( static_cast<unsigned int>( p[3] ) );
+}
+
+//-------------------------------------------------------------------------------------------
+//      ビッグエンディアンの16bit値を読み込みます.
+//-------------------------------------------------------------------------------------------
+inline unsigned short ReadBE16( const unsigned char* p )
+{ return static_cast<unsigned short>( ( p[0] << 8 ) | p[1] ); }
+
+//-------------------------------------------------------------------------------------------
+//      パース予測子を計算します.
+//-------------------------------------------------------------------------------------------
+inline unsigned char PaethPredictor( int a, int b, int c )
+{
+    const int p  = a + b - c;
+    const int pa = ( p > a ) ? p - a : a - p;
+    const int pb = ( p > b ) ? p - b : b - p;
+    const int pc = ( p > c ) ? p - c : c - p;
+
+    if ( pa <= pb && pa <= pc )
+    { return static_cast<unsigned char>( a ); }
+    if ( pb <= pc )
+    { return static_cast<unsigned char>( b ); }
+    return static_cast<unsigned char>( c );
+}
+
+#if PNG_ENABLE_SSE2
+//-------------------------------------------------------------------------------------------
+//      3バイトまたは4バイトを読み込みます.
+//-------------------------------------------------------------------------------------------
+template<int N>
+inline __m128i LoadPixel( const unsigned char* p )
+{
+    int value = 0;
+    memcpy( &value, p, N );
+    return _mm_cvtsi32_si128( value );
+}
+
+//-------------------------------------------------------------------------------------------
+//      3バイトまたは4バイトを書き込みます.
+//-------------------------------------------------------------------------------------------
+template<int N>
+inline void StorePixel( unsigned char* p, __m128i v )
+{
+    const int value = _mm_cvtsi128_si32( v );
+    memcpy( p, &value, N );
+}
+
+//-------------------------------------------------------------------------------------------
+//      16bit整数の絶対値を求めます.
+//-------------------------------------------------------------------------------------------
+inline __m128i Abs16( __m128i v )
+{ return _mm_max_epi16( v, _mm_sub_epi16( _mm_setzero_si128(), v ) ); }
+
+//-------------------------------------------------------------------------------------------
+//      マスクに従って選択します.
+//-------------------------------------------------------------------------------------------
+inline __m128i Select( __m128i mask, __m128i a, __m128i b )
+{ return _mm_or_si128( _mm_and_si128( mask, a ), _mm_andnot_si128( mask, b ) ); }
+
+//-------------------------------------------------------------------------------------------
+//      Sub フィルタを解除します(3, 4バイト/ピクセル).
+//-------------------------------------------------------------------------------------------
+template<int N>
+void UnfilterSubSSE2( unsigned char* pRow, size_t rowSize )
+{
+    __m128i a = _mm_setzero_si128();
+    for( size_t i=0; i<rowSize; i+=N )
+    {
+        a = _mm_add_epi8( LoadPixel<N>( pRow + i ), a );
+        StorePixel<N>( pRow + i, a );
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      Average フィルタを解除します(3, 4バイト/ピクセル).
+//-------------------------------------------------------------------------------------------
+template<int N>
+void UnfilterAverageSSE2( unsigned char* pRow, const unsigned char* pPrev, size_t rowSize )
+{
+    const __m128i one = _mm_set1_epi8( 1 );
+    __m128i a = _mm_setzero_si128();
+    for( size_t i=0; i<rowSize; i+=N )
+    {
+        const __m128i b = LoadPixel<N>( pPrev + i );
+
+        // _mm_avg_epu8 は切り上げなので，奇数和の場合は1引いて切り捨てにする.
+        __m128i avg = _mm_avg_epu8( a, b );
+        avg = _mm_sub_epi8( avg, _mm_and_si128( _mm_xor_si128( a, b ), one ) );
+
+        a = _mm_add_epi8( LoadPixel<N>( pRow + i ), avg );
+        StorePixel<N>( pRow + i, a );
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      Paeth フィルタを解除します(3, 4バイト/ピクセル).
+//-------------------------------------------------------------------------------------------
+template<int N>
+void UnfilterPaethSSE2( unsigned char* pRow, const unsigned char* pPrev, size_t rowSize )
+{
+    // 16bitに拡張して予測子を各成分並列に計算する.
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = zero;
+    __m128i c = zero;
+    for( size_t i=0; i<rowSize; i+=N )
+    {
+        const __m128i b = _mm_unpacklo_epi8( LoadPixel<N>( pPrev + i ), zero );
+        __m128i       x = _mm_unpacklo_epi8( LoadPixel<N>( pRow  + i ), zero );
+
+        const __m128i pa0 = _mm_sub_epi16( b, c );
+        const __m128i pb0 = _mm_sub_epi16( a, c );
+        const __m128i pa  = Abs16( pa0 );
+        const __m128i pb  = Abs16( pb0 );
+        const __m128i pc  = Abs16( _mm_add_epi16( pa0, pb0 ) );
+
+        const __m128i smallest = _mm_min_epi16( pc, _mm_min_epi16( pa, pb ) );
+
+        // 同値の場合は a, b, c の順に優先する.
+        const __m128i nearest = Select( _mm_cmpeq_epi16( smallest, pa ), a,
+                                Select( _mm_cmpeq_epi16( smallest, pb ), b, c ) );
+
+        x = _mm_add_epi8( x, nearest );
+        StorePixel<N>( pRow + i, _mm_packus_epi16( x, x ) );
+
+        c = b;
+        a = x;
+    }
+}
+#endif//PNG_ENABLE_SSE2
+
+//-------------------------------------------------------------------------------------------
+//      1行のフィルタを解除します.
+//-------------------------------------------------------------------------------------------
+bool UnfilterRow
+(
+    unsigned char           filter,
+    unsigned char*          pRow,
+    const unsigned char*    pPrev,
+    size_t                  rowSize,
+    unsigned int            stride
+)
+{
+    switch( filter )
+    {
+    case FILTER_NONE:
+        break;
+
+    case FILTER_SUB:
+        {
+        #if PNG_ENABLE_SSE2
+            if ( stride == 3 ) { UnfilterSubSSE2<3>( pRow, rowSize ); break; }
+            if ( stride == 4 ) { UnfilterSubSSE2<4>( pRow, rowSize ); break; }
+        #endif
+            for( size_t i=stride; i<rowSize; ++i )
+            { pRow[i] = static_cast<unsigned char>( pRow[i] + pRow[i - stride] ); }
+        }
+        break;
+
+    case FILTER_UP:
+        {
+            size_t i = 0;
+        #if PNG_ENABLE_SSE2
+            for( ; i + 16 <= rowSize; i += 16 )
+            {
+                const __m128i x = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pRow  + i ) );
+                const __m128i b = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pPrev + i ) );
+                _mm_storeu_si128( reinterpret_cast<__m128i*>( pRow + i ), _mm_add_epi8( x, b ) );
+            }
+        #endif
+            for( ; i<rowSize; ++i )
+            { pRow[i] = static_cast<unsigned char>( pRow[i] + pPrev[i] ); }
+        }
+        break;
+
+    case FILTER_AVERAGE:
+        {
+        #if PNG_ENABLE_SSE2
+            if ( stride == 3 ) { UnfilterAverageSSE2<3>( pRow, pPrev, rowSize ); break; }
+            if ( stride == 4 ) { UnfilterAverageSSE2<4>( pRow, pPrev, rowSize ); break; }
+        #endif
+            for( size_t i=0; i<stride && i<rowSize; ++i )
+            { pRow[i] = static_cast<unsigned char>( pRow[i] + ( pPrev[i] >> 1 ) ); }
+            for( size_t i=stride; i<rowSize; ++i )
+            { pRow[i] = static_cast<unsigned char>( pRow[i] + ( ( pRow[i - stride] + pPrev[i] ) >> 1 ) ); }
+        }
+        break;
+
+    case FILTER_PAETH:
+        {
+        #if PNG_ENABLE_SSE2
+            if ( stride == 3 ) { UnfilterPaethSSE2<3>( pRow, pPrev, rowSize ); break; }
+            if ( stride == 4 ) { UnfilterPaethSSE2<4>( pRow, pPrev, rowSize ); break; }
+        #endif
+            for( size_t i=0; i<stride && i<rowSize; ++i )
+            { pRow[i] = static_cast<unsigned char>( pRow[i] + pPrev[i] ); }
+            for( size_t i=stride; i<rowSize; ++i )
+            { pRow[i] = static_cast<unsigned char>( pRow[i] + PaethPredictor( pRow[i - stride], pPrev[i], pPrev[i - stride] ) ); }
+        }
+        break;
+
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      指定番号のサンプルを取得します.
+//-------------------------------------------------------------------------------------------
+inline unsigned int GetSample( const unsigned char* pRow, size_t index, unsigned int bitDepth )
+{
+    if ( bitDepth == 8 )
+    { return pRow[index]; }
+
+    if ( bitDepth == 16 )
+    { return ReadBE16( pRow + index * 2 ); }
+
+    const size_t       bitPos = index * bitDepth;
+    const unsigned int shift  = 8 - bitDepth - static_cast<unsigned int>( bitPos & 7 );
+    return ( pRow[bitPos >> 3] >> shift ) & ( ( 1u << bitDepth ) - 1 );
+}
+
+//-------------------------------------------------------------------------------------------
+//      サンプルを8bitに変換します.
+//-------------------------------------------------------------------------------------------
+inline unsigned char ToByte( unsigned int value, unsigned int bitDepth )
+{
+    switch( bitDepth )
+    {
+    case 1:  return static_cast<unsigned char>( value * 255 );
+    case 2:  return static_cast<unsigned char>( value * 85 );
+    case 4:  return static_cast<unsigned char>( value * 17 );
+    case 16: return static_cast<unsigned char>( value >> 8 );
+    default: return static_cast<unsigned char>( value );
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      フィルタ解除済みの1行を RGB(A)8 に展開します.
+//-------------------------------------------------------------------------------------------
+void ExpandRow
+(
+    const PngInfo&          info,
+    const unsigned char*    pRow,
+    unsigned int            width,
+    unsigned char*          pDst,
+    unsigned int            dstChannels
+)
+{
+    const unsigned int depth = info.bitDepth;
+
+    // よく使われる8bitの形式は直接複写する.
+    if ( depth == 8 && !info.hasTransparent )
+    {
+        if ( info.colorType == COLOR_TYPE_RGB || info.colorType == COLOR_TYPE_RGB_ALPHA )
+        {
+            memcpy( pDst, pRow, size_t( width ) * dstChannels );
+            return;
+        }
+    }
+
+    for( unsigned int x=0; x<width; ++x )
+    {
+        unsigned char* pOut = pDst + size_t( x ) * dstChannels;
+        unsigned char  alpha = 255;
+
+        switch( info.colorType )
+        {
+        case COLOR_TYPE_GRAY:
+            {
+                const unsigned int g = GetSample( pRow, x, depth );
+                pOut[0] = pOut[1] = pOut[2] = ToByte( g, depth );
+                if ( info.hasTransparent && g == info.transparent[0] )
+                { alpha = 0; }
+            }
+            break;
+
+        case COLOR_TYPE_RGB:
+            {
+                const unsigned int r = GetSample( pRow, size_t( x ) * 3 + 0, depth );
+                const unsigned int g = GetSample( pRow, size_t( x ) * 3 + 1, depth );
+                const unsigned int b = GetSample( pRow, size_t( x ) * 3 + 2, depth );
+                pOut[0] = ToByte( r, depth );
+                pOut[1] = ToByte( g, depth );
+                pOut[2] = ToByte( b, depth );
+                if ( info.hasTransparent
+                  && r == info.transparent[0]
+                  && g == info.transparent[1]
+                  && b == info.transparent[2] )
+                { alpha = 0; }
+            }
+            break;
+
+        case COLOR_TYPE_PALETTE:
+            {
+                // 範囲外の番号は黒として扱う.
+                const unsigned int index = GetSample( pRow, x, depth );
+                if ( index < info.paletteCount )
+                {
+                    pOut[0] = info.palette[index][0];
+                    pOut[1] = info.palette[index][1];
+                    pOut[2] = info.palette[index][2];
+                    alpha   = info.palette[index][3];
+                }
+                else
+                {
+                    pOut[0] = pOut[1] = pOut[2] = 0;
+                }
+            }
+            break;
+
+        case COLOR_TYPE_GRAY_ALPHA:
+            {
+                pOut[0] = pOut[1] = pOut[2] = ToByte( GetSample( pRow, size_t( x ) * 2 + 0, depth ), depth );
+                alpha = ToByte( GetSample( pRow, size_t( x ) * 2 + 1, depth ), depth );
+            }
+            break;
+
+        case COLOR_TYPE_RGB_ALPHA:
+            {
+                pOut[0] = ToByte( GetSample( pRow, size_t( x ) * 4 + 0, depth ), depth );
+                pOut[1] = ToByte( GetSample( pRow, size_t( x ) * 4 + 1, depth ), depth );
+                pOut[2] = ToByte( GetSample( pRow, size_t( x ) * 4 + 2, depth ), depth );
+                alpha   = ToByte( GetSample( pRow, size_t( x ) * 4 + 3, depth ), depth );
+            }
+            break;
+        }
+
+        if ( dstChannels == 4 )
+        { pOut[3] = alpha; }
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      IHDR チャンクを解析します.
+//-------------------------------------------------------------------------------------------
+bool ParseHeader( const unsigned char* pData, unsigned int length, PngInfo& info )
+{
+    if ( length != 13 )
+    { return false; }
+
+    info.width     = ReadBE32( pData + 0 );
+    info.height    = ReadBE32( pData + 4 );
+    info.bitDepth  = pData[8];
+    info.colorType = pData[9];
+    info.interlace = pData[12];
+
+    // 圧縮方式とフィルタ方式は 0 のみ定義されている.
+    if ( info.width == 0 || info.height == 0
+      || info.width > 0x7fffffff || info.height > 0x7fffffff
+      || pData[10] != 0 || pData[11] != 0 || info.interlace > 1 )
+    { return false; }
+
+    const unsigned int depth = info.bitDepth;
+    switch( info.colorType )
+    {
+    case COLOR_TYPE_GRAY:
+        if ( depth != 1 && depth != 2 && depth != 4 && depth != 8 && depth != 16 ) { return false; }
+        info.channels = 1;
+        break;
+
+    case COLOR_TYPE_RGB:
+        if ( depth != 8 && depth != 16 ) { return false; }
+        info.channels = 3;
+        break;
+
+    case COLOR_TYPE_PALETTE:
+        if ( depth != 1 && depth != 2 && depth != 4 && depth != 8 ) { return false; }
+        info.channels = 1;
+        break;
+
+    case COLOR_TYPE_GRAY_ALPHA:
+        if ( depth != 8 && depth != 16 ) { return false; }
+        info.channels = 2;
+        break;
+
+    case COLOR_TYPE_RGB_ALPHA:
+        if ( depth != 8 && depth != 16 ) { return false; }
+        info.channels = 4;
+        break;
+
+    default:
+        return false;
+    }
+
+    info.bitsPerPixel = info.channels * depth;
+    info.filterStride = ( info.bitsPerPixel + 7 ) / 8;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      指定幅の1行のバイト数を取得します(フィルタ番号を除く).
+//-------------------------------------------------------------------------------------------
+inline unsigned long long GetRowSize( const PngInfo& info, unsigned int width )
+{ return ( static_cast<unsigned long long>( width ) * info.bitsPerPixel + 7 ) / 8; }
+
+//-------------------------------------------------------------------------------------------
+//      色空間に応じた内部フォーマットを取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int GetInternalFormat( unsigned int format, COLOR_SPACE colorSpace )
+{
+    if ( colorSpace != COLOR_SPACE_SRGB )
+    { return format; }
+
+    return ( format == GL_RGBA ) ? GL_SRGB8_ALPHA8 : GL_SRGB8;
+}
+
+//-------------------------------------------------------------------------------------------
+//      sRGBの内部フォーマットかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsSRGBInternalFormat( unsigned int internalFormat )
+{ return ( internalFormat == GL_SRGB8 ) || ( internalFormat == GL_SRGB8_ALPHA8 ); }
+
+//-------------------------------------------------------------------------------------------
+//      sRGBテクスチャに対応しているかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsSupportSRGBTexture()
+{
+    // GL 2.1 以降はコア機能.
+    const char* pVersion = reinterpret_cast<const char*>( glGetString( GL_VERSION ) );
+    if ( pVersion != nullptr )
+    {
+        const char* pDot  = strchr( pVersion, '.' );
+        const int   major = atoi( pVersion );
+        const int   minor = ( pDot != nullptr ) ? atoi( pDot + 1 ) : 0;
+        if ( major > 2 || ( major == 2 && minor >= 1 ) )
+        { return true; }
+    }
+
+    const char* pExtensions = reinterpret_cast<const char*>( glGetString( GL_EXTENSIONS ) );
+    return ( pExtensions != nullptr ) && ( strstr( pExtensions, "GL_EXT_texture_sRGB" ) != nullptr );
+}
+
+} // namespace /* anonymous */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// PngImage class
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------
+PngImage::PngImage()
+: m_ImageSize       ( 0 )
+, m_Format          ( 0 )
+, m_InternalFormat  ( 0 )
+, m_Width           ( 0 )
+, m_Height          ( 0 )
+, m_BytePerPixel    ( 0 )
+, m_ID              ( 0 )
+, m_pImageData      ( nullptr )
+, m_ColorSpace      ( COLOR_SPACE_SRGB )
+, m_ColorSpaceHint  ( COLOR_SPACE_SRGB )
+{ /* DO_NOTHING */ }
+
+
+//-------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------
+PngImage::~PngImage()
+{ Release(); }
+
+//-------------------------------------------------------------------------------------------
+//      解放処理を行います.
+//-------------------------------------------------------------------------------------------
+void PngImage::Release()
+{
+    if ( m_pImageData )
+    {
+        delete[] m_pImageData;
+        m_pImageData = nullptr;
+    }
+
+    m_Cache.Close();
+
+    m_ImageSize      = 0;
+    m_Format         = 0;
+    m_InternalFormat = 0;
+    m_Width          = 0;
+    m_Height         = 0;
+    m_BytePerPixel   = 0;
+    m_ColorSpace     = m_ColorSpaceHint;
+}
+
+//-------------------------------------------------------------------------------------------
+//      読み込み処理を行います.
+//-------------------------------------------------------------------------------------------
+bool PngImage::Load( const char* filename )
+{
+    // 線形として扱う場合はミップマップの内容が変わるので，キャッシュを区別する.
+    const unsigned long long salt = ( m_ColorSpaceHint == COLOR_SPACE_LINEAR ) ? TextureCache::SALT_LINEAR : 0;
+
+    // 変換済みのキャッシュがあれば復号とミップ生成をすべて省略する.
+    if ( m_Cache.Open( filename, salt ) )
+    {
+        m_Width          = m_Cache.GetWidth();
+        m_Height         = m_Cache.GetHeight();
+        m_BytePerPixel   = m_Cache.GetBytePerPixel();
+        m_Format         = m_Cache.GetFormat();
+        m_InternalFormat = m_Cache.GetInternalFormat();
+        m_ColorSpace     = IsSRGBInternalFormat( m_InternalFormat ) ? COLOR_SPACE_SRGB : COLOR_SPACE_LINEAR;
+        m_ImageSize      = m_Cache.GetLevel( 0 ).size;
+        return true;
+    }
+
+    MappedFile file;
+    if ( !file.Open( filename ) )
+    {
+        std::cerr << "Error : File Open Failed.";
+        std::cerr << "File Name : " << filename << std::endl;
+        return false;
+    }
+
+    const unsigned char* pData = file.GetData();
+    const size_t         size  = file.GetSize();
+
+    // シグニチャチェック.
+    if ( size < sizeof(PNG_SIGNATURE) || memcmp( pData, PNG_SIGNATURE, sizeof(PNG_SIGNATURE) ) != 0 )
+    {
+        std::cerr << "Error : Invalid File.";
+        std::cerr << "File Name : " << filename << std::endl;
+        return false;
+    }
+
+    PngInfo info;
+    memset( &info, 0, sizeof(info) );
+
+    bool         hasHeader = false;
+    bool         hasEnd    = false;
+    bool         hasSRGB   = false;
+    unsigned int gamma     = 0;
+    std::vector<unsigned char> compressed;
+
+    // チャンクを順に読み取る. IDAT は連結して1つのzlibストリームとして扱う.
+    size_t offset = sizeof(PNG_SIGNATURE);
+    while( !hasEnd )
+    {
+        if ( size - offset < 12 )
+        {
+            std::cerr << "Error : Unexpected End Of File." << std::endl;
+            return false;
+        }
+
+        const unsigned char* pChunk = pData + offset;
+        const unsigned int   length = ReadBE32( pChunk );
+        const unsigned int   type   = ReadBE32( pChunk + 4 );
+        if ( length > size - offset - 12 )
+        {
+            std::cerr << "Error : Invalid Chunk Length." << std::endl;
+            return false;
+        }
+
+        const unsigned char* pBody = pChunk + 8;
+        if ( ComputeCrc32( pChunk + 4, length + 4 ) != ReadBE32( pBody + length ) )
+        {
+            std::cerr << "Error : Chunk CRC Mismatch." << std::endl;
+            return false;
+        }
+
+        if ( type != CHUNK_IHDR && !hasHeader )
+        {
+            std::cerr << "Error : IHDR Not Found." << std::endl;
+            return false;
+        }
+
+        switch( type )
+        {
+        case CHUNK_IHDR:
+            {
+                if ( hasHeader || !ParseHeader( pBody, length, info ) )
+                {
+                    std::cerr << "Error : Invalid IHDR." << std::endl;
+                    return false;
+                }
+                hasHeader = true;
+
+                for( int i=0; i<256; ++i )
+                { info.palette[i][3] = 255; }
+            }
+            break;
+
+        case CHUNK_PLTE:
+            {
+                if ( length % 3 != 0 || length / 3 > 256 || length == 0 )
+                {
+                    std::cerr << "Error : Invalid PLTE." << std::endl;
+                    return false;
+                }
+
+                info.paletteCount = length / 3;
+                for( unsigned int i=0; i<info.paletteCount; ++i )
+                {
+                    info.palette[i][0] = pBody[i * 3 + 0];
+                    info.palette[i][1] = pBody[i * 3 + 1];
+                    info.palette[i][2] = pBody[i * 3 + 2];
+                }
+            }
+            break;
+
+        case CHUNK_TRNS:
+            {
+                if ( info.colorType == COLOR_TYPE_PALETTE )
+                {
+                    if ( length > 256 )
+                    {
+                        std::cerr << "Error : Invalid tRNS." << std::endl;
+                        return false;
+                    }
+                    for( unsigned int i=0; i<length; ++i )
+                    { info.palette[i][3] = pBody[i]; }
+                    info.hasTransparent = true;
+                }
+                else if ( info.colorType == COLOR_TYPE_GRAY && length == 2 )
+                {
+                    info.transparent[0] = ReadBE16( pBody );
+                    info.hasTransparent = true;
+                }
+                else if ( info.colorType == COLOR_TYPE_RGB && length == 6 )
+                {
+                    info.transparent[0] = ReadBE16( pBody + 0 );
+                    info.transparent[1] = ReadBE16( pBody + 2 );
+                    info.transparent[2] = ReadBE16( pBody + 4 );
+                    info.hasTransparent = true;
+                }
+            }
+            break;
+
+        case CHUNK_IDAT:
+            { compressed.insert( compressed.end(), pBody, pBody + length ); }
+            break;
+
+        case CHUNK_SRGB:
+            { hasSRGB = true; }
+            break;
+
+        case CHUNK_GAMA:
+            {
+                if ( length == 4 )
+                { gamma = ReadBE32( pBody ); }
+            }
+            break;
+
+        case CHUNK_IEND:
+            { hasEnd = true; }
+            break;
+
+        default:
+            {
+                // 補助チャンク(先頭文字が小文字)以外は読み飛ばせない.
+                if ( ( pChunk[4] & 0x20 ) == 0 )
+                {
+                    std::cerr << "Error : Unsupported Critical Chunk." << std::endl;
+                    return false;
+                }
+            }
+            break;
+        }
+
+        offset += size_t( length ) + 12;
+    }
+
+    if ( compressed.empty() || ( info.colorType == COLOR_TYPE_PALETTE && info.paletteCount == 0 ) )
+    {
+        std::cerr << "Error : Image Data Not Found." << std::endl;
+        return false;
+    }
+
+    // sRGBチャンクを優先し，gAMAチャンクが 1/2.2 ならsRGB，1.0 なら線形として扱う.
+    // どちらも無い場合やその他のガンマ値は指定された色空間とする.
+    COLOR_SPACE colorSpace = m_ColorSpaceHint;
+    if ( hasSRGB || gamma == GAMMA_SRGB )
+    { colorSpace = COLOR_SPACE_SRGB; }
+    else if ( gamma == GAMMA_LINEAR )
+    { colorSpace = COLOR_SPACE_LINEAR; }
+
+    // 展開後のサイズ(各行の先頭にフィルタ番号が付く).
+    unsigned int passCount = ( info.interlace != 0 ) ? 7 : 1;
+    unsigned long long rawSize = 0;
+    for( unsigned int pass=0; pass<passCount; ++pass )
+    {
+        const unsigned int x0 = ( info.interlace ) ? ADAM7_X0[pass] : 0;
+        const unsigned int y0 = ( info.interlace ) ? ADAM7_Y0[pass] : 0;
+        const unsigned int dx = ( info.interlace ) ? ADAM7_DX[pass] : 1;
+        const unsigned int dy = ( info.interlace ) ? ADAM7_DY[pass] : 1;
+        if ( info.width <= x0 || info.height <= y0 )
+        { continue; }
+
+        const unsigned int passW = ( info.width  - x0 + dx - 1 ) / dx;
+        const unsigned int passH = ( info.height - y0 + dy - 1 ) / dy;
+        rawSize += ( GetRowSize( info, passW ) + 1 ) * passH;
+    }
+
+    const unsigned int channels = ( info.colorType == COLOR_TYPE_GRAY_ALPHA
+                                 || info.colorType == COLOR_TYPE_RGB_ALPHA
+                                 || info.hasTransparent ) ? 4 : 3;
+    const unsigned long long imageSize = static_cast<unsigned long long>( info.width ) * info.height * channels;
+
+    if ( rawSize > static_cast<unsigned long long>( size_t( -1 ) ) || imageSize > 0xffffffff )
+    {
+        std::cerr << "Error : Image Too Large." << std::endl;
+        return false;
+    }
+
+    std::vector<unsigned char> raw;
+    raw.resize( size_t( rawSize ) );
+    if ( !InflateZlib( &compressed[0], compressed.size(), &raw[0], raw.size() ) )
+    {
+        std::cerr << "Error : Inflate Failed." << std::endl;
+        return false;
+    }
+
+    m_pImageData = new(std::nothrow) unsigned char [size_t( imageSize )];
+    if ( m_pImageData == nullptr )
+    {
+        std::cerr << "Error : Memory Allocate Failed." << std::endl;
+        return false;
+    }
+
+    std::vector<unsigned char> zeroRow( size_t( GetRowSize( info, info.width ) ) + 1, 0 );
+    std::vector<unsigned char> passRow( ( info.interlace ) ? size_t( info.width ) * channels : 0 );
+
+    size_t rawOffset = 0;
+    for( unsigned int pass=0; pass<passCount; ++pass )
+    {
+        const unsigned int x0 = ( info.interlace ) ? ADAM7_X0[pass] : 0;
+        const unsigned int y0 = ( info.interlace ) ? ADAM7_Y0[pass] : 0;
+        const unsigned int dx = ( info.interlace ) ? ADAM7_DX[pass] : 1;
+        const unsigned int dy = ( info.interlace ) ? ADAM7_DY[pass] : 1;
+        if ( info.width <= x0 || info.height <= y0 )
+        { continue; }
+
+        const unsigned int passW   = ( info.width  - x0 + dx - 1 ) / dx;
+        const unsigned int passH   = ( info.height - y0 + dy - 1 ) / dy;
+        const size_t       rowSize = size_t( GetRowSize( info, passW ) );
+
+        // 前の行は展開先のバッファ上でフィルタ解除済みのものを参照する.
+        const unsigned char* pPrev = &zeroRow[1];
+        for( unsigned int y=0; y<passH; ++y )
+        {
+            unsigned char* pRow = &raw[rawOffset];
+            if ( !UnfilterRow( pRow[0], pRow + 1, pPrev, rowSize, info.filterStride ) )
+            {
+                std::cerr << "Error : Invalid Filter Type." << std::endl;
+                Release();
+                return false;
+            }
+
+            const unsigned int dstY = y0 + y * dy;
+            if ( info.interlace )
+            {
+                ExpandRow( info, pRow + 1, passW, &passRow[0], channels );
+                for( unsigned int x=0; x<passW; ++x )
+                {
+                    memcpy( m_pImageData + ( size_t( dstY ) * info.width + x0 + x * dx ) * channels,
+                            &passRow[size_t( x ) * channels],
+                            channels );
+                }
+            }
+            else
+            {
+                ExpandRow( info, pRow + 1, passW, m_pImageData + size_t( dstY ) * info.width * channels, channels );
+            }
+
+            pPrev      = pRow + 1;
+            rawOffset += rowSize + 1;
+        }
+    }
+
+    // データを設定.
+    m_Width          = info.width;
+    m_Height         = info.height;
+    m_BytePerPixel   = channels;
+    m_ImageSize      = static_cast<unsigned int>( imageSize );
+    m_Format         = ( channels == 4 ) ? GL_RGBA : GL_RGB;
+    m_ColorSpace     = colorSpace;
+    m_InternalFormat = GetInternalFormat( m_Format, m_ColorSpace );
+
+    // 正常終了.
+    return true;
+}
+//-------------------------------------------------------------------------------------------
+//      テクスチャを生成します.
+//-------------------------------------------------------------------------------------------
+bool PngImage::CreateGLTexture()
+{
+    if ( m_pImageData == nullptr && !m_Cache.IsValid() )
+    { return false; }
+
+    //　テクスチャを生成
+    glGenTextures(1, &m_ID);
+
+    //　テクスチャをバインドする
+    glBindTexture(GL_TEXTURE_2D, m_ID);
+
+    // sRGBテクスチャに非対応の環境では変換せずにそのまま転送する.
+    const unsigned int internalFormat = ( IsSRGBInternalFormat( m_InternalFormat ) && !IsSupportSRGBTexture() )
+        ? m_Format
+        : m_InternalFormat;
+
+    if ( m_BytePerPixel == 4 )
+    { glPixelStorei(GL_UNPACK_ALIGNMENT, 4); }
+    else 
+    { glPixelStorei(GL_UNPACK_ALIGNMENT, 1); }
+
+    if ( m_Cache.IsValid() )
+    {
+        //　キャッシュからマップしたまま転送する.
+        for( unsigned int i=0; i<m_Cache.GetMipCount(); ++i )
+        {
+            const TextureCache::Level& level = m_Cache.GetLevel( i );
+            glTexImage2D(
+                GL_TEXTURE_2D,
+                int(i),
+                internalFormat,
+                level.width,
+                level.height,
+                0,
+                m_Format,
+                GL_UNSIGNED_BYTE,
+                m_Cache.GetLevelData( i ) );
+        }
+    }
+    else
+    {
+        //　ミップマップチェインをCPUで生成する(非2の累乗サイズもリスケールしない).
+        //　sRGBの画像は線形空間に変換してから縮小する.
+        MipMapOption option;
+        option.isSRGB = ( m_ColorSpace == COLOR_SPACE_SRGB );
+
+        std::vector<MipLevel> levels;
+        if ( !GenerateMipMaps( m_pImageData, m_Width, m_Height, m_BytePerPixel, option, levels ) )
+        {
+            std::cerr << "Error : Generate MipMaps Failed." << std::endl;
+            glBindTexture( GL_TEXTURE_2D, 0 );
+            DeleteGLTexture();
+            return false;
+        }
+
+        //　テクスチャの割り当て
+        for( size_t i=0; i<levels.size(); ++i )
+        {
+            glTexImage2D(
+                GL_TEXTURE_2D,
+                int(i),
+                internalFormat,
+                levels[i].width,
+                levels[i].height,
+                0,
+                m_Format,
+                GL_UNSIGNED_BYTE,
+                &levels[i].pixels[0] );
+        }
+
+        // 次回の起動で復号とミップ生成を省略できるよう保存しておく.
+        m_Cache.Save( m_Format, m_InternalFormat, m_BytePerPixel, levels );
+    }
+
+    //　テクスチャを拡大・縮小する方法の指定
+    glTexParameteri(GL_TEXTURE_2D, 	GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, 	GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+
+    //　テクスチャ環境
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+
+    // アンバインドしておく.
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      テクスチャを破棄します.
+//-------------------------------------------------------------------------------------------
+void PngImage::DeleteGLTexture()
+{
+    if ( m_ID )
+    {
+        glDeleteTextures( 1, &m_ID );
+        m_ID = 0;
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      テクスチャIDを取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int PngImage::GetID() const
+{ return m_ID; }
+
+//-------------------------------------------------------------------------------------------
+//      画像の横幅を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int PngImage::GetWidth() const
+{ return m_Width; }
+
+//-------------------------------------------------------------------------------------------
+//      画像の縦幅を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int PngImage::GetHeight() const
+{ return m_Height; }
+
+//-------------------------------------------------------------------------------------------
+//      1ピクセルあたりのバイト数を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int PngImage::GetBytePerPixel() const
+{ return m_BytePerPixel; }
+
+//-------------------------------------------------------------------------------------------
+//      ピクセルデータを取得します.
+//-------------------------------------------------------------------------------------------
+const unsigned char* PngImage::GetPixels() const
+{ return ( m_pImageData != nullptr ) ? m_pImageData : m_Cache.GetLevelData( 0 ); }
+
+//-------------------------------------------------------------------------------------------
+//      色空間の情報を持たない画像に適用する色空間を設定します.
+//-------------------------------------------------------------------------------------------
+void PngImage::SetColorSpaceHint( COLOR_SPACE colorSpace )
+{ m_ColorSpaceHint = colorSpace; }
+
+//-------------------------------------------------------------------------------------------
+//      読み込んだ画像の色空間を取得します.
+//-------------------------------------------------------------------------------------------
+COLOR_SPACE PngImage::GetColorSpace() const
+{ return m_ColorSpace; }
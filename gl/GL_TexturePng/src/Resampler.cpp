@@ -0,0 +1,480 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : Resampler.cpp
+// Desc : Separable Image Resampler.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <Resampler.h>
+#include <ColorSpace.h>
+#include <ParallelRows.h>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+#if defined(__AVX__)
+    #define RESAMPLE_ENABLE_AVX     1
+    #define RESAMPLE_ENABLE_SSE     1
+    #include <immintrin.h>
+#elif defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 1 ) || defined(__SSE__)
+    #define RESAMPLE_ENABLE_AVX     0
+    #define RESAMPLE_ENABLE_SSE     1
+    #include <xmmintrin.h>
+#else
+    #define RESAMPLE_ENABLE_AVX     0
+    #define RESAMPLE_ENABLE_SSE     0
+#endif
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+static const float          PI                  = 3.14159265358979323846f;
+static const unsigned int   MIN_ROWS_PER_THREAD = 32;       // スレッド1つあたりの最小行数.
+
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// FilterTable structure
+////////////////////////////////////////////////////////////////////////////////////////////
+struct FilterTable
+{
+    unsigned int        taps;           // 1出力あたりのタップ数.
+    std::vector<int>    start;          // 参照する入力の先頭位置 (出力数). 窓は常に画像内に収まる.
+    std::vector<float>  weight;         // 正規化済みの重み (出力数 * taps).
+    std::vector<float>  weight4;        // 重みを4つずつ複製したもの (出力数 * taps * 4).
+};
+
+
+//-------------------------------------------------------------------------------------------
+//      sinc関数です.
+//-------------------------------------------------------------------------------------------
+inline float Sinc( float x )
+{
+    if ( fabsf( x ) < 1e-5f )
+    { return 1.0f; }
+
+    x *= PI;
+    return sinf( x ) / x;
+}
+
+//-------------------------------------------------------------------------------------------
+//      フィルタの半径を取得します.
+//-------------------------------------------------------------------------------------------
+float GetFilterWidth( RESAMPLE_FILTER filter )
+{
+    switch( filter )
+    {
+    case RESAMPLE_FILTER_BILINEAR:  return 1.0f;
+    case RESAMPLE_FILTER_BICUBIC:   return 2.0f;
+    case RESAMPLE_FILTER_LANCZOS3:  return 3.0f;
+    default:                        break;
+    }
+
+    return 0.5f;
+}
+
+//-------------------------------------------------------------------------------------------
+//      フィルタカーネルを評価します.
+//-------------------------------------------------------------------------------------------
+float EvaluateFilter( RESAMPLE_FILTER filter, float x )
+{
+    x = fabsf( x );
+
+    switch( filter )
+    {
+    case RESAMPLE_FILTER_BILINEAR:
+        { return ( x < 1.0f ) ? 1.0f - x : 0.0f; }
+
+    case RESAMPLE_FILTER_BICUBIC:
+        {
+            const float a = -0.5f;
+            if ( x < 1.0f )
+            { return ( ( a + 2.0f ) * x - ( a + 3.0f ) ) * x * x + 1.0f; }
+            if ( x < 2.0f )
+            { return ( ( a * x - 5.0f * a ) * x + 8.0f * a ) * x - 4.0f * a; }
+            return 0.0f;
+        }
+
+    case RESAMPLE_FILTER_LANCZOS3:
+        {
+            if ( x >= 3.0f )
+            { return 0.0f; }
+
+            return Sinc( x ) * Sinc( x / 3.0f );
+        }
+
+    default:
+        break;
+    }
+
+    return ( x <= 0.5f ) ? 1.0f : 0.0f;
+}
+
+//-------------------------------------------------------------------------------------------
+//      1次元のフィルタテーブルを構築します.
+//-------------------------------------------------------------------------------------------
+void BuildFilterTable( unsigned int srcSize, unsigned int dstSize, RESAMPLE_FILTER filter, FilterTable& table )
+{
+    // 縮小時はカーネルを縮小率に合わせて引き伸ばし，拡大時は元のまま使う.
+    const float scale       = float( srcSize ) / float( dstSize );
+    const float filterScale = std::max( scale, 1.0f );
+    const float support     = GetFilterWidth( filter ) * filterScale;
+
+    unsigned int taps = static_cast<unsigned int>( ceilf( support * 2.0f ) ) + 1;
+    if ( taps > srcSize )
+    { taps = srcSize; }
+
+    table.taps = taps;
+    table.start  .assign( dstSize, 0 );
+    table.weight .assign( size_t( dstSize ) * taps, 0.0f );
+    table.weight4.assign( size_t( dstSize ) * taps * 4, 0.0f );
+
+    for( unsigned int d=0; d<dstSize; ++d )
+    {
+        const float center = ( d + 0.5f ) * scale;
+        const int   left   = static_cast<int>( floorf( center - support ) );
+        const int   right  = static_cast<int>( ceilf ( center + support ) );
+
+        // 窓を画像内に収め，はみ出した分の重みは端のタップに畳み込む(クランプ).
+        const int first = std::min( std::max( left, 0 ), int( srcSize - taps ) );
+
+        float* pWeight = &table.weight[ size_t( d ) * taps ];
+        float  total   = 0.0f;
+
+        for( int s=left; s<=right; ++s )
+        {
+            float w;
+            if ( filter == RESAMPLE_FILTER_BOX )
+            {
+                // ボックスは出力ピクセルと入力ピクセルの重なり面積を重みとする.
+                const float lo = std::max( center - filterScale * 0.5f, float( s ) );
+                const float hi = std::min( center + filterScale * 0.5f, float( s + 1 ) );
+                w = std::max( hi - lo, 0.0f );
+            }
+            else
+            { w = EvaluateFilter( filter, ( s + 0.5f - center ) / filterScale ); }
+
+            if ( w == 0.0f )
+            { continue; }
+
+            const int i = std::min( std::max( s, 0 ), int( srcSize ) - 1 ) - first;
+            if ( i < 0 || i >= int( taps ) )
+            { continue; }
+
+            pWeight[ i ] += w;
+            total += w;
+        }
+
+        if ( total != 0.0f )
+        {
+            const float invTotal = 1.0f / total;
+            for( unsigned int t=0; t<taps; ++t )
+            { pWeight[ t ] *= invTotal; }
+        }
+
+        table.start[ d ] = first;
+
+        float* pWeight4 = &table.weight4[ size_t( d ) * taps * 4 ];
+        for( unsigned int t=0; t<taps; ++t )
+        { pWeight4[ t * 4 + 0 ] = pWeight4[ t * 4 + 1 ] = pWeight4[ t * 4 + 2 ] = pWeight4[ t * 4 + 3 ] = pWeight[ t ]; }
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      1行分を float4 に変換します.
+//-------------------------------------------------------------------------------------------
+void ConvertRowToFloat
+(
+    const void*     pSrc,
+    unsigned int    width,
+    RESAMPLE_FORMAT format,
+    bool            isSRGB,
+    float*          pDst
+)
+{
+    switch( format )
+    {
+    case RESAMPLE_FORMAT_RGB8:
+    case RESAMPLE_FORMAT_RGBA8:
+        {
+            ConvertToLinearFloat4(
+                static_cast<const unsigned char*>( pSrc ),
+                width,
+                ( format == RESAMPLE_FORMAT_RGBA8 ) ? 4 : 3,
+                ( isSRGB ) ? COLOR_SPACE_SRGB : COLOR_SPACE_LINEAR,
+                pDst );
+        }
+        break;
+
+    case RESAMPLE_FORMAT_RGB32F:
+        {
+            const float* pFloats = static_cast<const float*>( pSrc );
+            for( unsigned int x=0; x<width; ++x )
+            {
+                float* pOut = pDst + size_t( x ) * 4;
+                pOut[ 0 ] = pFloats[ x * 3 + 0 ];
+                pOut[ 1 ] = pFloats[ x * 3 + 1 ];
+                pOut[ 2 ] = pFloats[ x * 3 + 2 ];
+                pOut[ 3 ] = 1.0f;
+            }
+        }
+        break;
+
+    case RESAMPLE_FORMAT_RGBA32F:
+        { memcpy( pDst, pSrc, size_t( width ) * 4 * sizeof(float) ); }
+        break;
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      float4 の1行分を出力フォーマットに変換します.
+//-------------------------------------------------------------------------------------------
+void ConvertRowFromFloat
+(
+    const float*    pSrc,
+    unsigned int    width,
+    RESAMPLE_FORMAT format,
+    bool            isSRGB,
+    void*           pDst
+)
+{
+    switch( format )
+    {
+    case RESAMPLE_FORMAT_RGB8:
+    case RESAMPLE_FORMAT_RGBA8:
+        {
+            // 負のローブによるはみ出しは変換時にクランプされる.
+            ConvertFromLinearFloat4(
+                pSrc,
+                width,
+                ( format == RESAMPLE_FORMAT_RGBA8 ) ? 4 : 3,
+                ( isSRGB ) ? COLOR_SPACE_SRGB : COLOR_SPACE_LINEAR,
+                1.0f,
+                static_cast<unsigned char*>( pDst ) );
+        }
+        break;
+
+    case RESAMPLE_FORMAT_RGB32F:
+        {
+            float* pFloats = static_cast<float*>( pDst );
+            for( unsigned int x=0; x<width; ++x )
+            {
+                pFloats[ x * 3 + 0 ] = pSrc[ x * 4 + 0 ];
+                pFloats[ x * 3 + 1 ] = pSrc[ x * 4 + 1 ];
+                pFloats[ x * 3 + 2 ] = pSrc[ x * 4 + 2 ];
+            }
+        }
+        break;
+
+    case RESAMPLE_FORMAT_RGBA32F:
+        { memcpy( pDst, pSrc, size_t( width ) * 4 * sizeof(float) ); }
+        break;
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      横方向にフィルタします. 1ピクセルは float4 です.
+//-------------------------------------------------------------------------------------------
+void FilterRowHorizontal
+(
+    const float*        pSrcRow,
+    float*              pDstRow,
+    unsigned int        dstWidth,
+    const FilterTable&  table
+)
+{
+    const unsigned int taps = table.taps;
+
+    for( unsigned int x=0; x<dstWidth; ++x )
+    {
+        // 窓は連続しているので，入力と重みを先頭から順に読めばよい.
+        const float* pTexel  = pSrcRow + size_t( table.start[ x ] ) * 4;
+        const float* pWeight = &table.weight4[ size_t( x ) * taps * 4 ];
+        unsigned int t = 0;
+
+    #if RESAMPLE_ENABLE_AVX
+        // 2タップ(2ピクセル)ずつ積和し，最後に上下を足し合わせる.
+        __m256 sum8 = _mm256_setzero_ps();
+        for( ; t + 2 <= taps; t += 2 )
+        { sum8 = _mm256_add_ps( sum8, _mm256_mul_ps( _mm256_loadu_ps( pTexel + t * 4 ), _mm256_loadu_ps( pWeight + t * 4 ) ) ); }
+        __m128 sum = _mm_add_ps( _mm256_castps256_ps128( sum8 ), _mm256_extractf128_ps( sum8, 1 ) );
+    #elif RESAMPLE_ENABLE_SSE
+        __m128 sum = _mm_setzero_ps();
+    #endif
+
+    #if RESAMPLE_ENABLE_SSE
+        for( ; t<taps; ++t )
+        { sum = _mm_add_ps( sum, _mm_mul_ps( _mm_loadu_ps( pTexel + t * 4 ), _mm_loadu_ps( pWeight + t * 4 ) ) ); }
+        _mm_storeu_ps( pDstRow + x * 4, sum );
+    #else
+        float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for( ; t<taps; ++t )
+        {
+            for( int c=0; c<4; ++c )
+            { sum[ c ] += pTexel[ t * 4 + c ] * pWeight[ t * 4 + c ]; }
+        }
+        memcpy( pDstRow + x * 4, sum, sizeof(sum) );
+    #endif
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      縦方向にフィルタします. 行全体をまとめて積和します.
+//-------------------------------------------------------------------------------------------
+void FilterRowVertical
+(
+    const float*        pSrc,
+    float*              pDstRow,
+    unsigned int        width,
+    unsigned int        y,
+    const FilterTable&  table
+)
+{
+    const size_t  rowFloats = size_t( width ) * 4;
+    const float*  pWeight   = &table.weight[ size_t( y ) * table.taps ];
+    const float*  pSrcRow   = pSrc + size_t( table.start[ y ] ) * rowFloats;
+
+    memset( pDstRow, 0, rowFloats * sizeof(float) );
+
+    for( unsigned int t=0; t<table.taps; ++t, pSrcRow += rowFloats )
+    {
+        if ( pWeight[ t ] == 0.0f )
+        { continue; }
+
+        size_t i = 0;
+
+    #if RESAMPLE_ENABLE_AVX
+        const __m256 w8 = _mm256_set1_ps( pWeight[ t ] );
+        for( ; i + 8 <= rowFloats; i += 8 )
+        {
+            const __m256 acc = _mm256_loadu_ps( pDstRow + i );
+            _mm256_storeu_ps( pDstRow + i, _mm256_add_ps( acc, _mm256_mul_ps( _mm256_loadu_ps( pSrcRow + i ), w8 ) ) );
+        }
+    #endif
+
+    #if RESAMPLE_ENABLE_SSE
+        // 1ピクセルが float4 なので行は常に4の倍数.
+        const __m128 w = _mm_set1_ps( pWeight[ t ] );
+        for( ; i<rowFloats; i+=4 )
+        {
+            const __m128 acc = _mm_loadu_ps( pDstRow + i );
+            _mm_storeu_ps( pDstRow + i, _mm_add_ps( acc, _mm_mul_ps( _mm_loadu_ps( pSrcRow + i ), w ) ) );
+        }
+    #else
+        const float w = pWeight[ t ];
+        for( ; i<rowFloats; ++i )
+        { pDstRow[ i ] += pSrcRow[ i ] * w; }
+    #endif
+    }
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------
+//      1ピクセルあたりのバイト数を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int GetResampleBytePerPixel( RESAMPLE_FORMAT format )
+{
+    switch( format )
+    {
+    case RESAMPLE_FORMAT_RGB8:      return 3;
+    case RESAMPLE_FORMAT_RGBA8:     return 4;
+    case RESAMPLE_FORMAT_RGB32F:    return 12;
+    case RESAMPLE_FORMAT_RGBA32F:   return 16;
+    }
+
+    return 0;
+}
+
+//-------------------------------------------------------------------------------------------
+//      画像を任意のサイズに拡大・縮小します.
+//-------------------------------------------------------------------------------------------
+bool ResampleImage
+(
+    const void*             pSrc,
+    unsigned int            srcWidth,
+    unsigned int            srcHeight,
+    RESAMPLE_FORMAT         format,
+    void*                   pDst,
+    unsigned int            dstWidth,
+    unsigned int            dstHeight,
+    const ResampleOption&   option
+)
+{
+    const unsigned int bytePerPixel = GetResampleBytePerPixel( format );
+    if ( pSrc == nullptr || pDst == nullptr || bytePerPixel == 0 )
+    { return false; }
+
+    if ( srcWidth == 0 || srcHeight == 0 || dstWidth == 0 || dstHeight == 0 )
+    { return false; }
+
+    // 中間バッファ(出力の横幅 * 入力の縦幅 の float4)がアドレス空間に収まるか確認する.
+    const unsigned long long tempBytes = static_cast<unsigned long long>( dstWidth ) * srcHeight * 4 * sizeof(float);
+    if ( tempBytes > size_t( -1 ) / 2 )
+    { return false; }
+
+    // 同じサイズならフィルタは恒等変換なのでコピーするだけ.
+    if ( srcWidth == dstWidth && srcHeight == dstHeight )
+    {
+        memcpy( pDst, pSrc, size_t( srcWidth ) * srcHeight * bytePerPixel );
+        return true;
+    }
+
+    const bool isSRGB = option.isSRGB && ( format == RESAMPLE_FORMAT_RGB8 || format == RESAMPLE_FORMAT_RGBA8 );
+
+    FilterTable tableX;
+    FilterTable tableY;
+    BuildFilterTable( srcWidth,  dstWidth,  option.filter, tableX );
+    BuildFilterTable( srcHeight, dstHeight, option.filter, tableY );
+
+    const unsigned char* pSrcBytes = static_cast<const unsigned char*>( pSrc );
+    unsigned char*       pDstBytes = static_cast<unsigned char*>( pDst );
+    const size_t         srcPitch  = size_t( srcWidth ) * bytePerPixel;
+    const size_t         dstPitch  = size_t( dstWidth ) * bytePerPixel;
+
+    // 横方向: 入力行を float4 に変換しながら出力幅に縮める. 変換用の行バッファはスレッドごとに持つ.
+    std::vector<float> temp( size_t( dstWidth ) * srcHeight * 4 );
+    float* pTemp = &temp[0];
+
+    ParallelRows( srcHeight, MIN_ROWS_PER_THREAD, option.threadCount, [&]( unsigned int begin, unsigned int end )
+    {
+        std::vector<float> row( size_t( srcWidth ) * 4 );
+        for( unsigned int y=begin; y<end; ++y )
+        {
+            float* pTempRow = pTemp + size_t( y ) * dstWidth * 4;
+            if ( srcWidth == dstWidth )
+            {
+                ConvertRowToFloat( pSrcBytes + srcPitch * y, srcWidth, format, isSRGB, pTempRow );
+                continue;
+            }
+
+            ConvertRowToFloat( pSrcBytes + srcPitch * y, srcWidth, format, isSRGB, &row[0] );
+            FilterRowHorizontal( &row[0], pTempRow, dstWidth, tableX );
+        }
+    } );
+
+    // 縦方向: 出力行ごとに積和し，そのまま出力フォーマットに変換する.
+    ParallelRows( dstHeight, MIN_ROWS_PER_THREAD, option.threadCount, [&]( unsigned int begin, unsigned int end )
+    {
+        std::vector<float> row( size_t( dstWidth ) * 4 );
+        for( unsigned int y=begin; y<end; ++y )
+        {
+            const float* pRow = pTemp + size_t( y ) * dstWidth * 4;
+            if ( srcHeight != dstHeight )
+            {
+                FilterRowVertical( pTemp, &row[0], dstWidth, y, tableY );
+                pRow = &row[0];
+            }
+
+            ConvertRowFromFloat( pRow, dstWidth, format, isSRGB, pDstBytes + dstPitch * y );
+        }
+    } );
+
+    return true;
+}
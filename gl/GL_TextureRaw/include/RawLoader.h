@@ -7,6 +7,12 @@
 #ifndef _RAW_LOADER_H_
 #define _RAW_LOADER_H_
 
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <TextureCache.h>
+#include <ColorSpace.h>
+
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 //  RawImage class
@@ -74,6 +80,134 @@ public:
     //---------------------------------------------------------------------------------------
     unsigned int GetID() const;
 
+    //---------------------------------------------------------------------------------------
+    //! @brief      画像の横幅を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetWidth() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      画像の縦幅を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetHeight() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      1ピクセルあたりのバイト数を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetBytePerPixel() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      RGB(A)に変換済みのピクセルデータを取得します.
+    //!
+    //! @note       キャッシュから読み込んだ場合はマップされたキャッシュファイル上のデータを返却します.
+    //---------------------------------------------------------------------------------------
+    const unsigned char* GetPixels() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      色空間の情報を持たない画像をどの色空間として扱うかを設定します.
+    //!
+    //! @note       Load() の前に呼び出します. 既定値は COLOR_SPACE_SRGB です.
+    //!             sRGBの場合は線形空間でミップマップを生成し，sRGBの内部フォーマットで転送します.
+    //!             法線マップなどのデータテクスチャには COLOR_SPACE_LINEAR を指定します.
+    //---------------------------------------------------------------------------------------
+    void SetColorSpaceHint( COLOR_SPACE colorSpace );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      読み込んだ画像の色空間を取得します.
+    //---------------------------------------------------------------------------------------
+    COLOR_SPACE GetColorSpace() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      ファイル全体を読み込まずに領域読み込み用として開きます.
+    //!
+    //! @note       ピクセルは必要になった時点で位置指定読み込み(pread/ReadFile)で取得するため，
+    //!             アドレス空間に収まらない巨大な画像も扱えます.
+    //! @param [in]     filename        ファイル名です.
+    //! @param [in]     width           画像の横幅です.
+    //! @param [in]     height          画像の縦幅です.
+    //! @param [in]     alphaFlag       アルファ値を持つかどうかのフラグです.
+    //! @retval true    オープンに成功.
+    //! @retval false   オープンに失敗.
+    //---------------------------------------------------------------------------------------
+    bool OpenStream(
+        const char*         filename,
+        const unsigned int  width,
+        const unsigned int  height,
+        bool                alphaFlag = false );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      領域読み込み用に開いたファイルを閉じます.
+    //---------------------------------------------------------------------------------------
+    void CloseStream();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      領域読み込み用にファイルが開かれているかどうかチェックします.
+    //---------------------------------------------------------------------------------------
+    bool IsStreamOpen() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      指定領域のピクセルを読み込みます.
+    //!
+    //! @note       downsample が2以上の場合は downsample x downsample ピクセルの平均を
+    //!             1ピクセルとして出力します(右端・下端の端数ブロックは存在するピクセルのみで平均).
+    //!             作業メモリは downsample 行分のみで，領域全体は保持しません.
+    //! @param [in]     x               読み込み開始位置の横座標です.
+    //! @param [in]     y               読み込み開始位置の縦座標です.
+    //! @param [in]     width           読み込む横幅です(元画像のピクセル単位).
+    //! @param [in]     height          読み込む縦幅です(元画像のピクセル単位).
+    //! @param [out]    pDst            GetDownsampledSize( width, downsample ) *
+    //!                                 GetDownsampledSize( height, downsample ) * GetBytePerPixel()
+    //!                                 バイトの格納先です.
+    //! @param [in]     downsample      縮小率です. 1の場合は縮小しません.
+    //! @retval true    読み込みに成功.
+    //! @retval false   読み込みに失敗.
+    //---------------------------------------------------------------------------------------
+    bool ReadRegion(
+        unsigned int    x,
+        unsigned int    y,
+        unsigned int    width,
+        unsigned int    height,
+        unsigned char*  pDst,
+        unsigned int    downsample = 1 ) const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      指定領域を読み込み，テクスチャ生成用のピクセルデータとして保持します.
+    //!
+    //! @note       読み込み後の GetWidth(), GetHeight() は縮小後のサイズを返却します.
+    //!             プレビューや部分的なアップロードに使用します.
+    //! @param [in]     x               読み込み開始位置の横座標です.
+    //! @param [in]     y               読み込み開始位置の縦座標です.
+    //! @param [in]     width           読み込む横幅です(元画像のピクセル単位).
+    //! @param [in]     height          読み込む縦幅です(元画像のピクセル単位).
+    //! @param [in]     downsample      縮小率です. 1の場合は縮小しません.
+    //! @retval true    読み込みに成功.
+    //! @retval false   読み込みに失敗.
+    //---------------------------------------------------------------------------------------
+    bool LoadRegion(
+        unsigned int    x,
+        unsigned int    y,
+        unsigned int    width,
+        unsigned int    height,
+        unsigned int    downsample = 1 );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      領域読み込み用に開いた元画像の横幅を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetSourceWidth() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      領域読み込み用に開いた元画像の縦幅を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetSourceHeight() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      縮小後のサイズを取得します.
+    //!
+    //! @param [in]     size            元画像のピクセル単位のサイズです.
+    //! @param [in]     downsample      縮小率です.
+    //! @return     端数を切り上げた縮小後のサイズを返却します.
+    //---------------------------------------------------------------------------------------
+    static unsigned int GetDownsampledSize( unsigned int size, unsigned int downsample );
+
 protected:
     //=======================================================================================
     // protected variables.
@@ -86,11 +220,18 @@ protected:
     unsigned int    m_BytePerPixel;     //!< 1ピクセルあたりのバイト数です.
     unsigned int    m_ID;               //!< テクスチャIDです.
     unsigned char*  m_pImageData;       //!< ピクセルデータです.
+    TextureCache    m_Cache;            //!< 変換済みテクスチャのキャッシュです.
+    void*           m_hStream;          //!< 領域読み込み用のファイルハンドルです.
+    int             m_StreamDesc;       //!< 領域読み込み用のファイルディスクリプタです.
+    unsigned int    m_SourceWidth;      //!< 領域読み込み用に開いた元画像の横幅です.
+    unsigned int    m_SourceHeight;     //!< 領域読み込み用に開いた元画像の縦幅です.
+    COLOR_SPACE     m_ColorSpace;       //!< 読み込んだ画像の色空間です.
+    COLOR_SPACE     m_ColorSpaceHint;   //!< 色空間の情報を持たない画像に適用する色空間です.
 
     //=======================================================================================
     // protected methods.
     //=======================================================================================
-    /* NOTHING */
+    bool ReadAt( unsigned long long offset, void* pDst, size_t size ) const;
 
 private:
     //=======================================================================================
@@ -0,0 +1,144 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : RawTileIterator.h
+// Desc : Raw Texture Tile Iterator.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+#ifndef _RAW_TILE_ITERATOR_H_
+#define _RAW_TILE_ITERATOR_H_
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <vector>
+#include <RawLoader.h>
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// RawTileIterator class
+/////////////////////////////////////////////////////////////////////////////////////////////
+class RawTileIterator
+{
+    //=======================================================================================
+    // list of friend classes and methods.
+    //=======================================================================================
+    /* NOTHING */
+
+public:
+    //=======================================================================================
+    // public variables.
+    //=======================================================================================
+    /* NOTHING */
+
+    //=======================================================================================
+    // public methods.
+    //=======================================================================================
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //!
+    //! @note       タイルは左上から行優先で走査します. 保持するのは1タイル分のバッファのみなので，
+    //!             画像サイズに関わらず使用メモリは tileSize * tileSize * bpp 程度に収まります.
+    //! @param [in]     image           OpenStream() 済みの画像です.
+    //! @param [in]     tileSize        元画像のピクセル単位のタイルサイズです.
+    //!                                 縮小後のタイルが隙間なく並ぶよう downsample の倍数に切り上げます.
+    //! @param [in]     downsample      読み込み時の縮小率です.
+    //---------------------------------------------------------------------------------------
+    RawTileIterator( const RawImage& image, unsigned int tileSize, unsigned int downsample = 1 );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------
+    virtual ~RawTileIterator();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      次のタイルを読み込みます.
+    //!
+    //! @retval true    読み込みに成功.
+    //! @retval false   全タイルを走査し終えたか，読み込みに失敗.
+    //---------------------------------------------------------------------------------------
+    bool Next();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      走査を先頭に戻します.
+    //---------------------------------------------------------------------------------------
+    void Reset();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      読み込みに失敗したかどうかチェックします.
+    //---------------------------------------------------------------------------------------
+    bool IsFailed() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      現在のタイルの元画像上の横座標を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetX() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      現在のタイルの元画像上の縦座標を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetY() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      現在のタイルの縮小後の横幅を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetWidth() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      現在のタイルの縮小後の縦幅を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetHeight() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      現在のタイルの縮小後の出力先での横座標を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetDstX() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      現在のタイルの縮小後の出力先での縦座標を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetDstY() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      現在のタイルのピクセルデータを取得します.
+    //!
+    //! @note       次に Next() を呼び出すまで有効です.
+    //---------------------------------------------------------------------------------------
+    const unsigned char* GetPixels() const;
+
+protected:
+    //=======================================================================================
+    // protected variables.
+    //=======================================================================================
+    const RawImage&             m_Image;        //!< 読み込み元の画像です.
+    unsigned int                m_TileSize;     //!< 元画像のピクセル単位のタイルサイズです.
+    unsigned int                m_Downsample;   //!< 縮小率です.
+    unsigned int                m_NextX;        //!< 次のタイルの横座標です.
+    unsigned int                m_NextY;        //!< 次のタイルの縦座標です.
+    unsigned int                m_X;            //!< 現在のタイルの横座標です.
+    unsigned int                m_Y;            //!< 現在のタイルの縦座標です.
+    unsigned int                m_Width;        //!< 現在のタイルの縮小後の横幅です.
+    unsigned int                m_Height;       //!< 現在のタイルの縮小後の縦幅です.
+    bool                        m_Failed;       //!< 読み込みに失敗したかどうかのフラグです.
+    std::vector<unsigned char>  m_Buffer;       //!< 1タイル分のピクセルバッファです.
+
+    //=======================================================================================
+    // protected methods.
+    //=======================================================================================
+    /* NOTHING */
+
+private:
+    //=======================================================================================
+    // private variables.
+    //=======================================================================================
+    /* NOTHING */
+
+    //=======================================================================================
+    // private methods.
+    //=======================================================================================
+    RawTileIterator ( const RawTileIterator& value );   // アクセス禁止.
+    void operator = ( const RawTileIterator& value );   // アクセス禁止.
+};
+
+
+#endif//_RAW_TILE_ITERATOR_H_
@@ -0,0 +1,187 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : TextureCache.h
+// Desc : Content Hashed Decoded Texture Cache.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+#ifndef _TEXTURE_CACHE_H_
+#define _TEXTURE_CACHE_H_
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <vector>
+#include <MappedFile.h>
+#include <MipMapGenerator.h>
+
+
+//-------------------------------------------------------------------------------------------
+//! @brief      XXH64 ハッシュ値を計算します.
+//!
+//! @param [in]     pData       データです.
+//! @param [in]     size        データサイズです.
+//! @param [in]     seed        シード値です.
+//! @return     64bitハッシュ値を返却します.
+//-------------------------------------------------------------------------------------------
+unsigned long long ComputeHash64( const void* pData, size_t size, unsigned long long seed );
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// TextureCache class
+/////////////////////////////////////////////////////////////////////////////////////////////
+class TextureCache
+{
+    //=======================================================================================
+    // list of friend classes and methods.
+    //=======================================================================================
+    /* NOTHING */
+
+public:
+    /////////////////////////////////////////////////////////////////////////////////////////
+    // Level structure
+    /////////////////////////////////////////////////////////////////////////////////////////
+    struct Level
+    {
+        unsigned int    offset;         //!< ファイル先頭からのオフセットです.
+        unsigned int    size;           //!< データサイズです.
+        unsigned int    width;          //!< 横幅です.
+        unsigned int    height;         //!< 縦幅です.
+    };
+
+    //=======================================================================================
+    // public variables.
+    //=======================================================================================
+    static const unsigned long long SALT_LINEAR = 0x8000000000000000ull;   //!< 線形色空間としてミップを生成する場合にソルトへ加える値です.
+
+    //=======================================================================================
+    // public methods.
+    //=======================================================================================
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------
+    TextureCache();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------
+    virtual ~TextureCache();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      元画像の内容からハッシュを計算し，キャッシュを探します.
+    //!
+    //! @note       見つからなかった場合も計算したハッシュは保持され，Save() で使用されます.
+    //! @param [in]     sourceFilename  元画像のファイル名です.
+    //! @param [in]     salt            読み込みパラメータによって変換結果が変わる場合に指定する値です.
+    //! @retval true    キャッシュが見つかりマップされた.
+    //! @retval false   キャッシュが見つからない，または無効.
+    //---------------------------------------------------------------------------------------
+    bool Open( const char* sourceFilename, unsigned long long salt = 0 );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      変換済みのミップマップチェインをキャッシュに保存します.
+    //!
+    //! @param [in]     format          GLのピクセルフォーマットです.
+    //! @param [in]     internalFormat  GLの内部フォーマットです.
+    //! @param [in]     bytePerPixel    1ピクセルあたりのバイト数です.
+    //! @param [in]     levels          保存するミップレベルです.
+    //! @retval true    保存に成功.
+    //! @retval false   保存に失敗.
+    //---------------------------------------------------------------------------------------
+    bool Save(
+        unsigned int                    format,
+        unsigned int                    internalFormat,
+        unsigned int                    bytePerPixel,
+        const std::vector<MipLevel>&    levels );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      キャッシュを閉じます.
+    //---------------------------------------------------------------------------------------
+    void Close();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      有効なキャッシュがマップされているかどうかチェックします.
+    //---------------------------------------------------------------------------------------
+    bool IsValid() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      画像の横幅を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetWidth() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      画像の縦幅を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetHeight() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      1ピクセルあたりのバイト数を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetBytePerPixel() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      GLのピクセルフォーマットを取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetFormat() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      GLの内部フォーマットを取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetInternalFormat() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      ミップレベル数を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetMipCount() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      ミップレベルの情報を取得します.
+    //---------------------------------------------------------------------------------------
+    const Level& GetLevel( unsigned int index ) const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      ミップレベルのピクセルデータを取得します.
+    //!
+    //! @return     マップされたキャッシュファイル上のデータを返却します. コピーはされません.
+    //---------------------------------------------------------------------------------------
+    const unsigned char* GetLevelData( unsigned int index ) const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      キャッシュの保存先ディレクトリを設定します.
+    //!
+    //! @param [in]     path            ディレクトリパスです. 既定値は "../res/cache" です.
+    //---------------------------------------------------------------------------------------
+    static void SetDirectory( const char* path );
+
+protected:
+    struct Header;
+
+    //=======================================================================================
+    // protected variables.
+    //=======================================================================================
+    MappedFile              m_File;         //!< マップされたキャッシュファイルです.
+    unsigned long long      m_Hash;         //!< 元画像のハッシュ値です.
+    bool                    m_HasHash;      //!< ハッシュ値が有効かどうか.
+    const Header*           m_pHeader;      //!< マップされたヘッダです.
+    const Level*            m_pLevels;      //!< マップされたミップレベル情報です.
+
+    //=======================================================================================
+    // protected methods.
+    //=======================================================================================
+    /* NOTHING */
+
+private:
+    //=======================================================================================
+    // private variables.
+    //=======================================================================================
+    /* NOTHING */
+
+    //=======================================================================================
+    // private methods.
+    //=======================================================================================
+    TextureCache    ( const TextureCache& value );  // アクセス禁止.
+    void operator = ( const TextureCache& value );  // アクセス禁止.
+};
+
+
+#endif//_TEXTURE_CACHE_H_
@@ -0,0 +1,351 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : VirtualTexture.h
+// Desc : Virtual Texture Page Cache.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+#ifndef _VIRTUAL_TEXTURE_H_
+#define _VIRTUAL_TEXTURE_H_
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <RawLoader.h>
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// VirtualTextureDesc structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct VirtualTextureDesc
+{
+    unsigned int    width;              //!< 元画像の横幅です.
+    unsigned int    height;             //!< 元画像の縦幅です.
+    unsigned int    bytePerPixel;       //!< 1ピクセルあたりのバイト数です(3 または 4).
+    unsigned int    pageSize;           //!< ボーダーを除いたページの一辺のテクセル数です.
+    unsigned int    border;             //!< ページの四辺に付加するボーダーのテクセル数です.
+    unsigned int    physicalPagesX;     //!< 物理テクスチャの横方向のページ数です.
+    unsigned int    physicalPagesY;     //!< 物理テクスチャの縦方向のページ数です.
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //!
+    //! @note       既定値は pageSize + border * 2 = 128 となり，物理テクスチャが2の累乗になります.
+    //---------------------------------------------------------------------------------------
+    VirtualTextureDesc()
+    : width         ( 0 )
+    , height        ( 0 )
+    , bytePerPixel  ( 3 )
+    , pageSize      ( 120 )
+    , border        ( 4 )
+    , physicalPagesX( 16 )
+    , physicalPagesY( 16 )
+    { /* DO_NOTHING */ }
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// VirtualTextureStats structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct VirtualTextureStats
+{
+    unsigned long long  requestCount;   //!< 重複を除いたページ要求数です.
+    unsigned long long  hitCount;       //!< 要求時に常駐していたページ数です.
+    unsigned long long  missCount;      //!< 要求時に常駐していなかったページ数です.
+    unsigned long long  loadCount;      //!< 読み込んだページ数です.
+    unsigned long long  evictionCount;  //!< 追い出したページ数です.
+    unsigned long long  deferredCount;  //!< 空きページが無い，または読み込み上限により見送ったページ数です.
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------
+    VirtualTextureStats()
+    : requestCount  ( 0 )
+    , hitCount      ( 0 )
+    , missCount     ( 0 )
+    , loadCount     ( 0 )
+    , evictionCount ( 0 )
+    , deferredCount ( 0 )
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      ヒット率を取得します.
+    //---------------------------------------------------------------------------------------
+    double GetHitRate() const
+    { return ( requestCount > 0 ) ? double( hitCount ) / double( requestCount ) : 0.0; }
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// VirtualTextureFootprint structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct VirtualTextureFootprint
+{
+    float   minU;           //!< 可視領域のテクスチャ座標の最小値(U)です.
+    float   minV;           //!< 可視領域のテクスチャ座標の最小値(V)です.
+    float   maxU;           //!< 可視領域のテクスチャ座標の最大値(U)です.
+    float   maxV;           //!< 可視領域のテクスチャ座標の最大値(V)です.
+    float   pixelWidth;     //!< 可視領域が画面上で占める横幅(ピクセル)です.
+    float   pixelHeight;    //!< 可視領域が画面上で占める縦幅(ピクセル)です.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// VirtualTexture class
+/////////////////////////////////////////////////////////////////////////////////////////////
+class VirtualTexture
+{
+    //=======================================================================================
+    // list of friend classes and methods.
+    //=======================================================================================
+    /* NOTHING */
+
+public:
+    //=======================================================================================
+    // public variables.
+    //=======================================================================================
+    /* NOTHING */
+
+    //=======================================================================================
+    // public methods.
+    //=======================================================================================
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------
+    VirtualTexture();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------
+    virtual ~VirtualTexture();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      元画像をページに分割したページファイルを作成します.
+    //!
+    //! @note       ページファイルはボーダー込みのページを縦に並べたRAW画像で，
+    //!             ミップレベル0から順に各レベル内は行優先で格納します.
+    //!             各ミップレベルは元画像から直接ボックスフィルタで縮小し，
+    //!             作業メモリはページ1枚分と縮小に必要な行のみです.
+    //! @param [in]     source          OpenStream() 済みの元画像です.
+    //! @param [in]     pageFilename    出力するページファイル名です.
+    //! @param [in]     pageSize        ボーダーを除いたページの一辺のテクセル数です.
+    //! @param [in]     border          ボーダーのテクセル数です.
+    //! @retval true    作成に成功.
+    //! @retval false   作成に失敗.
+    //---------------------------------------------------------------------------------------
+    static bool BuildPageFile(
+        const RawImage& source,
+        const char*     pageFilename,
+        unsigned int    pageSize,
+        unsigned int    border );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @note       ページファイルを開かずにページ要求・常駐管理だけを動かすこともできます.
+    //!             その場合はページの中身を読み込まずに常駐扱いにします.
+    //! @param [in]     desc            構成設定です.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //---------------------------------------------------------------------------------------
+    bool Init( const VirtualTextureDesc& desc );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      BuildPageFile() で作成したページファイルを開きます.
+    //!
+    //! @param [in]     pageFilename    ページファイル名です.
+    //! @retval true    オープンに成功.
+    //! @retval false   オープンに失敗.
+    //---------------------------------------------------------------------------------------
+    bool OpenPageFile( const char* pageFilename );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //---------------------------------------------------------------------------------------
+    void Term();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      物理テクスチャと間接参照テクスチャを生成します.
+    //---------------------------------------------------------------------------------------
+    bool CreateGLTexture();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      物理テクスチャと間接参照テクスチャを破棄します.
+    //---------------------------------------------------------------------------------------
+    void DeleteGLTexture();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      フレームの開始処理です. 前フレームのページ要求を破棄します.
+    //---------------------------------------------------------------------------------------
+    void BeginFrame();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      ページを要求します.
+    //!
+    //! @param [in]     mipLevel        ミップレベルです.
+    //! @param [in]     pageX           ページの横方向の番号です.
+    //! @param [in]     pageY           ページの縦方向の番号です.
+    //---------------------------------------------------------------------------------------
+    void Request( unsigned int mipLevel, unsigned int pageX, unsigned int pageY );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      可視領域のフットプリントから必要なページを要求します.
+    //!
+    //! @param [in]     footprint       可視領域のフットプリントです.
+    //! @param [in]     mipBias         ミップレベルの選択に加えるバイアスです.
+    //! @return     選択したミップレベルを返却します.
+    //---------------------------------------------------------------------------------------
+    unsigned int RequestFootprint( const VirtualTextureFootprint& footprint, float mipBias = 0.0f );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      要求されたページを読み込み，間接参照テーブルを更新します.
+    //!
+    //! @note       粗いミップレベルから順に読み込み，未読み込みのページは常駐している
+    //!             最も近い親ページで代替されます.
+    //! @param [in]     maxLoadCount    1回の更新で読み込む最大ページ数です.
+    //! @return     読み込んだページ数を返却します.
+    //---------------------------------------------------------------------------------------
+    unsigned int Update( unsigned int maxLoadCount = 8 );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      ページが常駐しているかどうかチェックします.
+    //---------------------------------------------------------------------------------------
+    bool IsResident( unsigned int mipLevel, unsigned int pageX, unsigned int pageY ) const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      常駐しているページ数を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetResidentCount() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      ミップレベル数を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetMipCount() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      指定ミップレベルの横方向のページ数を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetPageCountX( unsigned int mipLevel ) const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      指定ミップレベルの縦方向のページ数を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetPageCountY( unsigned int mipLevel ) const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      指定ミップレベルの間接参照テーブルの一辺の要素数を取得します.
+    //!
+    //! @note       間接参照テーブルはミップレベル0のページ数を2の累乗に切り上げた正方形です.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetIndirectionSize( unsigned int mipLevel ) const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      指定ミップレベルの間接参照テーブルを取得します.
+    //!
+    //! @note       各要素はRGBA8で，物理ページの横番号，縦番号，実際に常駐しているミップレベル，255 です.
+    //---------------------------------------------------------------------------------------
+    const unsigned char* GetIndirection( unsigned int mipLevel ) const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      統計情報を取得します.
+    //---------------------------------------------------------------------------------------
+    const VirtualTextureStats& GetStats() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      統計情報をリセットします.
+    //---------------------------------------------------------------------------------------
+    void ResetStats();
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      物理テクスチャのIDを取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetPhysicalTextureID() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      間接参照テクスチャのIDを取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetIndirectionTextureID() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      GLの変換行列から四角形のフットプリントを計算します.
+    //!
+    //! @note       画面上で軸に沿って投影される四角形を想定し，ビューポートでクリップした範囲を
+    //!             テクスチャ座標へ線形に写像します. 視点の後ろに頂点がある場合は四角形全体を
+    //!             ビューポート全体の解像度で要求する保守的な結果を返却します.
+    //! @param [in]     pModelView      モデルビュー行列(列優先16要素)です.
+    //! @param [in]     pProjection     射影行列(列優先16要素)です.
+    //! @param [in]     viewportWidth   ビューポートの横幅です.
+    //! @param [in]     viewportHeight  ビューポートの縦幅です.
+    //! @param [in]     positions       四角形の頂点座標です.
+    //! @param [in]     texcoords       四角形のテクスチャ座標です.
+    //! @param [out]    result          フットプリントの格納先です.
+    //! @retval true    四角形が画面内に見えている.
+    //! @retval false   四角形が画面外にある.
+    //---------------------------------------------------------------------------------------
+    static bool ComputeFootprint(
+        const double*               pModelView,
+        const double*               pProjection,
+        int                         viewportWidth,
+        int                         viewportHeight,
+        const float                 positions[4][3],
+        const float                 texcoords[4][2],
+        VirtualTextureFootprint&    result );
+
+protected:
+    /////////////////////////////////////////////////////////////////////////////////////////
+    // Slot structure
+    /////////////////////////////////////////////////////////////////////////////////////////
+    struct Slot
+    {
+        unsigned long long                  pageId;     //!< 格納しているページのIDです.
+        unsigned int                        lastFrame;  //!< 最後に要求されたフレーム番号です.
+        bool                                used;       //!< ページを格納しているかどうかのフラグです.
+        std::list<unsigned int>::iterator   lruItr;     //!< LRUリスト上の位置です.
+    };
+
+    //=======================================================================================
+    // protected variables.
+    //=======================================================================================
+    VirtualTextureDesc                                      m_Desc;             //!< 構成設定です.
+    unsigned int                                            m_MipCount;         //!< ミップレベル数です.
+    unsigned int                                            m_IndirectionSize;  //!< ミップレベル0の間接参照テーブルの一辺の要素数です.
+    unsigned int                                            m_FrameIndex;       //!< フレーム番号です.
+    bool                                                    m_Dirty;            //!< 間接参照テーブルの更新が必要かどうかのフラグです.
+    RawImage                                                m_PageFile;         //!< ページファイルです.
+    std::vector<unsigned long long>                         m_PageBase;         //!< ミップレベルごとのページファイル上の先頭ページ番号です.
+    std::vector<std::vector<unsigned char>>                 m_Indirection;      //!< ミップレベルごとの間接参照テーブルです.
+    std::vector<Slot>                                       m_Slots;            //!< 物理ページです.
+    std::list<unsigned int>                                 m_LRU;              //!< 最近使われた順の物理ページ番号です(先頭が最新).
+    std::unordered_map<unsigned long long, unsigned int>    m_Resident;         //!< ページIDから物理ページ番号への対応表です.
+    std::unordered_set<unsigned long long>                  m_Requested;        //!< 現在のフレームで要求されたページIDです.
+    std::vector<unsigned long long>                         m_Pending;          //!< 読み込み待ちのページIDです.
+    std::vector<unsigned char>                              m_PageBuffer;       //!< ページ読み込み用のバッファです.
+    VirtualTextureStats                                     m_Stats;            //!< 統計情報です.
+    unsigned int                                            m_PhysicalID;       //!< 物理テクスチャのIDです.
+    unsigned int                                            m_IndirectionID;    //!< 間接参照テクスチャのIDです.
+
+    //=======================================================================================
+    // protected methods.
+    //=======================================================================================
+    bool LoadPage( unsigned long long pageId, unsigned int slot );
+    void UpdateIndirection();
+
+private:
+    //=======================================================================================
+    // private variables.
+    //=======================================================================================
+    /* NOTHING */
+
+    //=======================================================================================
+    // private methods.
+    //=======================================================================================
+    VirtualTexture  ( const VirtualTexture& value );    // アクセス禁止.
+    void operator = ( const VirtualTexture& value );    // アクセス禁止.
+};
+
+
+#endif//_VIRTUAL_TEXTURE_H_
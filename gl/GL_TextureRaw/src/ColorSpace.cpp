@@ -0,0 +1,463 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : ColorSpace.cpp
+// Desc : sRGB / Linear Color Space Conversion.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <ColorSpace.h>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <mutex>
+
+#if defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 ) || defined(__SSE2__)
+    #define COLOR_ENABLE_SSE2   1
+    #include <emmintrin.h>
+#else
+    #define COLOR_ENABLE_SSE2   0
+#endif
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+static const unsigned int   LINEAR_TO_SRGB_SIZE = 4096;                 // 線形 -> sRGB 変換テーブルのサイズ.
+static const float          SRGB_THRESHOLD      = 0.04045f;             // sRGB側の線形区間の上限.
+static const float          LINEAR_THRESHOLD    = 0.0031308f;           // 線形側の線形区間の上限.
+static const float          SQRT2               = 1.41421356237309505f;
+
+// log2(m) = 2/ln2 * ( t + t^3/3 + t^5/5 + ... ), t = (m - 1) / (m + 1) の係数.
+static const float          LOG2_C1             = 2.88539008177792681f;
+static const float          LOG2_C3             = 0.96179669392597560f;
+static const float          LOG2_C5             = 0.57707801635558536f;
+static const float          LOG2_C7             = 0.41219858311113240f;
+static const float          LOG2_C9             = 0.32059889797532520f;
+
+// 2^f = Σ (f * ln2)^n / n!, f は [-0.5, 0.5] の係数.
+static const float          EXP2_C1             = 0.693147180559945309f;
+static const float          EXP2_C2             = 0.240226506959100712f;
+static const float          EXP2_C3             = 0.055504108664821580f;
+static const float          EXP2_C4             = 0.009618129107628477f;
+static const float          EXP2_C5             = 0.001333355814642844f;
+static const float          EXP2_C6             = 0.000154035303933816f;
+static const float          EXP2_C7             = 0.000015252733804060f;
+
+
+//-------------------------------------------------------------------------------------------
+// Global Variables
+//-------------------------------------------------------------------------------------------
+float           g_SRGBToLinear[ 256 ];                  // sRGB -> 線形 変換テーブル.
+float           g_SRGBThreshold[ 256 ];                 // sRGB値 i と i+1 の境界となる線形値.
+unsigned char   g_LinearToSRGB[ LINEAR_TO_SRGB_SIZE ];  // 線形 -> sRGB 変換テーブル(近似値).
+std::once_flag  g_TableFlag;                            // テーブル初期化フラグ.
+
+
+//-------------------------------------------------------------------------------------------
+//      float のビット列を取得します.
+//-------------------------------------------------------------------------------------------
+inline int AsInt( float value )
+{
+    int result;
+    memcpy( &result, &value, sizeof(result) );
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------
+//      ビット列を float として解釈します.
+//-------------------------------------------------------------------------------------------
+inline float AsFloat( int value )
+{
+    float result;
+    memcpy( &result, &value, sizeof(result) );
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------
+//      正の値の log2 を求めます.
+//-------------------------------------------------------------------------------------------
+inline float FastLog2( float x )
+{
+    // 仮数を [sqrt(0.5), sqrt(2)) に寄せて級数の収束を速くする.
+    const int bits = AsInt( x );
+    float e = float( ( ( bits >> 23 ) & 0xff ) - 127 );
+    float m = AsFloat( ( bits & 0x007fffff ) | 0x3f800000 );
+    if ( m > SQRT2 )
+    {
+        m *= 0.5f;
+        e += 1.0f;
+    }
+
+    const float t  = ( m - 1.0f ) / ( m + 1.0f );
+    const float t2 = t * t;
+    return e + t * ( LOG2_C1 + t2 * ( LOG2_C3 + t2 * ( LOG2_C5 + t2 * ( LOG2_C7 + t2 * LOG2_C9 ) ) ) );
+}
+
+//-------------------------------------------------------------------------------------------
+//      2^y を求めます.
+//-------------------------------------------------------------------------------------------
+inline float FastExp2( float y )
+{
+    y = ( y < -126.0f ) ? -126.0f : ( ( y > 127.0f ) ? 127.0f : y );
+
+    const float i = floorf( y + 0.5f );
+    const float f = y - i;
+    const float p = 1.0f + f * ( EXP2_C1 + f * ( EXP2_C2 + f * ( EXP2_C3 + f * ( EXP2_C4
+                  + f * ( EXP2_C5 + f * ( EXP2_C6 + f * EXP2_C7 ) ) ) ) ) );
+    return p * AsFloat( ( int( i ) + 127 ) << 23 );
+}
+
+#if COLOR_ENABLE_SSE2
+//-------------------------------------------------------------------------------------------
+//      正の値の log2 を4要素まとめて求めます.
+//-------------------------------------------------------------------------------------------
+inline __m128 FastLog2( __m128 x )
+{
+    const __m128i bits  = _mm_castps_si128( x );
+    const __m128i exp   = _mm_sub_epi32( _mm_and_si128( _mm_srli_epi32( bits, 23 ), _mm_set1_epi32( 0xff ) ), _mm_set1_epi32( 127 ) );
+    const __m128  one   = _mm_set1_ps( 1.0f );
+
+    __m128 e = _mm_cvtepi32_ps( exp );
+    __m128 m = _mm_castsi128_ps( _mm_or_si128( _mm_and_si128( bits, _mm_set1_epi32( 0x007fffff ) ), _mm_set1_epi32( 0x3f800000 ) ) );
+
+    const __m128 mask = _mm_cmpgt_ps( m, _mm_set1_ps( SQRT2 ) );
+    m = _mm_or_ps( _mm_and_ps( mask, _mm_mul_ps( m, _mm_set1_ps( 0.5f ) ) ), _mm_andnot_ps( mask, m ) );
+    e = _mm_add_ps( e, _mm_and_ps( mask, one ) );
+
+    const __m128 t  = _mm_div_ps( _mm_sub_ps( m, one ), _mm_add_ps( m, one ) );
+    const __m128 t2 = _mm_mul_ps( t, t );
+
+    __m128 p = _mm_set1_ps( LOG2_C9 );
+    p = _mm_add_ps( _mm_mul_ps( p, t2 ), _mm_set1_ps( LOG2_C7 ) );
+    p = _mm_add_ps( _mm_mul_ps( p, t2 ), _mm_set1_ps( LOG2_C5 ) );
+    p = _mm_add_ps( _mm_mul_ps( p, t2 ), _mm_set1_ps( LOG2_C3 ) );
+    p = _mm_add_ps( _mm_mul_ps( p, t2 ), _mm_set1_ps( LOG2_C1 ) );
+    return _mm_add_ps( e, _mm_mul_ps( t, p ) );
+}
+
+//-------------------------------------------------------------------------------------------
+//      2^y を4要素まとめて求めます.
+//-------------------------------------------------------------------------------------------
+inline __m128 FastExp2( __m128 y )
+{
+    y = _mm_min_ps( _mm_max_ps( y, _mm_set1_ps( -126.0f ) ), _mm_set1_ps( 127.0f ) );
+
+    // スカラー版の floorf( y + 0.5f ) と揃える. y + 0.5 は正負どちらもあるので切り捨てを補正する.
+    const __m128  h = _mm_add_ps( y, _mm_set1_ps( 0.5f ) );
+    __m128i       n = _mm_cvttps_epi32( h );
+    __m128        i = _mm_cvtepi32_ps( n );
+    const __m128  c = _mm_cmpgt_ps( i, h );
+    i = _mm_sub_ps( i, _mm_and_ps( c, _mm_set1_ps( 1.0f ) ) );
+    n = _mm_add_epi32( n, _mm_castps_si128( c ) );
+
+    const __m128 f = _mm_sub_ps( y, i );
+
+    __m128 p = _mm_set1_ps( EXP2_C7 );
+    p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( EXP2_C6 ) );
+    p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( EXP2_C5 ) );
+    p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( EXP2_C4 ) );
+    p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( EXP2_C3 ) );
+    p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( EXP2_C2 ) );
+    p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( EXP2_C1 ) );
+    p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( 1.0f ) );
+
+    const __m128 scale = _mm_castsi128_ps( _mm_slli_epi32( _mm_add_epi32( n, _mm_set1_epi32( 127 ) ), 23 ) );
+    return _mm_mul_ps( p, scale );
+}
+
+//-------------------------------------------------------------------------------------------
+//      sRGB -> 線形 変換を4要素まとめて行います.
+//-------------------------------------------------------------------------------------------
+inline __m128 SRGBToLinear4( __m128 c )
+{
+    const __m128 base   = _mm_add_ps( _mm_mul_ps( c, _mm_set1_ps( 1.0f / 1.055f ) ), _mm_set1_ps( 0.055f / 1.055f ) );
+    const __m128 curve  = FastExp2( _mm_mul_ps( FastLog2( base ), _mm_set1_ps( 2.4f ) ) );
+    const __m128 linear = _mm_mul_ps( c, _mm_set1_ps( 1.0f / 12.92f ) );
+    const __m128 mask   = _mm_cmple_ps( c, _mm_set1_ps( SRGB_THRESHOLD ) );
+    return _mm_or_ps( _mm_and_ps( mask, linear ), _mm_andnot_ps( mask, curve ) );
+}
+
+//-------------------------------------------------------------------------------------------
+//      線形 -> sRGB 変換を4要素まとめて行います.
+//-------------------------------------------------------------------------------------------
+inline __m128 LinearToSRGB4( __m128 l )
+{
+    const __m128 curve  = _mm_sub_ps( _mm_mul_ps( FastExp2( _mm_mul_ps( FastLog2( l ), _mm_set1_ps( 1.0f / 2.4f ) ) ), _mm_set1_ps( 1.055f ) ), _mm_set1_ps( 0.055f ) );
+    const __m128 linear = _mm_mul_ps( l, _mm_set1_ps( 12.92f ) );
+    const __m128 mask   = _mm_cmple_ps( l, _mm_set1_ps( LINEAR_THRESHOLD ) );
+    return _mm_or_ps( _mm_and_ps( mask, linear ), _mm_andnot_ps( mask, curve ) );
+}
+#endif//COLOR_ENABLE_SSE2
+
+//-------------------------------------------------------------------------------------------
+//      sRGB -> 線形 変換を行います.
+//-------------------------------------------------------------------------------------------
+inline float SRGBToLinear1( float c )
+{
+    return ( c <= SRGB_THRESHOLD )
+        ? c * ( 1.0f / 12.92f )
+        : FastExp2( FastLog2( c * ( 1.0f / 1.055f ) + ( 0.055f / 1.055f ) ) * 2.4f );
+}
+
+//-------------------------------------------------------------------------------------------
+//      線形 -> sRGB 変換を行います.
+//-------------------------------------------------------------------------------------------
+inline float LinearToSRGB1( float l )
+{
+    return ( l <= LINEAR_THRESHOLD )
+        ? l * 12.92f
+        : FastExp2( FastLog2( l ) * ( 1.0f / 2.4f ) ) * 1.055f - 0.055f;
+}
+
+//-------------------------------------------------------------------------------------------
+//      8bit変換テーブルを初期化します.
+//-------------------------------------------------------------------------------------------
+void InitTables()
+{
+    // テーブルも同じ多項式カーネルで作る. 境界値は隣り合うsRGB値の中点を線形化したもの.
+    float values[ 256 ];
+    for( int i=0; i<256; ++i )
+    { values[ i ] = i / 255.0f; }
+    ConvertSRGBToLinear( values, g_SRGBToLinear, 256 );
+
+    for( int i=0; i<255; ++i )
+    { values[ i ] = ( i + 0.5f ) / 255.0f; }
+    ConvertSRGBToLinear( values, g_SRGBThreshold, 255 );
+    g_SRGBThreshold[ 255 ] = 2.0f;
+
+    // 端点は誤差なく 0, 1 になるよう固定する.
+    g_SRGBToLinear[   0 ] = 0.0f;
+    g_SRGBToLinear[ 255 ] = 1.0f;
+
+    std::vector<float> approx( LINEAR_TO_SRGB_SIZE );
+    for( unsigned int i=0; i<LINEAR_TO_SRGB_SIZE; ++i )
+    { approx[ i ] = i / float( LINEAR_TO_SRGB_SIZE - 1 ); }
+    ConvertLinearToSRGB( &approx[0], &approx[0], LINEAR_TO_SRGB_SIZE );
+
+    for( unsigned int i=0; i<LINEAR_TO_SRGB_SIZE; ++i )
+    {
+        const float c = approx[ i ] * 255.0f + 0.5f;
+        g_LinearToSRGB[ i ] = static_cast<unsigned char>( ( c < 255.0f ) ? c : 255.0f );
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      [0, 1] の線形値を8bitのsRGB値に変換します(テーブル初期化済みであること).
+//-------------------------------------------------------------------------------------------
+inline unsigned char QuantizeSRGB( float v )
+{
+    // テーブルで近似値を求め，境界値と比較して最も近い値に補正する.
+    int c = g_LinearToSRGB[ static_cast<unsigned int>( v * ( LINEAR_TO_SRGB_SIZE - 1 ) + 0.5f ) ];
+    while( c < 255 && v >= g_SRGBThreshold[ c ] )
+    { c++; }
+    while( c > 0 && v < g_SRGBThreshold[ c - 1 ] )
+    { c--; }
+
+    return static_cast<unsigned char>( c );
+}
+
+//-------------------------------------------------------------------------------------------
+//      [0, 1] にクランプします.
+//-------------------------------------------------------------------------------------------
+inline float Saturate( float v )
+{ return ( v > 0.0f ) ? ( ( v < 1.0f ) ? v : 1.0f ) : 0.0f; }
+
+//-------------------------------------------------------------------------------------------
+//      アルファチャンネルの位置を取得します.
+//-------------------------------------------------------------------------------------------
+inline int GetAlphaChannel( unsigned int bytePerPixel )
+{
+    if ( bytePerPixel == 4 ) { return 3; }
+    if ( bytePerPixel == 2 ) { return 1; }
+    return -1;
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------
+//      sRGB -> 線形 変換を行います.
+//-------------------------------------------------------------------------------------------
+float SRGBToLinear( float value )
+{
+#if COLOR_ENABLE_SSE2
+    // 配列版と結果を揃えるためSIMD版で計算する.
+    return _mm_cvtss_f32( SRGBToLinear4( _mm_set_ss( value ) ) );
+#else
+    return SRGBToLinear1( value );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------
+//      線形 -> sRGB 変換を行います.
+//-------------------------------------------------------------------------------------------
+float LinearToSRGB( float value )
+{
+#if COLOR_ENABLE_SSE2
+    return _mm_cvtss_f32( LinearToSRGB4( _mm_set_ss( value ) ) );
+#else
+    return LinearToSRGB1( value );
+#endif
+}
+
+//-------------------------------------------------------------------------------------------
+//      8bitのsRGB値を線形の値に変換します.
+//-------------------------------------------------------------------------------------------
+float SRGB8ToLinear( unsigned char value )
+{
+    std::call_once( g_TableFlag, InitTables );
+    return g_SRGBToLinear[ value ];
+}
+
+//-------------------------------------------------------------------------------------------
+//      線形の値を8bitのsRGB値に変換します.
+//-------------------------------------------------------------------------------------------
+unsigned char LinearToSRGB8( float value )
+{
+    std::call_once( g_TableFlag, InitTables );
+    return QuantizeSRGB( Saturate( value ) );
+}
+
+//-------------------------------------------------------------------------------------------
+//      浮動小数の配列をsRGBから線形に変換します.
+//-------------------------------------------------------------------------------------------
+void ConvertSRGBToLinear( const float* pSrc, float* pDst, size_t count )
+{
+    size_t i = 0;
+
+#if COLOR_ENABLE_SSE2
+    for( ; i + 4 <= count; i += 4 )
+    { _mm_storeu_ps( pDst + i, SRGBToLinear4( _mm_loadu_ps( pSrc + i ) ) ); }
+
+    for( ; i<count; ++i )
+    { pDst[ i ] = _mm_cvtss_f32( SRGBToLinear4( _mm_set_ss( pSrc[ i ] ) ) ); }
+#else
+    for( ; i<count; ++i )
+    { pDst[ i ] = SRGBToLinear1( pSrc[ i ] ); }
+#endif
+}
+
+//-------------------------------------------------------------------------------------------
+//      浮動小数の配列を線形からsRGBに変換します.
+//-------------------------------------------------------------------------------------------
+void ConvertLinearToSRGB( const float* pSrc, float* pDst, size_t count )
+{
+    size_t i = 0;
+
+#if COLOR_ENABLE_SSE2
+    for( ; i + 4 <= count; i += 4 )
+    { _mm_storeu_ps( pDst + i, LinearToSRGB4( _mm_loadu_ps( pSrc + i ) ) ); }
+
+    for( ; i<count; ++i )
+    { pDst[ i ] = _mm_cvtss_f32( LinearToSRGB4( _mm_set_ss( pSrc[ i ] ) ) ); }
+#else
+    for( ; i<count; ++i )
+    { pDst[ i ] = LinearToSRGB1( pSrc[ i ] ); }
+#endif
+}
+
+//-------------------------------------------------------------------------------------------
+//      8bitのピクセルデータを線形空間の float4 に変換します.
+//-------------------------------------------------------------------------------------------
+void ConvertToLinearFloat4
+(
+    const unsigned char*    pSrc,
+    size_t                  pixelCount,
+    unsigned int            bytePerPixel,
+    COLOR_SPACE             colorSpace,
+    float*                  pDst
+)
+{
+    std::call_once( g_TableFlag, InitTables );
+
+    // 線形の場合も 1/255 のテーブルとして同じループで処理する.
+    float unorm[ 256 ];
+    const float* pLut = g_SRGBToLinear;
+    if ( colorSpace != COLOR_SPACE_SRGB )
+    {
+        for( int i=0; i<256; ++i )
+        { unorm[ i ] = i / 255.0f; }
+        pLut = unorm;
+    }
+
+    switch( bytePerPixel )
+    {
+    case 4:
+        for( size_t i=0; i<pixelCount; ++i )
+        {
+            pDst[ i * 4 + 0 ] = pLut[ pSrc[ i * 4 + 0 ] ];
+            pDst[ i * 4 + 1 ] = pLut[ pSrc[ i * 4 + 1 ] ];
+            pDst[ i * 4 + 2 ] = pLut[ pSrc[ i * 4 + 2 ] ];
+            pDst[ i * 4 + 3 ] = pSrc[ i * 4 + 3 ] / 255.0f;
+        }
+        break;
+
+    case 3:
+        for( size_t i=0; i<pixelCount; ++i )
+        {
+            pDst[ i * 4 + 0 ] = pLut[ pSrc[ i * 3 + 0 ] ];
+            pDst[ i * 4 + 1 ] = pLut[ pSrc[ i * 3 + 1 ] ];
+            pDst[ i * 4 + 2 ] = pLut[ pSrc[ i * 3 + 2 ] ];
+            pDst[ i * 4 + 3 ] = 1.0f;
+        }
+        break;
+
+    default:
+        {
+            const int alphaChannel = GetAlphaChannel( bytePerPixel );
+            for( size_t i=0; i<pixelCount; ++i )
+            {
+                float* pTexel = pDst + i * 4;
+                pTexel[0] = pTexel[1] = pTexel[2] = 0.0f;
+                pTexel[3] = 1.0f;
+
+                for( unsigned int c=0; c<bytePerPixel; ++c )
+                {
+                    const unsigned char value = pSrc[ i * bytePerPixel + c ];
+                    pTexel[ c ] = ( int( c ) != alphaChannel ) ? pLut[ value ] : value / 255.0f;
+                }
+            }
+        }
+        break;
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      線形空間の float4 を8bitのピクセルデータに変換します.
+//-------------------------------------------------------------------------------------------
+void ConvertFromLinearFloat4
+(
+    const float*    pSrc,
+    size_t          pixelCount,
+    unsigned int    bytePerPixel,
+    COLOR_SPACE     colorSpace,
+    float           alphaScale,
+    unsigned char*  pDst
+)
+{
+    std::call_once( g_TableFlag, InitTables );
+
+    const int  alphaChannel = GetAlphaChannel( bytePerPixel );
+    const bool isSRGB       = ( colorSpace == COLOR_SPACE_SRGB );
+
+    for( size_t i=0; i<pixelCount; ++i )
+    {
+        const float* pTexel = pSrc + i * 4;
+
+        for( unsigned int c=0; c<bytePerPixel; ++c )
+        {
+            const bool isAlpha = ( int( c ) == alphaChannel );
+
+            // 負のローブによるはみ出しはクランプする.
+            const float v = Saturate( pTexel[ c ] * ( isAlpha ? alphaScale : 1.0f ) );
+
+            pDst[ i * bytePerPixel + c ] = ( isSRGB && !isAlpha )
+                ? QuantizeSRGB( v )
+                : static_cast<unsigned char>( v * 255.0f + 0.5f );
+        }
+    }
+}
@@ -0,0 +1,168 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : MappedFile.cpp
+// Desc : Read Only Memory Mapped File.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <MappedFile.h>
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif//WIN32_LEAN_AND_MEAN
+    #ifndef NOMINMAX
+    #define NOMINMAX
+    #endif//NOMINMAX
+    #include <Windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// MappedFile class
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------
+MappedFile::MappedFile()
+: m_hFile       ( nullptr )
+, m_hMapping    ( nullptr )
+, m_FileDesc    ( -1 )
+, m_pData       ( nullptr )
+, m_Size        ( 0 )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{ Close(); }
+
+//-------------------------------------------------------------------------------------------
+//      ファイルをメモリにマップします.
+//-------------------------------------------------------------------------------------------
+bool MappedFile::Open( const char* filename )
+{
+    Close();
+
+#if defined(_WIN32)
+    HANDLE hFile = CreateFileA(
+        filename,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr );
+    if ( hFile == INVALID_HANDLE_VALUE )
+    { return false; }
+
+    LARGE_INTEGER size;
+    if ( !GetFileSizeEx( hFile, &size )
+      || ( size.QuadPart <= 0 )
+      || ( static_cast<unsigned long long>( size.QuadPart ) > static_cast<unsigned long long>( size_t( -1 ) ) ) )
+    {
+        CloseHandle( hFile );
+        return false;
+    }
+
+    HANDLE hMapping = CreateFileMappingA( hFile, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    if ( hMapping == nullptr )
+    {
+        CloseHandle( hFile );
+        return false;
+    }
+
+    void* pView = MapViewOfFile( hMapping, FILE_MAP_READ, 0, 0, 0 );
+    if ( pView == nullptr )
+    {
+        CloseHandle( hMapping );
+        CloseHandle( hFile );
+        return false;
+    }
+
+    m_hFile    = hFile;
+    m_hMapping = hMapping;
+    m_pData    = static_cast<unsigned char*>( pView );
+    m_Size     = size_t( size.QuadPart );
+#else
+    int fd = open( filename, O_RDONLY );
+    if ( fd < 0 )
+    { return false; }
+
+    struct stat st;
+    if ( fstat( fd, &st ) != 0 || st.st_size <= 0 )
+    {
+        close( fd );
+        return false;
+    }
+
+    void* pView = mmap( nullptr, size_t( st.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+    if ( pView == MAP_FAILED )
+    {
+        close( fd );
+        return false;
+    }
+
+    m_FileDesc = fd;
+    m_pData    = static_cast<unsigned char*>( pView );
+    m_Size     = size_t( st.st_size );
+#endif
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      マップを解除し，ファイルを閉じます.
+//-------------------------------------------------------------------------------------------
+void MappedFile::Close()
+{
+#if defined(_WIN32)
+    if ( m_pData )
+    { UnmapViewOfFile( m_pData ); }
+
+    if ( m_hMapping )
+    { CloseHandle( m_hMapping ); }
+
+    if ( m_hFile )
+    { CloseHandle( m_hFile ); }
+#else
+    if ( m_pData )
+    { munmap( m_pData, m_Size ); }
+
+    if ( m_FileDesc >= 0 )
+    { close( m_FileDesc ); }
+#endif
+
+    m_hFile    = nullptr;
+    m_hMapping = nullptr;
+    m_FileDesc = -1;
+    m_pData    = nullptr;
+    m_Size     = 0;
+}
+
+//-------------------------------------------------------------------------------------------
+//      マップされているかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool MappedFile::IsOpen() const
+{ return ( m_pData != nullptr ); }
+
+//-------------------------------------------------------------------------------------------
+//      マップされたデータの先頭ポインタを取得します.
+//-------------------------------------------------------------------------------------------
+const unsigned char* MappedFile::GetData() const
+{ return m_pData; }
+
+//-------------------------------------------------------------------------------------------
+//      ファイルサイズを取得します.
+//-------------------------------------------------------------------------------------------
+size_t MappedFile::GetSize() const
+{ return m_Size; }
@@ -8,10 +8,87 @@
 // Includes
 //-------------------------------------------------------------------------------------------
 #include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
 #include <fstream>
+#include <vector>
 #include <RawLoader.h>
+#include <MipMapGenerator.h>
+#include <TextureCache.h>
+#include <ColorSpace.h>
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif//WIN32_LEAN_AND_MEAN
+    #ifndef NOMINMAX
+    #define NOMINMAX
+    #endif//NOMINMAX
+    #include <Windows.h>
+#else
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
 #include <GL/glut.h>
 
+#ifndef GL_SRGB8
+#define GL_SRGB8            0x8C41
+#endif//GL_SRGB8
+
+#ifndef GL_SRGB8_ALPHA8
+#define GL_SRGB8_ALPHA8     0x8C43
+#endif//GL_SRGB8_ALPHA8
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+const size_t    MAX_READ_SIZE   = size_t( 1 ) << 30;    //!< 1回の読み込みで要求する最大バイト数です.
+
+//-------------------------------------------------------------------------------------------
+//      色空間に応じた内部フォーマットを取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int GetInternalFormat( unsigned int format, COLOR_SPACE colorSpace )
+{
+    if ( colorSpace != COLOR_SPACE_SRGB )
+    { return format; }
+
+    return ( format == GL_RGBA ) ? GL_SRGB8_ALPHA8 : GL_SRGB8;
+}
+
+//-------------------------------------------------------------------------------------------
+//      sRGBの内部フォーマットかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsSRGBInternalFormat( unsigned int internalFormat )
+{ return ( internalFormat == GL_SRGB8 ) || ( internalFormat == GL_SRGB8_ALPHA8 ); }
+
+//-------------------------------------------------------------------------------------------
+//      sRGBテクスチャに対応しているかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsSupportSRGBTexture()
+{
+    // GL 2.1 以降はコア機能.
+    const char* pVersion = reinterpret_cast<const char*>( glGetString( GL_VERSION ) );
+    if ( pVersion != nullptr )
+    {
+        const char* pDot  = strchr( pVersion, '.' );
+        const int   major = atoi( pVersion );
+        const int   minor = ( pDot != nullptr ) ? atoi( pDot + 1 ) : 0;
+        if ( major > 2 || ( major == 2 && minor >= 1 ) )
+        { return true; }
+    }
+
+    const char* pExtensions = reinterpret_cast<const char*>( glGetString( GL_EXTENSIONS ) );
+    return ( pExtensions != nullptr ) && ( strstr( pExtensions, "GL_EXT_texture_sRGB" ) != nullptr );
+}
+
+} // namespace /* anonymous */
+
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 // RawImage class
@@ -29,6 +106,12 @@ RawImage::RawImage()
 , m_BytePerPixel    ( 0 )
 , m_ID              ( 0 )
 , m_pImageData      ( nullptr )
+, m_hStream         ( nullptr )
+, m_StreamDesc      ( -1 )
+, m_SourceWidth     ( 0 )
+, m_SourceHeight    ( 0 )
+, m_ColorSpace      ( COLOR_SPACE_SRGB )
+, m_ColorSpaceHint  ( COLOR_SPACE_SRGB )
 { /* DO_NOTHING */ }
 
 
@@ -49,12 +132,16 @@ void RawImage::Release()
         m_pImageData = nullptr;
     }
 
+    m_Cache.Close();
+    CloseStream();
+
     m_ImageSize      = 0;
     m_Format         = 0;
     m_InternalFormat = 0;
     m_Width          = 0;
     m_Height         = 0;
     m_BytePerPixel   = 0;
+    m_ColorSpace     = m_ColorSpaceHint;
 }
 
 //-------------------------------------------------------------------------------------------
@@ -68,6 +155,26 @@ bool RawImage::Load
     bool                alphaFlag
 )
 {
+    // RAWはサイズとアルファの有無を持たないので，キャッシュの識別に含める.
+    // 線形として扱う場合はミップマップの内容が変わるので，これも区別する.
+    const unsigned long long salt = ( ( static_cast<unsigned long long>( width ) << 32 )
+                                    | ( static_cast<unsigned long long>( height ) << 1 )
+                                    | ( alphaFlag ? 1 : 0 ) )
+                                  ^ ( ( m_ColorSpaceHint == COLOR_SPACE_LINEAR ) ? TextureCache::SALT_LINEAR : 0 );
+
+    // 変換済みのキャッシュがあれば復号とミップ生成をすべて省略する.
+    if ( m_Cache.Open( filename, salt ) )
+    {
+        m_Width          = m_Cache.GetWidth();
+        m_Height         = m_Cache.GetHeight();
+        m_BytePerPixel   = m_Cache.GetBytePerPixel();
+        m_Format         = m_Cache.GetFormat();
+        m_InternalFormat = m_Cache.GetInternalFormat();
+        m_ColorSpace     = IsSRGBInternalFormat( m_InternalFormat ) ? COLOR_SPACE_SRGB : COLOR_SPACE_LINEAR;
+        m_ImageSize      = m_Cache.GetLevel( 0 ).size;
+        return true;
+    }
+
     std::ifstream file;
 
     // ファイルを開く.
@@ -79,22 +186,23 @@ bool RawImage::Load
         return false;
     }
 
-    m_Width  = width;
-    m_Height = height;
+    m_Width      = width;
+    m_Height     = height;
+    m_ColorSpace = m_ColorSpaceHint;
 
     if ( alphaFlag )
     {
         m_BytePerPixel   = 4;
         m_ImageSize      = m_Width * m_Height * m_BytePerPixel;
         m_Format         = GL_RGBA;
-        m_InternalFormat = GL_RGBA;
+        m_InternalFormat = GetInternalFormat( GL_RGBA, m_ColorSpace );
     }
     else
     {
         m_BytePerPixel   = 3;
         m_ImageSize      = m_Width * m_Height * m_BytePerPixel;
         m_Format         = GL_RGB;
-        m_InternalFormat = GL_RGB;
+        m_InternalFormat = GetInternalFormat( GL_RGB, m_ColorSpace );
     }
 
     // メモリ確保.
@@ -120,7 +228,7 @@ bool RawImage::Load
 //-------------------------------------------------------------------------------------------
 bool RawImage::CreateGLTexture()
 {
-    if ( m_pImageData == nullptr )
+    if ( m_pImageData == nullptr && !m_Cache.IsValid() )
     { return false; }
 
     //　テクスチャを生成
@@ -129,20 +237,68 @@ bool RawImage::CreateGLTexture()
     //　テクスチャをバインドする
     glBindTexture(GL_TEXTURE_2D, m_ID);
 
+    // sRGBテクスチャに非対応の環境では変換せずにそのまま転送する.
+    const unsigned int internalFormat = ( IsSRGBInternalFormat( m_InternalFormat ) && !IsSupportSRGBTexture() )
+        ? m_Format
+        : m_InternalFormat;
+
     if ( m_BytePerPixel == 4 )
     { glPixelStorei(GL_UNPACK_ALIGNMENT, 4); }
     else 
     { glPixelStorei(GL_UNPACK_ALIGNMENT, 1); }
 
-    //　テクスチャの割り当て
-    gluBuild2DMipmaps(
-        GL_TEXTURE_2D,
-        m_InternalFormat,
-        m_Width,
-        m_Height,
-        m_Format,
-        GL_UNSIGNED_BYTE,
-        m_pImageData );
+    if ( m_Cache.IsValid() )
+    {
+        //　キャッシュからマップしたまま転送する.
+        for( unsigned int i=0; i<m_Cache.GetMipCount(); ++i )
+        {
+            const TextureCache::Level& level = m_Cache.GetLevel( i );
+            glTexImage2D(
+                GL_TEXTURE_2D,
+                int(i),
+                internalFormat,
+                level.width,
+                level.height,
+                0,
+                m_Format,
+                GL_UNSIGNED_BYTE,
+                m_Cache.GetLevelData( i ) );
+        }
+    }
+    else
+    {
+        //　ミップマップチェインをCPUで生成する(非2の累乗サイズもリスケールしない).
+        //　sRGBの画像は線形空間に変換してから縮小する.
+        MipMapOption option;
+        option.isSRGB = ( m_ColorSpace == COLOR_SPACE_SRGB );
+
+        std::vector<MipLevel> levels;
+        if ( !GenerateMipMaps( m_pImageData, m_Width, m_Height, m_BytePerPixel, option, levels ) )
+        {
+            std::cerr << "Error : Generate MipMaps Failed." << std::endl;
+            glBindTexture( GL_TEXTURE_2D, 0 );
+            DeleteGLTexture();
+            return false;
+        }
+
+        //　テクスチャの割り当て
+        for( size_t i=0; i<levels.size(); ++i )
+        {
+            glTexImage2D(
+                GL_TEXTURE_2D,
+                int(i),
+                internalFormat,
+                levels[i].width,
+                levels[i].height,
+                0,
+                m_Format,
+                GL_UNSIGNED_BYTE,
+                &levels[i].pixels[0] );
+        }
+
+        // 次回の起動で復号とミップ生成を省略できるよう保存しておく.
+        m_Cache.Save( m_Format, m_InternalFormat, m_BytePerPixel, levels );
+    }
 
     //　テクスチャを拡大・縮小する方法の指定
     glTexParameteri(GL_TEXTURE_2D, 	GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -174,3 +330,380 @@ void RawImage::DeleteGLTexture()
 //-------------------------------------------------------------------------------------------
 unsigned int RawImage::GetID() const
 { return m_ID; }
+
+//-------------------------------------------------------------------------------------------
+//      画像の横幅を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int RawImage::GetWidth() const
+{ return m_Width; }
+
+//-------------------------------------------------------------------------------------------
+//      画像の縦幅を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int RawImage::GetHeight() const
+{ return m_Height; }
+
+//-------------------------------------------------------------------------------------------
+//      1ピクセルあたりのバイト数を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int RawImage::GetBytePerPixel() const
+{ return m_BytePerPixel; }
+
+//-------------------------------------------------------------------------------------------
+//      ピクセルデータを取得します.
+//-------------------------------------------------------------------------------------------
+const unsigned char* RawImage::GetPixels() const
+{ return ( m_pImageData != nullptr ) ? m_pImageData : m_Cache.GetLevelData( 0 ); }
+
+//-------------------------------------------------------------------------------------------
+//      色空間の情報を持たない画像に適用する色空間を設定します.
+//-------------------------------------------------------------------------------------------
+void RawImage::SetColorSpaceHint( COLOR_SPACE colorSpace )
+{ m_ColorSpaceHint = colorSpace; }
+
+//-------------------------------------------------------------------------------------------
+//      読み込んだ画像の色空間を取得します.
+//-------------------------------------------------------------------------------------------
+COLOR_SPACE RawImage::GetColorSpace() const
+{ return m_ColorSpace; }
+
+//-------------------------------------------------------------------------------------------
+//      ファイル全体を読み込まずに領域読み込み用として開きます.
+//-------------------------------------------------------------------------------------------
+bool RawImage::OpenStream
+(
+    const char*         filename,
+    const unsigned int  width,
+    const unsigned int  height,
+    bool                alphaFlag
+)
+{
+    Release();
+
+    if ( width == 0 || height == 0 )
+    {
+        std::cerr << "Error : Invalid Image Size." << std::endl;
+        return false;
+    }
+
+    const unsigned int bytePerPixel = ( alphaFlag ) ? 4 : 3;
+    const unsigned long long requiredSize = static_cast<unsigned long long>( width )
+                                          * static_cast<unsigned long long>( height )
+                                          * bytePerPixel;
+
+#if defined(_WIN32)
+    HANDLE hFile = CreateFileA(
+        filename,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS,
+        nullptr );
+    if ( hFile == INVALID_HANDLE_VALUE )
+    {
+        std::cerr << "Error : File Open Failed.";
+        std::cerr << "File Name : " << filename << std::endl;
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if ( !GetFileSizeEx( hFile, &size )
+      || ( static_cast<unsigned long long>( size.QuadPart ) < requiredSize ) )
+    {
+        std::cerr << "Error : File Size Is Too Small.";
+        std::cerr << "File Name : " << filename << std::endl;
+        CloseHandle( hFile );
+        return false;
+    }
+
+    m_hStream = hFile;
+#else
+    int fd = open( filename, O_RDONLY );
+    if ( fd < 0 )
+    {
+        std::cerr << "Error : File Open Failed.";
+        std::cerr << "File Name : " << filename << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if ( fstat( fd, &st ) != 0
+      || ( static_cast<unsigned long long>( st.st_size ) < requiredSize ) )
+    {
+        std::cerr << "Error : File Size Is Too Small.";
+        std::cerr << "File Name : " << filename << std::endl;
+        close( fd );
+        return false;
+    }
+
+    m_StreamDesc = fd;
+#endif
+
+    m_SourceWidth    = width;
+    m_SourceHeight   = height;
+    m_BytePerPixel   = bytePerPixel;
+    m_Format         = ( alphaFlag ) ? GL_RGBA : GL_RGB;
+    m_ColorSpace     = m_ColorSpaceHint;
+    m_InternalFormat = GetInternalFormat( m_Format, m_ColorSpace );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      領域読み込み用に開いたファイルを閉じます.
+//-------------------------------------------------------------------------------------------
+void RawImage::CloseStream()
+{
+#if defined(_WIN32)
+    if ( m_hStream != nullptr )
+    {
+        CloseHandle( static_cast<HANDLE>( m_hStream ) );
+        m_hStream = nullptr;
+    }
+#else
+    if ( m_StreamDesc >= 0 )
+    {
+        close( m_StreamDesc );
+        m_StreamDesc = -1;
+    }
+#endif
+
+    m_SourceWidth  = 0;
+    m_SourceHeight = 0;
+}
+
+//-------------------------------------------------------------------------------------------
+//      領域読み込み用にファイルが開かれているかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool RawImage::IsStreamOpen() const
+{ return ( m_hStream != nullptr ) || ( m_StreamDesc >= 0 ); }
+
+//-------------------------------------------------------------------------------------------
+//      指定オフセットから読み込みます.
+//-------------------------------------------------------------------------------------------
+bool RawImage::ReadAt( unsigned long long offset, void* pDst, size_t size ) const
+{
+    unsigned char* pCur = static_cast<unsigned char*>( pDst );
+
+    // ファイルポインタを共有しない位置指定読み込みなので，複数スレッドから同時に呼び出せる.
+    while( size > 0 )
+    {
+        const size_t request = ( size < MAX_READ_SIZE ) ? size : MAX_READ_SIZE;
+
+#if defined(_WIN32)
+        OVERLAPPED overlapped = {};
+        overlapped.Offset     = static_cast<DWORD>( offset & 0xffffffff );
+        overlapped.OffsetHigh = static_cast<DWORD>( offset >> 32 );
+
+        DWORD readSize = 0;
+        if ( !ReadFile( static_cast<HANDLE>( m_hStream ), pCur, static_cast<DWORD>( request ), &readSize, &overlapped )
+          || ( readSize == 0 ) )
+        { return false; }
+#else
+        const ssize_t readSize = pread( m_StreamDesc, pCur, request, static_cast<off_t>( offset ) );
+        if ( readSize <= 0 )
+        { return false; }
+#endif
+
+        pCur   += readSize;
+        offset += readSize;
+        size   -= size_t( readSize );
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      指定領域のピクセルを読み込みます.
+//-------------------------------------------------------------------------------------------
+bool RawImage::ReadRegion
+(
+    unsigned int    x,
+    unsigned int    y,
+    unsigned int    width,
+    unsigned int    height,
+    unsigned char*  pDst,
+    unsigned int    downsample
+) const
+{
+    if ( !IsStreamOpen() || pDst == nullptr || downsample == 0 || width == 0 || height == 0 )
+    { return false; }
+
+    if ( ( x > m_SourceWidth  ) || ( width  > m_SourceWidth  - x )
+      || ( y > m_SourceHeight ) || ( height > m_SourceHeight - y ) )
+    {
+        std::cerr << "Error : Region Out Of Range." << std::endl;
+        return false;
+    }
+
+    const unsigned int       bpp       = m_BytePerPixel;
+    const size_t             rowSize   = size_t( width ) * bpp;
+    const unsigned long long pitch     = static_cast<unsigned long long>( m_SourceWidth ) * bpp;
+    const bool               fullWidth = ( x == 0 ) && ( width == m_SourceWidth );
+
+    // 縮小なし : 行ごとに読み込み先へ直接読み込む. 全幅の場合は連続領域なので1回で読む.
+    if ( downsample == 1 )
+    {
+        const unsigned long long offset = pitch * y + static_cast<unsigned long long>( x ) * bpp;
+        if ( fullWidth )
+        { return ReadAt( offset, pDst, rowSize * height ); }
+
+        for( unsigned int i=0; i<height; ++i )
+        {
+            if ( !ReadAt( offset + pitch * i, pDst + rowSize * i, rowSize ) )
+            { return false; }
+        }
+
+        return true;
+    }
+
+    // 縮小あり : downsample 行ずつ読み込んでボックスフィルタで平均する.
+    // sRGBのカラー成分はテーブルで線形化してから平均し，最も近いsRGB値に戻す.
+    const unsigned int dstW = GetDownsampledSize( width,  downsample );
+    const unsigned int dstH = GetDownsampledSize( height, downsample );
+    const bool         isSRGB = ( m_ColorSpace == COLOR_SPACE_SRGB );
+
+    float toLinear[ 256 ];
+    for( int i=0; i<256; ++i )
+    { toLinear[ i ] = ( isSRGB ) ? SRGB8ToLinear( static_cast<unsigned char>( i ) ) : i / 255.0f; }
+
+    std::vector<unsigned char> rows( rowSize * downsample );
+    std::vector<unsigned int>  sums( size_t( dstW ) * bpp );
+    std::vector<float>         linearSums( ( isSRGB ) ? size_t( dstW ) * bpp : 0 );
+
+    for( unsigned int j=0; j<dstH; ++j )
+    {
+        const unsigned int srcY  = y + j * downsample;
+        const unsigned int rest  = y + height - srcY;
+        const unsigned int rowCount = ( rest < downsample ) ? rest : downsample;
+        const unsigned long long offset = pitch * srcY + static_cast<unsigned long long>( x ) * bpp;
+
+        if ( fullWidth )
+        {
+            if ( !ReadAt( offset, &rows[0], rowSize * rowCount ) )
+            { return false; }
+        }
+        else
+        {
+            for( unsigned int r=0; r<rowCount; ++r )
+            {
+                if ( !ReadAt( offset + pitch * r, &rows[rowSize * r], rowSize ) )
+                { return false; }
+            }
+        }
+
+        std::fill( sums.begin(), sums.end(), 0 );
+        std::fill( linearSums.begin(), linearSums.end(), 0.0f );
+
+        for( unsigned int r=0; r<rowCount; ++r )
+        {
+            const unsigned char* pRow = &rows[rowSize * r];
+            for( unsigned int i=0; i<width; ++i )
+            {
+                unsigned int* pSum = &sums[size_t( i / downsample ) * bpp];
+                for( unsigned int c=0; c<bpp; ++c )
+                { pSum[c] += pRow[size_t( i ) * bpp + c]; }
+
+                if ( isSRGB )
+                {
+                    float* pLinearSum = &linearSums[size_t( i / downsample ) * bpp];
+                    for( unsigned int c=0; c<3; ++c )
+                    { pLinearSum[c] += toLinear[ pRow[size_t( i ) * bpp + c] ]; }
+                }
+            }
+        }
+
+        unsigned char* pOut = pDst + size_t( j ) * dstW * bpp;
+        for( unsigned int i=0; i<dstW; ++i )
+        {
+            const unsigned int restX    = width - i * downsample;
+            const unsigned int colCount = ( restX < downsample ) ? restX : downsample;
+            const unsigned int count    = colCount * rowCount;
+            for( unsigned int c=0; c<bpp; ++c )
+            {
+                // アルファは線形なので整数のまま平均する.
+                pOut[size_t( i ) * bpp + c] = ( isSRGB && c < 3 )
+                    ? LinearToSRGB8( linearSums[size_t( i ) * bpp + c] / count )
+                    : static_cast<unsigned char>( ( sums[size_t( i ) * bpp + c] + count / 2 ) / count );
+            }
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      指定領域を読み込み，テクスチャ生成用のピクセルデータとして保持します.
+//-------------------------------------------------------------------------------------------
+bool RawImage::LoadRegion
+(
+    unsigned int    x,
+    unsigned int    y,
+    unsigned int    width,
+    unsigned int    height,
+    unsigned int    downsample
+)
+{
+    if ( !IsStreamOpen() || downsample == 0 )
+    { return false; }
+
+    const unsigned int dstW = GetDownsampledSize( width,  downsample );
+    const unsigned int dstH = GetDownsampledSize( height, downsample );
+    const unsigned long long imageSize = static_cast<unsigned long long>( dstW ) * dstH * m_BytePerPixel;
+    if ( imageSize == 0 || imageSize > 0xffffffff )
+    {
+        std::cerr << "Error : Invalid Region Size." << std::endl;
+        return false;
+    }
+
+    unsigned char* pImageData = new(std::nothrow) unsigned char [size_t( imageSize )];
+    if ( pImageData == nullptr )
+    {
+        std::cerr << "Error : Memory Allocate Faied." << std::endl;
+        return false;
+    }
+
+    if ( !ReadRegion( x, y, width, height, pImageData, downsample ) )
+    {
+        std::cerr << "Error : Read Region Failed." << std::endl;
+        delete[] pImageData;
+        return false;
+    }
+
+    if ( m_pImageData )
+    { delete[] m_pImageData; }
+
+    // 領域ごとに内容が異なるので，ファイル全体に対するキャッシュは使わない.
+    m_Cache.Close();
+
+    m_pImageData = pImageData;
+    m_Width      = dstW;
+    m_Height     = dstH;
+    m_ImageSize  = static_cast<unsigned int>( imageSize );
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      領域読み込み用に開いた元画像の横幅を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int RawImage::GetSourceWidth() const
+{ return m_SourceWidth; }
+
+//-------------------------------------------------------------------------------------------
+//      領域読み込み用に開いた元画像の縦幅を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int RawImage::GetSourceHeight() const
+{ return m_SourceHeight; }
+
+//-------------------------------------------------------------------------------------------
+//      縮小後のサイズを取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int RawImage::GetDownsampledSize( unsigned int size, unsigned int downsample )
+{
+    if ( downsample == 0 )
+    { return 0; }
+
+    return ( size / downsample ) + ( ( size % downsample ) ? 1 : 0 );
+}
@@ -0,0 +1,142 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : RawTileIterator.cpp
+// Desc : Raw Texture Tile Iterator.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <RawTileIterator.h>
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// RawTileIterator class
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------
+RawTileIterator::RawTileIterator( const RawImage& image, unsigned int tileSize, unsigned int downsample )
+: m_Image       ( image )
+, m_TileSize    ( 0 )
+, m_Downsample  ( ( downsample > 0 ) ? downsample : 1 )
+, m_NextX       ( 0 )
+, m_NextY       ( 0 )
+, m_X           ( 0 )
+, m_Y           ( 0 )
+, m_Width       ( 0 )
+, m_Height      ( 0 )
+, m_Failed      ( false )
+{
+    // 縮小後のタイル境界が揃うように縮小率の倍数に切り上げる.
+    m_TileSize = ( tileSize > 0 ) ? tileSize : 1;
+    m_TileSize = ( ( m_TileSize + m_Downsample - 1 ) / m_Downsample ) * m_Downsample;
+
+    const unsigned int dstTile = m_TileSize / m_Downsample;
+    m_Buffer.resize( size_t( dstTile ) * dstTile * image.GetBytePerPixel() );
+}
+
+//-------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------
+RawTileIterator::~RawTileIterator()
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------
+//      次のタイルを読み込みます.
+//-------------------------------------------------------------------------------------------
+bool RawTileIterator::Next()
+{
+    const unsigned int srcW = m_Image.GetSourceWidth();
+    const unsigned int srcH = m_Image.GetSourceHeight();
+
+    if ( m_Failed || !m_Image.IsStreamOpen() || m_NextY >= srcH || m_Buffer.empty() )
+    { return false; }
+
+    const unsigned int tileW = ( srcW - m_NextX < m_TileSize ) ? srcW - m_NextX : m_TileSize;
+    const unsigned int tileH = ( srcH - m_NextY < m_TileSize ) ? srcH - m_NextY : m_TileSize;
+
+    if ( !m_Image.ReadRegion( m_NextX, m_NextY, tileW, tileH, &m_Buffer[0], m_Downsample ) )
+    {
+        m_Failed = true;
+        return false;
+    }
+
+    m_X      = m_NextX;
+    m_Y      = m_NextY;
+    m_Width  = RawImage::GetDownsampledSize( tileW, m_Downsample );
+    m_Height = RawImage::GetDownsampledSize( tileH, m_Downsample );
+
+    // 行優先で次のタイルへ進める.
+    m_NextX += tileW;
+    if ( m_NextX >= srcW )
+    {
+        m_NextX  = 0;
+        m_NextY += tileH;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      走査を先頭に戻します.
+//-------------------------------------------------------------------------------------------
+void RawTileIterator::Reset()
+{
+    m_NextX  = 0;
+    m_NextY  = 0;
+    m_X      = 0;
+    m_Y      = 0;
+    m_Width  = 0;
+    m_Height = 0;
+    m_Failed = false;
+}
+
+//-------------------------------------------------------------------------------------------
+//      読み込みに失敗したかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool RawTileIterator::IsFailed() const
+{ return m_Failed; }
+
+//-------------------------------------------------------------------------------------------
+//      現在のタイルの元画像上の横座標を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int RawTileIterator::GetX() const
+{ return m_X; }
+
+//-------------------------------------------------------------------------------------------
+//      現在のタイルの元画像上の縦座標を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int RawTileIterator::GetY() const
+{ return m_Y; }
+
+//-------------------------------------------------------------------------------------------
+//      現在のタイルの縮小後の横幅を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int RawTileIterator::GetWidth() const
+{ return m_Width; }
+
+//-------------------------------------------------------------------------------------------
+//      現在のタイルの縮小後の縦幅を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int RawTileIterator::GetHeight() const
+{ return m_Height; }
+
+//-------------------------------------------------------------------------------------------
+//      現在のタイルの縮小後の出力先での横座標を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int RawTileIterator::GetDstX() const
+{ return m_X / m_Downsample; }
+
+//-------------------------------------------------------------------------------------------
+//      現在のタイルの縮小後の出力先での縦座標を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int RawTileIterator::GetDstY() const
+{ return m_Y / m_Downsample; }
+
+//-------------------------------------------------------------------------------------------
+//      現在のタイルのピクセルデータを取得します.
+//-------------------------------------------------------------------------------------------
+const unsigned char* RawTileIterator::GetPixels() const
+{ return m_Buffer.empty() ? nullptr : &m_Buffer[0]; }
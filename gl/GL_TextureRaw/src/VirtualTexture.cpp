@@ -0,0 +1,854 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : VirtualTexture.cpp
+// Desc : Virtual Texture Page Cache.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <VirtualTexture.h>
+#include <GL/glut.h>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+const unsigned int  TOP_SLOT    = 0;        //!< 最も粗いミップレベルのページを常駐させる物理ページ番号です.
+
+
+//-------------------------------------------------------------------------------------------
+//      ページIDを生成します.
+//-------------------------------------------------------------------------------------------
+inline unsigned long long MakePageId( unsigned int mipLevel, unsigned int pageX, unsigned int pageY )
+{
+    return ( static_cast<unsigned long long>( mipLevel ) << 56 )
+         | ( static_cast<unsigned long long>( pageY & 0xfffffff ) << 28 )
+         | ( static_cast<unsigned long long>( pageX & 0xfffffff ) );
+}
+
+//-------------------------------------------------------------------------------------------
+//      ページIDからミップレベルを取得します.
+//-------------------------------------------------------------------------------------------
+inline unsigned int GetPageMip( unsigned long long pageId )
+{ return static_cast<unsigned int>( pageId >> 56 ); }
+
+//-------------------------------------------------------------------------------------------
+//      ページIDから横方向の番号を取得します.
+//-------------------------------------------------------------------------------------------
+inline unsigned int GetPageX( unsigned long long pageId )
+{ return static_cast<unsigned int>( pageId & 0xfffffff ); }
+
+//-------------------------------------------------------------------------------------------
+//      ページIDから縦方向の番号を取得します.
+//-------------------------------------------------------------------------------------------
+inline unsigned int GetPageY( unsigned long long pageId )
+{ return static_cast<unsigned int>( ( pageId >> 28 ) & 0xfffffff ); }
+
+//-------------------------------------------------------------------------------------------
+//      指定ミップレベルの画像サイズを取得します.
+//-------------------------------------------------------------------------------------------
+inline unsigned int GetMipSize( unsigned int size, unsigned int mipLevel )
+{ return RawImage::GetDownsampledSize( size, 1u << mipLevel ); }
+
+//-------------------------------------------------------------------------------------------
+//      指定サイズを覆うページ数を取得します.
+//-------------------------------------------------------------------------------------------
+inline unsigned int GetPageCount( unsigned int size, unsigned int pageSize )
+{ return ( size + pageSize - 1 ) / pageSize; }
+
+//-------------------------------------------------------------------------------------------
+//      ミップレベル0のページ数を覆う2の累乗の一辺を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int ComputeIndirectionSize( unsigned int width, unsigned int height, unsigned int pageSize, unsigned int& mipCount )
+{
+    const unsigned int pagesX = GetPageCount( width,  pageSize );
+    const unsigned int pagesY = GetPageCount( height, pageSize );
+    const unsigned int pages  = ( pagesX > pagesY ) ? pagesX : pagesY;
+
+    unsigned int size = 1;
+    mipCount = 1;
+    while( size < pages )
+    {
+        size <<= 1;
+        mipCount++;
+    }
+
+    return size;
+}
+
+} // namespace /* anonymous */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// VirtualTexture class
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------
+VirtualTexture::VirtualTexture()
+: m_Desc            ()
+, m_MipCount        ( 0 )
+, m_IndirectionSize ( 0 )
+, m_FrameIndex      ( 0 )
+, m_Dirty           ( false )
+, m_PhysicalID      ( 0 )
+, m_IndirectionID   ( 0 )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------
+VirtualTexture::~VirtualTexture()
+{ Term(); }
+
+//-------------------------------------------------------------------------------------------
+//      元画像をページに分割したページファイルを作成します.
+//-------------------------------------------------------------------------------------------
+bool VirtualTexture::BuildPageFile
+(
+    const RawImage& source,
+    const char*     pageFilename,
+    unsigned int    pageSize,
+    unsigned int    border
+)
+{
+    if ( !source.IsStreamOpen() || pageSize == 0 )
+    { return false; }
+
+    const unsigned int width     = source.GetSourceWidth();
+    const unsigned int height    = source.GetSourceHeight();
+    const unsigned int bpp       = source.GetBytePerPixel();
+    const unsigned int pageWidth = pageSize + border * 2;
+
+    unsigned int mipCount = 0;
+    ComputeIndirectionSize( width, height, pageSize, mipCount );
+
+    std::ofstream file( pageFilename, std::ios::out | std::ios::binary );
+    if ( !file.is_open() )
+    {
+        std::cerr << "Error : File Open Failed.";
+        std::cerr << "File Name : " << pageFilename << std::endl;
+        return false;
+    }
+
+    std::vector<unsigned char> page( size_t( pageWidth ) * pageWidth * bpp );
+    std::vector<unsigned char> region( page.size() );
+
+    for( unsigned int m=0; m<mipCount; ++m )
+    {
+        const unsigned int downsample = 1u << m;
+        const unsigned int mipW       = GetMipSize( width,  m );
+        const unsigned int mipH       = GetMipSize( height, m );
+        const unsigned int pagesX     = GetPageCount( mipW, pageSize );
+        const unsigned int pagesY     = GetPageCount( mipH, pageSize );
+
+        for( unsigned int py=0; py<pagesY; ++py )
+        {
+            for( unsigned int px=0; px<pagesX; ++px )
+            {
+                // ボーダー込みの範囲をミップレベルの画像内にクランプして読み込む.
+                const int x0 = int( px * pageSize ) - int( border );
+                const int y0 = int( py * pageSize ) - int( border );
+                const unsigned int cx0 = static_cast<unsigned int>( std::max( x0, 0 ) );
+                const unsigned int cy0 = static_cast<unsigned int>( std::max( y0, 0 ) );
+                const unsigned int cx1 = std::min( static_cast<unsigned int>( x0 + int( pageWidth ) ), mipW );
+                const unsigned int cy1 = std::min( static_cast<unsigned int>( y0 + int( pageWidth ) ), mipH );
+                const unsigned int regionW = cx1 - cx0;
+
+                const unsigned int sx = cx0 * downsample;
+                const unsigned int sy = cy0 * downsample;
+                const unsigned int sw = std::min( cx1 * downsample, width  ) - sx;
+                const unsigned int sh = std::min( cy1 * downsample, height ) - sy;
+
+                if ( !source.ReadRegion( sx, sy, sw, sh, &region[0], downsample ) )
+                {
+                    std::cerr << "Error : Read Region Failed." << std::endl;
+                    return false;
+                }
+
+                // 画像の外側は端のテクセルを複製する.
+                for( unsigned int j=0; j<pageWidth; ++j )
+                {
+                    const int my = std::min( std::max( y0 + int( j ), int( cy0 ) ), int( cy1 ) - 1 );
+                    const unsigned char* pRow = &region[size_t( my - int( cy0 ) ) * regionW * bpp];
+                    for( unsigned int i=0; i<pageWidth; ++i )
+                    {
+                        const int mx = std::min( std::max( x0 + int( i ), int( cx0 ) ), int( cx1 ) - 1 );
+                        const unsigned char* pSrc = pRow + size_t( mx - int( cx0 ) ) * bpp;
+                        unsigned char*       pDst = &page[( size_t( j ) * pageWidth + i ) * bpp];
+                        for( unsigned int c=0; c<bpp; ++c )
+                        { pDst[c] = pSrc[c]; }
+                    }
+                }
+
+                file.write( reinterpret_cast<const char*>( &page[0] ), std::streamsize( page.size() ) );
+                if ( !file )
+                {
+                    std::cerr << "Error : File Write Failed." << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      初期化処理を行います.
+//-------------------------------------------------------------------------------------------
+bool VirtualTexture::Init( const VirtualTextureDesc& desc )
+{
+    Term();
+
+    const unsigned int slotCount = desc.physicalPagesX * desc.physicalPagesY;
+    if ( desc.width == 0 || desc.height == 0 || desc.pageSize == 0
+      || ( desc.bytePerPixel != 3 && desc.bytePerPixel != 4 )
+      || desc.physicalPagesX > 256 || desc.physicalPagesY > 256
+      || slotCount < 2 )
+    {
+        std::cerr << "Error : Invalid Virtual Texture Desc." << std::endl;
+        return false;
+    }
+
+    m_Desc            = desc;
+    m_IndirectionSize = ComputeIndirectionSize( desc.width, desc.height, desc.pageSize, m_MipCount );
+
+    // ページファイル上の各ミップレベルの先頭ページ番号.
+    m_PageBase.resize( m_MipCount + 1 );
+    m_PageBase[0] = 0;
+    for( unsigned int m=0; m<m_MipCount; ++m )
+    {
+        m_PageBase[m + 1] = m_PageBase[m]
+            + static_cast<unsigned long long>( GetPageCountX( m ) ) * GetPageCountY( m );
+    }
+
+    m_Indirection.resize( m_MipCount );
+    for( unsigned int m=0; m<m_MipCount; ++m )
+    {
+        const unsigned int size = GetIndirectionSize( m );
+        m_Indirection[m].assign( size_t( size ) * size * 4, 0 );
+    }
+
+    // 先頭の物理ページは最も粗いミップレベルのページ専用とし，追い出さない.
+    // 未常駐のページは必ずこのページまで親をたどって代替できる.
+    m_Slots.resize( slotCount );
+    for( unsigned int i=0; i<slotCount; ++i )
+    {
+        m_Slots[i].pageId    = 0;
+        m_Slots[i].lastFrame = 0;
+        m_Slots[i].used      = false;
+        if ( i != TOP_SLOT )
+        { m_Slots[i].lruItr = m_LRU.insert( m_LRU.end(), i ); }
+    }
+
+    const unsigned long long topId = MakePageId( m_MipCount - 1, 0, 0 );
+    m_Slots[TOP_SLOT].pageId = topId;
+    m_Slots[TOP_SLOT].used   = true;
+    m_Resident[topId]        = TOP_SLOT;
+
+    m_Dirty = true;
+    UpdateIndirection();
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      ページファイルを開きます.
+//-------------------------------------------------------------------------------------------
+bool VirtualTexture::OpenPageFile( const char* pageFilename )
+{
+    if ( m_MipCount == 0 )
+    { return false; }
+
+    const unsigned int       pageWidth  = m_Desc.pageSize + m_Desc.border * 2;
+    const unsigned long long fileHeight = m_PageBase[m_MipCount] * pageWidth;
+    if ( fileHeight > 0xffffffff )
+    {
+        std::cerr << "Error : Page File Is Too Large." << std::endl;
+        return false;
+    }
+
+    if ( !m_PageFile.OpenStream( pageFilename, pageWidth, static_cast<unsigned int>( fileHeight ), ( m_Desc.bytePerPixel == 4 ) ) )
+    { return false; }
+
+    m_PageBuffer.resize( size_t( pageWidth ) * pageWidth * m_Desc.bytePerPixel );
+
+    // 既に常駐扱いのページに中身を読み込む.
+    for( std::unordered_map<unsigned long long, unsigned int>::const_iterator itr = m_Resident.begin();
+         itr != m_Resident.end();
+         ++itr )
+    {
+        if ( !LoadPage( itr->first, itr->second ) )
+        { return false; }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      終了処理を行います.
+//-------------------------------------------------------------------------------------------
+void VirtualTexture::Term()
+{
+    DeleteGLTexture();
+    m_PageFile.Release();
+
+    m_PageBase.clear();
+    m_Indirection.clear();
+    m_Slots.clear();
+    m_LRU.clear();
+    m_Resident.clear();
+    m_Requested.clear();
+    m_Pending.clear();
+    m_PageBuffer.clear();
+
+    m_Stats           = VirtualTextureStats();
+    m_MipCount        = 0;
+    m_IndirectionSize = 0;
+    m_FrameIndex      = 0;
+    m_Dirty           = false;
+}
+
+//-------------------------------------------------------------------------------------------
+//      物理テクスチャと間接参照テクスチャを生成します.
+//-------------------------------------------------------------------------------------------
+bool VirtualTexture::CreateGLTexture()
+{
+    if ( m_MipCount == 0 )
+    { return false; }
+
+    DeleteGLTexture();
+
+    const unsigned int pageWidth = m_Desc.pageSize + m_Desc.border * 2;
+    const unsigned int format    = ( m_Desc.bytePerPixel == 4 ) ? GL_RGBA : GL_RGB;
+
+    // 物理テクスチャ. ページ境界はボーダーがあるのでバイリニアで参照できる.
+    glGenTextures( 1, &m_PhysicalID );
+    glBindTexture( GL_TEXTURE_2D, m_PhysicalID );
+    glTexImage2D(
+        GL_TEXTURE_2D,
+        0,
+        format,
+        m_Desc.physicalPagesX * pageWidth,
+        m_Desc.physicalPagesY * pageWidth,
+        0,
+        format,
+        GL_UNSIGNED_BYTE,
+        nullptr );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP );
+
+    // 間接参照テクスチャ. 要素をそのまま引くので補間しない.
+    glGenTextures( 1, &m_IndirectionID );
+    glBindTexture( GL_TEXTURE_2D, m_IndirectionID );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+    for( unsigned int m=0; m<m_MipCount; ++m )
+    {
+        const unsigned int size = GetIndirectionSize( m );
+        glTexImage2D( GL_TEXTURE_2D, int( m ), GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, &m_Indirection[m][0] );
+    }
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST );
+
+    glBindTexture( GL_TEXTURE_2D, 0 );
+
+    // 常駐済みのページを転送しなおす.
+    if ( m_PageFile.IsStreamOpen() )
+    {
+        for( std::unordered_map<unsigned long long, unsigned int>::const_iterator itr = m_Resident.begin();
+             itr != m_Resident.end();
+             ++itr )
+        {
+            if ( !LoadPage( itr->first, itr->second ) )
+            {
+                DeleteGLTexture();
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      物理テクスチャと間接参照テクスチャを破棄します.
+//-------------------------------------------------------------------------------------------
+void VirtualTexture::DeleteGLTexture()
+{
+    if ( m_PhysicalID )
+    {
+        glDeleteTextures( 1, &m_PhysicalID );
+        m_PhysicalID = 0;
+    }
+
+    if ( m_IndirectionID )
+    {
+        glDeleteTextures( 1, &m_IndirectionID );
+        m_IndirectionID = 0;
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      フレームの開始処理です.
+//-------------------------------------------------------------------------------------------
+void VirtualTexture::BeginFrame()
+{
+    m_FrameIndex++;
+    m_Requested.clear();
+    m_Pending.clear();
+}
+
+//-------------------------------------------------------------------------------------------
+//      ページを要求します.
+//-------------------------------------------------------------------------------------------
+void VirtualTexture::Request( unsigned int mipLevel, unsigned int pageX, unsigned int pageY )
+{
+    if ( mipLevel >= m_MipCount
+      || pageX >= GetPageCountX( mipLevel )
+      || pageY >= GetPageCountY( mipLevel ) )
+    { return; }
+
+    const unsigned long long pageId = MakePageId( mipLevel, pageX, pageY );
+
+    // 同一フレーム内の重複要求は数えない.
+    if ( !m_Requested.insert( pageId ).second )
+    { return; }
+
+    m_Stats.requestCount++;
+
+    std::unordered_map<unsigned long long, unsigned int>::const_iterator itr = m_Resident.find( pageId );
+    if ( itr != m_Resident.end() )
+    {
+        m_Stats.hitCount++;
+
+        Slot& slot = m_Slots[itr->second];
+        slot.lastFrame = m_FrameIndex;
+        if ( itr->second != TOP_SLOT )
+        { m_LRU.splice( m_LRU.begin(), m_LRU, slot.lruItr ); }
+    }
+    else
+    {
+        m_Stats.missCount++;
+        m_Pending.push_back( pageId );
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      可視領域のフットプリントから必要なページを要求します.
+//-------------------------------------------------------------------------------------------
+unsigned int VirtualTexture::RequestFootprint( const VirtualTextureFootprint& footprint, float mipBias )
+{
+    if ( m_MipCount == 0 )
+    { return 0; }
+
+    const float minU = std::min( std::max( std::min( footprint.minU, footprint.maxU ), 0.0f ), 1.0f );
+    const float maxU = std::min( std::max( std::max( footprint.minU, footprint.maxU ), 0.0f ), 1.0f );
+    const float minV = std::min( std::max( std::min( footprint.minV, footprint.maxV ), 0.0f ), 1.0f );
+    const float maxV = std::min( std::max( std::max( footprint.minV, footprint.maxV ), 0.0f ), 1.0f );
+
+    // 1ピクセルあたりのテクセル数からミップレベルを選ぶ.
+    const float texelsX = ( maxU - minU ) * m_Desc.width;
+    const float texelsY = ( maxV - minV ) * m_Desc.height;
+    const float density = std::max(
+        texelsX / std::max( footprint.pixelWidth,  1.0f ),
+        texelsY / std::max( footprint.pixelHeight, 1.0f ) );
+
+    const float lod = ( density > 0.0f )
+        ? static_cast<float>( log( double( density ) ) / log( 2.0 ) ) + mipBias
+        : 0.0f;
+
+    unsigned int mipLevel = ( lod > 0.0f ) ? static_cast<unsigned int>( lod ) : 0;
+    if ( mipLevel >= m_MipCount )
+    { mipLevel = m_MipCount - 1; }
+
+    const unsigned int mipW   = GetMipSize( m_Desc.width,  mipLevel );
+    const unsigned int mipH   = GetMipSize( m_Desc.height, mipLevel );
+    const unsigned int pagesX = GetPageCountX( mipLevel );
+    const unsigned int pagesY = GetPageCountY( mipLevel );
+
+    const unsigned int px0 = std::min( static_cast<unsigned int>( minU * mipW ) / m_Desc.pageSize, pagesX - 1 );
+    const unsigned int py0 = std::min( static_cast<unsigned int>( minV * mipH ) / m_Desc.pageSize, pagesY - 1 );
+    const unsigned int px1 = std::min( static_cast<unsigned int>( ceil( maxU * mipW ) ) / m_Desc.pageSize, pagesX - 1 );
+    const unsigned int py1 = std::min( static_cast<unsigned int>( ceil( maxV * mipH ) ) / m_Desc.pageSize, pagesY - 1 );
+
+    for( unsigned int y=py0; y<=py1; ++y )
+    {
+        for( unsigned int x=px0; x<=px1; ++x )
+        { Request( mipLevel, x, y ); }
+    }
+
+    return mipLevel;
+}
+
+//-------------------------------------------------------------------------------------------
+//      要求されたページを読み込み，間接参照テーブルを更新します.
+//-------------------------------------------------------------------------------------------
+unsigned int VirtualTexture::Update( unsigned int maxLoadCount )
+{
+    if ( m_MipCount == 0 )
+    { return 0; }
+
+    // 粗いミップレベルを優先すると，読み込みが追いつかない間も代替ページの解像度が早く上がる.
+    std::sort( m_Pending.begin(), m_Pending.end(), []( unsigned long long lhs, unsigned long long rhs )
+    {
+        if ( GetPageMip( lhs ) != GetPageMip( rhs ) )
+        { return GetPageMip( lhs ) > GetPageMip( rhs ); }
+        return lhs < rhs;
+    });
+
+    unsigned int loadCount = 0;
+    size_t       index     = 0;
+
+    for( ; index<m_Pending.size(); ++index )
+    {
+        if ( loadCount >= maxLoadCount )
+        { break; }
+
+        // 最も長く使われていない物理ページを再利用する.
+        // それすら今フレームで要求されているなら，物理ページが足りていない.
+        const unsigned int slotIndex = m_LRU.back();
+        Slot& slot = m_Slots[slotIndex];
+        if ( slot.used && slot.lastFrame == m_FrameIndex )
+        { break; }
+
+        if ( slot.used )
+        {
+            m_Resident.erase( slot.pageId );
+            slot.used = false;
+            m_Stats.evictionCount++;
+            m_Dirty = true;
+        }
+
+        const unsigned long long pageId = m_Pending[index];
+        if ( !LoadPage( pageId, slotIndex ) )
+        {
+            m_Stats.deferredCount++;
+            continue;
+        }
+
+        slot.pageId    = pageId;
+        slot.lastFrame = m_FrameIndex;
+        slot.used      = true;
+        m_LRU.splice( m_LRU.begin(), m_LRU, slot.lruItr );
+        m_Resident[pageId] = slotIndex;
+
+        m_Stats.loadCount++;
+        loadCount++;
+        m_Dirty = true;
+    }
+
+    m_Stats.deferredCount += m_Pending.size() - index;
+    m_Pending.clear();
+
+    UpdateIndirection();
+
+    return loadCount;
+}
+
+//-------------------------------------------------------------------------------------------
+//      ページを物理ページに読み込みます.
+//-------------------------------------------------------------------------------------------
+bool VirtualTexture::LoadPage( unsigned long long pageId, unsigned int slot )
+{
+    // ページファイルが無い場合は常駐管理のみ行う.
+    if ( !m_PageFile.IsStreamOpen() )
+    { return true; }
+
+    const unsigned int       mipLevel  = GetPageMip( pageId );
+    const unsigned int       pageWidth = m_Desc.pageSize + m_Desc.border * 2;
+    const unsigned long long index     = m_PageBase[mipLevel]
+        + static_cast<unsigned long long>( GetPageY( pageId ) ) * GetPageCountX( mipLevel )
+        + GetPageX( pageId );
+
+    if ( !m_PageFile.ReadRegion( 0, static_cast<unsigned int>( index * pageWidth ), pageWidth, pageWidth, &m_PageBuffer[0] ) )
+    {
+        std::cerr << "Error : Read Page Failed." << std::endl;
+        return false;
+    }
+
+    if ( m_PhysicalID != 0 )
+    {
+        glBindTexture( GL_TEXTURE_2D, m_PhysicalID );
+        glPixelStorei( GL_UNPACK_ALIGNMENT, ( m_Desc.bytePerPixel == 4 ) ? 4 : 1 );
+        glTexSubImage2D(
+            GL_TEXTURE_2D,
+            0,
+            ( slot % m_Desc.physicalPagesX ) * pageWidth,
+            ( slot / m_Desc.physicalPagesX ) * pageWidth,
+            pageWidth,
+            pageWidth,
+            ( m_Desc.bytePerPixel == 4 ) ? GL_RGBA : GL_RGB,
+            GL_UNSIGNED_BYTE,
+            &m_PageBuffer[0] );
+        glBindTexture( GL_TEXTURE_2D, 0 );
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      間接参照テーブルを更新します.
+//-------------------------------------------------------------------------------------------
+void VirtualTexture::UpdateIndirection()
+{
+    if ( !m_Dirty )
+    { return; }
+
+    // 粗いミップレベルから順に，未常駐の要素には親の要素を引き継ぐ.
+    for( int m=int( m_MipCount ) - 1; m>=0; --m )
+    {
+        const unsigned int size = GetIndirectionSize( m );
+        std::vector<unsigned char>& table = m_Indirection[m];
+
+        for( unsigned int y=0; y<size; ++y )
+        {
+            for( unsigned int x=0; x<size; ++x )
+            {
+                unsigned char* pEntry = &table[( size_t( y ) * size + x ) * 4];
+
+                std::unordered_map<unsigned long long, unsigned int>::const_iterator itr
+                    = m_Resident.find( MakePageId( m, x, y ) );
+                if ( itr != m_Resident.end() )
+                {
+                    pEntry[0] = static_cast<unsigned char>( itr->second % m_Desc.physicalPagesX );
+                    pEntry[1] = static_cast<unsigned char>( itr->second / m_Desc.physicalPagesX );
+                    pEntry[2] = static_cast<unsigned char>( m );
+                    pEntry[3] = 255;
+                }
+                else if ( m + 1 < int( m_MipCount ) )
+                {
+                    const unsigned int parentSize = GetIndirectionSize( m + 1 );
+                    const unsigned char* pParent = &m_Indirection[m + 1][( size_t( y / 2 ) * parentSize + x / 2 ) * 4];
+                    pEntry[0] = pParent[0];
+                    pEntry[1] = pParent[1];
+                    pEntry[2] = pParent[2];
+                    pEntry[3] = pParent[3];
+                }
+                else
+                {
+                    pEntry[0] = pEntry[1] = pEntry[2] = pEntry[3] = 0;
+                }
+            }
+        }
+    }
+
+    if ( m_IndirectionID != 0 )
+    {
+        glBindTexture( GL_TEXTURE_2D, m_IndirectionID );
+        glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+        for( unsigned int m=0; m<m_MipCount; ++m )
+        {
+            const unsigned int size = GetIndirectionSize( m );
+            glTexSubImage2D( GL_TEXTURE_2D, int( m ), 0, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE, &m_Indirection[m][0] );
+        }
+        glBindTexture( GL_TEXTURE_2D, 0 );
+    }
+
+    m_Dirty = false;
+}
+
+//-------------------------------------------------------------------------------------------
+//      ページが常駐しているかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool VirtualTexture::IsResident( unsigned int mipLevel, unsigned int pageX, unsigned int pageY ) const
+{ return m_Resident.find( MakePageId( mipLevel, pageX, pageY ) ) != m_Resident.end(); }
+
+//-------------------------------------------------------------------------------------------
+//      常駐しているページ数を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int VirtualTexture::GetResidentCount() const
+{ return static_cast<unsigned int>( m_Resident.size() ); }
+
+//-------------------------------------------------------------------------------------------
+//      ミップレベル数を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int VirtualTexture::GetMipCount() const
+{ return m_MipCount; }
+
+//-------------------------------------------------------------------------------------------
+//      指定ミップレベルの横方向のページ数を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int VirtualTexture::GetPageCountX( unsigned int mipLevel ) const
+{ return GetPageCount( GetMipSize( m_Desc.width, mipLevel ), m_Desc.pageSize ); }
+
+//-------------------------------------------------------------------------------------------
+//      指定ミップレベルの縦方向のページ数を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int VirtualTexture::GetPageCountY( unsigned int mipLevel ) const
+{ return GetPageCount( GetMipSize( m_Desc.height, mipLevel ), m_Desc.pageSize ); }
+
+//-------------------------------------------------------------------------------------------
+//      指定ミップレベルの間接参照テーブルの一辺の要素数を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int VirtualTexture::GetIndirectionSize( unsigned int mipLevel ) const
+{ return ( mipLevel < m_MipCount ) ? ( m_IndirectionSize >> mipLevel ) : 0; }
+
+//-------------------------------------------------------------------------------------------
+//      指定ミップレベルの間接参照テーブルを取得します.
+//-------------------------------------------------------------------------------------------
+const unsigned char* VirtualTexture::GetIndirection( unsigned int mipLevel ) const
+{ return ( mipLevel < m_MipCount ) ? &m_Indirection[mipLevel][0] : nullptr; }
+
+//-------------------------------------------------------------------------------------------
+//      統計情報を取得します.
+//-------------------------------------------------------------------------------------------
+const VirtualTextureStats& VirtualTexture::GetStats() const
+{ return m_Stats; }
+
+//-------------------------------------------------------------------------------------------
+//      統計情報をリセットします.
+//-------------------------------------------------------------------------------------------
+void VirtualTexture::ResetStats()
+{ m_Stats = VirtualTextureStats(); }
+
+//-------------------------------------------------------------------------------------------
+//      物理テクスチャのIDを取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int VirtualTexture::GetPhysicalTextureID() const
+{ return m_PhysicalID; }
+
+//-------------------------------------------------------------------------------------------
+//      間接参照テクスチャのIDを取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int VirtualTexture::GetIndirectionTextureID() const
+{ return m_IndirectionID; }
+
+//-------------------------------------------------------------------------------------------
+//      GLの変換行列から四角形のフットプリントを計算します.
+//-------------------------------------------------------------------------------------------
+bool VirtualTexture::ComputeFootprint
+(
+    const double*               pModelView,
+    const double*               pProjection,
+    int                         viewportWidth,
+    int                         viewportHeight,
+    const float                 positions[4][3],
+    const float                 texcoords[4][2],
+    VirtualTextureFootprint&    result
+)
+{
+    float uvMin[2] = { texcoords[0][0], texcoords[0][1] };
+    float uvMax[2] = { texcoords[0][0], texcoords[0][1] };
+    for( int i=1; i<4; ++i )
+    {
+        for( int k=0; k<2; ++k )
+        {
+            uvMin[k] = std::min( uvMin[k], texcoords[i][k] );
+            uvMax[k] = std::max( uvMax[k], texcoords[i][k] );
+        }
+    }
+
+    // 頂点をウィンドウ座標に変換する.
+    double screen[4][2];
+    for( int i=0; i<4; ++i )
+    {
+        double view[4];
+        for( int r=0; r<4; ++r )
+        {
+            view[r] = pModelView[r +  0] * positions[i][0]
+                    + pModelView[r +  4] * positions[i][1]
+                    + pModelView[r +  8] * positions[i][2]
+                    + pModelView[r + 12];
+        }
+
+        double clip[4];
+        for( int r=0; r<4; ++r )
+        {
+            clip[r] = pProjection[r +  0] * view[0]
+                    + pProjection[r +  4] * view[1]
+                    + pProjection[r +  8] * view[2]
+                    + pProjection[r + 12] * view[3];
+        }
+
+        // 視点の後ろに頂点がある場合は保守的に四角形全体を最大解像度で要求する.
+        if ( clip[3] <= 1e-6 )
+        {
+            result.minU        = uvMin[0];
+            result.minV        = uvMin[1];
+            result.maxU        = uvMax[0];
+            result.maxV        = uvMax[1];
+            result.pixelWidth  = float( viewportWidth );
+            result.pixelHeight = float( viewportHeight );
+            return true;
+        }
+
+        screen[i][0] = ( clip[0] / clip[3] * 0.5 + 0.5 ) * viewportWidth;
+        screen[i][1] = ( clip[1] / clip[3] * 0.5 + 0.5 ) * viewportHeight;
+    }
+
+    double sMin[2] = { screen[0][0], screen[0][1] };
+    double sMax[2] = { screen[0][0], screen[0][1] };
+    for( int i=1; i<4; ++i )
+    {
+        for( int k=0; k<2; ++k )
+        {
+            sMin[k] = std::min( sMin[k], screen[i][k] );
+            sMax[k] = std::max( sMax[k], screen[i][k] );
+        }
+    }
+
+    // ビューポートでクリップする.
+    const double vMin[2] = { std::max( sMin[0], 0.0 ), std::max( sMin[1], 0.0 ) };
+    const double vMax[2] = { std::min( sMax[0], double( viewportWidth ) ), std::min( sMax[1], double( viewportHeight ) ) };
+    if ( vMin[0] >= vMax[0] || vMin[1] >= vMax[1] )
+    { return false; }
+
+    // 頂点0,1,3からテクスチャ座標→画面座標のアフィン変換を求め，逆変換でクリップ範囲をUVに戻す.
+    const double du1 = texcoords[1][0] - texcoords[0][0];
+    const double dv1 = texcoords[1][1] - texcoords[0][1];
+    const double du2 = texcoords[3][0] - texcoords[0][0];
+    const double dv2 = texcoords[3][1] - texcoords[0][1];
+    const double det = du1 * dv2 - du2 * dv1;
+    if ( fabs( det ) < 1e-12 )
+    { return false; }
+
+    // 画面座標 = A * ( uv - uv0 ) + s0
+    const double ds1x = screen[1][0] - screen[0][0];
+    const double ds1y = screen[1][1] - screen[0][1];
+    const double ds2x = screen[3][0] - screen[0][0];
+    const double ds2y = screen[3][1] - screen[0][1];
+    const double a00 = (  ds1x * dv2 - ds2x * dv1 ) / det;
+    const double a01 = ( -ds1x * du2 + ds2x * du1 ) / det;
+    const double a10 = (  ds1y * dv2 - ds2y * dv1 ) / det;
+    const double a11 = ( -ds1y * du2 + ds2y * du1 ) / det;
+
+    const double detA = a00 * a11 - a01 * a10;
+    if ( fabs( detA ) < 1e-12 )
+    { return false; }
+
+    double uMin = uvMax[0], uMax = uvMin[0];
+    double vMin2 = uvMax[1], vMax2 = uvMin[1];
+    for( int i=0; i<4; ++i )
+    {
+        const double sx = ( ( i & 1 ) ? vMax[0] : vMin[0] ) - screen[0][0];
+        const double sy = ( ( i & 2 ) ? vMax[1] : vMin[1] ) - screen[0][1];
+        const double u  = (  a11 * sx - a01 * sy ) / detA + texcoords[0][0];
+        const double v  = ( -a10 * sx + a00 * sy ) / detA + texcoords[0][1];
+        uMin  = std::min( uMin,  u );
+        uMax  = std::max( uMax,  u );
+        vMin2 = std::min( vMin2, v );
+        vMax2 = std::max( vMax2, v );
+    }
+
+    result.minU = float( std::max( uMin,  double( uvMin[0] ) ) );
+    result.maxU = float( std::min( uMax,  double( uvMax[0] ) ) );
+    result.minV = float( std::max( vMin2, double( uvMin[1] ) ) );
+    result.maxV = float( std::min( vMax2, double( uvMax[1] ) ) );
+
+    // UV方向それぞれの画面上の長さ(1UVあたりのピクセル数 * 可視UV幅).
+    result.pixelWidth  = float( sqrt( a00 * a00 + a10 * a10 ) * ( result.maxU - result.minU ) );
+    result.pixelHeight = float( sqrt( a01 * a01 + a11 * a11 ) * ( result.maxV - result.minV ) );
+
+    return true;
+}
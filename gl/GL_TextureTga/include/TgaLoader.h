@@ -7,6 +7,12 @@
 #ifndef _TGA_LOADER_H_
 #define _TGA_LOADER_H_
 
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <TextureCache.h>
+#include <ColorSpace.h>
+
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 // TgaImage class
@@ -67,6 +73,42 @@ public:
     //---------------------------------------------------------------------------------------
     unsigned int GetID() const;
 
+    //---------------------------------------------------------------------------------------
+    //! @brief      画像の横幅を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetWidth() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      画像の縦幅を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetHeight() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      1ピクセルあたりのバイト数を取得します.
+    //---------------------------------------------------------------------------------------
+    unsigned int GetBytePerPixel() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      RGB(A)に変換済みのピクセルデータを取得します.
+    //!
+    //! @note       キャッシュから読み込んだ場合はマップされたキャッシュファイル上のデータを返却します.
+    //---------------------------------------------------------------------------------------
+    const unsigned char* GetPixels() const;
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      色空間の情報を持たない画像をどの色空間として扱うかを設定します.
+    //!
+    //! @note       Load() の前に呼び出します. 既定値は COLOR_SPACE_SRGB です.
+    //!             sRGBの場合は線形空間でミップマップを生成し，sRGBの内部フォーマットで転送します.
+    //!             法線マップなどのデータテクスチャには COLOR_SPACE_LINEAR を指定します.
+    //---------------------------------------------------------------------------------------
+    void SetColorSpaceHint( COLOR_SPACE colorSpace );
+
+    //---------------------------------------------------------------------------------------
+    //! @brief      読み込んだ画像の色空間を取得します.
+    //---------------------------------------------------------------------------------------
+    COLOR_SPACE GetColorSpace() const;
+
 protected:
     //=======================================================================================
     // protected variables.
@@ -79,6 +121,9 @@ protected:
     unsigned int    m_BytePerPixel;     //!< 1ピクセルあたりのバイト数です.
     unsigned int    m_ID;               //!< テクスチャIDです.
     unsigned char*  m_pImageData;       //!< ピクセルデータです.
+    TextureCache    m_Cache;            //!< 変換済みテクスチャのキャッシュです.
+    COLOR_SPACE     m_ColorSpace;       //!< 読み込んだ画像の色空間です.
+    COLOR_SPACE     m_ColorSpaceHint;   //!< 色空間の情報を持たない画像に適用する色空間です.
 
     //=======================================================================================
     // protected methods.
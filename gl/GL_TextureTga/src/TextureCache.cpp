@@ -0,0 +1,458 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : TextureCache.cpp
+// Desc : Content Hashed Decoded Texture Cache.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <TextureCache.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif//WIN32_LEAN_AND_MEAN
+    #ifndef NOMINMAX
+    #define NOMINMAX
+    #endif//NOMINMAX
+    #include <Windows.h>
+    #include <direct.h>
+#else
+    #include <sys/stat.h>
+#endif
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+static const unsigned int       CACHE_MAGIC     = 'CTSA';   // ファイルマジック "ASTC".
+static const unsigned int       CACHE_VERSION   = 1;        // ファイルバージョン.
+static const unsigned int       CACHE_ALIGNMENT = 16;       // ピクセルデータのアライメント.
+
+// ミップ生成の設定を変えた場合はシードを変えて古いキャッシュを無効にする.
+static const unsigned long long CACHE_SEED      = 0x4153555241000002ULL;
+
+static const unsigned long long PRIME64_1 = 11400714785074694791ULL;
+static const unsigned long long PRIME64_2 = 14029467366897019727ULL;
+static const unsigned long long PRIME64_3 =  1609587929392839161ULL;
+static const unsigned long long PRIME64_4 =  9650029242287828579ULL;
+static const unsigned long long PRIME64_5 =  2870177450012600261ULL;
+
+
+//-------------------------------------------------------------------------------------------
+// Global Variables
+//-------------------------------------------------------------------------------------------
+std::string     g_CacheDirectory = "../res/cache";      // キャッシュの保存先.
+
+
+//-------------------------------------------------------------------------------------------
+//      64bit値を左回転します.
+//-------------------------------------------------------------------------------------------
+inline unsigned long long RotateLeft( unsigned long long value, int shift )
+{ return ( value << shift ) | ( value >> ( 64 - shift ) ); }
+
+//-------------------------------------------------------------------------------------------
+//      リトルエンディアンで64bit値を読み取ります.
+//-------------------------------------------------------------------------------------------
+inline unsigned long long Read64( const unsigned char* p )
+{
+    unsigned long long value;
+    memcpy( &value, p, sizeof(value) );
+    return value;
+}
+
+//-------------------------------------------------------------------------------------------
+//      リトルエンディアンで32bit値を読み取ります.
+//-------------------------------------------------------------------------------------------
+inline unsigned int Read32( const unsigned char* p )
+{
+    unsigned int value;
+    memcpy( &value, p, sizeof(value) );
+    return value;
+}
+
+//-------------------------------------------------------------------------------------------
+//      XXH64 の1ラウンドを計算します.
+//-------------------------------------------------------------------------------------------
+inline unsigned long long HashRound( unsigned long long acc, unsigned long long input )
+{
+    acc += input * PRIME64_2;
+    acc  = RotateLeft( acc, 31 );
+    acc *= PRIME64_1;
+    return acc;
+}
+
+//-------------------------------------------------------------------------------------------
+//      XXH64 のアキュムレータを合成します.
+//-------------------------------------------------------------------------------------------
+inline unsigned long long HashMerge( unsigned long long acc, unsigned long long value )
+{
+    acc ^= HashRound( 0, value );
+    acc  = acc * PRIME64_1 + PRIME64_4;
+    return acc;
+}
+
+//-------------------------------------------------------------------------------------------
+//      値をアライメントに切り上げます.
+//-------------------------------------------------------------------------------------------
+inline size_t AlignUp( size_t value, size_t alignment )
+{ return ( value + alignment - 1 ) & ~( alignment - 1 ); }
+
+//-------------------------------------------------------------------------------------------
+//      キャッシュファイル名を生成します.
+//-------------------------------------------------------------------------------------------
+std::string MakeCachePath( unsigned long long hash )
+{
+    char name[32];
+    sprintf_s( name, sizeof(name), "/%016llx.tcache", hash );
+    return g_CacheDirectory + name;
+}
+
+//-------------------------------------------------------------------------------------------
+//      一時ファイルで既存のファイルを置き換えます.
+//-------------------------------------------------------------------------------------------
+bool ReplaceCacheFile( const char* tempPath, const char* path )
+{
+#if defined(_WIN32)
+    // MSVC の rename() は既存のファイルを上書きしないので，古いキャッシュが残ってしまう.
+    return MoveFileExA( tempPath, path, MOVEFILE_REPLACE_EXISTING ) != FALSE;
+#else
+    return rename( tempPath, path ) == 0;
+#endif
+}
+
+} // namespace /* anonymous */
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// TextureCache::Header structure
+/////////////////////////////////////////////////////////////////////////////////////////////
+struct TextureCache::Header
+{
+    unsigned int        magic;              // ファイルマジック.
+    unsigned int        version;            // ファイルバージョン.
+    unsigned long long  hash;               // 元画像のハッシュ値.
+    unsigned int        width;              // 横幅.
+    unsigned int        height;             // 縦幅.
+    unsigned int        bytePerPixel;       // 1ピクセルあたりのバイト数.
+    unsigned int        format;             // GLのピクセルフォーマット.
+    unsigned int        internalFormat;     // GLの内部フォーマット.
+    unsigned int        mipCount;           // ミップレベル数. 直後に Level が mipCount 個続く.
+};
+
+
+//-------------------------------------------------------------------------------------------
+//      XXH64 ハッシュ値を計算します.
+//-------------------------------------------------------------------------------------------
+unsigned long long ComputeHash64( const void* pData, size_t size, unsigned long long seed )
+{
+    const unsigned char* p    = static_cast<const unsigned char*>( pData );
+    const unsigned char* pEnd = p + size;
+    unsigned long long   hash;
+
+    if ( size >= 32 )
+    {
+        unsigned long long v1 = seed + PRIME64_1 + PRIME64_2;
+        unsigned long long v2 = seed + PRIME64_2;
+        unsigned long long v3 = seed;
+        unsigned long long v4 = seed - PRIME64_1;
+
+        // 32バイト単位で4本のアキュムレータを独立に更新する.
+        const unsigned char* pLimit = pEnd - 32;
+        do
+        {
+            v1 = HashRound( v1, Read64( p      ) );
+            v2 = HashRound( v2, Read64( p +  8 ) );
+            v3 = HashRound( v3, Read64( p + 16 ) );
+            v4 = HashRound( v4, Read64( p + 24 ) );
+            p += 32;
+        }
+        while( p <= pLimit );
+
+        hash = RotateLeft( v1, 1 ) + RotateLeft( v2, 7 ) + RotateLeft( v3, 12 ) + RotateLeft( v4, 18 );
+        hash = HashMerge( hash, v1 );
+        hash = HashMerge( hash, v2 );
+        hash = HashMerge( hash, v3 );
+        hash = HashMerge( hash, v4 );
+    }
+    else
+    { hash = seed + PRIME64_5; }
+
+    hash += static_cast<unsigned long long>( size );
+
+    for( ; p + 8 <= pEnd; p += 8 )
+    {
+        hash ^= HashRound( 0, Read64( p ) );
+        hash  = RotateLeft( hash, 27 ) * PRIME64_1 + PRIME64_4;
+    }
+
+    if ( p + 4 <= pEnd )
+    {
+        hash ^= static_cast<unsigned long long>( Read32( p ) ) * PRIME64_1;
+        hash  = RotateLeft( hash, 23 ) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+
+    for( ; p < pEnd; ++p )
+    {
+        hash ^= static_cast<unsigned long long>( *p ) * PRIME64_5;
+        hash  = RotateLeft( hash, 11 ) * PRIME64_1;
+    }
+
+    // 最終的な攪拌.
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// TextureCache class
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------
+TextureCache::TextureCache()
+: m_File    ()
+, m_Hash    ( 0 )
+, m_HasHash ( false )
+, m_pHeader ( nullptr )
+, m_pLevels ( nullptr )
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------
+TextureCache::~TextureCache()
+{ Close(); }
+
+//-------------------------------------------------------------------------------------------
+//      元画像の内容からハッシュを計算し，キャッシュを探します.
+//-------------------------------------------------------------------------------------------
+bool TextureCache::Open( const char* sourceFilename, unsigned long long salt )
+{
+    Close();
+
+    // 元画像をマップしてハッシュを計算する. ファイル名や更新日時ではなく内容で識別する.
+    {
+        MappedFile source;
+        if ( !source.Open( sourceFilename ) )
+        { return false; }
+
+        m_Hash    = ComputeHash64( source.GetData(), source.GetSize(), CACHE_SEED ^ salt );
+        m_HasHash = true;
+    }
+
+    if ( !m_File.Open( MakeCachePath( m_Hash ).c_str() ) )
+    { return false; }
+
+    const unsigned char* pData = m_File.GetData();
+    const size_t         size  = m_File.GetSize();
+
+    if ( size < sizeof(Header) )
+    {
+        m_File.Close();
+        return false;
+    }
+
+    const Header* pHeader = reinterpret_cast<const Header*>( pData );
+
+    // 壊れたキャッシュや古い形式は使わない.
+    if ( ( pHeader->magic   != CACHE_MAGIC )
+      || ( pHeader->version != CACHE_VERSION )
+      || ( pHeader->hash    != m_Hash )
+      || ( pHeader->bytePerPixel == 0 )
+      || ( pHeader->bytePerPixel > 4 )
+      || ( pHeader->mipCount == 0 )
+      || ( pHeader->mipCount > 32 )
+      || ( size < sizeof(Header) + sizeof(Level) * pHeader->mipCount ) )
+    {
+        m_File.Close();
+        return false;
+    }
+
+    const Level* pLevels = reinterpret_cast<const Level*>( pData + sizeof(Header) );
+    for( unsigned int i=0; i<pHeader->mipCount; ++i )
+    {
+        // 転送時は width * height * bytePerPixel バイトを読むので，サイズの整合性も確認する.
+        const unsigned long long expected = static_cast<unsigned long long>( pLevels[i].width )
+                                          * pLevels[i].height * pHeader->bytePerPixel;
+        if ( ( pLevels[i].offset > size )
+          || ( pLevels[i].size > size - pLevels[i].offset )
+          || ( pLevels[i].size != expected ) )
+        {
+            m_File.Close();
+            return false;
+        }
+    }
+
+    m_pHeader = pHeader;
+    m_pLevels = pLevels;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      変換済みのミップマップチェインをキャッシュに保存します.
+//-------------------------------------------------------------------------------------------
+bool TextureCache::Save
+(
+    unsigned int                    format,
+    unsigned int                    internalFormat,
+    unsigned int                    bytePerPixel,
+    const std::vector<MipLevel>&    levels
+)
+{
+    if ( !m_HasHash || levels.empty() )
+    { return false; }
+
+#if defined(_WIN32)
+    _mkdir( g_CacheDirectory.c_str() );
+#else
+    mkdir( g_CacheDirectory.c_str(), 0755 );
+#endif
+
+    Header header;
+    header.magic          = CACHE_MAGIC;
+    header.version        = CACHE_VERSION;
+    header.hash           = m_Hash;
+    header.width          = levels[0].width;
+    header.height         = levels[0].height;
+    header.bytePerPixel   = bytePerPixel;
+    header.format         = format;
+    header.internalFormat = internalFormat;
+    header.mipCount       = static_cast<unsigned int>( levels.size() );
+
+    // 各レベルはアライメントを揃えて配置し，マップしたまま転送できるようにする.
+    std::vector<Level> table( levels.size() );
+    size_t offset = AlignUp( sizeof(Header) + sizeof(Level) * levels.size(), CACHE_ALIGNMENT );
+    for( size_t i=0; i<levels.size(); ++i )
+    {
+        table[i].offset = static_cast<unsigned int>( offset );
+        table[i].size   = static_cast<unsigned int>( levels[i].pixels.size() );
+        table[i].width  = levels[i].width;
+        table[i].height = levels[i].height;
+        offset = AlignUp( offset + levels[i].pixels.size(), CACHE_ALIGNMENT );
+    }
+
+    // 書き込み途中のファイルを読まれないよう，一時ファイルに書いてから置き換える.
+    const std::string path     = MakeCachePath( m_Hash );
+    const std::string tempPath = path + ".tmp";
+
+    FILE* pFile;
+    if ( fopen_s( &pFile, tempPath.c_str(), "wb" ) != 0 )
+    { return false; }
+
+    static const unsigned char padding[ CACHE_ALIGNMENT ] = { 0 };
+
+    bool result = ( fwrite( &header, sizeof(header), 1, pFile ) == 1 )
+               && ( fwrite( &table[0], sizeof(Level), table.size(), pFile ) == table.size() );
+
+    size_t written = sizeof(Header) + sizeof(Level) * table.size();
+    for( size_t i=0; i<levels.size() && result; ++i )
+    {
+        result = ( fwrite( padding, 1, table[i].offset - written, pFile ) == table[i].offset - written )
+              && ( fwrite( &levels[i].pixels[0], 1, table[i].size, pFile ) == table[i].size );
+        written = table[i].offset + table[i].size;
+    }
+
+    fclose( pFile );
+
+    if ( !result || !ReplaceCacheFile( tempPath.c_str(), path.c_str() ) )
+    {
+        remove( tempPath.c_str() );
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      キャッシュを閉じます.
+//-------------------------------------------------------------------------------------------
+void TextureCache::Close()
+{
+    m_File.Close();
+    m_pHeader = nullptr;
+    m_pLevels = nullptr;
+    m_HasHash = false;
+}
+
+//-------------------------------------------------------------------------------------------
+//      有効なキャッシュがマップされているかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool TextureCache::IsValid() const
+{ return ( m_pHeader != nullptr ); }
+
+//-------------------------------------------------------------------------------------------
+//      画像の横幅を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int TextureCache::GetWidth() const
+{ return ( m_pHeader != nullptr ) ? m_pHeader->width : 0; }
+
+//-------------------------------------------------------------------------------------------
+//      画像の縦幅を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int TextureCache::GetHeight() const
+{ return ( m_pHeader != nullptr ) ? m_pHeader->height : 0; }
+
+//-------------------------------------------------------------------------------------------
+//      1ピクセルあたりのバイト数を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int TextureCache::GetBytePerPixel() const
+{ return ( m_pHeader != nullptr ) ? m_pHeader->bytePerPixel : 0; }
+
+//-------------------------------------------------------------------------------------------
+//      GLのピクセルフォーマットを取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int TextureCache::GetFormat() const
+{ return ( m_pHeader != nullptr ) ? m_pHeader->format : 0; }
+
+//-------------------------------------------------------------------------------------------
+//      GLの内部フォーマットを取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int TextureCache::GetInternalFormat() const
+{ return ( m_pHeader != nullptr ) ? m_pHeader->internalFormat : 0; }
+
+//-------------------------------------------------------------------------------------------
+//      ミップレベル数を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int TextureCache::GetMipCount() const
+{ return ( m_pHeader != nullptr ) ? m_pHeader->mipCount : 0; }
+
+//-------------------------------------------------------------------------------------------
+//      ミップレベルの情報を取得します.
+//-------------------------------------------------------------------------------------------
+const TextureCache::Level& TextureCache::GetLevel( unsigned int index ) const
+{ return m_pLevels[ index ]; }
+
+//-------------------------------------------------------------------------------------------
+//      ミップレベルのピクセルデータを取得します.
+//-------------------------------------------------------------------------------------------
+const unsigned char* TextureCache::GetLevelData( unsigned int index ) const
+{
+    if ( m_pHeader == nullptr || index >= m_pHeader->mipCount )
+    { return nullptr; }
+
+    return m_File.GetData() + m_pLevels[ index ].offset;
+}
+
+//-------------------------------------------------------------------------------------------
+//      キャッシュの保存先ディレクトリを設定します.
+//-------------------------------------------------------------------------------------------
+void TextureCache::SetDirectory( const char* path )
+{
+    if ( path != nullptr )
+    { g_CacheDirectory = path; }
+}
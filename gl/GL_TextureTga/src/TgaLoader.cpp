@@ -8,13 +8,33 @@
 // Includes
 //-------------------------------------------------------------------------------------------
 #include <iostream>
-#include <fstream>
+#include <cstdlib>
+#include <cstring>
 #include <TgaLoader.h>
+#include <MappedFile.h>
+#include <MipMapGenerator.h>
+#include <TextureCache.h>
+#include <ColorSpace.h>
 #include <GL/glut.h>
 
+#ifndef GL_SRGB8
+#define GL_SRGB8            0x8C41
+#endif//GL_SRGB8
+
+#ifndef GL_SRGB8_ALPHA8
+#define GL_SRGB8_ALPHA8     0x8C43
+#endif//GL_SRGB8_ALPHA8
+
 
 namespace /* anonymous */ {
 
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+const unsigned char     TGA_TYPE_TRUECOLOR  = 2;        // 非圧縮フルカラー.
+const unsigned char     TGA_ORIGIN_TOP      = 0x20;     // 記述子: 原点が上端.
+
+
 #pragma pack(push, 1)   // パディングでサイズがずれるのを防ぐ.
 
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -38,6 +58,43 @@ struct TgaHeader
 
 #pragma pack(pop)
 
+//-------------------------------------------------------------------------------------------
+//      色空間に応じた内部フォーマットを取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int GetInternalFormat( unsigned int format, COLOR_SPACE colorSpace )
+{
+    if ( colorSpace != COLOR_SPACE_SRGB )
+    { return format; }
+
+    return ( format == GL_RGBA ) ? GL_SRGB8_ALPHA8 : GL_SRGB8;
+}
+
+//-------------------------------------------------------------------------------------------
+//      sRGBの内部フォーマットかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsSRGBInternalFormat( unsigned int internalFormat )
+{ return ( internalFormat == GL_SRGB8 ) || ( internalFormat == GL_SRGB8_ALPHA8 ); }
+
+//-------------------------------------------------------------------------------------------
+//      sRGBテクスチャに対応しているかどうかチェックします.
+//-------------------------------------------------------------------------------------------
+bool IsSupportSRGBTexture()
+{
+    // GL 2.1 以降はコア機能.
+    const char* pVersion = reinterpret_cast<const char*>( glGetString( GL_VERSION ) );
+    if ( pVersion != nullptr )
+    {
+        const char* pDot  = strchr( pVersion, '.' );
+        const int   major = atoi( pVersion );
+        const int   minor = ( pDot != nullptr ) ? atoi( pDot + 1 ) : 0;
+        if ( major > 2 || ( major == 2 && minor >= 1 ) )
+        { return true; }
+    }
+
+    const char* pExtensions = reinterpret_cast<const char*>( glGetString( GL_EXTENSIONS ) );
+    return ( pExtensions != nullptr ) && ( strstr( pExtensions, "GL_EXT_texture_sRGB" ) != nullptr );
+}
+
 } // namespace /* anonymous */
 
 
@@ -57,6 +114,8 @@ TgaImage::TgaImage()
 , m_BytePerPixel    ( 0 )
 , m_ID              ( 0 )
 , m_pImageData      ( nullptr )
+, m_ColorSpace      ( COLOR_SPACE_SRGB )
+, m_ColorSpaceHint  ( COLOR_SPACE_SRGB )
 { /* DO_NOTHING */ }
 
 
@@ -77,12 +136,15 @@ void TgaImage::Release()
         m_pImageData = nullptr;
     }
 
+    m_Cache.Close();
+
     m_ImageSize      = 0;
     m_Format         = 0;
     m_InternalFormat = 0;
     m_Width          = 0;
     m_Height         = 0;
     m_BytePerPixel   = 0;
+    m_ColorSpace     = m_ColorSpaceHint;
 }
 
 //-------------------------------------------------------------------------------------------
@@ -90,72 +152,113 @@ void TgaImage::Release()
 //-------------------------------------------------------------------------------------------
 bool TgaImage::Load(const char *filename)
 {
-    FILE *fp;
-    TgaHeader header;
+    // 線形として扱う場合はミップマップの内容が変わるので，キャッシュを区別する.
+    const unsigned long long salt = ( m_ColorSpaceHint == COLOR_SPACE_LINEAR ) ? TextureCache::SALT_LINEAR : 0;
+
+    // 変換済みのキャッシュがあれば復号とミップ生成をすべて省略する.
+    if ( m_Cache.Open( filename, salt ) )
+    {
+        m_Width          = m_Cache.GetWidth();
+        m_Height         = m_Cache.GetHeight();
+        m_BytePerPixel   = m_Cache.GetBytePerPixel();
+        m_Format         = m_Cache.GetFormat();
+        m_InternalFormat = m_Cache.GetInternalFormat();
+        m_ColorSpace     = IsSRGBInternalFormat( m_InternalFormat ) ? COLOR_SPACE_SRGB : COLOR_SPACE_LINEAR;
+        m_ImageSize      = m_Cache.GetLevel( 0 ).size;
+        return true;
+    }
 
-    //　ファイルを開く
-    errno_t err = fopen_s( &fp, filename, "rb");
-    if ( err != 0 )
+    MappedFile file;
+    if ( !file.Open( filename ) )
     {
         std::cerr << "Error : File Open Failed" << std::endl;
         std::cerr << "File Name : " << filename << std::endl;
         return false;
     }
 
-    //　ヘッダー情報の読み込み
-    fread(&header, sizeof(header), 1, fp);
+    const unsigned char* pData = file.GetData();
+    const size_t         size  = file.GetSize();
 
-    //　幅と高さを決める
-    m_Width  = header.ImageWidth;
-    m_Height = header.ImageHeight;
+    //　ヘッダー情報の読み込み
+    TgaHeader header;
+    if ( size < sizeof(header) )
+    {
+        std::cerr << "Error : Unexpected End Of File." << std::endl;
+        return false;
+    }
+    memcpy( &header, pData, sizeof(header) );
 
-    //　24 bit
-    if ( header.BitPerPixel == 24 )
+    //　非圧縮フルカラーの 24 bit と 32 bit のみ対応.
+    if ( header.ImageType != TGA_TYPE_TRUECOLOR || ( header.BitPerPixel != 24 && header.BitPerPixel != 32 ) )
     {
-        m_Format = GL_RGB;
-        m_InternalFormat = GL_RGB;
+        std::cerr << "Error : Unexpected Data." << std::endl;
+        return false;
     }
-    //　32 bit
-    else if ( header.BitPerPixel == 32 )
+
+    if ( header.ImageWidth == 0 || header.ImageHeight == 0 )
     {
-        m_Format = GL_RGBA;
-        m_InternalFormat = GL_RGBA;
+        std::cerr << "Error : Invalid Size." << std::endl;
+        return false;
     }
-    else
+
+    //　ピクセルデータは ID とカラーマップの後に続く.
+    const unsigned long long colorMapSize = ( header.ColorMapType != 0 )
+        ? static_cast<unsigned long long>( header.ColorMapLength ) * ( ( header.ColorMapDepth + 7 ) / 8 )
+        : 0;
+    const unsigned long long offset       = sizeof(header) + header.IDLength + colorMapSize;
+
+    //　データサイズは64bitで計算し，オーバーフローと切れたファイルをチェックする.
+    const unsigned int       bytePerPixel = header.BitPerPixel / 8;
+    const unsigned long long imageSize    = static_cast<unsigned long long>( header.ImageWidth ) * header.ImageHeight * bytePerPixel;
+    if ( imageSize > 0xffffffff || imageSize > static_cast<unsigned long long>( size_t( -1 ) ) )
     {
-        std::cerr << "Error : Unexpected Data." << std::endl;
+        std::cerr << "Error : Image Too Large." << std::endl;
         return false;
     }
 
-    // 1ピクセル当たりのバイト数.
-    m_BytePerPixel = header.BitPerPixel / 8;
+    if ( offset > size || imageSize > size - offset )
+    {
+        std::cerr << "Error : Unexpected End Of File." << std::endl;
+        return false;
+    }
 
-    //　データサイズの決定
-    m_ImageSize = m_Width * m_Height * m_BytePerPixel;
+    //　幅と高さを決める
+    m_Width          = header.ImageWidth;
+    m_Height         = header.ImageHeight;
+    m_BytePerPixel   = bytePerPixel;
+    m_Format         = ( bytePerPixel == 4 ) ? GL_RGBA : GL_RGB;
+    m_ColorSpace     = m_ColorSpaceHint;
+    m_InternalFormat = GetInternalFormat( m_Format, m_ColorSpace );
+    m_ImageSize      = static_cast<unsigned int>( imageSize );
 
     //　メモリを確保
     m_pImageData = new(std::nothrow) unsigned char[ m_ImageSize ];
     if ( m_pImageData == nullptr )
     {
         std::cerr << "Error : Memory Allocacte Failed." << std::endl;
-        fclose( fp );
         return false;
     }
 
-    //　テクセルデータを一気に読み取り
-    fread( m_pImageData, sizeof(unsigned char), m_ImageSize, fp );
-
-    //　BGR(A)をRGB(A)にコンバート
-    for ( unsigned int i=0; i<m_ImageSize; i+=m_BytePerPixel )
+    //　BGR(A)をRGB(A)にコンバートしながらコピー.
+    //　原点が上端の場合は下から上の行順に揃える.
+    const bool           topDown = ( header.Descriptor & TGA_ORIGIN_TOP ) != 0;
+    const size_t         pitch   = size_t( m_Width ) * m_BytePerPixel;
+    const unsigned char* pPixels = pData + offset;
+    for ( unsigned int y=0; y<m_Height; ++y )
     {
-        unsigned char    temp = m_pImageData[ i + 0 ];
-        m_pImageData[ i + 0 ] = m_pImageData[ i + 2 ];
-        m_pImageData[ i + 2 ] = temp;
+        const unsigned int   srcY = ( topDown ) ? ( m_Height - 1 - y ) : y;
+        const unsigned char* pSrc = pPixels + pitch * srcY;
+        unsigned char*       pDst = m_pImageData + pitch * y;
+
+        memcpy( pDst, pSrc, pitch );
+        for ( size_t i=0; i<pitch; i+=m_BytePerPixel )
+        {
+            unsigned char temp = pDst[ i + 0 ];
+            pDst[ i + 0 ]      = pDst[ i + 2 ];
+            pDst[ i + 2 ]      = temp;
+        }
     }
 
-    //　ファイルを閉じる
-    fclose(fp);
-
     // 正常終了.
     return true;
 }
@@ -165,7 +268,7 @@ bool TgaImage::Load(const char *filename)
 //-------------------------------------------------------------------------------------------
 bool TgaImage::CreateGLTexture()
 {
-    if ( m_pImageData == nullptr )
+    if ( m_pImageData == nullptr && !m_Cache.IsValid() )
     { return false; }
 
     //　テクスチャを生成
@@ -174,20 +277,68 @@ bool TgaImage::CreateGLTexture()
     //　テクスチャをバインドする
     glBindTexture(GL_TEXTURE_2D, m_ID);
 
+    // sRGBテクスチャに非対応の環境では変換せずにそのまま転送する.
+    const unsigned int internalFormat = ( IsSRGBInternalFormat( m_InternalFormat ) && !IsSupportSRGBTexture() )
+        ? m_Format
+        : m_InternalFormat;
+
     if ( m_BytePerPixel == 4 )
     { glPixelStorei(GL_UNPACK_ALIGNMENT, 4); }
     else 
     { glPixelStorei(GL_UNPACK_ALIGNMENT, 1); }
 
-    //　テクスチャの割り当て
-    gluBuild2DMipmaps(
-        GL_TEXTURE_2D,
-        m_InternalFormat,
-        m_Width,
-        m_Height,
-        m_Format,
-        GL_UNSIGNED_BYTE,
-        m_pImageData );
+    if ( m_Cache.IsValid() )
+    {
+        //　キャッシュからマップしたまま転送する.
+        for( unsigned int i=0; i<m_Cache.GetMipCount(); ++i )
+        {
+            const TextureCache::Level& level = m_Cache.GetLevel( i );
+            glTexImage2D(
+                GL_TEXTURE_2D,
+                int(i),
+                internalFormat,
+                level.width,
+                level.height,
+                0,
+                m_Format,
+                GL_UNSIGNED_BYTE,
+                m_Cache.GetLevelData( i ) );
+        }
+    }
+    else
+    {
+        //　ミップマップチェインをCPUで生成する(非2の累乗サイズもリスケールしない).
+        //　sRGBの画像は線形空間に変換してから縮小する.
+        MipMapOption option;
+        option.isSRGB = ( m_ColorSpace == COLOR_SPACE_SRGB );
+
+        std::vector<MipLevel> levels;
+        if ( !GenerateMipMaps( m_pImageData, m_Width, m_Height, m_BytePerPixel, option, levels ) )
+        {
+            std::cerr << "Error : Generate MipMaps Failed." << std::endl;
+            glBindTexture( GL_TEXTURE_2D, 0 );
+            DeleteGLTexture();
+            return false;
+        }
+
+        //　テクスチャの割り当て
+        for( size_t i=0; i<levels.size(); ++i )
+        {
+            glTexImage2D(
+                GL_TEXTURE_2D,
+                int(i),
+                internalFormat,
+                levels[i].width,
+                levels[i].height,
+                0,
+                m_Format,
+                GL_UNSIGNED_BYTE,
+                &levels[i].pixels[0] );
+        }
+
+        // 次回の起動で復号とミップ生成を省略できるよう保存しておく.
+        m_Cache.Save( m_Format, m_InternalFormat, m_BytePerPixel, levels );
+    }
 
     //　テクスチャを拡大・縮小する方法の指定
     glTexParameteri(GL_TEXTURE_2D, 	GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -219,3 +370,39 @@ void TgaImage::DeleteGLTexture()
 //-------------------------------------------------------------------------------------------
 unsigned int TgaImage::GetID() const
 { return m_ID; }
+
+//-------------------------------------------------------------------------------------------
+//      画像の横幅を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int TgaImage::GetWidth() const
+{ return m_Width; }
+
+//-------------------------------------------------------------------------------------------
+//      画像の縦幅を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int TgaImage::GetHeight() const
+{ return m_Height; }
+
+//-------------------------------------------------------------------------------------------
+//      1ピクセルあたりのバイト数を取得します.
+//-------------------------------------------------------------------------------------------
+unsigned int TgaImage::GetBytePerPixel() const
+{ return m_BytePerPixel; }
+
+//-------------------------------------------------------------------------------------------
+//      ピクセルデータを取得します.
+//-------------------------------------------------------------------------------------------
+const unsigned char* TgaImage::GetPixels() const
+{ return ( m_pImageData != nullptr ) ? m_pImageData : m_Cache.GetLevelData( 0 ); }
+
+//-------------------------------------------------------------------------------------------
+//      色空間の情報を持たない画像に適用する色空間を設定します.
+//-------------------------------------------------------------------------------------------
+void TgaImage::SetColorSpaceHint( COLOR_SPACE colorSpace )
+{ m_ColorSpaceHint = colorSpace; }
+
+//-------------------------------------------------------------------------------------------
+//      読み込んだ画像の色空間を取得します.
+//-------------------------------------------------------------------------------------------
+COLOR_SPACE TgaImage::GetColorSpace() const
+{ return m_ColorSpace; }
@@ -0,0 +1,401 @@
+﻿//-------------------------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Virtual Texture Headless Test.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------
+
+
+#if defined(DEBUG) || defined(_DEBUG)
+    #define _CRTDBG_MAP_ALLOC
+    #include <crtdbg.h>
+#endif//defined(DEBUG) || defined(_DEBUG)
+
+//-------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <VirtualTexture.h>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------
+const char*         DEFAULT_SOURCE  = "../../GL_TextureRaw/res/sample.raw";  // プロジェクトディレクトリからの相対パス.
+const char*         PAGE_FILENAME   = "VirtualTextureTest.page";            // 作業用のページファイル名.
+const unsigned int  SOURCE_SIZE     = 512;      // sample.raw の一辺のピクセル数.
+const unsigned int  SOURCE_BPP      = 3;        // sample.raw の1ピクセルあたりのバイト数.
+const unsigned int  PAGE_SIZE       = 120;      // ボーダーを除いたページの一辺のテクセル数.
+const unsigned int  PAGE_BORDER     = 4;        // ボーダーのテクセル数.
+const unsigned int  PAGE_WIDTH      = PAGE_SIZE + PAGE_BORDER * 2;
+
+// 512 を 120 で分割すると，ミップレベル 0-3 はそれぞれ 5x5, 3x3, 2x2, 1x1 ページになる.
+const unsigned int  MIP_COUNT       = 4;
+const unsigned int  PAGE_COUNTS[]   = { 5, 3, 2, 1 };
+const unsigned int  TOTAL_PAGES     = 25 + 9 + 4 + 1;
+
+//-------------------------------------------------------------------------------------------
+// Global Variables
+//-------------------------------------------------------------------------------------------
+unsigned int g_CheckCount = 0;
+unsigned int g_FailCount  = 0;
+
+
+//-------------------------------------------------------------------------------------------
+//      条件を判定して結果を表示します.
+//-------------------------------------------------------------------------------------------
+void Check( bool condition, const char* message )
+{
+    g_CheckCount++;
+    if ( !condition )
+    { g_FailCount++; }
+
+    std::cout << ( condition ? "[ OK ] " : "[FAIL] " ) << message << std::endl;
+}
+
+//-------------------------------------------------------------------------------------------
+//      統計情報を判定して結果を表示します.
+//-------------------------------------------------------------------------------------------
+void CheckStats
+(
+    const VirtualTexture&   texture,
+    unsigned long long      requestCount,
+    unsigned long long      hitCount,
+    unsigned long long      loadCount,
+    unsigned long long      evictionCount,
+    unsigned long long      deferredCount,
+    const char*             message
+)
+{
+    const VirtualTextureStats& stats = texture.GetStats();
+    const bool condition = ( stats.requestCount  == requestCount )
+                        && ( stats.hitCount      == hitCount )
+                        && ( stats.missCount     == requestCount - hitCount )
+                        && ( stats.loadCount     == loadCount )
+                        && ( stats.evictionCount == evictionCount )
+                        && ( stats.deferredCount == deferredCount );
+    Check( condition, message );
+
+    if ( !condition )
+    {
+        std::cout << "       request " << stats.requestCount
+                  << ", hit "        << stats.hitCount
+                  << ", miss "       << stats.missCount
+                  << ", load "       << stats.loadCount
+                  << ", eviction "   << stats.evictionCount
+                  << ", deferred "   << stats.deferredCount << std::endl;
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+//      ファイルサイズを取得します.
+//-------------------------------------------------------------------------------------------
+long long GetFileSize( const char* filename )
+{
+    FILE* pFile;
+    if ( fopen_s( &pFile, filename, "rb" ) != 0 )
+    { return -1; }
+
+    _fseeki64( pFile, 0, SEEK_END );
+    const long long size = _ftelli64( pFile );
+    fclose( pFile );
+
+    return size;
+}
+
+//-------------------------------------------------------------------------------------------
+//      テスト用の構成設定を取得します.
+//-------------------------------------------------------------------------------------------
+VirtualTextureDesc GetTestDesc()
+{
+    // 物理ページは4枚で，先頭は最も粗いページ専用なので追い出し対象は3枚.
+    VirtualTextureDesc desc;
+    desc.width          = SOURCE_SIZE;
+    desc.height         = SOURCE_SIZE;
+    desc.bytePerPixel   = SOURCE_BPP;
+    desc.pageSize       = PAGE_SIZE;
+    desc.border         = PAGE_BORDER;
+    desc.physicalPagesX = 2;
+    desc.physicalPagesY = 2;
+    return desc;
+}
+
+//-------------------------------------------------------------------------------------------
+//      ページファイルの作成をテストします.
+//-------------------------------------------------------------------------------------------
+bool TestPageFile( const char* sourceFilename )
+{
+    RawImage source;
+    if ( !source.OpenStream( sourceFilename, SOURCE_SIZE, SOURCE_SIZE ) )
+    {
+        Check( false, "open source image" );
+        return false;
+    }
+
+    const bool built = VirtualTexture::BuildPageFile( source, PAGE_FILENAME, PAGE_SIZE, PAGE_BORDER );
+    Check( built, "build page file" );
+    if ( !built )
+    { return false; }
+
+    const long long expectedSize = static_cast<long long>( TOTAL_PAGES ) * PAGE_WIDTH * PAGE_WIDTH * SOURCE_BPP;
+    Check( GetFileSize( PAGE_FILENAME ) == expectedSize, "page file holds 39 pages with borders" );
+
+    RawImage pages;
+    if ( !pages.OpenStream( PAGE_FILENAME, PAGE_WIDTH, TOTAL_PAGES * PAGE_WIDTH ) )
+    {
+        Check( false, "open page file" );
+        return false;
+    }
+
+    std::vector<unsigned char> page    ( PAGE_WIDTH * PAGE_WIDTH * SOURCE_BPP );
+    std::vector<unsigned char> expected( PAGE_SIZE  * PAGE_SIZE  * SOURCE_BPP );
+
+    // ミップレベル0のページ(1, 1)の内側は元画像の (120, 120) からの領域と一致する.
+    {
+        const unsigned int index = 1 * PAGE_COUNTS[0] + 1;
+        pages .ReadRegion( 0, index * PAGE_WIDTH, PAGE_WIDTH, PAGE_WIDTH, &page[0] );
+        source.ReadRegion( PAGE_SIZE, PAGE_SIZE, PAGE_SIZE, PAGE_SIZE, &expected[0] );
+
+        bool match = true;
+        for( unsigned int y=0; y<PAGE_SIZE && match; ++y )
+        {
+            match = memcmp(
+                &page[ ( ( y + PAGE_BORDER ) * PAGE_WIDTH + PAGE_BORDER ) * SOURCE_BPP ],
+                &expected[ y * PAGE_SIZE * SOURCE_BPP ],
+                PAGE_SIZE * SOURCE_BPP ) == 0;
+        }
+        Check( match, "mip 0 page interior matches the source" );
+    }
+
+    // ページ(0, 0)の左上のボーダーは元画像の左上のピクセルを複製している.
+    {
+        unsigned char corner[SOURCE_BPP];
+        pages .ReadRegion( 0, 0, PAGE_WIDTH, PAGE_WIDTH, &page[0] );
+        source.ReadRegion( 0, 0, 1, 1, corner );
+
+        bool match = true;
+        for( unsigned int y=0; y<=PAGE_BORDER && match; ++y )
+        {
+            for( unsigned int x=0; x<=PAGE_BORDER && match; ++x )
+            { match = memcmp( &page[ ( y * PAGE_WIDTH + x ) * SOURCE_BPP ], corner, SOURCE_BPP ) == 0; }
+        }
+        Check( match, "border texels clamp to the image edge" );
+    }
+
+    // ミップレベル1のページ(0, 0)の内側は元画像を2x2で平均したものと一致する.
+    {
+        const unsigned int index = PAGE_COUNTS[0] * PAGE_COUNTS[0];
+        pages .ReadRegion( 0, index * PAGE_WIDTH, PAGE_WIDTH, PAGE_WIDTH, &page[0] );
+        source.ReadRegion( 0, 0, PAGE_SIZE * 2, PAGE_SIZE * 2, &expected[0], 2 );
+
+        bool match = true;
+        for( unsigned int y=0; y<PAGE_SIZE && match; ++y )
+        {
+            match = memcmp(
+                &page[ ( ( y + PAGE_BORDER ) * PAGE_WIDTH + PAGE_BORDER ) * SOURCE_BPP ],
+                &expected[ y * PAGE_SIZE * SOURCE_BPP ],
+                PAGE_SIZE * SOURCE_BPP ) == 0;
+        }
+        Check( match, "mip 1 page interior matches the 2x2 box downsample" );
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+//      ページ数と間接参照テーブルの大きさをテストします.
+//-------------------------------------------------------------------------------------------
+void TestLayout()
+{
+    VirtualTexture texture;
+    Check( texture.Init( GetTestDesc() ), "init without page file" );
+    Check( texture.GetMipCount() == MIP_COUNT, "mip count is 4" );
+
+    bool match = true;
+    for( unsigned int m=0; m<MIP_COUNT; ++m )
+    {
+        match &= ( texture.GetPageCountX( m ) == PAGE_COUNTS[m] );
+        match &= ( texture.GetPageCountY( m ) == PAGE_COUNTS[m] );
+        match &= ( texture.GetIndirectionSize( m ) == ( 8u >> m ) );
+    }
+    Check( match, "per-mip page counts are 5, 3, 2, 1 and indirection sizes 8, 4, 2, 1" );
+
+    // 最も粗いページは最初から常駐している.
+    Check( texture.GetResidentCount() == 1 && texture.IsResident( MIP_COUNT - 1, 0, 0 ), "coarsest page is resident after init" );
+}
+
+//-------------------------------------------------------------------------------------------
+//      常駐管理とLRUによる追い出しをテストします.
+//-------------------------------------------------------------------------------------------
+void TestResidency()
+{
+    VirtualTexture texture;
+    texture.Init( GetTestDesc() );
+
+    // 3ページを要求すると全て読み込まれる. 同じフレーム内の重複は数えない.
+    texture.BeginFrame();
+    texture.Request( 0, 0, 0 );
+    texture.Request( 0, 1, 0 );
+    texture.Request( 0, 2, 0 );
+    texture.Request( 0, 0, 0 );
+    Check( texture.Update() == 3, "frame 1 loads 3 pages" );
+    CheckStats( texture, 3, 0, 3, 0, 0, "frame 1 counts 3 misses and ignores duplicates" );
+    Check( texture.GetResidentCount() == 4, "frame 1 fills all physical pages" );
+
+    // 常駐しているページと最も粗いページはヒットする.
+    texture.BeginFrame();
+    texture.Request( 0, 0, 0 );
+    texture.Request( 0, 1, 0 );
+    texture.Request( MIP_COUNT - 1, 0, 0 );
+    Check( texture.Update() == 0, "frame 2 loads nothing" );
+    CheckStats( texture, 6, 3, 3, 0, 0, "frame 2 hits resident pages" );
+
+    // 前のフレームで要求されなかった (2, 0) が追い出される.
+    texture.BeginFrame();
+    texture.Request( 0, 3, 0 );
+    texture.Update();
+    CheckStats( texture, 7, 3, 4, 1, 0, "frame 3 evicts one page" );
+    Check( !texture.IsResident( 0, 2, 0 ), "least recently used page was evicted" );
+    Check( texture.IsResident( 0, 0, 0 ) && texture.IsResident( 0, 1, 0 ) && texture.IsResident( 0, 3, 0 ), "recently used pages stay resident" );
+
+    // 物理ページより多く要求すると，今フレームで使うページは追い出さずに見送る.
+    texture.BeginFrame();
+    texture.Request( 0, 0, 1 );
+    texture.Request( 0, 1, 1 );
+    texture.Request( 0, 2, 1 );
+    texture.Request( 0, 3, 1 );
+    Check( texture.Update() == 3, "frame 4 loads as many pages as fit" );
+    CheckStats( texture, 11, 3, 7, 4, 1, "frame 4 defers the page that does not fit" );
+    Check( texture.IsResident( 0, 0, 1 ) && texture.IsResident( 0, 1, 1 ) && texture.IsResident( 0, 2, 1 ), "pages are loaded in page order" );
+    Check( !texture.IsResident( 0, 3, 1 ) && !texture.IsResident( 0, 0, 0 ), "deferred and evicted pages are not resident" );
+
+    // 読み込み上限を超えた分は見送る.
+    texture.BeginFrame();
+    texture.Request( 0, 4, 0 );
+    texture.Request( 0, 4, 1 );
+    Check( texture.Update( 1 ) == 1, "frame 5 honours the load limit" );
+    CheckStats( texture, 13, 3, 8, 5, 2, "frame 5 defers pages over the load limit" );
+    Check( texture.GetResidentCount() == 4, "resident count never exceeds the physical pages" );
+
+    const double hitRate = texture.GetStats().GetHitRate();
+    Check( hitRate > 3.0 / 13.0 - 1e-9 && hitRate < 3.0 / 13.0 + 1e-9, "hit rate is 3 / 13" );
+
+    // 常駐していないページは常駐している最も近い親ページを参照する.
+    {
+        const unsigned char* pTable = texture.GetIndirection( 0 );
+        const unsigned char* pEntry = &pTable[ ( 0 * 8 + 4 ) * 4 ];
+        Check( pEntry[2] == 0 && pEntry[3] == 255, "indirection points resident pages at mip 0" );
+
+        pEntry = &pTable[ ( 0 * 8 + 2 ) * 4 ];
+        Check( pEntry[0] == 0 && pEntry[1] == 0 && pEntry[2] == MIP_COUNT - 1, "indirection falls back to the coarsest page" );
+    }
+
+    texture.ResetStats();
+    CheckStats( texture, 0, 0, 0, 0, 0, "stats reset" );
+}
+
+//-------------------------------------------------------------------------------------------
+//      フットプリントからのミップレベル選択をテストします.
+//-------------------------------------------------------------------------------------------
+void TestFootprint()
+{
+    VirtualTextureDesc desc = GetTestDesc();
+    desc.physicalPagesX = 8;
+    desc.physicalPagesY = 8;
+
+    VirtualTexture texture;
+    texture.Init( desc );
+
+    VirtualTextureFootprint footprint;
+    footprint.minU        = 0.0f;
+    footprint.minV        = 0.0f;
+    footprint.maxU        = 1.0f;
+    footprint.maxV        = 1.0f;
+    footprint.pixelWidth  = 512.0f;
+    footprint.pixelHeight = 512.0f;
+
+    // 1テクセル1ピクセルならミップレベル0の全ページ.
+    texture.BeginFrame();
+    Check( texture.RequestFootprint( footprint ) == 0, "full screen footprint selects mip 0" );
+    Check( texture.GetStats().requestCount == 25, "mip 0 footprint requests 25 pages" );
+
+    // バイアスで1段粗くできる.
+    texture.ResetStats();
+    texture.BeginFrame();
+    Check( texture.RequestFootprint( footprint, 1.0f ) == 1, "mip bias 1 selects mip 1" );
+    Check( texture.GetStats().requestCount == 9, "mip 1 footprint requests 9 pages" );
+
+    // 1/8 に縮小して表示する場合は最も粗いページだけ.
+    footprint.pixelWidth  = 64.0f;
+    footprint.pixelHeight = 64.0f;
+    texture.ResetStats();
+    texture.BeginFrame();
+    Check( texture.RequestFootprint( footprint ) == MIP_COUNT - 1, "1/8 footprint selects mip 3" );
+    CheckStats( texture, 1, 1, 0, 0, 0, "mip 3 footprint hits the coarsest page" );
+
+    // 一部だけ見えている場合はその範囲のページだけ.
+    footprint.minU        = 0.5f;
+    footprint.maxU        = 0.6f;
+    footprint.minV        = 0.0f;
+    footprint.maxV        = 0.1f;
+    footprint.pixelWidth  = 51.2f;
+    footprint.pixelHeight = 51.2f;
+    texture.ResetStats();
+    texture.BeginFrame();
+    Check( texture.RequestFootprint( footprint ) == 0, "zoomed footprint selects mip 0" );
+    Check( texture.GetStats().requestCount == 1, "zoomed footprint requests only the covered page" );
+}
+
+//-------------------------------------------------------------------------------------------
+//      ページファイルからの読み込みをテストします.
+//-------------------------------------------------------------------------------------------
+void TestPageLoad()
+{
+    VirtualTexture texture;
+    texture.Init( GetTestDesc() );
+    Check( !texture.OpenPageFile( "VirtualTextureTest.missing" ), "missing page file is rejected" );
+    Check( texture.OpenPageFile( PAGE_FILENAME ), "open page file" );
+
+    // 各ミップレベルの最後のページまでページファイルから読める.
+    texture.BeginFrame();
+    texture.Request( 0, 4, 4 );
+    texture.Request( 1, 2, 2 );
+    texture.Request( 2, 1, 1 );
+    Check( texture.Update() == 3, "last page of each mip loads from the page file" );
+    CheckStats( texture, 3, 0, 3, 0, 0, "no page read was deferred" );
+}
+
+} // namespace /* anonymous */
+
+
+//-------------------------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+#if defined(DEBUG) || defined(_DEBUG)
+    _CrtSetDbgFlag( _CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF );
+#endif//defined(DEBUG) || defined(_DEBUG)
+
+    // 引数で 512x512 RGB のRAW画像を指定できる.
+    const char* sourceFilename = ( argc > 1 ) ? argv[1] : DEFAULT_SOURCE;
+
+    TestLayout();
+    TestResidency();
+    TestFootprint();
+
+    if ( TestPageFile( sourceFilename ) )
+    { TestPageLoad(); }
+
+    remove( PAGE_FILENAME );
+
+    std::cout << "\n"
+              << ( g_CheckCount - g_FailCount ) << " / " << g_CheckCount << " checks passed"
+              << std::endl;
+
+    return ( g_FailCount == 0 ) ? 0 : 1;
+}